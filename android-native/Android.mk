@@ -442,6 +442,7 @@ LOCAL_SRC_FILES := \
   src/ndn-cpp/src/c/util/dynamic-uint8-array.c \
   src/ndn-cpp/src/c/util/ndn_memory.c \
   src/ndn-cpp/src/c/util/ndn_realloc.c \
+  src/ndn-cpp/src/c/util/sha256-multi-buffer.c \
   src/ndn-cpp/src/c/util/time.c \
   src/ndn-cpp/src/common.cpp \
   src/ndn-cpp/src/control-parameters.cpp \
@@ -601,6 +602,7 @@ LOCAL_SRC_FILES := \
   src/ndn-cpp/src/security/v2/validator-config/config-filter.cpp \
   src/ndn-cpp/src/security/v2/validator-config/config-name-relation.cpp \
   src/ndn-cpp/src/security/v2/validator-config/config-rule.cpp \
+  src/ndn-cpp/src/security/v2/validator-config/config-rule-index.cpp \
   src/ndn-cpp/src/transport/async-tcp-transport.cpp \
   src/ndn-cpp/src/transport/async-unix-transport.cpp \
   src/ndn-cpp/src/transport/tcp-transport.cpp \
@@ -608,14 +610,26 @@ LOCAL_SRC_FILES := \
   src/ndn-cpp/src/transport/udp-transport.cpp \
   src/ndn-cpp/src/transport/unix-transport.cpp \
   src/ndn-cpp/src/util/boost-info-parser.cpp \
+  src/ndn-cpp/src/util/cache-eviction-policy.cpp \
+  src/ndn-cpp/src/util/cache-eviction-policy-arc.cpp \
+  src/ndn-cpp/src/util/cache-eviction-policy-lfu.cpp \
+  src/ndn-cpp/src/util/cache-eviction-policy-lru.cpp \
   src/ndn-cpp/src/util/command-interest-generator.cpp \
   src/ndn-cpp/src/util/config-file.cpp \
   src/ndn-cpp/src/util/dynamic-uint8-vector.cpp \
   src/ndn-cpp/src/util/exponential-re-express.cpp \
+  src/ndn-cpp/src/util/face-metrics.cpp \
+  src/ndn-cpp/src/util/latency-histogram.cpp \
   src/ndn-cpp/src/util/logging.cpp \
   src/ndn-cpp/src/util/memory-content-cache.cpp \
+  src/ndn-cpp/src/util/persistent-content-store.cpp \
+  src/ndn-cpp/src/util/rtt-estimator.cpp \
   src/ndn-cpp/src/util/segment-fetcher.cpp \
+  src/ndn-cpp/src/util/segment-manifest.cpp \
+  src/ndn-cpp/src/util/segment-publisher.cpp \
+  src/ndn-cpp/src/util/sharded-content-store.cpp \
   src/ndn-cpp/src/util/sqlite3-statement.cpp \
+  src/ndn-cpp/src/util/regex/ndn-regex-automaton.cpp \
   src/ndn-cpp/src/util/regex/ndn-regex-backref-manager.cpp \
   src/ndn-cpp/src/util/regex/ndn-regex-backref-matcher.cpp \
   src/ndn-cpp/src/util/regex/ndn-regex-component-matcher.cpp \
@@ -190,8 +190,8 @@ static const SHA_LONG K256[64] = {
 
 # ifdef OPENSSL_SMALL_FOOTPRINT
 
-static void sha256_block_data_order(SHA256_CTX *ctx, const void *in,
-                                    size_t num)
+static void sha256_block_data_order_c(SHA256_CTX *ctx, const void *in,
+                                      size_t num)
 {
     unsigned MD32_REG_T a, b, c, d, e, f, g, h, s0, s1, T1, T2;
     SHA_LONG X[16], l;
@@ -268,8 +268,8 @@ static void sha256_block_data_order(SHA256_CTX *ctx, const void *in,
         T1 = X[(i)&0x0f] += s0 + s1 + X[(i+9)&0x0f];    \
         ROUND_00_15(i,a,b,c,d,e,f,g,h);         } while (0)
 
-static void sha256_block_data_order(SHA256_CTX *ctx, const void *in,
-                                    size_t num)
+static void sha256_block_data_order_c(SHA256_CTX *ctx, const void *in,
+                                      size_t num)
 {
     unsigned MD32_REG_T a, b, c, d, e, f, g, h, s0, s1, T1;
     SHA_LONG X[16];
@@ -408,6 +408,105 @@ static void sha256_block_data_order(SHA256_CTX *ctx, const void *in,
 }
 
 # endif
+
+/*
+ * On x86 with GCC or Clang, use the SHA extensions (SHA-NI) if the CPU has
+ * them. This is checked once at run time so that the library still runs on
+ * older CPUs.
+ */
+# if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && \
+     (defined(__clang__) || __GNUC__ >= 5)
+#  define SHA256_SHAEXT
+#  include <cpuid.h>
+#  include <immintrin.h>
+
+static int sha256_shaext_capable(void)
+{
+    static int capable = -1;
+
+    if (capable < 0) {
+        unsigned int eax, ebx, ecx, edx;
+        int result = 0;
+
+        if (__get_cpuid(1, &eax, &ebx, &ecx, &edx) && (ecx & bit_SSSE3) &&
+            (ecx & bit_SSE4_1) && __get_cpuid_max(0, 0) >= 7) {
+            __cpuid_count(7, 0, eax, ebx, ecx, edx);
+            /* CPUID.(EAX=7,ECX=0):EBX bit 29 is SHA. */
+            result = (ebx & (1U << 29)) != 0;
+        }
+        capable = result;
+    }
+    return capable;
+}
+
+__attribute__((target("sha,sse4.1,ssse3")))
+static void sha256_block_data_order_shaext(SHA256_CTX *ctx, const void *in,
+                                           size_t num)
+{
+    const unsigned char *data = in;
+    const __m128i MASK =
+        _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+    __m128i STATE0, STATE1, MSG, TMP, ABEF_SAVE, CDGH_SAVE;
+    __m128i M[4];
+    int i;
+
+    /* Load the state and arrange it as ABEF and CDGH. */
+    TMP = _mm_loadu_si128((const __m128i *)&ctx->h[0]);
+    STATE1 = _mm_loadu_si128((const __m128i *)&ctx->h[4]);
+    TMP = _mm_shuffle_epi32(TMP, 0xB1);          /* CDAB */
+    STATE1 = _mm_shuffle_epi32(STATE1, 0x1B);    /* EFGH */
+    STATE0 = _mm_alignr_epi8(TMP, STATE1, 8);    /* ABEF */
+    STATE1 = _mm_blend_epi16(STATE1, TMP, 0xF0); /* CDGH */
+
+    while (num--) {
+        ABEF_SAVE = STATE0;
+        CDGH_SAVE = STATE1;
+
+        /* Each group i does 4 rounds with the message words in M[i & 3]. */
+        for (i = 0; i < 16; i++) {
+            if (i < 4)
+                M[i] = _mm_shuffle_epi8
+                    (_mm_loadu_si128((const __m128i *)(data + 16 * i)), MASK);
+            else
+                M[i & 3] = _mm_sha256msg2_epu32
+                    (_mm_add_epi32
+                     (_mm_sha256msg1_epu32(M[i & 3], M[(i + 1) & 3]),
+                      _mm_alignr_epi8(M[(i + 3) & 3], M[(i + 2) & 3], 4)),
+                     M[(i + 3) & 3]);
+
+            MSG = _mm_add_epi32
+                (M[i & 3], _mm_loadu_si128((const __m128i *)&K256[4 * i]));
+            STATE1 = _mm_sha256rnds2_epu32(STATE1, STATE0, MSG);
+            MSG = _mm_shuffle_epi32(MSG, 0x0E);
+            STATE0 = _mm_sha256rnds2_epu32(STATE0, STATE1, MSG);
+        }
+
+        STATE0 = _mm_add_epi32(STATE0, ABEF_SAVE);
+        STATE1 = _mm_add_epi32(STATE1, CDGH_SAVE);
+        data += SHA256_CBLOCK;
+    }
+
+    /* Put the state back in order as ABCD and EFGH. */
+    TMP = _mm_shuffle_epi32(STATE0, 0x1B);       /* FEBA */
+    STATE1 = _mm_shuffle_epi32(STATE1, 0xB1);    /* DCHG */
+    STATE0 = _mm_blend_epi16(TMP, STATE1, 0xF0); /* DCBA */
+    STATE1 = _mm_alignr_epi8(STATE1, TMP, 8);    /* HGFE */
+    _mm_storeu_si128((__m128i *)&ctx->h[0], STATE0);
+    _mm_storeu_si128((__m128i *)&ctx->h[4], STATE1);
+}
+# endif
+
+static void sha256_block_data_order(SHA256_CTX *ctx, const void *in,
+                                    size_t num)
+{
+# ifdef SHA256_SHAEXT
+    if (sha256_shaext_capable()) {
+        sha256_block_data_order_shaext(ctx, in, num);
+        return;
+    }
+# endif
+    sha256_block_data_order_c(ctx, in, num);
+}
 #endif                         /* SHA256_ASM */
 
 #endif // NDN_CPP_HAVE_LIBCRYPTO
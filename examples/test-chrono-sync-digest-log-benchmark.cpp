@@ -0,0 +1,158 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Regents of the University of California.
+ * @author: Jeff Thompson <jefft0@remap.ucla.edu>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+/**
+ * This is a soak test of the ChronoSync2013 digest log. It applies 1 million
+ * sequence number updates in a group of 2000 participants to a DigestTree,
+ * adding each new root digest to the DigestLog as ChronoSync2013 does, and
+ * looks up the previous root digest as for a sync interest from a user who is
+ * one update behind. It prints the rate and the number of log entries after
+ * each 100000 updates, first with the default maximum log size and then with
+ * no limit.
+ */
+
+// Only compile if ndn-cpp-config.h defines NDN_CPP_HAVE_PROTOBUF = 1.
+#include <ndn-cpp/ndn-cpp-config.h>
+#if NDN_CPP_HAVE_PROTOBUF
+
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include "../src/sync/sync-state.pb.h"
+#include "../src/sync/digest-tree.hpp"
+#include "../src/sync/digest-log.hpp"
+
+using namespace std;
+using namespace ndn;
+
+static double
+getNowSeconds()
+{
+  struct timeval t;
+  gettimeofday(&t, 0);
+  return t.tv_sec + t.tv_usec / 1000000.0;
+}
+
+/**
+ * Get the maximum resident set size of this process so far.
+ * @return The maximum resident set size (in kilobytes on Linux).
+ */
+static long
+getMaxResidentSetSize()
+{
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_maxrss;
+}
+
+/**
+ * Apply the updates and print the progress.
+ * @param label The label to print.
+ * @param maxEntries The maximum number of digest log entries, or 0 for no
+ * limit.
+ * @param nParticipants The number of participants.
+ * @param nUpdates The number of updates.
+ */
+static void
+soak
+  (const string& label, size_t maxEntries, size_t nParticipants, int nUpdates)
+{
+  const int reportInterval = 100000;
+  DigestTree digestTree;
+  DigestLog digestLog(maxEntries);
+  Sync::SyncStateMsg emptyContent;
+  digestLog.add("00", emptyContent.ss());
+
+  vector<string> prefixes;
+  vector<int> sequenceNos(nParticipants, 0);
+  for (size_t i = 0; i < nParticipants; ++i) {
+    ostringstream prefix;
+    prefix << "/ndn/edu/ucla/chat/participant" << i;
+    prefixes.push_back(prefix.str());
+  }
+
+  cout << label << ":" << endl;
+  int nFound = 0;
+  string previousRoot = digestTree.getRoot();
+  double start = getNowSeconds();
+  double totalStart = start;
+  for (int i = 0; i < nUpdates; ++i) {
+    size_t participant = ((size_t)i * 7919) % nParticipants;
+    Sync::SyncStateMsg content;
+    Sync::SyncState* syncState = content.add_ss();
+    syncState->set_name(prefixes[participant]);
+    syncState->set_type(Sync::SyncState_ActionType_UPDATE);
+    syncState->mutable_seqno()->set_seq(++sequenceNos[participant]);
+    syncState->mutable_seqno()->set_session(1);
+
+    // Update as in ChronoSync2013::Impl::update.
+    digestTree.update(syncState->name(), 1, syncState->seqno().seq());
+    const string& root = digestTree.getRoot();
+    if (digestLog.find(root) == -1)
+      digestLog.add(root, content.ss());
+
+    // Answer a sync interest for the previous root.
+    if (digestLog.find(previousRoot) != -1)
+      ++nFound;
+    previousRoot = root;
+
+    if ((i + 1) % reportInterval == 0) {
+      double now = getNowSeconds();
+      cout << "  " << (i + 1) << " updates: " << reportInterval / (now - start) <<
+        " updates/s, " << digestLog.size() << " log entries, max RSS " <<
+        getMaxResidentSetSize() << endl;
+      start = now;
+    }
+  }
+
+  cout << "  Total " << nUpdates / (getNowSeconds() - totalStart) <<
+    " updates/s, found " << nFound << " previous roots, evicted " <<
+    digestLog.getEvictionCount() << endl;
+}
+
+int
+main(int argc, char** argv)
+{
+  const size_t nParticipants = 2000;
+  const int nUpdates = 1000000;
+
+  soak("Default maximum log size", DigestLog::DEFAULT_MAX_ENTRIES,
+       nParticipants, nUpdates);
+  soak("No log size limit", 0, nParticipants, nUpdates);
+
+  return 0;
+}
+
+#else // NDN_CPP_HAVE_PROTOBUF
+
+#include <iostream>
+
+using namespace std;
+
+int main(int argc, char** argv)
+{
+  cout <<
+    "This program uses Protobuf but it is not installed. Install it and ./configure again." << endl;
+}
+
+#endif // NDN_CPP_HAVE_PROTOBUF
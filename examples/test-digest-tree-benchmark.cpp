@@ -0,0 +1,104 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Regents of the University of California.
+ * @author: Jeff Thompson <jefft0@remap.ucla.edu>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+
+/**
+ * This measures the rate at which the ChronoSync2013 DigestTree applies
+ * sequence number updates in a group of 2000 participants. It updates one
+ * participant and gets the root digest for each update, as for a locally
+ * published sequence number, and then applies bursts of 10 updates before
+ * getting the root digest, as for a received SyncStateMsg.
+ */
+
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <sys/time.h>
+#include "../src/sync/digest-tree.hpp"
+
+using namespace std;
+using namespace ndn;
+
+static double
+getNowSeconds()
+{
+  struct timeval t;
+  gettimeofday(&t, 0);
+  return t.tv_sec + t.tv_usec / 1000000.0;
+}
+
+/**
+ * Apply the updates to the digest tree, getting the root digest after each
+ * burst, and print the rate.
+ * @param label The label to print.
+ * @param digestTree The DigestTree with all the participants.
+ * @param prefixes The data prefix of each participant.
+ * @param sequenceNos The sequence number of each participant, which is
+ * incremented for each update.
+ * @param nUpdates The number of updates.
+ * @param burstSize The number of updates before getting the root.
+ */
+static void
+benchmarkUpdates
+  (const string& label, DigestTree& digestTree, const vector<string>& prefixes,
+   vector<int>& sequenceNos, int nUpdates, int burstSize)
+{
+  size_t rootLength = 0;
+  double start = getNowSeconds();
+  for (int i = 0; i < nUpdates; ++i) {
+    size_t participant = ((size_t)i * 7919) % prefixes.size();
+    digestTree.update(prefixes[participant], 1, ++sequenceNos[participant]);
+    if ((i + 1) % burstSize == 0)
+      rootLength += digestTree.getRoot().size();
+  }
+  double seconds = getNowSeconds() - start;
+
+  // Use rootLength so that the compiler doesn't optimize it out.
+  cout << label << ": " << nUpdates / seconds << " updates/s" <<
+    (rootLength > 0 ? "" : " (no root)") << endl;
+}
+
+int
+main(int argc, char** argv)
+{
+  const size_t nParticipants = 2000;
+
+  DigestTree digestTree;
+  vector<string> prefixes;
+  vector<int> sequenceNos(nParticipants, 0);
+  double start = getNowSeconds();
+  for (size_t i = 0; i < nParticipants; ++i) {
+    ostringstream prefix;
+    prefix << "/ndn/edu/ucla/chat/participant" << i;
+    prefixes.push_back(prefix.str());
+    digestTree.update(prefixes.back(), 1, 0);
+    digestTree.getRoot();
+  }
+  cout << "Join " << nParticipants << " participants: " <<
+    (getNowSeconds() - start) * 1000 << " ms" << endl;
+
+  benchmarkUpdates("Root after each update", digestTree, prefixes, sequenceNos,
+                   20000, 1);
+  benchmarkUpdates("Root after 10 updates", digestTree, prefixes, sequenceNos,
+                   100000, 10);
+
+  return 0;
+}
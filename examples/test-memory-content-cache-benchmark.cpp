@@ -0,0 +1,179 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Regents of the University of California.
+ * @author: Jeff Thompson <jefft0@remap.ucla.edu>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+/**
+ * This measures the rate at which MemoryContentCache answers Interests for
+ * different numbers of Data packets in the cache, for an exact name, a prefix
+ * with the leftmost child and a prefix with the rightmost child.
+ */
+
+#include <iostream>
+#include <stdexcept>
+#include <sys/time.h>
+#include <ndn-cpp/util/memory-content-cache.hpp>
+
+using namespace std;
+using namespace ndn;
+
+static double
+getNowMilliseconds()
+{
+  struct timeval t;
+  gettimeofday(&t, 0);
+  return t.tv_sec * 1000.0 + t.tv_usec / 1000.0;
+}
+
+/**
+ * CaptureFace extends Face to save the OnInterestCallback from
+ * setInterestFilter so that the benchmark can call it directly, and to count
+ * the packets sent instead of sending them to a forwarder.
+ */
+class CaptureFace : public Face {
+public:
+  CaptureFace()
+  : Face("localhost"), nSent_(0)
+  {
+  }
+
+  virtual uint64_t
+  setInterestFilter(const Name& prefix, const OnInterestCallback& onInterest)
+  {
+    prefix_ = ptr_lib::make_shared<Name>(prefix);
+    onInterest_ = onInterest;
+    return 1;
+  }
+
+  virtual void
+  unsetInterestFilter(uint64_t interestFilterId) {}
+
+  virtual void
+  send(const uint8_t *encoding, size_t encodingLength) { ++nSent_; }
+
+  /**
+   * Call the OnInterestCallback from setInterestFilter for the interest.
+   */
+  void
+  receive(const ptr_lib::shared_ptr<const Interest>& interest)
+  {
+    onInterest_
+      (prefix_, interest, *this, 1, ptr_lib::shared_ptr<const InterestFilter>());
+  }
+
+  size_t
+  getSentCount() const { return nSent_; }
+
+private:
+  ptr_lib::shared_ptr<const Name> prefix_;
+  OnInterestCallback onInterest_;
+  size_t nSent_;
+};
+
+/**
+ * Call face.receive for each of the interests, repeating them for nInterests
+ * in total, and print the rate.
+ * @param label The label to print.
+ * @param face The CaptureFace with the cache's callback.
+ * @param interests The Interests to send.
+ * @param nInterests The total number of Interests to send.
+ */
+static void
+benchmarkInterests
+  (const string& label, CaptureFace& face,
+   const vector<ptr_lib::shared_ptr<const Interest> >& interests,
+   size_t nInterests)
+{
+  size_t nSentBefore = face.getSentCount();
+  double startTime = getNowMilliseconds();
+  for (size_t i = 0; i < nInterests; ++i)
+    face.receive(interests[i % interests.size()]);
+  double durationSeconds = (getNowMilliseconds() - startTime) / 1000.0;
+
+  if (face.getSentCount() - nSentBefore != nInterests)
+    throw runtime_error("Not all Interests were answered for " + label);
+  cout << "  " << label << ": Interests/s: " <<
+    (nInterests / durationSeconds) << endl;
+}
+
+/**
+ * Fill a new MemoryContentCache with nObjects objects of nSegments segments
+ * each, and print the Interest-serving rate.
+ */
+static void
+benchmarkCacheSize(size_t nObjects, size_t nSegments, size_t nInterests)
+{
+  CaptureFace face;
+  MemoryContentCache cache(&face);
+  Name prefix("/test/cache");
+  cache.setInterestFilter(prefix);
+
+  vector<uint8_t> value(100);
+  for (size_t i = 0; i < nObjects; ++i) {
+    for (size_t j = 0; j < nSegments; ++j) {
+      Data data(Name(prefix).append("object").appendNumber(i).appendSegment(j));
+      data.setContent(value);
+      data.getMetaInfo().setFreshnessPeriod(3600 * 1000.0);
+      cache.add(data);
+    }
+  }
+
+  // Ask for objects spread across the cache.
+  const size_t nDistinct = 100;
+  vector<ptr_lib::shared_ptr<const Interest> > exactInterests;
+  vector<ptr_lib::shared_ptr<const Interest> > leftmostInterests;
+  vector<ptr_lib::shared_ptr<const Interest> > rightmostInterests;
+  for (size_t i = 0; i < nDistinct; ++i) {
+    size_t object = (i * 7919) % nObjects;
+    Name objectName = Name(prefix).append("object").appendNumber(object);
+
+    ptr_lib::shared_ptr<Interest> interest
+      (new Interest(Name(objectName).appendSegment((i * 31) % nSegments)));
+    exactInterests.push_back(interest);
+
+    interest.reset(new Interest(objectName));
+    interest->setChildSelector(0);
+    leftmostInterests.push_back(interest);
+
+    interest.reset(new Interest(objectName));
+    interest->setChildSelector(1);
+    interest->setMustBeFresh(true);
+    rightmostInterests.push_back(interest);
+  }
+
+  cout << "Cache size " << (nObjects * nSegments) << ":" << endl;
+  benchmarkInterests("Exact name", face, exactInterests, nInterests);
+  benchmarkInterests("Leftmost child", face, leftmostInterests, nInterests);
+  benchmarkInterests
+    ("Rightmost child, MustBeFresh", face, rightmostInterests, nInterests);
+}
+
+int
+main(int argc, char** argv)
+{
+  try {
+    const size_t nSegments = 10;
+    size_t nObjectsList[] = { 10, 100, 1000, 10000 };
+    for (size_t i = 0; i < sizeof(nObjectsList) / sizeof(nObjectsList[0]); ++i)
+      benchmarkCacheSize(nObjectsList[i], nSegments, 100000);
+  } catch (std::exception& e) {
+    cout << "exception: " << e.what() << endl;
+  }
+  return 0;
+}
@@ -0,0 +1,530 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Regents of the University of California.
+ * @author: Jeff Thompson <jefft0@remap.ucla.edu>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+
+/**
+ * This measures PartialPSync2017Producer and PartialPSyncConsumer at scale
+ * with an in-process forwarder, so that no NFD is needed. One producer has
+ * many user prefixes, and each of many consumers subscribes to a few of them.
+ * For each round, the producer publishes new sequence numbers for random
+ * prefixes, and this measures the time until every consumer has the latest
+ * sequence numbers of its subscribed prefixes, and the bytes of Data which the
+ * forwarder delivered to the consumers. For comparison, this also prints the
+ * size of the sync state with all the names published in the round, which is
+ * what each member of a full sync group would need to receive.
+ */
+
+// Only compile if ndn-cpp-config.h defines NDN_CPP_HAVE_LIBZ 1.
+#include <ndn-cpp/ndn-cpp-config.h>
+#if NDN_CPP_HAVE_LIBZ
+
+#include <iostream>
+#include <deque>
+#include <list>
+#include <unistd.h>
+#include <sys/time.h>
+#include <ndn-cpp/face.hpp>
+#include <ndn-cpp/control-parameters.hpp>
+#include <ndn-cpp/control-response.hpp>
+#include <ndn-cpp/security/key-chain.hpp>
+#include <ndn-cpp/encoding/tlv-wire-format.hpp>
+#include <ndn-cpp/sync/partial-psync2017-producer.hpp>
+#include <ndn-cpp/sync/partial-psync-consumer.hpp>
+#include "../src/c/encoding/tlv/tlv.h"
+#include "../src/encoding/element-listener.hpp"
+
+using namespace std;
+using namespace ndn;
+using namespace ndn::func_lib;
+
+static double
+getNowMilliseconds()
+{
+  struct timeval t;
+  gettimeofday(&t, 0);
+  return t.tv_sec * 1000.0 + t.tv_usec / 1000.0;
+}
+
+class BusTransport;
+
+/**
+ * ForwarderBus is a minimal in-process forwarder for the BusTransport of each
+ * Face. It answers prefix registration commands, forwards each Interest to
+ * the faces which registered a matching prefix, and uses a pending Interest
+ * table to return each Data to the faces which asked for it.
+ */
+class ForwarderBus {
+public:
+  ForwarderBus(KeyChain& keyChain)
+  : keyChain_(keyChain)
+  {
+  }
+
+  /**
+   * Add the transport and return its face index.
+   */
+  size_t
+  addTransport(BusTransport* transport)
+  {
+    transports_.push_back(transport);
+    fib_.push_back(vector<Name>());
+    nBytesReceived_.push_back(0);
+    return transports_.size() - 1;
+  }
+
+  /**
+   * Queue the packet which was sent by the face.
+   */
+  void
+  send(size_t faceIndex, const uint8_t *data, size_t dataLength)
+  {
+    queue_.push_back(make_pair(faceIndex, Blob(data, dataLength)));
+  }
+
+  /**
+   * Forward all the queued packets, including packets which are queued while
+   * forwarding.
+   * @return True if any packet was forwarded.
+   */
+  bool
+  forward();
+
+  /**
+   * Get the total bytes of packets delivered to the faces in the range.
+   */
+  uint64_t
+  getBytesReceived(size_t beginIndex, size_t endIndex) const
+  {
+    uint64_t result = 0;
+    for (size_t i = beginIndex; i < endIndex; ++i)
+      result += nBytesReceived_[i];
+    return result;
+  }
+
+private:
+  class PitEntry {
+  public:
+    PitEntry(const ptr_lib::shared_ptr<Interest>& interest, size_t faceIndex)
+    : interest_(interest), faceIndex_(faceIndex),
+      expireTime_(getNowMilliseconds() + interest->getInterestLifetimeMilliseconds())
+    {
+    }
+
+    ptr_lib::shared_ptr<Interest> interest_;
+    size_t faceIndex_;
+    double expireTime_;
+  };
+
+  void
+  deliver(size_t faceIndex, const Blob& encoding);
+
+  void
+  onInterest(size_t faceIndex, const Blob& encoding);
+
+  void
+  onData(const Blob& encoding);
+
+  KeyChain& keyChain_;
+  vector<BusTransport*> transports_;
+  // fib_[i] has the prefixes registered by face i.
+  vector<vector<Name> > fib_;
+  vector<uint64_t> nBytesReceived_;
+  list<PitEntry> pit_;
+  deque<pair<size_t, Blob> > queue_;
+};
+
+/**
+ * BusTransport extends Transport to send packets through a ForwarderBus.
+ */
+class BusTransport : public Transport {
+public:
+  BusTransport(ForwarderBus& bus)
+  : bus_(bus), elementListener_(0)
+  {
+    faceIndex_ = bus_.addTransport(this);
+  }
+
+  virtual bool
+  isLocal(const Transport::ConnectionInfo& connectionInfo) { return true; }
+
+  virtual bool
+  isAsync() { return false; }
+
+  virtual void
+  connect
+    (const Transport::ConnectionInfo& connectionInfo,
+     ElementListener& elementListener, const OnConnected& onConnected)
+  {
+    elementListener_ = &elementListener;
+    if (onConnected)
+      onConnected();
+  }
+
+  virtual void
+  send(const uint8_t *data, size_t dataLength)
+  {
+    bus_.send(faceIndex_, data, dataLength);
+  }
+
+  virtual void
+  processEvents() {}
+
+  virtual bool
+  getIsConnected() { return elementListener_ != 0; }
+
+  /**
+   * Deliver the encoded packet to the Face as if it came from the forwarder.
+   */
+  void
+  receive(const Blob& encoding)
+  {
+    elementListener_->onReceivedElement(encoding.buf(), encoding.size());
+  }
+
+private:
+  ForwarderBus& bus_;
+  size_t faceIndex_;
+  ElementListener* elementListener_;
+};
+
+bool
+ForwarderBus::forward()
+{
+  bool didForward = false;
+  while (queue_.size() > 0) {
+    pair<size_t, Blob> packet = queue_.front();
+    queue_.pop_front();
+    didForward = true;
+
+    if (packet.second.size() == 0)
+      continue;
+    if (packet.second.buf()[0] == ndn_Tlv_Interest)
+      onInterest(packet.first, packet.second);
+    else if (packet.second.buf()[0] == ndn_Tlv_Data)
+      onData(packet.second);
+  }
+
+  return didForward;
+}
+
+void
+ForwarderBus::deliver(size_t faceIndex, const Blob& encoding)
+{
+  nBytesReceived_[faceIndex] += encoding.size();
+  transports_[faceIndex]->receive(encoding);
+}
+
+void
+ForwarderBus::onInterest(size_t faceIndex, const Blob& encoding)
+{
+  ptr_lib::shared_ptr<Interest> interest(new Interest());
+  interest->wireDecode(encoding);
+
+  static const Name registerPrefix("/localhost/nfd/rib/register");
+  if (registerPrefix.match(interest->getName())) {
+    ControlParameters controlParameters;
+    controlParameters.wireDecode
+      (interest->getName().get(registerPrefix.size()).getValue(),
+       *TlvWireFormat::get());
+    fib_[faceIndex].push_back(controlParameters.getName());
+
+    Data response(interest->getName());
+    response.setContent(ControlResponse().setStatusCode(200)
+      .setStatusText("OK").wireEncode());
+    keyChain_.signWithSha256(response);
+    deliver(faceIndex, response.wireEncode());
+    return;
+  }
+
+  pit_.push_back(PitEntry(interest, faceIndex));
+  for (size_t i = 0; i < fib_.size(); ++i) {
+    if (i == faceIndex)
+      continue;
+
+    for (size_t j = 0; j < fib_[i].size(); ++j) {
+      if (fib_[i][j].match(interest->getName())) {
+        deliver(i, encoding);
+        break;
+      }
+    }
+  }
+}
+
+void
+ForwarderBus::onData(const Blob& encoding)
+{
+  Data data;
+  data.wireDecode(encoding);
+  double now = getNowMilliseconds();
+  vector<bool> isDelivered(transports_.size(), false);
+
+  for (list<PitEntry>::iterator entry = pit_.begin(); entry != pit_.end();) {
+    if (entry->expireTime_ < now)
+      pit_.erase(entry++);
+    else if (entry->interest_->matchesData(data)) {
+      if (!isDelivered[entry->faceIndex_]) {
+        isDelivered[entry->faceIndex_] = true;
+        deliver(entry->faceIndex_, encoding);
+      }
+      pit_.erase(entry++);
+    }
+    else
+      ++entry;
+  }
+}
+
+/**
+ * BenchmarkConsumer has a PartialPSyncConsumer with a Face on the bus, and
+ * subscribes to its prefixes when it receives the hello reply.
+ */
+class BenchmarkConsumer {
+public:
+  BenchmarkConsumer
+    (ForwarderBus& bus, const Name& syncPrefix, const vector<Name>& prefixes)
+  : transport_(new BusTransport(bus)),
+    face_(transport_, ptr_lib::make_shared<Transport::ConnectionInfo>()),
+    consumer_
+      (face_, syncPrefix, bind(&BenchmarkConsumer::onReceiveHelloData, this, _1),
+       bind(&BenchmarkConsumer::onUpdate, this, _1), prefixes.size()),
+    prefixes_(prefixes), nUpdates_(0)
+  {
+  }
+
+  void
+  onReceiveHelloData(const ptr_lib::shared_ptr<vector<Name> >& prefixes)
+  {
+    for (size_t i = 0; i < prefixes_.size(); ++i)
+      consumer_.addSubscription(prefixes_[i]);
+    consumer_.sendSyncInterest();
+  }
+
+  void
+  onUpdate
+    (const ptr_lib::shared_ptr<vector<ptr_lib::shared_ptr<PSyncMissingDataInfo> > >& updates)
+  {
+    nUpdates_ += updates->size();
+  }
+
+  /**
+   * Check if this has the producer's sequence number for all the prefixes.
+   */
+  bool
+  isUpToDate(const PartialPSync2017Producer& producer) const
+  {
+    for (size_t i = 0; i < prefixes_.size(); ++i) {
+      if (consumer_.getSequenceNo(prefixes_[i]) !=
+          producer.getSequenceNo(prefixes_[i]))
+        return false;
+    }
+
+    return true;
+  }
+
+  ptr_lib::shared_ptr<BusTransport> transport_;
+  Face face_;
+  PartialPSyncConsumer consumer_;
+  vector<Name> prefixes_;
+  uint64_t nUpdates_;
+};
+
+/**
+ * Process events on all the faces and forward packets until the condition is
+ * true or the timeout.
+ * @return The elapsed milliseconds, or -1 for timeout.
+ */
+template<class Condition> static double
+runUntil
+  (ForwarderBus& bus, Face& producerFace,
+   vector<ptr_lib::shared_ptr<BenchmarkConsumer> >& consumers,
+   Condition condition, double timeoutMilliseconds)
+{
+  double startTime = getNowMilliseconds();
+  while (!condition()) {
+    double elapsed = getNowMilliseconds() - startTime;
+    if (elapsed > timeoutMilliseconds)
+      return -1;
+
+    producerFace.processEvents();
+    for (size_t i = 0; i < consumers.size(); ++i)
+      consumers[i]->face_.processEvents();
+    if (!bus.forward())
+      // Wait for a timer such as an Interest timeout.
+      usleep(1000);
+  }
+
+  return getNowMilliseconds() - startTime;
+}
+
+class AllHaveHelloData {
+public:
+  AllHaveHelloData(const vector<ptr_lib::shared_ptr<BenchmarkConsumer> >& consumers)
+  : consumers_(consumers)
+  {
+  }
+
+  bool
+  operator()() const
+  {
+    for (size_t i = 0; i < consumers_.size(); ++i) {
+      if (!consumers_[i]->consumer_.isSubscribed(consumers_[i]->prefixes_[0]))
+        return false;
+    }
+
+    return true;
+  }
+
+  const vector<ptr_lib::shared_ptr<BenchmarkConsumer> >& consumers_;
+};
+
+class AllUpToDate {
+public:
+  AllUpToDate
+    (const vector<ptr_lib::shared_ptr<BenchmarkConsumer> >& consumers,
+     const PartialPSync2017Producer& producer)
+  : consumers_(consumers), producer_(producer)
+  {
+  }
+
+  bool
+  operator()() const
+  {
+    for (size_t i = 0; i < consumers_.size(); ++i) {
+      if (!consumers_[i]->isUpToDate(producer_))
+        return false;
+    }
+
+    return true;
+  }
+
+  const vector<ptr_lib::shared_ptr<BenchmarkConsumer> >& consumers_;
+  const PartialPSync2017Producer& producer_;
+};
+
+int
+main(int argc, char** argv)
+{
+  const size_t nPrefixes = 10000;
+  const size_t nConsumers = 50;
+  const size_t nSubscriptionsPerConsumer = 5;
+  const int nRounds = 10;
+  const size_t nPublishesPerRound = 50;
+  // The encoded IBLT must fit in the Interest name, so it is sized for the
+  // differences between sync rounds, not for all the prefixes.
+  const size_t expectedNEntries = 100;
+  const Name syncPrefix("/benchmark/sync");
+
+  try {
+    Interest::setDefaultCanBePrefix(true);
+    KeyChain keyChain("pib-memory:", "tpm-memory:");
+    keyChain.createIdentityV2(Name("/benchmark/producer"));
+    ForwarderBus bus(keyChain);
+
+    // Face index 0 is the producer.
+    Face producerFace
+      (ptr_lib::make_shared<BusTransport>(bus),
+       ptr_lib::make_shared<Transport::ConnectionInfo>());
+    producerFace.setCommandSigningInfo
+      (keyChain, keyChain.getDefaultCertificateName());
+    PartialPSync2017Producer producer
+      (expectedNEntries, producerFace, syncPrefix, Name(), keyChain, 1000, 1000,
+       SigningInfo(SigningInfo::SIGNER_TYPE_SHA256));
+
+    vector<Name> prefixes;
+    for (size_t i = 0; i < nPrefixes; ++i) {
+      prefixes.push_back(Name("/benchmark/stream").appendNumber(i));
+      producer.addUserNode(prefixes.back());
+      producer.publishName(prefixes.back());
+    }
+
+    srand(1);
+    vector<ptr_lib::shared_ptr<BenchmarkConsumer> > consumers;
+    for (size_t i = 0; i < nConsumers; ++i) {
+      vector<Name> subscriptions;
+      for (size_t j = 0; j < nSubscriptionsPerConsumer; ++j)
+        subscriptions.push_back(prefixes[rand() % nPrefixes]);
+      consumers.push_back(ptr_lib::make_shared<BenchmarkConsumer>
+        (bus, syncPrefix, subscriptions));
+    }
+
+    // Answer the producer's prefix registration.
+    bus.forward();
+
+    for (size_t i = 0; i < consumers.size(); ++i)
+      consumers[i]->consumer_.sendHelloInterest();
+    double helloMilliseconds = runUntil
+      (bus, producerFace, consumers, AllHaveHelloData(consumers), 10000);
+    uint64_t helloBytes = bus.getBytesReceived(1, 1 + nConsumers);
+    cout << nConsumers << " consumers got the hello reply with " << nPrefixes <<
+      " prefixes in " << helloMilliseconds << " ms, " <<
+      helloBytes / nConsumers << " bytes per consumer" << endl;
+
+    double totalMilliseconds = 0;
+    uint64_t totalSyncBytes = 0;
+    uint64_t totalFullSyncBytes = 0;
+    for (int round = 0; round < nRounds; ++round) {
+      uint64_t startBytes = bus.getBytesReceived(1, 1 + nConsumers);
+      for (size_t i = 0; i <= nPublishesPerRound; ++i) {
+        // Make sure each round updates at least one subscription.
+        const Name& prefix = (i == nPublishesPerRound ?
+          consumers[round % nConsumers]->prefixes_[0] :
+          prefixes[rand() % nPrefixes]);
+        producer.publishName(prefix);
+        // A full sync member would receive at least the encoding of each name.
+        totalFullSyncBytes += Name(prefix).appendNumber
+          (producer.getSequenceNo(prefix)).wireEncode().size();
+      }
+
+      double milliseconds = runUntil
+        (bus, producerFace, consumers, AllUpToDate(consumers, producer), 10000);
+      if (milliseconds < 0) {
+        cout << "Round " << round << " timed out" << endl;
+        return 1;
+      }
+      totalMilliseconds += milliseconds;
+      totalSyncBytes += bus.getBytesReceived(1, 1 + nConsumers) - startBytes;
+    }
+
+    cout << "Partial sync: " << nRounds << " rounds of " << nPublishesPerRound <<
+      " publishes converged in " << totalMilliseconds / nRounds <<
+      " ms per round, " << totalSyncBytes / (nRounds * nConsumers) <<
+      " bytes per consumer per round" << endl;
+    cout << "Full sync would send at least " << totalFullSyncBytes / nRounds <<
+      " bytes per member per round" << endl;
+  } catch (const std::exception& ex) {
+    cout << "exception: " << ex.what() << endl;
+    return 1;
+  }
+
+  return 0;
+}
+
+#else // NDN_CPP_HAVE_LIBZ
+
+#include <iostream>
+using namespace std;
+int main(int argc, char** argv)
+{
+  cout <<
+    "This program uses zlib but it is not installed. Install it and ./configure again." <<
+    endl;
+}
+
+#endif // NDN_CPP_HAVE_LIBZ
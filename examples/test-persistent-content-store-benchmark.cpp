@@ -0,0 +1,128 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Regents of the University of California.
+ * @author: Jeff Thompson <jefft0@remap.ucla.edu>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+/**
+ * This measures the rate at which PersistentContentStore adds Data packets to
+ * the log, the time to open the log again as after a restart, the rate at
+ * which it finds Data packets for Interests, and the time to compact the log.
+ * Usage: test-persistent-content-store-benchmark [logFilePath]
+ */
+
+#include <cstdio>
+#include <iostream>
+#include <sys/time.h>
+#include <ndn-cpp/util/persistent-content-store.hpp>
+
+using namespace std;
+using namespace ndn;
+
+static double
+getNowMilliseconds()
+{
+  struct timeval t;
+  gettimeofday(&t, 0);
+  return t.tv_sec * 1000.0 + t.tv_usec / 1000.0;
+}
+
+static Name
+makeName(size_t i)
+{
+  const size_t nSegments = 10;
+  return Name("/test/store").appendNumber(i / nSegments).appendSegment
+    (i % nSegments);
+}
+
+int
+main(int argc, char** argv)
+{
+  string logFilePath = "test-persistent-content-store.log";
+  if (argc > 1)
+    logFilePath = argv[1];
+  remove(logFilePath.c_str());
+
+  try {
+    const size_t nData = 200000;
+    vector<uint8_t> value(1000);
+
+    // Encode first, like a producer which signs the Data packets.
+    vector<ptr_lib::shared_ptr<Data> > dataList;
+    for (size_t i = 0; i < nData; ++i) {
+      ptr_lib::shared_ptr<Data> data(new Data(makeName(i)));
+      data->setContent(value);
+      data->getMetaInfo().setFreshnessPeriod(3600 * 1000.0);
+      data->wireEncode();
+      dataList.push_back(data);
+    }
+
+    {
+      PersistentContentStore store(logFilePath);
+      store.setAutoCompactionRatio(1.0);
+      double startTime = getNowMilliseconds();
+      for (size_t i = 0; i < nData; ++i)
+        store.add(*dataList[i]);
+      store.flush();
+      double durationSeconds = (getNowMilliseconds() - startTime) / 1000.0;
+      cout << "Add " << nData << " Data packets: Adds/s: " <<
+        (nData / durationSeconds) << ", log size " << store.getLogSize() <<
+        endl;
+    }
+
+    double startTime = getNowMilliseconds();
+    PersistentContentStore store(logFilePath);
+    store.setAutoCompactionRatio(1.0);
+    cout << "Open the log: seconds: " <<
+      ((getNowMilliseconds() - startTime) / 1000.0) << endl;
+
+    const size_t nInterests = 1000000;
+    vector<ptr_lib::shared_ptr<Interest> > interests;
+    for (size_t i = 0; i < 1000; ++i)
+      interests.push_back(ptr_lib::make_shared<Interest>
+        (makeName((i * 7919) % nData)));
+    size_t nFound = 0;
+    startTime = getNowMilliseconds();
+    for (size_t i = 0; i < nInterests; ++i) {
+      const uint8_t* encoding;
+      size_t encodingLength;
+      if (store.find(*interests[i % interests.size()], encoding, encodingLength))
+        ++nFound;
+    }
+    double durationSeconds = (getNowMilliseconds() - startTime) / 1000.0;
+    if (nFound != nInterests)
+      throw runtime_error("Not all Interests were answered");
+    cout << "Find: Interests/s: " << (nInterests / durationSeconds) << endl;
+
+    // Replace half the Data packets, then compact.
+    for (size_t i = 0; i < nData; i += 2)
+      store.add(*dataList[i]);
+    uint64_t logSize = store.getLogSize();
+    startTime = getNowMilliseconds();
+    store.startCompaction();
+    store.waitForCompaction();
+    cout << "Compact from " << logSize << " to " << store.getLogSize() <<
+      " bytes: seconds: " << ((getNowMilliseconds() - startTime) / 1000.0) <<
+      endl;
+  } catch (std::exception& e) {
+    cout << "exception: " << e.what() << endl;
+  }
+
+  remove(logFilePath.c_str());
+  return 0;
+}
@@ -0,0 +1,127 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Regents of the University of California.
+ * @author: Jeff Thompson <jefft0@remap.ucla.edu>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+
+/**
+ * This measures the rate at which FullPSync2017 can make sync Interests with a
+ * 40000-entry IBLT for different zlib compression levels, both when the IBLT
+ * changes before each Interest (so that it must be encoded again) and when it
+ * does not change (so that the saved encoding is used).
+ */
+
+// Only compile if ndn-cpp-config.h defines NDN_CPP_HAVE_LIBZ 1.
+#include <ndn-cpp/ndn-cpp-config.h>
+#if NDN_CPP_HAVE_LIBZ
+
+#include <iostream>
+#include <sys/time.h>
+#include <ndn-cpp/interest.hpp>
+#include <ndn-cpp/lite/util/crypto-lite.hpp>
+#include "../src/sync/detail/invertible-bloom-lookup-table.hpp"
+
+using namespace std;
+using namespace ndn;
+
+static double
+getNowMilliseconds()
+{
+  struct timeval t;
+  gettimeofday(&t, 0);
+  return t.tv_sec * 1000.0 + t.tv_usec / 1000.0;
+}
+
+/**
+ * Make nInterests sync Interests the same as
+ * FullPSync2017::Impl::sendSyncInterest and print the rate.
+ * @param label The label to print.
+ * @param iblt The IBLT to encode in each sync Interest name.
+ * @param isChanged If true, insert and erase a key before each Interest so
+ * that the IBLT must be encoded again.
+ * @param nInterests The number of Interests to make.
+ */
+static void
+benchmarkSyncInterests
+  (const string& label, InvertibleBloomLookupTable& iblt, bool isChanged,
+   size_t nInterests)
+{
+  Name syncPrefix("/ndn/test/psync");
+  size_t nBytes = 0;
+  double startTime = getNowMilliseconds();
+  for (size_t i = 0; i < nInterests; ++i) {
+    if (isChanged) {
+      iblt.insert(0x12345678);
+      iblt.erase(0x12345678);
+    }
+
+    Name syncInterestName(syncPrefix);
+    syncInterestName.append(iblt.encode());
+    Interest syncInterest(syncInterestName);
+    syncInterest.setInterestLifetimeMilliseconds(1000);
+    syncInterest.refreshNonce();
+    nBytes += syncInterest.wireEncode().size();
+  }
+  double durationSeconds = (getNowMilliseconds() - startTime) / 1000.0;
+
+  cout << "  " << label << ": Interest size " << (nBytes / nInterests) <<
+    " bytes, Interests/s: " << (nInterests / durationSeconds) << endl;
+}
+
+int
+main(int argc, char** argv)
+{
+  try {
+    // Silence the warning from Interest wire encode.
+    Interest::setDefaultCanBePrefix(true);
+
+    const size_t nEntries = 40000;
+    InvertibleBloomLookupTable iblt(nEntries);
+    for (size_t i = 0; i < nEntries; ++i) {
+      string uri = Name("/test/user").appendNumber(i).appendNumber(1).toUri();
+      iblt.insert(CryptoLite::murmurHash3
+        (InvertibleBloomLookupTable::N_HASHCHECK, uri.data(), uri.size()));
+    }
+
+    int levels[] = { 9, -1, 1, 0 };
+    for (size_t i = 0; i < sizeof(levels) / sizeof(levels[0]); ++i) {
+      iblt.setCompressionLevel(levels[i]);
+      cout << "Compression level " << levels[i] << ":" << endl;
+      benchmarkSyncInterests("Changed IBLT", iblt, true, 50);
+      benchmarkSyncInterests("Unchanged IBLT", iblt, false, 5000);
+    }
+  } catch (std::exception& e) {
+    cout << "exception: " << e.what() << endl;
+  }
+  return 0;
+}
+
+#else // NDN_CPP_HAVE_LIBZ
+
+#include <iostream>
+
+using namespace std;
+
+int main(int argc, char** argv)
+{
+  cout <<
+    "This program uses zlib but it is not installed. Install it and ./configure again." << endl;
+}
+
+#endif // NDN_CPP_HAVE_LIBZ
@@ -0,0 +1,154 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Regents of the University of California.
+ * @author: Jeff Thompson <jefft0@remap.ucla.edu>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+
+/**
+ * This measures the rate at which FullPSync2017 can check its pending sync
+ * Interests when it publishes a name. For each of 1000 pending Interests, it
+ * gets the difference of the pending Interest's IBLT from our IBLT and lists
+ * the entries. This compares making a new difference IBLT and listing into
+ * sets for each pending Interest with reusing a scratch IBLT and peeling into
+ * sorted vectors.
+ */
+
+// Only compile if ndn-cpp-config.h defines NDN_CPP_HAVE_LIBZ 1.
+#include <ndn-cpp/ndn-cpp-config.h>
+#if NDN_CPP_HAVE_LIBZ
+
+#include <iostream>
+#include <stdexcept>
+#include <sys/time.h>
+#include <ndn-cpp/name.hpp>
+#include <ndn-cpp/lite/util/crypto-lite.hpp>
+#include "../src/sync/detail/invertible-bloom-lookup-table.hpp"
+
+using namespace std;
+using namespace ndn;
+
+static double
+getNowMilliseconds()
+{
+  struct timeval t;
+  gettimeofday(&t, 0);
+  return t.tv_sec * 1000.0 + t.tv_usec / 1000.0;
+}
+
+static uint32_t
+getHash(const string& prefix, size_t i)
+{
+  string uri = Name(prefix).appendNumber(i).appendNumber(1).toUri();
+  return CryptoLite::murmurHash3
+    (InvertibleBloomLookupTable::N_HASHCHECK, uri.data(), uri.size());
+}
+
+/**
+ * Print the rate of checking pending Interests.
+ * @param label The label to print.
+ * @param startTime The start time from getNowMilliseconds().
+ * @param nChecked The number of pending Interests which were checked.
+ * @param nEntries The total number of entries which were listed.
+ */
+static void
+printRate
+  (const string& label, double startTime, size_t nChecked, size_t nEntries)
+{
+  double durationSeconds = (getNowMilliseconds() - startTime) / 1000.0;
+  cout << "  " << label << ": " << nEntries << " entries, pending Interests/s: "
+       << (nChecked / durationSeconds) << endl;
+}
+
+int
+main(int argc, char** argv)
+{
+  try {
+    const size_t expectedNEntries = 1000;
+    const size_t nPending = 1000;
+    const size_t nRepeat = 20;
+
+    InvertibleBloomLookupTable ownIblt(expectedNEntries);
+    for (size_t i = 0; i < expectedNEntries; ++i)
+      ownIblt.insert(getHash("/test/own", i));
+
+    // Each pending Interest is missing 1 to 5 of our names and has 1 name of
+    // its own.
+    vector<ptr_lib::shared_ptr<InvertibleBloomLookupTable> > pendingIblts;
+    for (size_t i = 0; i < nPending; ++i) {
+      ptr_lib::shared_ptr<InvertibleBloomLookupTable> iblt
+        (new InvertibleBloomLookupTable(ownIblt));
+      for (size_t j = 0; j < 1 + i % 5; ++j)
+        iblt->erase(getHash("/test/own", (i + j * 97) % expectedNEntries));
+      iblt->insert(getHash("/test/other", i));
+      pendingIblts.push_back(iblt);
+    }
+
+    cout << nPending << " pending Interests, expected entries " <<
+      expectedNEntries << ":" << endl;
+
+    size_t nEntries = 0;
+    double startTime = getNowMilliseconds();
+    for (size_t repeat = 0; repeat < nRepeat; ++repeat) {
+      for (size_t i = 0; i < nPending; ++i) {
+        ptr_lib::shared_ptr<InvertibleBloomLookupTable> difference =
+          ownIblt.difference(*pendingIblts[i]);
+        set<uint32_t> positive;
+        set<uint32_t> negative;
+        if (!difference->listEntries(positive, negative))
+          throw runtime_error("listEntries failed");
+        nEntries += positive.size() + negative.size();
+      }
+    }
+    printRate("New difference, listEntries", startTime, nRepeat * nPending,
+              nEntries);
+
+    InvertibleBloomLookupTable difference(0);
+    vector<uint32_t> positive;
+    vector<uint32_t> negative;
+    nEntries = 0;
+    startTime = getNowMilliseconds();
+    for (size_t repeat = 0; repeat < nRepeat; ++repeat) {
+      for (size_t i = 0; i < nPending; ++i) {
+        ownIblt.difference(*pendingIblts[i], difference);
+        if (!difference.peelEntries(positive, negative))
+          throw runtime_error("peelEntries failed");
+        nEntries += positive.size() + negative.size();
+      }
+    }
+    printRate("Scratch difference, peelEntries", startTime, nRepeat * nPending,
+              nEntries);
+  } catch (std::exception& e) {
+    cout << "exception: " << e.what() << endl;
+  }
+  return 0;
+}
+
+#else // NDN_CPP_HAVE_LIBZ
+
+#include <iostream>
+
+using namespace std;
+
+int main(int argc, char** argv)
+{
+  cout <<
+    "This program uses zlib but it is not installed. Install it and ./configure again." << endl;
+}
+
+#endif // NDN_CPP_HAVE_LIBZ
@@ -0,0 +1,141 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Regents of the University of California.
+ * @author: Jeff Thompson <jefft0@remap.ucla.edu>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+
+/**
+ * This measures the rate at which PSyncProducerBase inserts names into its
+ * IBLT and name table, as done for each FullPSync2017 publishName, when
+ * hashing the name URI and when hashing the name TLV wire encoding. It then
+ * measures the rate of looking up each name by its hash and removing it.
+ */
+
+// Only compile if ndn-cpp-config.h defines NDN_CPP_HAVE_LIBZ 1.
+#include <ndn-cpp/ndn-cpp-config.h>
+#if NDN_CPP_HAVE_LIBZ
+
+#include <iostream>
+#include <stdexcept>
+#include <sys/time.h>
+#include <ndn-cpp/sync/psync-producer-base.hpp>
+
+using namespace std;
+using namespace ndn;
+
+static double
+getNowMilliseconds()
+{
+  struct timeval t;
+  gettimeofday(&t, 0);
+  return t.tv_sec * 1000.0 + t.tv_usec / 1000.0;
+}
+
+/**
+ * BenchmarkProducer extends PSyncProducerBase to call its protected methods.
+ */
+class BenchmarkProducer : public PSyncProducerBase {
+public:
+  BenchmarkProducer(size_t expectedNEntries, NameHashMode nameHashMode)
+  : PSyncProducerBase(expectedNEntries, Name("/ndn/test/psync"), 1000)
+  {
+    setNameHashMode(nameHashMode);
+  }
+
+  void
+  publish(const Name& name) { insertIntoIblt(name); }
+
+  void
+  remove(const Name& name) { removeFromIblt(name); }
+
+  bool
+  lookUp(const Name& name) { return findNameByHash(getNameHash(name)) != 0; }
+};
+
+/**
+ * Publish, look up and remove the names and print the rates.
+ * @param label The label to print.
+ * @param nameHashMode The NameHashMode for the producer.
+ * @param names The names to publish.
+ */
+static void
+benchmarkPublish
+  (const string& label, PSyncProducerBase::NameHashMode nameHashMode,
+   const vector<Name>& names)
+{
+  BenchmarkProducer producer(names.size(), nameHashMode);
+
+  double startTime = getNowMilliseconds();
+  for (size_t i = 0; i < names.size(); ++i)
+    producer.publish(names[i]);
+  double publishSeconds = (getNowMilliseconds() - startTime) / 1000.0;
+
+  startTime = getNowMilliseconds();
+  for (size_t i = 0; i < names.size(); ++i) {
+    if (!producer.lookUp(names[i]))
+      throw runtime_error("Can't find name " + names[i].toUri());
+  }
+  double lookUpSeconds = (getNowMilliseconds() - startTime) / 1000.0;
+
+  startTime = getNowMilliseconds();
+  for (size_t i = 0; i < names.size(); ++i)
+    producer.remove(names[i]);
+  double removeSeconds = (getNowMilliseconds() - startTime) / 1000.0;
+
+  cout << label << ":" << endl;
+  cout << "  Publish names/s: " << (names.size() / publishSeconds) << endl;
+  cout << "  Hash and look up names/s: " << (names.size() / lookUpSeconds) <<
+    endl;
+  cout << "  Remove names/s: " << (names.size() / removeSeconds) << endl;
+}
+
+int
+main(int argc, char** argv)
+{
+  try {
+    const size_t nNames = 200000;
+    // Names like the user prefix and sequence number in FullPSync2017WithUsers.
+    vector<Name> names;
+    for (size_t i = 0; i < nNames; ++i)
+      names.push_back(Name("/ndn/test/user").appendNumber(i % 1000)
+                      .append("data stream").appendNumber(i / 1000));
+
+    benchmarkPublish("Name URI hash", PSyncProducerBase::NAME_HASH_URI, names);
+    benchmarkPublish
+      ("Name wire encoding hash", PSyncProducerBase::NAME_HASH_WIRE_ENCODING,
+       names);
+  } catch (std::exception& e) {
+    cout << "exception: " << e.what() << endl;
+  }
+  return 0;
+}
+
+#else // NDN_CPP_HAVE_LIBZ
+
+#include <iostream>
+
+using namespace std;
+
+int main(int argc, char** argv)
+{
+  cout <<
+    "This program uses zlib but it is not installed. Install it and ./configure again." << endl;
+}
+
+#endif // NDN_CPP_HAVE_LIBZ
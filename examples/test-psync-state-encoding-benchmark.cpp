@@ -0,0 +1,179 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Regents of the University of California.
+ * @author: Jeff Thompson <jefft0@remap.ucla.edu>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+/**
+ * This compares the size in bytes per update and the encoding and decoding
+ * time of the PSyncContent and the compact PSyncCompactContent encodings of
+ * PSyncState for sync replies with different numbers of names: user prefixes
+ * with one sequence number each as in FullPSync2017WithUsers, user prefixes
+ * with several new sequence numbers each, stream names as in
+ * PartialPSync2017Producer, and application names without sequence numbers.
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <sys/time.h>
+#include "../src/sync/detail/psync-state.hpp"
+
+using namespace std;
+using namespace ndn;
+
+static double
+getNowMilliseconds()
+{
+  struct timeval t;
+  gettimeofday(&t, 0);
+  return t.tv_sec * 1000.0 + t.tv_usec / 1000.0;
+}
+
+/**
+ * Get the time to encode and decode the state with the encoding.
+ * @param state The PSyncState to encode.
+ * @param isCompact True for PSyncCompactContent.
+ * @param nIterations The number of times to encode and decode.
+ * @param encodeMicroseconds Set this to the encoding time per name.
+ * @param decodeMicroseconds Set this to the decoding time per name.
+ * @return The encoding.
+ */
+static Blob
+timeEncoding
+  (const PSyncState& state, bool isCompact, int nIterations,
+   double& encodeMicroseconds, double& decodeMicroseconds)
+{
+  Blob encoding;
+  double start = getNowMilliseconds();
+  for (int i = 0; i < nIterations; ++i)
+    encoding = state.wireEncode(isCompact);
+  double nNames = (double)nIterations * state.getContent().size();
+  encodeMicroseconds = (getNowMilliseconds() - start) * 1000.0 / nNames;
+
+  PSyncState decodedState;
+  start = getNowMilliseconds();
+  for (int i = 0; i < nIterations; ++i)
+    decodedState.wireDecode(encoding);
+  decodeMicroseconds = (getNowMilliseconds() - start) * 1000.0 / nNames;
+
+  return encoding;
+}
+
+/**
+ * Print the bytes per update and the time per update for both encodings.
+ * @param label The label to print.
+ * @param state The PSyncState to encode.
+ */
+static void
+benchmarkState(const string& label, const PSyncState& state)
+{
+  size_t nNames = state.getContent().size();
+  // Encode and decode about 200000 names for each encoding.
+  int nIterations = (int)(200000 / nNames) + 1;
+
+  double legacyEncode, legacyDecode, compactEncode, compactDecode;
+  Blob legacy = timeEncoding
+    (state, false, nIterations, legacyEncode, legacyDecode);
+  Blob compact = timeEncoding
+    (state, true, nIterations, compactEncode, compactDecode);
+
+  cout << setw(40) << left << label << right << fixed << setprecision(1) <<
+    setw(8) << (double)legacy.size() / nNames << setw(8) <<
+    (double)compact.size() / nNames << setw(7) <<
+    100.0 * compact.size() / legacy.size() << "%" << setprecision(2) <<
+    setw(8) << legacyEncode << setw(8) << compactEncode << setw(8) <<
+    legacyDecode << setw(8) << compactDecode << endl;
+}
+
+int
+main(int argc, char** argv)
+{
+  try {
+    cout << setw(40) << left << "Names" << right << setw(8) << "B/upd" <<
+      setw(8) << "B/upd" << setw(8) << "" << setw(8) << "enc us" <<
+      setw(8) << "enc us" << setw(8) << "dec us" << setw(8) << "dec us" <<
+      endl;
+    cout << setw(40) << "" << setw(8) << "legacy" << setw(8) << "compact" <<
+      setw(8) << "ratio" << setw(8) << "legacy" << setw(8) << "compact" <<
+      setw(8) << "legacy" << setw(8) << "compact" << endl;
+
+    // Each user prefix has one sequence number, as in FullPSync2017WithUsers.
+    size_t nPrefixes[] = { 1, 10, 100, 1000 };
+    for (size_t i = 0; i < sizeof(nPrefixes) / sizeof(nPrefixes[0]); ++i) {
+      PSyncState state;
+      for (size_t j = 0; j < nPrefixes[i]; ++j) {
+        ostringstream user;
+        user << "user" << j;
+        state.addContent
+          (Name("/ndn/edu/ucla/chat/room1").append(user.str()).appendNumber
+           (1000 + 37 * j));
+      }
+
+      ostringstream label;
+      label << nPrefixes[i] << " user prefixes x 1 seq";
+      benchmarkState(label.str(), state);
+    }
+
+    // Each user prefix has a run of new sequence numbers.
+    size_t nSequenceNos[] = { 5, 50 };
+    for (size_t i = 0; i < sizeof(nSequenceNos) / sizeof(nSequenceNos[0]); ++i) {
+      PSyncState state;
+      for (size_t j = 0; j < 100; ++j) {
+        ostringstream user;
+        user << "user" << j;
+        Name prefix("/ndn/edu/ucla/chat/room1");
+        prefix.append(user.str());
+        for (size_t k = 0; k < nSequenceNos[i]; ++k)
+          state.addContent(Name(prefix).appendNumber(1000 + 37 * j + k));
+      }
+
+      ostringstream label;
+      label << "100 user prefixes x " << nSequenceNos[i] << " seq";
+      benchmarkState(label.str(), state);
+    }
+
+    // Stream names as in PartialPSync2017Producer.
+    {
+      PSyncState state;
+      for (size_t j = 0; j < 100; ++j) {
+        ostringstream stream;
+        stream << "stream-" << j;
+        state.addContent
+          (Name("/ndn/org/example/sensors").append(stream.str()).appendNumber
+           (j * 65537));
+      }
+      benchmarkState("100 partial sync stream names", state);
+    }
+
+    // Application names as in FullPSync2017 without sequence numbers.
+    {
+      PSyncState state;
+      for (size_t j = 0; j < 100; ++j) {
+        ostringstream message;
+        message << "msg-" << setw(8) << setfill('0') << hex << (j * 2654435761U);
+        state.addContent
+          (Name("/ndn/edu/ucla/chat/room1/messages").append(message.str()));
+      }
+      benchmarkState("100 names without sequence numbers", state);
+    }
+  } catch (std::exception& e) {
+    cout << "exception: " << e.what() << endl;
+  }
+  return 0;
+}
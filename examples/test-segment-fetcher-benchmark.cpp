@@ -0,0 +1,270 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Regents of the University of California.
+ * @author: Jeff Thompson <jefft0@remap.ucla.edu>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+/**
+ * This measures the goodput of SegmentFetcher over a simulated loopback link
+ * with a fixed round-trip time and a bottleneck with a drop-tail queue,
+ * comparing stop-and-wait with pipelines of a constant window size, AIMD and
+ * CUBIC.
+ */
+
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <unistd.h>
+#include <sys/time.h>
+#include <ndn-cpp/util/segment-fetcher.hpp>
+
+using namespace std;
+using namespace ndn;
+using namespace ndn::func_lib;
+
+static double
+getNowMilliseconds()
+{
+  struct timeval t;
+  gettimeofday(&t, 0);
+  return t.tv_sec * 1000.0 + t.tv_usec / 1000.0;
+}
+
+/**
+ * LoopbackFace extends Face to answer Interests from a list of segments after
+ * a simulated delay, without a forwarder. Each Data packet waits for the
+ * bottleneck link, which sends segmentsPerSecond packets. If the queue for the
+ * link has more than queueLimit packets, the Data is dropped and the Interest
+ * times out after its lifetime.
+ */
+class LoopbackFace : public Face {
+public:
+  LoopbackFace
+    (const vector<ptr_lib::shared_ptr<Data> >& segments,
+     double rttMilliseconds, double segmentsPerSecond, double queueLimit)
+  : Face("localhost"), segments_(segments), rttMilliseconds_(rttMilliseconds),
+    segmentsPerSecond_(segmentsPerSecond), queueLimit_(queueLimit),
+    linkFreeTime_(0), nextPendingInterestId_(1), nDropped_(0)
+  {
+  }
+
+  virtual uint64_t
+  expressInterest
+    (const Interest& interest, const OnData& onData, const OnTimeout& onTimeout,
+     const OnNetworkNack& onNetworkNack,
+     WireFormat& wireFormat = *WireFormat::getDefaultWireFormat())
+  {
+    double now = getNowMilliseconds();
+    ptr_lib::shared_ptr<Event> event(new Event());
+    event->pendingInterestId_ = nextPendingInterestId_++;
+    event->interest_ = ptr_lib::make_shared<Interest>(interest);
+    event->onData_ = onData;
+    event->onTimeout_ = onTimeout;
+
+    // The Interest to discover the version has no segment number.
+    const Name& name = interest.getName();
+    size_t segment = 0;
+    if (name.size() > 0 && name.get(-1).isSegment())
+      segment = (size_t)name.get(-1).toSegment();
+    if (segment < segments_.size())
+      event->data_ = segments_[segment];
+
+    // The Data arrives at the bottleneck after half the RTT.
+    double arrivalTime = now + rttMilliseconds_ / 2;
+    double queueLength = max(0.0, linkFreeTime_ - arrivalTime) *
+      segmentsPerSecond_ / 1000.0;
+    double time;
+    if (event->data_ && queueLength <= queueLimit_) {
+      linkFreeTime_ = max(linkFreeTime_, arrivalTime) +
+        1000.0 / segmentsPerSecond_;
+      time = linkFreeTime_ + rttMilliseconds_ / 2;
+    }
+    else {
+      if (event->data_)
+        ++nDropped_;
+      event->data_.reset();
+      time = now + interest.getInterestLifetimeMilliseconds();
+    }
+
+    events_.insert(make_pair(time, event));
+    return event->pendingInterestId_;
+  }
+
+  virtual void
+  removePendingInterest(uint64_t pendingInterestId)
+  {
+    for (multimap<double, ptr_lib::shared_ptr<Event> >::iterator i =
+           events_.begin();
+         i != events_.end(); ++i) {
+      if (i->second->pendingInterestId_ == pendingInterestId) {
+        events_.erase(i);
+        return;
+      }
+    }
+  }
+
+  /**
+   * Call the callbacks of the events which are due.
+   */
+  virtual void
+  processEvents()
+  {
+    double now = getNowMilliseconds();
+    while (events_.size() > 0 && events_.begin()->first <= now) {
+      ptr_lib::shared_ptr<Event> event = events_.begin()->second;
+      events_.erase(events_.begin());
+
+      if (event->data_)
+        event->onData_(event->interest_, event->data_);
+      else
+        event->onTimeout_(event->interest_);
+    }
+  }
+
+  size_t
+  getDroppedCount() const { return nDropped_; }
+
+private:
+  class Event {
+  public:
+    uint64_t pendingInterestId_;
+    ptr_lib::shared_ptr<Interest> interest_;
+    ptr_lib::shared_ptr<Data> data_;
+    OnData onData_;
+    OnTimeout onTimeout_;
+  };
+
+  vector<ptr_lib::shared_ptr<Data> > segments_;
+  double rttMilliseconds_;
+  double segmentsPerSecond_;
+  double queueLimit_;
+  // The time when the bottleneck link finishes sending the queued packets.
+  double linkFreeTime_;
+  uint64_t nextPendingInterestId_;
+  size_t nDropped_;
+  // The key is the time to call the callback.
+  multimap<double, ptr_lib::shared_ptr<Event> > events_;
+};
+
+static void
+onComplete(const Blob& content, Blob& result) { result = content; }
+
+static void
+onError
+  (SegmentFetcher::ErrorCode errorCode, const string& message, bool& isError)
+{
+  cout << "Error " << errorCode << ": " << message << endl;
+  isError = true;
+}
+
+/**
+ * Fetch the segments over a new LoopbackFace and print the goodput.
+ * @param label The label to print.
+ * @param segments The segments to fetch.
+ * @param options The pipeline options, or null for stop-and-wait.
+ */
+static void
+benchmarkFetch
+  (const string& label, const vector<ptr_lib::shared_ptr<Data> >& segments,
+   const SegmentFetcher::Options* options)
+{
+  // 8 ms RTT with a bottleneck of 10000 segments per second, so the
+  // bandwidth-delay product is 80 segments.
+  LoopbackFace face(segments, 8.0, 10000.0, 100.0);
+  Blob content;
+  bool isError = false;
+
+  Interest interest(segments[0]->getName().getPrefix(-2));
+  interest.setInterestLifetimeMilliseconds(1000);
+  double startTime = getNowMilliseconds();
+  if (options)
+    SegmentFetcher::fetch
+      (face, interest, SegmentFetcher::DontVerifySegment,
+       bind(&onComplete, _1, ref(content)), bind(&onError, _1, _2, ref(isError)),
+       *options);
+  else
+    SegmentFetcher::fetch
+      (face, interest, SegmentFetcher::DontVerifySegment,
+       bind(&onComplete, _1, ref(content)), bind(&onError, _1, _2, ref(isError)));
+
+  while (content.isNull() && !isError) {
+    face.processEvents();
+    // We need to sleep for a few milliseconds so we don't use 100% of the CPU.
+    usleep(100);
+  }
+  double durationSeconds = (getNowMilliseconds() - startTime) / 1000.0;
+
+  if (isError)
+    return;
+  cout << label << ": Duration sec, goodput MB/s, dropped: " << durationSeconds <<
+    ", " << (content.size() / durationSeconds / 1000000.0) << ", " <<
+    face.getDroppedCount() << endl;
+}
+
+int
+main(int argc, char** argv)
+{
+  try {
+    const size_t nSegments = 2000;
+    const size_t segmentSize = 8000;
+    Name versionedPrefix = Name("/test/object").appendVersion(1);
+    vector<ptr_lib::shared_ptr<Data> > segments;
+    vector<uint8_t> value(segmentSize);
+    for (size_t i = 0; i < nSegments; ++i) {
+      ptr_lib::shared_ptr<Data> segment
+        (new Data(Name(versionedPrefix).appendSegment(i)));
+      segment->setContent(value);
+      segment->getMetaInfo().setFinalBlockId
+        (Name::Component::fromSegment(nSegments - 1));
+      segments.push_back(segment);
+    }
+
+    cout << "Segments: " << nSegments << " of " << segmentSize << " bytes" << endl;
+    // Stop-and-wait takes one RTT per segment, so only fetch some segments.
+    vector<ptr_lib::shared_ptr<Data> > firstSegments
+      (segments.begin(), segments.begin() + nSegments / 10);
+    for (size_t i = 0; i < firstSegments.size(); ++i) {
+      ptr_lib::shared_ptr<Data> segment(new Data(*firstSegments[i]));
+      segment->getMetaInfo().setFinalBlockId
+        (Name::Component::fromSegment(firstSegments.size() - 1));
+      firstSegments[i] = segment;
+    }
+    benchmarkFetch("Stop-and-wait (1/10 of the segments)", firstSegments, 0);
+
+    int windows[] = { 1, 4, 16, 64 };
+    for (size_t i = 0; i < sizeof(windows) / sizeof(windows[0]); ++i) {
+      SegmentFetcher::Options options;
+      options.setInitialWindow(windows[i]).setUseConstantWindow(true)
+        .setMinRto(50.0);
+      ostringstream label;
+      label << "Constant window " << windows[i];
+      benchmarkFetch(label.str(), segments, &options);
+    }
+
+    SegmentFetcher::Options aimdOptions;
+    aimdOptions.setMinRto(50.0);
+    benchmarkFetch("AIMD", segments, &aimdOptions);
+
+    SegmentFetcher::Options cubicOptions;
+    cubicOptions.setUseCubic(true).setMinRto(50.0);
+    benchmarkFetch("CUBIC", segments, &cubicOptions);
+  } catch (std::exception& e) {
+    cout << "exception: " << e.what() << endl;
+  }
+  return 0;
+}
@@ -0,0 +1,96 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Regents of the University of California.
+ * @author: Jeff Thompson <jefft0@remap.ucla.edu>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+/**
+ * This measures the rate in MB/s at which SegmentPublisher segments and signs
+ * a large object with RSA, ECDSA and SHA-256 digest signatures for different
+ * numbers of signing threads, and adds the segments to a MemoryContentCache.
+ */
+
+#include <iostream>
+#include <ndn-cpp/util/memory-content-cache.hpp>
+#include <ndn-cpp/util/segment-publisher.hpp>
+
+using namespace std;
+using namespace ndn;
+using namespace ndn::func_lib;
+
+static void
+onSegment(const Data& segment, MemoryContentCache& cache)
+{
+  cache.add(segment);
+}
+
+/**
+ * Publish the content with each number of threads and print the throughput.
+ * @param label The label to print.
+ * @param keyChain The KeyChain for signing.
+ * @param signingInfo The SigningInfo for the segments.
+ * @param content The content to publish.
+ */
+static void
+benchmarkSigning
+  (const string& label, KeyChain& keyChain, const SigningInfo& signingInfo,
+   const Blob& content)
+{
+  cout << label << ":" << endl;
+  size_t nThreadsList[] = { 1, 2, 4, 8 };
+  for (size_t i = 0; i < sizeof(nThreadsList) / sizeof(nThreadsList[0]); ++i) {
+    Face face("localhost");
+    MemoryContentCache cache(&face);
+    SegmentPublisher publisher
+      (keyChain, SegmentPublisher::Options().setNThreads(nThreadsList[i])
+       .setSigningInfo(signingInfo));
+
+    publisher.publish
+      (Name("/test/object"), content, bind(&onSegment, _1, ref(cache)));
+    cout << "  " << nThreadsList[i] << " threads: " <<
+      publisher.getLastSegmentCount() << " segments, MB/s: " <<
+      publisher.getLastThroughput() << endl;
+  }
+}
+
+int
+main(int argc, char** argv)
+{
+  try {
+    KeyChain keyChain("pib-memory:", "tpm-memory:");
+    vector<uint8_t> value(20 * 1000 * 1000);
+    for (size_t i = 0; i < value.size(); ++i)
+      value[i] = (uint8_t)i;
+    Blob content(value);
+
+    benchmarkSigning
+      ("RSA", keyChain,
+       SigningInfo(keyChain.createIdentityV2(Name("/test/rsa"), RsaKeyParams())),
+       content);
+    benchmarkSigning
+      ("ECDSA", keyChain,
+       SigningInfo(keyChain.createIdentityV2(Name("/test/ecdsa"), EcKeyParams())),
+       content);
+    SigningInfo digestSigningInfo;
+    digestSigningInfo.setSha256Signing();
+    benchmarkSigning("SHA-256 digest", keyChain, digestSigningInfo, content);
+  } catch (std::exception& e) {
+    cout << "exception: " << e.what() << endl;
+  }
+  return 0;
+}
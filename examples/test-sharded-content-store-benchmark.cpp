@@ -0,0 +1,135 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Regents of the University of California.
+ * @author: Jeff Thompson <jefft0@remap.ucla.edu>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+/**
+ * This measures the rate at which worker threads add pre-encoded Data packets
+ * to a ShardedContentStore while the main thread finds Data packets for
+ * Interests, for 1 to N worker threads. To compare with one global lock, it
+ * also measures a store with one shard.
+ * Usage: test-sharded-content-store-benchmark [maxThreads]
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include <pthread.h>
+#include <sys/time.h>
+#include <ndn-cpp/util/sharded-content-store.hpp>
+
+using namespace std;
+using namespace ndn;
+
+static double
+getNowMilliseconds()
+{
+  struct timeval t;
+  gettimeofday(&t, 0);
+  return t.tv_sec * 1000.0 + t.tv_usec / 1000.0;
+}
+
+class WorkerParams {
+public:
+  ShardedContentStore* store_;
+  // The Data packets are already encoded, like a producer which signs them.
+  vector<ptr_lib::shared_ptr<Data> >* dataList_;
+};
+
+static void*
+addDataList(void* arg)
+{
+  WorkerParams& params = *(WorkerParams*)arg;
+  for (size_t i = 0; i < params.dataList_->size(); ++i)
+    params.store_->add(*(*params.dataList_)[i]);
+
+  return 0;
+}
+
+/**
+ * Start nThreads worker threads to add nDataPerThread Data packets each, and
+ * find Data packets on this thread until they finish. Print the rates.
+ */
+static void
+benchmarkThreads(size_t nShards, size_t nThreads, size_t nDataPerThread)
+{
+  ShardedContentStore store(nShards, 2);
+  const size_t nSegments = 10;
+
+  vector<vector<ptr_lib::shared_ptr<Data> > > dataLists(nThreads);
+  vector<uint8_t> value(100);
+  for (size_t t = 0; t < nThreads; ++t) {
+    for (size_t i = 0; i < nDataPerThread; ++i) {
+      // Each object has nSegments segments.
+      ptr_lib::shared_ptr<Data> data(new Data
+        (Name("/test").appendNumber(t * nDataPerThread + i / nSegments)
+         .appendSegment(i % nSegments)));
+      data->setContent(value);
+      data->wireEncode();
+      dataLists[t].push_back(data);
+    }
+  }
+
+  // Interests for the objects which the first worker adds.
+  vector<ptr_lib::shared_ptr<const Interest> > interests;
+  for (size_t i = 0; i < 100; ++i)
+    interests.push_back(ptr_lib::make_shared<Interest>
+      (Name("/test").appendNumber(i).appendSegment(i % nSegments)));
+
+  vector<pthread_t> threads(nThreads);
+  vector<WorkerParams> params(nThreads);
+  double startTime = getNowMilliseconds();
+  for (size_t t = 0; t < nThreads; ++t) {
+    params[t].store_ = &store;
+    params[t].dataList_ = &dataLists[t];
+    pthread_create(&threads[t], 0, addDataList, &params[t]);
+  }
+
+  // Act as the Face thread while the workers add.
+  size_t nFinds = 0;
+  while (store.size() < nThreads * nDataPerThread) {
+    for (size_t i = 0; i < interests.size(); ++i)
+      store.find(*interests[i]);
+    nFinds += interests.size();
+  }
+  double durationSeconds = (getNowMilliseconds() - startTime) / 1000.0;
+
+  for (size_t t = 0; t < nThreads; ++t)
+    pthread_join(threads[t], 0);
+
+  cout << "  Shards " << nShards << ", threads " << nThreads << ": Adds/s: " <<
+    (nThreads * nDataPerThread / durationSeconds) << ", Finds/s: " <<
+    (nFinds / durationSeconds) << endl;
+}
+
+int
+main(int argc, char** argv)
+{
+  size_t maxThreads = 8;
+  if (argc > 1)
+    maxThreads = (size_t)atoi(argv[1]);
+
+  const size_t nDataPerThread = 20000;
+  size_t nShardsList[] = { 1, 64 };
+  for (size_t i = 0; i < sizeof(nShardsList) / sizeof(nShardsList[0]); ++i) {
+    for (size_t nThreads = 1; nThreads <= maxThreads; nThreads *= 2)
+      benchmarkThreads(nShardsList[i], nThreads, nDataPerThread);
+  }
+
+  return 0;
+}
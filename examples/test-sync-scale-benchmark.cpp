@@ -0,0 +1,868 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Regents of the University of California.
+ * @author: Jeff Thompson <jefft0@remap.ucla.edu>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+
+/**
+ * This measures FullPSync2017, FullPSync2017WithUsers and ChronoSync2013 with
+ * many participants in one process, so that no forwarder is needed. Each
+ * participant has a Face on a simulated broadcast medium which forwards each
+ * Interest to all the other faces which registered a matching prefix,
+ * aggregating Interests with the same name like a forwarder, and returns each
+ * Data to the faces with a matching pending Interest. Each
+ * delivery is delayed by the one-way latency and dropped with the loss rate.
+ * First, every participant publishes at the same time as they join, and this
+ * measures the time until all participants have the latest update of all the
+ * others. Then for each round, some random participants publish an update and
+ * this measures the time until all participants have them. For the rounds,
+ * this prints the Interests and Data per update, and the CPU time per
+ * participant per update which is spent in its Face and sync callbacks.
+ * Usage: test-sync-scale-benchmark [nParticipants [latencyMilliseconds [lossPercent]]]
+ */
+
+// Only compile if ndn-cpp-config.h defines NDN_CPP_HAVE_LIBZ and
+// NDN_CPP_HAVE_PROTOBUF.
+#include <ndn-cpp/ndn-cpp-config.h>
+#if NDN_CPP_HAVE_LIBZ && NDN_CPP_HAVE_PROTOBUF
+
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <list>
+#include <algorithm>
+#include <unistd.h>
+#include <sys/time.h>
+#include <ndn-cpp/face.hpp>
+#include <ndn-cpp/control-parameters.hpp>
+#include <ndn-cpp/control-response.hpp>
+#include <ndn-cpp/security/key-chain.hpp>
+#include <ndn-cpp/encoding/tlv-wire-format.hpp>
+#include <ndn-cpp/sync/full-psync2017.hpp>
+#include <ndn-cpp/sync/full-psync2017-with-users.hpp>
+#include <ndn-cpp/sync/chrono-sync2013.hpp>
+#include "../src/c/encoding/tlv/tlv.h"
+#include "../src/encoding/element-listener.hpp"
+
+using namespace std;
+using namespace ndn;
+using namespace ndn::func_lib;
+
+static double
+getNowMilliseconds()
+{
+  struct timeval t;
+  gettimeofday(&t, 0);
+  return t.tv_sec * 1000.0 + t.tv_usec / 1000.0;
+}
+
+class MediumTransport;
+
+/**
+ * SimulatedMedium is an in-process broadcast medium for the MediumTransport
+ * of each Face. It answers prefix registration commands, forwards each
+ * Interest to the other faces which registered a matching prefix, and uses a
+ * pending Interest table to aggregate Interests with the same name and to
+ * return each Data to the other faces which asked for it. Each delivery is delayed by the latency and dropped with the loss
+ * rate. This also keeps the statistics of each face.
+ */
+class SimulatedMedium {
+public:
+  /**
+   * Create a SimulatedMedium.
+   * @param keyChain The KeyChain for signing registration responses.
+   * @param latencyMilliseconds The delay of each delivery.
+   * @param lossRate The probability from 0.0 to 1.0 that a delivery is lost.
+   */
+  SimulatedMedium
+    (KeyChain& keyChain, double latencyMilliseconds, double lossRate)
+  : keyChain_(keyChain), latencyMilliseconds_(latencyMilliseconds),
+    lossRate_(lossRate), lastPruneTime_(0)
+  {
+  }
+
+  /**
+   * Add the transport and return its face index.
+   */
+  size_t
+  addTransport(MediumTransport* transport)
+  {
+    transports_.push_back(transport);
+    fib_.push_back(vector<Name>());
+    statistics_.push_back(Statistics());
+    return transports_.size() - 1;
+  }
+
+  /**
+   * Process the packet which was sent by the face and schedule its deliveries.
+   */
+  void
+  send(size_t faceIndex, const uint8_t *data, size_t dataLength);
+
+  /**
+   * Deliver the scheduled packets whose delivery time has come, including
+   * packets which are scheduled while delivering.
+   * @return True if any packet was delivered.
+   */
+  bool
+  forward();
+
+  /**
+   * Add to the CPU time of the face, for work done outside of a delivery.
+   */
+  void
+  addCpuMilliseconds(size_t faceIndex, double milliseconds)
+  {
+    statistics_[faceIndex].cpuMilliseconds_ += milliseconds;
+  }
+
+  class Statistics {
+  public:
+    Statistics()
+    : nInterestsSent_(0), nDataSent_(0), nInterestsDelivered_(0),
+      nDataDelivered_(0), nBytesDelivered_(0), cpuMilliseconds_(0)
+    {
+    }
+
+    uint64_t nInterestsSent_;
+    uint64_t nDataSent_;
+    uint64_t nInterestsDelivered_;
+    uint64_t nDataDelivered_;
+    uint64_t nBytesDelivered_;
+    double cpuMilliseconds_;
+  };
+
+  const Statistics&
+  getStatistics(size_t faceIndex) const { return statistics_[faceIndex]; }
+
+private:
+  class PitEntry {
+  public:
+    PitEntry(const ptr_lib::shared_ptr<Interest>& interest, size_t faceIndex)
+    : interest_(interest), faceIndex_(faceIndex),
+      expireTime_(getNowMilliseconds() + interest->getInterestLifetimeMilliseconds())
+    {
+    }
+
+    ptr_lib::shared_ptr<Interest> interest_;
+    size_t faceIndex_;
+    double expireTime_;
+  };
+
+  class Delivery {
+  public:
+    Delivery(size_t faceIndex, const Blob& encoding, bool isInterest)
+    : faceIndex_(faceIndex), encoding_(encoding), isInterest_(isInterest)
+    {
+    }
+
+    size_t faceIndex_;
+    Blob encoding_;
+    bool isInterest_;
+  };
+
+  /**
+   * Schedule the delivery after the latency, unless it is lost.
+   */
+  void
+  schedule(size_t faceIndex, const Blob& encoding, bool isInterest)
+  {
+    if (lossRate_ > 0 && rand() / (RAND_MAX + 1.0) < lossRate_)
+      return;
+
+    deliveries_.insert(make_pair
+      (getNowMilliseconds() + latencyMilliseconds_,
+       Delivery(faceIndex, encoding, isInterest)));
+  }
+
+  void
+  onInterest(size_t faceIndex, const Blob& encoding);
+
+  void
+  onData(size_t faceIndex, const Blob& encoding);
+
+  KeyChain& keyChain_;
+  double latencyMilliseconds_;
+  double lossRate_;
+  vector<MediumTransport*> transports_;
+  // fib_[i] has the prefixes registered by face i.
+  vector<vector<Name> > fib_;
+  vector<Statistics> statistics_;
+  list<PitEntry> pit_;
+  double lastPruneTime_;
+  // The key is the delivery time.
+  multimap<double, Delivery> deliveries_;
+};
+
+/**
+ * MediumTransport extends Transport to send packets through a SimulatedMedium.
+ */
+class MediumTransport : public Transport {
+public:
+  MediumTransport(SimulatedMedium& medium)
+  : medium_(medium), elementListener_(0)
+  {
+    faceIndex_ = medium_.addTransport(this);
+  }
+
+  virtual bool
+  isLocal(const Transport::ConnectionInfo& connectionInfo) { return true; }
+
+  virtual bool
+  isAsync() { return false; }
+
+  virtual void
+  connect
+    (const Transport::ConnectionInfo& connectionInfo,
+     ElementListener& elementListener, const OnConnected& onConnected)
+  {
+    elementListener_ = &elementListener;
+    if (onConnected)
+      onConnected();
+  }
+
+  virtual void
+  send(const uint8_t *data, size_t dataLength)
+  {
+    medium_.send(faceIndex_, data, dataLength);
+  }
+
+  virtual void
+  processEvents() {}
+
+  virtual bool
+  getIsConnected() { return elementListener_ != 0; }
+
+  /**
+   * Deliver the encoded packet to the Face as if it came from the forwarder.
+   */
+  void
+  receive(const Blob& encoding)
+  {
+    elementListener_->onReceivedElement(encoding.buf(), encoding.size());
+  }
+
+  size_t
+  getFaceIndex() const { return faceIndex_; }
+
+private:
+  SimulatedMedium& medium_;
+  size_t faceIndex_;
+  ElementListener* elementListener_;
+};
+
+void
+SimulatedMedium::send(size_t faceIndex, const uint8_t *data, size_t dataLength)
+{
+  if (dataLength == 0)
+    return;
+
+  Blob encoding(data, dataLength);
+  if (data[0] == ndn_Tlv_Interest)
+    onInterest(faceIndex, encoding);
+  else if (data[0] == ndn_Tlv_Data)
+    onData(faceIndex, encoding);
+}
+
+bool
+SimulatedMedium::forward()
+{
+  bool didForward = false;
+  while (deliveries_.size() > 0 &&
+         deliveries_.begin()->first <= getNowMilliseconds()) {
+    Delivery delivery = deliveries_.begin()->second;
+    deliveries_.erase(deliveries_.begin());
+    didForward = true;
+
+    Statistics& statistics = statistics_[delivery.faceIndex_];
+    if (delivery.isInterest_)
+      ++statistics.nInterestsDelivered_;
+    else
+      ++statistics.nDataDelivered_;
+    statistics.nBytesDelivered_ += delivery.encoding_.size();
+
+    double startTime = getNowMilliseconds();
+    transports_[delivery.faceIndex_]->receive(delivery.encoding_);
+    statistics.cpuMilliseconds_ += getNowMilliseconds() - startTime;
+  }
+
+  double now = getNowMilliseconds();
+  if (now - lastPruneTime_ >= 100) {
+    // Remove expired PIT entries.
+    lastPruneTime_ = now;
+    for (list<PitEntry>::iterator entry = pit_.begin(); entry != pit_.end();) {
+      if (entry->expireTime_ < now)
+        pit_.erase(entry++);
+      else
+        ++entry;
+    }
+  }
+
+  return didForward;
+}
+
+void
+SimulatedMedium::onInterest(size_t faceIndex, const Blob& encoding)
+{
+  ptr_lib::shared_ptr<Interest> interest(new Interest());
+  interest->wireDecode(encoding);
+
+  static const Name registerPrefix("/localhost/nfd/rib/register");
+  if (registerPrefix.match(interest->getName())) {
+    ControlParameters controlParameters;
+    controlParameters.wireDecode
+      (interest->getName().get(registerPrefix.size()).getValue(),
+       *TlvWireFormat::get());
+    fib_[faceIndex].push_back(controlParameters.getName());
+
+    // Answer the local registration without latency or loss.
+    Data response(interest->getName());
+    response.setContent(ControlResponse().setStatusCode(200)
+      .setStatusText("OK").wireEncode());
+    keyChain_.signWithSha256(response);
+    deliveries_.insert(make_pair
+      (getNowMilliseconds(), Delivery(faceIndex, response.wireEncode(), false)));
+    return;
+  }
+
+  ++statistics_[faceIndex].nInterestsSent_;
+
+  // Like a forwarder, aggregate an Interest with the same name as a pending
+  // Interest so that the Data is returned to both, and only forward it once.
+  bool isAggregated = false;
+  double now = getNowMilliseconds();
+  for (list<PitEntry>::iterator entry = pit_.begin(); entry != pit_.end();
+       ++entry) {
+    if (entry->expireTime_ >= now &&
+        entry->interest_->getName().equals(interest->getName())) {
+      isAggregated = true;
+      break;
+    }
+  }
+
+  pit_.push_back(PitEntry(interest, faceIndex));
+  if (isAggregated)
+    return;
+
+  for (size_t i = 0; i < fib_.size(); ++i) {
+    if (i == faceIndex)
+      continue;
+
+    for (size_t j = 0; j < fib_[i].size(); ++j) {
+      if (fib_[i][j].match(interest->getName())) {
+        schedule(i, encoding, true);
+        break;
+      }
+    }
+  }
+}
+
+void
+SimulatedMedium::onData(size_t faceIndex, const Blob& encoding)
+{
+  ++statistics_[faceIndex].nDataSent_;
+
+  Data data;
+  data.wireDecode(encoding);
+  double now = getNowMilliseconds();
+  vector<bool> isScheduled(transports_.size(), false);
+  // Don't return the Data to the face which sent it.
+  isScheduled[faceIndex] = true;
+
+  for (list<PitEntry>::iterator entry = pit_.begin(); entry != pit_.end();) {
+    if (entry->expireTime_ < now)
+      pit_.erase(entry++);
+    else if (entry->faceIndex_ != faceIndex &&
+             entry->interest_->matchesData(data)) {
+      if (!isScheduled[entry->faceIndex_]) {
+        isScheduled[entry->faceIndex_] = true;
+        schedule(entry->faceIndex_, encoding, false);
+      }
+      pit_.erase(entry++);
+    }
+    else
+      ++entry;
+  }
+}
+
+/**
+ * SyncNode is an abstract base class for a participant with a sync protocol
+ * and a Face on the medium. A subclass makes its sync object after the Face,
+ * so that the sync object is destroyed first.
+ */
+class SyncNode {
+public:
+  SyncNode
+    (SimulatedMedium& medium, KeyChain& keyChain, const Name& certificateName)
+  : medium_(medium), transport_(new MediumTransport(medium)),
+    face_(transport_, ptr_lib::make_shared<Transport::ConnectionInfo>())
+  {
+    face_.setCommandSigningInfo(keyChain, certificateName);
+  }
+
+  virtual
+  ~SyncNode() {}
+
+  /**
+   * Check if this participant has joined and can publish.
+   */
+  virtual bool
+  isReady() const { return true; }
+
+  /**
+   * Publish the next update of this participant.
+   */
+  void
+  publish()
+  {
+    double startTime = getNowMilliseconds();
+    doPublish();
+    medium_.addCpuMilliseconds
+      (transport_->getFaceIndex(), getNowMilliseconds() - startTime);
+  }
+
+  /**
+   * Check if this participant has the latest update of the publisher.
+   */
+  virtual bool
+  hasLatest(const SyncNode& publisher) const = 0;
+
+  void
+  processEvents()
+  {
+    double startTime = getNowMilliseconds();
+    face_.processEvents();
+    medium_.addCpuMilliseconds
+      (transport_->getFaceIndex(), getNowMilliseconds() - startTime);
+  }
+
+  size_t
+  getFaceIndex() const { return transport_->getFaceIndex(); }
+
+protected:
+  virtual void
+  doPublish() = 0;
+
+  SimulatedMedium& medium_;
+  ptr_lib::shared_ptr<MediumTransport> transport_;
+  Face face_;
+};
+
+/**
+ * FullPSyncNode publishes a new name /benchmark/full/<nodeNo>/<sequenceNo>
+ * for each update with FullPSync2017.
+ */
+class FullPSyncNode : public SyncNode {
+public:
+  FullPSyncNode
+    (SimulatedMedium& medium, KeyChain& keyChain, const Name& certificateName,
+     size_t nodeNo, size_t nNodes)
+  : SyncNode(medium, keyChain, certificateName), nodeNo_(nodeNo),
+    sequenceNo_(-1), latestSequenceNos_(nNodes, -1),
+    sync_
+      (EXPECTED_N_ENTRIES, face_, Name("/benchmark/full/sync"),
+       bind(&FullPSyncNode::onNamesUpdate, this, _1), keyChain,
+       FullPSync2017::DEFAULT_SYNC_INTEREST_LIFETIME,
+       FullPSync2017::DEFAULT_SYNC_REPLY_FRESHNESS_PERIOD,
+       SigningInfo(SigningInfo::SIGNER_TYPE_SHA256))
+  {
+  }
+
+  virtual bool
+  hasLatest(const SyncNode& publisher) const
+  {
+    const FullPSyncNode& node = dynamic_cast<const FullPSyncNode&>(publisher);
+    return &node == this ||
+      latestSequenceNos_[node.nodeNo_] >= node.sequenceNo_;
+  }
+
+protected:
+  virtual void
+  doPublish()
+  {
+    ++sequenceNo_;
+    sync_.publishName(Name("/benchmark/full").appendNumber(nodeNo_)
+      .appendNumber(sequenceNo_));
+  }
+
+private:
+  void
+  onNamesUpdate(const ptr_lib::shared_ptr<vector<Name> >& names)
+  {
+    for (size_t i = 0; i < names->size(); ++i) {
+      size_t nodeNo = (size_t)(*names)[i].get(-2).toNumber();
+      int sequenceNo = (int)(*names)[i].get(-1).toNumber();
+      if (nodeNo < latestSequenceNos_.size())
+        latestSequenceNos_[nodeNo] =
+          max(latestSequenceNos_[nodeNo], sequenceNo);
+    }
+  }
+
+  static const size_t EXPECTED_N_ENTRIES = 80;
+
+  size_t nodeNo_;
+  int sequenceNo_;
+  vector<int> latestSequenceNos_;
+  FullPSync2017 sync_;
+};
+
+/**
+ * FullPSyncWithUsersNode publishes the next sequence number of its user prefix
+ * /benchmark/users/<nodeNo> with FullPSync2017WithUsers.
+ */
+class FullPSyncWithUsersNode : public SyncNode {
+public:
+  FullPSyncWithUsersNode
+    (SimulatedMedium& medium, KeyChain& keyChain, const Name& certificateName,
+     size_t nodeNo)
+  : SyncNode(medium, keyChain, certificateName),
+    userPrefix_(Name("/benchmark/users").appendNumber(nodeNo)),
+    sync_
+      (EXPECTED_N_ENTRIES, face_, Name("/benchmark/users/sync"), userPrefix_,
+       bind(&FullPSyncWithUsersNode::onUpdate, this, _1), keyChain,
+       FullPSync2017::DEFAULT_SYNC_INTEREST_LIFETIME,
+       FullPSync2017::DEFAULT_SYNC_REPLY_FRESHNESS_PERIOD,
+       SigningInfo(SigningInfo::SIGNER_TYPE_SHA256))
+  {
+  }
+
+  virtual bool
+  hasLatest(const SyncNode& publisher) const
+  {
+    const FullPSyncWithUsersNode& node =
+      dynamic_cast<const FullPSyncWithUsersNode&>(publisher);
+    return &node == this ||
+      sync_.getSequenceNo(node.userPrefix_) >=
+        node.sync_.getSequenceNo(node.userPrefix_);
+  }
+
+protected:
+  virtual void
+  doPublish() { sync_.publishName(userPrefix_); }
+
+private:
+  void
+  onUpdate
+    (const ptr_lib::shared_ptr<vector<ptr_lib::shared_ptr<PSyncMissingDataInfo> > >& updates)
+  {
+  }
+
+  static const size_t EXPECTED_N_ENTRIES = 80;
+
+  Name userPrefix_;
+  FullPSync2017WithUsers sync_;
+};
+
+/**
+ * ChronoSyncNode publishes the next sequence number of its data prefix
+ * /benchmark/chrono/<nodeNo> with ChronoSync2013. It is ready when
+ * ChronoSync2013 calls onInitialized.
+ */
+class ChronoSyncNode : public SyncNode {
+public:
+  ChronoSyncNode
+    (SimulatedMedium& medium, KeyChain& keyChain, const Name& certificateName,
+     size_t nodeNo)
+  : SyncNode(medium, keyChain, certificateName),
+    dataPrefixUri_(Name("/benchmark/chrono").appendNumber(nodeNo).toUri()),
+    isInitialized_(false),
+    sync_
+      (bind(&ChronoSyncNode::onReceivedSyncState, this, _1, _2),
+       bind(&ChronoSyncNode::onInitialized, this), Name(dataPrefixUri_),
+       Name("/benchmark/chrono/sync"), SESSION_NO, face_, keyChain,
+       certificateName, SYNC_LIFETIME, onRegisterFailed)
+  {
+  }
+
+  virtual
+  ~ChronoSyncNode() { sync_.shutdown(); }
+
+  virtual bool
+  isReady() const { return isInitialized_; }
+
+  virtual bool
+  hasLatest(const SyncNode& publisher) const
+  {
+    const ChronoSyncNode& node = dynamic_cast<const ChronoSyncNode&>(publisher);
+    return &node == this ||
+      sync_.getProducerSequenceNo(node.dataPrefixUri_, SESSION_NO) >=
+        node.sync_.getSequenceNo();
+  }
+
+protected:
+  virtual void
+  doPublish() { sync_.publishNextSequenceNo(); }
+
+private:
+  void
+  onReceivedSyncState
+    (const vector<ChronoSync2013::SyncState>& syncStates, bool isRecovery)
+  {
+  }
+
+  void
+  onInitialized() { isInitialized_ = true; }
+
+  static void
+  onRegisterFailed(const ptr_lib::shared_ptr<const Name>& prefix)
+  {
+    cout << "Register failed for prefix " << prefix->toUri() << endl;
+  }
+
+  static const int SESSION_NO = 1;
+  static const int SYNC_LIFETIME = 5000;
+
+  string dataPrefixUri_;
+  bool isInitialized_;
+  ChronoSync2013 sync_;
+};
+
+/**
+ * Check if all the nodes are ready and have the latest update of all the
+ * publishers.
+ */
+static bool
+isConverged
+  (const vector<ptr_lib::shared_ptr<SyncNode> >& nodes,
+   const vector<SyncNode*>& publishers)
+{
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    if (!nodes[i]->isReady())
+      return false;
+
+    for (size_t j = 0; j < publishers.size(); ++j) {
+      if (!nodes[i]->hasLatest(*publishers[j]))
+        return false;
+    }
+  }
+
+  return true;
+}
+
+/**
+ * Process events on all the faces and forward packets until all the nodes
+ * have the latest update of all the publishers, or the timeout.
+ * @return The elapsed milliseconds, or -1 for timeout.
+ */
+static double
+runUntilConverged
+  (SimulatedMedium& medium, const vector<ptr_lib::shared_ptr<SyncNode> >& nodes,
+   const vector<SyncNode*>& publishers, double timeoutMilliseconds)
+{
+  double startTime = getNowMilliseconds();
+  double lastCheckTime = 0;
+  while (true) {
+    double now = getNowMilliseconds();
+    // Checking all the nodes is expensive, so limit how often.
+    if (now - lastCheckTime >= 5) {
+      lastCheckTime = now;
+      if (isConverged(nodes, publishers))
+        return now - startTime;
+    }
+    if (now - startTime > timeoutMilliseconds)
+      return -1;
+
+    for (size_t i = 0; i < nodes.size(); ++i)
+      nodes[i]->processEvents();
+    if (!medium.forward())
+      // Wait for the next delivery or a timer such as an Interest timeout.
+      usleep(1000);
+  }
+}
+
+/**
+ * Get the sum of the statistics of all the nodes.
+ */
+static SimulatedMedium::Statistics
+getTotalStatistics
+  (const SimulatedMedium& medium,
+   const vector<ptr_lib::shared_ptr<SyncNode> >& nodes)
+{
+  SimulatedMedium::Statistics total;
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    const SimulatedMedium::Statistics& statistics =
+      medium.getStatistics(nodes[i]->getFaceIndex());
+    total.nInterestsSent_ += statistics.nInterestsSent_;
+    total.nDataSent_ += statistics.nDataSent_;
+    total.nInterestsDelivered_ += statistics.nInterestsDelivered_;
+    total.nDataDelivered_ += statistics.nDataDelivered_;
+    total.nBytesDelivered_ += statistics.nBytesDelivered_;
+    total.cpuMilliseconds_ += statistics.cpuMilliseconds_;
+  }
+
+  return total;
+}
+
+enum Protocol { FULL_PSYNC, FULL_PSYNC_WITH_USERS, CHRONO_SYNC };
+
+/**
+ * Make the nodes for the protocol, run the join and the publish rounds, and
+ * print the results.
+ */
+static void
+benchmark
+  (Protocol protocol, size_t nNodes, double latencyMilliseconds, double lossRate,
+   KeyChain& keyChain)
+{
+  const int nRounds = 10;
+  const size_t nPublishersPerRound = min(nNodes, (size_t)10);
+  const double timeoutMilliseconds = 30000;
+
+  SimulatedMedium medium(keyChain, latencyMilliseconds, lossRate);
+  vector<ptr_lib::shared_ptr<SyncNode> > nodes;
+  for (size_t i = 0; i < nNodes; ++i) {
+    if (protocol == FULL_PSYNC)
+      nodes.push_back(ptr_lib::make_shared<FullPSyncNode>
+        (medium, keyChain, keyChain.getDefaultCertificateName(), i, nNodes));
+    else if (protocol == FULL_PSYNC_WITH_USERS)
+      nodes.push_back(ptr_lib::make_shared<FullPSyncWithUsersNode>
+        (medium, keyChain, keyChain.getDefaultCertificateName(), i));
+    else
+      nodes.push_back(ptr_lib::make_shared<ChronoSyncNode>
+        (medium, keyChain, keyChain.getDefaultCertificateName(), i));
+  }
+
+  cout << (protocol == FULL_PSYNC ? "FullPSync2017" :
+           protocol == FULL_PSYNC_WITH_USERS ? "FullPSync2017WithUsers" :
+           "ChronoSync2013") << ", " << nNodes << " participants:" << endl;
+
+  // ChronoSync2013 publishes the first sequence number when it initializes.
+  vector<SyncNode*> publishers;
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    if (protocol != CHRONO_SYNC)
+      nodes[i]->publish();
+    publishers.push_back(nodes[i].get());
+  }
+  double joinMilliseconds = runUntilConverged
+    (medium, nodes, publishers, timeoutMilliseconds);
+  if (joinMilliseconds < 0)
+    cout << "  Join did not converge in " << timeoutMilliseconds << " ms" << endl;
+  else
+    cout << "  Join converged in " << joinMilliseconds << " ms" << endl;
+
+  SimulatedMedium::Statistics start = getTotalStatistics(medium, nodes);
+  vector<double> startCpuMilliseconds;
+  for (size_t i = 0; i < nodes.size(); ++i)
+    startCpuMilliseconds.push_back
+      (medium.getStatistics(nodes[i]->getFaceIndex()).cpuMilliseconds_);
+  double totalMilliseconds = 0;
+  double maxMilliseconds = 0;
+  int nTimeouts = 0;
+  for (int round = 0; round < nRounds; ++round) {
+    vector<size_t> nodeNos;
+    for (size_t i = 0; i < nodes.size(); ++i)
+      nodeNos.push_back(i);
+    random_shuffle(nodeNos.begin(), nodeNos.end());
+
+    publishers.clear();
+    for (size_t i = 0; i < nPublishersPerRound; ++i) {
+      SyncNode* node = nodes[nodeNos[i]].get();
+      if (!node->isReady())
+        continue;
+      node->publish();
+      publishers.push_back(node);
+    }
+
+    double milliseconds = runUntilConverged
+      (medium, nodes, publishers, timeoutMilliseconds);
+    if (milliseconds < 0) {
+      ++nTimeouts;
+      milliseconds = timeoutMilliseconds;
+    }
+    totalMilliseconds += milliseconds;
+    maxMilliseconds = max(maxMilliseconds, milliseconds);
+  }
+  SimulatedMedium::Statistics end = getTotalStatistics(medium, nodes);
+
+  double nUpdates = nRounds * nPublishersPerRound;
+  cout << "  " << nRounds << " rounds of " << nPublishersPerRound <<
+    " updates converged in " << totalMilliseconds / nRounds <<
+    " ms average, " << maxMilliseconds << " ms max";
+  if (nTimeouts > 0)
+    cout << " (" << nTimeouts << " rounds timed out)";
+  cout << endl;
+  cout << "  Per update: " <<
+    (end.nInterestsSent_ - start.nInterestsSent_) / nUpdates <<
+    " Interests and " << (end.nDataSent_ - start.nDataSent_) / nUpdates <<
+    " Data sent, " <<
+    (end.nInterestsDelivered_ - start.nInterestsDelivered_) / nUpdates <<
+    " Interests and " <<
+    (end.nDataDelivered_ - start.nDataDelivered_) / nUpdates <<
+    " Data delivered, " <<
+    (end.nBytesDelivered_ - start.nBytesDelivered_) / (nUpdates * nNodes) <<
+    " bytes delivered per participant" << endl;
+
+  double maxCpuMilliseconds = 0;
+  for (size_t i = 0; i < nodes.size(); ++i)
+    maxCpuMilliseconds = max
+      (maxCpuMilliseconds,
+       medium.getStatistics(nodes[i]->getFaceIndex()).cpuMilliseconds_ -
+       startCpuMilliseconds[i]);
+  cout << "  CPU per participant per update: " <<
+    (end.cpuMilliseconds_ - start.cpuMilliseconds_) / (nUpdates * nNodes) <<
+    " ms average, " << maxCpuMilliseconds / nUpdates << " ms max" << endl;
+}
+
+int
+main(int argc, char** argv)
+{
+  size_t nNodes = 50;
+  double latencyMilliseconds = 10;
+  double lossPercent = 0;
+  if (argc > 1)
+    nNodes = (size_t)atoi(argv[1]);
+  if (argc > 2)
+    latencyMilliseconds = atof(argv[2]);
+  if (argc > 3)
+    lossPercent = atof(argv[3]);
+
+  try {
+    Interest::setDefaultCanBePrefix(true);
+    KeyChain keyChain("pib-memory:", "tpm-memory:");
+    keyChain.createIdentityV2(Name("/benchmark/participant"), EcKeyParams());
+    srand(1);
+
+    cout << "Latency " << latencyMilliseconds << " ms, loss " << lossPercent <<
+      "%" << endl;
+    benchmark(FULL_PSYNC, nNodes, latencyMilliseconds, lossPercent / 100,
+              keyChain);
+    benchmark(FULL_PSYNC_WITH_USERS, nNodes, latencyMilliseconds,
+              lossPercent / 100, keyChain);
+    benchmark(CHRONO_SYNC, nNodes, latencyMilliseconds, lossPercent / 100,
+              keyChain);
+  } catch (const std::exception& ex) {
+    cout << "exception: " << ex.what() << endl;
+    return 1;
+  }
+
+  return 0;
+}
+
+#else // NDN_CPP_HAVE_LIBZ && NDN_CPP_HAVE_PROTOBUF
+
+#include <iostream>
+using namespace std;
+int main(int argc, char** argv)
+{
+  cout <<
+    "This program uses zlib and Protobuf but they are not installed. Install them and ./configure again." <<
+    endl;
+}
+
+#endif // NDN_CPP_HAVE_LIBZ && NDN_CPP_HAVE_PROTOBUF
@@ -0,0 +1,192 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Regents of the University of California.
+ * @author: Jeff Thompson <jefft0@remap.ucla.edu>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+/**
+ * This measures the time to find the matching validator config rule for a
+ * packet name with a 100-rule configuration, comparing the linear search of
+ * ConfigRule::match with ConfigRuleIndex.
+ */
+
+#include <iostream>
+#include <sstream>
+#include <sys/time.h>
+#include <ndn-cpp/security/v2/validator-config/config-rule-index.hpp>
+
+using namespace std;
+using namespace ndn;
+
+static double
+getNowSeconds()
+{
+  struct timeval t;
+  gettimeofday(&t, 0);
+  return t.tv_sec + t.tv_usec / 1000000.0;
+}
+
+static string
+toString(int x)
+{
+  ostringstream result;
+  result << x;
+  return result.str();
+}
+
+/**
+ * Make a rule set for Data packets like a large site configuration, mixing
+ * name relation filters and regex filters.
+ * @param nRules The number of rules.
+ * @param rules Append the rules to this list.
+ * @param names Append packet names to this list, one for each rule and some
+ * which don't match any rule.
+ */
+static void
+makeRules
+  (int nRules, vector<ptr_lib::shared_ptr<ConfigRule>>& rules,
+   vector<Name>& names)
+{
+  for (int i = 0; i < nRules; ++i) {
+    string index = toString(i);
+    ptr_lib::shared_ptr<ConfigRule> rule(new ConfigRule("rule" + index, false));
+
+    switch (i % 4) {
+    case 0:
+      rule->addFilter(ptr_lib::make_shared<ConfigRelationNameFilter>
+        (Name("/org/site" + index + "/data"), ConfigNameRelation::IS_PREFIX_OF));
+      names.push_back(Name("/org/site" + index + "/data/temp/reading/7"));
+      break;
+    case 1:
+      rule->addFilter(ptr_lib::make_shared<ConfigRegexNameFilter>
+        ("^<org><app" + index + "><>*<DATA><>$"));
+      names.push_back
+        (Name("/org/app" + index + "/v1/chat/room/12/DATA/%FD%01"));
+      break;
+    case 2:
+      rule->addFilter(ptr_lib::make_shared<ConfigRegexNameFilter>
+        ("^<org><user" + index + "><KEY><>{1,3}$"));
+      names.push_back(Name("/org/user" + index + "/KEY/%01%02/self/%FD%01"));
+      break;
+    default:
+      rule->addFilter(ptr_lib::make_shared<ConfigRegexNameFilter>
+        ("^<>*<group" + index + "><>*<SYNC><>$"));
+      names.push_back
+        (Name("/org/dept/lab/group" + index + "/member/a/b/SYNC/%00%05"));
+      break;
+    }
+
+    rules.push_back(rule);
+  }
+
+  // Add names which don't match any rule.
+  names.push_back(Name("/org/site7/data/temp"));
+  names.push_back(Name("/org/app1/v1/chat/room/12/DATA"));
+  names.push_back(Name("/other/a/b/c/d/e/f/g/h"));
+  names.push_back(Name("/org/dept/lab/groupX/member/a/b/c/d/SYNC"));
+}
+
+/**
+ * Find the first matching rule for each name with a linear search of the
+ * rules.
+ * @return The number of seconds for nIterations.
+ */
+static double
+benchmarkLinearSeconds
+  (int nIterations, const vector<ptr_lib::shared_ptr<ConfigRule>>& rules,
+   const vector<Name>& names, vector<ConfigRule*>& results)
+{
+  double start = getNowSeconds();
+  for (int i = 0; i < nIterations; ++i) {
+    for (size_t j = 0; j < names.size(); ++j) {
+      ConfigRule* result = 0;
+      for (size_t k = 0; k < rules.size(); ++k) {
+        if (rules[k]->match(false, names[j])) {
+          result = rules[k].get();
+          break;
+        }
+      }
+
+      if (i == 0)
+        results.push_back(result);
+    }
+  }
+  double finish = getNowSeconds();
+
+  return finish - start;
+}
+
+/**
+ * Find the first matching rule for each name with a ConfigRuleIndex.
+ * @return The number of seconds for nIterations.
+ */
+static double
+benchmarkIndexSeconds
+  (int nIterations, const vector<ptr_lib::shared_ptr<ConfigRule>>& rules,
+   const vector<Name>& names, vector<ConfigRule*>& results)
+{
+  ConfigRuleIndex index(rules, false);
+
+  double start = getNowSeconds();
+  for (int i = 0; i < nIterations; ++i) {
+    for (size_t j = 0; j < names.size(); ++j) {
+      ConfigRule* result = index.findFirstMatch(names[j]);
+
+      if (i == 0)
+        results.push_back(result);
+    }
+  }
+  double finish = getNowSeconds();
+
+  return finish - start;
+}
+
+int
+main(int argc, char** argv)
+{
+  try {
+    vector<ptr_lib::shared_ptr<ConfigRule>> rules;
+    vector<Name> names;
+    makeRules(100, rules, names);
+
+    vector<ConfigRule*> linearResults;
+    vector<ConfigRule*> indexResults;
+    int nIterations = 20;
+    double linearDuration = benchmarkLinearSeconds
+      (nIterations, rules, names, linearResults);
+    int nIndexIterations = 2000;
+    double indexDuration = benchmarkIndexSeconds
+      (nIndexIterations, rules, names, indexResults);
+
+    if (linearResults != indexResults) {
+      cout << "Error: ConfigRuleIndex found a different rule than the linear search" << endl;
+      return 1;
+    }
+
+    double nLinearLookups = (double)nIterations * names.size();
+    double nIndexLookups = (double)nIndexIterations * names.size();
+    cout << "Rules: " << rules.size() << ", names: " << names.size() << endl;
+    cout << "Linear rule search: Duration sec, lookups/sec: " << linearDuration
+         << ", " << (nLinearLookups / linearDuration) << endl;
+    cout << "ConfigRuleIndex:    Duration sec, lookups/sec: " << indexDuration
+         << ", " << (nIndexLookups / indexDuration) << endl;
+  } catch (std::exception& e) {
+    cout << "exception: " << e.what() << endl;
+  }
+  return 0;
+}
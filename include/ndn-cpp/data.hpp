@@ -175,6 +175,25 @@ public:
   ptr_lib::shared_ptr<Name>
   getFullName(WireFormat& wireFormat = *WireFormat::getDefaultWireFormat()) const;
 
+  /**
+   * Get the full name of each Data packet in the list, the same as calling
+   * getFullName for each. This is faster for many Data packets because it
+   * computes the ImplicitSha256Digest of several encodings at once with
+   * CryptoLite::digestSha256Multi. For the default wire format, this also
+   * caches each full name so that a later call to getFullName returns it.
+   * @param dataList The list of Data packets.
+   * @param fullNames Append the full name of each Data packet to this list, in
+   * the same order as dataList. You must not change the Name objects - if you
+   * need to change it then make a copy.
+   * @param wireFormat A WireFormat object used to encode the Data packets. If
+   * omitted, use WireFormat getDefaultWireFormat().
+   */
+  static void
+  getFullNames
+    (const std::vector<ptr_lib::shared_ptr<Data> >& dataList,
+     std::vector<ptr_lib::shared_ptr<Name> >& fullNames,
+     WireFormat& wireFormat = *WireFormat::getDefaultWireFormat());
+
   /**
    * Return a reference to the defaultWireEncoding, which was encoded with
    * getDefaultWireEncodingFormat().  The SignedBlob may have a null pointer.
@@ -302,6 +321,9 @@ private:
   {
     defaultWireEncoding_ = defaultWireEncoding;
     defaultWireEncodingFormat_ = defaultWireEncodingFormat;
+    // The full name depends on the default wire encoding, so clear it.
+    if (defaultFullName_->size() > 0)
+      defaultFullName_.reset(new Name());
     // Set getDefaultWireEncodingChangeCount_ so that the next call to
     //   getDefaultWireEncoding() won't clear defaultWireEncoding_.
     getDefaultWireEncodingChangeCount_ = getChangeCount();
@@ -28,12 +28,15 @@
 #ifdef NDN_CPP_HAVE_SQLITE3
 
 #include "../common.hpp"
+#include "../util/sqlite3-synchronous.hpp"
 #include "consumer-db.hpp"
 
 struct sqlite3;
 
 namespace ndn {
 
+class Sqlite3StatementCache;
+
 /**
  * Sqlite3ConsumerDb extends ConsumerDb to implement the storage of decryption
  * keys for the consumer using SQLite3.
@@ -47,6 +50,47 @@ public:
    */
   Sqlite3ConsumerDb(const std::string& databaseFilePath);
 
+  /**
+   * Finalize the cached statements and close the database.
+   */
+  virtual
+  ~Sqlite3ConsumerDb();
+
+  /**
+   * Set the level for the SQLite "synchronous" setting. The constructor sets
+   * the database to use write-ahead logging with Sqlite3Synchronous::NORMAL.
+   * @param level The synchronous level.
+   * @throws ConsumerDb::Error for a database error.
+   */
+  void
+  setSynchronous(Sqlite3Synchronous::Level level);
+
+  /**
+   * Begin a transaction so that the following changes are written together by
+   * commitTransaction(), which is much faster for bulk operations such as
+   * adding many decryption keys. Transactions may be nested, in which case only
+   * the outermost transaction is committed.
+   * @throws ConsumerDb::Error for a database error.
+   */
+  void
+  beginTransaction();
+
+  /**
+   * End the transaction begun by beginTransaction(). If this is the outermost
+   * transaction, commit the changes to the database.
+   * @throws ConsumerDb::Error if not in a transaction, or for a database error.
+   */
+  void
+  commitTransaction();
+
+  /**
+   * Discard the changes in the outermost transaction, including all nested
+   * transactions. If not in a transaction, do nothing.
+   * @throws ConsumerDb::Error for a database error.
+   */
+  void
+  rollbackTransaction();
+
   /**
    * Get the key with keyName from the database.
    * @param keyName The key name.
@@ -77,7 +121,12 @@ public:
   deleteKey(const Name& keyName);
 
 private:
+  // Disable the copy constructor and assignment operator.
+  Sqlite3ConsumerDb(const Sqlite3ConsumerDb& other);
+  Sqlite3ConsumerDb& operator=(const Sqlite3ConsumerDb& other);
+
   struct sqlite3 *database_;
+  ptr_lib::shared_ptr<Sqlite3StatementCache> statementCache_;
 };
 
 }
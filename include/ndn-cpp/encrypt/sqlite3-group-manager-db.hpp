@@ -29,12 +29,15 @@
 
 #include <map>
 #include "../common.hpp"
+#include "../util/sqlite3-synchronous.hpp"
 #include "group-manager-db.hpp"
 
 struct sqlite3;
 
 namespace ndn {
 
+class Sqlite3StatementCache;
+
 /**
  * Sqlite3GroupManagerDb extends GroupManagerDb to implement the storage of
  * data used by the GroupManager using SQLite3.
@@ -48,6 +51,47 @@ public:
    */
   Sqlite3GroupManagerDb(const std::string& databaseFilePath);
 
+  /**
+   * Finalize the cached statements and close the database.
+   */
+  virtual
+  ~Sqlite3GroupManagerDb();
+
+  /**
+   * Set the level for the SQLite "synchronous" setting. The constructor sets
+   * the database to use write-ahead logging with Sqlite3Synchronous::NORMAL.
+   * @param level The synchronous level.
+   * @throws GroupManagerDb::Error for a database error.
+   */
+  void
+  setSynchronous(Sqlite3Synchronous::Level level);
+
+  /**
+   * Begin a transaction so that the following changes are written together by
+   * commitTransaction(), which is much faster for bulk operations such as
+   * adding many group members. Transactions may be nested, in which case only
+   * the outermost transaction is committed.
+   * @throws GroupManagerDb::Error for a database error.
+   */
+  void
+  beginTransaction();
+
+  /**
+   * End the transaction begun by beginTransaction(). If this is the outermost
+   * transaction, commit the changes to the database.
+   * @throws GroupManagerDb::Error if not in a transaction, or for a database error.
+   */
+  void
+  commitTransaction();
+
+  /**
+   * Discard the changes in the outermost transaction, including all nested
+   * transactions. If not in a transaction, do nothing.
+   * @throws GroupManagerDb::Error for a database error.
+   */
+  void
+  rollbackTransaction();
+
   ////////////////////////////////////////////////////// Schedule management.
 
   /**
@@ -244,6 +288,10 @@ public:
   deleteEKey(const Name& eKeyName);
 
 private:
+  // Disable the copy constructor and assignment operator.
+  Sqlite3GroupManagerDb(const Sqlite3GroupManagerDb& other);
+  Sqlite3GroupManagerDb& operator=(const Sqlite3GroupManagerDb& other);
+
   /**
    * Get the ID for the schedule.
    * @param name The schedule name.
@@ -254,6 +302,7 @@ private:
   getScheduleId(const std::string& name);
 
   struct sqlite3 *database_;
+  ptr_lib::shared_ptr<Sqlite3StatementCache> statementCache_;
   std::map<Name, Blob> privateKeyBase_;
 };
 
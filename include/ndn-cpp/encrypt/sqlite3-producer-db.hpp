@@ -28,12 +28,15 @@
 #ifdef NDN_CPP_HAVE_SQLITE3
 
 #include "../common.hpp"
+#include "../util/sqlite3-synchronous.hpp"
 #include "producer-db.hpp"
 
 struct sqlite3;
 
 namespace ndn {
 
+class Sqlite3StatementCache;
+
 /**
  * Sqlite3ProducerDb extends ProducerDb to implement storage of keys for the
  * producer using SQLite3. It contains one table that maps time slots (to the
@@ -48,6 +51,47 @@ public:
    */
   Sqlite3ProducerDb(const std::string& databaseFilePath);
 
+  /**
+   * Finalize the cached statements and close the database.
+   */
+  virtual
+  ~Sqlite3ProducerDb();
+
+  /**
+   * Set the level for the SQLite "synchronous" setting. The constructor sets
+   * the database to use write-ahead logging with Sqlite3Synchronous::NORMAL.
+   * @param level The synchronous level.
+   * @throws ProducerDb::Error for a database error.
+   */
+  void
+  setSynchronous(Sqlite3Synchronous::Level level);
+
+  /**
+   * Begin a transaction so that the following changes are written together by
+   * commitTransaction(), which is much faster for bulk operations such as
+   * adding many content keys. Transactions may be nested, in which case only
+   * the outermost transaction is committed.
+   * @throws ProducerDb::Error for a database error.
+   */
+  void
+  beginTransaction();
+
+  /**
+   * End the transaction begun by beginTransaction(). If this is the outermost
+   * transaction, commit the changes to the database.
+   * @throws ProducerDb::Error if not in a transaction, or for a database error.
+   */
+  void
+  commitTransaction();
+
+  /**
+   * Discard the changes in the outermost transaction, including all nested
+   * transactions. If not in a transaction, do nothing.
+   * @throws ProducerDb::Error for a database error.
+   */
+  void
+  rollbackTransaction();
+
   /**
    * Check if a content key exists for the hour covering timeSlot.
    * @param timeSlot The time slot as milliseconds since Jan 1, 1970 UTC.
@@ -87,7 +131,12 @@ public:
   deleteContentKey(MillisecondsSince1970 timeSlot);
 
 private:
+  // Disable the copy constructor and assignment operator.
+  Sqlite3ProducerDb(const Sqlite3ProducerDb& other);
+  Sqlite3ProducerDb& operator=(const Sqlite3ProducerDb& other);
+
   struct sqlite3 *database_;
+  ptr_lib::shared_ptr<Sqlite3StatementCache> statementCache_;
 };
 
 }
@@ -29,6 +29,7 @@
 #include "encoding/wire-format.hpp"
 #include "interest-filter.hpp"
 #include "transport/transport.hpp"
+#include "util/face-metrics.hpp"
 
 namespace ndn {
 
@@ -124,6 +125,65 @@ public:
   void
   setInterestLoopbackEnabled(bool interestLoopbackEnabled);
 
+  /**
+   * Enable or disable Interest aggregation. If Interest aggregation is enabled,
+   * then when expressInterest is called with an Interest which is the same as
+   * an outstanding Interest except for the nonce and lifetime, the new
+   * Interest is not sent but waits for the response to the outstanding one.
+   * When the Data or network Nack arrives, this calls the callbacks for all
+   * the aggregated Interests. An Interest is only aggregated if it would
+   * expire no later than the outstanding one, counting from when the
+   * outstanding one was sent (with a tolerance of 100 milliseconds so that
+   * the same Interest expressed again right away is aggregated). Each
+   * Interest still times out according to its own lifetime. This is useful when many parts of an
+   * application fetch the same packet, such as a certificate. Interest
+   * aggregation is disabled by default.
+   * @param interestAggregationEnabled If True, enable Interest aggregation,
+   * otherwise disable it.
+   */
+  void
+  setInterestAggregationEnabled(bool interestAggregationEnabled);
+
+  /**
+   * Enable or disable collecting performance metrics for this Face. The
+   * metrics count the Interests sent, Data received, timeouts, network Nacks by
+   * reason and bytes in and out, and have histograms of the Interest to Data
+   * round trip time and the time taken by the application callbacks. When
+   * disabled, the overhead is only a check of a null pointer. Metrics are
+   * disabled by default.
+   * @param metricsEnabled If true and metrics are not already enabled, start
+   * collecting with all counts zero. If false, stop collecting and discard the
+   * metrics.
+   */
+  void
+  setMetricsEnabled(bool metricsEnabled);
+
+  /**
+   * Get a snapshot of the metrics, which also has the current sizes of the
+   * pending Interest table, Interest filter table and delayed call table. Like
+   * expressInterest, you should call this in the same thread as
+   * processEvents.
+   * @return A new copy of the metrics, or null if metrics are not enabled.
+   */
+  ptr_lib::shared_ptr<FaceMetrics>
+  getMetrics();
+
+  /**
+   * Periodically call onMetrics with a snapshot of the metrics, using
+   * callLater. This enables metrics if needed.
+   * @param intervalMilliseconds The interval between calls. If this is not
+   * positive, stop the periodic dump.
+   * @param onMetrics (optional) This calls onMetrics(metrics). If omitted or
+   * an empty OnFaceMetrics(), log the metrics at the INFO level instead.
+   * NOTE: The library will log any exceptions thrown by this callback, but for
+   * better error handling the callback should catch and properly handle any
+   * exceptions.
+   */
+  void
+  setMetricsDump
+    (Milliseconds intervalMilliseconds,
+     const OnFaceMetrics& onMetrics = OnFaceMetrics());
+
   /**
    * Send the Interest through the transport, read the entire response and call
    * onData, onTimeout or onNetworkNack as described below.
@@ -26,6 +26,7 @@
 #include <map>
 #include "../interest.hpp"
 #include "../data.hpp"
+#include "../util/cache-eviction-policy.hpp"
 
 // Give friend access to the tests.
 class TestEncryptorV2_EnumerateDataFromInMemoryStorage_Test;
@@ -35,8 +36,9 @@ namespace ndn {
 
 /**
  * InMemoryStorageRetaining provides an application cache with in-memory
- * storage, of which no eviction policy will be employed. Entries will only be
- * evicted by explicit application control.
+ * storage. By default, no eviction policy is employed and entries are only
+ * evicted by explicit application control. Use setEvictionPolicy to limit the
+ * total size of the entries.
  * Note: In ndn-cxx, this class is called InMemoryStoragePersistent, but
  * "persistent" misleadingly sounds like persistent on-disk storage.
  */
@@ -44,17 +46,17 @@ class InMemoryStorageRetaining {
 public:
   /**
    * Insert a Data packet. If a Data packet with the same name, including the
-   * implicit digest, already exists, replace it.
+   * implicit digest, already exists, replace it. If there is an eviction policy
+   * and this makes the storage larger than its byte budget, remove the entries
+   * which the policy selects.
    * @param data The packet to insert, which is copied.
    */
   void
-  insert(const Data& data)
-  {
-    cache_[*data.getFullName()] = ptr_lib::make_shared<Data>(data);
-  }
+  insert(const Data& data);
 
   /**
-   * Find the best match Data for a Name.
+   * Find the best match Data for a Name. If there is an eviction policy, this
+   * updates its hit or miss count.
    * @param name The Name of the Data packet to find.
    * @return The best match if any, otherwise null. You should not modify the
    * returned object. If you need to modify it then you must make a copy.
@@ -89,6 +91,26 @@ public:
   size_t
   size() { return cache_.size(); }
 
+  /**
+   * Set the eviction policy which limits the total size of the Data packet
+   * encodings in the storage. If the storage already has entries, add them to
+   * the policy and evict as needed.
+   * @param evictionPolicy The CacheEvictionPolicy such as
+   * CacheEvictionPolicyLru, which should not be used by another cache. If
+   * null, there is no limit (the default).
+   */
+  void
+  setEvictionPolicy
+    (const ptr_lib::shared_ptr<CacheEvictionPolicy>& evictionPolicy);
+
+  /**
+   * Get the eviction policy given to setEvictionPolicy, for example to get the
+   * hit, miss and eviction counts.
+   * @return The CacheEvictionPolicy, or null if not set.
+   */
+  const ptr_lib::shared_ptr<CacheEvictionPolicy>&
+  getEvictionPolicy() { return evictionPolicy_; }
+
   /**
    * Get the the storage cache, which should only be used for testing.
    * @return The storage cache.
@@ -101,7 +123,14 @@ private:
   friend class ::TestEncryptorV2_EnumerateDataFromInMemoryStorage_Test;
   friend class ::TestAccessManagerV2_EnumerateDataFromInMemoryStorage_Test;
 
+  /**
+   * While evictionPolicy_ is over budget, remove the entries that it selects.
+   */
+  void
+  evictWhileOverBudget();
+
   std::map<Name, ptr_lib::shared_ptr<Data> > cache_;
+  ptr_lib::shared_ptr<CacheEvictionPolicy> evictionPolicy_;
 };
 
 }
@@ -30,12 +30,15 @@
 #include "../../ndn-cpp-config.h"
 #ifdef NDN_CPP_HAVE_SQLITE3
 
+#include "../../util/sqlite3-synchronous.hpp"
 #include "pib-impl.hpp"
 
 struct sqlite3;
 
 namespace ndn {
 
+class Sqlite3StatementCache;
+
 /**
  * PibSqlite3 extends PibImpl and is used by the Pib class as an implementation
  * of a PIB based on an SQLite3 database. All the contents in the PIB are stored
@@ -67,6 +70,41 @@ public:
   static std::string
   getScheme();
 
+  /**
+   * Set the level for the SQLite "synchronous" setting. The constructor sets
+   * the database to use write-ahead logging with Sqlite3Synchronous::NORMAL.
+   * @param level The synchronous level.
+   * @throws PibImpl::Error for a database error.
+   */
+  void
+  setSynchronous(Sqlite3Synchronous::Level level);
+
+  /**
+   * Begin a transaction so that the following changes to the PIB are written
+   * together by commitTransaction(), which is much faster for bulk operations
+   * such as adding many certificates. Transactions may be nested, in which
+   * case only the outermost transaction is committed.
+   * @throws PibImpl::Error for a database error.
+   */
+  void
+  beginTransaction();
+
+  /**
+   * End the transaction begun by beginTransaction(). If this is the outermost
+   * transaction, commit the changes to the database.
+   * @throws PibImpl::Error if not in a transaction, or for a database error.
+   */
+  void
+  commitTransaction();
+
+  /**
+   * Discard the changes in the outermost transaction, including all nested
+   * transactions. If not in a transaction, do nothing.
+   * @throws PibImpl::Error for a database error.
+   */
+  void
+  rollbackTransaction();
+
   // TpmLocator management.
 
   /**
@@ -322,6 +360,7 @@ private:
   PibSqlite3& operator=(const PibSqlite3& other);
 
   struct sqlite3 *database_;
+  ptr_lib::shared_ptr<Sqlite3StatementCache> statementCache_;
 };
 
 }
@@ -25,6 +25,7 @@
 
 #include <float.h>
 #include <map>
+#include <list>
 #include "../../interest.hpp"
 #include "certificate-v2.hpp"
 
@@ -33,7 +34,8 @@ namespace ndn {
 /**
  * A CertificateCacheV2 holds other user's verified certificates in security v2
  * format CertificateV2. A certificate is removed no later than its NotAfter
- * time, or maxLifetime after it has been added to the cache.
+ * time, or maxLifetime after it has been added to the cache. If the cache has
+ * more than its capacity, the least recently used certificate is removed.
  */
 class CertificateCacheV2 {
 public:
@@ -42,20 +44,27 @@ public:
    * @param maxLifetimeMilliseconds (optional) The maximum time that
    * certificates can live inside the cache, in milliseconds. If omitted, use
    * getDefaultLifetime().
+   * @param capacity (optional) The maximum number of certificates in the
+   * cache. If omitted, use getDefaultCapacity().
    */
-  CertificateCacheV2(Milliseconds maxLifetimeMilliseconds = getDefaultLifetime());
+  CertificateCacheV2
+    (Milliseconds maxLifetimeMilliseconds = getDefaultLifetime(),
+     size_t capacity = getDefaultCapacity());
 
   /**
    * Insert the certificate into the cache. The inserted certificate will be
    * removed no later than its NotAfter time, or maxLifetimeMilliseconds given
-   * to the constructor.
+   * to the constructor. If this makes the number of certificates more than
+   * the capacity, remove the least recently used certificate. If a
+   * certificate with the same name is already in the cache, replace it.
    * @param certificate The certificate object, which is copied.
    */
   void
   insert(const CertificateV2& certificate);
 
   /**
-   * Find the certificate by the given key name.
+   * Find the certificate by the given key name. This marks the certificate as
+   * recently used.
    * @param certificatePrefix The certificate prefix for searching for the
    * certificate.
    * @return The found certificate, or null if not found. You must not modify
@@ -65,7 +74,9 @@ public:
   find(const Name& certificatePrefix) const;
 
   /**
-   * Find the certificate by the given interest.
+   * Find the certificate by the given interest. This marks the certificate as
+   * recently used. If the interest has no selectors (and the name doesn't end
+   * in an implicit digest), this is the same as find(interest.getName()).
    * @param interest The input interest object.
    * @return The found certificate which matches the interest, or null if not
    * found. You must not modify the returned object. If you need to modify it,
@@ -90,9 +101,26 @@ public:
   clear()
   {
     certificatesByName_.clear();
+    leastRecentlyUsed_.clear();
+    removalTimeHeap_.clear();
     nextRefreshTime_ = DBL_MAX;
   }
 
+  /**
+   * Get the number of certificates in the cache, which may include expired
+   * certificates which have not yet been removed.
+   * @return The number of certificates.
+   */
+  size_t
+  size() const { return certificatesByName_.size(); }
+
+  /**
+   * Get the maximum number of certificates in the cache.
+   * @return The capacity.
+   */
+  size_t
+  getCapacity() const { return capacity_; }
+
   /**
    * Get the default maximum lifetime (1 hour).
    * @return The lifetime in milliseconds.
@@ -100,6 +128,13 @@ public:
   static Milliseconds
   getDefaultLifetime() { return 3600.0 * 1000; }
 
+  /**
+   * Get the default capacity (10000 certificates).
+   * @return The maximum number of certificates.
+   */
+  static size_t
+  getDefaultCapacity() { return 10000; }
+
   /**
    * Set the offset when insert() and refresh() get the current time, which
    * should only be used for testing.
@@ -135,6 +170,8 @@ public:
 
     ptr_lib::shared_ptr<CertificateV2> certificate_;
     MillisecondsSince1970 removalTime_;
+    // The position of the certificate name in leastRecentlyUsed_.
+    std::list<Name>::iterator leastRecentlyUsedPosition_;
   };
 
   /**
@@ -149,19 +186,79 @@ public:
   }
 
 private:
+  /**
+   * A RemovalTimeHeapEntry is an entry in removalTimeHeap_. It is stale if
+   * the certificate was deleted or re-inserted with a different removal time.
+   */
+  class RemovalTimeHeapEntry {
+  public:
+    RemovalTimeHeapEntry
+      (MillisecondsSince1970 removalTime, const Name& certificateName)
+    : removalTime_(removalTime), certificateName_(certificateName)
+    {}
+
+    /**
+     * Compare by removal time so that std::push_heap makes a min-heap.
+     */
+    bool
+    operator < (const RemovalTimeHeapEntry& other) const
+    {
+      return removalTime_ > other.removalTime_;
+    }
+
+    MillisecondsSince1970 removalTime_;
+    Name certificateName_;
+  };
+
   /**
    * Remove all outdated certificate entries.
    */
   void
   refresh();
 
+  /**
+   * Mark the entry as the most recently used.
+   * @param entry The entry in certificatesByName_.
+   */
+  void
+  touch(const Entry& entry) const
+  {
+    leastRecentlyUsed_.splice
+      (leastRecentlyUsed_.end(), leastRecentlyUsed_,
+       entry.leastRecentlyUsedPosition_);
+  }
+
+  /**
+   * Remove the certificate from certificatesByName_ and leastRecentlyUsed_.
+   * Any entry in removalTimeHeap_ becomes stale.
+   * @param certificate The iterator in certificatesByName_.
+   */
+  void
+  erase(std::map<Name, Entry>::iterator certificate)
+  {
+    leastRecentlyUsed_.erase(certificate->second.leastRecentlyUsedPosition_);
+    certificatesByName_.erase(certificate);
+  }
+
+  /**
+   * Remake removalTimeHeap_ from certificatesByName_ to remove stale entries.
+   */
+  void
+  rebuildRemovalTimeHeap();
+
   // Disable the copy constructor and assignment operator.
   CertificateCacheV2(const CertificateCacheV2& other);
   CertificateCacheV2& operator=(const CertificateCacheV2& other);
 
   std::map<Name, Entry> certificatesByName_;
+  // The certificate names with the least recently used at the front.
+  mutable std::list<Name> leastRecentlyUsed_;
+  // A min-heap of removal times, managed with std::push_heap and
+  // std::pop_heap.
+  std::vector<RemovalTimeHeapEntry> removalTimeHeap_;
   MillisecondsSince1970 nextRefreshTime_;
   Milliseconds maxLifetimeMilliseconds_;
+  size_t capacity_;
   Milliseconds nowOffsetMilliseconds_;
 };
 
@@ -23,6 +23,7 @@
 #ifndef NDN_CERTIFICATE_FETCHER_FROM_NETWORK_HPP
 #define NDN_CERTIFICATE_FETCHER_FROM_NETWORK_HPP
 
+#include <map>
 #include "../../face.hpp"
 #include "certificate-fetcher.hpp"
 
@@ -30,7 +31,14 @@ namespace ndn {
 
 /**
  * CertificateFetcherFromNetwork extends CertificateFetcher to fetch missing
- * certificates from the network.
+ * certificates from the network. Concurrent requests for the same certificate
+ * name share one outstanding Interest. Each request keeps its own retry count.
+ * When the Interest times out or is Nacked, each request uses one of its
+ * retries, and a request with no retries left fails. If any requests remain,
+ * the certificate cache is checked again before re-expressing the Interest,
+ * in case the certificate arrived another way. When all the requests have
+ * failed, further requests for that name fail immediately until the negative
+ * cache lifetime has passed.
  */
 class CertificateFetcherFromNetwork : public CertificateFetcher {
 public:
@@ -42,6 +50,50 @@ public:
   : impl_(new Impl(*this, face))
   {}
 
+  /**
+   * Set the lifetime of entries in the negative cache of certificate names
+   * which could not be fetched. This only affects later failures.
+   * @param negativeCacheLifetime The lifetime in milliseconds. If 0, don't
+   * use the negative cache.
+   */
+  void
+  setNegativeCacheLifetime(Milliseconds negativeCacheLifetime)
+  {
+    impl_->negativeCacheLifetime_ = negativeCacheLifetime;
+  }
+
+  /**
+   * Get the lifetime of entries in the negative cache.
+   * @return The lifetime in milliseconds.
+   */
+  Milliseconds
+  getNegativeCacheLifetime() const { return impl_->negativeCacheLifetime_; }
+
+  /**
+   * Get the default lifetime of entries in the negative cache (10 seconds).
+   * @return The lifetime in milliseconds.
+   */
+  static Milliseconds
+  getDefaultNegativeCacheLifetime() { return 10000.0; }
+
+  /**
+   * Get the number of certificate names with an outstanding Interest.
+   * @return The number of pending fetches.
+   */
+  size_t
+  getPendingFetchCount() const { return impl_->pendingFetches_.size(); }
+
+  /**
+   * Set the offset when checking the negative cache for the current time,
+   * which should only be used for testing.
+   * @param nowOffsetMilliseconds The offset in milliseconds.
+   */
+  void
+  setNowOffsetMilliseconds_(Milliseconds nowOffsetMilliseconds)
+  {
+    impl_->nowOffsetMilliseconds_ = nowOffsetMilliseconds;
+  }
+
 protected:
   /**
    * Implement doFetch to use face_.expressInterest to fetch a certificate.
@@ -71,7 +123,9 @@ private:
   class Impl : public ptr_lib::enable_shared_from_this<Impl> {
   public:
     Impl(CertificateFetcherFromNetwork& parent, Face& face)
-    : parent_(parent), face_(face)
+    : parent_(parent), face_(face),
+      negativeCacheLifetime_(getDefaultNegativeCacheLifetime()),
+      nextNegativeCachePruneSize_(16), nowOffsetMilliseconds_(0)
     {}
 
     /**
@@ -89,66 +143,124 @@ private:
        const ptr_lib::shared_ptr<ValidationState>& state,
        const ValidationContinuation& continueValidation);
 
-  private:
-    /** This is called when a certificate is retrieved.
+    /**
+     * A Waiter is a validation state waiting for a pending fetch, with its own
+     * request which has its count of retries left.
+     */
+    class Waiter {
+    public:
+      Waiter
+        (const ptr_lib::shared_ptr<CertificateRequest>& certificateRequest,
+         const ptr_lib::shared_ptr<ValidationState>& state,
+         const ValidationContinuation& continueValidation)
+      : certificateRequest_(certificateRequest), state_(state),
+        continueValidation_(continueValidation)
+      {}
+
+      ptr_lib::shared_ptr<CertificateRequest> certificateRequest_;
+      ptr_lib::shared_ptr<ValidationState> state_;
+      ValidationContinuation continueValidation_;
+    };
+
+    /**
+     * A PendingFetch has the request of the first caller to doFetch for a
+     * certificate name, whose Interest is expressed, and all the waiters for
+     * the result.
+     */
+    class PendingFetch {
+    public:
+      PendingFetch
+        (const ptr_lib::shared_ptr<CertificateRequest>& certificateRequest)
+      : certificateRequest_(certificateRequest)
+      {}
+
+      ptr_lib::shared_ptr<CertificateRequest> certificateRequest_;
+      std::vector<Waiter> waiters_;
+    };
+
+    /**
+     * Express the Interest of the pending fetch.
+     * @param pendingFetch The PendingFetch.
+     */
+    void
+    expressInterest(const ptr_lib::shared_ptr<PendingFetch>& pendingFetch);
+
+    /**
+     * Remove the pending fetch from pendingFetches_ so that a later call to
+     * doFetch makes a new fetch.
+     * @param pendingFetch The PendingFetch.
+     * @param waiters Set this to the waiters of the pending fetch.
+     */
+    void
+    removePendingFetch
+      (const ptr_lib::shared_ptr<PendingFetch>& pendingFetch,
+       std::vector<Waiter>& waiters);
+
+    /** This is called when a certificate is retrieved. This calls
+     * continueValidation for each waiter.
      * @param interest This is ignored.
      * @param data The data packet of the fetched certificate.
-     * @param state The validation state, from doFetch.
-     * @param continueValidation After fetching, this calls
-     * continueValidation(certificate, state) where certificate is the fetched
-     * certificate and state is the ValidationState.
+     * @param pendingFetch The PendingFetch from doFetch.
      */
     void
     onData
       (const ptr_lib::shared_ptr<const Interest>& interest,
        const ptr_lib::shared_ptr<Data>& data,
-       const ptr_lib::shared_ptr<ValidationState>& state,
-       const CertificateFetcher::ValidationContinuation& continueValidation);
+       const ptr_lib::shared_ptr<PendingFetch>& pendingFetch);
 
     /** This is called when expressing the Interest for a certificate receives a
-     * network Nack. It will re-express the interest if
-     * certificateRequest.nRetriesLeft_ is greater than zero, otherwise this calls
-     * state.fail() .
+     * network Nack. See onFailure.
      * @param interest This is ignored in favor of the Interest in
-     * certificateRequest.
+     * pendingFetch.
      * @param networkNack The received network Nack.
-     * @param certificateRequest The the request with the Interest for fetching
-     * the certificate, from doFetch.
-     * @param state The validation state, from doFetch.
-     * @param continueValidation After fetching, this calls
-     * continueValidation(certificate, state) where certificate is the fetched
-     * certificate and state is the ValidationState.
+     * @param pendingFetch The PendingFetch from doFetch.
      */
     void
     onNetworkNack
       (const ptr_lib::shared_ptr<const Interest>& interest,
        const ptr_lib::shared_ptr<NetworkNack>& networkNack,
-       const ptr_lib::shared_ptr<CertificateRequest>& certificateRequest,
-       const ptr_lib::shared_ptr<ValidationState>& state,
-       const CertificateFetcher::ValidationContinuation& continueValidation);
+       const ptr_lib::shared_ptr<PendingFetch>& pendingFetch);
 
     /** This is called when expressing the Interest for a certificate receives a
-     * timeout. It will re-express the interest if
-     * certificateRequest.nRetriesLeft_ is greater than zero, otherwise this calls
-     * state.fail() .
+     * timeout. See onFailure.
      * @param interest This is ignored in favor of the Interest in
-     * certificateRequest.
-     * @param certificateRequest The the request with the Interest for fetching
-     * the certificate, from doFetch.
-     * @param state The validation state, from doFetch.
-     * @param continueValidation After fetching, this calls
-     * continueValidation(certificate, state) where certificate is the fetched
-     * certificate and state is the ValidationState.
+     * pendingFetch.
+     * @param pendingFetch The PendingFetch from doFetch.
      */
     void
     onTimeout
       (const ptr_lib::shared_ptr<const Interest>& interest,
-       const ptr_lib::shared_ptr<CertificateRequest>& certificateRequest,
-       const ptr_lib::shared_ptr<ValidationState>& state,
-       const CertificateFetcher::ValidationContinuation& continueValidation);
+       const ptr_lib::shared_ptr<PendingFetch>& pendingFetch);
+
+    /**
+     * Decrement nRetriesLeft_ of each waiter's request and call state.fail()
+     * for each waiter with no retries left. If waiters remain, check the
+     * unverified certificate cache as CertificateFetcher::fetch does and
+     * continue validation if the certificate is found, otherwise re-express
+     * the Interest. If no waiters remain, add the certificate name to the
+     * negative cache.
+     * @param pendingFetch The PendingFetch from doFetch.
+     */
+    void
+    onFailure(const ptr_lib::shared_ptr<PendingFetch>& pendingFetch);
+
+    /**
+     * Remove expired entries from negativeCache_.
+     * @param now The current time in milliseconds.
+     */
+    void
+    pruneNegativeCache(MillisecondsSince1970 now);
 
     CertificateFetcherFromNetwork& parent_;
     Face& face_;
+    // The key is the certificate Interest name.
+    std::map<Name, ptr_lib::shared_ptr<PendingFetch> > pendingFetches_;
+    // The key is the certificate Interest name. The value is the time when the
+    // entry expires.
+    std::map<Name, MillisecondsSince1970> negativeCache_;
+    Milliseconds negativeCacheLifetime_;
+    size_t nextNegativeCachePruneSize_;
+    Milliseconds nowOffsetMilliseconds_;
   };
 
   ptr_lib::shared_ptr<Impl> impl_;
@@ -23,11 +23,13 @@
 #ifndef NDN_VALIDATION_POLICY_COMMAND_INTEREST_HPP
 #define NDN_VALIDATION_POLICY_COMMAND_INTEREST_HPP
 
-#include <map>
+#include <list>
 #include "validation-policy.hpp"
 
 namespace ndn {
 
+template<class Value> class HashIndex;
+
 /**
  * ValidationPolicyCommandInterest extends ValidationPolicy as a policy for
  * stop-and-wait command Interests. See:
@@ -189,16 +191,22 @@ private:
     (const Interest& interest, const Name& keyName,
      MillisecondsSince1970 timestamp);
 
+  typedef std::list<LastTimestampRecord> RecordList;
+
   /**
    * Find the record in container_ which has the keyName.
    * @param keyName The key name to search for.
-   * @return The index in container_ of the record, or -1 if not found.
+   * @return An iterator to the record in container_, or container_.end() if
+   * not found.
    */
-  int
+  RecordList::iterator
   findByKeyName(const Name& keyName);
 
   Options options_;
-  std::vector<ptr_lib::shared_ptr<LastTimestampRecord> > container_;
+  // The records in order of lastRefreshed_, so that the oldest is first.
+  RecordList container_;
+  // The hash table of container_ records by keyName_.hash(), for fast lookup.
+  ptr_lib::shared_ptr<HashIndex<RecordList::iterator> > index_;
   Milliseconds nowOffsetMilliseconds_;
 };
 
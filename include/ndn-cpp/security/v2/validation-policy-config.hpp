@@ -24,7 +24,7 @@
 #define NDN_VALIDATION_POLICY_CONFIG_HPP
 
 #include "validation-policy.hpp"
-#include "validator-config/config-rule.hpp"
+#include "validator-config/config-rule-index.hpp"
 
 namespace ndn {
 
@@ -117,6 +117,9 @@ private:
   bool isConfigured_;
   std::vector<ptr_lib::shared_ptr<ConfigRule>> dataRules_;
   std::vector<ptr_lib::shared_ptr<ConfigRule>> interestRules_;
+  // The rules compiled for fast lookup, created by load().
+  ptr_lib::shared_ptr<ConfigRuleIndex> dataRuleIndex_;
+  ptr_lib::shared_ptr<ConfigRuleIndex> interestRuleIndex_;
 };
 
 }
@@ -31,6 +31,7 @@ namespace ndn {
 
 class BoostInfoTree;
 class NdnRegexTopMatcher;
+class NdnRegexAutomaton;
 
 /**
  * A ConfigChecker is an abstract base class for ConfigNameRelationChecker, etc.
@@ -138,6 +139,9 @@ protected:
 
 private:
   ptr_lib::shared_ptr<NdnRegexTopMatcher> regex_;
+  // If the regex can be compiled to an automaton, use it to match instead of
+  // regex_. Otherwise this is null.
+  ptr_lib::shared_ptr<NdnRegexAutomaton> automaton_;
 };
 
 class ConfigHyperRelationChecker : public ConfigChecker {
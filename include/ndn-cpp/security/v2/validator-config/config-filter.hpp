@@ -31,6 +31,7 @@ namespace ndn {
 
 class BoostInfoTree;
 class NdnRegexTopMatcher;
+class NdnRegexAutomaton;
 
 /**
  * ConfigFilter is an abstract base class for RegexNameFilter, etc. used by
@@ -117,6 +118,20 @@ public:
   {
   }
 
+  /**
+   * Get the relation name.
+   * @return The relation name.
+   */
+  const Name&
+  getName() const { return name_; }
+
+  /**
+   * Get the relation type.
+   * @return The relation type as a ConfigNameRelation::Relation enum.
+   */
+  ConfigNameRelation::Relation
+  getRelation() const { return relation_; }
+
 private:
   /**
    * Implementation of the check for match.
@@ -150,6 +165,24 @@ public:
    */
   ConfigRegexNameFilter(const std::string& regexString);
 
+  /**
+   * Get the name components which every matching packet name must start with,
+   * from the leading literal components of a regex which starts with '^'.
+   * @return The literal prefix, which is empty if the regex doesn't have one.
+   */
+  Name
+  getLiteralPrefix() const;
+
+  /**
+   * Get the literal name components which every matching packet name must
+   * contain somewhere, for example /group1/SYNC for the regex
+   * "<group1><>*<SYNC><>$".
+   * @return The required components, which is empty if the regex doesn't have
+   * any.
+   */
+  Name
+  getRequiredComponents() const;
+
 private:
   /**
    * Implementation of the check for match.
@@ -162,6 +195,9 @@ private:
 
 private:
   ptr_lib::shared_ptr<NdnRegexTopMatcher> regex_;
+  // If the regex can be compiled to an automaton, use it to match instead of
+  // regex_. Otherwise this is null.
+  ptr_lib::shared_ptr<NdnRegexAutomaton> automaton_;
 };
 
 }
@@ -0,0 +1,126 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Regents of the University of California.
+ * @author: Jeff Thompson <jefft0@remap.ucla.edu>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+#ifndef NDN_CONFIG_RULE_INDEX_HPP
+#define NDN_CONFIG_RULE_INDEX_HPP
+
+#include <map>
+#include "config-rule.hpp"
+
+namespace ndn {
+
+/**
+ * A ConfigRuleIndex is compiled from the list of ConfigRule for Data or
+ * Interest packets so that findFirstMatch gives the same result as calling
+ * ConfigRule::match for each rule in order, without trying every filter.
+ * The filters are stored in a tree of name components:
+ * - A ConfigRelationNameFilter is stored at the node for its name and is
+ *   decided by the depth of the packet name without calling the filter.
+ * - A ConfigRegexNameFilter is stored at the node for the literal prefix of
+ *   its regex (see ConfigRegexNameFilter::getLiteralPrefix) so that it is only
+ *   evaluated for packet names with that prefix. If the regex has no literal
+ *   prefix, it is stored by one of its required components (see
+ *   ConfigRegexNameFilter::getRequiredComponents) so that it is only evaluated
+ *   for packet names which contain that component.
+ * - Other filter types are stored at the root.
+ * A rule with no filters matches every packet.
+ */
+class ConfigRuleIndex {
+public:
+  /**
+   * Create a ConfigRuleIndex for the list of rules.
+   * @param rules The list of rules in the order from the configuration. All
+   * rules must have getIsForInterest() equal to isForInterest. This keeps a
+   * pointer to each ConfigRule.
+   * @param isForInterest True if the rules are for Interest packets, false if
+   * for Data packets.
+   */
+  ConfigRuleIndex
+    (const std::vector<ptr_lib::shared_ptr<ConfigRule>>& rules,
+     bool isForInterest);
+
+  /**
+   * Find the first rule in the list where ConfigRule::match returns true.
+   * @param packetName The packet name. For a signed interest, the last two
+   * components are skipped but not removed.
+   * @return A pointer to the first matching rule, or 0 if no rule matches.
+   */
+  ConfigRule*
+  findFirstMatch(const Name& packetName);
+
+  /**
+   * Get the number of rules.
+   * @return The number of rules.
+   */
+  size_t
+  size() const { return rules_.size(); }
+
+private:
+  enum EntryType {
+    ENTRY_ALWAYS,              // The rule has no filters.
+    ENTRY_EQUAL,               // A ConfigRelationNameFilter with EQUAL.
+    ENTRY_IS_PREFIX_OF,        // A ConfigRelationNameFilter with IS_PREFIX_OF.
+    ENTRY_IS_STRICT_PREFIX_OF, // ... with IS_STRICT_PREFIX_OF.
+    ENTRY_CANDIDATE            // Call the filter to check for a match.
+  };
+
+  class Entry {
+  public:
+    Entry(size_t ruleIndex, EntryType type, ConfigFilter* filter)
+    : ruleIndex_(ruleIndex), type_(type), filter_(filter)
+    {
+    }
+
+    size_t ruleIndex_;
+    EntryType type_;
+    ConfigFilter* filter_;
+  };
+
+  class Node {
+  public:
+    std::map<Name::Component, size_t> children_;
+    std::vector<Entry> entries_;
+  };
+
+  /**
+   * Get the node for the name, creating nodes as needed.
+   * @param name The name of the node.
+   * @return The index of the node in nodes_.
+   */
+  size_t
+  getNode(const Name& name);
+
+  static bool
+  entryRuleIndexLess(const Entry* entry1, const Entry* entry2);
+
+  std::vector<ptr_lib::shared_ptr<ConfigRule>> rules_;
+  bool isForInterest_;
+  // nodes_[0] is the root.
+  std::vector<Node> nodes_;
+  // The key is a required component of the regex filters in the entries.
+  std::map<Name::Component, std::vector<Entry>> requiredComponentEntries_;
+  // Scratch space for findFirstMatch.
+  std::vector<const Entry*> candidates_;
+};
+
+}
+
+#endif
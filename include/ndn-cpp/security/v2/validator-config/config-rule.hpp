@@ -72,6 +72,13 @@ public:
     filters_.push_back(filter);
   }
 
+  /**
+   * Get the list of filters.
+   * @return The list of ConfigFilter.
+   */
+  const std::vector<ptr_lib::shared_ptr<ConfigFilter>>&
+  getFilters() const { return filters_; }
+
   /**
    * Add the ConfigChecker to the list of checkers.
    * @param checker The ConfigChecker.
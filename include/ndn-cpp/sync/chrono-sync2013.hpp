@@ -35,6 +35,7 @@ namespace Sync { class SyncState; }
 namespace ndn {
 
 class DigestTree;
+class DigestLog;
 
 /**
  * ChronoSync2013 implements the NDN ChronoSync protocol as described in the
@@ -268,6 +269,22 @@ public:
     return impl_->getSequenceNo();
   }
 
+  /**
+   * Set the maximum number of entries in the digest log, which remembers each
+   * root digest so that this can answer a sync interest for an older digest
+   * with only the sync state messages after it. When the log is full, this
+   * evicts the oldest entry. If another user sends a sync interest with a
+   * digest which is not in the log and has possibly been evicted, this answers
+   * it with the full state of the digest tree (as for a recovery interest).
+   * @param maxDigestLogSize The maximum number of entries, or 0 for no limit.
+   * The default is 10000.
+   */
+  void
+  setMaxDigestLogSize(size_t maxDigestLogSize)
+  {
+    impl_->setMaxDigestLogSize(maxDigestLogSize);
+  }
+
   /**
    * Unregister callbacks so that this does not respond to interests anymore.
    * If you will delete this ChronoSync2013 object while your application is
@@ -285,23 +302,6 @@ public:
   }
 
 private:
-  class DigestLogEntry {
-  public:
-    DigestLogEntry
-      (const std::string& digest,
-       const google::protobuf::RepeatedPtrField<Sync::SyncState>& data);
-
-    const std::string&
-    getDigest() const { return digest_; }
-
-    const google::protobuf::RepeatedPtrField<Sync::SyncState>&
-    getData() const { return *data_; }
-
-  private:
-    std::string digest_;
-    ptr_lib::shared_ptr<google::protobuf::RepeatedPtrField<Sync::SyncState> > data_;
-  };
-
   /**
    * ChronoSync2013::Impl does the work of ChronoSync2013. It is a separate
    * class so that ChronoSync2013 can create an instance in a shared_ptr to
@@ -357,6 +357,12 @@ private:
     int
     getSequenceNo() const { return sequenceNo_; }
 
+    /**
+     * See ChronoSync2013::setMaxDigestLogSize.
+     */
+    void
+    setMaxDigestLogSize(size_t maxDigestLogSize);
+
     /**
      * See ChronoSync2013::shutdown.
      */
@@ -389,10 +395,6 @@ private:
     bool
     update(const google::protobuf::RepeatedPtrField<Sync::SyncState >& content);
 
-    // Search the digest log by digest.
-    int
-    logFind(const std::string& digest) const;
-
     /**
      * Process the sync interest from the applicationBroadcastPrefix. If we can't
      * satisfy the interest, add it to the pending interest table in the
@@ -419,6 +421,18 @@ private:
     processRecoveryInterest
       (const Interest& interest, const std::string& syncDigest, Face& face);
 
+    /**
+     * Make a data packet with the given name and a sync state message for
+     * every node in the digest tree. Sign and send.
+     * @param name The name for the data packet.
+     * @param isFreshnessLimited If true, set the freshness period so that the
+     * reply does not stay long in caches, since a later reply for the same
+     * name can be different.
+     * @param face The Face for calling putData.
+     */
+    void
+    sendFullState(const Name& name, bool isFreshnessLimited, Face& face);
+
     /**
      * Common interest processing, using digest log to find the difference after
      * syncDigest. Return true if sent a data packet to satisfy the interest,
@@ -465,7 +479,7 @@ private:
     Milliseconds syncLifetime_;
     OnReceivedSyncState onReceivedSyncState_;
     OnInitialized onInitialized_;
-    std::vector<ptr_lib::shared_ptr<DigestLogEntry> > digestLog_;
+    ptr_lib::shared_ptr<DigestLog> digestLog_;
     ptr_lib::shared_ptr<DigestTree> digestTree_;
     std::string applicationDataPrefixUri_;
     const Name applicationBroadcastPrefix_;
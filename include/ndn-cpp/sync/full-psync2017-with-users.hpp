@@ -136,6 +136,32 @@ public:
     impl_->publishName(prefix, sequenceNo);
   }
 
+  /**
+   * Set the mode for hashing each Name for the IBLT. All the users in the
+   * sync group must use the same mode. This must be called right after the
+   * constructor. See FullPSync2017::setNameHashMode.
+   * @param nameHashMode The PSyncProducerBase::NameHashMode.
+   * @throws runtime_error if names have already been published or received.
+   */
+  void
+  setNameHashMode(PSyncProducerBase::NameHashMode nameHashMode)
+  {
+    impl_->setNameHashMode(nameHashMode);
+  }
+
+  /**
+   * Set the zlib compression level for the IBLT which is sent in each sync
+   * Interest. See FullPSync2017::setCompressionLevel.
+   * @param compressionLevel The level from 0 (no compression) to 9 (best
+   * compression, which is the default), or -1 for the zlib default.
+   * @throws runtime_error if compressionLevel is not from -1 to 9.
+   */
+  void
+  setCompressionLevel(int compressionLevel)
+  {
+    impl_->setCompressionLevel(compressionLevel);
+  }
+
 private:
   /**
    * FullPSync2017WithUsers::Impl does the work of FullPSync2017WithUsers. It is a
@@ -174,6 +200,18 @@ private:
     void
     publishName(const Name& prefix, int sequenceNo);
 
+    void
+    setNameHashMode(PSyncProducerBase::NameHashMode nameHashMode)
+    {
+      fullPSync_->setNameHashMode(nameHashMode);
+    }
+
+    void
+    setCompressionLevel(int compressionLevel)
+    {
+      fullPSync_->setCompressionLevel(compressionLevel);
+    }
+
   private:
     /**
      * This is called when new names are received to check if the name can be
@@ -122,6 +122,47 @@ public:
     impl_->removeName(name);
   }
 
+  /**
+   * Set the zlib compression level for the IBLT which is sent in each sync
+   * Interest and sync Data name. A lower level uses less CPU to make each
+   * sync Interest but makes a larger name. Any level can be decoded by the
+   * other users, so this does not need to be the same in the sync group.
+   * @param compressionLevel The level from 0 (no compression, for example in a
+   * local sync group where the name size matters less) to 9 (best compression,
+   * which is the default), or -1 for the zlib default.
+   * @throws runtime_error if compressionLevel is not from -1 to 9.
+   */
+  void
+  setCompressionLevel(int compressionLevel)
+  {
+    impl_->setCompressionLevel(compressionLevel);
+  }
+
+  /**
+   * Set the mode for hashing each Name for the IBLT. The default
+   * PSyncProducerBase::NAME_HASH_URI hashes the name URI, which is compatible
+   * with the PSync library. PSyncProducerBase::NAME_HASH_WIRE_ENCODING hashes
+   * the TLV wire encoding, which is faster to publish. All the users in the
+   * sync group must use the same mode. This must be called right after the
+   * constructor, before publishing or receiving names.
+   * @param nameHashMode The PSyncProducerBase::NameHashMode.
+   * @throws runtime_error if names have already been published or received.
+   */
+  void
+  setNameHashMode(PSyncProducerBase::NameHashMode nameHashMode)
+  {
+    impl_->setNameHashMode(nameHashMode);
+  }
+
+  /**
+   * Get the hash of the Name for the IBLT, using the mode from
+   * setNameHashMode.
+   * @param name The Name to hash.
+   * @return The hash.
+   */
+  uint32_t
+  getNameHash(const Name& name) const { return impl_->getNameHash(name); }
+
   static const int DEFAULT_SYNC_INTEREST_LIFETIME = 1000;
   static const int DEFAULT_SYNC_REPLY_FRESHNESS_PERIOD = 1000;
 
@@ -158,6 +199,18 @@ private:
     void
     removeName(const Name& name) { removeFromIblt(name); }
 
+    void
+    setNameHashMode(NameHashMode nameHashMode);
+
+    uint32_t
+    getNameHash(const Name& name) const
+    {
+      return PSyncProducerBase::getNameHash(name);
+    }
+
+    void
+    setCompressionLevel(int compressionLevel);
+
   private:
     class PendingEntryInfoFull {
     public:
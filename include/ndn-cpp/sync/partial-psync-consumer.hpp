@@ -0,0 +1,282 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2019-2020 Regents of the University of California.
+ * @author: Jeff Thompson <jefft0@remap.ucla.edu>
+ * @author: From the PSync library https://github.com/named-data/PSync/blob/master/PSync/consumer.hpp
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+#ifndef NDN_PARTIAL_PSYNC_CONSUMER_HPP
+#define NDN_PARTIAL_PSYNC_CONSUMER_HPP
+
+#include <map>
+#include "../face.hpp"
+#include "../util/segment-fetcher.hpp"
+#include "psync-missing-data-info.hpp"
+
+namespace ndn {
+
+class BloomFilter;
+
+/**
+ * PartialPSyncConsumer implements the consumer side of the partial sync logic
+ * of PSync, to get updates from a PartialPSync2017Producer for only the user
+ * prefixes that the application subscribes to. First call sendHelloInterest.
+ * When the onReceiveHelloData callback gives the available user prefixes,
+ * call addSubscription for the prefixes of interest and then call
+ * sendSyncInterest. After that, this sends a new sync Interest whenever it
+ * gets a reply and calls onUpdate for new sequence numbers of the subscribed
+ * prefixes. Currently, fetching the data (named by the user prefix plus the
+ * sequence number) needs to be handled by the application. See
+ * PartialPSync2017Producer for details on the protocol.
+ * (Note: This is modeled on the Consumer of the PSync library, but it does not
+ * interoperate with it. The Bloom filter uses a different hash and bit layout,
+ * so the hello and sync Interests use the operation components "partial-hello"
+ * and "partial-sync" instead of the PSync "hello" and "sync". Use
+ * PartialPSync2017Producer as the producer.)
+ */
+class PartialPSyncConsumer {
+public:
+  typedef func_lib::function<void
+    (const ptr_lib::shared_ptr<std::vector<Name>>& prefixes)> OnReceiveHelloData;
+  typedef func_lib::function<void
+    (const ptr_lib::shared_ptr<std::vector<ptr_lib::shared_ptr<PSyncMissingDataInfo>>>& updates)> OnUpdate;
+
+  /**
+   * Create a PartialPSyncConsumer.
+   * @param face The application's Face.
+   * @param syncPrefix The prefix Name of the sync group, which is copied.
+   * @param onReceiveHelloData When the reply to sendHelloInterest is received,
+   * this calls onReceiveHelloData(prefixes) where prefixes is the list of the
+   * producer's user prefixes. The application can call addSubscription and
+   * sendSyncInterest in this callback.
+   * NOTE: The library will log any exceptions thrown by this callback, but for
+   * better error handling the callback should catch and properly handle any
+   * exceptions.
+   * @param onUpdate When there is new data for a subscribed prefix, this calls
+   * onUpdate(updates) where updates is a list of PSyncMissingDataInfo.
+   * NOTE: The library will log any exceptions thrown by this callback, but for
+   * better error handling the callback should catch and properly handle any
+   * exceptions.
+   * @param expectedNSubscriptions The expected number of subscriptions, used
+   * to size the Bloom filter.
+   * @param falsePositiveProbability (optional) The false positive probability
+   * of the Bloom filter, from 0.001 to 0.999. If omitted, use 0.001.
+   * @param helloInterestLifetime (optional) The Interest lifetime for the hello
+   * Interest, in milliseconds. If omitted, use
+   * DEFAULT_HELLO_INTEREST_LIFETIME.
+   * @param syncInterestLifetime (optional) The Interest lifetime for the sync
+   * Interests, in milliseconds. If omitted, use
+   * DEFAULT_SYNC_INTEREST_LIFETIME.
+   * @throws runtime_error if falsePositiveProbability is out of range.
+   */
+  PartialPSyncConsumer
+    (Face& face, const Name& syncPrefix,
+     const OnReceiveHelloData& onReceiveHelloData, const OnUpdate& onUpdate,
+     size_t expectedNSubscriptions, double falsePositiveProbability = 0.001,
+     Milliseconds helloInterestLifetime = DEFAULT_HELLO_INTEREST_LIFETIME,
+     Milliseconds syncInterestLifetime = DEFAULT_SYNC_INTEREST_LIFETIME)
+  : impl_(new Impl
+          (face, syncPrefix, onReceiveHelloData, onUpdate,
+           expectedNSubscriptions, falsePositiveProbability,
+           helloInterestLifetime, syncInterestLifetime))
+  {
+  }
+
+  /**
+   * Send the hello Interest /<sync-prefix>/partial-hello to get the
+   * producer's user prefixes. When the reply is received, call
+   * onReceiveHelloData.
+   */
+  void
+  sendHelloInterest() { impl_->sendHelloInterest(); }
+
+  /**
+   * Send the sync Interest /<sync-prefix>/partial-sync/<Bloom-filter>/<IBLT>
+   * with the subscribed prefixes in the Bloom filter and the IBLT from the
+   * producer's last reply. After this, a new sync Interest is sent whenever a
+   * reply is received or the Interest fails. This replaces a sync Interest
+   * which was already sent. You must call sendHelloInterest and get the reply
+   * first.
+   */
+  void
+  sendSyncInterest() { impl_->sendSyncInterest(); }
+
+  /**
+   * Subscribe to the user prefix. Call sendSyncInterest after subscribing so
+   * that the producer gets the new Bloom filter.
+   * @param prefix The user prefix.
+   * @param sequenceNo (optional) The sequence number which the application
+   * already has, so that onUpdate is called for greater sequence numbers. If
+   * omitted or -1, use the sequence number from the hello reply, or 0 if the
+   * prefix was not in the hello reply.
+   * @return True if the subscription was added, or false if already
+   * subscribed.
+   */
+  bool
+  addSubscription(const Name& prefix, int sequenceNo = -1)
+  {
+    return impl_->addSubscription(prefix, sequenceNo);
+  }
+
+  /**
+   * Remove the subscription to the user prefix. Call sendSyncInterest after
+   * this so that the producer gets the new Bloom filter.
+   * @param prefix The user prefix. If not subscribed, do nothing.
+   */
+  void
+  removeSubscription(const Name& prefix) { impl_->removeSubscription(prefix); }
+
+  /**
+   * Check if the user prefix is subscribed.
+   * @param prefix The user prefix.
+   * @return True if subscribed.
+   */
+  bool
+  isSubscribed(const Name& prefix) const { return impl_->isSubscribed(prefix); }
+
+  /**
+   * Get the latest sequence number of the subscribed user prefix.
+   * @param prefix The user prefix.
+   * @return The sequence number, or -1 if not subscribed.
+   */
+  int
+  getSequenceNo(const Name& prefix) const
+  {
+    return impl_->getSequenceNo(prefix);
+  }
+
+  static const int DEFAULT_HELLO_INTEREST_LIFETIME = 1000;
+  static const int DEFAULT_SYNC_INTEREST_LIFETIME = 1000;
+
+private:
+  /**
+   * PartialPSyncConsumer::Impl does the work of PartialPSyncConsumer. It is a
+   * separate class so that PartialPSyncConsumer can create an instance in a
+   * shared_ptr to use in callbacks.
+   */
+  class Impl : public ptr_lib::enable_shared_from_this<Impl> {
+  public:
+    /**
+     * Create a new Impl, which should belong to a shared_ptr. See the
+     * PartialPSyncConsumer constructor for parameter documentation.
+     */
+    Impl
+      (Face& face, const Name& syncPrefix,
+       const OnReceiveHelloData& onReceiveHelloData, const OnUpdate& onUpdate,
+       size_t expectedNSubscriptions, double falsePositiveProbability,
+       Milliseconds helloInterestLifetime, Milliseconds syncInterestLifetime);
+
+    void
+    sendHelloInterest();
+
+    void
+    sendSyncInterest();
+
+    bool
+    addSubscription(const Name& prefix, int sequenceNo);
+
+    void
+    removeSubscription(const Name& prefix);
+
+    bool
+    isSubscribed(const Name& prefix) const
+    {
+      return subscriptions_.find(prefix) != subscriptions_.end();
+    }
+
+    int
+    getSequenceNo(const Name& prefix) const;
+
+  private:
+    /**
+     * This is the VerifySegment callback for SegmentFetcher to save the name
+     * of the received Data, which has the producer's IBLT.
+     * @param dataName Set this to the Data name.
+     * @param data The received Data.
+     * @return True to accept the Data.
+     */
+    static bool
+    saveDataName
+      (const ptr_lib::shared_ptr<Name>& dataName,
+       const ptr_lib::shared_ptr<Data>& data);
+
+    /**
+     * Process the hello Data content, which has names /<prefix>/<sequence-no>.
+     * Save the IBLT from the Data name and call onReceiveHelloData_.
+     */
+    void
+    onHelloData(const Blob& content, const ptr_lib::shared_ptr<Name>& dataName);
+
+    /**
+     * Process the sync Data content. Save the IBLT from the Data name, call
+     * onUpdate_ for new sequence numbers of subscribed prefixes, and send a new
+     * sync Interest.
+     * @param syncInterestCount The value of syncInterestCount_ when the sync
+     * Interest was sent. If it has changed, ignore this old reply.
+     */
+    void
+    onSyncData
+      (const Blob& content, const ptr_lib::shared_ptr<Name>& dataName,
+       uint64_t syncInterestCount);
+
+    static void
+    onHelloError(SegmentFetcher::ErrorCode errorCode, const std::string& message);
+
+    /**
+     * Send a new sync Interest after a random delay, unless a newer sync
+     * Interest was sent.
+     */
+    void
+    onSyncError
+      (SegmentFetcher::ErrorCode errorCode, const std::string& message,
+       uint64_t syncInterestCount);
+
+    void
+    retrySyncInterest(uint64_t syncInterestCount);
+
+    /**
+     * Get the IBLT component from the name of a hello or sync Data
+     * /.../<IBLT>/<version>/<segment-no> .
+     * @return True if dataName has the IBLT, otherwise false.
+     */
+    bool
+    setIbltFromDataName(const Name& dataName);
+
+    Face& face_;
+    Name syncPrefix_;
+    OnReceiveHelloData onReceiveHelloData_;
+    OnUpdate onUpdate_;
+    ptr_lib::shared_ptr<BloomFilter> bloomFilter_;
+    Milliseconds helloInterestLifetime_;
+    Milliseconds syncInterestLifetime_;
+    // The encoded IBLT from the producer's last reply, or empty if none.
+    Name::Component iblt_;
+    // The key is the subscribed prefix. The value is the sequence number.
+    std::map<Name, int> subscriptions_;
+    // The key is the prefix from the hello reply. The value is the sequence
+    // number.
+    std::map<Name, int> availableSubscriptions_;
+    uint64_t syncInterestCount_;
+  };
+
+  ptr_lib::shared_ptr<Impl> impl_;
+};
+
+}
+
+#endif
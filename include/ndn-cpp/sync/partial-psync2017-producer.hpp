@@ -0,0 +1,324 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2019-2020 Regents of the University of California.
+ * @author: Jeff Thompson <jefft0@remap.ucla.edu>
+ * @author: From the PSync library https://github.com/named-data/PSync/blob/master/PSync/partial-producer.hpp
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+#ifndef NDN_PARTIAL_PSYNC2017_PRODUCER_HPP
+#define NDN_PARTIAL_PSYNC2017_PRODUCER_HPP
+
+#include <map>
+#include "../face.hpp"
+#include "../security/key-chain.hpp"
+#include "psync-producer-base.hpp"
+
+namespace ndn {
+
+class PSyncSegmentPublisher;
+class PSyncUserPrefixes;
+class BloomFilter;
+
+/**
+ * PartialPSync2017Producer implements the producer side of the partial sync
+ * logic of PSync, where a consumer subscribes to some of the user prefixes of
+ * the producer. The application should call publishName whenever it wants to
+ * let consumers know that new data with a new sequence number is available
+ * for the user prefix. Multiple user prefixes can be added by using
+ * addUserNode. Currently, fetching and publishing the data (named by the user
+ * prefix plus the sequence number) needs to be handled by the application.
+ * A consumer such as PartialPSyncConsumer first sends a hello Interest
+ * /<sync-prefix>/partial-hello and gets all the user prefixes with their
+ * sequence numbers. It then sends a sync Interest
+ * /<sync-prefix>/partial-sync/<Bloom-filter>/<IBLT> where the Bloom filter has
+ * its subscribed prefixes and the IBLT is from the producer's last reply. The
+ * producer answers with only the changed names which are in the Bloom filter.
+ * The Partial PSync protocol is described in Section G "Partial-Data
+ * Synchronization" of:
+ * https://named-data.net/wp-content/uploads/2017/05/scalable_name-based_data_synchronization.pdf
+ * (Note: This is modeled on the PartialProducer of the PSync library, but it
+ * does not interoperate with it. The Bloom filter uses a different hash and
+ * bit layout, so the hello and sync Interests use the operation components
+ * "partial-hello" and "partial-sync" instead of the PSync "hello" and "sync".
+ * Use PartialPSyncConsumer as the consumer.)
+ */
+class PartialPSync2017Producer {
+public:
+  /**
+   * Create a PartialPSync2017Producer.
+   * @param expectedNEntries The expected number of entries in the IBLT. This
+   * should be at least the number of names which change between the sync
+   * Interests of a consumer.
+   * @param face The application's Face.
+   * @param syncPrefix The prefix Name of the sync group, which is copied.
+   * @param userPrefix The prefix Name of the first user in the group, which is
+   * copied. However, if this Name is empty, it is not added and you must call
+   * addUserNode.
+   * @param keyChain The KeyChain for signing Data packets.
+   * @param helloReplyFreshnessPeriod (optional) The freshness period of the
+   * hello Data packet, in milliseconds. If omitted, use
+   * DEFAULT_HELLO_REPLY_FRESHNESS_PERIOD.
+   * @param syncReplyFreshnessPeriod (optional) The freshness period of the sync
+   * Data packet, in milliseconds. If omitted, use
+   * DEFAULT_SYNC_REPLY_FRESHNESS_PERIOD.
+   * @param signingInfo (optional) The SigningInfo for signing Data packets,
+   * which is copied. If omitted, use the default SigningInfo().
+   */
+  PartialPSync2017Producer
+    (size_t expectedNEntries, Face& face, const Name& syncPrefix,
+     const Name& userPrefix, KeyChain& keyChain,
+     Milliseconds helloReplyFreshnessPeriod = DEFAULT_HELLO_REPLY_FRESHNESS_PERIOD,
+     Milliseconds syncReplyFreshnessPeriod = DEFAULT_SYNC_REPLY_FRESHNESS_PERIOD,
+     const SigningInfo& signingInfo = SigningInfo())
+  : impl_(new Impl
+          (expectedNEntries, face, syncPrefix, keyChain,
+           helloReplyFreshnessPeriod, syncReplyFreshnessPeriod, signingInfo))
+  {
+    impl_->initialize(userPrefix);
+  }
+
+  /**
+   * Return the current sequence number of the given user prefix.
+   * @param prefix The user prefix for the sequence number.
+   * @return The sequence number for the user prefix, or -1 if not found.
+   */
+  int
+  getSequenceNo(const Name& prefix) const
+  {
+    return impl_->getSequenceNo(prefix);
+  }
+
+  /**
+   * Add a user node for synchronization based on the prefix Name, and
+   * initialize the sequence number to zero. However, if the prefix Name already
+   * exists, then do nothing and return false. This does not add sequence number
+   * zero to the IBLT.
+   * @param prefix The prefix Name of the user node to be added.
+   * @return True if the user node with the prefix Name was added, false if the
+   * prefix Name already exists.
+   */
+  bool
+  addUserNode(const Name& prefix) { return impl_->addUserNode(prefix); }
+
+  /**
+   * Remove the user node from the synchronization. This erases the prefix from
+   * the IBLT and other tables.
+   * @param prefix The prefix Name of the user node to be removed. If there is
+   * no user node with this prefix, do nothing.
+   */
+  void
+  removeUserNode(const Name& prefix) { impl_->removeUserNode(prefix); }
+
+  /**
+   * Publish the sequence number for the prefix Name to inform the consumers
+   * which subscribe to it. (addUserNode needs to be called before this to add
+   * the prefix, if it was not already added via the constructor.)
+   * @param prefix the prefix Name to be updated.
+   * @param sequenceNo (optional) The sequence number of the user prefix to be
+   * set in the IBLT. However, if sequenceNo is omitted or -1, then the existing
+   * sequence number is incremented by 1.
+   */
+  void
+  publishName(const Name& prefix, int sequenceNo = -1)
+  {
+    impl_->publishName(prefix, sequenceNo);
+  }
+
+  /**
+   * Set the mode for hashing each Name for the IBLT. The consumer only returns
+   * the IBLT it received, so this does not need to match the consumers. This
+   * must be called right after the constructor. See
+   * FullPSync2017::setNameHashMode.
+   * @param nameHashMode The PSyncProducerBase::NameHashMode.
+   * @throws runtime_error if names have already been published.
+   */
+  void
+  setNameHashMode(PSyncProducerBase::NameHashMode nameHashMode)
+  {
+    impl_->setNameHashMode(nameHashMode);
+  }
+
+  /**
+   * Set the zlib compression level for the IBLT which is sent in each hello
+   * and sync Data name. See FullPSync2017::setCompressionLevel.
+   * @param compressionLevel The level from 0 (no compression) to 9 (best
+   * compression, which is the default), or -1 for the zlib default.
+   * @throws runtime_error if compressionLevel is not from -1 to 9.
+   */
+  void
+  setCompressionLevel(int compressionLevel)
+  {
+    impl_->setCompressionLevel(compressionLevel);
+  }
+
+  /**
+   * Get the name component for the hello Interest which follows the sync
+   * prefix.
+   * @return The "partial-hello" name component.
+   */
+  static const Name::Component&
+  getHelloComponent();
+
+  /**
+   * Get the name component for the sync Interest which follows the sync
+   * prefix.
+   * @return The "partial-sync" name component.
+   */
+  static const Name::Component&
+  getSyncComponent();
+
+  static const int DEFAULT_HELLO_REPLY_FRESHNESS_PERIOD = 1000;
+  static const int DEFAULT_SYNC_REPLY_FRESHNESS_PERIOD = 1000;
+
+private:
+  /**
+   * PartialPSync2017Producer::Impl does the work of PartialPSync2017Producer.
+   * It is a separate class so that PartialPSync2017Producer can create an
+   * instance in a shared_ptr to use in callbacks.
+   */
+  class Impl : public PSyncProducerBase {
+  public:
+    /**
+     * Create a new Impl, which should belong to a shared_ptr. Then you must
+     * call initialize(). See the PartialPSync2017Producer constructor for
+     * parameter documentation.
+     */
+    Impl
+      (size_t expectedNEntries, Face& face, const Name& syncPrefix,
+       KeyChain& keyChain, Milliseconds helloReplyFreshnessPeriod,
+       Milliseconds syncReplyFreshnessPeriod, const SigningInfo& signingInfo);
+
+    /**
+     * Complete the work of the constructor. This is needed because we can't
+     * call shared_from_this() in the constructor.
+     * @param userPrefix The first user prefix, or an empty Name for none.
+     */
+    void
+    initialize(const Name& userPrefix);
+
+    int
+    getSequenceNo(const Name& prefix) const;
+
+    bool
+    addUserNode(const Name& prefix);
+
+    void
+    removeUserNode(const Name& prefix);
+
+    void
+    publishName(const Name& prefix, int sequenceNo);
+
+    void
+    setNameHashMode(NameHashMode nameHashMode);
+
+    void
+    setCompressionLevel(int compressionLevel);
+
+  private:
+    class PendingEntryInfo {
+    public:
+      PendingEntryInfo
+        (const ptr_lib::shared_ptr<BloomFilter>& bloomFilter,
+         const ptr_lib::shared_ptr<InvertibleBloomLookupTable>& iblt)
+      : bloomFilter_(bloomFilter), iblt_(iblt), isRemoved_(false)
+      {}
+
+      ptr_lib::shared_ptr<BloomFilter> bloomFilter_;
+      ptr_lib::shared_ptr<InvertibleBloomLookupTable> iblt_;
+      bool isRemoved_;
+    };
+
+    /**
+     * This is called for an Interest under the sync prefix. Reply from the
+     * segment store if possible. Otherwise call onHelloInterest or
+     * onSyncInterest based on the component after the sync prefix.
+     */
+    void
+    onInterest
+      (const ptr_lib::shared_ptr<const Name>& prefixName,
+       const ptr_lib::shared_ptr<const Interest>& interest, Face& face,
+       uint64_t interestFilterId,
+       const ptr_lib::shared_ptr<const InterestFilter>& filter);
+
+    /**
+     * Reply to the hello Interest with all the user prefixes and their
+     * sequence numbers as names /<prefix>/<sequence-number>. The Data name is
+     * /<sync-prefix>/partial-hello/<own-IBLT>/<version>/<segment>.
+     * @param interest The hello Interest.
+     */
+    void
+    onHelloInterest(const Interest& interest);
+
+    /**
+     * Process the sync Interest
+     * /<sync-prefix>/partial-sync/<Bloom-filter>/<IBLT>.
+     * Get the difference between our IBLT and the IBLT in the Interest. Reply
+     * with the positive names whose prefix is in the Bloom filter. If the
+     * difference can't be decoded, reply with the names of all the prefixes in
+     * the Bloom filter so that the consumer can catch up. If there is nothing
+     * to send, add the Interest to pendingEntries_.
+     * @param interest The sync Interest.
+     * @param interestName The Interest name without the version and segment.
+     */
+    void
+    onSyncInterest(const Interest& interest, const Name& interestName);
+
+    /**
+     * Send the content as segmented Data named
+     * <interestName>/<own-IBLT>/<version>/<segment>.
+     * @param interestName The Interest name without the version and segment.
+     * @param content The encoded PSyncState.
+     */
+    void
+    sendSyncData(const Name& interestName, Blob content);
+
+    /**
+     * Satisfy the pending sync Interests whose Bloom filter has the prefix by
+     * sending the new name /<prefix>/<sequenceNo>.
+     */
+    void
+    satisfyPendingSyncInterests(const Name& prefix, int sequenceNo);
+
+    /**
+     * Remove the entry from pendingEntries_ which has the name. However, if
+     * entry->isRemoved_ is true, do nothing. Therefore, if an entry is
+     * directly removed from pendingEntries_, it should set isRemoved_.
+     * @param name The key in the pendingEntries_ map for the entry to remove.
+     * @param entry A (possibly earlier and removed) entry from when it was
+     * inserted into the pendingEntries_ map.
+     */
+    void
+    delayedRemovePendingEntry
+      (const Name& name, const ptr_lib::shared_ptr<PendingEntryInfo>& entry);
+
+    Face& face_;
+    KeyChain& keyChain_;
+    SigningInfo signingInfo_;
+    Milliseconds helloReplyFreshnessPeriod_;
+    ptr_lib::shared_ptr<PSyncSegmentPublisher> segmentPublisher_;
+    ptr_lib::shared_ptr<PSyncUserPrefixes> prefixes_;
+    std::map<Name, ptr_lib::shared_ptr<PendingEntryInfo> > pendingEntries_;
+    uint64_t registeredPrefix_;
+  };
+
+  ptr_lib::shared_ptr<Impl> impl_;
+};
+
+}
+
+#endif
@@ -23,18 +23,31 @@
 #ifndef NDN_PSYNC_PRODUCER_BASE_HPP
 #define NDN_PSYNC_PRODUCER_BASE_HPP
 
-#include <map>
+#include <list>
 #include "../name.hpp"
 
 namespace ndn {
 
 class InvertibleBloomLookupTable;
+template<class Value> class HashIndex;
 
 /**
  * PSyncProducerBase is a base class for PsyncPartialProducer::Impl and
  * FullPSync2017::Impl.
  */
 class PSyncProducerBase : public ptr_lib::enable_shared_from_this<PSyncProducerBase> {
+public:
+  /**
+   * A NameHashMode selects how a Name is hashed for the IBLT. All the members
+   * of a sync group must use the same mode.
+   */
+  enum NameHashMode {
+    /** Hash the URI of the name. This is compatible with the PSync library. */
+    NAME_HASH_URI = 0,
+    /** Hash the TLV wire encoding of the name, which is faster. */
+    NAME_HASH_WIRE_ENCODING = 1
+  };
+
 protected:
   /**
    * Create a PSyncProducerBase.
@@ -48,22 +61,72 @@ protected:
      Milliseconds syncReplyFreshnessPeriod);
 
   /**
-   * Insert the URI of the name into the iblt_, and update nameToHash_ and
-   * hashToName_.
+   * Set the mode for hashing a Name for the IBLT. This must be called before
+   * any names are inserted.
+   * @param nameHashMode The NameHashMode.
+   * @throws runtime_error if names have already been inserted.
+   */
+  void
+  setNameHashMode(NameHashMode nameHashMode);
+
+  /**
+   * Get the hash of the name for the IBLT, using the NameHashMode.
+   * @param name The Name to hash.
+   * @return The hash.
+   */
+  uint32_t
+  getNameHash(const Name& name) const;
+
+  /**
+   * Insert the hash of the name into the iblt_, and add the name to the name
+   * table. However, if the name is already in the name table, do nothing.
    * @param name The Name to insert.
    */
   void
   insertIntoIblt(const Name& name);
 
   /**
-   * If the Name is in nameToHash_, then remove the hash from the iblt_,
-   * nameToHash_ and hashToName_. However, if the Name is not in nameToHash_
-   * then do nothing.
+   * If the Name is in the name table, then remove its hash from the iblt_ and
+   * remove it from the name table. However, if the Name is not in the name
+   * table then do nothing.
    * @param name The Name to remove.
    */
   void
   removeFromIblt(const Name& name);
 
+  /**
+   * Check if the name has been inserted with insertIntoIblt.
+   * @param name The Name to check.
+   * @return True if the name is in the name table.
+   */
+  bool
+  hasName(const Name& name) const
+  {
+    return findByName(name) != names_.end();
+  }
+
+  /**
+   * Find the name in the name table with the given IBLT hash.
+   * @param hash The hash from getNameHash.
+   * @return A pointer to the Name in the name table, or 0 if not found. The
+   * pointer is invalid after the name is removed.
+   */
+  const Name*
+  findNameByHash(uint32_t hash) const;
+
+  class NameEntry {
+  public:
+    NameEntry(const Name& name, uint32_t hash)
+    : name_(name), hash_(hash)
+    {
+    }
+
+    Name name_;
+    uint32_t hash_;
+  };
+
+  typedef std::list<NameEntry> NameList;
+
   /**
    * This is called when registerPrefix fails to log an error message.
    */
@@ -76,16 +139,25 @@ protected:
   // threshold, and whether we need to update the other IBLT.
   size_t threshold_;
 
-  // nameToHash_ and hashToName_ are just for looking up the hash more quickly
-  // (instead of calculating it again).
-  // The key is the Name. The value is the hash.
-  std::map<Name, uint32_t> nameToHash_;
-  // The key is the hash. The value is the Name.
-  std::map<uint32_t, Name> hashToName_;
+  // names_ has the inserted names with their hash, so that we don't have to
+  // calculate the hash again. Iterate over it to get all the names.
+  NameList names_;
 
   Name syncPrefix_;
 
   Milliseconds syncReplyFreshnessPeriod_;
+
+private:
+  NameList::iterator
+  findByName(const Name& name);
+
+  NameList::const_iterator
+  findByName(const Name& name) const;
+
+  NameHashMode nameHashMode_;
+  // The hash tables of names_ entries by Name::hash() and by the IBLT hash.
+  ptr_lib::shared_ptr<HashIndex<NameList::iterator> > nameIndex_;
+  ptr_lib::shared_ptr<HashIndex<NameList::iterator> > hashIndex_;
 };
 
 }
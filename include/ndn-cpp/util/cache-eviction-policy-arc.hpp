@@ -0,0 +1,120 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Regents of the University of California.
+ * @author: Jeff Thompson <jefft0@remap.ucla.edu>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+#ifndef NDN_CACHE_EVICTION_POLICY_ARC_HPP
+#define NDN_CACHE_EVICTION_POLICY_ARC_HPP
+
+#include <map>
+#include <list>
+#include "cache-eviction-policy.hpp"
+
+namespace ndn {
+
+/**
+ * CacheEvictionPolicyArc extends CacheEvictionPolicy to use Adaptive
+ * Replacement Cache (ARC) from Megiddo and Modha, "ARC: A Self-Tuning, Low
+ * Overhead Replacement Cache", FAST 2003. Entries used once are in the list
+ * T1, and entries used more than once are in T2. The ghost lists B1 and B2
+ * remember the names of entries recently evicted from T1 and T2. A new insert
+ * of a name in B1 makes the target size of T1 larger, and a name in B2 makes
+ * it smaller, so that the policy adapts between recency and frequency. This
+ * version measures the lists in bytes instead of entries. The ghost lists
+ * together are limited to the byte budget.
+ */
+class CacheEvictionPolicyArc : public CacheEvictionPolicy {
+public:
+  /**
+   * Create a CacheEvictionPolicyArc with the given byte budget.
+   * @param maxBytes The maximum total size in bytes of the entries in the
+   * cache.
+   */
+  CacheEvictionPolicyArc(size_t maxBytes)
+  : CacheEvictionPolicy(maxBytes), t1TargetBytes_(0)
+  {
+    for (size_t i = 0; i < 4; ++i)
+      listBytes_[i] = 0;
+  }
+
+  /**
+   * Get the current target size of the T1 list, which should only be used for
+   * testing.
+   * @return The target size in bytes.
+   */
+  size_t
+  getT1TargetBytes_() const { return t1TargetBytes_; }
+
+protected:
+  virtual void
+  doInsert(const Name& name, size_t nBytes);
+
+  virtual void
+  doAccess(const Name& name);
+
+  virtual size_t
+  doErase(const Name& name);
+
+  virtual bool
+  doEvict(Name& name, size_t& nBytes);
+
+private:
+  enum ListType { T1 = 0, T2 = 1, B1 = 2, B2 = 3 };
+
+  class Entry {
+  public:
+    ListType listType_;
+    size_t nBytes_;
+    // The position of the name in lists_[listType_].
+    std::list<Name>::iterator position_;
+  };
+
+  /**
+   * Move the entry to the most recently used end of the list.
+   * @param entry The entry in entries_.
+   * @param listType The list to move to.
+   */
+  void
+  moveTo(Entry& entry, ListType listType);
+
+  /**
+   * Remove the entry from its list and from entries_.
+   * @param entry The iterator in entries_.
+   */
+  void
+  remove(std::map<Name, Entry>::iterator entry);
+
+  /**
+   * Remove the least recently used entries from the ghost lists B1 and B2 so
+   * that T1 plus B1 is within the byte budget, and all the lists are within
+   * twice the byte budget.
+   */
+  void
+  trimGhosts();
+
+  std::map<Name, Entry> entries_;
+  // Each list has the least recently used at the front.
+  std::list<Name> lists_[4];
+  size_t listBytes_[4];
+  size_t t1TargetBytes_;
+};
+
+}
+
+#endif
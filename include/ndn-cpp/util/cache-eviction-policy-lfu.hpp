@@ -0,0 +1,86 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Regents of the University of California.
+ * @author: Jeff Thompson <jefft0@remap.ucla.edu>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+#ifndef NDN_CACHE_EVICTION_POLICY_LFU_HPP
+#define NDN_CACHE_EVICTION_POLICY_LFU_HPP
+
+#include <map>
+#include <list>
+#include "cache-eviction-policy.hpp"
+
+namespace ndn {
+
+/**
+ * CacheEvictionPolicyLfu extends CacheEvictionPolicy to evict the least
+ * frequently used entry. Among entries with the same use count, evict the one
+ * which was least recently used. A new entry has a use count of 1.
+ */
+class CacheEvictionPolicyLfu : public CacheEvictionPolicy {
+public:
+  /**
+   * Create a CacheEvictionPolicyLfu with the given byte budget.
+   * @param maxBytes The maximum total size in bytes of the entries in the
+   * cache.
+   */
+  CacheEvictionPolicyLfu(size_t maxBytes)
+  : CacheEvictionPolicy(maxBytes)
+  {
+  }
+
+protected:
+  virtual void
+  doInsert(const Name& name, size_t nBytes);
+
+  virtual void
+  doAccess(const Name& name);
+
+  virtual size_t
+  doErase(const Name& name);
+
+  virtual bool
+  doEvict(Name& name, size_t& nBytes);
+
+private:
+  class Entry {
+  public:
+    size_t nBytes_;
+    uint64_t useCount_;
+    // The position of the name in the list in byUseCount_ for useCount_.
+    std::list<Name>::iterator position_;
+  };
+
+  /**
+   * Remove the entry's name from its list in byUseCount_, and remove the list
+   * if it is empty.
+   * @param entry The entry in entries_.
+   */
+  void
+  removeFromUseCount(const Entry& entry);
+
+  std::map<Name, Entry> entries_;
+  // The key is the use count. In each list, the front is the least recently
+  // used.
+  std::map<uint64_t, std::list<Name> > byUseCount_;
+};
+
+}
+
+#endif
@@ -0,0 +1,75 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Regents of the University of California.
+ * @author: Jeff Thompson <jefft0@remap.ucla.edu>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+#ifndef NDN_CACHE_EVICTION_POLICY_LRU_HPP
+#define NDN_CACHE_EVICTION_POLICY_LRU_HPP
+
+#include <map>
+#include <list>
+#include "cache-eviction-policy.hpp"
+
+namespace ndn {
+
+/**
+ * CacheEvictionPolicyLru extends CacheEvictionPolicy to evict the least
+ * recently used entry.
+ */
+class CacheEvictionPolicyLru : public CacheEvictionPolicy {
+public:
+  /**
+   * Create a CacheEvictionPolicyLru with the given byte budget.
+   * @param maxBytes The maximum total size in bytes of the entries in the
+   * cache.
+   */
+  CacheEvictionPolicyLru(size_t maxBytes)
+  : CacheEvictionPolicy(maxBytes)
+  {
+  }
+
+protected:
+  virtual void
+  doInsert(const Name& name, size_t nBytes);
+
+  virtual void
+  doAccess(const Name& name);
+
+  virtual size_t
+  doErase(const Name& name);
+
+  virtual bool
+  doEvict(Name& name, size_t& nBytes);
+
+private:
+  class Entry {
+  public:
+    size_t nBytes_;
+    // The position of the name in leastRecentlyUsed_.
+    std::list<Name>::iterator position_;
+  };
+
+  std::map<Name, Entry> entries_;
+  // The front is the least recently used.
+  std::list<Name> leastRecentlyUsed_;
+};
+
+}
+
+#endif
@@ -0,0 +1,210 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Regents of the University of California.
+ * @author: Jeff Thompson <jefft0@remap.ucla.edu>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+#ifndef NDN_CACHE_EVICTION_POLICY_HPP
+#define NDN_CACHE_EVICTION_POLICY_HPP
+
+#include "../name.hpp"
+
+namespace ndn {
+
+/**
+ * CacheEvictionPolicy is an abstract base class for the policy which a cache
+ * such as MemoryContentCache or InMemoryStorageRetaining uses to keep the
+ * total size of its entries within a byte budget. The cache reports each
+ * entry's name and size (the size of the Data packet wire encoding) when it is
+ * inserted, accessed or removed. When isOverBudget() is true, the cache calls
+ * evict() to get the name of the entry to remove. The policy also keeps hit,
+ * miss and eviction counters to help size the cache.
+ * A subclass implements the protected do... methods. A policy should only be
+ * used by one cache.
+ */
+class CacheEvictionPolicy {
+public:
+  /**
+   * Create a CacheEvictionPolicy with the given byte budget.
+   * @param maxBytes The maximum total size in bytes of the entries in the
+   * cache.
+   */
+  CacheEvictionPolicy(size_t maxBytes)
+  : maxBytes_(maxBytes), nBytes_(0), nHits_(0), nMisses_(0), nEvictions_(0)
+  {
+  }
+
+  virtual
+  ~CacheEvictionPolicy();
+
+  /**
+   * The cache calls this after it inserts an entry. If the policy already has
+   * an entry with the name, replace it.
+   * @param name The name of the entry.
+   * @param nBytes The size of the entry in bytes.
+   */
+  void
+  insert(const Name& name, size_t nBytes)
+  {
+    nBytes_ -= doErase(name);
+    nBytes_ += nBytes;
+    doInsert(name, nBytes);
+  }
+
+  /**
+   * The cache calls this when it returns the entry for a request. This
+   * increments the hit count.
+   * @param name The name of the entry.
+   */
+  void
+  access(const Name& name)
+  {
+    ++nHits_;
+    doAccess(name);
+  }
+
+  /**
+   * The cache calls this when it has no entry for a request. This increments
+   * the miss count.
+   */
+  void
+  miss() { ++nMisses_; }
+
+  /**
+   * The cache calls this after it removes an entry for a reason other than
+   * eviction, such as when the entry is stale.
+   * @param name The name of the entry. If the policy does not have the entry,
+   * do nothing.
+   */
+  void
+  erase(const Name& name) { nBytes_ -= doErase(name); }
+
+  /**
+   * Check if the total size of the entries is greater than the byte budget.
+   * @return True if the cache should call evict().
+   */
+  bool
+  isOverBudget() const { return nBytes_ > maxBytes_; }
+
+  /**
+   * Select the entry to evict and remove it from this policy. The cache must
+   * then remove the entry with the name. This increments the eviction count.
+   * @param name Set name to the name of the entry to evict.
+   * @return True if an entry was selected, or false if the policy has no
+   * entries.
+   */
+  bool
+  evict(Name& name);
+
+  /**
+   * Get the maximum total size of the entries.
+   * @return The byte budget.
+   */
+  size_t
+  getMaxBytes() const { return maxBytes_; }
+
+  /**
+   * Get the current total size of the entries.
+   * @return The number of bytes.
+   */
+  size_t
+  getByteCount() const { return nBytes_; }
+
+  /**
+   * Get the number of calls to access().
+   * @return The hit count.
+   */
+  uint64_t
+  getHitCount() const { return nHits_; }
+
+  /**
+   * Get the number of calls to miss().
+   * @return The miss count.
+   */
+  uint64_t
+  getMissCount() const { return nMisses_; }
+
+  /**
+   * Get the number of entries which evict() has selected.
+   * @return The eviction count.
+   */
+  uint64_t
+  getEvictionCount() const { return nEvictions_; }
+
+  /**
+   * Reset the hit, miss and eviction counts to zero.
+   */
+  void
+  resetCounters()
+  {
+    nHits_ = 0;
+    nMisses_ = 0;
+    nEvictions_ = 0;
+  }
+
+protected:
+  /**
+   * Add the new entry to the policy. insert() has already called doErase(name).
+   * @param name The name of the entry.
+   * @param nBytes The size of the entry in bytes.
+   */
+  virtual void
+  doInsert(const Name& name, size_t nBytes) = 0;
+
+  /**
+   * Update the policy for an access to the entry.
+   * @param name The name of the entry. If the policy does not have the entry,
+   * do nothing.
+   */
+  virtual void
+  doAccess(const Name& name) = 0;
+
+  /**
+   * Remove the entry from the policy.
+   * @param name The name of the entry.
+   * @return The size of the removed entry in bytes, or 0 if the policy does
+   * not have the entry.
+   */
+  virtual size_t
+  doErase(const Name& name) = 0;
+
+  /**
+   * Select the entry to evict and remove it from the policy.
+   * @param name Set name to the name of the entry to evict.
+   * @param nBytes Set nBytes to the size of the entry in bytes.
+   * @return True if an entry was selected, or false if the policy has no
+   * entries.
+   */
+  virtual bool
+  doEvict(Name& name, size_t& nBytes) = 0;
+
+private:
+  // Disable the copy constructor and assignment operator.
+  CacheEvictionPolicy(const CacheEvictionPolicy& other);
+  CacheEvictionPolicy& operator=(const CacheEvictionPolicy& other);
+
+  size_t maxBytes_;
+  size_t nBytes_;
+  uint64_t nHits_;
+  uint64_t nMisses_;
+  uint64_t nEvictions_;
+};
+
+}
+
+#endif
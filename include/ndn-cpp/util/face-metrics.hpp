@@ -0,0 +1,280 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Regents of the University of California.
+ * @author: Jeff Thompson <jefft0@remap.ucla.edu>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+#ifndef NDN_FACE_METRICS_HPP
+#define NDN_FACE_METRICS_HPP
+
+#include <string>
+#include "../c/network-nack-types.h"
+#include "latency-histogram.hpp"
+
+namespace ndn {
+
+class FaceMetrics;
+
+/**
+ * An OnFaceMetrics function object is called with a snapshot of the metrics
+ * for the periodic dump from Face::setMetricsDump.
+ */
+typedef func_lib::function<void(const FaceMetrics& metrics)> OnFaceMetrics;
+
+/**
+ * FaceMetrics holds the performance counters and latency histograms of a Face.
+ * Face::getMetrics returns a snapshot copy, which also has the current sizes
+ * of the Face's tables. The latencies are in microseconds.
+ */
+class FaceMetrics {
+public:
+  /**
+   * Create a FaceMetrics with all counts zero.
+   */
+  FaceMetrics()
+  : nInterestsSent_(0), nDataReceived_(0), nTimeouts_(0), nBytesSent_(0),
+    nBytesReceived_(0), nPendingInterests_(0), nInterestFilters_(0),
+    nDelayedCalls_(0)
+  {
+    for (size_t i = 0; i < N_NACK_REASONS; ++i)
+      nNetworkNacks_[i] = 0;
+  }
+
+  /**
+   * The Face calls this when it sends an Interest.
+   * @param nBytes The size of the Interest encoding.
+   */
+  void
+  interestSent(size_t nBytes)
+  {
+    ++nInterestsSent_;
+    nBytesSent_ += nBytes;
+  }
+
+  /**
+   * The Face calls this when it sends another packet such as a Data or Nack.
+   * @param nBytes The size of the packet encoding.
+   */
+  void
+  packetSent(size_t nBytes) { nBytesSent_ += nBytes; }
+
+  /**
+   * The Face calls this when it receives a packet of any type.
+   * @param nBytes The size of the packet encoding.
+   */
+  void
+  packetReceived(size_t nBytes) { nBytesReceived_ += nBytes; }
+
+  /**
+   * The Face calls this when it receives a Data packet.
+   */
+  void
+  dataReceived() { ++nDataReceived_; }
+
+  /**
+   * The Face calls this when a pending Interest times out.
+   */
+  void
+  interestTimedOut() { ++nTimeouts_; }
+
+  /**
+   * The Face calls this when it receives a network Nack.
+   * @param reason The reason in the network Nack.
+   */
+  void
+  networkNackReceived(ndn_NetworkNackReason reason)
+  {
+    ++nNetworkNacks_[getNackReasonIndex(reason)];
+  }
+
+  /**
+   * The Face calls this when it receives the Data for a pending Interest.
+   * @param rttMilliseconds The time since the Interest was expressed.
+   */
+  void
+  recordRtt(Milliseconds rttMilliseconds)
+  {
+    rttHistogram_.record(toMicroseconds(rttMilliseconds));
+  }
+
+  /**
+   * The Face calls this after it calls an application callback such as
+   * OnData, OnTimeout, OnNetworkNack or OnInterestCallback.
+   * @param durationMilliseconds The time that the callback took.
+   */
+  void
+  recordCallbackTime(Milliseconds durationMilliseconds)
+  {
+    callbackHistogram_.record(toMicroseconds(durationMilliseconds));
+  }
+
+  /**
+   * The Face calls this to set the table sizes in a snapshot.
+   * @param nPendingInterests The number of entries in the pending Interest
+   * table.
+   * @param nInterestFilters The number of entries in the Interest filter table.
+   * @param nDelayedCalls The number of calls waiting in the delayed call table
+   * which is used by processEvents.
+   */
+  void
+  setTableSizes
+    (size_t nPendingInterests, size_t nInterestFilters, size_t nDelayedCalls)
+  {
+    nPendingInterests_ = nPendingInterests;
+    nInterestFilters_ = nInterestFilters;
+    nDelayedCalls_ = nDelayedCalls;
+  }
+
+  /**
+   * Get the number of Interests sent.
+   * @return The count.
+   */
+  uint64_t
+  getInterestsSentCount() const { return nInterestsSent_; }
+
+  /**
+   * Get the number of Data packets received.
+   * @return The count.
+   */
+  uint64_t
+  getDataReceivedCount() const { return nDataReceived_; }
+
+  /**
+   * Get the number of pending Interests which timed out.
+   * @return The count.
+   */
+  uint64_t
+  getTimeoutCount() const { return nTimeouts_; }
+
+  /**
+   * Get the number of received network Nacks with the reason.
+   * @param reason The Nack reason. All reasons which are not recognized are
+   * counted as ndn_NetworkNackReason_OTHER_CODE.
+   * @return The count.
+   */
+  uint64_t
+  getNetworkNackCount(ndn_NetworkNackReason reason) const
+  {
+    return nNetworkNacks_[getNackReasonIndex(reason)];
+  }
+
+  /**
+   * Get the number of received network Nacks for all reasons.
+   * @return The count.
+   */
+  uint64_t
+  getNetworkNackCount() const;
+
+  /**
+   * Get the total size of the sent packets.
+   * @return The number of bytes.
+   */
+  uint64_t
+  getBytesSentCount() const { return nBytesSent_; }
+
+  /**
+   * Get the total size of the received packets.
+   * @return The number of bytes.
+   */
+  uint64_t
+  getBytesReceivedCount() const { return nBytesReceived_; }
+
+  /**
+   * Get the number of entries in the pending Interest table.
+   * @return The count.
+   */
+  size_t
+  getPendingInterestCount() const { return nPendingInterests_; }
+
+  /**
+   * Get the number of entries in the Interest filter table.
+   * @return The count.
+   */
+  size_t
+  getInterestFilterCount() const { return nInterestFilters_; }
+
+  /**
+   * Get the number of calls waiting in the delayed call table which is used
+   * by processEvents.
+   * @return The count.
+   */
+  size_t
+  getDelayedCallCount() const { return nDelayedCalls_; }
+
+  /**
+   * Get the histogram of the time in microseconds from expressing an Interest
+   * to receiving its Data.
+   * @return The histogram.
+   */
+  const LatencyHistogram&
+  getRttHistogram() const { return rttHistogram_; }
+
+  /**
+   * Get the histogram of the time in microseconds taken by the application
+   * callbacks.
+   * @return The histogram.
+   */
+  const LatencyHistogram&
+  getCallbackHistogram() const { return callbackHistogram_; }
+
+  /**
+   * Get a one-line summary of the counters and latency percentiles, for
+   * example for logging.
+   * @return The summary string.
+   */
+  std::string
+  toString() const;
+
+private:
+  static const size_t N_NACK_REASONS = 5;
+
+  static size_t
+  getNackReasonIndex(ndn_NetworkNackReason reason)
+  {
+    switch (reason) {
+    case ndn_NetworkNackReason_NONE:       return 0;
+    case ndn_NetworkNackReason_CONGESTION: return 1;
+    case ndn_NetworkNackReason_DUPLICATE:  return 2;
+    case ndn_NetworkNackReason_NO_ROUTE:   return 3;
+    default:                               return 4;
+    }
+  }
+
+  static uint64_t
+  toMicroseconds(Milliseconds milliseconds)
+  {
+    // The clock may go backwards.
+    return milliseconds > 0 ? (uint64_t)(milliseconds * 1000.0 + 0.5) : 0;
+  }
+
+  uint64_t nInterestsSent_;
+  uint64_t nDataReceived_;
+  uint64_t nTimeouts_;
+  uint64_t nNetworkNacks_[N_NACK_REASONS];
+  uint64_t nBytesSent_;
+  uint64_t nBytesReceived_;
+  size_t nPendingInterests_;
+  size_t nInterestFilters_;
+  size_t nDelayedCalls_;
+  LatencyHistogram rttHistogram_;
+  LatencyHistogram callbackHistogram_;
+};
+
+}
+
+#endif
@@ -0,0 +1,122 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Regents of the University of California.
+ * @author: Jeff Thompson <jefft0@remap.ucla.edu>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+#ifndef NDN_LATENCY_HISTOGRAM_HPP
+#define NDN_LATENCY_HISTOGRAM_HPP
+
+#include <vector>
+#include "../common.hpp"
+
+namespace ndn {
+
+/**
+ * A LatencyHistogram counts recorded values in logarithmic buckets in the style
+ * of an HDR histogram, so that it can cover values from 1 to 2^64 with a fixed
+ * relative precision and constant-time recording. Values below 32 have their
+ * own bucket. Above that, each power of two is divided into 16 linear buckets,
+ * so a bucket's range is within 1/16 of its values. The unit of the values is
+ * up to the caller, for example microseconds.
+ */
+class LatencyHistogram {
+public:
+  /**
+   * Create an empty LatencyHistogram.
+   */
+  LatencyHistogram()
+  : count_(0), min_(0), max_(0), sum_(0)
+  {
+  }
+
+  /**
+   * Add the value to the histogram.
+   * @param value The value to record.
+   */
+  void
+  record(uint64_t value);
+
+  /**
+   * Get the number of recorded values.
+   * @return The count.
+   */
+  uint64_t
+  getCount() const { return count_; }
+
+  /**
+   * Get the smallest recorded value.
+   * @return The minimum, or 0 if there are no values.
+   */
+  uint64_t
+  getMin() const { return min_; }
+
+  /**
+   * Get the largest recorded value.
+   * @return The maximum, or 0 if there are no values.
+   */
+  uint64_t
+  getMax() const { return max_; }
+
+  /**
+   * Get the mean of the recorded values.
+   * @return The mean, or 0 if there are no values.
+   */
+  double
+  getMean() const { return count_ == 0 ? 0 : sum_ / count_; }
+
+  /**
+   * Get the value at the percentile, which is the largest value in the bucket
+   * that holds the value where the given percentage of the recorded values are
+   * less than or equal to it. This is not more than getMax().
+   * @param percentile The percentile from 0 to 100, such as 99.9.
+   * @return The value, or 0 if there are no values.
+   */
+  uint64_t
+  getValueAtPercentile(double percentile) const;
+
+  /**
+   * Remove all the recorded values.
+   */
+  void
+  reset();
+
+private:
+  /**
+   * Get the index in counts_ of the bucket for the value.
+   */
+  static size_t
+  getBucketIndex(uint64_t value);
+
+  /**
+   * Get the largest value in the bucket at the index.
+   */
+  static uint64_t
+  getBucketMaxValue(size_t index);
+
+  // counts_ only grows as needed to hold the bucket of the largest value.
+  std::vector<uint64_t> counts_;
+  uint64_t count_;
+  uint64_t min_;
+  uint64_t max_;
+  double sum_;
+};
+
+}
+
+#endif
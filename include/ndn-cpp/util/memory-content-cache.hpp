@@ -23,8 +23,8 @@
 #define NDN_MEMORY_CONTENT_CACHE_HPP
 
 #include <map>
-#include <deque>
 #include "../face.hpp"
+#include "cache-eviction-policy.hpp"
 
 namespace ndn {
 
@@ -106,6 +106,14 @@ public:
       return nowMilliseconds >= timeoutTimeMilliseconds_;
     }
 
+    /**
+     * Return the time when this interest times out.
+     * @return The timeout time in milliseconds since 1/1/1970, as returned by
+     * ndn_getNowMilliseconds.
+     */
+    MillisecondsSince1970
+    getTimeoutTime() const { return timeoutTimeMilliseconds_; }
+
   private:
     ptr_lib::shared_ptr<const Interest> interest_;
     Face& face_;
@@ -400,7 +408,8 @@ public:
 
   /**
    * Set the OnContentRemoved callback to call when stale content is removed
-   * from the cache during cleanup. Note: Because onContentRemoved is called
+   * from the cache during cleanup, or when the eviction policy evicts content.
+   * Note: Because onContentRemoved is called
    * while processing incoming Interests, it should return quickly to allow the
    * Interest to be processed quickly.
    * @param onContentRemoved This calls onContentRemoved(contentList) where
@@ -435,6 +444,32 @@ public:
     impl_->setMinimumCacheLifetime(minimumCacheLifetime);
   }
 
+  /**
+   * Set the eviction policy which limits the total size of the Data packet
+   * encodings in the cache. When add(data) makes the cache larger than the
+   * policy's byte budget, remove the content which the policy selects and
+   * call the OnContentRemoved callback. While an eviction policy is set,
+   * add(data) replaces content which has the same name as the data. This also
+   * updates the policy's hit and miss counts for each incoming Interest. If
+   * the cache already has content, add it to the policy and evict as needed.
+   * @param evictionPolicy The CacheEvictionPolicy such as
+   * CacheEvictionPolicyLru, which should not be used by another cache. If
+   * null, there is no limit (the default).
+   */
+  void
+  setEvictionPolicy(const ptr_lib::shared_ptr<CacheEvictionPolicy>& evictionPolicy)
+  {
+    impl_->setEvictionPolicy(evictionPolicy);
+  }
+
+  /**
+   * Get the eviction policy given to setEvictionPolicy, for example to get the
+   * hit, miss and eviction counts.
+   * @return The CacheEvictionPolicy, or null if not set.
+   */
+  const ptr_lib::shared_ptr<CacheEvictionPolicy>&
+  getEvictionPolicy() { return impl_->getEvictionPolicy(); }
+
 private:
   /**
    * MemoryContentCache::Impl does the work of MemoryContentCache. It is a
@@ -510,14 +545,24 @@ private:
       minimumCacheLifetime_ = minimumCacheLifetime;
     }
 
+    void
+    setEvictionPolicy
+      (const ptr_lib::shared_ptr<CacheEvictionPolicy>& evictionPolicy);
+
+    const ptr_lib::shared_ptr<CacheEvictionPolicy>&
+    getEvictionPolicy() { return evictionPolicy_; }
+
     /**
      * This is the OnInterestCallback which is called when the library receives
      * an interest whose name has the prefix given to registerPrefix. First
      * check if cleanupIntervalMilliseconds milliseconds have passed and remove
      * stale content from the cache. Then search the cache for the Data packet,
      * matching any interest selectors including ChildSelector, and send the
-     * Data packet to the transport. If no matching Data packet is in the cache,
-     * call the callback in onDataNotFoundForPrefix_ (if defined).
+     * Data packet to the transport. The search uses nameIndex_ so that it
+     * takes logarithmic time in the size of the cache when the first entries
+     * with the interest name as a prefix satisfy the selectors. If no matching
+     * Data packet is in the cache, call the callback in onDataNotFoundForPrefix_
+     * (if defined).
      */
     void
     onInterest
@@ -574,7 +619,8 @@ private:
       }
 
       /**
-       * Compare shared_ptrs to Content based only on cacheRemovalTimeMilliseconds_.
+       * Compare shared_ptrs to Content based only on
+       * cacheRemovalTimeMilliseconds_, so that std::push_heap makes a min-heap.
        */
       class Compare {
       public:
@@ -583,7 +629,7 @@ private:
           (const ptr_lib::shared_ptr<const StaleTimeContent>& x,
            const ptr_lib::shared_ptr<const StaleTimeContent>& y) const
         {
-          return x->cacheRemovalTimeMilliseconds_ < y->cacheRemovalTimeMilliseconds_;
+          return x->cacheRemovalTimeMilliseconds_ > y->cacheRemovalTimeMilliseconds_;
         }
       };
 
@@ -596,13 +642,143 @@ private:
         remove from the cache) in milliseconds according to ndn_getNowMilliseconds */
     };
 
+    /**
+     * An IndexEntry is the value in nameIndex_ for each Content in the cache.
+     */
+    class IndexEntry {
+    public:
+      IndexEntry
+        (const ptr_lib::shared_ptr<const Content>& content,
+         const StaleTimeContent* staleTimeContent)
+      : content_(content), staleTimeContent_(staleTimeContent)
+      {
+      }
+
+      /**
+       * Check if the content is fresh. Content without a stale time is always
+       * fresh.
+       * @param nowMilliseconds The current time in milliseconds from
+       * ndn_getNowMilliseconds.
+       * @return True if the content is fresh, otherwise false.
+       */
+      bool
+      isFresh(MillisecondsSince1970 nowMilliseconds) const
+      {
+        return !staleTimeContent_ || staleTimeContent_->isFresh(nowMilliseconds);
+      }
+
+      ptr_lib::shared_ptr<const Content> content_;
+      // If not 0, this is the same as content_ and is also in staleTimeHeap_.
+      const StaleTimeContent* staleTimeContent_;
+    };
+
+    typedef std::multimap<Name, IndexEntry> NameIndex;
+
+    /**
+     * Compare shared_ptrs to PendingInterest based only on the timeout time,
+     * so that std::push_heap makes a min-heap.
+     */
+    class CompareTimeoutTime {
+    public:
+      bool
+      operator()
+        (const ptr_lib::shared_ptr<const PendingInterest>& x,
+         const ptr_lib::shared_ptr<const PendingInterest>& y) const
+      {
+        return x->getTimeoutTime() > y->getTimeoutTime();
+      }
+    };
+
+    // The key is the Interest name.
+    typedef std::multimap<Name, ptr_lib::shared_ptr<const PendingInterest> >
+      PendingInterestIndex;
+
+    /**
+     * Find the content in nameIndex_ which best matches the interest, using
+     * the name order to find the range of names with the interest name as a
+     * prefix, then checking the selectors of each entry in the range. If the
+     * interest has a rightmost ChildSelector, search the range backwards.
+     * @param interest The Interest to match.
+     * @param nowMilliseconds The current time in milliseconds from
+     * ndn_getNowMilliseconds.
+     * @return The matching Content, or 0 if not found.
+     */
+    const Content*
+    findBestMatch
+      (const Interest& interest, MillisecondsSince1970 nowMilliseconds) const;
+
+    /**
+     * Remove the entry for the content from nameIndex_.
+     * @param content The Content which was added to nameIndex_.
+     * @return True if the content was removed, or false if it was not in
+     * nameIndex_.
+     */
+    bool
+    removeFromIndex(const Content* content);
+
+    /**
+     * Remove all content with the name from nameIndex_. This leaves the entries
+     * in staleTimeHeap_, which doCleanup skips since they are not in
+     * nameIndex_.
+     * @param name The name of the content.
+     * @param removedContent If not null, append the removed content.
+     */
+    void
+    removeContent(const Name& name, ContentList* removedContent);
+
+    /**
+     * Remake staleTimeHeap_ from the stale time content in nameIndex_ to remove
+     * the entries for content which is no longer in the cache.
+     */
+    void
+    rebuildStaleTimeHeap();
+
+    /**
+     * Remove the pending interest from pendingInterestIndex_.
+     * @param pendingInterest The PendingInterest which was added to
+     * pendingInterestIndex_.
+     * @return True if the pending interest was removed, or false if it was not
+     * in pendingInterestIndex_.
+     */
+    bool
+    removeFromPendingInterestIndex(const PendingInterest* pendingInterest);
+
+    /**
+     * Pop the timed-out pending interests from pendingInterestTimeoutHeap_ and
+     * remove them from pendingInterestIndex_.
+     * @param nowMilliseconds The current time in milliseconds from
+     * ndn_getNowMilliseconds.
+     */
+    void
+    removeTimedOutPendingInterests(MillisecondsSince1970 nowMilliseconds);
+
+    /**
+     * Get the pending interests whose name is a prefix of the name and which
+     * match the name. Only these can match, so this only searches
+     * pendingInterestIndex_ for each prefix of the name.
+     * @param name The name to match.
+     * @param pendingInterests Append the matching entries from
+     * pendingInterestIndex_.
+     */
+    void
+    findPendingInterestsForName
+      (const Name& name,
+       std::vector<PendingInterestIndex::iterator>& pendingInterests);
+
+    /**
+     * While evictionPolicy_ is over budget, remove the content that it
+     * selects. Then call onContentRemoved_ for the removed content.
+     */
+    void
+    evictWhileOverBudget();
+
     /**
      * Check if now is greater than nextCleanupTime_ and, if so, remove stale
-     * content from staleTimeCache_ and reset nextCleanupTime_ based on
-     * cleanupIntervalMilliseconds_. Since add(Data) does a sorted insert into
-     * staleTimeCache_, the check for stale data is quick and does not require
-     * searching the entire staleTimeCache_. If onContentRemoved_ is defined,
-     * this calls onContentRemoved_(content) for the removed content.
+     * content from the cache and reset nextCleanupTime_ based on
+     * cleanupIntervalMilliseconds_. Since staleTimeHeap_ is a min-heap on the
+     * removal time, this only pops the stale content and does not require
+     * searching all the content. If onContentRemoved_ is defined, this calls
+     * onContentRemoved_(content) for the removed content.
      * @param nowMilliseconds The current time in milliseconds from
      * ndn_getNowMilliseconds.
      */
@@ -630,16 +806,29 @@ private:
     std::map<std::string, OnInterestCallback> onDataNotFoundForPrefix_; /**< The map key is the prefix.toUri() */
     std::vector<uint64_t> interestFilterIdList_;
     std::vector<uint64_t> registeredPrefixIdList_;
-    std::vector<ptr_lib::shared_ptr<const Content> > noStaleTimeCache_;
-    // Use a deque so we can efficiently remove from the front.
-    std::deque<ptr_lib::shared_ptr<const StaleTimeContent> > staleTimeCache_;
+    // A min-heap on the removal time of the content with a stale time. This may
+    // have entries for content which removeContent removed from nameIndex_.
+    std::vector<ptr_lib::shared_ptr<const StaleTimeContent> > staleTimeHeap_;
+    // The number of entries in staleTimeHeap_ which are not in nameIndex_.
+    size_t nRemovedInStaleTimeHeap_;
     StaleTimeContent::Compare contentCompare_;
-    Name::Component emptyComponent_;
-    std::vector<ptr_lib::shared_ptr<const PendingInterest> > pendingInterestTable_;
+    // All the content in the cache, sorted by name. This owns the content which
+    // has no stale time.
+    NameIndex nameIndex_;
+    PendingInterestIndex pendingInterestIndex_;
+    // A min-heap on the timeout time of the entries in pendingInterestIndex_.
+    // This may have entries for pending interests which were satisfied.
+    std::vector<ptr_lib::shared_ptr<const PendingInterest> >
+      pendingInterestTimeoutHeap_;
+    // The number of entries in pendingInterestTimeoutHeap_ which are not in
+    // pendingInterestIndex_.
+    size_t nSatisfiedInTimeoutHeap_;
+    CompareTimeoutTime timeoutCompare_;
     OnInterestCallback storePendingInterestCallback_;
     OnContentRemoved onContentRemoved_;
     bool isDoingCleanup_;
     Milliseconds minimumCacheLifetime_;
+    ptr_lib::shared_ptr<CacheEvictionPolicy> evictionPolicy_;
   };
 
   ptr_lib::shared_ptr<Impl> impl_;
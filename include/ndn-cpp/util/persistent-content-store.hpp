@@ -0,0 +1,295 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Regents of the University of California.
+ * @author: Jeff Thompson <jefft0@remap.ucla.edu>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+#ifndef NDN_PERSISTENT_CONTENT_STORE_HPP
+#define NDN_PERSISTENT_CONTENT_STORE_HPP
+
+#include <map>
+#include "../face.hpp"
+
+namespace ndn {
+
+/**
+ * A PersistentContentStore holds a set of Data packets in a log file and
+ * answers an Interest to return the correct Data packet, like
+ * MemoryContentCache, but the Data packets remain after a restart so that the
+ * producer does not need to sign and add them again.
+ * add() appends the wire encoding of the Data packet to the log, and remove()
+ * appends the wire encoding of the name. The log is memory-mapped, and the
+ * constructor rebuilds the name index by only decoding the name and
+ * MetaInfo of each record. onInterest sends the matching Data packet
+ * directly from the mapped log without copying it.
+ * When a Data packet is replaced or removed, its old record remains in the log
+ * until compaction, which copies the records that are still used to a new log
+ * on a background thread while this store continues to answer Interests.
+ * Except for the background compaction, this is not thread safe. You should
+ * call the methods on the same thread as face.processEvents().
+ * The FreshnessPeriod of a Data packet starts when it is added. The log does
+ * not record when that was, so after a restart a Data packet which has a
+ * FreshnessPeriod is stale and does not match an Interest with MustBeFresh.
+ */
+class PersistentContentStore {
+public:
+  /**
+   * Open the log file and build the name index from its records. If the file
+   * does not exist, create it. If the last record is incomplete, for example
+   * because the process stopped while writing it, then truncate it. A
+   * complete record whose value can't be decoded is logged and skipped
+   * using its TLV length, and the next compaction removes it.
+   * @param filePath The path of the log file. This also uses the path
+   * filePath + ".compact" for compaction.
+   * @throws runtime_error if the file can't be opened or mapped, or if this
+   * platform does not support memory-mapped files.
+   */
+  PersistentContentStore(const std::string& filePath);
+
+  /**
+   * Wait for a running compaction to finish, then close the log file.
+   */
+  ~PersistentContentStore();
+
+  /**
+   * Append the Data packet to the log and add it to the name index. If a Data
+   * packet with the same name is in the store, this replaces it. This uses
+   * data.wireEncode(), which returns the cached encoding if the Data packet
+   * has already been encoded or signed.
+   * @param data The Data packet to add.
+   * @throws runtime_error if the log file can't be written.
+   */
+  void
+  add(const Data& data);
+
+  /**
+   * Remove the Data packet with the name by appending a removal record to the
+   * log.
+   * @param name The name of the Data packet.
+   * @return True if the Data packet was removed, or false if it was not in the
+   * store.
+   * @throws runtime_error if the log file can't be written.
+   */
+  bool
+  remove(const Name& name);
+
+  /**
+   * Find the Data packet which best matches the interest, according to the
+   * Interest's selectors.
+   * @param interest The Interest to match.
+   * @param encoding Set encoding to a pointer to the wire encoding in the
+   * mapped log. This is only valid until the next call to a method which
+   * changes the store, because the log may be mapped again.
+   * @param encodingLength Set encodingLength to the length of the encoding.
+   * @return True if found, otherwise false.
+   */
+  bool
+  find
+    (const Interest& interest, const uint8_t*& encoding, size_t& encodingLength);
+
+  /**
+   * Flush the written records to the storage device.
+   */
+  void
+  flush();
+
+  /**
+   * Get the number of Data packets in the store.
+   * @return The number of Data packets.
+   */
+  size_t
+  size() const { return index_.size(); }
+
+  /**
+   * Get the size of the log file, including the records which are no longer
+   * used.
+   * @return The number of bytes.
+   */
+  uint64_t
+  getLogSize() const { return logSize_; }
+
+  /**
+   * Get the total size of the records for the Data packets in the store.
+   * @return The number of bytes.
+   */
+  uint64_t
+  getLiveSize() const { return liveSize_; }
+
+  /**
+   * Start compacting the log on a background thread, if it is not already
+   * running. When the background thread is done, the next call to add,
+   * remove, find or onInterest switches to the compacted log.
+   * @return True if this started compaction, or false if it was already
+   * running.
+   * @throws runtime_error if the compacted log file can't be created.
+   */
+  bool
+  startCompaction();
+
+  /**
+   * Wait for a running compaction to finish and switch to the compacted log.
+   * If compaction is not running, do nothing.
+   */
+  void
+  waitForCompaction();
+
+  /**
+   * Check if compaction is running.
+   * @return True if compaction is running.
+   */
+  bool
+  isCompacting() const { return !!compaction_; }
+
+  /**
+   * Set the ratio of unused bytes in the log which makes add and remove call
+   * startCompaction(). Compaction only starts if the log is at least one
+   * megabyte.
+   * @param maxUnusedRatio The ratio from 0 to 1 of the log size, or a value
+   * greater than or equal to 1 to not compact automatically. If you don't
+   * call this, use 0.5.
+   */
+  void
+  setAutoCompactionRatio(double maxUnusedRatio)
+  {
+    autoCompactionRatio_ = maxUnusedRatio;
+  }
+
+  /**
+   * Set the callback for an Interest which onInterest cannot answer from the
+   * store.
+   * @param onDataNotFound This calls
+   * onDataNotFound(prefix, interest, face, interestFilterId, filter). If this
+   * is an empty OnInterestCallback(), it is not used. This copies the function
+   * object, so you may need to use func_lib::ref() as appropriate.
+   * NOTE: The library will log any exceptions thrown by this callback, but for
+   * better error handling the callback should catch and properly handle any
+   * exceptions.
+   */
+  void
+  setOnDataNotFound(const OnInterestCallback& onDataNotFound)
+  {
+    onDataNotFound_ = onDataNotFound;
+  }
+
+  /**
+   * This is the OnInterestCallback to pass to face.setInterestFilter, using
+   * for example
+   * bind(&PersistentContentStore::onInterest, &store, _1, _2, _3, _4, _5) .
+   * Find the best matching Data packet and send it from the mapped log with
+   * face.send(), or call the callback from setOnDataNotFound.
+   */
+  void
+  onInterest
+    (const ptr_lib::shared_ptr<const Name>& prefix,
+     const ptr_lib::shared_ptr<const Interest>& interest, Face& face,
+     uint64_t interestFilterId,
+     const ptr_lib::shared_ptr<const InterestFilter>& filter);
+
+private:
+  /**
+   * An Entry is the location of a Data packet's record in the log.
+   */
+  class Entry {
+  public:
+    Entry(uint64_t offset, size_t length,
+          MillisecondsSince1970 freshnessExpiryTime)
+    : offset_(offset), length_(length),
+      freshnessExpiryTimeMilliseconds_(freshnessExpiryTime)
+    {
+    }
+
+    bool
+    isFresh(MillisecondsSince1970 nowMilliseconds) const
+    {
+      return freshnessExpiryTimeMilliseconds_ < 0 ||
+        freshnessExpiryTimeMilliseconds_ > nowMilliseconds;
+    }
+
+    uint64_t offset_;
+    size_t length_;
+    // -1 if the Data packet has no FreshnessPeriod.
+    MillisecondsSince1970 freshnessExpiryTimeMilliseconds_;
+  };
+
+  typedef std::map<Name, Entry> NameIndex;
+
+  // Compaction is defined in the source file so that this header does not
+  // depend on the threading library.
+  class Compaction;
+
+  /**
+   * Open filePath_, map it and build index_ from the records.
+   */
+  void
+  open();
+
+  /**
+   * Unmap and close the log file.
+   */
+  void
+  close();
+
+  /**
+   * Map the log file so that at least the first length bytes are mapped.
+   * @param length The number of bytes which must be mapped.
+   */
+  void
+  map(uint64_t length);
+
+  /**
+   * Append the encoding to the log file and map it.
+   * @param encoding The encoding of the record.
+   * @param encodingLength The length of the encoding.
+   * @return The offset of the record in the log.
+   */
+  uint64_t
+  append(const uint8_t* encoding, size_t encodingLength);
+
+  /**
+   * If the unused bytes in the log exceed autoCompactionRatio_, call
+   * startCompaction().
+   */
+  void
+  maybeStartCompaction();
+
+  /**
+   * If the compaction thread is done, switch to the compacted log.
+   * @param wait If true, wait for the compaction thread to be done.
+   */
+  void
+  finishCompaction(bool wait);
+
+  // Disable the copy constructor and assignment operator.
+  PersistentContentStore(const PersistentContentStore& other);
+  PersistentContentStore& operator=(const PersistentContentStore& other);
+
+  std::string filePath_;
+  int fd_;
+  uint8_t* map_;
+  uint64_t mapSize_;
+  uint64_t logSize_;
+  uint64_t liveSize_;
+  NameIndex index_;
+  double autoCompactionRatio_;
+  ptr_lib::shared_ptr<Compaction> compaction_;
+  OnInterestCallback onDataNotFound_;
+};
+
+}
+
+#endif
@@ -0,0 +1,110 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Regents of the University of California.
+ * @author: Jeff Thompson <jefft0@remap.ucla.edu>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+#ifndef NDN_RTT_ESTIMATOR_HPP
+#define NDN_RTT_ESTIMATOR_HPP
+
+#include "../common.hpp"
+
+namespace ndn {
+
+/**
+ * An RttEstimator keeps the smoothed round-trip time and its variation from
+ * RTT measurements to compute the retransmission timeout (RTO) as described in
+ * RFC 6298. The caller should only add measurements for packets which were not
+ * retransmitted (Karn's algorithm). This is used by SegmentFetcher to set the
+ * lifetime of each Interest.
+ */
+class RttEstimator {
+public:
+  /**
+   * Create an RttEstimator with no measurements, where getEstimatedRto()
+   * returns initialRto.
+   * @param initialRto (optional) The RTO before the first measurement, in
+   * milliseconds. If omitted, use 1000 milliseconds.
+   * @param minRto (optional) The minimum RTO in milliseconds. If omitted, use
+   * 200 milliseconds.
+   * @param maxRto (optional) The maximum RTO in milliseconds. If omitted, use
+   * 60000 milliseconds.
+   */
+  RttEstimator
+    (Milliseconds initialRto = 1000.0, Milliseconds minRto = 200.0,
+     Milliseconds maxRto = 60000.0)
+  : minRto_(minRto), maxRto_(maxRto), smoothedRtt_(-1.0), rttVariation_(0.0),
+    rto_(initialRto), nMeasurements_(0)
+  {
+  }
+
+  /**
+   * Update the smoothed RTT and RTT variation with a new measurement, and
+   * recompute the RTO. This also clears the effect of any backoffRto().
+   * @param rtt The measured round-trip time in milliseconds.
+   */
+  void
+  addMeasurement(Milliseconds rtt);
+
+  /**
+   * Double the RTO up to the maximum RTO. Call this when an Interest times out.
+   */
+  void
+  backoffRto();
+
+  /**
+   * Get the current retransmission timeout.
+   * @return The RTO in milliseconds.
+   */
+  Milliseconds
+  getEstimatedRto() const { return rto_; }
+
+  /**
+   * Get the smoothed round-trip time.
+   * @return The smoothed RTT in milliseconds, or -1 if there are no
+   * measurements yet.
+   */
+  Milliseconds
+  getSmoothedRtt() const { return smoothedRtt_; }
+
+  /**
+   * Get the round-trip time variation.
+   * @return The RTT variation in milliseconds.
+   */
+  Milliseconds
+  getRttVariation() const { return rttVariation_; }
+
+  /**
+   * Get the number of measurements given to addMeasurement.
+   * @return The number of measurements.
+   */
+  size_t
+  getMeasurementCount() const { return nMeasurements_; }
+
+private:
+  Milliseconds minRto_;
+  Milliseconds maxRto_;
+  Milliseconds smoothedRtt_;
+  Milliseconds rttVariation_;
+  Milliseconds rto_;
+  size_t nMeasurements_;
+};
+
+}
+
+#endif
@@ -23,8 +23,12 @@
 #ifndef NDN_SEGMENT_FETCHER_HPP
 #define NDN_SEGMENT_FETCHER_HPP
 
+#include <map>
+#include <deque>
 #include "../face.hpp"
 #include "../security/key-chain.hpp"
+#include "segment-manifest.hpp"
+#include "rtt-estimator.hpp"
 
 namespace ndn {
 
@@ -74,6 +78,41 @@ namespace ndn {
  * SEGMENT_VERIFICATION_FAILED. If data validation is not required, pass a null
  * KeyChain.
  *
+ * If the producer published a SegmentManifest, use fetchWithManifest so that
+ * only manifest segment 0 is validated with the KeyChain and each segment is
+ * checked against its digest in the manifest, instead of doing a public-key
+ * verify for each segment.
+ *
+ * The fetch and fetchWithManifest methods which take an Options object fetch
+ * the segments with a pipeline of Interests instead of one Interest at a time.
+ * After discovering the version, this keeps up to a congestion window of
+ * Interests outstanding. The window grows with each received segment (using
+ * AIMD or optionally CUBIC) and is decreased at most once per window of
+ * Interests when an Interest times out, the Data has a congestion mark, or a
+ * Network Nack has the reason CONGESTION. The lifetime of each Interest is the
+ * retransmission timeout from an RttEstimator. An Interest which times out or
+ * gets a Network Nack is retransmitted up to Options.getMaxRetries() times.
+ * Segments may arrive out of order and are put in order when all have been
+ * received. The pipeline needs the FinalBlockId to know when to stop, so
+ * Interests sent past the last segment are cancelled when it is known. With
+ * the pipeline, the following error is also possible:
+ *
+ * - `NACK_ERROR`: if an Interest gets a Network Nack after the maximum
+ *   number of retries
+ *
+ * By default, the pipeline keeps the content of all segments and
+ * concatenates them for onComplete. To fetch a large object with bounded
+ * memory, set Options.setOnSegment to receive each segment in order as it
+ * arrives, or Options.setOutputBuffer or Options.setOutputFile to write the
+ * content directly to a buffer or a memory-mapped file. Only the segments
+ * which arrive ahead of a missing segment are kept. While a segment is
+ * missing, no segment is requested which is Options.getMaxWindow() or more
+ * past it, so this is bounded by the maximum window. In these modes, onComplete is called with a null Blob. The
+ * following error is also possible:
+ *
+ * - `IO_ERROR`: if the output buffer is too small or the output file can't
+ *   be written
+ *
  * Example:
  *     void onComplete(const Blob& encodedMessage);
  *
@@ -89,7 +128,366 @@ public:
   enum ErrorCode {
     INTEREST_TIMEOUT = 1,
     DATA_HAS_NO_SEGMENT = 2,
-    SEGMENT_VERIFICATION_FAILED = 3
+    SEGMENT_VERIFICATION_FAILED = 3,
+    NACK_ERROR = 4,
+    IO_ERROR = 5
+  };
+
+  typedef func_lib::function<void
+    (uint64_t offset, const Blob& content)> OnSegment;
+
+  /**
+   * An Options object holds the settings of the congestion-controlled
+   * pipeline for the fetch and fetchWithManifest methods which take an
+   * Options. Each setter returns this Options so that you can chain calls to
+   * update values.
+   */
+  class Options {
+  public:
+    /**
+     * Create an Options with the default values: an initial window of 2
+     * Interests, a maximum window of 1000 Interests, additive increase of 1
+     * segment per window, multiplicative decrease by 0.5, AIMD instead of
+     * CUBIC, respond to congestion marks, 15 retries and the default
+     * RttEstimator timeouts.
+     */
+    Options()
+    : initialWindow_(2.0), maxWindow_(1000.0), useConstantWindow_(false),
+      aiStep_(1.0), mdCoefficient_(0.5), useCubic_(false),
+      ignoreCongestionMarks_(false), maxRetries_(15), initialRto_(1000.0),
+      minRto_(200.0), maxRto_(60000.0), outputBuffer_(0), outputBufferSize_(0),
+      outputFileSize_(0)
+    {
+    }
+
+    /**
+     * Get the initial congestion window.
+     * @return The initial number of Interests in the pipeline.
+     */
+    double
+    getInitialWindow() const { return initialWindow_; }
+
+    /**
+     * Set the initial congestion window.
+     * @param initialWindow The initial number of Interests in the pipeline.
+     * @return This Options so that you can chain calls to update values.
+     */
+    Options&
+    setInitialWindow(double initialWindow)
+    {
+      initialWindow_ = initialWindow;
+      return *this;
+    }
+
+    /**
+     * Get the maximum congestion window.
+     * @return The maximum number of Interests in the pipeline.
+     */
+    double
+    getMaxWindow() const { return maxWindow_; }
+
+    /**
+     * Set the maximum congestion window.
+     * @param maxWindow The maximum number of Interests in the pipeline.
+     * @return This Options so that you can chain calls to update values.
+     */
+    Options&
+    setMaxWindow(double maxWindow)
+    {
+      maxWindow_ = maxWindow;
+      return *this;
+    }
+
+    /**
+     * Get the flag for a constant window.
+     * @return True if the window stays at the initial window.
+     */
+    bool
+    getUseConstantWindow() const { return useConstantWindow_; }
+
+    /**
+     * Set the flag for a constant window.
+     * @param useConstantWindow True to keep the window at the initial window
+     * and not do congestion control. Interests are still retransmitted.
+     * @return This Options so that you can chain calls to update values.
+     */
+    Options&
+    setUseConstantWindow(bool useConstantWindow)
+    {
+      useConstantWindow_ = useConstantWindow;
+      return *this;
+    }
+
+    /**
+     * Get the additive increase step.
+     * @return The number of segments added to the window per window of
+     * received segments (or per segment in slow start).
+     */
+    double
+    getAiStep() const { return aiStep_; }
+
+    /**
+     * Set the additive increase step.
+     * @param aiStep The number of segments added to the window per window of
+     * received segments (or per segment in slow start).
+     * @return This Options so that you can chain calls to update values.
+     */
+    Options&
+    setAiStep(double aiStep)
+    {
+      aiStep_ = aiStep;
+      return *this;
+    }
+
+    /**
+     * Get the multiplicative decrease coefficient for AIMD.
+     * @return The fraction of the window which is kept after congestion.
+     */
+    double
+    getMdCoefficient() const { return mdCoefficient_; }
+
+    /**
+     * Set the multiplicative decrease coefficient for AIMD.
+     * @param mdCoefficient The fraction of the window which is kept after
+     * congestion.
+     * @return This Options so that you can chain calls to update values.
+     */
+    Options&
+    setMdCoefficient(double mdCoefficient)
+    {
+      mdCoefficient_ = mdCoefficient;
+      return *this;
+    }
+
+    /**
+     * Get the flag to use CUBIC.
+     * @return True to grow the window with CUBIC (RFC 8312), false for AIMD.
+     */
+    bool
+    getUseCubic() const { return useCubic_; }
+
+    /**
+     * Set the flag to use CUBIC.
+     * @param useCubic True to grow the window with CUBIC (RFC 8312), false for
+     * AIMD.
+     * @return This Options so that you can chain calls to update values.
+     */
+    Options&
+    setUseCubic(bool useCubic)
+    {
+      useCubic_ = useCubic;
+      return *this;
+    }
+
+    /**
+     * Get the flag to ignore congestion marks.
+     * @return True if a congestion mark in a Data packet does not decrease
+     * the window.
+     */
+    bool
+    getIgnoreCongestionMarks() const { return ignoreCongestionMarks_; }
+
+    /**
+     * Set the flag to ignore congestion marks.
+     * @param ignoreCongestionMarks True if a congestion mark in a Data packet
+     * does not decrease the window.
+     * @return This Options so that you can chain calls to update values.
+     */
+    Options&
+    setIgnoreCongestionMarks(bool ignoreCongestionMarks)
+    {
+      ignoreCongestionMarks_ = ignoreCongestionMarks;
+      return *this;
+    }
+
+    /**
+     * Get the maximum number of retransmissions of a segment Interest.
+     * @return The maximum number of retries.
+     */
+    int
+    getMaxRetries() const { return maxRetries_; }
+
+    /**
+     * Set the maximum number of retransmissions of a segment Interest. After
+     * this, a timeout or Network Nack calls onError.
+     * @param maxRetries The maximum number of retries.
+     * @return This Options so that you can chain calls to update values.
+     */
+    Options&
+    setMaxRetries(int maxRetries)
+    {
+      maxRetries_ = maxRetries;
+      return *this;
+    }
+
+    /**
+     * Get the Interest lifetime before the first RTT measurement.
+     * @return The initial RTO in milliseconds.
+     */
+    Milliseconds
+    getInitialRto() const { return initialRto_; }
+
+    /**
+     * Set the Interest lifetime before the first RTT measurement.
+     * @param initialRto The initial RTO in milliseconds.
+     * @return This Options so that you can chain calls to update values.
+     */
+    Options&
+    setInitialRto(Milliseconds initialRto)
+    {
+      initialRto_ = initialRto;
+      return *this;
+    }
+
+    /**
+     * Get the minimum Interest lifetime.
+     * @return The minimum RTO in milliseconds.
+     */
+    Milliseconds
+    getMinRto() const { return minRto_; }
+
+    /**
+     * Set the minimum Interest lifetime.
+     * @param minRto The minimum RTO in milliseconds.
+     * @return This Options so that you can chain calls to update values.
+     */
+    Options&
+    setMinRto(Milliseconds minRto)
+    {
+      minRto_ = minRto;
+      return *this;
+    }
+
+    /**
+     * Get the maximum Interest lifetime.
+     * @return The maximum RTO in milliseconds.
+     */
+    Milliseconds
+    getMaxRto() const { return maxRto_; }
+
+    /**
+     * Set the maximum Interest lifetime.
+     * @param maxRto The maximum RTO in milliseconds.
+     * @return This Options so that you can chain calls to update values.
+     */
+    Options&
+    setMaxRto(Milliseconds maxRto)
+    {
+      maxRto_ = maxRto;
+      return *this;
+    }
+
+    /**
+     * Get the OnSegment callback.
+     * @return The OnSegment callback, or an empty OnSegment if not set.
+     */
+    const OnSegment&
+    getOnSegment() const { return onSegment_; }
+
+    /**
+     * Set the callback to receive the content of each segment in order
+     * instead of concatenating all the content for onComplete. If an output
+     * buffer or file is also set, this is called after writing the segment.
+     * @param onSegment When the next segment in order is received and
+     * verified, this calls onSegment(offset, content) where offset is the
+     * byte offset of the segment content in the whole object. This makes a
+     * copy of the function object.
+     * NOTE: The library will log any exceptions thrown by this callback, but
+     * for better error handling the callback should catch and properly handle
+     * any exceptions.
+     * @return This Options so that you can chain calls to update values.
+     */
+    Options&
+    setOnSegment(const OnSegment& onSegment)
+    {
+      onSegment_ = onSegment;
+      return *this;
+    }
+
+    /**
+     * Get the output buffer.
+     * @return The output buffer, or 0 if not set.
+     */
+    uint8_t*
+    getOutputBuffer() const { return outputBuffer_; }
+
+    /**
+     * Get the size of the output buffer.
+     * @return The size of the output buffer.
+     */
+    size_t
+    getOutputBufferSize() const { return outputBufferSize_; }
+
+    /**
+     * Set the buffer to receive the content of the segments, which are copied
+     * in order as they arrive instead of concatenating all the content for
+     * onComplete. If the content is larger than the buffer, fetching stops
+     * with IO_ERROR. To get the content size, also use setOnSegment.
+     * @param outputBuffer The output buffer. This does not make a copy; the
+     * buffer must remain valid while fetching.
+     * @param outputBufferSize The size of the output buffer.
+     * @return This Options so that you can chain calls to update values.
+     */
+    Options&
+    setOutputBuffer(uint8_t* outputBuffer, size_t outputBufferSize)
+    {
+      outputBuffer_ = outputBuffer;
+      outputBufferSize_ = outputBufferSize;
+      return *this;
+    }
+
+    /**
+     * Get the output file path.
+     * @return The output file path, or "" if not set.
+     */
+    const std::string&
+    getOutputFilePath() const { return outputFilePath_; }
+
+    /**
+     * Get the initial size of the output file.
+     * @return The initial size of the output file.
+     */
+    uint64_t
+    getOutputFileSize() const { return outputFileSize_; }
+
+    /**
+     * Set the file to receive the content of the segments. The file is
+     * created (or truncated) and memory-mapped with the initial size, and the
+     * content of the segments is copied in order as they arrive instead of
+     * concatenating all the content for onComplete. If the content is larger
+     * than the file, the file is grown. When fetching finishes or stops, the
+     * file is truncated to the size of the content received so far. This is
+     * not supported on platforms without mmap.
+     * @param outputFilePath The path of the output file.
+     * @param outputFileSize (optional) The initial size of the file, such as
+     * the expected size of the content. If omitted, use 0.
+     * @return This Options so that you can chain calls to update values.
+     */
+    Options&
+    setOutputFile(const std::string& outputFilePath, uint64_t outputFileSize = 0)
+    {
+      outputFilePath_ = outputFilePath;
+      outputFileSize_ = outputFileSize;
+      return *this;
+    }
+
+  private:
+    double initialWindow_;
+    double maxWindow_;
+    bool useConstantWindow_;
+    double aiStep_;
+    double mdCoefficient_;
+    bool useCubic_;
+    bool ignoreCongestionMarks_;
+    int maxRetries_;
+    Milliseconds initialRto_;
+    Milliseconds minRto_;
+    Milliseconds maxRto_;
+    OnSegment onSegment_;
+    uint8_t* outputBuffer_;
+    size_t outputBufferSize_;
+    std::string outputFilePath_;
+    uint64_t outputFileSize_;
   };
 
   typedef func_lib::function<bool(const ptr_lib::shared_ptr<Data>& data)> VerifySegment;
@@ -171,20 +569,158 @@ public:
     (Face& face, const Interest &baseInterest, KeyChain* validatorKeyChain,
      const OnComplete& onComplete, const OnError& onError);
 
+  /**
+   * Initiate segment fetching where the segments are verified with a
+   * SegmentManifest. After discovering the version, this fetches manifest
+   * segment 0 named /<prefix>/<version>/_manifest/<segment=0> and verifies it
+   * with verifySegment. Each segment and each following manifest segment is
+   * accepted only if its implicit SHA-256 digest matches the digest in the
+   * verified manifest. For more details, see the documentation for the class
+   * and SegmentManifest.
+   * @param face This calls face.expressInterest to fetch more segments.
+   * @param baseInterest An Interest for the initial segment of the requested
+   * data, where baseInterest.getName() has the name prefix. See fetch.
+   * @param verifySegment When manifest segment 0 is received this calls
+   * verifySegment(data). If it returns false then abort fetching and call
+   * onError with SEGMENT_VERIFICATION_FAILED.
+   * NOTE: The library will log any exceptions thrown by this callback, but for
+   * better error handling the callback should catch and properly handle any
+   * exceptions.
+   * @param onComplete When all segments are received, call
+   * onComplete(content) where content is the concatenation of the content of
+   * all the segments.
+   * NOTE: The library will log any exceptions thrown by this callback, but for
+   * better error handling the callback should catch and properly handle any
+   * exceptions.
+   * @param onError Call onError(errorCode, message) for timeout or an error
+   * processing segments, including a segment which does not match the
+   * manifest.
+   * NOTE: The library will log any exceptions thrown by this callback, but for
+   * better error handling the callback should catch and properly handle any
+   * exceptions.
+   */
+  static void
+  fetchWithManifest
+    (Face& face, const Interest &baseInterest, const VerifySegment& verifySegment,
+     const OnComplete& onComplete, const OnError& onError);
+
+  /**
+   * Initiate segment fetching where the segments are verified with a
+   * SegmentManifest. This is the same as fetchWithManifest with a
+   * VerifySegment, except that manifest segment 0 is validated with
+   * validatorKeyChain->verifyData(data). This does not make a copy of the
+   * KeyChain; the object must remain valid while fetching. If
+   * validatorKeyChain is null, this does not validate manifest segment 0.
+   */
+  static void
+  fetchWithManifest
+    (Face& face, const Interest &baseInterest, KeyChain* validatorKeyChain,
+     const OnComplete& onComplete, const OnError& onError);
+
+  /**
+   * Initiate segment fetching with a congestion-controlled pipeline of
+   * Interests. This is the same as fetch with a VerifySegment, except that
+   * after discovering the version this keeps a window of Interests
+   * outstanding as described in the documentation for the class.
+   * @param options The settings of the pipeline. This makes a copy.
+   */
+  static void
+  fetch
+    (Face& face, const Interest &baseInterest, const VerifySegment& verifySegment,
+     const OnComplete& onComplete, const OnError& onError,
+     const Options& options);
+
+  /**
+   * Initiate segment fetching with a congestion-controlled pipeline of
+   * Interests. This is the same as fetch with a KeyChain, except that after
+   * discovering the version this keeps a window of Interests outstanding as
+   * described in the documentation for the class.
+   * @param options The settings of the pipeline. This makes a copy.
+   */
+  static void
+  fetch
+    (Face& face, const Interest &baseInterest, KeyChain* validatorKeyChain,
+     const OnComplete& onComplete, const OnError& onError,
+     const Options& options);
+
+  /**
+   * Initiate segment fetching with a congestion-controlled pipeline of
+   * Interests where the segments are verified with a SegmentManifest. This is
+   * the same as fetchWithManifest with a VerifySegment, except that the
+   * segments are fetched with the pipeline as described in the documentation
+   * for the class. The manifest segments are fetched one at a time as needed
+   * to check the received segments.
+   * @param options The settings of the pipeline. This makes a copy.
+   */
+  static void
+  fetchWithManifest
+    (Face& face, const Interest &baseInterest, const VerifySegment& verifySegment,
+     const OnComplete& onComplete, const OnError& onError,
+     const Options& options);
+
+  /**
+   * Initiate segment fetching with a congestion-controlled pipeline of
+   * Interests where the segments are verified with a SegmentManifest. This is
+   * the same as fetchWithManifest with a KeyChain, except that the segments
+   * are fetched with the pipeline as described in the documentation for the
+   * class.
+   * @param options The settings of the pipeline. This makes a copy.
+   */
+  static void
+  fetchWithManifest
+    (Face& face, const Interest &baseInterest, KeyChain* validatorKeyChain,
+     const OnComplete& onComplete, const OnError& onError,
+     const Options& options);
+
 private:
   /**
    * Create a new SegmentFetcher to use the Face. See the static fetch method
    * for details. If validatorKeyChain is not null, use it and ignore
-   * verifySegment. After creating the SegmentFetcher, call fetchFirstSegment.
+   * verifySegment. If useManifest is true, only use validatorKeyChain or
+   * verifySegment for manifest segment 0. If options is not null, use the
+   * congestion-controlled pipeline with a copy of the options. After creating
+   * the SegmentFetcher, call fetchFirstSegment.
    */
   SegmentFetcher
     (Face& face, KeyChain* validatorKeyChain, const VerifySegment& verifySegment,
-     const OnComplete& onComplete, const OnError& onError)
+     const OnComplete& onComplete, const OnError& onError, bool useManifest,
+     const Options* options = 0)
   : face_(face), validatorKeyChain_(validatorKeyChain), verifySegment_(verifySegment),
-    onComplete_(onComplete), onError_(onError)
+    onComplete_(onComplete), onError_(onError), useManifest_(useManifest),
+    nextManifestSegment_(0), isFetchingManifest_(false), nManifestRetries_(0),
+    isPipelined_(options != 0), options_(options ? *options : Options()),
+    isStreaming_
+      (options_.getOnSegment() || options_.getOutputBuffer() ||
+       options_.getOutputFilePath() != ""),
+    rttEstimator_
+      (options_.getInitialRto(), options_.getMinRto(), options_.getMaxRto()),
+    hasVersionedName_(false), nSegments_(-1), nextSegmentToRequest_(0),
+    highInterest_(0), hasRecoveryPoint_(false), recoveryPoint_(0),
+    cwnd_(options_.getInitialWindow()), ssthresh_(options_.getMaxWindow()),
+    wMax_(0), lastDecreaseTime_(0), lastBackoffTime_(0),
+    nDiscoveryRetries_(0), isStopped_(false), nextSegmentToDeliver_(0),
+    deliveredSize_(0)
   {
   }
 
+  /**
+   * A PendingSegment holds the state of a segment Interest in the pipeline.
+   */
+  class PendingSegment {
+  public:
+    PendingSegment()
+    : sendTime_(0), nRetries_(0), pendingInterestId_(0), isInRetxQueue_(false)
+    {
+    }
+
+    MillisecondsSince1970 sendTime_;
+    int nRetries_;
+    uint64_t pendingInterestId_;
+    // True if the Interest timed out or got a Nack and is waiting in
+    // retxQueue_ to be sent again.
+    bool isInRetxQueue_;
+  };
+
   void
   fetchFirstSegment(const Interest& baseInterest);
 
@@ -209,6 +745,172 @@ private:
   void
   onTimeout(const ptr_lib::shared_ptr<const Interest>& interest);
 
+  /**
+   * Handle a verified segment in the pipeline. Save the content, learn the
+   * number of segments from the FinalBlockId, and finish or send more
+   * Interests.
+   * @param data The verified segment Data packet.
+   */
+  void
+  onPipelinedSegmentVerified(const ptr_lib::shared_ptr<Data>& data);
+
+  /**
+   * Update the RTT estimate and the congestion window for a segment which
+   * arrived in the pipeline, before it is verified.
+   * @param interest The Interest which fetched the segment.
+   * @param data The received Data packet.
+   * @return True if the segment should be verified and processed, or false if
+   * it is a duplicate or is no longer pending.
+   */
+  bool
+  onPipelinedSegmentArrived
+    (const ptr_lib::shared_ptr<const Interest>& interest,
+     const ptr_lib::shared_ptr<Data>& data);
+
+  void
+  onPipelinedTimeout(const ptr_lib::shared_ptr<const Interest>& interest);
+
+  void
+  onPipelinedNetworkNack
+    (const ptr_lib::shared_ptr<const Interest>& interest,
+     const ptr_lib::shared_ptr<NetworkNack>& networkNack);
+
+  /**
+   * Express the Interest for the first segment again after a timeout or
+   * Network Nack, or report the error if there are no more retries.
+   * @param interest The Interest for the first segment.
+   * @param errorCode The error code if there are no more retries.
+   * @param message The error message if there are no more retries.
+   */
+  void
+  retryFirstSegment
+    (const ptr_lib::shared_ptr<const Interest>& interest, ErrorCode errorCode,
+     const std::string& message);
+
+  /**
+   * In streaming mode, deliver the received segments which are next in order
+   * to the output buffer, output file and onSegment callback, and remove them
+   * from receivedSegments_.
+   * @return True for success, false if there was an error and fetching has
+   * stopped.
+   */
+  bool
+  deliverSegments();
+
+  /**
+   * Send Interests while the number in flight is less than the congestion
+   * window, first for segments waiting to be retransmitted and then for new
+   * segments.
+   */
+  void
+  schedulePackets();
+
+  /**
+   * Express the Interest for the segment in pendingSegments_ with the current
+   * RTO as its lifetime.
+   * @param segment The segment number.
+   */
+  void
+  sendSegmentInterest(uint64_t segment);
+
+  /**
+   * Put the segment in the retransmission queue, or report the error if it
+   * has no more retries.
+   * @param segment The segment number in pendingSegments_.
+   * @param errorCode The error code if there are no more retries.
+   * @param message The error message if there are no more retries.
+   * @return True if the segment will be retransmitted, false if fetching
+   * has stopped.
+   */
+  bool
+  enqueueRetransmission
+    (uint64_t segment, ErrorCode errorCode, const std::string& message);
+
+  void
+  increaseWindow();
+
+  /**
+   * Decrease the congestion window for a congestion signal on the segment,
+   * unless the window was already decreased for an Interest sent after it.
+   * @param segment The segment number with the congestion signal.
+   */
+  void
+  decreaseWindow(uint64_t segment);
+
+  /**
+   * Set nSegments_ and drop all state for segments past the last one.
+   * @param finalSegment The segment number from the FinalBlockId.
+   */
+  void
+  setFinalSegment(uint64_t finalSegment);
+
+  /**
+   * Stop the pipeline and remove the pending Interests from the face.
+   */
+  void
+  stop();
+
+  /**
+   * Concatenate the content parts and call onComplete_, logging any
+   * exception thrown by it.
+   * @param contentParts The content of the segments in order.
+   */
+  void
+  reportComplete(const std::vector<Blob>& contentParts);
+
+  /**
+   * Express the Interest for the next manifest segment. The Interest
+   * copies the selectors of originalInterest.
+   * @param originalInterest The Interest which fetched a segment.
+   * @param segmentName The name of a segment, used to get the
+   * /<prefix>/<version> name prefix.
+   */
+  void
+  fetchNextManifestSegment
+    (const Interest& originalInterest, const Name& segmentName);
+
+  void
+  onManifestSegmentReceived
+    (const ptr_lib::shared_ptr<const Interest>& originalInterest,
+     const ptr_lib::shared_ptr<Data>& data);
+
+  void
+  onManifestSegmentVerified
+    (const ptr_lib::shared_ptr<Data>& data,
+     const ptr_lib::shared_ptr<const Interest>& originalInterest);
+
+  /**
+   * In the pipeline, express the manifest segment Interest again up to the
+   * maximum retries, then report INTEREST_TIMEOUT.
+   */
+  void
+  onManifestTimeout(const ptr_lib::shared_ptr<const Interest>& interest);
+
+  void
+  onManifestNetworkNack
+    (const ptr_lib::shared_ptr<const Interest>& interest,
+     const ptr_lib::shared_ptr<NetworkNack>& networkNack);
+
+  /**
+   * Check the segment against the digests of the manifest segments received
+   * so far. If the digest for the segment is not known yet, save the segment
+   * and fetch the next manifest segment. In the pipeline, any number of
+   * segments can wait for the manifest.
+   * @param originalInterest The Interest which fetched the segment.
+   * @param data The segment Data packet.
+   */
+  void
+  checkSegmentWithManifest
+    (const ptr_lib::shared_ptr<const Interest>& originalInterest,
+     const ptr_lib::shared_ptr<Data>& data);
+
+  /**
+   * Stop the pipeline, call onError_ with the errorCode and message, and log
+   * any exception thrown by it.
+   */
+  void
+  reportError(ErrorCode errorCode, const std::string& message);
+
   /**
    * Check if the last component in the name is a segment number.
    * @param name The name to check.
@@ -226,6 +928,57 @@ private:
   VerifySegment verifySegment_;
   OnComplete onComplete_;
   OnError onError_;
+  bool useManifest_;
+  // The segment digests from the manifest segments verified so far.
+  std::vector<Blob> manifestDigests_;
+  // The digest of manifest segment nextManifestSegment_, if it is not 0.
+  Blob nextManifestDigest_;
+  uint64_t nextManifestSegment_;
+  bool isFetchingManifest_;
+  int nManifestRetries_;
+  // The segments waiting for the next manifest segment, with their Interest.
+  std::vector<std::pair<ptr_lib::shared_ptr<Data>,
+                        ptr_lib::shared_ptr<const Interest> > >
+    segmentsWaitingForManifest_;
+
+  // The following are only used by the pipeline.
+  class OutputFile;
+  bool isPipelined_;
+  Options options_;
+  // True if the segments are delivered in order instead of concatenated.
+  bool isStreaming_;
+  RttEstimator rttEstimator_;
+  // The Interest with the selectors of the base Interest for all segments.
+  Interest segmentInterestTemplate_;
+  // The /<prefix>/<version> name, if hasVersionedName_.
+  Name versionedName_;
+  bool hasVersionedName_;
+  // The number of segments from the FinalBlockId, or -1 if not known yet.
+  int64_t nSegments_;
+  uint64_t nextSegmentToRequest_;
+  // The highest segment number which was requested.
+  uint64_t highInterest_;
+  // The window is not decreased again for a segment up to recoveryPoint_.
+  bool hasRecoveryPoint_;
+  uint64_t recoveryPoint_;
+  // The key is the segment number.
+  std::map<uint64_t, PendingSegment> pendingSegments_;
+  std::deque<uint64_t> retxQueue_;
+  // The key is the segment number. The segments may arrive out of order.
+  std::map<uint64_t, Blob> receivedSegments_;
+  double cwnd_;
+  double ssthresh_;
+  // The window before the last decrease, for CUBIC.
+  double wMax_;
+  MillisecondsSince1970 lastDecreaseTime_;
+  MillisecondsSince1970 lastBackoffTime_;
+  int nDiscoveryRetries_;
+  bool isStopped_;
+  // In streaming mode, the segments before nextSegmentToDeliver_ have been
+  // delivered and removed from receivedSegments_.
+  uint64_t nextSegmentToDeliver_;
+  uint64_t deliveredSize_;
+  ptr_lib::shared_ptr<OutputFile> outputFile_;
 };
 
 }
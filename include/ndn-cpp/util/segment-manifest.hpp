@@ -0,0 +1,206 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Regents of the University of California.
+ * @author: Jeff Thompson <jefft0@remap.ucla.edu>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+#ifndef NDN_SEGMENT_MANIFEST_HPP
+#define NDN_SEGMENT_MANIFEST_HPP
+
+#include "../data.hpp"
+#include "../security/key-chain.hpp"
+
+namespace ndn {
+
+class TlvEncoder;
+
+/**
+ * A SegmentManifest holds the implicit SHA-256 digests of a range of segment
+ * Data packets so that a large segmented object can be signed once with the
+ * KeyChain instead of signing every segment with a public key.
+ *
+ * For segmented Data named /<prefix>/<version>/<segment>, the manifest is
+ * itself a chain of Data packets named
+ * /<prefix>/<version>/_manifest/<manifest-segment>. Manifest segment 0 is
+ * signed with the KeyChain. Every other manifest segment is verified by the
+ * digest of its full name which is listed in the previous manifest segment.
+ * The segments listed in the manifest only need a DigestSha256Signature,
+ * since the consumer checks them against the digests in the verified
+ * manifest. See makeManifest and SegmentFetcher::fetchWithManifest.
+ */
+class SegmentManifest {
+public:
+  /**
+   * Create a SegmentManifest with no digests.
+   */
+  SegmentManifest() {}
+
+  /**
+   * Create a SegmentManifest by decoding the input as an NDN-TLV
+   * SegmentManifest.
+   * @param input The input buffer to decode.
+   */
+  SegmentManifest(const Blob& input)
+  {
+    wireDecode(input);
+  }
+
+  /**
+   * Append the digest of the next segment.
+   * @param digest The implicit SHA-256 digest of the segment Data packet,
+   * which must have size ndn_SHA256_DIGEST_SIZE.
+   */
+  void
+  addDigest(const Blob& digest) { digests_.push_back(digest); }
+
+  /**
+   * Get the list of segment digests, in order of segment number.
+   * @return The list of digests.
+   */
+  const std::vector<Blob>&
+  getDigests() const { return digests_; }
+
+  /**
+   * Get the implicit SHA-256 digest of the next manifest segment.
+   * @return The digest, or an isNull Blob if this is the last manifest segment.
+   */
+  const Blob&
+  getNextManifestDigest() const { return nextManifestDigest_; }
+
+  /**
+   * Set the implicit SHA-256 digest of the next manifest segment.
+   * @param nextManifestDigest The digest, or an isNull Blob if this is the
+   * last manifest segment.
+   */
+  void
+  setNextManifestDigest(const Blob& nextManifestDigest)
+  {
+    nextManifestDigest_ = nextManifestDigest;
+  }
+
+  /**
+   * Remove the digests and the next manifest digest.
+   */
+  void
+  clear()
+  {
+    digests_.clear();
+    nextManifestDigest_ = Blob();
+  }
+
+  /**
+   * Encode this as an NDN-TLV SegmentManifest.
+   * @return The encoding as a Blob.
+   */
+  Blob
+  wireEncode() const;
+
+  /**
+   * Decode the input as an NDN-TLV SegmentManifest and update this object.
+   * @param input A pointer to the input buffer to decode.
+   * @param inputLength The number of bytes in input.
+   * @throws runtime_error for a decoding error.
+   */
+  void
+  wireDecode(const uint8_t *input, size_t inputLength);
+
+  /**
+   * Decode the input as an NDN-TLV SegmentManifest and update this object.
+   * @param input The input buffer to decode.
+   * @throws runtime_error for a decoding error.
+   */
+  void
+  wireDecode(const Blob& input)
+  {
+    wireDecode(input.buf(), input.size());
+  }
+
+  /**
+   * Sign each segment with a DigestSha256Signature and create the chain of
+   * manifest Data packets which list the segment digests. Manifest segment 0
+   * is signed with keyChain using signingInfo. Each other manifest segment is
+   * signed with a DigestSha256Signature and is covered by the digest in the
+   * previous manifest segment. The manifest Data packets have the
+   * FreshnessPeriod of the first segment.
+   * @param segments The segment Data packets, in order of segment number
+   * starting from 0, all with the same /<prefix>/<version> name prefix. This
+   * replaces the signature of each segment.
+   * @param keyChain The KeyChain for signing manifest segment 0.
+   * @param manifests Append the manifest Data packets to this list, in order
+   * of manifest segment number. The caller should publish these with the
+   * segments.
+   * @param signingInfo (optional) The SigningInfo for signing manifest
+   * segment 0. If omitted, use the default SigningInfo().
+   * @param maxDigestsPerManifest (optional) The maximum number of segment
+   * digests in each manifest segment. If omitted, use
+   * DEFAULT_MAX_DIGESTS_PER_MANIFEST.
+   * @throws runtime_error if segments is empty or maxDigestsPerManifest is 0.
+   */
+  static void
+  makeManifest
+    (const std::vector<ptr_lib::shared_ptr<Data> >& segments,
+     KeyChain& keyChain, std::vector<ptr_lib::shared_ptr<Data> >& manifests,
+     const SigningInfo& signingInfo = SigningInfo(),
+     size_t maxDigestsPerManifest = DEFAULT_MAX_DIGESTS_PER_MANIFEST);
+
+  /**
+   * Get the name prefix of the manifest segments for the segmented Data.
+   * @param versionedPrefix The /<prefix>/<version> name of the segmented Data.
+   * @return The name /<prefix>/<version>/_manifest .
+   */
+  static Name
+  getManifestPrefix(const Name& versionedPrefix)
+  {
+    return Name(versionedPrefix).append(getManifestComponent());
+  }
+
+  /**
+   * Get the name component which marks the manifest segments.
+   * @return The "_manifest" name component.
+   */
+  static const Name::Component&
+  getManifestComponent();
+
+  /**
+   * The default maximum number of digests in one manifest segment, so that
+   * the manifest content fits in half of MAX_NDN_PACKET_SIZE like the
+   * segments of PSyncSegmentPublisher.
+   */
+  static const size_t DEFAULT_MAX_DIGESTS_PER_MANIFEST = 128;
+
+  enum {
+    Tlv_SegmentManifest = 144,
+    Tlv_SegmentManifest_NextManifestDigest = 145
+  };
+
+private:
+  /**
+   * This is called by writeNestedTlv to encode the digests.
+   * @param context A pointer to the SegmentManifest.
+   * @param encoder The TlvEncoder.
+   */
+  static void
+  encodeContent(const void *context, TlvEncoder &encoder);
+
+  std::vector<Blob> digests_;
+  Blob nextManifestDigest_;
+};
+
+}
+
+#endif
@@ -0,0 +1,271 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Regents of the University of California.
+ * @author: Jeff Thompson <jefft0@remap.ucla.edu>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+#ifndef NDN_SEGMENT_PUBLISHER_HPP
+#define NDN_SEGMENT_PUBLISHER_HPP
+
+#include "../security/key-chain.hpp"
+
+namespace ndn {
+
+/**
+ * SegmentPublisher is the producer-side counterpart of SegmentFetcher. It
+ * divides a buffer or file into segments named
+ * <prefix>/<version>/<segment> with the FinalBlockId of the last segment,
+ * signs them in parallel on a pool of worker threads and passes each signed
+ * segment in order to an OnSegment callback, which normally adds it to a
+ * content store such as MemoryContentCache. For example:
+ * publisher.publish(prefix, content, bind(&MemoryContentCache::add, &cache, _1));
+ * The first segment is signed with keyChain.sign() on the calling thread to
+ * get the SignatureInfo and signing key, and the worker threads only encode
+ * the other segments and call the TPM's sign for them. With a security v1
+ * KeyChain, or if the number of threads is 1, all the segments are signed on
+ * the calling thread. The KeyChain should not be used by other threads while
+ * publish runs.
+ */
+class SegmentPublisher {
+public:
+  typedef func_lib::function<void(const Data& segment)> OnSegment;
+
+  /**
+   * An Options object holds the settings for the segments and the thread
+   * pool. Each setter returns this Options so that you can chain calls to
+   * update values.
+   */
+  class Options {
+  public:
+    /**
+     * Create an Options with the default values: a segment size of half of
+     * the maximum NDN packet size, no FreshnessPeriod, 4 threads and the
+     * default SigningInfo.
+     */
+    Options()
+    : segmentSize_(MAX_NDN_PACKET_SIZE / 2), freshnessPeriod_(-1.0),
+      nThreads_(4)
+    {
+    }
+
+    /**
+     * Get the maximum size of the content of each segment.
+     * @return The number of bytes.
+     */
+    size_t
+    getSegmentSize() const { return segmentSize_; }
+
+    /**
+     * Set the maximum size of the content of each segment.
+     * @param segmentSize The number of bytes, which must be greater than 0.
+     * @return This Options so that you can chain calls to update values.
+     */
+    Options&
+    setSegmentSize(size_t segmentSize)
+    {
+      segmentSize_ = segmentSize;
+      return *this;
+    }
+
+    /**
+     * Get the FreshnessPeriod of each segment.
+     * @return The FreshnessPeriod in milliseconds, or -1 to not set it.
+     */
+    Milliseconds
+    getFreshnessPeriod() const { return freshnessPeriod_; }
+
+    /**
+     * Set the FreshnessPeriod of each segment.
+     * @param freshnessPeriod The FreshnessPeriod in milliseconds, or -1 to not
+     * set it.
+     * @return This Options so that you can chain calls to update values.
+     */
+    Options&
+    setFreshnessPeriod(Milliseconds freshnessPeriod)
+    {
+      freshnessPeriod_ = freshnessPeriod;
+      return *this;
+    }
+
+    /**
+     * Get the number of signing threads.
+     * @return The number of threads.
+     */
+    size_t
+    getNThreads() const { return nThreads_; }
+
+    /**
+     * Set the number of signing threads. The SegmentPublisher constructor
+     * starts this many threads, unless it is 1 in which case it signs on the
+     * calling thread.
+     * @param nThreads The number of threads, which must be at least 1.
+     * @return This Options so that you can chain calls to update values.
+     */
+    Options&
+    setNThreads(size_t nThreads)
+    {
+      nThreads_ = nThreads;
+      return *this;
+    }
+
+    /**
+     * Get the SigningInfo for signing the segments.
+     * @return The SigningInfo.
+     */
+    const SigningInfo&
+    getSigningInfo() const { return signingInfo_; }
+
+    /**
+     * Set the SigningInfo for signing the segments.
+     * @param signingInfo The SigningInfo. This copies the object.
+     * @return This Options so that you can chain calls to update values.
+     */
+    Options&
+    setSigningInfo(const SigningInfo& signingInfo)
+    {
+      signingInfo_ = signingInfo;
+      return *this;
+    }
+
+  private:
+    size_t segmentSize_;
+    Milliseconds freshnessPeriod_;
+    size_t nThreads_;
+    SigningInfo signingInfo_;
+  };
+
+  /**
+   * Create a SegmentPublisher and start the worker threads.
+   * @param keyChain The KeyChain for signing the segments. The KeyChain must
+   * remain valid during the life of this object.
+   * @param options (optional) The Options. If omitted, use the default
+   * Options(). This copies the object.
+   * @throws runtime_error if the segment size or number of threads is 0, or
+   * if a thread can't be started.
+   */
+  SegmentPublisher(KeyChain& keyChain, const Options& options = Options());
+
+  /**
+   * Stop the worker threads.
+   */
+  ~SegmentPublisher();
+
+  /**
+   * Publish the content as segments of a new version of the object.
+   * @param prefix The name of the object. This appends the version as the
+   * current time in milliseconds and the segment number.
+   * @param content A pointer to the content. If contentLength is 0, this
+   * publishes one segment with empty content.
+   * @param contentLength The length of the content.
+   * @param onSegment This calls onSegment(segment) for each signed segment, in
+   * order of the segment number, on the calling thread.
+   * NOTE: The library will not catch exceptions thrown by this callback. They
+   * stop the publish and are passed to the caller.
+   * @return The versioned name of the object.
+   * @throws runtime_error if a segment can't be signed.
+   */
+  Name
+  publish
+    (const Name& prefix, const uint8_t* content, size_t contentLength,
+     const OnSegment& onSegment);
+
+  /**
+   * Publish the content as segments of a new version of the object. This is
+   * the same as publish(prefix, content.buf(), content.size(), onSegment).
+   */
+  Name
+  publish(const Name& prefix, const Blob& content, const OnSegment& onSegment)
+  {
+    return publish(prefix, content.buf(), content.size(), onSegment);
+  }
+
+  /**
+   * Read the file and publish its contents as segments of a new version of
+   * the object. This only reads enough of the file at a time to give each
+   * thread a batch of segments.
+   * @param prefix The name of the object. This appends the version and the
+   * segment number.
+   * @param filePath The path of the file.
+   * @param onSegment See publish.
+   * @return The versioned name of the object.
+   * @throws runtime_error if the file can't be read or if a segment can't be
+   * signed.
+   */
+  Name
+  publishFile
+    (const Name& prefix, const std::string& filePath,
+     const OnSegment& onSegment);
+
+  /**
+   * Get the number of segments from the last call to publish or publishFile.
+   * @return The number of segments.
+   */
+  uint64_t
+  getLastSegmentCount() const { return lastSegmentCount_; }
+
+  /**
+   * Get the throughput of the last call to publish or publishFile, which is
+   * the content size divided by the time to make, sign and pass all the
+   * segments to onSegment.
+   * @return The throughput in megabytes (10^6 bytes) per second.
+   */
+  double
+  getLastThroughput() const { return lastThroughput_; }
+
+private:
+  // WorkerPool is defined in the source file so that this header does not
+  // depend on the threading library.
+  class WorkerPool;
+
+  /**
+   * Make and sign the segments from the content in batches and call
+   * onSegment.
+   * @param readContent A function object which is called as
+   * readContent(buffer, length) to fill the buffer with the next length bytes
+   * of the content.
+   */
+  Name
+  publishSegments
+    (const Name& prefix, uint64_t contentLength,
+     const func_lib::function<void(uint8_t* buffer, size_t length)>& readContent,
+     const OnSegment& onSegment);
+
+  /**
+   * Encode the segment, sign the encoding and set the signature. The segment
+   * already has the SignatureInfo. This is called by the worker threads.
+   * @param segment The segment to sign.
+   * @param keyName The name of the key, or an empty Name to sign with a
+   * SHA-256 digest.
+   */
+  void
+  signSegment(Data& segment, const Name& keyName);
+
+  // Disable the copy constructor and assignment operator.
+  SegmentPublisher(const SegmentPublisher& other);
+  SegmentPublisher& operator=(const SegmentPublisher& other);
+
+  KeyChain& keyChain_;
+  Options options_;
+  ptr_lib::shared_ptr<WorkerPool> workerPool_;
+  uint64_t lastSegmentCount_;
+  double lastThroughput_;
+};
+
+}
+
+#endif
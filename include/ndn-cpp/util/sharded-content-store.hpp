@@ -0,0 +1,175 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Regents of the University of California.
+ * @author: Jeff Thompson <jefft0@remap.ucla.edu>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+#ifndef NDN_SHARDED_CONTENT_STORE_HPP
+#define NDN_SHARDED_CONTENT_STORE_HPP
+
+#include "../face.hpp"
+
+namespace ndn {
+
+/**
+ * A ShardedContentStore holds a set of Data packets and answers an Interest to
+ * return the correct Data packet, like MemoryContentCache, but it can be used
+ * from multiple threads. For example, producer threads can call add() with
+ * Data packets which they have already encoded and signed while the thread
+ * which calls face.processEvents() answers Interests from the store.
+ * The Data packets are divided among shards, each with its own reader-writer
+ * lock, so that threads which use different shards do not wait for each other
+ * and threads which only find Data packets do not wait for each other. The
+ * shard of a Data packet is selected by a hash of the first
+ * nShardKeyComponents components of its name, so an Interest whose name has
+ * at least this many components is answered from one shard. An Interest with a
+ * shorter name must search all the shards.
+ * The store holds the name and wire encoding of each Data packet, so that
+ * threads do not share a Data object. If a Data packet with the same name is
+ * added, it replaces the previous one.
+ */
+class ShardedContentStore {
+public:
+  /**
+   * Create a ShardedContentStore.
+   * @param nShards (optional) The number of shards. More shards allow more
+   * threads to add Data packets at the same time. If omitted, use 16.
+   * @param nShardKeyComponents (optional) The number of name components used
+   * to select the shard. This should be the number of components of the
+   * prefix which is shared by related Data packets, such as the segments of
+   * one object. If omitted, use 2.
+   */
+  ShardedContentStore(size_t nShards = 16, size_t nShardKeyComponents = 2);
+
+  ~ShardedContentStore();
+
+  /**
+   * Add the Data packet to the store. This is thread safe. This copies the
+   * name and wire encoding of the Data packet, where wireEncode() returns the
+   * cached encoding if the Data packet has already been encoded or signed. If
+   * the Data packet has a FreshnessPeriod, it is stale when the
+   * FreshnessPeriod expires and is removed by removeStaleContent().
+   * @param data The Data packet object to put in the store. This calls
+   * data.wireEncode(), so the Data object must not be used at the same time by
+   * another thread.
+   */
+  void
+  add(const Data& data);
+
+  /**
+   * Remove the Data packet with the name from the store. This is thread safe.
+   * @param name The name of the Data packet.
+   * @return True if the Data packet was removed, or false if it was not in the
+   * store.
+   */
+  bool
+  remove(const Name& name);
+
+  /**
+   * Find the Data packet which best matches the interest, according to the
+   * Interest's selectors. This is thread safe.
+   * @param interest The Interest to match.
+   * @return The wire encoding of the matching Data packet, or an isNull() Blob
+   * if not found.
+   */
+  Blob
+  find(const Interest& interest) const;
+
+  /**
+   * Remove the Data packets whose FreshnessPeriod has expired. This is thread
+   * safe, and only locks one shard at a time.
+   * @return The number of removed Data packets.
+   */
+  size_t
+  removeStaleContent();
+
+  /**
+   * Get the number of Data packets in the store. This is thread safe, but
+   * other threads may change the count while this adds up the shards.
+   * @return The number of Data packets.
+   */
+  size_t
+  size() const;
+
+  /**
+   * Get the number of shards given to the constructor.
+   * @return The number of shards.
+   */
+  size_t
+  getShardCount() const { return shards_.size(); }
+
+  /**
+   * Set the callback for an Interest which onInterest cannot answer from the
+   * store. This is not thread safe, so you should call it before calling
+   * face.setInterestFilter.
+   * @param onDataNotFound This calls
+   * onDataNotFound(prefix, interest, face, interestFilterId, filter). If this
+   * is an empty OnInterestCallback(), it is not used. This copies the function
+   * object, so you may need to use func_lib::ref() as appropriate.
+   * NOTE: The library will log any exceptions thrown by this callback, but for
+   * better error handling the callback should catch and properly handle any
+   * exceptions.
+   */
+  void
+  setOnDataNotFound(const OnInterestCallback& onDataNotFound)
+  {
+    onDataNotFound_ = onDataNotFound;
+  }
+
+  /**
+   * This is the OnInterestCallback to pass to face.setInterestFilter, using
+   * for example
+   * bind(&ShardedContentStore::onInterest, &store, _1, _2, _3, _4, _5) .
+   * Find the best matching Data packet and send it with face.send(), or call
+   * the callback from setOnDataNotFound. This is called on the thread of
+   * face.processEvents(), so it uses the Face without locking it.
+   */
+  void
+  onInterest
+    (const ptr_lib::shared_ptr<const Name>& prefix,
+     const ptr_lib::shared_ptr<const Interest>& interest, Face& face,
+     uint64_t interestFilterId,
+     const ptr_lib::shared_ptr<const InterestFilter>& filter);
+
+private:
+  // Shard is defined in the source file so that this header does not depend
+  // on the threading library.
+  class Shard;
+
+  /**
+   * Get the shard for the name, using a hash of the first nShardKeyComponents_
+   * components.
+   * @param name The name, which must have at least nShardKeyComponents_
+   * components, or be the name of a Data packet.
+   * @return The shard.
+   */
+  Shard&
+  getShard(const Name& name) const;
+
+  // Disable the copy constructor and assignment operator.
+  ShardedContentStore(const ShardedContentStore& other);
+  ShardedContentStore& operator=(const ShardedContentStore& other);
+
+  std::vector<ptr_lib::shared_ptr<Shard> > shards_;
+  size_t nShardKeyComponents_;
+  OnInterestCallback onDataNotFound_;
+};
+
+}
+
+#endif
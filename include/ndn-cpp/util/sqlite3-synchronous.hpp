@@ -0,0 +1,45 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Regents of the University of California.
+ * @author: Jeff Thompson <jefft0@remap.ucla.edu>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+#ifndef NDN_SQLITE3_SYNCHRONOUS_HPP
+#define NDN_SQLITE3_SYNCHRONOUS_HPP
+
+namespace ndn {
+
+/** Sqlite3Synchronous defines the Sqlite3Synchronous::Level enum for the
+ * SQLite "PRAGMA synchronous" setting of the SQLite3 databases such as
+ * PibSqlite3. The databases use write-ahead logging (WAL) where NORMAL is
+ * safe from corruption and only a power loss can lose the most recent
+ * transactions. See https://www.sqlite.org/pragma.html#pragma_synchronous .
+ */
+class Sqlite3Synchronous {
+public:
+  enum Level {
+    OFF = 0,
+    NORMAL = 1,
+    FULL = 2,
+    EXTRA = 3
+  };
+};
+
+}
+
+#endif
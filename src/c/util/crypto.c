@@ -19,6 +19,7 @@
  */
 
 #include "crypto.h"
+#include "sha256-multi-buffer.h"
 
 #ifdef ARDUINO
 
@@ -163,3 +164,34 @@ const struct ndn_EcKeyInfo *
 ndn_getEcKeyInfo(int i) { return 0; }
 
 #endif
+
+void
+ndn_digestSha256Multi
+  (const uint8_t * const *data, const size_t *dataLength, size_t nBuffers,
+   uint8_t *digests)
+{
+  size_t i = 0;
+
+#if NDN_HAVE_SHA256_MULTI_BUFFER
+  if (ndn_Sha256MultiBuffer_isPreferred()) {
+    for (; i + NDN_SHA256_MULTI_BUFFER_LANES <= nBuffers;
+         i += NDN_SHA256_MULTI_BUFFER_LANES)
+      ndn_Sha256MultiBuffer_digest
+        (data + i, dataLength + i, NDN_SHA256_MULTI_BUFFER_LANES,
+         digests + i * ndn_SHA256_DIGEST_SIZE);
+
+    if (nBuffers - i > 1) {
+      // Hash the remaining buffers in one pass with some lanes unused.
+      ndn_Sha256MultiBuffer_digest
+        (data + i, dataLength + i, nBuffers - i,
+         digests + i * ndn_SHA256_DIGEST_SIZE);
+      return;
+    }
+  }
+#endif
+
+  // Hash one buffer at a time. (With the SHA extensions, this is faster.)
+  for (; i < nBuffers; ++i)
+    ndn_digestSha256
+      (data[i], dataLength[i], digests + i * ndn_SHA256_DIGEST_SIZE);
+}
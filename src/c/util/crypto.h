@@ -47,6 +47,22 @@ struct ndn_EcKeyInfo {
  */
 void ndn_digestSha256(const uint8_t *data, size_t dataLength, uint8_t *digest);
 
+/**
+ * Compute the sha-256 digest of each of a list of independent buffers. If the
+ * CPU supports it, this hashes several buffers at once with multi-buffer SIMD
+ * instructions, which is faster than calling ndn_digestSha256 for each buffer.
+ * @param data An array of nBuffers pointers to the input byte arrays.
+ * @param dataLength An array of the nBuffers lengths of the input byte arrays.
+ * @param nBuffers The number of input buffers.
+ * @param digests A pointer to a buffer of size
+ * nBuffers * ndn_SHA256_DIGEST_SIZE to receive the digests, in the same order
+ * as data.
+ */
+void
+ndn_digestSha256Multi
+  (const uint8_t * const *data, const size_t *dataLength, size_t nBuffers,
+   uint8_t *digests);
+
 /**
  * Fill the buffer with random bytes.
  * @param buffer Write the random bytes to this buffer.
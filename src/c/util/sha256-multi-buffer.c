@@ -0,0 +1,297 @@
+/**
+ * Copyright (C) 2020 Regents of the University of California.
+ * @author: Jeff Thompson <jefft0@remap.ucla.edu>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+#include "sha256-multi-buffer.h"
+
+#if NDN_HAVE_SHA256_MULTI_BUFFER
+
+#include <string.h>
+#include <cpuid.h>
+#include <immintrin.h>
+
+#define SHA256_BLOCK_SIZE 64
+
+static const uint32_t K256[64] = {
+  0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5,
+  0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+  0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+  0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+  0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc,
+  0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+  0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7,
+  0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+  0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+  0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+  0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3,
+  0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+  0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5,
+  0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+  0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+  0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+static const uint32_t H256[8] = {
+  0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+  0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+};
+
+static int isSupported = -1;
+static int isPreferred = -1;
+
+int
+ndn_Sha256MultiBuffer_isSupported()
+{
+  if (isSupported < 0) {
+    __builtin_cpu_init();
+    isSupported = __builtin_cpu_supports("avx2") ? 1 : 0;
+  }
+
+  return isSupported;
+}
+
+int
+ndn_Sha256MultiBuffer_isPreferred()
+{
+  if (isPreferred < 0) {
+    int hasShaExtensions = 0;
+    unsigned int eax, ebx, ecx, edx;
+
+    if (__get_cpuid_max(0, 0) >= 7) {
+      __cpuid_count(7, 0, eax, ebx, ecx, edx);
+      // CPUID.(EAX=7,ECX=0):EBX bit 29 is SHA.
+      hasShaExtensions = (ebx & (1U << 29)) != 0;
+    }
+
+    isPreferred = ndn_Sha256MultiBuffer_isSupported() && !hasShaExtensions;
+  }
+
+  return isPreferred;
+}
+
+#define ROTR(x, n) \
+  _mm256_or_si256(_mm256_srli_epi32(x, n), _mm256_slli_epi32(x, 32 - (n)))
+#define BIG_SIGMA0(x) \
+  _mm256_xor_si256(_mm256_xor_si256(ROTR(x, 2), ROTR(x, 13)), ROTR(x, 22))
+#define BIG_SIGMA1(x) \
+  _mm256_xor_si256(_mm256_xor_si256(ROTR(x, 6), ROTR(x, 11)), ROTR(x, 25))
+#define SMALL_SIGMA0(x) _mm256_xor_si256 \
+  (_mm256_xor_si256(ROTR(x, 7), ROTR(x, 18)), _mm256_srli_epi32(x, 3))
+#define SMALL_SIGMA1(x) _mm256_xor_si256 \
+  (_mm256_xor_si256(ROTR(x, 17), ROTR(x, 19)), _mm256_srli_epi32(x, 10))
+// (e & f) ^ (~e & g)
+#define CH(e, f, g) \
+  _mm256_xor_si256(_mm256_and_si256(e, f), _mm256_andnot_si256(e, g))
+// (a & b) ^ (a & c) ^ (b & c) == (a & (b | c)) | (b & c)
+#define MAJ(a, b, c) _mm256_or_si256 \
+  (_mm256_and_si256(a, _mm256_or_si256(b, c)), _mm256_and_si256(b, c))
+
+/**
+ * Load the 32-byte row at offset of each lane's block and transpose so that
+ * w[i] has message word offset/4 + i of all the lanes, in host byte order.
+ */
+__attribute__((target("avx2")))
+static void
+loadWords(const uint8_t * const *blocks, size_t offset, __m256i *w)
+{
+  const __m256i byteSwap = _mm256_set_epi8
+    (12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3,
+     12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3);
+  __m256i r[8], t[8], u[8];
+  int i;
+
+  for (i = 0; i < 8; ++i)
+    r[i] = _mm256_loadu_si256((const __m256i *)(blocks[i] + offset));
+
+  for (i = 0; i < 8; i += 2) {
+    t[i] = _mm256_unpacklo_epi32(r[i], r[i + 1]);
+    t[i + 1] = _mm256_unpackhi_epi32(r[i], r[i + 1]);
+  }
+  for (i = 0; i < 8; i += 4) {
+    u[i] = _mm256_unpacklo_epi64(t[i], t[i + 2]);
+    u[i + 1] = _mm256_unpackhi_epi64(t[i], t[i + 2]);
+    u[i + 2] = _mm256_unpacklo_epi64(t[i + 1], t[i + 3]);
+    u[i + 3] = _mm256_unpackhi_epi64(t[i + 1], t[i + 3]);
+  }
+  for (i = 0; i < 4; ++i) {
+    w[i] = _mm256_shuffle_epi8
+      (_mm256_permute2x128_si256(u[i], u[i + 4], 0x20), byteSwap);
+    w[i + 4] = _mm256_shuffle_epi8
+      (_mm256_permute2x128_si256(u[i], u[i + 4], 0x31), byteSwap);
+  }
+}
+
+/**
+ * Process one 64-byte block in each lane and update the state of the lanes
+ * which are set in activeMask.
+ */
+__attribute__((target("avx2")))
+static void
+compressBlocks
+  (__m256i *state, const uint8_t * const *blocks, __m256i activeMask)
+{
+  __m256i w[16];
+  __m256i a = state[0], b = state[1], c = state[2], d = state[3];
+  __m256i e = state[4], f = state[5], g = state[6], h = state[7];
+  __m256i t1, t2;
+  int i;
+
+  loadWords(blocks, 0, w);
+  loadWords(blocks, 32, w + 8);
+
+  for (i = 0; i < 64; ++i) {
+    if (i >= 16)
+      w[i & 15] = _mm256_add_epi32
+        (_mm256_add_epi32(w[i & 15], SMALL_SIGMA0(w[(i + 1) & 15])),
+         _mm256_add_epi32(w[(i + 9) & 15], SMALL_SIGMA1(w[(i + 14) & 15])));
+
+    t1 = _mm256_add_epi32
+      (_mm256_add_epi32(h, BIG_SIGMA1(e)),
+       _mm256_add_epi32
+       (CH(e, f, g),
+        _mm256_add_epi32(_mm256_set1_epi32((int)K256[i]), w[i & 15])));
+    t2 = _mm256_add_epi32(BIG_SIGMA0(a), MAJ(a, b, c));
+    h = g;
+    g = f;
+    f = e;
+    e = _mm256_add_epi32(d, t1);
+    d = c;
+    c = b;
+    b = a;
+    a = _mm256_add_epi32(t1, t2);
+  }
+
+  state[0] = _mm256_blendv_epi8
+    (state[0], _mm256_add_epi32(state[0], a), activeMask);
+  state[1] = _mm256_blendv_epi8
+    (state[1], _mm256_add_epi32(state[1], b), activeMask);
+  state[2] = _mm256_blendv_epi8
+    (state[2], _mm256_add_epi32(state[2], c), activeMask);
+  state[3] = _mm256_blendv_epi8
+    (state[3], _mm256_add_epi32(state[3], d), activeMask);
+  state[4] = _mm256_blendv_epi8
+    (state[4], _mm256_add_epi32(state[4], e), activeMask);
+  state[5] = _mm256_blendv_epi8
+    (state[5], _mm256_add_epi32(state[5], f), activeMask);
+  state[6] = _mm256_blendv_epi8
+    (state[6], _mm256_add_epi32(state[6], g), activeMask);
+  state[7] = _mm256_blendv_epi8
+    (state[7], _mm256_add_epi32(state[7], h), activeMask);
+}
+
+__attribute__((target("avx2")))
+void
+ndn_Sha256MultiBuffer_digest
+  (const uint8_t * const *data, const size_t *dataLength, size_t nBuffers,
+   uint8_t *digests)
+{
+  // The padded final one or two blocks of each lane.
+  uint8_t tail[NDN_SHA256_MULTI_BUFFER_LANES][2 * SHA256_BLOCK_SIZE];
+  size_t nFullBlocks[NDN_SHA256_MULTI_BUFFER_LANES];
+  int32_t nBlocks[NDN_SHA256_MULTI_BUFFER_LANES];
+  const uint8_t *blocks[NDN_SHA256_MULTI_BUFFER_LANES];
+  uint32_t result[8][NDN_SHA256_MULTI_BUFFER_LANES];
+  __m256i state[8];
+  __m256i nBlocksVector;
+  int32_t maxBlocks = 0;
+  int32_t iBlock;
+  size_t lane;
+  int i;
+
+  if (nBuffers > NDN_SHA256_MULTI_BUFFER_LANES)
+    nBuffers = NDN_SHA256_MULTI_BUFFER_LANES;
+
+  for (lane = 0; lane < NDN_SHA256_MULTI_BUFFER_LANES; ++lane) {
+    size_t length = lane < nBuffers ? dataLength[lane] : 0;
+    size_t remaining = length % SHA256_BLOCK_SIZE;
+    size_t nTailBlocks =
+      remaining + 9 > SHA256_BLOCK_SIZE ? 2 : 1;
+    uint64_t bitLength = (uint64_t)length * 8;
+    uint8_t *lengthField;
+
+    nFullBlocks[lane] = length / SHA256_BLOCK_SIZE;
+    // An unused lane still hashes one padding block, but it is masked out.
+    nBlocks[lane] = lane < nBuffers ?
+      (int32_t)(nFullBlocks[lane] + nTailBlocks) : 0;
+    if (nBlocks[lane] > maxBlocks)
+      maxBlocks = nBlocks[lane];
+
+    memset(tail[lane], 0, sizeof(tail[lane]));
+    if (remaining > 0)
+      memcpy(tail[lane], data[lane] + length - remaining, remaining);
+    tail[lane][remaining] = 0x80;
+    lengthField = tail[lane] + nTailBlocks * SHA256_BLOCK_SIZE - 8;
+    for (i = 7; i >= 0; --i) {
+      lengthField[i] = (uint8_t)bitLength;
+      bitLength >>= 8;
+    }
+  }
+
+  for (i = 0; i < 8; ++i)
+    state[i] = _mm256_set1_epi32((int)H256[i]);
+  nBlocksVector = _mm256_loadu_si256((const __m256i *)nBlocks);
+
+  for (iBlock = 0; iBlock < maxBlocks; ++iBlock) {
+    __m256i activeMask = _mm256_cmpgt_epi32
+      (nBlocksVector, _mm256_set1_epi32(iBlock));
+
+    for (lane = 0; lane < NDN_SHA256_MULTI_BUFFER_LANES; ++lane) {
+      if ((size_t)iBlock < nFullBlocks[lane])
+        blocks[lane] = data[lane] + (size_t)iBlock * SHA256_BLOCK_SIZE;
+      else if (iBlock < nBlocks[lane])
+        blocks[lane] = tail[lane] +
+          ((size_t)iBlock - nFullBlocks[lane]) * SHA256_BLOCK_SIZE;
+      else
+        // The lane is finished. Load anything since it is masked out.
+        blocks[lane] = tail[lane];
+    }
+
+    compressBlocks(state, blocks, activeMask);
+  }
+
+  for (i = 0; i < 8; ++i)
+    _mm256_storeu_si256((__m256i *)result[i], state[i]);
+  for (lane = 0; lane < nBuffers; ++lane) {
+    uint8_t *digest = digests + lane * ndn_SHA256_DIGEST_SIZE;
+    for (i = 0; i < 8; ++i) {
+      uint32_t word = result[i][lane];
+      digest[4 * i] = (uint8_t)(word >> 24);
+      digest[4 * i + 1] = (uint8_t)(word >> 16);
+      digest[4 * i + 2] = (uint8_t)(word >> 8);
+      digest[4 * i + 3] = (uint8_t)word;
+    }
+  }
+}
+
+#else
+
+int
+ndn_Sha256MultiBuffer_isSupported() { return 0; }
+
+int
+ndn_Sha256MultiBuffer_isPreferred() { return 0; }
+
+void
+ndn_Sha256MultiBuffer_digest
+  (const uint8_t * const *data, const size_t *dataLength, size_t nBuffers,
+   uint8_t *digests)
+{
+}
+
+#endif
@@ -0,0 +1,87 @@
+/**
+ * Copyright (C) 2020 Regents of the University of California.
+ * @author: Jeff Thompson <jefft0@remap.ucla.edu>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+/*
+ * Multi-buffer SHA-256 computes the digests of up to
+ * NDN_SHA256_MULTI_BUFFER_LANES independent messages at once, one message in
+ * each 32-bit lane of the AVX2 registers. This is only compiled for x86 with
+ * GCC or Clang, and is only used if the CPU supports AVX2.
+ */
+
+#ifndef NDN_SHA256_MULTI_BUFFER_H
+#define NDN_SHA256_MULTI_BUFFER_H
+
+#include <ndn-cpp/c/common.h>
+
+#if !defined(ARDUINO) && defined(__GNUC__) && \
+    (defined(__x86_64__) || defined(__i386__)) && \
+    (defined(__clang__) || __GNUC__ >= 5)
+#define NDN_HAVE_SHA256_MULTI_BUFFER 1
+#else
+#define NDN_HAVE_SHA256_MULTI_BUFFER 0
+#endif
+
+/** The number of messages that ndn_Sha256MultiBuffer_digest hashes at once. */
+#define NDN_SHA256_MULTI_BUFFER_LANES 8
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Check if ndn_Sha256MultiBuffer_digest can run on this CPU. The result is
+ * computed once and cached.
+ * @return 1 if the CPU supports AVX2, else 0. This is always 0 if
+ * NDN_HAVE_SHA256_MULTI_BUFFER is 0.
+ */
+int
+ndn_Sha256MultiBuffer_isSupported();
+
+/**
+ * Check if ndn_Sha256MultiBuffer_digest is faster on this CPU than computing
+ * each digest with ndn_digestSha256. This is false if the CPU has the SHA
+ * extensions (SHA-NI), which hash one message faster than AVX2 can hash one
+ * lane.
+ * @return 1 if multi-buffer hashing should be used, else 0.
+ */
+int
+ndn_Sha256MultiBuffer_isPreferred();
+
+/**
+ * Compute the SHA-256 digest of each message. This should only be called if
+ * ndn_Sha256MultiBuffer_isSupported() returns 1.
+ * @param data An array of nBuffers pointers to the messages.
+ * @param dataLength An array of the nBuffers message lengths.
+ * @param nBuffers The number of messages, from 1 to
+ * NDN_SHA256_MULTI_BUFFER_LANES.
+ * @param digests A pointer to a buffer of size
+ * nBuffers * ndn_SHA256_DIGEST_SIZE to receive the digests, in the same order
+ * as data.
+ */
+void
+ndn_Sha256MultiBuffer_digest
+  (const uint8_t * const *data, const size_t *dataLength, size_t nBuffers,
+   uint8_t *digests);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
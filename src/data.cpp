@@ -57,7 +57,7 @@ Data::Data(const Data& data)
 : name_(data.name_),
   metaInfo_(data.metaInfo_),
   content_(data.content_),
-  defaultFullName_(new Name(*data.defaultFullName_)),
+  defaultFullName_(new Name()),
   changeCount_(0)
 {
   if (data.signature_.get()) {
@@ -66,6 +66,8 @@ Data::Data(const Data& data)
   }
   setDefaultWireEncoding
     (data.getDefaultWireEncoding(), data.defaultWireEncodingFormat_);
+  // Copy the full name after setDefaultWireEncoding, which clears it.
+  *defaultFullName_ = *data.defaultFullName_;
 }
 
 Data::~Data()
@@ -133,6 +135,57 @@ Data::getFullName(WireFormat& wireFormat) const
   return fullName;
 }
 
+void
+Data::getFullNames
+  (const vector<ptr_lib::shared_ptr<Data> >& dataList,
+   vector<ptr_lib::shared_ptr<Name> >& fullNames, WireFormat& wireFormat)
+{
+  bool isDefaultWireFormat =
+    (&wireFormat == WireFormat::getDefaultWireFormat());
+  size_t firstResult = fullNames.size();
+  fullNames.resize(firstResult + dataList.size());
+
+  // Get the encodings which still need a digest.
+  vector<size_t> toHash;
+  vector<SignedBlob> encodings;
+  for (size_t i = 0; i < dataList.size(); ++i) {
+    const Data& data = *dataList[i];
+    if (isDefaultWireFormat && !data.getDefaultWireEncoding().isNull() &&
+        data.defaultFullName_->size() > 0 &&
+        data.getDefaultWireEncodingFormat() == &wireFormat)
+      fullNames[firstResult + i] = data.defaultFullName_;
+    else {
+      toHash.push_back(i);
+      // wireEncode will use the cached encoding if possible.
+      encodings.push_back(data.wireEncode(wireFormat));
+    }
+  }
+  if (toHash.size() == 0)
+    return;
+
+  vector<const uint8_t*> buffers(encodings.size());
+  vector<size_t> bufferLengths(encodings.size());
+  for (size_t i = 0; i < encodings.size(); ++i) {
+    buffers[i] = encodings[i].buf();
+    bufferLengths[i] = encodings[i].size();
+  }
+  vector<uint8_t> digests(encodings.size() * ndn_SHA256_DIGEST_SIZE);
+  CryptoLite::digestSha256Multi
+    (&buffers.front(), &bufferLengths.front(), buffers.size(), &digests.front());
+
+  for (size_t j = 0; j < toHash.size(); ++j) {
+    const Data& data = *dataList[toHash[j]];
+    ptr_lib::shared_ptr<Name> fullName(new Name(data.getName()));
+    fullName->appendImplicitSha256Digest
+      (Blob(&digests[j * ndn_SHA256_DIGEST_SIZE], ndn_SHA256_DIGEST_SIZE));
+
+    if (isDefaultWireFormat)
+      // wireEncode has already set defaultWireEncodingFormat_.
+      const_cast<Data&>(data).defaultFullName_ = fullName;
+    fullNames[firstResult + toHash[j]] = fullName;
+  }
+}
+
 void
 Data::get(DataLite& dataLite) const
 {
@@ -29,6 +29,7 @@
 #include <stdlib.h>
 #include <sstream>
 #include <fstream>
+#include "../util/sqlite3-statement.hpp"
 #include <ndn-cpp/encrypt/sqlite3-consumer-db.hpp>
 
 using namespace std;
@@ -45,16 +46,6 @@ static const string INITIALIZATION =
   "CREATE UNIQUE INDEX IF NOT EXISTS                  \n"
   "   KeyNameIndex ON decryptionkeys(key_name);       \n";
 
-/**
- * A utility function to call the normal sqlite3_bind_blob where the value and
- * length are blob.buf() and blob.size().
- */
-static int sqlite3_bind_blob
-  (sqlite3_stmt* statement, int index, const Blob& value, void(*destructor)(void*))
-{
-  return sqlite3_bind_blob(statement, index, value.buf(), value.size(), destructor);
-}
-
 Sqlite3ConsumerDb::Sqlite3ConsumerDb(const string& databaseFilePath)
 {
   int status = sqlite3_open(databaseFilePath.c_str(), &database_);
@@ -62,6 +53,10 @@ Sqlite3ConsumerDb::Sqlite3ConsumerDb(const string& databaseFilePath)
   if (status != SQLITE_OK)
     throw ConsumerDb::Error("Consumer DB cannot be opened/created");
 
+  statementCache_.reset(new Sqlite3StatementCache(database_));
+  // Use write-ahead logging so that each change needs fewer disk syncs.
+  statementCache_->enableWriteAheadLog(Sqlite3Synchronous::NORMAL);
+
   // Enable foreign keys.
   sqlite3_exec(database_, "PRAGMA foreign_keys = ON", NULL, NULL, NULL);
 
@@ -74,40 +69,67 @@ Sqlite3ConsumerDb::Sqlite3ConsumerDb(const string& databaseFilePath)
   }
 }
 
+Sqlite3ConsumerDb::~Sqlite3ConsumerDb()
+{
+  // Finalize the cached statements before closing.
+  statementCache_.reset();
+  sqlite3_close(database_);
+}
+
+void
+Sqlite3ConsumerDb::setSynchronous(Sqlite3Synchronous::Level level)
+{
+  if (statementCache_->setSynchronous(level) != SQLITE_OK)
+    throw ConsumerDb::Error
+      ("Sqlite3ConsumerDb: Cannot set the synchronous level");
+}
+
+void
+Sqlite3ConsumerDb::beginTransaction()
+{
+  if (statementCache_->beginTransaction() != SQLITE_OK)
+    throw ConsumerDb::Error("Sqlite3ConsumerDb: Cannot begin a transaction");
+}
+
+void
+Sqlite3ConsumerDb::commitTransaction()
+{
+  if (statementCache_->commitTransaction() != SQLITE_OK)
+    throw ConsumerDb::Error("Sqlite3ConsumerDb: Cannot commit the transaction");
+}
+
+void
+Sqlite3ConsumerDb::rollbackTransaction()
+{
+  if (statementCache_->rollbackTransaction() != SQLITE_OK)
+    throw ConsumerDb::Error
+      ("Sqlite3ConsumerDb: Cannot roll back the transaction");
+}
+
 Blob
 Sqlite3ConsumerDb::getKey(const Name& keyName)
 {
-  sqlite3_stmt *statement;
-  sqlite3_prepare_v2
-    (database_, "SELECT key_buf FROM decryptionkeys WHERE key_name=?",
-     -1, &statement, 0);
-  sqlite3_bind_blob(statement, 1, keyName.wireEncode(), SQLITE_TRANSIENT);
-
-  int res = sqlite3_step(statement);
+  Sqlite3Statement statement
+    (*statementCache_, "SELECT key_buf FROM decryptionkeys WHERE key_name=?");
+  statement.bind(1, keyName.wireEncode());
 
   Blob key;
-  if (res == SQLITE_ROW)
-    key = Blob
-      (static_cast<const uint8_t*>(sqlite3_column_blob(statement, 0)),
-       sqlite3_column_bytes(statement, 0));
+  if (statement.step() == SQLITE_ROW)
+    key = statement.getBlob(0);
 
-  sqlite3_finalize(statement);
   return key;
 }
 
 void
 Sqlite3ConsumerDb::addKey(const Name& keyName, const Blob& keyBlob)
 {
-  sqlite3_stmt *statement;
-  sqlite3_prepare_v2
-    (database_, "INSERT INTO decryptionkeys(key_name, key_buf) values (?, ?)",
-     -1, &statement, 0);
-  sqlite3_bind_blob(statement, 1, keyName.wireEncode(), SQLITE_TRANSIENT);
-  sqlite3_bind_blob(statement, 2, keyBlob, SQLITE_TRANSIENT);
-
-  int status = sqlite3_step(statement);
-  sqlite3_finalize(statement);
-  if (status != SQLITE_DONE)
+  Sqlite3Statement statement
+    (*statementCache_,
+     "INSERT INTO decryptionkeys(key_name, key_buf) values (?, ?)");
+  statement.bind(1, keyName.wireEncode());
+  statement.bind(2, keyBlob);
+
+  if (statement.step() != SQLITE_DONE)
     throw ConsumerDb::Error
       ("Sqlite3ConsumerDb::addKey: Cannot add the key to the database");
 }
@@ -115,12 +137,10 @@ Sqlite3ConsumerDb::addKey(const Name& keyName, const Blob& keyBlob)
 void
 Sqlite3ConsumerDb::deleteKey(const Name& keyName)
 {
-  sqlite3_stmt *statement;
-  sqlite3_prepare_v2
-    (database_, "DELETE FROM decryptionkeys WHERE key_name=?", -1, &statement, 0);
-  sqlite3_bind_blob(statement, 1, keyName.wireEncode(), SQLITE_TRANSIENT);
-  sqlite3_step(statement);
-  sqlite3_finalize(statement);
+  Sqlite3Statement statement
+    (*statementCache_, "DELETE FROM decryptionkeys WHERE key_name=?");
+  statement.bind(1, keyName.wireEncode());
+  statement.step();
 }
 
 }
@@ -29,6 +29,7 @@
 #include <stdlib.h>
 #include <sstream>
 #include <fstream>
+#include "../util/sqlite3-statement.hpp"
 #include <ndn-cpp/encrypt/sqlite3-group-manager-db.hpp>
 
 using namespace std;
@@ -69,26 +70,6 @@ namespace ndn {
   "CREATE UNIQUE INDEX IF NOT EXISTS                  \n"
   "   ekeyNameIndex ON ekeys(ekey_name);              \n";
 
-/**
- * A utility function to call the normal sqlite3_bind_text where the value and
- * length are value.c_str() and value.size().
- */
-static int sqlite3_bind_text
-  (sqlite3_stmt* statement, int index, const string& value, void(*destructor)(void*))
-{
-  return sqlite3_bind_text(statement, index, value.c_str(), value.size(), destructor);
-}
-
-/**
- * A utility function to call the normal sqlite3_bind_blob where the value and
- * length are blob.buf() and blob.size().
- */
-static int sqlite3_bind_blob
-  (sqlite3_stmt* statement, int index, const Blob& value, void(*destructor)(void*))
-{
-  return sqlite3_bind_blob(statement, index, value.buf(), value.size(), destructor);
-}
-
 Sqlite3GroupManagerDb::Sqlite3GroupManagerDb(const string& databaseFilePath)
 {
   int status = sqlite3_open(databaseFilePath.c_str(), &database_);
@@ -96,6 +77,10 @@ Sqlite3GroupManagerDb::Sqlite3GroupManagerDb(const string& databaseFilePath)
   if (status != SQLITE_OK)
     throw GroupManagerDb::Error("GroupManager DB cannot be opened/created");
 
+  statementCache_.reset(new Sqlite3StatementCache(database_));
+  // Use write-ahead logging so that each change needs fewer disk syncs.
+  statementCache_->enableWriteAheadLog(Sqlite3Synchronous::NORMAL);
+
   // Enable foreign keys.
   sqlite3_exec(database_, "PRAGMA foreign_keys = ON", NULL, NULL, NULL);
 
@@ -108,18 +93,53 @@ Sqlite3GroupManagerDb::Sqlite3GroupManagerDb(const string& databaseFilePath)
   }
 }
 
+Sqlite3GroupManagerDb::~Sqlite3GroupManagerDb()
+{
+  // Finalize the cached statements before closing.
+  statementCache_.reset();
+  sqlite3_close(database_);
+}
+
+void
+Sqlite3GroupManagerDb::setSynchronous(Sqlite3Synchronous::Level level)
+{
+  if (statementCache_->setSynchronous(level) != SQLITE_OK)
+    throw GroupManagerDb::Error
+      ("Sqlite3GroupManagerDb: Cannot set the synchronous level");
+}
+
+void
+Sqlite3GroupManagerDb::beginTransaction()
+{
+  if (statementCache_->beginTransaction() != SQLITE_OK)
+    throw GroupManagerDb::Error
+      ("Sqlite3GroupManagerDb: Cannot begin a transaction");
+}
+
+void
+Sqlite3GroupManagerDb::commitTransaction()
+{
+  if (statementCache_->commitTransaction() != SQLITE_OK)
+    throw GroupManagerDb::Error
+      ("Sqlite3GroupManagerDb: Cannot commit the transaction");
+}
+
+void
+Sqlite3GroupManagerDb::rollbackTransaction()
+{
+  if (statementCache_->rollbackTransaction() != SQLITE_OK)
+    throw GroupManagerDb::Error
+      ("Sqlite3GroupManagerDb: Cannot roll back the transaction");
+}
+
 bool
 Sqlite3GroupManagerDb::hasSchedule(const string& name)
 {
-  sqlite3_stmt *statement;
-  sqlite3_prepare_v2
-    (database_, "SELECT schedule_id FROM schedules WHERE schedule_name=?",
-     -1, &statement, 0);
-  sqlite3_bind_text(statement, 1, name, SQLITE_TRANSIENT);
-
-  bool result = (sqlite3_step(statement) == SQLITE_ROW);
-  sqlite3_finalize(statement);
-  return result;
+  Sqlite3Statement statement
+    (*statementCache_, "SELECT schedule_id FROM schedules WHERE schedule_name=?");
+  statement.bind(1, name);
+
+  return statement.step() == SQLITE_ROW;
 }
 
 void
@@ -127,48 +147,33 @@ Sqlite3GroupManagerDb::listAllScheduleNames(vector<string>& nameList)
 {
   nameList.clear();
 
-  sqlite3_stmt* statement;
-  sqlite3_prepare_v2
-    (database_, "SELECT schedule_name FROM schedules", -1, &statement, 0);
-
-  while (sqlite3_step(statement) == SQLITE_ROW)
-    nameList.push_back
-      (string(reinterpret_cast<const char *>(sqlite3_column_text(statement, 0)),
-              sqlite3_column_bytes(statement, 0)));
+  Sqlite3Statement statement
+    (*statementCache_, "SELECT schedule_name FROM schedules");
 
-  sqlite3_finalize(statement);
+  while (statement.step() == SQLITE_ROW)
+    nameList.push_back(statement.getString(0));
 }
 
 ptr_lib::shared_ptr<Schedule>
 Sqlite3GroupManagerDb::getSchedule(const string& name)
 {
-  sqlite3_stmt *statement;
-  sqlite3_prepare_v2
-    (database_, "SELECT schedule FROM schedules where schedule_name=?",
-     -1, &statement, 0);
-  sqlite3_bind_text(statement, 1, name, SQLITE_TRANSIENT);
+  Sqlite3Statement statement
+    (*statementCache_, "SELECT schedule FROM schedules where schedule_name=?");
+  statement.bind(1, name);
 
-  int status = sqlite3_step(statement);
-
-  if (status == SQLITE_ROW) {
+  if (statement.step() == SQLITE_ROW) {
     ptr_lib::shared_ptr<Schedule> result(new Schedule());
     try {
-      result->wireDecode
-        (Blob((const uint8_t*)sqlite3_column_blob(statement, 0),
-              sqlite3_column_bytes(statement, 0)));
+      result->wireDecode(statement.getBlob(0));
     } catch (...) {
-      sqlite3_finalize(statement);
       throw GroupManagerDb::Error
         ("Sqlite3GroupManagerDb::getSchedule: The schedule cannot be decoded");
     }
 
-    sqlite3_finalize(statement);
     return result;
   }
-  else {
-    sqlite3_finalize(statement);
+  else
     throw GroupManagerDb::Error("Cannot get the result from the database");
-  }
 }
 
 void
@@ -177,31 +182,24 @@ Sqlite3GroupManagerDb::getScheduleMembers
 {
   memberMap.clear();
 
-  sqlite3_stmt* statement;
-  sqlite3_prepare_v2
-    (database_,
+  Sqlite3Statement statement
+    (*statementCache_,
      "SELECT key_name, pubkey\
       FROM members JOIN schedules ON members.schedule_id=schedules.schedule_id\
-      WHERE schedule_name=?", -1, &statement, 0);
-  sqlite3_bind_text(statement, 1, name, SQLITE_TRANSIENT);
+      WHERE schedule_name=?");
+  statement.bind(1, name);
 
-  while (sqlite3_step(statement) == SQLITE_ROW) {
+  while (statement.step() == SQLITE_ROW) {
     Name keyName;
     try {
-      keyName.wireDecode
-        (Blob((const uint8_t*)sqlite3_column_blob(statement, 0),
-              sqlite3_column_bytes(statement, 0)));
+      keyName.wireDecode(statement.getBlob(0));
     } catch (...) {
-      sqlite3_finalize(statement);
       throw GroupManagerDb::Error
         ("Sqlite3GroupManagerDb.getScheduleMembers: Error decoding name");
     }
 
-    memberMap[keyName] = Blob((const uint8_t*)sqlite3_column_blob(statement, 1),
-                              sqlite3_column_bytes(statement, 1));
+    memberMap[keyName] = statement.getBlob(1);
   }
-
-  sqlite3_finalize(statement);
 }
 
 void
@@ -210,28 +208,23 @@ Sqlite3GroupManagerDb::addSchedule(const string& name, const Schedule& schedule)
   if (name.size() == 0)
     throw GroupManagerDb::Error("addSchedule: The schedule name cannot be empty");
 
-  sqlite3_stmt *statement;
-  sqlite3_prepare_v2
-    (database_, "INSERT INTO schedules (schedule_name, schedule) values (?, ?)",
-     -1, &statement, 0);
-  sqlite3_bind_text(statement, 1, name, SQLITE_TRANSIENT);
-  sqlite3_bind_blob(statement, 2, schedule.wireEncode(), SQLITE_TRANSIENT);
+  Sqlite3Statement statement
+    (*statementCache_,
+     "INSERT INTO schedules (schedule_name, schedule) values (?, ?)");
+  statement.bind(1, name);
+  statement.bind(2, schedule.wireEncode());
 
-  int status = sqlite3_step(statement);
-  sqlite3_finalize(statement);
-  if (status != SQLITE_DONE)
+  if (statement.step() != SQLITE_DONE)
     throw GroupManagerDb::Error("Cannot add the schedule to the database");
 }
 
 void
 Sqlite3GroupManagerDb::deleteSchedule(const string& name)
 {
-  sqlite3_stmt *statement;
-  sqlite3_prepare_v2
-    (database_, "DELETE FROM schedules WHERE schedule_name=?", -1, &statement, 0);
-  sqlite3_bind_text(statement, 1, name, SQLITE_TRANSIENT);
-  sqlite3_step(statement);
-  sqlite3_finalize(statement);
+  Sqlite3Statement statement
+    (*statementCache_, "DELETE FROM schedules WHERE schedule_name=?");
+  statement.bind(1, name);
+  statement.step();
 }
 
 void
@@ -242,16 +235,13 @@ Sqlite3GroupManagerDb::renameSchedule
     throw GroupManagerDb::Error
       ("renameSchedule: The schedule newName cannot be empty");
 
-  sqlite3_stmt *statement;
-  sqlite3_prepare_v2
-    (database_, "UPDATE schedules SET schedule_name=? WHERE schedule_name=?",
-     -1, &statement, 0);
-  sqlite3_bind_text(statement, 1, newName, SQLITE_TRANSIENT);
-  sqlite3_bind_text(statement, 2, oldName, SQLITE_TRANSIENT);
+  Sqlite3Statement statement
+    (*statementCache_,
+     "UPDATE schedules SET schedule_name=? WHERE schedule_name=?");
+  statement.bind(1, newName);
+  statement.bind(2, oldName);
 
-  int status = sqlite3_step(statement);
-  sqlite3_finalize(statement);
-  if (status != SQLITE_DONE)
+  if (statement.step() != SQLITE_DONE)
     throw GroupManagerDb::Error("Cannot rename the schedule in the database");
 }
 
@@ -264,31 +254,23 @@ Sqlite3GroupManagerDb::updateSchedule
     return;
   }
 
-  sqlite3_stmt *statement;
-  sqlite3_prepare_v2
-    (database_, "UPDATE schedules SET schedule=? WHERE schedule_name=?",
-     -1, &statement, 0);
-  sqlite3_bind_blob(statement, 1, schedule.wireEncode(), SQLITE_TRANSIENT);
-  sqlite3_bind_text(statement, 2, name, SQLITE_TRANSIENT);
+  Sqlite3Statement statement
+    (*statementCache_, "UPDATE schedules SET schedule=? WHERE schedule_name=?");
+  statement.bind(1, schedule.wireEncode());
+  statement.bind(2, name);
 
-  int status = sqlite3_step(statement);
-  sqlite3_finalize(statement);
-  if (status != SQLITE_DONE)
+  if (statement.step() != SQLITE_DONE)
     throw GroupManagerDb::Error("Cannot update the schedule in the database");
 }
 
 bool
 Sqlite3GroupManagerDb::hasMember(const Name& identity)
 {
-  sqlite3_stmt *statement;
-  sqlite3_prepare_v2
-    (database_, "SELECT member_id FROM members WHERE member_name=?",
-     -1, &statement, 0);
-  sqlite3_bind_blob(statement, 1, identity.wireEncode(), SQLITE_TRANSIENT);
-
-  bool result = (sqlite3_step(statement) == SQLITE_ROW);
-  sqlite3_finalize(statement);
-  return result;
+  Sqlite3Statement statement
+    (*statementCache_, "SELECT member_id FROM members WHERE member_name=?");
+  statement.bind(1, identity.wireEncode());
+
+  return statement.step() == SQLITE_ROW;
 }
 
 void
@@ -296,53 +278,36 @@ Sqlite3GroupManagerDb::listAllMembers(vector<Name>& nameList)
 {
   nameList.clear();
 
-  sqlite3_stmt* statement;
-  sqlite3_prepare_v2
-    (database_, "SELECT member_name FROM members", -1, &statement, 0);
+  Sqlite3Statement statement
+    (*statementCache_, "SELECT member_name FROM members");
 
-  while (sqlite3_step(statement) == SQLITE_ROW) {
+  while (statement.step() == SQLITE_ROW) {
     Name name;
     try {
-      name.wireDecode
-        (Blob((const uint8_t*)sqlite3_column_blob(statement, 0),
-              sqlite3_column_bytes(statement, 0)));
+      name.wireDecode(statement.getBlob(0));
     } catch (...) {
-      sqlite3_finalize(statement);
       throw GroupManagerDb::Error
         ("Sqlite3GroupManagerDb.listAllMembers: Error decoding name");
     }
 
     nameList.push_back(name);
   }
-
-  sqlite3_finalize(statement);
 }
 
 string
 Sqlite3GroupManagerDb::getMemberSchedule(const Name& identity)
 {
-  sqlite3_stmt *statement;
-  sqlite3_prepare_v2
-    (database_,
+  Sqlite3Statement statement
+    (*statementCache_,
      "SELECT schedule_name\
       FROM schedules JOIN members ON schedules.schedule_id = members.schedule_id\
-      WHERE member_name=?",
-     -1, &statement, 0);
-  sqlite3_bind_blob(statement, 1, identity.wireEncode(), SQLITE_TRANSIENT);
-
-  int status = sqlite3_step(statement);
+      WHERE member_name=?");
+  statement.bind(1, identity.wireEncode());
 
-  if (status == SQLITE_ROW) {
-    string result(reinterpret_cast<const char *>(sqlite3_column_text(statement, 0)),
-                  sqlite3_column_bytes(statement, 0));
-
-    sqlite3_finalize(statement);
-    return result;
-  }
-  else {
-    sqlite3_finalize(statement);
+  if (statement.step() == SQLITE_ROW)
+    return statement.getString(0);
+  else
     throw GroupManagerDb::Error("Cannot get the result from the database");
-  }
 }
 
 void
@@ -356,20 +321,16 @@ Sqlite3GroupManagerDb::addMember
   // Needs to be changed in the future.
   Name memberName = keyName.getPrefix(-1);
 
-  sqlite3_stmt *statement;
-  sqlite3_prepare_v2
-    (database_,
+  Sqlite3Statement statement
+    (*statementCache_,
      "INSERT INTO members(schedule_id, member_name, key_name, pubkey)\
-      values (?, ?, ?, ?)",
-     -1, &statement, 0);
-  sqlite3_bind_int(statement, 1, scheduleId);
-  sqlite3_bind_blob(statement, 2, memberName.wireEncode(), SQLITE_TRANSIENT);
-  sqlite3_bind_blob(statement, 3, keyName.wireEncode(), SQLITE_TRANSIENT);
-  sqlite3_bind_blob(statement, 4, key, SQLITE_TRANSIENT);
-
-  int status = sqlite3_step(statement);
-  sqlite3_finalize(statement);
-  if (status != SQLITE_DONE)
+      values (?, ?, ?, ?)");
+  statement.bind(1, scheduleId);
+  statement.bind(2, memberName.wireEncode());
+  statement.bind(3, keyName.wireEncode());
+  statement.bind(4, key);
+
+  if (statement.step() != SQLITE_DONE)
     throw GroupManagerDb::Error("Cannot add the member to the database");
 }
 
@@ -382,57 +343,44 @@ Sqlite3GroupManagerDb::updateMemberSchedule
     throw GroupManagerDb::Error
       ("Sqlite3GroupManagerDb.updateMemberSchedule: The schedule does not exist");
 
-  sqlite3_stmt *statement;
-  sqlite3_prepare_v2
-    (database_, "UPDATE members SET schedule_id=? WHERE member_name=?",
-     -1, &statement, 0);
-  sqlite3_bind_int(statement, 1, scheduleId);
-  sqlite3_bind_blob(statement, 2, identity.wireEncode(), SQLITE_TRANSIENT);
+  Sqlite3Statement statement
+    (*statementCache_, "UPDATE members SET schedule_id=? WHERE member_name=?");
+  statement.bind(1, scheduleId);
+  statement.bind(2, identity.wireEncode());
 
-  int status = sqlite3_step(statement);
-  sqlite3_finalize(statement);
-  if (status != SQLITE_DONE)
+  if (statement.step() != SQLITE_DONE)
     throw GroupManagerDb::Error("Sqlite3GroupManagerDb.updateMemberSchedule: SQLite error");
 }
 
 void
 Sqlite3GroupManagerDb::deleteMember(const Name& identity)
 {
-  sqlite3_stmt *statement;
-  sqlite3_prepare_v2
-    (database_, "DELETE FROM members WHERE member_name=?", -1, &statement, 0);
-  sqlite3_bind_blob(statement, 1, identity.wireEncode(), SQLITE_TRANSIENT);
-  sqlite3_step(statement);
-  sqlite3_finalize(statement);
+  Sqlite3Statement statement
+    (*statementCache_, "DELETE FROM members WHERE member_name=?");
+  statement.bind(1, identity.wireEncode());
+  statement.step();
 }
 
 bool
 Sqlite3GroupManagerDb::hasEKey(const Name& eKeyName)
 {
-  sqlite3_stmt *statement;
-  sqlite3_prepare_v2
-    (database_, "SELECT ekey_id FROM ekeys where ekey_name=?", -1, &statement, 0);
-  sqlite3_bind_blob(statement, 1, eKeyName.wireEncode(), SQLITE_TRANSIENT);
+  Sqlite3Statement statement
+    (*statementCache_, "SELECT ekey_id FROM ekeys where ekey_name=?");
+  statement.bind(1, eKeyName.wireEncode());
 
-  bool result = (sqlite3_step(statement) == SQLITE_ROW);
-  sqlite3_finalize(statement);
-  return result;
+  return statement.step() == SQLITE_ROW;
 }
 
 void
 Sqlite3GroupManagerDb::addEKey
   (const Name& eKeyName, const Blob& publicKey, const Blob& privateKey)
 {
-  sqlite3_stmt *statement;
-  sqlite3_prepare_v2
-    (database_, "INSERT INTO ekeys(ekey_name, pub_key) values (?, ?)",
-     -1, &statement, 0);
-  sqlite3_bind_blob(statement, 1, eKeyName.wireEncode(), SQLITE_TRANSIENT);
-  sqlite3_bind_blob(statement, 2, publicKey, SQLITE_TRANSIENT);
-
-  int status = sqlite3_step(statement);
-  sqlite3_finalize(statement);
-  if (status != SQLITE_DONE)
+  Sqlite3Statement statement
+    (*statementCache_, "INSERT INTO ekeys(ekey_name, pub_key) values (?, ?)");
+  statement.bind(1, eKeyName.wireEncode());
+  statement.bind(2, publicKey);
+
+  if (statement.step() != SQLITE_DONE)
     throw GroupManagerDb::Error("Cannot add the EKey to database");
 
   privateKeyBase_[eKeyName] = privateKey;
@@ -442,22 +390,14 @@ void
 Sqlite3GroupManagerDb::getEKey
   (const Name& eKeyName, Blob& publicKey, Blob& privateKey)
 {
-  sqlite3_stmt *statement;
-  sqlite3_prepare_v2
-    (database_, "SELECT pub_key FROM ekeys where ekey_name=?", -1, &statement, 0);
-  sqlite3_bind_blob(statement, 1, eKeyName.wireEncode(), SQLITE_TRANSIENT);
-
-  int status = sqlite3_step(statement);
+  Sqlite3Statement statement
+    (*statementCache_, "SELECT pub_key FROM ekeys where ekey_name=?");
+  statement.bind(1, eKeyName.wireEncode());
 
-  if (status == SQLITE_ROW) {
-    publicKey = Blob((const uint8_t*)sqlite3_column_blob(statement, 0),
-      sqlite3_column_bytes(statement, 0));
-    sqlite3_finalize(statement);
-  }
-  else {
-    sqlite3_finalize(statement);
+  if (statement.step() == SQLITE_ROW)
+    publicKey = statement.getBlob(0);
+  else
     throw GroupManagerDb::Error("Cannot get the result from the database");
-  }
 
   privateKey = privateKeyBase_[eKeyName];
 }
@@ -465,10 +405,8 @@ Sqlite3GroupManagerDb::getEKey
 void
 Sqlite3GroupManagerDb::cleanEKeys()
 {
-  sqlite3_stmt *statement;
-  sqlite3_prepare_v2(database_, "DELETE FROM ekeys", -1, &statement, 0);
-  sqlite3_step(statement);
-  sqlite3_finalize(statement);
+  Sqlite3Statement statement(*statementCache_, "DELETE FROM ekeys");
+  statement.step();
 
   privateKeyBase_.clear();
 }
@@ -476,12 +414,10 @@ Sqlite3GroupManagerDb::cleanEKeys()
 void
 Sqlite3GroupManagerDb::deleteEKey(const Name& eKeyName)
 {
-  sqlite3_stmt *statement;
-  sqlite3_prepare_v2
-    (database_, "DELETE FROM ekeys WHERE ekey_name=?", -1, &statement, 0);
-  sqlite3_bind_blob(statement, 1, eKeyName.wireEncode(), SQLITE_TRANSIENT);
-  sqlite3_step(statement);
-  sqlite3_finalize(statement);
+  Sqlite3Statement statement
+    (*statementCache_, "DELETE FROM ekeys WHERE ekey_name=?");
+  statement.bind(1, eKeyName.wireEncode());
+  statement.step();
 
   map<Name, Blob>::iterator it = privateKeyBase_.find(eKeyName);
   privateKeyBase_.erase(it);
@@ -490,19 +426,14 @@ Sqlite3GroupManagerDb::deleteEKey(const Name& eKeyName)
 int
 Sqlite3GroupManagerDb::getScheduleId(const std::string& name)
 {
-  sqlite3_stmt *statement;
-  sqlite3_prepare_v2
-    (database_, "SELECT schedule_id FROM schedules WHERE schedule_name=?",
-     -1, &statement, 0);
-  sqlite3_bind_text(statement, 1, name, SQLITE_TRANSIENT);
-
-  int status = sqlite3_step(statement);
+  Sqlite3Statement statement
+    (*statementCache_, "SELECT schedule_id FROM schedules WHERE schedule_name=?");
+  statement.bind(1, name);
 
   int result = -1;
-  if (status == SQLITE_ROW)
-    result = sqlite3_column_int(statement, 0);
+  if (statement.step() == SQLITE_ROW)
+    result = statement.getInt(0);
 
-  sqlite3_finalize(statement);
   return result;
 }
 
@@ -29,6 +29,7 @@
 #include <stdlib.h>
 #include <sstream>
 #include <fstream>
+#include "../util/sqlite3-statement.hpp"
 #include <ndn-cpp/encrypt/sqlite3-producer-db.hpp>
 
 using namespace std;
@@ -45,16 +46,6 @@ static const string INITIALIZATION =
   "CREATE UNIQUE INDEX IF NOT EXISTS                  \n"
   "   timeslotIndex ON contentkeys(timeslot);         \n";
 
-/**
- * A utility function to call the normal sqlite3_bind_blob where the value and
- * length are blob.buf() and blob.size().
- */
-static int sqlite3_bind_blob
-  (sqlite3_stmt* statement, int index, const Blob& value, void(*destructor)(void*))
-{
-  return sqlite3_bind_blob(statement, index, value.buf(), value.size(), destructor);
-}
-
 Sqlite3ProducerDb::Sqlite3ProducerDb(const string& databaseFilePath)
 {
   int status = sqlite3_open(databaseFilePath.c_str(), &database_);
@@ -62,6 +53,10 @@ Sqlite3ProducerDb::Sqlite3ProducerDb(const string& databaseFilePath)
   if (status != SQLITE_OK)
     throw ProducerDb::Error("Producer DB cannot be opened/created");
 
+  statementCache_.reset(new Sqlite3StatementCache(database_));
+  // Use write-ahead logging so that each change needs fewer disk syncs.
+  statementCache_->enableWriteAheadLog(Sqlite3Synchronous::NORMAL);
+
   // Enable foreign keys.
   sqlite3_exec(database_, "PRAGMA foreign_keys = ON", NULL, NULL, NULL);
 
@@ -74,20 +69,53 @@ Sqlite3ProducerDb::Sqlite3ProducerDb(const string& databaseFilePath)
   }
 }
 
+Sqlite3ProducerDb::~Sqlite3ProducerDb()
+{
+  // Finalize the cached statements before closing.
+  statementCache_.reset();
+  sqlite3_close(database_);
+}
+
+void
+Sqlite3ProducerDb::setSynchronous(Sqlite3Synchronous::Level level)
+{
+  if (statementCache_->setSynchronous(level) != SQLITE_OK)
+    throw ProducerDb::Error
+      ("Sqlite3ProducerDb: Cannot set the synchronous level");
+}
+
+void
+Sqlite3ProducerDb::beginTransaction()
+{
+  if (statementCache_->beginTransaction() != SQLITE_OK)
+    throw ProducerDb::Error("Sqlite3ProducerDb: Cannot begin a transaction");
+}
+
+void
+Sqlite3ProducerDb::commitTransaction()
+{
+  if (statementCache_->commitTransaction() != SQLITE_OK)
+    throw ProducerDb::Error("Sqlite3ProducerDb: Cannot commit the transaction");
+}
+
+void
+Sqlite3ProducerDb::rollbackTransaction()
+{
+  if (statementCache_->rollbackTransaction() != SQLITE_OK)
+    throw ProducerDb::Error
+      ("Sqlite3ProducerDb: Cannot roll back the transaction");
+}
+
 bool
 Sqlite3ProducerDb::hasContentKey(MillisecondsSince1970 timeSlot)
 {
   int fixedTimeSlot = getFixedTimeSlot(timeSlot);
 
-  sqlite3_stmt *statement;
-  sqlite3_prepare_v2
-    (database_, "SELECT key FROM contentkeys where timeslot=?",
-     -1, &statement, 0);
-  sqlite3_bind_int(statement, 1, fixedTimeSlot);
+  Sqlite3Statement statement
+    (*statementCache_, "SELECT key FROM contentkeys where timeslot=?");
+  statement.bind(1, fixedTimeSlot);
 
-  bool result = (sqlite3_step(statement) == SQLITE_ROW);
-  sqlite3_finalize(statement);
-  return result;
+  return statement.step() == SQLITE_ROW;
 }
 
 Blob
@@ -95,20 +123,12 @@ Sqlite3ProducerDb::getContentKey(MillisecondsSince1970 timeSlot)
 {
   int fixedTimeSlot = getFixedTimeSlot(timeSlot);
 
-  sqlite3_stmt *statement;
-  sqlite3_prepare_v2
-    (database_, "SELECT key FROM contentkeys where timeslot=?", -1, &statement, 0);
-  sqlite3_bind_int(statement, 1, fixedTimeSlot);
-
-  int res = sqlite3_step(statement);
+  Sqlite3Statement statement
+    (*statementCache_, "SELECT key FROM contentkeys where timeslot=?");
+  statement.bind(1, fixedTimeSlot);
 
-  if (res == SQLITE_ROW) {
-    Blob result = Blob
-      (static_cast<const uint8_t*>(sqlite3_column_blob(statement, 0)),
-       sqlite3_column_bytes(statement, 0));
-    sqlite3_finalize(statement);
-    return result;
-  }
+  if (statement.step() == SQLITE_ROW)
+    return statement.getBlob(0);
   else
     throw ProducerDb::Error
       ("Sqlite3ProducerDb.getContentKey: Cannot get the key from the database");
@@ -119,16 +139,12 @@ Sqlite3ProducerDb::addContentKey(MillisecondsSince1970 timeSlot, const Blob& key
 {
   int fixedTimeSlot = getFixedTimeSlot(timeSlot);
 
-  sqlite3_stmt *statement;
-  sqlite3_prepare_v2
-    (database_, "INSERT INTO contentkeys (timeslot, key) values (?, ?)",
-     -1, &statement, 0);
-  sqlite3_bind_int(statement, 1, fixedTimeSlot);
-  sqlite3_bind_blob(statement, 2, key, SQLITE_TRANSIENT);
+  Sqlite3Statement statement
+    (*statementCache_, "INSERT INTO contentkeys (timeslot, key) values (?, ?)");
+  statement.bind(1, fixedTimeSlot);
+  statement.bind(2, key);
 
-  int status = sqlite3_step(statement);
-  sqlite3_finalize(statement);
-  if (status != SQLITE_DONE)
+  if (statement.step() != SQLITE_DONE)
     throw ProducerDb::Error("Cannot add the key to the database");
 }
 
@@ -136,12 +152,10 @@ void
 Sqlite3ProducerDb::deleteContentKey(MillisecondsSince1970 timeSlot)
 {
   int fixedTimeSlot = getFixedTimeSlot(timeSlot);
-  sqlite3_stmt *statement;
-  sqlite3_prepare_v2
-    (database_, "DELETE FROM contentkeys WHERE timeslot=?", -1, &statement, 0);
-  sqlite3_bind_int(statement, 1, fixedTimeSlot);
-  sqlite3_step(statement);
-  sqlite3_finalize(statement);
+  Sqlite3Statement statement
+    (*statementCache_, "DELETE FROM contentkeys WHERE timeslot=?");
+  statement.bind(1, fixedTimeSlot);
+  statement.step();
 }
 
 }
@@ -100,6 +100,31 @@ Face::setInterestLoopbackEnabled(bool interestLoopbackEnabled)
   node_->setInterestLoopbackEnabled(interestLoopbackEnabled);
 }
 
+void
+Face::setInterestAggregationEnabled(bool interestAggregationEnabled)
+{
+  node_->setInterestAggregationEnabled(interestAggregationEnabled);
+}
+
+void
+Face::setMetricsEnabled(bool metricsEnabled)
+{
+  node_->setMetricsEnabled(metricsEnabled);
+}
+
+ptr_lib::shared_ptr<FaceMetrics>
+Face::getMetrics()
+{
+  return node_->getMetrics();
+}
+
+void
+Face::setMetricsDump
+  (Milliseconds intervalMilliseconds, const OnFaceMetrics& onMetrics)
+{
+  node_->setMetricsDump(intervalMilliseconds, onMetrics, this);
+}
+
 uint64_t
 Face::expressInterest
   (const Interest& interest, const OnData& onData, const OnTimeout& onTimeout,
@@ -50,6 +50,13 @@ public:
   void
   callTimedOut();
 
+  /**
+   * Get the number of callbacks waiting in the delayed call table.
+   * @return The number of entries.
+   */
+  size_t
+  size() const { return table_.size(); }
+
   /**
    * Set the offset when insert() and refresh() get the current time, which
    * should only be used for testing.
@@ -142,6 +142,13 @@ public:
   void
   unsetInterestFilter(uint64_t interestFilterId);
 
+  /**
+   * Get the number of entries in the interest filter table.
+   * @return The number of entries.
+   */
+  size_t
+  size() const { return table_.size(); }
+
 private:
   std::vector<ptr_lib::shared_ptr<Entry> > table_;
 };
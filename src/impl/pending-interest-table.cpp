@@ -96,7 +96,7 @@ PendingInterestTable::extractEntriesForNackInterest
 
     // wireEncode returns the encoding cached when the interest was sent (if
     // it was the default wire encoding).
-    if (pendingInterest->getInterest()->wireEncode().equals(encoding)) {
+    if (pendingInterest->getSentInterest()->wireEncode().equals(encoding)) {
       entries.push_back(pendingInterest);
       // We let the callback from callLater call _processInterestTimeout, but
       // for efficiency, mark this as removed so that it returns right away.
@@ -106,6 +106,49 @@ PendingInterestTable::extractEntriesForNackInterest
   }
 }
 
+Milliseconds
+PendingInterestTable::getLifetimeMilliseconds(const Interest& interest)
+{
+  Milliseconds lifetimeMilliseconds = interest.getInterestLifetimeMilliseconds();
+  return lifetimeMilliseconds >= 0.0 ? lifetimeMilliseconds : 4000.0;
+}
+
+ptr_lib::shared_ptr<PendingInterestTable::Entry>
+PendingInterestTable::findAggregationEntry
+  (const Interest& interest, MillisecondsSince1970 nowMilliseconds)
+{
+  // Make the copy for comparing encodings only when a name matches.
+  ptr_lib::shared_ptr<Interest> interestCopy;
+
+  for (size_t i = 0; i < table_.size(); ++i) {
+    ptr_lib::shared_ptr<Entry>& pendingInterest = table_[i];
+    if (pendingInterest->getSentExpirationTime() <= nowMilliseconds)
+      // This includes entries where setSentInterest was not called.
+      continue;
+    const Interest& sentInterest = *pendingInterest->getSentInterest();
+    if (!sentInterest.getName().equals(interest.getName()))
+      continue;
+    // The new Interest must not outlive the forwarder's PIT entry for the
+    // sent Interest, or it would wait with nothing on the wire.
+    if (nowMilliseconds + getLifetimeMilliseconds(interest) >
+        pendingInterest->getSentExpirationTime() +
+          AGGREGATION_TOLERANCE_MILLISECONDS)
+      continue;
+
+    // Compare the encoding with the same lifetime and nonce as sentInterest.
+    if (!interestCopy)
+      interestCopy.reset(new Interest(interest));
+    // Set the lifetime first since changing it clears the nonce.
+    interestCopy->setInterestLifetimeMilliseconds
+      (sentInterest.getInterestLifetimeMilliseconds());
+    interestCopy->setNonce(sentInterest.getNonce());
+    if (interestCopy->wireEncode().equals(sentInterest.wireEncode()))
+      return pendingInterest;
+  }
+
+  return ptr_lib::shared_ptr<Entry>();
+}
+
 void
 PendingInterestTable::removePendingInterest(uint64_t pendingInterestId)
 {
@@ -47,7 +47,8 @@ public:
        const ptr_lib::shared_ptr<const Interest>& interest, const OnData& onData,
        const OnTimeout& onTimeout, const OnNetworkNack& onNetworkNack)
     : pendingInterestId_(pendingInterestId), interest_(interest), onData_(onData),
-      onTimeout_(onTimeout), onNetworkNack_(onNetworkNack), isRemoved_(false)
+      onTimeout_(onTimeout), onNetworkNack_(onNetworkNack), isRemoved_(false),
+      sentInterest_(interest), sentExpirationTime_(-1.0), expressTime_(-1.0)
     {
     }
 
@@ -80,6 +81,61 @@ public:
     const OnNetworkNack&
     getOnNetworkNack() { return onNetworkNack_; }
 
+    /**
+     * Get the Interest which was sent for this entry. This is the same as
+     * getInterest() unless the entry was aggregated with an outstanding
+     * Interest, in which case this is the outstanding Interest.
+     * @return The sent Interest.
+     */
+    const ptr_lib::shared_ptr<const Interest>&
+    getSentInterest() { return sentInterest_; }
+
+    /**
+     * Get the time when the forwarder's PIT entry for getSentInterest() expires,
+     * as given to setSentInterest.
+     * @return The expiration time in milliseconds since 1/1/1970, or -1 if
+     * setSentInterest was not called, in which case another Interest can't be
+     * aggregated with this entry.
+     */
+    MillisecondsSince1970
+    getSentExpirationTime() { return sentExpirationTime_; }
+
+    /**
+     * Set the Interest which was sent for this entry, so that another Interest
+     * can be aggregated with it.
+     * @param sentInterest The Interest which was sent. This is the entry's own
+     * Interest, or the outstanding Interest it was aggregated with.
+     * @param sentExpirationTime The time when the forwarder's PIT entry for
+     * sentInterest expires, in milliseconds since 1/1/1970.
+     */
+    void
+    setSentInterest
+      (const ptr_lib::shared_ptr<const Interest>& sentInterest,
+       MillisecondsSince1970 sentExpirationTime)
+    {
+      sentInterest_ = sentInterest;
+      sentExpirationTime_ = sentExpirationTime;
+    }
+
+    /**
+     * Get the time when the Interest was expressed, as given to
+     * setExpressTime.
+     * @return The time in milliseconds since 1/1/1970, or -1 if not set.
+     */
+    MillisecondsSince1970
+    getExpressTime() { return expressTime_; }
+
+    /**
+     * Set the time when the Interest was expressed, which is used to measure
+     * the round trip time.
+     * @param expressTime The time in milliseconds since 1/1/1970.
+     */
+    void
+    setExpressTime(MillisecondsSince1970 expressTime)
+    {
+      expressTime_ = expressTime;
+    }
+
     /**
      * Set the isRemoved flag which is returned by getIsRemoved().
      */
@@ -107,6 +163,9 @@ public:
     const OnTimeout onTimeout_;
     const OnNetworkNack onNetworkNack_;
     bool isRemoved_;
+    ptr_lib::shared_ptr<const Interest> sentInterest_;
+    MillisecondsSince1970 sentExpirationTime_;
+    MillisecondsSince1970 expressTime_;
   };
 
   /**
@@ -145,13 +204,15 @@ public:
 
   /**
    * Find all entries from the pending interest table where the OnNetworkNack
-   * callback is not an empty OnNetworkNack() and the entry's interest is the
-   * same as the given interest, remove the entries from the table, set each
+   * callback is not an empty OnNetworkNack() and the entry's sent interest is
+   * the same as the given interest, remove the entries from the table, set each
    * entry's isRemoved flag, and add to the entries list. (We don't remove the
    * entry if the OnNetworkNack callback is an empty OnNetworkNack() so that
    * OnTimeout will be called later.) The interests are the same if their
    * default wire encoding is the same (which has everything including the name,
-   * nonce, link object and selectors).
+   * nonce, link object and selectors). Because an aggregated entry's sent
+   * interest is the outstanding interest, this also returns the entries which
+   * were aggregated with it.
    * @param interest The Interest to search for (typically from a Nack packet).
    * @param entries Add matching PendingInterestTable::Entry from the pending
    * interest table.  The caller should pass in a reference to an empty vector.
@@ -160,6 +221,30 @@ public:
   extractEntriesForNackInterest
     (const Interest& interest, std::vector<ptr_lib::shared_ptr<Entry> > &entries);
 
+  /**
+   * Get the Interest lifetime, or the forwarder's default 4000 milliseconds if
+   * it is not specified.
+   * @param interest The Interest.
+   * @return The lifetime in milliseconds.
+   */
+  static Milliseconds
+  getLifetimeMilliseconds(const Interest& interest);
+
+  /**
+   * Find an entry whose sent Interest can be shared by a new Interest, so that
+   * the new Interest does not need to be sent. The sent Interest must be the
+   * same as the new Interest except for the nonce and lifetime, and the new
+   * Interest must not expire after the forwarder's PIT entry for the sent
+   * Interest, allowing AGGREGATION_TOLERANCE_MILLISECONDS so that the same
+   * Interest expressed again right away is aggregated.
+   * @param interest The new Interest.
+   * @param nowMilliseconds The current time in milliseconds since 1/1/1970.
+   * @return The entry to aggregate with, or null if none.
+   */
+  ptr_lib::shared_ptr<Entry>
+  findAggregationEntry
+    (const Interest& interest, MillisecondsSince1970 nowMilliseconds);
+
   /**
    * Remove the pending interest entry with the pendingInterestId from the
    * pending interest table and set its isRemoved flag. This does not affect
@@ -180,6 +265,17 @@ public:
   bool
   removeEntry(const ptr_lib::shared_ptr<Entry>& pendingInterest);
 
+  /**
+   * Get the number of entries in the pending interest table.
+   * @return The number of entries.
+   */
+  size_t
+  size() const { return table_.size(); }
+
+  // How long a new Interest may outlive the forwarder's PIT entry for the
+  // sent Interest and still be aggregated with it.
+  static const int AGGREGATION_TOLERANCE_MILLISECONDS = 100;
+
 private:
   std::vector<ptr_lib::shared_ptr<Entry> > table_;
   std::vector<uint64_t> removeRequests_;
@@ -26,15 +26,33 @@ using namespace std;
 
 namespace ndn {
 
+void
+InMemoryStorageRetaining::insert(const Data& data)
+{
+  const Name& fullName = *data.getFullName();
+  cache_[fullName] = ptr_lib::make_shared<Data>(data);
+
+  if (evictionPolicy_) {
+    // getFullName has already encoded the data, so wireEncode returns the
+    // cached encoding.
+    evictionPolicy_->insert(fullName, data.wireEncode().size());
+    evictWhileOverBudget();
+  }
+}
+
 ptr_lib::shared_ptr<Data>
 InMemoryStorageRetaining::find(const Name& name)
 {
-  for (map<Name, ptr_lib::shared_ptr<Data> >::iterator i = cache_.begin();
-       i != cache_.end(); ++i) {
-    if (name.isPrefixOf(i->first))
-      return i->second;
+  // The Name keys are in order, so the first match is at the lower bound.
+  map<Name, ptr_lib::shared_ptr<Data> >::iterator i = cache_.lower_bound(name);
+  if (i != cache_.end() && name.isPrefixOf(i->first)) {
+    if (evictionPolicy_)
+      evictionPolicy_->access(i->first);
+    return i->second;
   }
 
+  if (evictionPolicy_)
+    evictionPolicy_->miss();
   return ptr_lib::shared_ptr<Data>();
 }
 
@@ -42,9 +60,34 @@ void
 InMemoryStorageRetaining::remove(const Name& prefix)
 {
   // The Name keys are in order.
-  map<Name, ptr_lib::shared_ptr<Data> >::const_iterator it = cache_.lower_bound(prefix);
-  while (it != cache_.end() && prefix.isPrefixOf(it->first))
+  map<Name, ptr_lib::shared_ptr<Data> >::iterator it = cache_.lower_bound(prefix);
+  while (it != cache_.end() && prefix.isPrefixOf(it->first)) {
+    if (evictionPolicy_)
+      evictionPolicy_->erase(it->first);
     cache_.erase(it++);
+  }
+}
+
+void
+InMemoryStorageRetaining::setEvictionPolicy
+  (const ptr_lib::shared_ptr<CacheEvictionPolicy>& evictionPolicy)
+{
+  evictionPolicy_ = evictionPolicy;
+  if (!evictionPolicy_)
+    return;
+
+  for (map<Name, ptr_lib::shared_ptr<Data> >::iterator i = cache_.begin();
+       i != cache_.end(); ++i)
+    evictionPolicy_->insert(i->first, i->second->wireEncode().size());
+  evictWhileOverBudget();
+}
+
+void
+InMemoryStorageRetaining::evictWhileOverBudget()
+{
+  Name name;
+  while (evictionPolicy_->isOverBudget() && evictionPolicy_->evict(name))
+    cache_.erase(name);
 }
 
 }
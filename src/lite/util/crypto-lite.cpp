@@ -50,6 +50,14 @@ CryptoLite::digestSha256(const uint8_t *data, size_t dataLength, uint8_t *digest
   ndn_digestSha256(data, dataLength, digest);
 }
 
+void
+CryptoLite::digestSha256Multi
+  (const uint8_t* const* data, const size_t* dataLength, size_t nBuffers,
+   uint8_t *digests)
+{
+  ndn_digestSha256Multi(data, dataLength, nBuffers, digests);
+}
+
 ndn_Error
 CryptoLite::generateRandomBytes(uint8_t *buffer, size_t bufferLength)
 {
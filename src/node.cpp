@@ -38,11 +38,36 @@ using namespace ndn::func_lib;
 
 namespace ndn {
 
+/**
+ * A CallbackTimer records the time from its creation to its destruction as the
+ * callback time in the metrics. If the metrics are null, it does nothing.
+ */
+class CallbackTimer {
+public:
+  CallbackTimer(const ptr_lib::shared_ptr<FaceMetrics>& metrics)
+  : metrics_(metrics), startTime_(metrics ? ndn_getNowMilliseconds() : 0)
+  {
+  }
+
+  ~CallbackTimer()
+  {
+    if (metrics_)
+      metrics_->recordCallbackTime(ndn_getNowMilliseconds() - startTime_);
+  }
+
+private:
+  // Keep a copy in case the callback disables metrics.
+  ptr_lib::shared_ptr<FaceMetrics> metrics_;
+  MillisecondsSince1970 startTime_;
+};
+
 Node::Node(const ptr_lib::shared_ptr<Transport>& transport, const ptr_lib::shared_ptr<const Transport::ConnectionInfo>& connectionInfo)
 : transport_(transport), connectionInfo_(connectionInfo),
   timeoutPrefix_(Name("/local/timeout")),
   lastEntryId_(0), connectStatus_(ConnectStatus_UNCONNECTED),
-  interestLoopbackEnabled_(false), registeredPrefixTable_(interestFilterTable_),
+  interestLoopbackEnabled_(false), interestAggregationEnabled_(false),
+  metricsDumpInterval_(0), metricsDumpGeneration_(0),
+  registeredPrefixTable_(interestFilterTable_),
   nonceTemplate_((const uint8_t*)"\0\0\0\0", 4)
 {
 }
@@ -183,6 +208,8 @@ Node::send(const uint8_t *encoding, size_t encodingLength)
       ("The encoded packet size exceeds the maximum limit getMaxNdnPacketSize()");
 
   transport_->send(encoding, encodingLength);
+  if (metrics_)
+    metrics_->packetSent(encodingLength);
 }
 
 uint64_t
@@ -201,6 +228,7 @@ Node::dispatchInterest(const ptr_lib::shared_ptr<const Interest>& interest)
 
   for (size_t i = 0; i < matchedFilters.size(); ++i) {
     InterestFilterTable::Entry &entry = *matchedFilters[i];
+    CallbackTimer timer(metrics_);
     try {
       entry.getOnInterest()
         (entry.getPrefix(), interest, entry.getFace(),
@@ -218,7 +246,16 @@ Node::satisfyPendingInterests(const ptr_lib::shared_ptr<Data>& data)
 {
   vector<ptr_lib::shared_ptr<PendingInterestTable::Entry> > pitEntries;
   pendingInterestTable_.extractEntriesForExpressedInterest(*data, pitEntries);
+  if (metrics_) {
+    MillisecondsSince1970 nowMilliseconds = ndn_getNowMilliseconds();
+    for (size_t i = 0; i < pitEntries.size(); ++i) {
+      if (pitEntries[i]->getExpressTime() >= 0)
+        metrics_->recordRtt(nowMilliseconds - pitEntries[i]->getExpressTime());
+    }
+  }
+
   for (size_t i = 0; i < pitEntries.size(); ++i) {
+    CallbackTimer timer(metrics_);
     try {
       pitEntries[i]->getOnData()(pitEntries[i]->getInterest(), data);
     } catch (const std::exception& ex) {
@@ -241,6 +278,7 @@ Node::satisfyPendingInterests(const Data& data)
     hasMatch = true;
     if (!dataCopy)
       dataCopy = ptr_lib::make_shared<Data>(data);
+    CallbackTimer timer(metrics_);
     try {
       pitEntries[i]->getOnData()(pitEntries[i]->getInterest(), dataCopy);
     } catch (const std::exception& ex) {
@@ -411,6 +449,9 @@ Node::processEvents()
 void
 Node::onReceivedElement(const uint8_t *element, size_t elementLength)
 {
+  if (metrics_)
+    metrics_->packetReceived(elementLength);
+
   ptr_lib::shared_ptr<LpPacket> lpPacket;
   if (element[0] == ndn_Tlv_LpPacket_LpPacket) {
     // Decode the LpPacket and replace element with the fragment.
@@ -462,10 +503,13 @@ Node::onReceivedElement(const uint8_t *element, size_t elementLength)
       if (!interest)
         // We got a Nack but not for an Interest, so drop the packet.
         return;
+      if (metrics_)
+        metrics_->networkNackReceived(networkNack->getReason());
 
       vector<ptr_lib::shared_ptr<PendingInterestTable::Entry> > pitEntries;
       pendingInterestTable_.extractEntriesForNackInterest(*interest, pitEntries);
       for (size_t i = 0; i < pitEntries.size(); ++i) {
+        CallbackTimer timer(metrics_);
         try {
           pitEntries[i]->getOnNetworkNack()
             (pitEntries[i]->getInterest(), networkNack);
@@ -484,8 +528,11 @@ Node::onReceivedElement(const uint8_t *element, size_t elementLength)
   // Now process as Interest or Data.
   if (interest)
     dispatchInterest(interest);
-  else if (data)
+  else if (data) {
+    if (metrics_)
+      metrics_->dataReceived();
     satisfyPendingInterests(data);
+  }
 }
 
 void
@@ -501,12 +548,37 @@ Node::expressInterestHelper
    const OnData& onData, const OnTimeout& onTimeout,
    const OnNetworkNack& onNetworkNack, WireFormat* wireFormat, Face* face)
 {
+  // Special case: For timeoutPrefix_ we don't actually send the interest.
+  bool isTimeoutPrefix = timeoutPrefix_.match(interestCopy->getName());
+
+  ptr_lib::shared_ptr<PendingInterestTable::Entry> aggregationEntry;
+  MillisecondsSince1970 sentExpirationTime = -1.0;
+  if (interestAggregationEnabled_ && !isTimeoutPrefix) {
+    MillisecondsSince1970 nowMilliseconds = ndn_getNowMilliseconds();
+    sentExpirationTime = nowMilliseconds +
+      PendingInterestTable::getLifetimeMilliseconds(*interestCopy);
+
+    aggregationEntry = pendingInterestTable_.findAggregationEntry
+      (*interestCopy, nowMilliseconds);
+  }
+
   ptr_lib::shared_ptr<PendingInterestTable::Entry> pendingInterest =
     pendingInterestTable_.add
       (pendingInterestId, interestCopy, onData, onTimeout, onNetworkNack);
   if (!pendingInterest)
     // removePendingInterest was already called with the pendingInterestId.
     return;
+  if (metrics_)
+    pendingInterest->setExpressTime(ndn_getNowMilliseconds());
+
+  if (aggregationEntry)
+    // A matching Data or Nack for the sent Interest will also satisfy this
+    // entry.
+    pendingInterest->setSentInterest
+      (aggregationEntry->getSentInterest(),
+       aggregationEntry->getSentExpirationTime());
+  else if (interestAggregationEnabled_ && !isTimeoutPrefix)
+    pendingInterest->setSentInterest(interestCopy, sentExpirationTime);
 
   if (onTimeout || interestCopy->getInterestLifetimeMilliseconds() >= 0.0) {
     // Set up the timeout.
@@ -520,13 +592,14 @@ Node::expressInterestHelper
        bind(&Node::processInterestTimeout, this, pendingInterest));
   }
 
-  // Special case: For timeoutPrefix_ we don't actually send the interest.
-  if (!timeoutPrefix_.match(interestCopy->getName())) {
+  if (!isTimeoutPrefix && !aggregationEntry) {
     Blob encoding = interestCopy->wireEncode(*wireFormat);
     if (encoding.size() > getMaxNdnPacketSize())
       throw runtime_error
         ("The encoded interest size exceeds the maximum limit getMaxNdnPacketSize()");
     transport_->send(*encoding);
+    if (metrics_)
+      metrics_->interestSent(encoding.size());
 
     if (interestLoopbackEnabled_)
         dispatchInterest(interestCopy);
@@ -537,8 +610,83 @@ void
 Node::processInterestTimeout
   (ptr_lib::shared_ptr<PendingInterestTable::Entry> pendingInterest)
 {
-  if (pendingInterestTable_.removeEntry(pendingInterest))
+  if (pendingInterestTable_.removeEntry(pendingInterest)) {
+    if (metrics_)
+      metrics_->interestTimedOut();
+    CallbackTimer timer(metrics_);
     pendingInterest->callTimeout();
+  }
+}
+
+void
+Node::setMetricsEnabled(bool metricsEnabled)
+{
+  if (metricsEnabled) {
+    if (!metrics_)
+      metrics_.reset(new FaceMetrics());
+  }
+  else
+    metrics_.reset();
+}
+
+ptr_lib::shared_ptr<FaceMetrics>
+Node::getMetrics()
+{
+  if (!metrics_)
+    return ptr_lib::shared_ptr<FaceMetrics>();
+
+  ptr_lib::shared_ptr<FaceMetrics> snapshot(new FaceMetrics(*metrics_));
+  snapshot->setTableSizes
+    (pendingInterestTable_.size(), interestFilterTable_.size(),
+     delayedCallTable_.size());
+  return snapshot;
+}
+
+void
+Node::setMetricsDump
+  (Milliseconds intervalMilliseconds, const OnFaceMetrics& onMetrics,
+   Face* face)
+{
+  // Incrementing the generation stops a previously scheduled dump.
+  ++metricsDumpGeneration_;
+  metricsDumpInterval_ = intervalMilliseconds;
+  onMetricsDump_ = onMetrics;
+  if (intervalMilliseconds <= 0)
+    return;
+
+  setMetricsEnabled(true);
+  face->callLater
+    (intervalMilliseconds,
+     bind(&Node::dumpMetrics, this, metricsDumpGeneration_, face));
+}
+
+void
+Node::dumpMetrics(uint64_t generation, Face* face)
+{
+  if (generation != metricsDumpGeneration_)
+    // setMetricsDump was called again.
+    return;
+
+  ptr_lib::shared_ptr<FaceMetrics> metrics = getMetrics();
+  if (metrics) {
+    if (onMetricsDump_) {
+      try {
+        onMetricsDump_(*metrics);
+      } catch (const std::exception& ex) {
+        _LOG_ERROR("Node::dumpMetrics: Error in onMetrics: " << ex.what());
+      } catch (...) {
+        _LOG_ERROR("Node::dumpMetrics: Error in onMetrics.");
+      }
+    }
+    else
+      _LOG_INFO("Face metrics: " << metrics->toString());
+  }
+
+  // Check the generation again in case onMetrics called setMetricsDump.
+  if (generation == metricsDumpGeneration_)
+    face->callLater
+      (metricsDumpInterval_,
+       bind(&Node::dumpMetrics, this, generation, face));
 }
 
 class EncodeLpContext {
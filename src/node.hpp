@@ -32,6 +32,7 @@
 #include <ndn-cpp/data.hpp>
 #include <ndn-cpp/interest-filter.hpp>
 #include <ndn-cpp/face.hpp>
+#include <ndn-cpp/util/face-metrics.hpp>
 #include "util/command-interest-generator.hpp"
 #include "impl/delayed-call-table.hpp"
 #include "impl/interest-filter-table.hpp"
@@ -65,6 +66,48 @@ public:
     interestLoopbackEnabled_ = interestLoopbackEnabled;
   }
 
+  /**
+   * Enable or disable Interest aggregation.
+   * @param interestAggregationEnabled If True, enable Interest aggregation,
+   * otherwise disable it.
+   */
+  void
+  setInterestAggregationEnabled(bool interestAggregationEnabled)
+  {
+    interestAggregationEnabled_ = interestAggregationEnabled;
+  }
+
+  /**
+   * Enable or disable collecting metrics. When disabled, the only overhead is
+   * checking a null pointer.
+   * @param metricsEnabled If true and metrics are not already enabled, start
+   * collecting with all counts zero. If false, stop collecting and discard the
+   * metrics.
+   */
+  void
+  setMetricsEnabled(bool metricsEnabled);
+
+  /**
+   * Get a snapshot of the metrics, including the current table sizes.
+   * @return A new copy of the metrics, or null if metrics are not enabled.
+   */
+  ptr_lib::shared_ptr<FaceMetrics>
+  getMetrics();
+
+  /**
+   * Periodically call onMetrics with a snapshot of the metrics. This enables
+   * metrics if needed.
+   * @param intervalMilliseconds The interval between calls. If this is not
+   * positive, stop the periodic dump.
+   * @param onMetrics This calls onMetrics(metrics). If this is an empty
+   * OnFaceMetrics(), log the metrics at the INFO level instead.
+   * @param face The face which has the callLater method.
+   */
+  void
+  setMetricsDump
+    (Milliseconds intervalMilliseconds, const OnFaceMetrics& onMetrics,
+     Face* face);
+
   /**
    * Send the Interest through the transport, read the entire response and call
    * onData, onTimeout or onNetworkNack as described below.
@@ -426,7 +469,11 @@ private:
   /**
    * Do the work of expressInterest once we know we are connected. Add the
    * entry to the PIT, encode and send the interest. If Interest loopback is
-   * enabled, then also call dispatchInterest.
+   * enabled, then also call dispatchInterest. If Interest aggregation is
+   * enabled and PendingInterestTable::findAggregationEntry finds an
+   * outstanding Interest which is the same except for the nonce and lifetime
+   * and which the new Interest does not outlive (within
+   * AGGREGATION_TOLERANCE_MILLISECONDS), then aggregate with it and don't send.
    * @param pendingInterestId The getNextEntryId() for the pending interest ID
    * which Face got so it could return it to the caller.
    * @param interestCopy The Interest to send, which has already been copied and put
@@ -524,6 +571,16 @@ private:
   bool
   satisfyPendingInterests(const Data& data);
 
+  /**
+   * This is used in callLater for the periodic metrics dump. If generation is
+   * still metricsDumpGeneration_, call onMetricsDump_ and schedule the next
+   * call.
+   * @param generation The metricsDumpGeneration_ when this was scheduled.
+   * @param face The face which has the callLater method.
+   */
+  void
+  dumpMetrics(uint64_t generation, Face* face);
+
   // Disable the copy constructor and assignment operator.
   Node(const Node& other);
   Node& operator=(const Node& other);
@@ -539,6 +596,12 @@ private:
   Name timeoutPrefix_;
   ConnectStatus connectStatus_;
   bool interestLoopbackEnabled_;
+  bool interestAggregationEnabled_;
+  // metrics_ is null if metrics are not enabled.
+  ptr_lib::shared_ptr<FaceMetrics> metrics_;
+  Milliseconds metricsDumpInterval_;
+  OnFaceMetrics onMetricsDump_;
+  uint64_t metricsDumpGeneration_;
   Blob nonceTemplate_;
 #if NDN_CPP_HAVE_BOOST_ATOMIC
   // ThreadsafeFace accesses lastEntryId_ outside of a thread safe dispatch, so
@@ -215,6 +215,10 @@ PibSqlite3::PibSqlite3
     throw PibImpl::Error
       ("PIB database cannot be opened/created: " + databaseFilePath);
 
+  statementCache_.reset(new Sqlite3StatementCache(database_));
+  // Use write-ahead logging so that each change needs fewer disk syncs.
+  statementCache_->enableWriteAheadLog(Sqlite3Synchronous::NORMAL);
+
   // Enable foreign keys.
   sqlite3_exec(database_, "PRAGMA foreign_keys=ON", NULL, NULL, NULL);
 
@@ -230,23 +234,53 @@ PibSqlite3::PibSqlite3
 
 PibSqlite3::~PibSqlite3()
 {
+  // Finalize the cached statements before closing.
+  statementCache_.reset();
   sqlite3_close(database_);
 }
 
 string
 PibSqlite3::getScheme() { return NDN_PIB_SQLITE3_SCHEME; }
 
+void
+PibSqlite3::setSynchronous(Sqlite3Synchronous::Level level)
+{
+  if (statementCache_->setSynchronous(level) != SQLITE_OK)
+    throw PibImpl::Error("PibSqlite3: Cannot set the synchronous level");
+}
+
+void
+PibSqlite3::beginTransaction()
+{
+  if (statementCache_->beginTransaction() != SQLITE_OK)
+    throw PibImpl::Error("PibSqlite3: Cannot begin a transaction");
+}
+
+void
+PibSqlite3::commitTransaction()
+{
+  if (statementCache_->commitTransaction() != SQLITE_OK)
+    throw PibImpl::Error("PibSqlite3: Cannot commit the transaction");
+}
+
+void
+PibSqlite3::rollbackTransaction()
+{
+  if (statementCache_->rollbackTransaction() != SQLITE_OK)
+    throw PibImpl::Error("PibSqlite3: Cannot roll back the transaction");
+}
+
 void
 PibSqlite3::setTpmLocator(const string& tpmLocator)
 {
-  Sqlite3Statement statement(database_, "UPDATE tpmInfo SET tpm_locator=?");
+  Sqlite3Statement statement(*statementCache_, "UPDATE tpmInfo SET tpm_locator=?");
   statement.bind(1, tpmLocator);
   statement.step();
 
   if (sqlite3_changes(database_) == 0) {
     // No row was updated, so tpmLocator does not exist. Insert it directly.
     Sqlite3Statement insertStatement
-      (database_, "INSERT INTO tpmInfo (tpm_locator) values (?)");
+      (*statementCache_, "INSERT INTO tpmInfo (tpm_locator) values (?)");
     insertStatement.bind(1, tpmLocator);
     insertStatement.step();
   }
@@ -255,7 +289,7 @@ PibSqlite3::setTpmLocator(const string& tpmLocator)
 string
 PibSqlite3::getTpmLocator() const
 {
-  Sqlite3Statement statement(database_, "SELECT tpm_locator FROM tpmInfo");
+  Sqlite3Statement statement(*statementCache_, "SELECT tpm_locator FROM tpmInfo");
   int res = statement.step();
   if (res == SQLITE_ROW)
     return statement.getString(0);
@@ -267,7 +301,7 @@ bool
 PibSqlite3::hasIdentity(const Name& identityName) const
 {
   Sqlite3Statement statement
-    (database_, "SELECT id FROM identities WHERE identity=?");
+    (*statementCache_, "SELECT id FROM identities WHERE identity=?");
   statement.bind(1, identityName.wireEncode());
   return (statement.step() == SQLITE_ROW);
 }
@@ -277,7 +311,7 @@ PibSqlite3::addIdentity(const Name& identityName)
 {
   if (!hasIdentity(identityName)) {
     Sqlite3Statement statement
-      (database_, "INSERT INTO identities (identity) values (?)");
+      (*statementCache_, "INSERT INTO identities (identity) values (?)");
     statement.bind(1, identityName.wireEncode());
     statement.step();
   }
@@ -289,7 +323,7 @@ PibSqlite3::addIdentity(const Name& identityName)
 void
 PibSqlite3::removeIdentity(const Name& identityName)
 {
-  Sqlite3Statement statement(database_, "DELETE FROM identities WHERE identity=?");
+  Sqlite3Statement statement(*statementCache_, "DELETE FROM identities WHERE identity=?");
   statement.bind(1, identityName.wireEncode());
   statement.step();
 }
@@ -297,7 +331,7 @@ PibSqlite3::removeIdentity(const Name& identityName)
 void
 PibSqlite3::clearIdentities()
 {
-  Sqlite3Statement statement(database_, "DELETE FROM identities");
+  Sqlite3Statement statement(*statementCache_, "DELETE FROM identities");
   statement.step();
 }
 
@@ -305,7 +339,7 @@ set<Name>
 PibSqlite3::getIdentities() const
 {
   set<Name> identities;
-  Sqlite3Statement statement(database_, "SELECT identity FROM identities");
+  Sqlite3Statement statement(*statementCache_, "SELECT identity FROM identities");
 
   while (statement.step() == SQLITE_ROW) {
     Name name;
@@ -321,13 +355,13 @@ PibSqlite3::setDefaultIdentity(const Name& identityName)
 {
   if (!hasIdentity(identityName)) {
     Sqlite3Statement statement
-      (database_, "INSERT INTO identities (identity) values (?)");
+      (*statementCache_, "INSERT INTO identities (identity) values (?)");
     statement.bind(1, identityName.wireEncode());
     statement.step();
   }
 
   Sqlite3Statement statement
-    (database_, "UPDATE identities SET is_default=1 WHERE identity=?");
+    (*statementCache_, "UPDATE identities SET is_default=1 WHERE identity=?");
   statement.bind(1, identityName.wireEncode());
   statement.step();
 }
@@ -336,7 +370,7 @@ Name
 PibSqlite3::getDefaultIdentity() const
 {
   Sqlite3Statement statement
-    (database_, "SELECT identity FROM identities WHERE is_default=1");
+    (*statementCache_, "SELECT identity FROM identities WHERE is_default=1");
 
   if (statement.step() == SQLITE_ROW) {
     Name name;
@@ -350,7 +384,7 @@ PibSqlite3::getDefaultIdentity() const
 bool
 PibSqlite3::hasKey(const Name& keyName) const
 {
-  Sqlite3Statement statement(database_, "SELECT id FROM keys WHERE key_name=?");
+  Sqlite3Statement statement(*statementCache_, "SELECT id FROM keys WHERE key_name=?");
   statement.bind(1, keyName.wireEncode());
 
   return (statement.step() == SQLITE_ROW);
@@ -365,7 +399,7 @@ PibSqlite3::addKey
   addIdentity(identityName);
 
   if (!hasKey(keyName)) {
-    Sqlite3Statement statement(database_,
+    Sqlite3Statement statement(*statementCache_,
 "INSERT INTO keys (identity_id, key_name, key_bits) \
 VALUES ((SELECT id FROM identities WHERE identity=?), ?, ?)");
     statement.bind(1, identityName.wireEncode());
@@ -375,7 +409,7 @@ VALUES ((SELECT id FROM identities WHERE identity=?), ?, ?)");
   }
   else {
     Sqlite3Statement statement
-      (database_, "UPDATE keys SET key_bits=? WHERE key_name=?");
+      (*statementCache_, "UPDATE keys SET key_bits=? WHERE key_name=?");
     statement.bind(1, key, keyLength, SQLITE_STATIC);
     statement.bind(2, keyName.wireEncode());
     statement.step();
@@ -388,7 +422,7 @@ VALUES ((SELECT id FROM identities WHERE identity=?), ?, ?)");
 void
 PibSqlite3::removeKey(const Name& keyName)
 {
-  Sqlite3Statement statement(database_, "DELETE FROM keys WHERE key_name=?");
+  Sqlite3Statement statement(*statementCache_, "DELETE FROM keys WHERE key_name=?");
   statement.bind(1, keyName.wireEncode());
   statement.step();
 }
@@ -397,7 +431,7 @@ Blob
 PibSqlite3::getKeyBits(const Name& keyName) const
 {
   Sqlite3Statement statement
-    (database_, "SELECT key_bits FROM keys WHERE key_name=?");
+    (*statementCache_, "SELECT key_bits FROM keys WHERE key_name=?");
   statement.bind(1, keyName.wireEncode());
 
   if (statement.step() == SQLITE_ROW)
@@ -411,7 +445,7 @@ PibSqlite3::getKeysOfIdentity(const Name& identityName) const
 {
   set<Name> keyNames;
 
-  Sqlite3Statement statement(database_,
+  Sqlite3Statement statement(*statementCache_,
 "SELECT key_name \
 FROM keys JOIN identities ON keys.identity_id=identities.id \
 WHERE identities.identity=?");
@@ -434,7 +468,7 @@ PibSqlite3::setDefaultKeyOfIdentity
     throw Pib::Error("Key `" + keyName.toUri() + "` does not exist");
 
   Sqlite3Statement statement
-    (database_, "UPDATE keys SET is_default=1 WHERE key_name=?");
+    (*statementCache_, "UPDATE keys SET is_default=1 WHERE key_name=?");
   statement.bind(1, keyName.wireEncode());
   statement.step();
 }
@@ -445,7 +479,7 @@ PibSqlite3::getDefaultKeyOfIdentity(const Name& identityName) const
   if (!hasIdentity(identityName))
     throw Pib::Error("Identity `" + identityName.toUri() + "` does not exist");
 
-  Sqlite3Statement statement(database_,
+  Sqlite3Statement statement(*statementCache_,
 "SELECT key_name \
 FROM keys JOIN identities ON keys.identity_id=identities.id \
 WHERE identities.identity=? AND keys.is_default=1");
@@ -464,7 +498,7 @@ bool
 PibSqlite3::hasCertificate(const Name& certificateName) const
 {
   Sqlite3Statement statement
-    (database_, "SELECT id FROM certificates WHERE certificate_name=?");
+    (*statementCache_, "SELECT id FROM certificates WHERE certificate_name=?");
   statement.bind(1, certificateName.wireEncode());
   return (statement.step() == SQLITE_ROW);
 }
@@ -479,7 +513,7 @@ PibSqlite3::addCertificate(const CertificateV2& certificate)
      content.buf(), content.size());
 
   if (!hasCertificate(certificate.getName())) {
-    Sqlite3Statement statement(database_,
+    Sqlite3Statement statement(*statementCache_,
 "INSERT INTO certificates \
 (key_id, certificate_name, certificate_data) \
 VALUES ((SELECT id FROM keys WHERE key_name=?), ?, ?)");
@@ -491,7 +525,7 @@ VALUES ((SELECT id FROM keys WHERE key_name=?), ?, ?)");
   }
   else {
     Sqlite3Statement statement
-      (database_,
+      (*statementCache_,
        "UPDATE certificates SET certificate_data=? WHERE certificate_name=?");
     statement.bind(1, certificate.wireEncode(), true);
     statement.bind(2, certificate.getName().wireEncode());
@@ -506,7 +540,7 @@ void
 PibSqlite3::removeCertificate(const Name& certificateName)
 {
   Sqlite3Statement statement
-    (database_, "DELETE FROM certificates WHERE certificate_name=?");
+    (*statementCache_, "DELETE FROM certificates WHERE certificate_name=?");
   statement.bind(1, certificateName.wireEncode());
   statement.step();
 }
@@ -515,7 +549,7 @@ ptr_lib::shared_ptr<CertificateV2>
 PibSqlite3::getCertificate(const Name& certificateName) const
 {
   Sqlite3Statement statement
-    (database_,
+    (*statementCache_,
      "SELECT certificate_data FROM certificates WHERE certificate_name=?");
   statement.bind(1, certificateName.wireEncode());
 
@@ -533,7 +567,7 @@ PibSqlite3::getCertificatesOfKey(const Name& keyName) const
 {
   set<Name> certNames;
 
-  Sqlite3Statement statement(database_,
+  Sqlite3Statement statement(*statementCache_,
 "SELECT certificate_name \
 FROM certificates JOIN keys ON certificates.key_id=keys.id \
 WHERE keys.key_name=?");
@@ -556,7 +590,7 @@ PibSqlite3::setDefaultCertificateOfKey
     throw Pib::Error("Certificate `" + certificateName.toUri() + "` does not exist");
 
   Sqlite3Statement statement
-    (database_, "UPDATE certificates SET is_default=1 WHERE certificate_name=?");
+    (*statementCache_, "UPDATE certificates SET is_default=1 WHERE certificate_name=?");
   statement.bind(1, certificateName.wireEncode());
   statement.step();
 }
@@ -564,7 +598,7 @@ PibSqlite3::setDefaultCertificateOfKey
 ptr_lib::shared_ptr<CertificateV2>
 PibSqlite3::getDefaultCertificateOfKey(const Name& keyName) const
 {
-  Sqlite3Statement statement(database_,
+  Sqlite3Statement statement(*statementCache_,
 "SELECT certificate_data \
 FROM certificates JOIN keys ON certificates.key_id=keys.id \
 WHERE certificates.is_default=1 AND keys.key_name=?");
@@ -601,14 +635,14 @@ bool
 PibSqlite3::hasDefaultIdentity() const
 {
   Sqlite3Statement statement
-    (database_, "SELECT identity FROM identities WHERE is_default=1");
+    (*statementCache_, "SELECT identity FROM identities WHERE is_default=1");
   return (statement.step() == SQLITE_ROW);
 }
 
 bool
 PibSqlite3::hasDefaultKeyOfIdentity(const Name& identityName) const
 {
-  Sqlite3Statement statement(database_,
+  Sqlite3Statement statement(*statementCache_,
 "SELECT key_name \
 FROM keys JOIN identities ON keys.identity_id=identities.id \
 WHERE identities.identity=? AND keys.is_default=1");
@@ -621,7 +655,7 @@ WHERE identities.identity=? AND keys.is_default=1");
 bool
 PibSqlite3::hasDefaultCertificateOfKey(const Name& keyName) const
 {
-  Sqlite3Statement statement(database_,
+  Sqlite3Statement statement(*statementCache_,
 "SELECT certificate_data \
 FROM certificates JOIN keys ON certificates.key_id=keys.id \
 WHERE certificates.is_default=1 AND keys.key_name=?");
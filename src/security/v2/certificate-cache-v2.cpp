@@ -30,8 +30,10 @@ INIT_LOGGER("ndn.CertificateCacheV2");
 
 namespace ndn {
 
-CertificateCacheV2::CertificateCacheV2(Milliseconds maxLifetimeMilliseconds)
+CertificateCacheV2::CertificateCacheV2
+  (Milliseconds maxLifetimeMilliseconds, size_t capacity)
 : maxLifetimeMilliseconds_(maxLifetimeMilliseconds),
+  capacity_(capacity),
   nextRefreshTime_(DBL_MAX),
   nowOffsetMilliseconds_(0)
 {
@@ -60,8 +62,33 @@ CertificateCacheV2::insert(const CertificateV2& certificate)
   _LOG_DEBUG("Adding " << certificate.getName().toUri() << ", will remove in "
     << removalHours << " hours");
   ptr_lib::shared_ptr<CertificateV2> certificateCopy(new CertificateV2(certificate));
-  certificatesByName_[certificateCopy->getName()] =
-    Entry(certificateCopy, removalTime);
+  const Name& certificateName = certificateCopy->getName();
+  map<Name, Entry>::iterator found = certificatesByName_.find(certificateName);
+  if (found != certificatesByName_.end()) {
+    // Replace the existing certificate. Its entry in removalTimeHeap_ becomes
+    // stale unless the removal time is the same.
+    found->second.certificate_ = certificateCopy;
+    found->second.removalTime_ = removalTime;
+    touch(found->second);
+  }
+  else {
+    Entry& entry = certificatesByName_[certificateName];
+    entry = Entry(certificateCopy, removalTime);
+    entry.leastRecentlyUsedPosition_ = leastRecentlyUsed_.insert
+      (leastRecentlyUsed_.end(), certificateName);
+  }
+
+  removalTimeHeap_.push_back(RemovalTimeHeapEntry(removalTime, certificateName));
+  push_heap(removalTimeHeap_.begin(), removalTimeHeap_.end());
+  if (removalTimeHeap_.size() > 2 * certificatesByName_.size() + 16)
+    // There are too many stale entries.
+    rebuildRemovalTimeHeap();
+
+  while (certificatesByName_.size() > capacity_) {
+    _LOG_DEBUG("Removing least recently used " <<
+      leastRecentlyUsed_.front().toUri() << ": the cache is full");
+    erase(certificatesByName_.find(leastRecentlyUsed_.front()));
+  }
 }
 
 ptr_lib::shared_ptr<CertificateV2>
@@ -78,6 +105,8 @@ CertificateCacheV2::find(const Name& certificatePrefix) const
   if (itr == certificatesByName_.end() ||
       !certificatePrefix.isPrefixOf(itr->second.certificate_->getName()))
     return ptr_lib::shared_ptr<CertificateV2>();
+
+  touch(itr->second);
   return itr->second.certificate_;
 }
 
@@ -91,6 +120,16 @@ CertificateCacheV2::find(const Interest& interest) const
       interest.getName()[-1].isImplicitSha256Digest())
     _LOG_DEBUG("Certificate search using a name with an implicit digest is not yet supported");
 
+  if (interest.getMinSuffixComponents() < 0 &&
+      interest.getMaxSuffixComponents() < 0 &&
+      interest.getExclude().size() == 0 &&
+      interest.getKeyLocator().getType() < 0 &&
+      !(interest.getName().size() > 0 &&
+        interest.getName()[-1].isImplicitSha256Digest()))
+    // With no selectors, Interest::matchesData only checks that the Interest
+    // name is a prefix of the certificate name, so do a prefix lookup.
+    return find(interest.getName());
+
   const_cast<CertificateCacheV2*>(this)->refresh();
 
   for (map<Name, Entry>::const_iterator i =
@@ -98,8 +137,10 @@ CertificateCacheV2::find(const Interest& interest) const
        i != certificatesByName_.end() &&
          interest.getName().isPrefixOf(i->second.certificate_->getName());
        ++i) {
-    if (interest.matchesData(*i->second.certificate_))
+    if (interest.matchesData(*i->second.certificate_)) {
+      touch(i->second);
       return i->second.certificate_;
+    }
   }
 
   return ptr_lib::shared_ptr<CertificateV2>();
@@ -108,7 +149,9 @@ CertificateCacheV2::find(const Interest& interest) const
 void
 CertificateCacheV2::deleteCertificate(const Name& certificateName)
 {
-  certificatesByName_.erase(certificateName);
+  map<Name, Entry>::iterator found = certificatesByName_.find(certificateName);
+  if (found != certificatesByName_.end())
+    erase(found);
   // This may be the certificate to be removed at nextRefreshTime_ by refresh(),
   // but just allow refresh() to run instead of update nextRefreshTime_ now.
 }
@@ -121,22 +164,37 @@ CertificateCacheV2::refresh()
   if (now < nextRefreshTime_)
     return;
 
-  // We recompute nextRefreshTime_.
-  MillisecondsSince1970 nextRefreshTime = DBL_MAX;
-  // Keep a separate list of entries to erase since we can't erase while iterating.
-  vector<Name> namesToErase;
-  for (map<Name, Entry>::const_iterator i = certificatesByName_.begin();
-       i != certificatesByName_.end(); ++i) {
-    if (i->second.removalTime_ <= now)
-      namesToErase.push_back(i->first);
-    else
-      nextRefreshTime = min(nextRefreshTime, i->second.removalTime_);
+  // Pop the earliest removal times from the heap instead of checking every
+  // certificate.
+  while (removalTimeHeap_.size() > 0 &&
+         removalTimeHeap_.front().removalTime_ <= now) {
+    pop_heap(removalTimeHeap_.begin(), removalTimeHeap_.end());
+    const RemovalTimeHeapEntry& heapEntry = removalTimeHeap_.back();
+
+    map<Name, Entry>::iterator found =
+      certificatesByName_.find(heapEntry.certificateName_);
+    // Skip a stale heap entry.
+    if (found != certificatesByName_.end() &&
+        found->second.removalTime_ == heapEntry.removalTime_)
+      erase(found);
+
+    removalTimeHeap_.pop_back();
   }
 
-  nextRefreshTime_ = nextRefreshTime;
-  // Now actually erase.
-  for (int i = 0; i < namesToErase.size(); ++i)
-    certificatesByName_.erase(namesToErase[i]);
+  // We recompute nextRefreshTime_.
+  nextRefreshTime_ = (removalTimeHeap_.size() > 0 ?
+    removalTimeHeap_.front().removalTime_ : DBL_MAX);
+}
+
+void
+CertificateCacheV2::rebuildRemovalTimeHeap()
+{
+  removalTimeHeap_.clear();
+  for (map<Name, Entry>::const_iterator i = certificatesByName_.begin();
+       i != certificatesByName_.end(); ++i)
+    removalTimeHeap_.push_back
+      (RemovalTimeHeapEntry(i->second.removalTime_, i->first));
+  make_heap(removalTimeHeap_.begin(), removalTimeHeap_.end());
 }
 
 }
@@ -21,6 +21,7 @@
  */
 
 #include <stdexcept>
+#include <algorithm>
 #include <ndn-cpp/util/logging.hpp>
 #include <ndn-cpp/security/v2/certificate-fetcher-from-network.hpp>
 
@@ -36,77 +37,200 @@ CertificateFetcherFromNetwork::Impl::doFetch
   (const ptr_lib::shared_ptr<CertificateRequest>& certificateRequest,
    const ptr_lib::shared_ptr<ValidationState>& state,
    const ValidationContinuation& continueValidation)
+{
+  const Name& certificateName = certificateRequest->interest_.getName();
+
+  map<Name, MillisecondsSince1970>::iterator failed =
+    negativeCache_.find(certificateName);
+  if (failed != negativeCache_.end()) {
+    // nowOffsetMilliseconds_ is only used for testing.
+    MillisecondsSince1970 now =
+      ndn_getNowMilliseconds() + nowOffsetMilliseconds_;
+    if (now < failed->second) {
+      _LOG_TRACE("Not fetching certificate " << certificateName.toUri() <<
+        " which recently failed");
+      state->fail(ValidationError(ValidationError::CANNOT_RETRIEVE_CERTIFICATE,
+        "Cannot fetch certificate `" + certificateName.toUri() +
+        "` which recently failed"));
+      return;
+    }
+
+    negativeCache_.erase(failed);
+  }
+
+  map<Name, ptr_lib::shared_ptr<PendingFetch> >::iterator pending =
+    pendingFetches_.find(certificateName);
+  if (pending != pendingFetches_.end()) {
+    _LOG_TRACE("Waiting for the pending fetch of certificate " <<
+      certificateName.toUri());
+    pending->second->waiters_.push_back
+      (Waiter(certificateRequest, state, continueValidation));
+    return;
+  }
+
+  ptr_lib::shared_ptr<PendingFetch> pendingFetch
+    (new PendingFetch(certificateRequest));
+  pendingFetch->waiters_.push_back
+    (Waiter(certificateRequest, state, continueValidation));
+  pendingFetches_[certificateName] = pendingFetch;
+  expressInterest(pendingFetch);
+}
+
+void
+CertificateFetcherFromNetwork::Impl::expressInterest
+  (const ptr_lib::shared_ptr<PendingFetch>& pendingFetch)
 {
   face_.expressInterest
-    (certificateRequest->interest_,
+    (pendingFetch->certificateRequest_->interest_,
      bind(&CertificateFetcherFromNetwork::Impl::onData, shared_from_this(),
-          _1, _2, state, continueValidation),
+          _1, _2, pendingFetch),
      bind(&CertificateFetcherFromNetwork::Impl::onTimeout, shared_from_this(),
-          _1, certificateRequest, state, continueValidation),
+          _1, pendingFetch),
      bind(&CertificateFetcherFromNetwork::Impl::onNetworkNack, shared_from_this(),
-          _1, _2, certificateRequest, state, continueValidation));
+          _1, _2, pendingFetch));
+}
+
+void
+CertificateFetcherFromNetwork::Impl::removePendingFetch
+  (const ptr_lib::shared_ptr<PendingFetch>& pendingFetch,
+   vector<Waiter>& waiters)
+{
+  map<Name, ptr_lib::shared_ptr<PendingFetch> >::iterator pending =
+    pendingFetches_.find(pendingFetch->certificateRequest_->interest_.getName());
+  if (pending != pendingFetches_.end() && pending->second == pendingFetch)
+    pendingFetches_.erase(pending);
+
+  // Take the waiters now since a continuation may call doFetch for the same
+  // name, which makes a new PendingFetch.
+  waiters.swap(pendingFetch->waiters_);
 }
 
 void
 CertificateFetcherFromNetwork::Impl::onData
   (const ptr_lib::shared_ptr<const Interest>& interest,
    const ptr_lib::shared_ptr<Data>& data,
-   const ptr_lib::shared_ptr<ValidationState>& state,
-   const CertificateFetcher::ValidationContinuation& continueValidation)
+   const ptr_lib::shared_ptr<PendingFetch>& pendingFetch)
 {
   _LOG_TRACE("Fetched certificate from network " << data->getName().toUri());
 
+  vector<Waiter> waiters;
+  removePendingFetch(pendingFetch, waiters);
+
   ptr_lib::shared_ptr<CertificateV2> certificate;
   try {
     certificate.reset(new CertificateV2(*data));
   } catch (const std::exception& ex) {
-    state->fail(ValidationError(ValidationError::MALFORMED_CERTIFICATE,
-      "Fetched a malformed certificate `" + data->getName().toUri() +
-      "` (" + ex.what() + ")"));
+    for (size_t i = 0; i < waiters.size(); ++i)
+      waiters[i].state_->fail(ValidationError
+        (ValidationError::MALFORMED_CERTIFICATE,
+         "Fetched a malformed certificate `" + data->getName().toUri() +
+         "` (" + ex.what() + ")"));
     return;
   }
 
-  continueValidation(certificate, state);
+  for (size_t i = 0; i < waiters.size(); ++i)
+    waiters[i].continueValidation_(certificate, waiters[i].state_);
 }
 
 void
 CertificateFetcherFromNetwork::Impl::onNetworkNack
   (const ptr_lib::shared_ptr<const Interest>& interest,
    const ptr_lib::shared_ptr<NetworkNack>& networkNack,
-   const ptr_lib::shared_ptr<CertificateRequest>& certificateRequest,
-   const ptr_lib::shared_ptr<ValidationState>& state,
-   const CertificateFetcher::ValidationContinuation& continueValidation)
+   const ptr_lib::shared_ptr<PendingFetch>& pendingFetch)
 {
   _LOG_TRACE("NACK (" << networkNack->getReason() <<
     ") while fetching certificate " <<
-    certificateRequest->interest_.getName().toUri());
-
-  --certificateRequest->nRetriesLeft_;
-  if (certificateRequest->nRetriesLeft_ >= 0)
-    parent_.fetch(certificateRequest, state, continueValidation);
-  else
-    state->fail(ValidationError(ValidationError::CANNOT_RETRIEVE_CERTIFICATE,
-      "Cannot fetch certificate after all retries `" +
-      certificateRequest->interest_.getName().toUri() + "`"));
+    pendingFetch->certificateRequest_->interest_.getName().toUri());
+
+  onFailure(pendingFetch);
 }
 
 void
 CertificateFetcherFromNetwork::Impl::onTimeout
   (const ptr_lib::shared_ptr<const Interest>& interest,
-   const ptr_lib::shared_ptr<CertificateRequest>& certificateRequest,
-   const ptr_lib::shared_ptr<ValidationState>& state,
-   const CertificateFetcher::ValidationContinuation& continueValidation)
+   const ptr_lib::shared_ptr<PendingFetch>& pendingFetch)
 {
   _LOG_TRACE("Timeout while fetching certificate " <<
-    certificateRequest->interest_.getName().toUri() << ", retrying");
-
-  --certificateRequest->nRetriesLeft_;
-  if (certificateRequest->nRetriesLeft_ >= 0)
-    parent_.fetch(certificateRequest, state, continueValidation);
-  else
-    state->fail(ValidationError(ValidationError::CANNOT_RETRIEVE_CERTIFICATE,
-      "Cannot fetch certificate after all retries `" +
-      certificateRequest->interest_.getName().toUri() + "`"));
+    pendingFetch->certificateRequest_->interest_.getName().toUri() <<
+    ", retrying");
+
+  onFailure(pendingFetch);
+}
+
+void
+CertificateFetcherFromNetwork::Impl::onFailure
+  (const ptr_lib::shared_ptr<PendingFetch>& pendingFetch)
+{
+  const Name& certificateName =
+    pendingFetch->certificateRequest_->interest_.getName();
+
+  // Each waiter uses one of its own retries.
+  vector<Waiter> failedWaiters;
+  vector<Waiter>& waiters = pendingFetch->waiters_;
+  for (size_t i = 0; i < waiters.size(); ) {
+    --waiters[i].certificateRequest_->nRetriesLeft_;
+    if (waiters[i].certificateRequest_->nRetriesLeft_ < 0) {
+      failedWaiters.push_back(waiters[i]);
+      waiters.erase(waiters.begin() + i);
+    }
+    else
+      ++i;
+  }
+
+  if (waiters.size() > 0) {
+    // Check the cache as in CertificateFetcher::fetch, in case the
+    // certificate arrived another way.
+    ptr_lib::shared_ptr<CertificateV2> certificate =
+      parent_.certificateStorage_->getUnverifiedCertificateCache().find
+        (pendingFetch->certificateRequest_->interest_);
+    if (certificate) {
+      _LOG_TRACE("Found certificate in **un**verified key cache " <<
+                 certificate->getName());
+      vector<Waiter> foundWaiters;
+      removePendingFetch(pendingFetch, foundWaiters);
+      for (size_t i = 0; i < foundWaiters.size(); ++i)
+        foundWaiters[i].continueValidation_
+          (certificate, foundWaiters[i].state_);
+    }
+    else
+      // Keep the remaining waiters and re-express the Interest.
+      expressInterest(pendingFetch);
+  }
+  else {
+    vector<Waiter> noWaiters;
+    removePendingFetch(pendingFetch, noWaiters);
+
+    if (negativeCacheLifetime_ > 0) {
+      // nowOffsetMilliseconds_ is only used for testing.
+      MillisecondsSince1970 now =
+        ndn_getNowMilliseconds() + nowOffsetMilliseconds_;
+      if (negativeCache_.size() >= nextNegativeCachePruneSize_)
+        pruneNegativeCache(now);
+      negativeCache_[certificateName] = now + negativeCacheLifetime_;
+    }
+  }
+
+  for (size_t i = 0; i < failedWaiters.size(); ++i)
+    failedWaiters[i].state_->fail(ValidationError
+      (ValidationError::CANNOT_RETRIEVE_CERTIFICATE,
+       "Cannot fetch certificate after all retries `" +
+       certificateName.toUri() + "`"));
+}
+
+void
+CertificateFetcherFromNetwork::Impl::pruneNegativeCache
+  (MillisecondsSince1970 now)
+{
+  for (map<Name, MillisecondsSince1970>::iterator i = negativeCache_.begin();
+       i != negativeCache_.end(); ) {
+    if (i->second <= now)
+      negativeCache_.erase(i++);
+    else
+      ++i;
+  }
+
+  // Wait until the cache doubles so that pruning is amortized.
+  nextNegativeCachePruneSize_ = max((size_t)16, 2 * negativeCache_.size());
 }
 
 }
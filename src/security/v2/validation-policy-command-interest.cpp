@@ -22,6 +22,7 @@
 
 #include <ndn-cpp/security/command-interest-signer.hpp>
 #include <ndn-cpp/security/v2/validation-policy-command-interest.hpp>
+#include "../../util/hash-index.hpp"
 
 using namespace std;
 using namespace ndn::func_lib;
@@ -32,6 +33,7 @@ ValidationPolicyCommandInterest::ValidationPolicyCommandInterest
   (const ptr_lib::shared_ptr<ValidationPolicy>& innerPolicy, const Options& options)
 // This copies the options.
 : options_(options),
+  index_(new HashIndex<RecordList::iterator>()),
   nowOffsetMilliseconds_(0)
 {
   if (!innerPolicy)
@@ -74,9 +76,12 @@ ValidationPolicyCommandInterest::cleanUp()
   MillisecondsSince1970 now = ndn_getNowMilliseconds() + nowOffsetMilliseconds_;
   MillisecondsSince1970 expiring = now - options_.recordLifetime_;
 
-  while ((container_.size() > 0 && container_[0]->lastRefreshed_ <= expiring) ||
-         (options_.maxRecords_ >= 0 && container_.size() > options_.maxRecords_))
-    container_.erase(container_.begin());
+  while ((container_.size() > 0 &&
+          container_.front().lastRefreshed_ <= expiring) ||
+         (options_.maxRecords_ >= 0 && container_.size() > options_.maxRecords_)) {
+    index_->erase(container_.front().keyName_.hash(), container_.begin());
+    container_.pop_front();
+  }
 }
 
 bool
@@ -121,9 +126,9 @@ ValidationPolicyCommandInterest::checkTimestamp
     return false;
   }
 
-  int index = findByKeyName(keyName);
-  if (index >= 0) {
-    if (timestamp <= container_[index]->timestamp_) {
+  RecordList::iterator record = findByKeyName(keyName);
+  if (record != container_.end()) {
+    if (timestamp <= record->timestamp_) {
       state->fail(ValidationError(ValidationError::POLICY_ERROR,
         "Timestamp is reordered for key " + keyName.toUri()));
       return false;
@@ -146,26 +151,32 @@ ValidationPolicyCommandInterest::insertNewRecord
 {
   // nowOffsetMilliseconds_ is only used for testing.
   MillisecondsSince1970 now = ndn_getNowMilliseconds() + nowOffsetMilliseconds_;
-  ptr_lib::shared_ptr<LastTimestampRecord> newRecord
-    (new LastTimestampRecord(keyName, timestamp, now));
-
-  int index = findByKeyName(keyName);
-  if (index >= 0)
-    // Remove the existing record so we can move it to the end.
-    container_.erase(container_.begin() + index);
 
-  container_.push_back(newRecord);
+  RecordList::iterator record = findByKeyName(keyName);
+  if (record != container_.end()) {
+    // Refresh the existing record and move it to the end. This keeps the
+    // iterator in index_ valid.
+    record->timestamp_ = timestamp;
+    record->lastRefreshed_ = now;
+    container_.splice(container_.end(), container_, record);
+  }
+  else {
+    container_.push_back(LastTimestampRecord(keyName, timestamp, now));
+    index_->insert(keyName.hash(), --container_.end());
+  }
 }
 
-int
+ValidationPolicyCommandInterest::RecordList::iterator
 ValidationPolicyCommandInterest::findByKeyName(const Name& keyName)
 {
-  for (int i = 0; i < container_.size(); ++i) {
-    if (container_[i]->keyName_.equals(keyName))
-      return i;
+  size_t hash = keyName.hash();
+  const HashIndex<RecordList::iterator>::Bucket& bucket = index_->getBucket(hash);
+  for (size_t i = 0; i < bucket.size(); ++i) {
+    if (bucket[i].hash_ == hash && bucket[i].value_->keyName_.equals(keyName))
+      return bucket[i].value_;
   }
 
-  return -1;
+  return container_.end();
 }
 
 }
@@ -63,6 +63,8 @@ ValidationPolicyConfig::load
     shouldBypass_ = false;
     dataRules_.clear();
     interestRules_.clear();
+    dataRuleIndex_.reset();
+    interestRuleIndex_.reset();
 
     validator_->resetAnchors();
     validator_->resetVerifiedCertificates();
@@ -84,6 +86,8 @@ ValidationPolicyConfig::load
     else
       dataRules_.push_back(rule);
   }
+  dataRuleIndex_.reset(new ConfigRuleIndex(dataRules_, false));
+  interestRuleIndex_.reset(new ConfigRuleIndex(interestRules_, true));
 
   // Get the trust anchors.
   vector<const BoostInfoTree*> trustAnchorList = validatorSection["trust-anchor"];
@@ -110,20 +114,16 @@ ValidationPolicyConfig::checkPolicy
     // Already called state.fail() .
     return;
 
-  for (size_t i = 0; i < dataRules_.size(); ++i) {
-    ConfigRule& rule = *dataRules_[i];
-
-    if (rule.match(false, data.getName())) {
-      if (rule.check(false, data.getName(), keyLocatorName, state)) {
-        continueValidation
-          (ptr_lib::make_shared<CertificateRequest>(Interest(keyLocatorName)),
-           state);
-        return;
-      }
-      else
-        // rule.check failed and already called state.fail() .
-        return;
-    }
+  // The index gives the same rule as calling rule.match for each rule in order.
+  ConfigRule* rule =
+    (dataRuleIndex_ ? dataRuleIndex_->findFirstMatch(data.getName()) : 0);
+  if (rule) {
+    if (rule->check(false, data.getName(), keyLocatorName, state))
+      continueValidation
+        (ptr_lib::make_shared<CertificateRequest>(Interest(keyLocatorName)),
+         state);
+    // Otherwise rule.check failed and already called state.fail() .
+    return;
   }
 
   state->fail(ValidationError(ValidationError::POLICY_ERROR,
@@ -149,20 +149,17 @@ ValidationPolicyConfig::checkPolicy
     // Already called state.fail() .
     return;
 
-  for (size_t i = 0; i < interestRules_.size(); ++i) {
-    ConfigRule& rule = *interestRules_[i];
-
-    if (rule.match(true, interest.getName())) {
-      if (rule.check(true, interest.getName(), keyLocatorName, state)) {
-        continueValidation
-          (ptr_lib::make_shared<CertificateRequest>(Interest(keyLocatorName)),
-           state);
-        return;
-      }
-      else
-        // rule.check failed and already called state.fail() .
-        return;
-    }
+  // The index gives the same rule as calling rule.match for each rule in order.
+  ConfigRule* rule =
+    (interestRuleIndex_ ? interestRuleIndex_->findFirstMatch(interest.getName())
+     : 0);
+  if (rule) {
+    if (rule->check(true, interest.getName(), keyLocatorName, state))
+      continueValidation
+        (ptr_lib::make_shared<CertificateRequest>(Interest(keyLocatorName)),
+         state);
+    // Otherwise rule.check failed and already called state.fail() .
+    return;
   }
 
   state->fail(ValidationError(ValidationError::POLICY_ERROR,
@@ -26,6 +26,7 @@
 
 #include "../../../util/boost-info-parser.hpp"
 #include "../../../util/regex/ndn-regex-top-matcher.hpp"
+#include "../../../util/regex/ndn-regex-automaton.hpp"
 #include <ndn-cpp/security/pib/pib-key.hpp>
 #include <ndn-cpp/security/validator-config-error.hpp>
 #include <ndn-cpp/security/v2/validator-config/config-checker.hpp>
@@ -206,6 +207,11 @@ ConfigNameRelationChecker::checkNames
 ConfigRegexChecker::ConfigRegexChecker(const string& regexString)
 : regex_(new NdnRegexTopMatcher(regexString))
 {
+  try {
+    automaton_.reset(new NdnRegexAutomaton(regexString));
+  } catch (const std::exception& ex) {
+    // The regex is too large for the automaton, so use regex_ .
+  }
 }
 
 bool
@@ -213,7 +219,8 @@ ConfigRegexChecker::checkNames
   (const Name& packetName, const Name& keyLocatorName,
    const ptr_lib::shared_ptr<ValidationState>& state)
 {
-  bool result = regex_->match(keyLocatorName);
+  bool result = (automaton_ ? automaton_->match(keyLocatorName)
+                 : regex_->match(keyLocatorName));
   if (!result)
     state->fail(ValidationError(ValidationError::POLICY_ERROR,
       "KeyLocator check failed: regex " + regex_->getExpr() + " for packet " +
@@ -28,6 +28,7 @@
 #include <ndn-cpp/security/v2/validator-config/config-name-relation.hpp>
 #include "../../../util/boost-info-parser.hpp"
 #include "../../../util/regex/ndn-regex-top-matcher.hpp"
+#include "../../../util/regex/ndn-regex-automaton.hpp"
 #include <ndn-cpp/security/v2/validator-config/config-filter.hpp>
 
 using namespace std;
@@ -106,12 +107,38 @@ ConfigRelationNameFilter::matchName(const Name& packetName)
 ConfigRegexNameFilter::ConfigRegexNameFilter(const string& regexString)
 : regex_(new NdnRegexTopMatcher(regexString))
 {
+  try {
+    automaton_.reset(new NdnRegexAutomaton(regexString));
+  } catch (const std::exception& ex) {
+    // The regex is too large for the automaton, so use regex_ .
+  }
+}
+
+Name
+ConfigRegexNameFilter::getLiteralPrefix() const
+{
+  if (automaton_)
+    return automaton_->getLiteralPrefix();
+  else
+    return Name();
+}
+
+Name
+ConfigRegexNameFilter::getRequiredComponents() const
+{
+  if (automaton_)
+    return automaton_->getRequiredComponents();
+  else
+    return Name();
 }
 
 bool
 ConfigRegexNameFilter::matchName(const Name& packetName)
 {
-  return regex_->match(packetName);
+  if (automaton_)
+    return automaton_->match(packetName);
+  else
+    return regex_->match(packetName);
 }
 
 }
@@ -0,0 +1,237 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Regents of the University of California.
+ * @author: Jeff Thompson <jefft0@remap.ucla.edu>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+#include "../../../util/regex/ndn-regex-matcher-base.hpp"
+// Only compile if we set NDN_CPP_HAVE_REGEX_LIB in ndn-regex-matcher-base.hpp.
+#if NDN_CPP_HAVE_REGEX_LIB
+
+#include <algorithm>
+#include <ndn-cpp/security/validator-config-error.hpp>
+#include <ndn-cpp/security/v2/validator-config/config-rule-index.hpp>
+
+using namespace std;
+
+namespace ndn {
+
+ConfigRuleIndex::ConfigRuleIndex
+  (const vector<ptr_lib::shared_ptr<ConfigRule>>& rules, bool isForInterest)
+: rules_(rules), isForInterest_(isForInterest)
+{
+  // Create the root.
+  nodes_.push_back(Node());
+
+  // Regex filters with no literal prefix but with required components. Add
+  // these after counting how many filters require each component.
+  vector<Entry> requiredComponentFilters;
+  map<Name::Component, size_t> requiredComponentCount;
+
+  for (size_t i = 0; i < rules_.size(); ++i) {
+    ConfigRule& rule = *rules_[i];
+    if (rule.getIsForInterest() != isForInterest_)
+      throw ValidatorConfigError
+        ("ConfigRuleIndex: The rule " + rule.getId() +
+         " is not for the same packet type as the index");
+
+    const vector<ptr_lib::shared_ptr<ConfigFilter>>& filters = rule.getFilters();
+    if (filters.size() == 0) {
+      nodes_[0].entries_.push_back(Entry(i, ENTRY_ALWAYS, 0));
+      continue;
+    }
+
+    for (size_t j = 0; j < filters.size(); ++j) {
+      ConfigFilter* filter = filters[j].get();
+
+      ConfigRelationNameFilter* relationFilter =
+        dynamic_cast<ConfigRelationNameFilter*>(filter);
+      if (relationFilter) {
+        EntryType type;
+        if (relationFilter->getRelation() == ConfigNameRelation::EQUAL)
+          type = ENTRY_EQUAL;
+        else if (relationFilter->getRelation() ==
+                 ConfigNameRelation::IS_PREFIX_OF)
+          type = ENTRY_IS_PREFIX_OF;
+        else
+          type = ENTRY_IS_STRICT_PREFIX_OF;
+
+        size_t iNode = getNode(relationFilter->getName());
+        nodes_[iNode].entries_.push_back(Entry(i, type, filter));
+        continue;
+      }
+
+      ConfigRegexNameFilter* regexFilter =
+        dynamic_cast<ConfigRegexNameFilter*>(filter);
+      if (regexFilter) {
+        Name literalPrefix = regexFilter->getLiteralPrefix();
+        Name requiredComponents = regexFilter->getRequiredComponents();
+        if (literalPrefix.size() == 0 && requiredComponents.size() > 0) {
+          requiredComponentFilters.push_back(Entry(i, ENTRY_CANDIDATE, filter));
+          for (size_t k = 0; k < requiredComponents.size(); ++k)
+            ++requiredComponentCount[requiredComponents.get(k)];
+        }
+        else {
+          size_t iNode = getNode(literalPrefix);
+          nodes_[iNode].entries_.push_back(Entry(i, ENTRY_CANDIDATE, filter));
+        }
+        continue;
+      }
+
+      // An unknown filter type must always be checked.
+      nodes_[0].entries_.push_back(Entry(i, ENTRY_CANDIDATE, filter));
+    }
+  }
+
+  // Store each filter by the required component which the fewest other
+  // filters require, so that it is evaluated for fewer packet names.
+  for (size_t i = 0; i < requiredComponentFilters.size(); ++i) {
+    const Entry& entry = requiredComponentFilters[i];
+    Name requiredComponents =
+      dynamic_cast<ConfigRegexNameFilter*>(entry.filter_)
+      ->getRequiredComponents();
+
+    size_t iBest = 0;
+    for (size_t j = 1; j < requiredComponents.size(); ++j) {
+      if (requiredComponentCount[requiredComponents.get(j)] <
+          requiredComponentCount[requiredComponents.get(iBest)])
+        iBest = j;
+    }
+
+    requiredComponentEntries_[requiredComponents.get(iBest)].push_back(entry);
+  }
+}
+
+ConfigRule*
+ConfigRuleIndex::findFirstMatch(const Name& packetName)
+{
+  const size_t signedInterestMinSize = 2;
+  // An Interest name which is too short can't match any filter. (See
+  // ConfigFilter::match.)
+  bool isTooShort =
+    (isForInterest_ && packetName.size() < signedInterestMinSize);
+  // The filters match the Interest name without the signature components.
+  size_t nameSize = isTooShort ? 0 :
+    (isForInterest_ ? packetName.size() - signedInterestMinSize
+                    : packetName.size());
+
+  size_t bestRuleIndex = rules_.size();
+  candidates_.clear();
+
+  // Walk down the tree along packetName, where each node is for the first
+  // depth components.
+  size_t iNode = 0;
+  for (size_t depth = 0; ; ++depth) {
+    const Node& node = nodes_[iNode];
+
+    for (size_t i = 0; i < node.entries_.size(); ++i) {
+      const Entry& entry = node.entries_[i];
+      if (entry.ruleIndex_ >= bestRuleIndex)
+        // The entries are in order of the rule index.
+        break;
+
+      if (entry.type_ == ENTRY_ALWAYS)
+        bestRuleIndex = entry.ruleIndex_;
+      else if (isTooShort)
+        continue;
+      else if (entry.type_ == ENTRY_IS_PREFIX_OF ||
+               (entry.type_ == ENTRY_EQUAL && depth == nameSize) ||
+               (entry.type_ == ENTRY_IS_STRICT_PREFIX_OF && depth < nameSize))
+        bestRuleIndex = entry.ruleIndex_;
+      else if (entry.type_ == ENTRY_CANDIDATE)
+        candidates_.push_back(&entry);
+    }
+
+    if (isTooShort || depth >= nameSize)
+      break;
+    map<Name::Component, size_t>::const_iterator child =
+      node.children_.find(packetName.get(depth));
+    if (child == node.children_.end())
+      break;
+    iNode = child->second;
+  }
+
+  if (!isTooShort && requiredComponentEntries_.size() > 0) {
+    // Add the candidates for each component in the name.
+    for (size_t i = 0; i < nameSize; ++i) {
+      map<Name::Component, vector<Entry>>::const_iterator entries =
+        requiredComponentEntries_.find(packetName.get(i));
+      if (entries == requiredComponentEntries_.end())
+        continue;
+
+      for (size_t j = 0; j < entries->second.size(); ++j) {
+        const Entry& entry = entries->second[j];
+        if (entry.ruleIndex_ >= bestRuleIndex)
+          break;
+        candidates_.push_back(&entry);
+      }
+    }
+  }
+
+  // Check the candidates which come before the best definite match, in order.
+  sort(candidates_.begin(), candidates_.end(), entryRuleIndexLess);
+  for (size_t i = 0; i < candidates_.size(); ++i) {
+    const Entry& entry = *candidates_[i];
+    if (entry.ruleIndex_ >= bestRuleIndex)
+      break;
+    if (i > 0 && candidates_[i - 1] == &entry)
+      // A required component was repeated in the name.
+      continue;
+
+    if (entry.filter_->match(isForInterest_, packetName))
+      return rules_[entry.ruleIndex_].get();
+  }
+
+  if (bestRuleIndex < rules_.size())
+    return rules_[bestRuleIndex].get();
+  else
+    return 0;
+}
+
+bool
+ConfigRuleIndex::entryRuleIndexLess(const Entry* entry1, const Entry* entry2)
+{
+  if (entry1->ruleIndex_ != entry2->ruleIndex_)
+    return entry1->ruleIndex_ < entry2->ruleIndex_;
+  // Put duplicates together.
+  return less<const Entry*>()(entry1, entry2);
+}
+
+size_t
+ConfigRuleIndex::getNode(const Name& name)
+{
+  size_t iNode = 0;
+  for (size_t i = 0; i < name.size(); ++i) {
+    map<Name::Component, size_t>::iterator child =
+      nodes_[iNode].children_.find(name.get(i));
+    if (child != nodes_[iNode].children_.end())
+      iNode = child->second;
+    else {
+      size_t iChild = nodes_.size();
+      nodes_[iNode].children_[name.get(i)] = iChild;
+      nodes_.push_back(Node());
+      iNode = iChild;
+    }
+  }
+
+  return iNode;
+}
+
+}
+
+#endif // NDN_CPP_HAVE_REGEX_LIB
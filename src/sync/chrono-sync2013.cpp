@@ -29,6 +29,7 @@
 #include "sync-state.pb.h"
 #include "../c/util/time.h"
 #include "digest-tree.hpp"
+#include "digest-log.hpp"
 #include <ndn-cpp/sync/chrono-sync2013.hpp>
 
 INIT_LOGGER("ndn.ChronoSync2013");
@@ -49,8 +50,8 @@ ChronoSync2013::Impl::Impl
   applicationBroadcastPrefix_(applicationBroadcastPrefix), sessionNo_(sessionNo),
   face_(face), keyChain_(keyChain), certificateName_(certificateName),
   syncLifetime_(syncLifetime), initialPreviousSequenceNo_(previousSequenceNumber),
-  sequenceNo_(previousSequenceNumber), digestTree_(new DigestTree()),
-  contentCache_(&face), enabled_(true)
+  sequenceNo_(previousSequenceNumber), digestLog_(new DigestLog()),
+  digestTree_(new DigestTree()), contentCache_(&face), enabled_(true)
 {
 }
 
@@ -58,8 +59,7 @@ void
 ChronoSync2013::Impl::initialize(const OnRegisterFailed& onRegisterFailed)
 {
   Sync::SyncStateMsg emptyContent;
-  digestLog_.push_back(ptr_lib::make_shared<DigestLogEntry>
-    ("00", emptyContent.ss()));
+  digestLog_->add("00", emptyContent.ss());
 
   // Register the prefix with the contentCache_ and use our own onInterest
   //   as the onDataNotFound fallback.
@@ -77,17 +77,6 @@ ChronoSync2013::Impl::initialize(const OnRegisterFailed& onRegisterFailed)
   _LOG_DEBUG(interest.getName().toUri());
 }
 
-int
-ChronoSync2013::Impl::logFind(const std::string& digest) const
-{
-  for (size_t i = 0; i < digestLog_.size(); ++i) {
-    if (digest == digestLog_[i]->getDigest())
-      return i;
-  }
-
-  return -1;
-};
-
 bool
 ChronoSync2013::Impl::update
   (const google::protobuf::RepeatedPtrField<Sync::SyncState >& content)
@@ -104,9 +93,8 @@ ChronoSync2013::Impl::update
     }
   }
 
-  if (logFind(digestTree_->getRoot()) == -1) {
-    digestLog_.push_back(ptr_lib::make_shared<DigestLogEntry>
-      (digestTree_->getRoot(), content));
+  if (digestLog_->find(digestTree_->getRoot()) == -1) {
+    digestLog_->add(digestTree_->getRoot(), content);
     return true;
   }
   else
@@ -129,11 +117,11 @@ ChronoSync2013::Impl::getProducerPrefixes
 int
 ChronoSync2013::Impl::getProducerSequenceNo(const std::string& dataPrefix, int sessionNo) const
 {
-  int index = digestTree_->find(dataPrefix, sessionNo);
-  if (index < 0)
+  const DigestTree::Node* node = digestTree_->find(dataPrefix, sessionNo);
+  if (!node)
     return -1;
   else
-    return digestTree_->get(index).getSequenceNo();
+    return node->getSequenceNo();
 }
 
 void
@@ -169,6 +157,12 @@ ChronoSync2013::Impl::publishNextSequenceNo(const Blob& applicationInfo)
      bind(&ChronoSync2013::Impl::syncTimeout, shared_from_this(), _1));
 }
 
+void
+ChronoSync2013::Impl::setMaxDigestLogSize(size_t maxDigestLogSize)
+{
+  digestLog_->setMaxEntries(maxDigestLogSize);
+}
+
 void
 ChronoSync2013::Impl::onInterest
   (const ptr_lib::shared_ptr<const Name>& prefix,
@@ -199,7 +193,7 @@ ChronoSync2013::Impl::onInterest
     contentCache_.storePendingInterest(interest, face);
 
     if (syncDigest != digestTree_->getRoot()) {
-      size_t index = logFind(syncDigest);
+      int index = digestLog_->find(syncDigest);
       if (index == -1) {
         // To see whether there is any data packet coming back, wait 2 seconds
         // using the Interest timeout mechanism.
@@ -290,34 +284,44 @@ ChronoSync2013::Impl::processRecoveryInterest
   (const Interest& interest, const string& syncDigest, Face& face)
 {
   _LOG_DEBUG("processRecoveryInst");
-  if (logFind(syncDigest) != -1) {
-    Sync::SyncStateMsg tempContent;
-    for (size_t i = 0; i < digestTree_->size(); ++i) {
-      Sync::SyncState* content = tempContent.add_ss();
-      content->set_name(digestTree_->get(i).getDataPrefix());
-      content->set_type(Sync::SyncState_ActionType_UPDATE);
-      content->mutable_seqno()->set_seq(digestTree_->get(i).getSequenceNo());
-      content->mutable_seqno()->set_session(digestTree_->get(i).getSessionNo());
-    }
+  // The initial digest "00" may have been evicted from the digest log, but a
+  // newcomer's interest for it is always answered.
+  if (syncDigest == "00" || digestLog_->find(syncDigest) != -1)
+    // Limit the lifetime of replies to interest for "00" since they can be different.
+    sendFullState
+      (interest.getName(), interest.getName().get(-1).toEscapedString() == "00",
+       face);
+}
 
-    if (tempContent.ss_size() != 0) {
-      ptr_lib::shared_ptr<vector<uint8_t> > array(new vector<uint8_t>(tempContent.ByteSize()));
-      tempContent.SerializeToArray(&array->front(), array->size());
-      Data data(interest.getName());
-      data.setContent(Blob(array, false));
-      if (interest.getName().get(-1).toEscapedString() == "00")
-        // Limit the lifetime of replies to interest for "00" since they can be different.
-        data.getMetaInfo().setFreshnessPeriod(1000);
+void
+ChronoSync2013::Impl::sendFullState
+  (const Name& name, bool isFreshnessLimited, Face& face)
+{
+  Sync::SyncStateMsg tempContent;
+  for (size_t i = 0; i < digestTree_->size(); ++i) {
+    Sync::SyncState* content = tempContent.add_ss();
+    content->set_name(digestTree_->get(i).getDataPrefix());
+    content->set_type(Sync::SyncState_ActionType_UPDATE);
+    content->mutable_seqno()->set_seq(digestTree_->get(i).getSequenceNo());
+    content->mutable_seqno()->set_session(digestTree_->get(i).getSessionNo());
+  }
 
-      keyChain_.sign(data, certificateName_);
-      try {
-        face.putData(data);
-        _LOG_DEBUG("send recovery data back");
-        _LOG_DEBUG(interest.getName().toUri());
-      }
-      catch (std::exception& e) {
-        _LOG_DEBUG(e.what());
-      }
+  if (tempContent.ss_size() != 0) {
+    ptr_lib::shared_ptr<vector<uint8_t> > array(new vector<uint8_t>(tempContent.ByteSize()));
+    tempContent.SerializeToArray(&array->front(), array->size());
+    Data data(name);
+    data.setContent(Blob(array, false));
+    if (isFreshnessLimited)
+      data.getMetaInfo().setFreshnessPeriod(1000);
+
+    keyChain_.sign(data, certificateName_);
+    try {
+      face.putData(data);
+      _LOG_DEBUG("send recovery data back");
+      _LOG_DEBUG(name.toUri());
+    }
+    catch (std::exception& e) {
+      _LOG_DEBUG(e.what());
     }
   }
 }
@@ -329,14 +333,14 @@ ChronoSync2013::Impl::processSyncInterest
   vector<string> nameList;
   vector<int> sequenceNoList;
   vector<int> sessionNoList;
-  for (size_t j = index + 1; j < digestLog_.size(); ++j) {
+  for (size_t j = index + 1; j < digestLog_->size(); ++j) {
     const google::protobuf::RepeatedPtrField<Sync::SyncState>& temp =
-      digestLog_[j]->getData();
+      digestLog_->get(j).getData();
     for (size_t i = 0; i < temp.size(); ++i) {
       if (temp.Get(i).type() != Sync::SyncState_ActionType_UPDATE)
         continue;
 
-      if (digestTree_->find(temp.Get(i).name(), temp.Get(i).seqno().session()) != -1) {
+      if (digestTree_->find(temp.Get(i).name(), temp.Get(i).seqno().session())) {
         int n = -1;
         for (size_t k = 0; k < nameList.size(); ++k) {
           if (nameList[k] == temp.Get(i).name()) {
@@ -412,13 +416,25 @@ ChronoSync2013::Impl::judgeRecovery
     // Ignore callbacks after the application calls shutdown().
     return;
 
-  int index2 = logFind(syncDigest);
+  int index2 = digestLog_->find(syncDigest);
   if (index2 != -1) {
     if (syncDigest != digestTree_->getRoot())
       processSyncInterest(index2, syncDigest, *face);
   }
-  else
+  else {
+    if (digestLog_->getEvictionCount() > 0) {
+      // The digest may be older than the entries in the digest log, so we
+      // can't send only the differences. Send the full state which the
+      // requester can merge. Its freshness is limited because a later reply
+      // for the same digest can be different.
+      Name name(applicationBroadcastPrefix_);
+      name.append(syncDigest);
+      sendFullState(name, true, *face);
+    }
+
+    // The digest may also be newer than our state.
     sendRecovery(syncDigest);
+  }
 }
 
 void
@@ -491,7 +507,7 @@ ChronoSync2013::Impl::initialOndata
 
   broadcastSyncState(digest, tempContent2);
 
-  if (digestTree_->find(applicationDataPrefixUri_, sessionNo_) == -1) {
+  if (!digestTree_->find(applicationDataPrefixUri_, sessionNo_)) {
     // the user hasn't put himself in the digest tree.
     _LOG_DEBUG("initial state");
     ++sequenceNo_;
@@ -572,14 +588,6 @@ ChronoSync2013::Impl::broadcastSyncState
   contentCache_.add(data);
 }
 
-ChronoSync2013::DigestLogEntry::DigestLogEntry
-  (const std::string& digest,
-   const google::protobuf::RepeatedPtrField<Sync::SyncState>& data)
-  : digest_(digest),
-   data_(new google::protobuf::RepeatedPtrField<Sync::SyncState>(data))
-{
-}
-
 void
 ChronoSync2013::Impl::dummyOnData
   (const ptr_lib::shared_ptr<const Interest>& interest,
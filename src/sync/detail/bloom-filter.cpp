@@ -0,0 +1,127 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2019-2020 Regents of the University of California.
+ * @author: Jeff Thompson <jefft0@remap.ucla.edu>
+ * @author: From the PSync library https://github.com/named-data/PSync/blob/master/PSync/detail/bloom-filter.cpp
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+#include <math.h>
+#include <stdexcept>
+#include <ndn-cpp/lite/util/crypto-lite.hpp>
+#include "bloom-filter.hpp"
+
+using namespace std;
+
+namespace ndn {
+
+BloomFilter::BloomFilter
+  (size_t projectedElementCount, double falsePositiveProbability)
+: projectedElementCount_(projectedElementCount),
+  // Round to the resolution of the encoding.
+  falsePositiveProbability_(round(falsePositiveProbability * 1000) / 1000.0)
+{
+  if (falsePositiveProbability_ <= 0 || falsePositiveProbability_ >= 1)
+    throw runtime_error
+      ("BloomFilter: The false positive probability must be from 0.001 to 0.999");
+
+  bitTable_.assign(computeParameters(), 0);
+}
+
+BloomFilter::BloomFilter(const Name& name)
+{
+  if (name.size() < N_NAME_COMPONENTS)
+    throw runtime_error("BloomFilter: The name is too short");
+
+  // The name may come from a remote sync Interest, so check the count before
+  // computing the size of the bit table.
+  uint64_t projectedElementCount = name.get(-3).toNumber();
+  if (projectedElementCount > MAX_PROJECTED_ELEMENT_COUNT)
+    throw runtime_error("BloomFilter: The projected element count is too large");
+  projectedElementCount_ = (size_t)projectedElementCount;
+  falsePositiveProbability_ = name.get(-2).toNumber() / 1000.0;
+  if (falsePositiveProbability_ <= 0 || falsePositiveProbability_ >= 1)
+    throw runtime_error("BloomFilter: Invalid false positive probability");
+
+  // Check the size of the received bit table before allocating.
+  const Blob& bitTable = name.get(-1).getValue();
+  if (bitTable.size() != computeParameters())
+    throw runtime_error("BloomFilter: The bit table size is not as expected");
+  bitTable_.assign(bitTable.buf(), bitTable.buf() + bitTable.size());
+}
+
+void
+BloomFilter::insert(const Name& key)
+{
+  uint32_t h1, h2;
+  getHashes(key, h1, h2);
+  for (size_t i = 0; i < nHashes_; ++i) {
+    // Use uint32_t so that the result is the same on all platforms.
+    size_t bit = (uint32_t)(h1 + (uint32_t)i * h2) % nBits_;
+    bitTable_[bit / 8] |= (1 << (bit % 8));
+  }
+}
+
+bool
+BloomFilter::contains(uint32_t h1, uint32_t h2) const
+{
+  for (size_t i = 0; i < nHashes_; ++i) {
+    size_t bit = (uint32_t)(h1 + (uint32_t)i * h2) % nBits_;
+    if ((bitTable_[bit / 8] & (1 << (bit % 8))) == 0)
+      return false;
+  }
+
+  return true;
+}
+
+void
+BloomFilter::appendToName(Name& name) const
+{
+  name.appendNumber(projectedElementCount_);
+  name.appendNumber((uint64_t)round(falsePositiveProbability_ * 1000));
+  name.append(&bitTable_[0], bitTable_.size());
+}
+
+size_t
+BloomFilter::computeParameters()
+{
+  // The optimal number of bits is -n ln(p) / (ln 2)^2 and the optimal number
+  // of hash functions is (bits / n) ln 2 .
+  double n = projectedElementCount_ > 0 ? projectedElementCount_ : 1;
+  double ln2 = log(2.0);
+  size_t nBits = (size_t)ceil(-n * log(falsePositiveProbability_) / (ln2 * ln2));
+  // Use whole bytes.
+  size_t nBytes = (nBits + 7) / 8;
+  nBits_ = nBytes * 8;
+
+  nHashes_ = (size_t)round((nBits_ / n) * ln2);
+  if (nHashes_ < 1)
+    nHashes_ = 1;
+
+  return nBytes;
+}
+
+void
+BloomFilter::getHashes(const Name& key, uint32_t& h1, uint32_t& h2)
+{
+  string uri = key.toUri();
+  h1 = CryptoLite::murmurHash3(0, uri.data(), uri.size());
+  // Make h2 odd so that it is not a multiple of a factor of nBits_.
+  h2 = CryptoLite::murmurHash3(1, uri.data(), uri.size()) | 1;
+}
+
+}
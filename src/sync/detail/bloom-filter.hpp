@@ -0,0 +1,153 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2019-2020 Regents of the University of California.
+ * @author: Jeff Thompson <jefft0@remap.ucla.edu>
+ * @author: From the PSync library https://github.com/named-data/PSync/blob/master/PSync/detail/bloom-filter.hpp
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+#ifndef NDN_BLOOM_FILTER_HPP
+#define NDN_BLOOM_FILTER_HPP
+
+#include <vector>
+#include <ndn-cpp/name.hpp>
+
+namespace ndn {
+
+/**
+ * BloomFilter implements a Bloom filter of Names. This is used by
+ * PartialPSyncConsumer to send the set of its subscribed prefixes in a sync
+ * Interest, and by PartialPSync2017Producer to check if a prefix is
+ * subscribed. The number of bits and hash functions is computed from the
+ * projected number of elements and the desired false positive probability.
+ * The bits use double hashing of the name URI and do not match the Bloom
+ * filter of the PSync library.
+ */
+class BloomFilter {
+public:
+  /**
+   * Create an empty BloomFilter.
+   * @param projectedElementCount The expected number of elements.
+   * @param falsePositiveProbability The desired probability of a false
+   * positive, such as 0.001. This is encoded with a resolution of 0.001.
+   */
+  BloomFilter(size_t projectedElementCount, double falsePositiveProbability);
+
+  /**
+   * Create a BloomFilter from the name components made by appendToName.
+   * @param name The name which has the three components at the end.
+   * @throws runtime_error if the components are not a valid BloomFilter
+   * encoding, or if the projected element count is greater than
+   * MAX_PROJECTED_ELEMENT_COUNT.
+   */
+  BloomFilter(const Name& name);
+
+  /**
+   * Insert the key into this Bloom filter.
+   * @param key The key Name.
+   */
+  void
+  insert(const Name& key);
+
+  /**
+   * Check if the key may be in this Bloom filter.
+   * @param key The key Name.
+   * @return True if the key may have been inserted, or false if it was
+   * definitely not inserted.
+   */
+  bool
+  contains(const Name& key) const
+  {
+    uint32_t h1, h2;
+    getHashes(key, h1, h2);
+    return contains(h1, h2);
+  }
+
+  /**
+   * Check if the key with the hashes from getHashes may be in this Bloom
+   * filter. The hashes don't depend on the size of the Bloom filter, so this
+   * is faster when checking the same key in many Bloom filters.
+   * @param h1 The first hash from getHashes.
+   * @param h2 The second hash from getHashes.
+   * @return True if the key may have been inserted, or false if it was
+   * definitely not inserted.
+   */
+  bool
+  contains(uint32_t h1, uint32_t h2) const;
+
+  /**
+   * Compute the two base hashes of the key. The hash functions are
+   * h1 + i * h2 for i from 0 to the number of hash functions minus 1.
+   * @param key The key Name.
+   * @param h1 Set this to the first hash.
+   * @param h2 Set this to the second hash.
+   */
+  static void
+  getHashes(const Name& key, uint32_t& h1, uint32_t& h2);
+
+  /**
+   * Remove all the keys.
+   */
+  void
+  clear() { bitTable_.assign(bitTable_.size(), 0); }
+
+  /**
+   * Append the projected element count, the false positive probability times
+   * 1000, and the bit table as three components to the name.
+   * @param name The Name to append to.
+   */
+  void
+  appendToName(Name& name) const;
+
+  size_t
+  getProjectedElementCount() const { return projectedElementCount_; }
+
+  double
+  getFalsePositiveProbability() const { return falsePositiveProbability_; }
+
+  /**
+   * Get the number of hash functions, which should only be used for testing.
+   * @return The number of hash functions.
+   */
+  size_t
+  getHashCount_() const { return nHashes_; }
+
+  // The number of components from appendToName.
+  static const size_t N_NAME_COMPONENTS = 3;
+  // The maximum projected element count when decoding from a name. At the
+  // lowest false positive probability, the bit table is 1.8 MB.
+  static const uint64_t MAX_PROJECTED_ELEMENT_COUNT = 1000000;
+
+private:
+  /**
+   * Compute nHashes_ and nBits_ from projectedElementCount_ and
+   * falsePositiveProbability_. This does not allocate bitTable_.
+   * @return The number of bytes for bitTable_.
+   */
+  size_t
+  computeParameters();
+
+  size_t projectedElementCount_;
+  double falsePositiveProbability_;
+  size_t nHashes_;
+  size_t nBits_;
+  std::vector<uint8_t> bitTable_;
+};
+
+}
+
+#endif
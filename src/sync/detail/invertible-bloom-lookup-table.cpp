@@ -49,6 +49,7 @@
 #include <ndn-cpp/ndn-cpp-config.h>
 #if NDN_CPP_HAVE_LIBZ
 
+#include <algorithm>
 #include <stdexcept>
 #include <zlib.h>
 #include <ndn-cpp/lite/util/crypto-lite.hpp>
@@ -59,6 +60,7 @@ using namespace std;
 namespace ndn {
 
 InvertibleBloomLookupTable::InvertibleBloomLookupTable(size_t expectedNEntries)
+: compressionLevel_(DEFAULT_COMPRESSION_LEVEL)
 {
   // 1.5 times the expected number of entries gives a very low probability of a
   // decoding failure.
@@ -79,6 +81,8 @@ InvertibleBloomLookupTable::initialize(const Blob& encoding)
   if (3 * hashTable_.size() != values.size())
     throw runtime_error("The received Invertible Bloom Filter cannot be decoded");
 
+  encoding_ = Blob();
+
   for (size_t i = 0; i < hashTable_.size(); i++) {
     HashTableEntry& entry = hashTable_.at(i);
     if (values[i * 3] != 0) {
@@ -93,33 +97,73 @@ bool
 InvertibleBloomLookupTable::listEntries
   (set<uint32_t>& positive, set<uint32_t>& negative) const
 {
+  // Make a deep copy to peel.
+  InvertibleBloomLookupTable peeled(*this);
+  vector<uint32_t> positiveList;
+  vector<uint32_t> negativeList;
+  bool result = peeled.peelEntries(positiveList, negativeList);
+
   positive.clear();
   negative.clear();
+  positive.insert(positiveList.begin(), positiveList.end());
+  negative.insert(negativeList.begin(), negativeList.end());
+  return result;
+}
 
-  // Make a deep copy.
-  InvertibleBloomLookupTable peeled(*this);
+bool
+InvertibleBloomLookupTable::peelEntries
+  (vector<uint32_t>& positive, vector<uint32_t>& negative)
+{
+  positive.clear();
+  negative.clear();
+  encoding_ = Blob();
+
+  // Only a pure cell can be peeled. Erasing its key only changes the N_HASH
+  // cells of the key, so after the first sweep we only need to check those.
+  peelQueue_.clear();
+  for (size_t i = 0; i < hashTable_.size(); ++i) {
+    if (hashTable_[i].isPure())
+      peelQueue_.push_back(i);
+  }
 
-  size_t nErased = 0;
-  do {
-    nErased = 0;
-    for (vector<HashTableEntry>::const_iterator entry = peeled.hashTable_.begin();
-         entry != peeled.hashTable_.end(); ++entry) {
-      if (entry->isPure()) {
-        if (entry->count_ == 1)
-          positive.insert(entry->keySum_);
-        else
-          negative.insert(entry->keySum_);
-
-        peeled.update(-entry->count_, entry->keySum_);
-        ++nErased;
-      }
+  size_t bucketsPerHash = hashTable_.size() / N_HASH;
+  while (!peelQueue_.empty()) {
+    const HashTableEntry& entry = hashTable_[peelQueue_.back()];
+    peelQueue_.pop_back();
+    // An earlier peel may have changed this cell since it was queued.
+    if (!entry.isPure())
+      continue;
+
+    int32_t count = entry.count_;
+    uint32_t key = entry.keySum_;
+    if (count == 1)
+      positive.push_back(key);
+    else
+      negative.push_back(key);
+
+    // This is the same as update(-count, key), but queues the changed cells.
+    uint32_t keyCheck = CryptoLite::murmurHash3(N_HASHCHECK, key);
+    for (size_t i = 0; i < N_HASH; i++) {
+      size_t index = i * bucketsPerHash +
+        (CryptoLite::murmurHash3(i, key) % bucketsPerHash);
+      HashTableEntry& cell = hashTable_[index];
+      cell.count_ -= count;
+      cell.keySum_ ^= key;
+      cell.keyCheck_ ^= keyCheck;
+      if (cell.isPure())
+        peelQueue_.push_back(index);
     }
-  } while (nErased > 0);
+  }
+
+  sort(positive.begin(), positive.end());
+  positive.erase(unique(positive.begin(), positive.end()), positive.end());
+  sort(negative.begin(), negative.end());
+  negative.erase(unique(negative.begin(), negative.end()), negative.end());
 
   // If any buckets for one of the hash functions is not empty, then we didn't
   // peel them all.
-  for (vector<HashTableEntry>::const_iterator entry = peeled.hashTable_.begin();
-       entry != peeled.hashTable_.end(); ++entry) {
+  for (vector<HashTableEntry>::const_iterator entry = hashTable_.begin();
+       entry != hashTable_.end(); ++entry) {
     if (!entry->isEmpty())
       return false;
   }
@@ -130,26 +174,40 @@ InvertibleBloomLookupTable::listEntries
 ptr_lib::shared_ptr<InvertibleBloomLookupTable>
 InvertibleBloomLookupTable::difference
   (const InvertibleBloomLookupTable& other) const
+{
+  ptr_lib::shared_ptr<InvertibleBloomLookupTable> result =
+    ptr_lib::make_shared<InvertibleBloomLookupTable>(0);
+  difference(other, *result);
+  return result;
+}
+
+void
+InvertibleBloomLookupTable::difference
+  (const InvertibleBloomLookupTable& other,
+   InvertibleBloomLookupTable& result) const
 {
   if (hashTable_.size() != other.hashTable_.size())
     throw runtime_error("IBLT difference: Both tables must be the same size");
 
-  ptr_lib::shared_ptr<InvertibleBloomLookupTable> result =
-    ptr_lib::make_shared<InvertibleBloomLookupTable>(*this);
+  result.hashTable_.resize(hashTable_.size());
   for (size_t i = 0; i < hashTable_.size(); i++) {
-    HashTableEntry& e1 = result->hashTable_.at(i);
-    const HashTableEntry& e2 = other.hashTable_.at(i);
-    e1.count_ -= e2.count_;
-    e1.keySum_ ^= e2.keySum_;
-    e1.keyCheck_ ^= e2.keyCheck_;
+    HashTableEntry& e = result.hashTable_[i];
+    const HashTableEntry& e1 = hashTable_[i];
+    const HashTableEntry& e2 = other.hashTable_[i];
+    e.count_ = e1.count_ - e2.count_;
+    e.keySum_ = e1.keySum_ ^ e2.keySum_;
+    e.keyCheck_ = e1.keyCheck_ ^ e2.keyCheck_;
   }
-
-  return result;
+  result.compressionLevel_ = compressionLevel_;
+  result.encoding_ = Blob();
 }
 
 Blob
 InvertibleBloomLookupTable::encode() const
 {
+  if (!encoding_.isNull())
+    return encoding_;
+
   size_t nEntries = hashTable_.size();
   size_t unitSize = (32 * 3) / 8; // hard coding
   size_t tableSize = unitSize * nEntries;
@@ -181,7 +239,22 @@ InvertibleBloomLookupTable::encode() const
     table[(i * unitSize) + 11] = 0xFF & (entry.keyCheck_ >> 24);
   }
 
-  return zlibCompress(table.data(), table.size());
+  encoding_ = zlibCompress(table.data(), table.size(), compressionLevel_);
+  return encoding_;
+}
+
+void
+InvertibleBloomLookupTable::setCompressionLevel(int compressionLevel)
+{
+  if (compressionLevel < Z_DEFAULT_COMPRESSION ||
+      compressionLevel > Z_BEST_COMPRESSION)
+    throw runtime_error
+      ("InvertibleBloomLookupTable: The compression level must be from -1 to 9");
+
+  if (compressionLevel != compressionLevel_) {
+    compressionLevel_ = compressionLevel;
+    encoding_ = Blob();
+  }
 }
 
 bool
@@ -215,6 +288,8 @@ InvertibleBloomLookupTable::update(int plusOrMinus, uint32_t key)
     entry.keySum_ ^= key;
     entry.keyCheck_ ^= CryptoLite::murmurHash3(N_HASHCHECK, key);
   }
+
+  encoding_ = Blob();
 }
 
 vector<uint32_t>
@@ -238,41 +313,34 @@ InvertibleBloomLookupTable::decode(const Blob& encoding)
 }
 
 Blob
-InvertibleBloomLookupTable::zlibCompress(const uint8_t* data, size_t dataLength)
+InvertibleBloomLookupTable::zlibCompress
+  (const uint8_t* data, size_t dataLength, int compressionLevel)
 {
-  // From https://www.zlib.net/zlib_how.html
-
-  // Use a vector in a shared_ptr so we can make it a Blob without copying.
-  ptr_lib::shared_ptr<vector<uint8_t>> result(new vector<uint8_t>());
-  uint8_t outBuffer[16384];
-
   z_stream stream;
   stream.zalloc = Z_NULL;
   stream.zfree = Z_NULL;
   stream.opaque = Z_NULL;
-  deflateInit(&stream, Z_BEST_COMPRESSION);
+  if (deflateInit(&stream, compressionLevel) != Z_OK)
+    throw runtime_error("zlibCompress: Error in deflateInit");
+
+  // deflateBound gives the maximum output size, so we can deflate in one call
+  // without copying through an intermediate buffer. Use a vector in a
+  // shared_ptr so we can make it a Blob without copying.
+  ptr_lib::shared_ptr<vector<uint8_t>> result
+    (new vector<uint8_t>(deflateBound(&stream, dataLength)));
 
   stream.next_in = const_cast<uint8_t*>(data);
   stream.avail_in = dataLength;
+  stream.next_out = result->data();
+  stream.avail_out = result->size();
 
-  int status;
-  do {
-    stream.avail_out = sizeof(outBuffer);
-    stream.next_out = outBuffer;
-    status = deflate(&stream, Z_FINISH);
-    if (!(status == Z_OK || status == Z_STREAM_END))
-      // We don't expect a compression error.
-      throw runtime_error("zlibCompress: Error during deflate");
-
-    size_t have = sizeof(outBuffer) - stream.avail_out;
-    result->insert(result->end(), outBuffer, outBuffer + have);
-  } while (stream.avail_out == 0);
-
+  int status = deflate(&stream, Z_FINISH);
   deflateEnd(&stream);
   if (status != Z_STREAM_END)
-    // We don't expect this error since stream.avail_out == 0.
+    // We don't expect this error since the output buffer is large enough.
     throw runtime_error("zlibCompress: status is not Z_STREAM_END");
 
+  result->resize(result->size() - stream.avail_out);
   return Blob(result, false);
 }
 
@@ -96,6 +96,21 @@ public:
   bool
   listEntries(std::set<uint32_t>& positive, std::set<uint32_t>& negative) const;
 
+  /**
+   * List all the entries in the IBLT by peeling them from this IBLT, which
+   * changes it. This is like listEntries but does not copy the IBLT, so it
+   * should be called on a scratch IBLT from difference(other, result). This
+   * only revisits the cells changed by the previous peel instead of sweeping
+   * the whole table again.
+   * @param positive Set positive to the sorted positive entries. This first
+   * clears the vector, but keeps its allocated capacity for reuse.
+   * @param negative Set negative to the sorted negative entries. This first
+   * clears the vector, but keeps its allocated capacity for reuse.
+   * @return True if decoding is completed successfully.
+   */
+  bool
+  peelEntries(std::vector<uint32_t>& positive, std::vector<uint32_t>& negative);
+
   /**
    * Get a new IBLT which is the difference of the other IBLT from this IBLT.
    * @param other The other IBLT.
@@ -104,17 +119,52 @@ public:
   ptr_lib::shared_ptr<InvertibleBloomLookupTable>
   difference(const InvertibleBloomLookupTable& other) const;
 
+  /**
+   * Set result to the difference of the other IBLT from this IBLT. This
+   * reuses the memory of result, so that a caller can use the same scratch
+   * IBLT for many differences.
+   * @param other The other IBLT.
+   * @param result Set this to this - other. It can be any size since this
+   * replaces its hash table.
+   */
+  void
+  difference
+    (const InvertibleBloomLookupTable& other,
+     InvertibleBloomLookupTable& result) const;
+
   /**
    * Encode this IBLT to a Blob. This encodes this hash table from a uint32_t
    * array to a uint8_t array. We create a uin8_t array 12 times the size of
    * the uint32_t array. We put the first count in the first 4 cells, keySum in
    * the next 4, and keyCheck in the next 4. We repeat for all the other cells
    * of the hash table. Then we append this uint8_t array to the name.
+   * This saves the compressed result and returns it again until the IBLT
+   * changes, so it is cheap to call for each sync Interest.
    * @return The encoded Blob.
    */
   Blob
   encode() const;
 
+  /**
+   * Set the zlib compression level used by encode(). Because the decoder
+   * always inflates, IBLTs encoded with any level can be decoded by any
+   * other.
+   * @param compressionLevel The level from 0 (no compression, which is fastest
+   * and uses zlib stored blocks) to 9 (best compression), or -1 for the zlib
+   * default.
+   * @throws runtime_error if compressionLevel is not from -1 to 9.
+   */
+  void
+  setCompressionLevel(int compressionLevel);
+
+  /**
+   * Get the zlib compression level used by encode().
+   * @return The compression level. If not set, this is
+   * DEFAULT_COMPRESSION_LEVEL.
+   */
+  int
+  getCompressionLevel() const { return compressionLevel_; }
+
   /**
    * Check if this IBLT has the same number of entries as the other IBLT and
    * that they are equal.
@@ -132,6 +182,8 @@ public:
 
   static const size_t N_HASH = 3;
   static const size_t N_HASHCHECK = 11;
+  // This is Z_BEST_COMPRESSION, which the PSync library uses.
+  static const int DEFAULT_COMPRESSION_LEVEL = 9;
 
 private:
   class HashTableEntry
@@ -169,12 +221,18 @@ private:
   decode(const Blob& encoding);
 
   static Blob
-  zlibCompress(const uint8_t* data, size_t dataLength);
+  zlibCompress(const uint8_t* data, size_t dataLength, int compressionLevel);
 
   static Blob
   zlibDecompress(const uint8_t* data, size_t dataLength);
 
   std::vector<HashTableEntry> hashTable_;
+  // peelQueue_ is scratch space for peelEntries.
+  std::vector<size_t> peelQueue_;
+  int compressionLevel_;
+  // encoding_ is the saved result of encode(), or null if hashTable_ or
+  // compressionLevel_ changed since it was computed.
+  mutable Blob encoding_;
 
   static const int INSERT = 1;
   static const int ERASE = -1;
@@ -21,6 +21,7 @@
  */
 
 #include <sstream>
+#include <algorithm>
 #include "../../encoding/tlv-encoder.hpp"
 #include "../../encoding/tlv-decoder.hpp"
 #include "../../c/encoding/tlv/tlv-name.h"
@@ -30,14 +31,41 @@ using namespace std;
 
 namespace ndn {
 
+/**
+ * Compare Name pointers by the Names, for sorting.
+ */
+static bool
+nameLess(const Name* name1, const Name* name2) { return *name1 < *name2; }
+
 Blob
-PSyncState::wireEncode() const
+PSyncState::wireEncode(bool isCompact) const
 {
   // Encode directly as TLV. We don't support the WireFormat abstraction
   // because this isn't meant to go directly on the wire.
   TlvEncoder encoder(256);
 
-  encoder.writeNestedTlv(Tlv_PSyncContent, encodeContent, this);
+  if (isCompact) {
+    // The compact encoding splits off the last component of each name.
+    for (size_t i = 0; i < content_.size(); ++i) {
+      if (content_[i].size() == 0) {
+        isCompact = false;
+        break;
+      }
+    }
+  }
+
+  if (isCompact) {
+    vector<const Name*> sortedNames;
+    sortedNames.reserve(content_.size());
+    for (size_t i = 0; i < content_.size(); ++i)
+      sortedNames.push_back(&content_[i]);
+    sort(sortedNames.begin(), sortedNames.end(), nameLess);
+
+    encoder.writeNestedTlv
+      (Tlv_PSyncCompactContent, encodeCompactContent, &sortedNames);
+  }
+  else
+    encoder.writeNestedTlv(Tlv_PSyncContent, encodeContent, this);
 
   return encoder.finish();
 }
@@ -63,6 +91,67 @@ PSyncState::encodeContent(const void *context, TlvEncoder &encoder)
   }
 }
 
+void
+PSyncState::encodeCompactContent(const void *context, TlvEncoder &encoder)
+{
+  const vector<const Name*>& sortedNames = *(const vector<const Name*> *)context;
+
+  const Name* previousName = 0;
+  size_t previousPrefixSize = 0;
+  // The previous sequence number with the same prefix.
+  uint64_t previousSequenceNo = 0;
+  ndn_Error error;
+  for (size_t i = 0; i < sortedNames.size(); ++i) {
+    const Name& name = *sortedNames[i];
+    struct ndn_NameComponent nameComponents[100];
+    NameLite nameLite
+      (nameComponents, sizeof(nameComponents) / sizeof(nameComponents[0]));
+    name.get(nameLite);
+
+    size_t prefixSize = name.size() - 1;
+    size_t nShared = 0;
+    if (previousName) {
+      size_t maxShared = min(prefixSize, previousPrefixSize);
+      while (nShared < maxShared &&
+             name.get(nShared).equals(previousName->get(nShared)))
+        ++nShared;
+    }
+    if (!(previousName && nShared == previousPrefixSize &&
+          nShared == prefixSize))
+      // The prefix is different.
+      previousSequenceNo = 0;
+
+    if ((error = ndn_TlvEncoder_writeVarNumber(&encoder, nShared)) ||
+        (error = ndn_TlvEncoder_writeVarNumber(&encoder, prefixSize - nShared)))
+      throw runtime_error(ndn_getErrorString(error));
+    for (size_t j = nShared; j < prefixSize; ++j) {
+      if ((error = ndn_encodeTlvNameComponent(&nameComponents[j], &encoder)))
+        throw runtime_error(ndn_getErrorString(error));
+    }
+
+    // Write a sequence number as the difference plus 1, or 0 followed by the
+    // component. The names are sorted, so the difference is not negative.
+    uint64_t sequenceNo;
+    if (getSequenceNo(name.get(-1), sequenceNo) &&
+        sequenceNo >= previousSequenceNo &&
+        sequenceNo - previousSequenceNo < 0xffffffffffffffffULL) {
+      if ((error = ndn_TlvEncoder_writeVarNumber
+           (&encoder, sequenceNo - previousSequenceNo + 1)))
+        throw runtime_error(ndn_getErrorString(error));
+      previousSequenceNo = sequenceNo;
+    }
+    else {
+      if ((error = ndn_TlvEncoder_writeVarNumber(&encoder, 0)) ||
+          (error = ndn_encodeTlvNameComponent
+           (&nameComponents[prefixSize], &encoder)))
+        throw runtime_error(ndn_getErrorString(error));
+    }
+
+    previousName = &name;
+    previousPrefixSize = prefixSize;
+  }
+}
+
 void
 PSyncState::wireDecode(const uint8_t *input, size_t inputLength)
 {
@@ -71,6 +160,19 @@ PSyncState::wireDecode(const uint8_t *input, size_t inputLength)
   // Decode directly as TLV. We don't support the WireFormat abstraction
   // because this isn't meant to go directly on the wire.
   TlvDecoder decoder(input, inputLength);
+
+  int isCompact;
+  ndn_Error error;
+  if ((error = ndn_TlvDecoder_peekType
+       (&decoder, Tlv_PSyncCompactContent, inputLength, &isCompact)))
+    throw runtime_error(ndn_getErrorString(error));
+  if (isCompact) {
+    size_t endOffset = decoder.readNestedTlvsStart(Tlv_PSyncCompactContent);
+    decodeCompactContent(decoder, endOffset);
+    decoder.finishNestedTlvs(endOffset);
+    return;
+  }
+
   size_t endOffset = decoder.readNestedTlvsStart(Tlv_PSyncContent);
 
   // Decode a sequence of Name.
@@ -93,6 +195,63 @@ PSyncState::wireDecode(const uint8_t *input, size_t inputLength)
   decoder.finishNestedTlvs(endOffset);
 }
 
+void
+PSyncState::decodeCompactContent(TlvDecoder& decoder, size_t endOffset)
+{
+  Name previousPrefix;
+  bool hasPrevious = false;
+  uint64_t previousSequenceNo = 0;
+  ndn_Error error;
+  while (decoder.offset < endOffset) {
+    uint64_t nShared = decoder.readVarNumber();
+    uint64_t nNew = decoder.readVarNumber();
+    if (nShared > previousPrefix.size())
+      throw runtime_error
+        ("PSyncState: The number of shared components is too large");
+
+    Name prefix(previousPrefix.getPrefix((int)nShared));
+    for (uint64_t i = 0; i < nNew; ++i) {
+      struct ndn_NameComponent component;
+      if ((error = ndn_decodeTlvNameComponent(&component, &decoder)))
+        throw runtime_error(ndn_getErrorString(error));
+      prefix.append(Name::Component(NameLite::Component::downCast(component)));
+    }
+    if (!(hasPrevious && nShared == previousPrefix.size() && nNew == 0))
+      // The prefix is different.
+      previousSequenceNo = 0;
+
+    uint64_t code = decoder.readVarNumber();
+    Name name(prefix);
+    if (code == 0) {
+      struct ndn_NameComponent component;
+      if ((error = ndn_decodeTlvNameComponent(&component, &decoder)))
+        throw runtime_error(ndn_getErrorString(error));
+      name.append(Name::Component(NameLite::Component::downCast(component)));
+    }
+    else {
+      previousSequenceNo += code - 1;
+      name.appendNumber(previousSequenceNo);
+    }
+    content_.push_back(name);
+
+    previousPrefix = prefix;
+    hasPrevious = true;
+  }
+}
+
+bool
+PSyncState::getSequenceNo(const Name::Component& component, uint64_t& number)
+{
+  size_t size = component.getValue().size();
+  if (!component.isGeneric() ||
+      !(size == 1 || size == 2 || size == 4 || size == 8))
+    return false;
+
+  number = component.toNumber();
+  // Only use a canonical encoding which decodes to the same component.
+  return Name::Component::fromNumber(number).equals(component);
+}
+
 string
 PSyncState::toString() const
 {
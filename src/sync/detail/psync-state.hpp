@@ -28,10 +28,22 @@
 namespace ndn {
 
 class TlvEncoder;
+class TlvDecoder;
 
 /**
  * The PSyncState class represents a sequence of Names as the state of PSync.
- * It has methods to encode and decode for the wire.
+ * It has methods to encode and decode for the wire, either as the
+ * PSyncContent of the PSync library with each full Name, or as the compact
+ * PSyncCompactContent. The compact encoding sorts the names and writes each
+ * one as the number of prefix components (all but the last component) which
+ * are shared with the previous name, followed by the new prefix components.
+ * If the last component is a sequence number (a NonNegativeInteger
+ * component), it is written as the difference from the previous sequence
+ * number with the same prefix. The compact encoding is ndn-cpp specific, so
+ * a sync Interest makes its IBLT component with makeIbltComponent() to tell
+ * the replier that it can decode the compact encoding. Other PSync
+ * implementations only use the value of the IBLT component, so they still
+ * interoperate and reply with PSyncContent.
  */
 class PSyncState {
 public:
@@ -80,14 +92,19 @@ public:
   clear() { content_.clear(); }
 
   /**
-   * Encode this as an NDN-TLV PSyncContent.
+   * Encode this as an NDN-TLV PSyncContent or PSyncCompactContent.
+   * @param isCompact (optional) If true, encode as PSyncCompactContent. Only
+   * use this if canDecodeCompact() is true for the IBLT component of the sync
+   * Interest. If the content has an empty Name, this uses PSyncContent anyway.
+   * If omitted, encode as PSyncContent.
    * @return The encoding as a Blob.
    */
   Blob
-  wireEncode() const;
+  wireEncode(bool isCompact = false) const;
 
   /**
-   * Decode the input as an NDN-TLV PSyncContent and update this object.
+   * Decode the input as an NDN-TLV PSyncContent or PSyncCompactContent and
+   * update this object. For PSyncCompactContent, the names are in sorted order.
    * @param input A pointer to the input buffer to decode.
    * @param inputLength The number of bytes in input.
    */
@@ -95,7 +112,8 @@ public:
   wireDecode(const uint8_t *input, size_t inputLength);
 
   /**
-   * Decode the input as an NDN-TLV PSyncContent and update this object.
+   * Decode the input as an NDN-TLV PSyncContent or PSyncCompactContent and
+   * update this object. For PSyncCompactContent, the names are in sorted order.
    * @param input The input buffer to decode.
    */
   void
@@ -111,8 +129,36 @@ public:
   std::string
   toString() const;
 
+  /**
+   * Make the name component for the IBLT in a sync Interest. Its type tells
+   * the replier that this can decode PSyncCompactContent.
+   * @param encodedIblt The encoded IBLT.
+   * @return The name component.
+   */
+  static Name::Component
+  makeIbltComponent(const Blob& encodedIblt)
+  {
+    return Name::Component
+      (encodedIblt, ndn_NameComponentType_OTHER_CODE, Tlv_PSyncCompactContent);
+  }
+
+  /**
+   * Check if the IBLT component of a sync Interest was made by
+   * makeIbltComponent(), so that the reply can be encoded as
+   * PSyncCompactContent.
+   * @param ibltComponent The IBLT name component.
+   * @return True if the requester can decode PSyncCompactContent.
+   */
+  static bool
+  canDecodeCompact(const Name::Component& ibltComponent)
+  {
+    return ibltComponent.getType() == ndn_NameComponentType_OTHER_CODE &&
+      ibltComponent.getOtherTypeCode() == Tlv_PSyncCompactContent;
+  }
+
   enum {
-    Tlv_PSyncContent = 128
+    Tlv_PSyncContent = 128,
+    Tlv_PSyncCompactContent = 129
   };
 
 private:
@@ -125,6 +171,31 @@ private:
   static void
   encodeContent(const void *context, TlvEncoder &encoder);
 
+  /**
+   * This is called by writeNestedTlv to encode the sorted Names as
+   * PSyncCompactContent.
+   * @param context A pointer to the vector of sorted Name pointers.
+   * @param encoder The TlvEncoder.
+   */
+  static void
+  encodeCompactContent(const void *context, TlvEncoder &encoder);
+
+  /**
+   * Decode the value of a PSyncCompactContent and append to content_.
+   */
+  void
+  decodeCompactContent(TlvDecoder& decoder, size_t endOffset);
+
+  /**
+   * Check if the name component is a NonNegativeInteger which the compact
+   * encoding can write as a number, and get the number.
+   * @param component The name component.
+   * @param number Set this to the number.
+   * @return True if the component is a sequence number.
+   */
+  static bool
+  getSequenceNo(const Name::Component& component, uint64_t& number);
+
   std::vector<Name> content_;
 };
 
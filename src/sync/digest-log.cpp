@@ -0,0 +1,96 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Regents of the University of California.
+ * @author: Jeff Thompson <jefft0@remap.ucla.edu>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+// Only compile if ndn-cpp-config.h defines NDN_CPP_HAVE_PROTOBUF = 1.
+#include <ndn-cpp/ndn-cpp-config.h>
+#if NDN_CPP_HAVE_PROTOBUF
+
+#include <ndn-cpp/lite/util/crypto-lite.hpp>
+#include "sync-state.pb.h"
+#include "digest-log.hpp"
+
+using namespace std;
+
+namespace ndn {
+
+DigestLog::Entry::Entry
+  (const string& digest,
+   const google::protobuf::RepeatedPtrField<Sync::SyncState>& data)
+  : digest_(digest),
+   data_(new google::protobuf::RepeatedPtrField<Sync::SyncState>(data))
+{
+}
+
+int
+DigestLog::find(const string& digest) const
+{
+  uint32_t hash = getIndexHash(digest);
+  const HashIndex<uint64_t>::Bucket& bucket = index_.getBucket(hash);
+  for (size_t i = 0; i < bucket.size(); ++i) {
+    if (bucket[i].hash_ != hash)
+      continue;
+    size_t position = (size_t)(bucket[i].value_ - nEvictions_);
+    if (entries_[position].getDigest() == digest)
+      return (int)position;
+  }
+
+  return -1;
+}
+
+void
+DigestLog::add
+  (const string& digest,
+   const google::protobuf::RepeatedPtrField<Sync::SyncState>& data)
+{
+  if (maxEntries_ > 0 && entries_.size() >= maxEntries_)
+    evictOldest();
+
+  entries_.push_back(Entry(digest, data));
+  index_.insert(getIndexHash(digest), nEvictions_ + entries_.size() - 1);
+}
+
+void
+DigestLog::setMaxEntries(size_t maxEntries)
+{
+  maxEntries_ = maxEntries;
+  if (maxEntries_ > 0) {
+    while (entries_.size() > maxEntries_)
+      evictOldest();
+  }
+}
+
+uint32_t
+DigestLog::getIndexHash(const string& digest)
+{
+  return CryptoLite::murmurHash3(0, digest.data(), digest.size());
+}
+
+void
+DigestLog::evictOldest()
+{
+  index_.erase(getIndexHash(entries_.front().getDigest()), nEvictions_);
+  entries_.pop_front();
+  ++nEvictions_;
+}
+
+}
+
+#endif // NDN_CPP_HAVE_PROTOBUF
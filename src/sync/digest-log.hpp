@@ -0,0 +1,153 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Regents of the University of California.
+ * @author: Jeff Thompson <jefft0@remap.ucla.edu>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+#ifndef NDN_DIGEST_LOG_HPP
+#define NDN_DIGEST_LOG_HPP
+
+#include <ndn-cpp/common.hpp>
+#include <string>
+#include <deque>
+#include "../util/hash-index.hpp"
+
+namespace google { namespace protobuf { template <typename Element> class RepeatedPtrField; } }
+namespace Sync { class SyncState; }
+
+namespace ndn {
+
+/**
+ * A DigestLog holds the ChronoSync2013 root digests in the order that they
+ * were reached, each with the sync state messages which changed the digest
+ * tree to that root. The entries are indexed by a hash table of the digest for
+ * fast lookup. To bound the memory, the log keeps at most a maximum number of
+ * entries, evicting the oldest entry when a new one is added. A digest which
+ * has been evicted can't be found, so ChronoSync2013 must answer it with the
+ * full state instead of the differences after it.
+ */
+class DigestLog {
+public:
+  class Entry {
+  public:
+    Entry
+      (const std::string& digest,
+       const google::protobuf::RepeatedPtrField<Sync::SyncState>& data);
+
+    const std::string&
+    getDigest() const { return digest_; }
+
+    const google::protobuf::RepeatedPtrField<Sync::SyncState>&
+    getData() const { return *data_; }
+
+  private:
+    std::string digest_;
+    ptr_lib::shared_ptr<google::protobuf::RepeatedPtrField<Sync::SyncState> > data_;
+  };
+
+  /**
+   * Create an empty DigestLog.
+   * @param maxEntries (optional) The maximum number of entries to keep, or 0
+   * for no limit. If omitted, use DEFAULT_MAX_ENTRIES.
+   */
+  DigestLog(size_t maxEntries = DEFAULT_MAX_ENTRIES)
+  : maxEntries_(maxEntries), nEvictions_(0)
+  {}
+
+  /**
+   * Find the entry with the digest.
+   * @param digest The root digest as a hex string.
+   * @return The position of the entry from 0 (the oldest entry still in the
+   * log) to size() - 1, or -1 if not found.
+   */
+  int
+  find(const std::string& digest) const;
+
+  /**
+   * Append a new entry with the digest and a copy of the data. If this makes
+   * the log exceed the maximum number of entries, evict the oldest entries.
+   * This does not check if the log already has the digest.
+   * @param digest The root digest as a hex string.
+   * @param data The sync state messages which changed the digest tree to the
+   * digest.
+   */
+  void
+  add(const std::string& digest,
+      const google::protobuf::RepeatedPtrField<Sync::SyncState>& data);
+
+  /**
+   * Get the number of entries in the log.
+   * @return The number of entries.
+   */
+  size_t
+  size() const { return entries_.size(); }
+
+  /**
+   * Get the entry at the position.
+   * @param i The position from 0 (the oldest entry) to size() - 1.
+   * @return The entry.
+   */
+  const Entry&
+  get(size_t i) const { return entries_[i]; }
+
+  /**
+   * Get the maximum number of entries.
+   * @return The maximum number of entries, or 0 for no limit.
+   */
+  size_t
+  getMaxEntries() const { return maxEntries_; }
+
+  /**
+   * Set the maximum number of entries, and evict the oldest entries if the log
+   * now has more.
+   * @param maxEntries The maximum number of entries, or 0 for no limit.
+   */
+  void
+  setMaxEntries(size_t maxEntries);
+
+  /**
+   * Get the number of entries which have been evicted from the log.
+   * @return The eviction count.
+   */
+  uint64_t
+  getEvictionCount() const { return nEvictions_; }
+
+  static const size_t DEFAULT_MAX_ENTRIES = 10000;
+
+private:
+  static uint32_t
+  getIndexHash(const std::string& digest);
+
+  /**
+   * Remove the oldest entry from entries_ and index_.
+   */
+  void
+  evictOldest();
+
+  size_t maxEntries_;
+  uint64_t nEvictions_;
+  // The front is the oldest entry.
+  std::deque<Entry> entries_;
+  // The hash table of entries_ by digest. Each value is the sequence number of
+  // an entry, where the sequence number of entries_[i] is nEvictions_ + i.
+  HashIndex<uint64_t> index_;
+};
+
+}
+
+#endif
@@ -22,6 +22,7 @@
 
 #include <algorithm>
 #include <ndn-cpp/util/logging.hpp>
+#include <ndn-cpp/lite/util/crypto-lite.hpp>
 #if NDN_CPP_HAVE_LIBCRYPTO
 #include <openssl/ssl.h>
 #else
@@ -35,50 +36,16 @@ using namespace std;
 
 namespace ndn {
 
-/**
- * Convert the hex character to an integer from 0 to 15, or -1 if not a hex character.
- * @param c
- * @return
- */
-static int
-fromHexChar(uint8_t c)
-{
-  if (c >= '0' && c <= '9')
-    return (int)c - (int)'0';
-  else if (c >= 'A' && c <= 'F')
-    return (int)c - (int)'A' + 10;
-  else if (c >= 'a' && c <= 'f')
-    return (int)c - (int)'a' + 10;
-  else
-    return -1;
-}
-
-/**
- * Convert the hex string to bytes and call SHA256_Update.
- * @param context The SHA256_CTX to update.
- * @param hex The hex string.
- * @return The result from SHA256_Update.
- */
-static int
-SHA256_UpdateHex(SHA256_CTX *context, const string& hex)
-{
-  vector<uint8_t> data(hex.size() / 2);
-  for (size_t i = 0; i < data.size(); ++i)
-    data[i] = (uint8_t)(16 * fromHexChar(hex[2 * i]) + fromHexChar(hex[2 * i + 1]));
-
-  return SHA256_Update(context, &data[0], data.size());
-}
-
 bool
 DigestTree::update(const std::string& dataPrefix, int sessionNo, int sequenceNo)
 {
-  int index = find(dataPrefix, sessionNo);
+  Node* node = findNode(dataPrefix, sessionNo);
   _LOG_DEBUG(dataPrefix << ", " << sessionNo);
-  _LOG_DEBUG("DigestTree::update session " << sessionNo << ", index " << index);
-  if (index >= 0) {
+  _LOG_DEBUG("DigestTree::update session " << sessionNo << ", found " << (node != 0));
+  if (node) {
     // only update the newer status
-    if (digestNode_[index]->getSequenceNo() < sequenceNo)
-      digestNode_[index]->setSequenceNo(sequenceNo);
+    if (node->getSequenceNo() < sequenceNo)
+      node->setSequenceNo(sequenceNo);
     else
       return false;
   }
@@ -90,36 +57,61 @@ DigestTree::update(const std::string& dataPrefix, int sessionNo, int sequenceNo)
     digestNode_.insert
       (std::lower_bound(digestNode_.begin(), digestNode_.end(), temp, nodeCompare_),
        temp);
+    index_.insert(getIndexHash(dataPrefix, sessionNo), temp.get());
   }
 
-  recomputeRoot();
+  // getRoot() will recompute the root.
+  isRootDirty_ = true;
   return true;
 }
 
 void
-DigestTree::recomputeRoot()
+DigestTree::recomputeRoot() const
 {
   SHA256_CTX sha256;
 
   SHA256_Init(&sha256);
   for (size_t i = 0; i < digestNode_.size(); ++i)
-    SHA256_UpdateHex(&sha256, digestNode_[i]->getDigest());
+    SHA256_Update(&sha256, digestNode_[i]->getDigest(), ndn_SHA256_DIGEST_SIZE);
   uint8_t digestRoot[ndn_SHA256_DIGEST_SIZE];
   SHA256_Final(&digestRoot[0], &sha256);
   root_ = toHex(digestRoot, sizeof(digestRoot));
+  isRootDirty_ = false;
   _LOG_DEBUG("update root to: " + root_);
 }
 
-int
-DigestTree::find(const string& dataPrefix, int sessionNo) const
+DigestTree::Node*
+DigestTree::findNode(const string& dataPrefix, int sessionNo) const
 {
-  for (size_t i = 0; i < digestNode_.size(); ++i) {
-    if (digestNode_[i]->getDataPrefix() == dataPrefix &&
-        digestNode_[i]->getSessionNo() == sessionNo)
-      return i;
+  uint32_t hash = getIndexHash(dataPrefix, sessionNo);
+  const HashIndex<Node*>::Bucket& bucket = index_.getBucket(hash);
+  for (size_t i = 0; i < bucket.size(); ++i) {
+    if (bucket[i].hash_ == hash &&
+        bucket[i].value_->getSessionNo() == sessionNo &&
+        bucket[i].value_->getDataPrefix() == dataPrefix)
+      return bucket[i].value_;
   }
 
-  return -1;
+  return 0;
+}
+
+uint32_t
+DigestTree::getIndexHash(const string& dataPrefix, int sessionNo)
+{
+  return CryptoLite::murmurHash3
+    ((uint32_t)sessionNo, dataPrefix.data(), dataPrefix.size());
+}
+
+DigestTree::Node::Node
+  (const std::string& dataPrefix, int sessionNo, int sequenceNo)
+: dataPrefix_(dataPrefix), sessionNo_(sessionNo), sequenceNo_(sequenceNo)
+{
+  SHA256_CTX sha256;
+  SHA256_Init(&sha256);
+  SHA256_Update(&sha256, &dataPrefix_[0], dataPrefix_.size());
+  SHA256_Final(nameDigest_, &sha256);
+
+  recomputeDigest();
 }
 
 void
@@ -137,16 +129,9 @@ DigestTree::Node::recomputeDigest()
   SHA256_Final(sequenceDigest, &sha256);
 
   SHA256_Init(&sha256);
-  SHA256_Update(&sha256, &dataPrefix_[0], dataPrefix_.size());
-  uint8_t nameDigest[ndn_SHA256_DIGEST_SIZE];
-  SHA256_Final(nameDigest, &sha256);
-
-  SHA256_Init(&sha256);
-  SHA256_Update(&sha256, nameDigest, sizeof(nameDigest));
+  SHA256_Update(&sha256, nameDigest_, sizeof(nameDigest_));
   SHA256_Update(&sha256, sequenceDigest, sizeof(sequenceDigest));
-  uint8_t nodeDigest[ndn_SHA256_DIGEST_SIZE];
-  SHA256_Final(nodeDigest, &sha256);
-  digest_ = toHex(nodeDigest, sizeof(nodeDigest));
+  SHA256_Final(digest_, &sha256);
 }
 
 void
@@ -25,13 +25,23 @@
 
 #include <ndn-cpp/common.hpp>
 #include <string>
+#include <vector>
+#include "../util/hash-index.hpp"
 
 namespace ndn {
 
+/**
+ * A DigestTree holds the (data prefix, session) nodes of a ChronoSync2013
+ * group with their sequence numbers, and the root digest of all the nodes.
+ * The nodes are kept sorted for computing the root, and indexed by a hash
+ * table for fast lookup. The root is only recomputed when it is needed after
+ * a change, so that a burst of updates, such as from one SyncStateMsg, hashes
+ * the nodes once.
+ */
 class DigestTree {
 public:
   DigestTree()
-  : root_("00")
+  : root_("00"), isRootDirty_(false)
   {}
 
   class Node {
@@ -42,13 +52,7 @@ public:
      * @param sessionNo The sequence number.
      * @param sequenceNo The session number.
      */
-    Node(const std::string& dataPrefix, int sessionNo, int sequenceNo)
-    : dataPrefix_(dataPrefix),
-      sessionNo_(sessionNo),
-      sequenceNo_(sequenceNo)
-    {
-      recomputeDigest();
-    }
+    Node(const std::string& dataPrefix, int sessionNo, int sequenceNo);
 
     const std::string&
     getDataPrefix() const { return dataPrefix_; }
@@ -61,9 +65,9 @@ public:
 
     /**
      * Get the digest.
-     * @return The digest as a hex string.
+     * @return A pointer to the ndn_SHA256_DIGEST_SIZE bytes of the digest.
      */
-    const std::string&
+    const uint8_t*
     getDigest() const { return digest_; }
 
     /**
@@ -97,7 +101,7 @@ public:
 
   private:
     /**
-     * Digest the fields and set digest_ to the hex digest.
+     * Digest nameDigest_ and the numbers and set digest_.
      */
     void
     recomputeDigest();
@@ -108,13 +112,16 @@ public:
     std::string dataPrefix_;
     int sessionNo_;
     int sequenceNo_;
-    std::string digest_;
+    // The digest of dataPrefix_, which doesn't change.
+    uint8_t nameDigest_[ndn_SHA256_DIGEST_SIZE];
+    uint8_t digest_[ndn_SHA256_DIGEST_SIZE];
   };
 
   /**
-   * Update the digest tree and recompute the root digest.  If the combination
-   * of dataPrefix and sessionNo already exists in the tree then update its
-   * sequenceNo (only if the given sequenceNo is newer), otherwise add a new node.
+   * Update the digest tree and mark the root digest to be recomputed.  If the
+   * combination of dataPrefix and sessionNo already exists in the tree then
+   * update its sequenceNo (only if the given sequenceNo is newer), otherwise
+   * add a new node.
    * @param dataPrefix The name prefix.
    * @param sessionNo The session number.
    * @param sequenceNo The new sequence number.
@@ -124,8 +131,18 @@ public:
   bool
   update(const std::string& dataPrefix, int sessionNo, int sequenceNo);
 
-  int
-  find(const std::string& dataPrefix, int sessionNo) const;
+  /**
+   * Find the node with the dataPrefix and sessionNo.
+   * @param dataPrefix The name prefix.
+   * @param sessionNo The session number.
+   * @return A pointer to the node, or 0 if not found. Nodes are never removed,
+   * so the pointer is valid for the life of this DigestTree.
+   */
+  const DigestTree::Node*
+  find(const std::string& dataPrefix, int sessionNo) const
+  {
+    return findNode(dataPrefix, sessionNo);
+  }
 
   size_t
   size() const { return digestNode_.size(); }
@@ -134,11 +151,17 @@ public:
   get(size_t i) const { return *digestNode_[i]; }
 
   /**
-   * Get the root digest.
+   * Get the root digest, recomputing it if the tree changed since the last
+   * call.
    * @return The root digest as a hex string.
    */
   const std::string&
-  getRoot() const { return root_; }
+  getRoot() const
+  {
+    if (isRootDirty_)
+      recomputeRoot();
+    return root_;
+  }
 
 private:
   /**
@@ -146,14 +169,28 @@ private:
    * to the hex value of the digest.
    */
   void
-  recomputeRoot();
+  recomputeRoot() const;
 
+  /**
+   * Find the node in index_. This is the same as find(), but returns a
+   * non-const Node for update().
+   */
+  DigestTree::Node*
+  findNode(const std::string& dataPrefix, int sessionNo) const;
+
+  static uint32_t
+  getIndexHash(const std::string& dataPrefix, int sessionNo);
+
+  // The nodes sorted by Node::Compare, which is the order for the root digest.
   std::vector<ptr_lib::shared_ptr<DigestTree::Node> > digestNode_;
-  std::string root_;
+  mutable std::string root_;
+  // True if digestNode_ changed since root_ was computed.
+  mutable bool isRootDirty_;
+  // The hash table of the nodes in digestNode_ by dataPrefix and sessionNo.
+  HashIndex<DigestTree::Node*> index_;
   Node::Compare nodeCompare_;
 };
 
 }
 
 #endif
-
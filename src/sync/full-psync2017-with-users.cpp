@@ -157,9 +157,8 @@ FullPSync2017WithUsers::Impl::isNotFutureHash
 {
   Name prefix = name.getPrefix(-1);
 
-  string uri = Name(prefix).appendNumber(prefixes_->prefixes_[prefix] + 1).toUri();
-  uint32_t nextHash = CryptoLite::murmurHash3
-    (InvertibleBloomLookupTable::N_HASHCHECK, uri.data(), uri.size());
+  uint32_t nextHash = fullPSync_->getNameHash
+    (Name(prefix).appendNumber(prefixes_->prefixes_[prefix] + 1));
 
   for (set<uint32_t>::iterator negativeHash = negative.begin();
        negativeHash != negative.end();
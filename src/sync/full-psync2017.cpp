@@ -71,7 +71,7 @@ FullPSync2017::Impl::initialize()
 void
 FullPSync2017::Impl::publishName(const Name& name)
 {
-  if (nameToHash_.find(name) != nameToHash_.end()) {
+  if (hasName(name)) {
     _LOG_DEBUG("Already published, ignoring: " << name);
     return;
   }
@@ -81,6 +81,18 @@ FullPSync2017::Impl::publishName(const Name& name)
   satisfyPendingInterests();
 }
 
+void
+FullPSync2017::Impl::setNameHashMode(NameHashMode nameHashMode)
+{
+  PSyncProducerBase::setNameHashMode(nameHashMode);
+}
+
+void
+FullPSync2017::Impl::setCompressionLevel(int compressionLevel)
+{
+  iblt_->setCompressionLevel(compressionLevel);
+}
+
 void
 FullPSync2017::Impl::sendSyncInterest()
 {
@@ -96,8 +108,9 @@ FullPSync2017::Impl::sendSyncInterest()
   // Sync Interest format for full sync: /<sync-prefix>/<ourLatestIBF>
   Name syncInterestName(syncPrefix_);
 
-  // Append our latest IBLT.
-  syncInterestName.append(iblt_->encode());
+  // Append our latest IBLT, with the component type which tells the replier
+  // that we can decode the compact encoding of the sync state.
+  syncInterestName.append(PSyncState::makeIbltComponent(iblt_->encode()));
 
   outstandingInterestName_ = syncInterestName;
 
@@ -172,13 +185,13 @@ FullPSync2017::Impl::onSyncInterest
     return;
   }
 
-  ptr_lib::shared_ptr<InvertibleBloomLookupTable> difference =
-   iblt_->difference(*iblt);
+  InvertibleBloomLookupTable difference(0);
+  iblt_->difference(*iblt, difference);
 
-  set<uint32_t> positive;
-  set<uint32_t> negative;
+  vector<uint32_t> positive;
+  vector<uint32_t> negative;
 
-  if (!difference->listEntries(positive, negative)) {
+  if (!difference.peelEntries(positive, negative)) {
     _LOG_TRACE("Cannot decode differences, positive: " << positive.size() <<
             " negative: " << negative.size() << " threshold: " <<
             threshold_);
@@ -189,33 +202,40 @@ FullPSync2017::Impl::onSyncInterest
     if (positive.size() + negative.size() >= threshold_ ||
         (positive.size() == 0 && negative.size() == 0)) {
       PSyncState state1;
-      for (map<Name, uint32_t>::iterator entry = nameToHash_.begin();
-           entry != nameToHash_.end(); ++entry)
-        state1.addContent(entry->first);
+      for (NameList::iterator entry = names_.begin(); entry != names_.end();
+           ++entry)
+        state1.addContent(entry->name_);
 
       if (state1.getContent().size() > 0)
         segmentPublisher_->publish
-          (interest->getName(), interest->getName(), state1.wireEncode(),
+          (interest->getName(), interest->getName(),
+           state1.wireEncode(PSyncState::canDecodeCompact(ibltName)),
            syncReplyFreshnessPeriod_, signingInfo_);
 
       return;
     }
   }
 
+  // The CanAddToSyncData callback takes a set, so only make it if needed.
+  set<uint32_t> negativeSet;
+  if (canAddToSyncData_)
+    negativeSet.insert(negative.begin(), negative.end());
+
   PSyncState state;
-  for (set<uint32_t>::iterator hash = positive.begin(); hash != positive.end();
-       ++hash) {
-    Name name = hashToName_[*hash];
+  for (vector<uint32_t>::iterator hash = positive.begin();
+       hash != positive.end(); ++hash) {
+    const Name* name = findNameByHash(*hash);
 
-    if (nameToHash_.find(name) != nameToHash_.end()) {
-      if (!canAddToSyncData_ || canAddToSyncData_(name, negative))
-        state.addContent(name);
+    if (name) {
+      if (!canAddToSyncData_ || canAddToSyncData_(*name, negativeSet))
+        state.addContent(*name);
     }
   }
 
   if (state.getContent().size() > 0) {
     _LOG_DEBUG("Sending sync content: " << state.toString());
-    sendSyncData(interestName, state.wireEncode());
+    sendSyncData
+      (interestName, state.wireEncode(PSyncState::canDecodeCompact(ibltName)));
     return;
   }
 
@@ -275,16 +295,17 @@ FullPSync2017::Impl::satisfyPendingInterests()
 {
   _LOG_DEBUG("Satisfying full sync Interest: " << pendingEntries_.size());
 
+  // Reuse the scratch difference and results for each pending entry.
+  InvertibleBloomLookupTable difference(0);
+  vector<uint32_t> positive;
+  vector<uint32_t> negative;
+
   for (map<Name, ptr_lib::shared_ptr<PendingEntryInfoFull> >::iterator it =
          pendingEntries_.begin();
        it != pendingEntries_.end();) {
-    const InvertibleBloomLookupTable& entryIblt = *it->second->iblt_;
-    ptr_lib::shared_ptr<InvertibleBloomLookupTable> difference =
-            iblt_->difference(entryIblt);
-    set<uint32_t> positive;
-    set<uint32_t> negative;
+    iblt_->difference(*it->second->iblt_, difference);
 
-    if (!difference->listEntries(positive, negative)) {
+    if (!difference.peelEntries(positive, negative)) {
       _LOG_TRACE("Decode failed for pending interest");
       if (positive.size() + negative.size() >= threshold_ ||
           (positive.size() == 0 && negative.size() == 0)) {
@@ -298,17 +319,19 @@ FullPSync2017::Impl::satisfyPendingInterests()
     }
 
     PSyncState state;
-    for (set<uint32_t>::iterator hash = positive.begin(); hash != positive.end();
-         ++hash) {
-      Name name = hashToName_[*hash];
+    for (vector<uint32_t>::iterator hash = positive.begin();
+         hash != positive.end(); ++hash) {
+      const Name* name = findNameByHash(*hash);
 
-      if (nameToHash_.find(name) != nameToHash_.end())
-        state.addContent(name);
+      if (name)
+        state.addContent(*name);
     }
 
     if (state.getContent().size() > 0) {
       _LOG_DEBUG("Satisfying sync content: " << state.toString());
-      sendSyncData(it->first, state.wireEncode());
+      sendSyncData
+        (it->first,
+         state.wireEncode(PSyncState::canDecodeCompact(it->first.get(-1))));
       // Prevent delayedRemovePendingEntry from removing a new entry with the same Name.
       it->second->isRemoved_ = true;
       pendingEntries_.erase(it++);
@@ -347,7 +370,7 @@ FullPSync2017::Impl::onSyncData
   const std::vector<Name>& content = state.getContent();
   for (vector<Name>::const_iterator contentName = content.begin();
        contentName != content.end(); ++contentName) {
-    if (nameToHash_.find(*contentName) == nameToHash_.end()) {
+    if (!hasName(*contentName)) {
       _LOG_DEBUG("Checking whether to add " << *contentName);
       if (!canAddReceivedName_ || canAddReceivedName_(*contentName)) {
         _LOG_DEBUG("Adding name " << *contentName);
@@ -0,0 +1,278 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2019-2020 Regents of the University of California.
+ * @author: Jeff Thompson <jefft0@remap.ucla.edu>
+ * @author: From the PSync library https://github.com/named-data/PSync/blob/master/PSync/consumer.cpp
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+#include <ndn-cpp/util/logging.hpp>
+#include <ndn-cpp/lite/util/crypto-lite.hpp>
+#include "./detail/bloom-filter.hpp"
+#include "./detail/psync-state.hpp"
+#include <ndn-cpp/sync/partial-psync2017-producer.hpp>
+#include <ndn-cpp/sync/partial-psync-consumer.hpp>
+
+using namespace std;
+using namespace ndn::func_lib;
+
+INIT_LOGGER("ndn.PartialPSyncConsumer");
+
+namespace ndn {
+
+PartialPSyncConsumer::Impl::Impl
+  (Face& face, const Name& syncPrefix,
+   const OnReceiveHelloData& onReceiveHelloData, const OnUpdate& onUpdate,
+   size_t expectedNSubscriptions, double falsePositiveProbability,
+   Milliseconds helloInterestLifetime, Milliseconds syncInterestLifetime)
+: face_(face), syncPrefix_(syncPrefix), onReceiveHelloData_(onReceiveHelloData),
+  onUpdate_(onUpdate),
+  bloomFilter_(new BloomFilter(expectedNSubscriptions, falsePositiveProbability)),
+  helloInterestLifetime_(helloInterestLifetime),
+  syncInterestLifetime_(syncInterestLifetime), syncInterestCount_(0)
+{
+}
+
+void
+PartialPSyncConsumer::Impl::sendHelloInterest()
+{
+  Interest helloInterest(Name(syncPrefix_).append
+    (PartialPSync2017Producer::getHelloComponent()));
+  helloInterest.setInterestLifetimeMilliseconds(helloInterestLifetime_);
+  helloInterest.setCanBePrefix(true);
+  helloInterest.setMustBeFresh(true);
+
+  _LOG_DEBUG("Send hello Interest " << helloInterest.getName());
+
+  ptr_lib::shared_ptr<Name> dataName(new Name());
+  SegmentFetcher::fetch
+    (face_, helloInterest, bind(&PartialPSyncConsumer::Impl::saveDataName, dataName, _1),
+     bind(&PartialPSyncConsumer::Impl::onHelloData, shared_from_this(), _1, dataName),
+     &PartialPSyncConsumer::Impl::onHelloError);
+}
+
+void
+PartialPSyncConsumer::Impl::sendSyncInterest()
+{
+  if (iblt_.getValue().size() == 0) {
+    _LOG_ERROR("sendSyncInterest: Must receive the hello Data first");
+    return;
+  }
+
+  // Sync Interest format for partial sync:
+  // /<sync-prefix>/partial-sync/<Bloom-filter>/<producer-IBLT>
+  Name syncInterestName(syncPrefix_);
+  syncInterestName.append(PartialPSync2017Producer::getSyncComponent());
+  bloomFilter_->appendToName(syncInterestName);
+  // Tell the producer that we can decode the compact encoding of the state.
+  syncInterestName.append(PSyncState::makeIbltComponent(iblt_.getValue()));
+
+  Interest syncInterest(syncInterestName);
+  syncInterest.setInterestLifetimeMilliseconds(syncInterestLifetime_);
+  syncInterest.setCanBePrefix(true);
+  syncInterest.setMustBeFresh(true);
+
+  // Ignore the reply or error for a sync Interest that we sent before.
+  ++syncInterestCount_;
+
+  _LOG_DEBUG("sendSyncInterest, hash: " << syncInterestName.hash());
+
+  ptr_lib::shared_ptr<Name> dataName(new Name());
+  SegmentFetcher::fetch
+    (face_, syncInterest, bind(&PartialPSyncConsumer::Impl::saveDataName, dataName, _1),
+     bind(&PartialPSyncConsumer::Impl::onSyncData, shared_from_this(), _1,
+          dataName, syncInterestCount_),
+     bind(&PartialPSyncConsumer::Impl::onSyncError, shared_from_this(), _1, _2,
+          syncInterestCount_));
+}
+
+bool
+PartialPSyncConsumer::Impl::addSubscription(const Name& prefix, int sequenceNo)
+{
+  if (isSubscribed(prefix))
+    return false;
+
+  if (sequenceNo < 0) {
+    map<Name, int>::iterator available = availableSubscriptions_.find(prefix);
+    sequenceNo = (available != availableSubscriptions_.end() ?
+                  available->second : 0);
+  }
+
+  _LOG_DEBUG("Subscribe: " << prefix << " from sequence number " << sequenceNo);
+  subscriptions_[prefix] = sequenceNo;
+  bloomFilter_->insert(prefix);
+  return true;
+}
+
+void
+PartialPSyncConsumer::Impl::removeSubscription(const Name& prefix)
+{
+  if (subscriptions_.erase(prefix) == 0)
+    return;
+
+  // We can't remove from a Bloom filter, so make it again.
+  bloomFilter_->clear();
+  for (map<Name, int>::iterator subscription = subscriptions_.begin();
+       subscription != subscriptions_.end(); ++subscription)
+    bloomFilter_->insert(subscription->first);
+}
+
+int
+PartialPSyncConsumer::Impl::getSequenceNo(const Name& prefix) const
+{
+  map<Name, int>::const_iterator subscription = subscriptions_.find(prefix);
+  if (subscription == subscriptions_.end())
+    return -1;
+
+  return subscription->second;
+}
+
+bool
+PartialPSyncConsumer::Impl::saveDataName
+  (const ptr_lib::shared_ptr<Name>& dataName,
+   const ptr_lib::shared_ptr<Data>& data)
+{
+  *dataName = data->getName();
+  return true;
+}
+
+void
+PartialPSyncConsumer::Impl::onHelloData
+  (const Blob& content, const ptr_lib::shared_ptr<Name>& dataName)
+{
+  if (!setIbltFromDataName(*dataName))
+    return;
+
+  PSyncState state(content);
+  _LOG_DEBUG("Hello Data received: " << state.toString());
+
+  ptr_lib::shared_ptr<vector<Name>> prefixes
+    (ptr_lib::make_shared<vector<Name>>());
+  availableSubscriptions_.clear();
+  const vector<Name>& names = state.getContent();
+  for (vector<Name>::const_iterator name = names.begin();
+       name != names.end(); ++name) {
+    Name prefix = name->getPrefix(-1);
+    availableSubscriptions_[prefix] = (int)name->get(-1).toNumber();
+    prefixes->push_back(prefix);
+  }
+
+  try {
+    onReceiveHelloData_(prefixes);
+  } catch (const std::exception& ex) {
+    _LOG_ERROR("Error in onReceiveHelloData: " << ex.what());
+  } catch (...) {
+    _LOG_ERROR("Error in onReceiveHelloData.");
+  }
+}
+
+void
+PartialPSyncConsumer::Impl::onSyncData
+  (const Blob& content, const ptr_lib::shared_ptr<Name>& dataName,
+   uint64_t syncInterestCount)
+{
+  if (syncInterestCount != syncInterestCount_)
+    // We already sent a new sync Interest.
+    return;
+  if (!setIbltFromDataName(*dataName))
+    return;
+
+  PSyncState state(content);
+  _LOG_DEBUG("Sync Data received: " << state.toString());
+
+  ptr_lib::shared_ptr<vector<ptr_lib::shared_ptr<PSyncMissingDataInfo>>> updates
+    (ptr_lib::make_shared<vector<ptr_lib::shared_ptr<PSyncMissingDataInfo>>>());
+  const vector<Name>& names = state.getContent();
+  for (vector<Name>::const_iterator name = names.begin();
+       name != names.end(); ++name) {
+    map<Name, int>::iterator subscription =
+      subscriptions_.find(name->getPrefix(-1));
+    if (subscription == subscriptions_.end())
+      // A false positive in the Bloom filter.
+      continue;
+
+    int sequenceNo = (int)name->get(-1).toNumber();
+    if (sequenceNo > subscription->second) {
+      updates->push_back(ptr_lib::make_shared<PSyncMissingDataInfo>
+        (subscription->first, subscription->second + 1, sequenceNo));
+      subscription->second = sequenceNo;
+    }
+  }
+
+  if (updates->size() > 0) {
+    try {
+      onUpdate_(updates);
+    } catch (const std::exception& ex) {
+      _LOG_ERROR("Error in onUpdate: " << ex.what());
+    } catch (...) {
+      _LOG_ERROR("Error in onUpdate.");
+    }
+  }
+
+  sendSyncInterest();
+}
+
+void
+PartialPSyncConsumer::Impl::onHelloError
+  (SegmentFetcher::ErrorCode errorCode, const std::string& message)
+{
+  _LOG_TRACE("Cannot fetch hello data, error: " << errorCode <<
+             " message: " << message);
+}
+
+void
+PartialPSyncConsumer::Impl::onSyncError
+  (SegmentFetcher::ErrorCode errorCode, const std::string& message,
+   uint64_t syncInterestCount)
+{
+  if (syncInterestCount != syncInterestCount_)
+    return;
+
+  _LOG_TRACE("Cannot fetch sync data, error: " << errorCode <<
+             " message: " << message);
+
+  // random1 is from 0.0 to 1.0.
+  float random1;
+  CryptoLite::generateRandomFloat(random1);
+  // Retry after 100 to 500 milliseconds, as in the PSync library.
+  face_.callLater
+    (100 + random1 * 400,
+     bind(&PartialPSyncConsumer::Impl::retrySyncInterest, shared_from_this(),
+          syncInterestCount));
+}
+
+void
+PartialPSyncConsumer::Impl::retrySyncInterest(uint64_t syncInterestCount)
+{
+  if (syncInterestCount == syncInterestCount_)
+    sendSyncInterest();
+}
+
+bool
+PartialPSyncConsumer::Impl::setIbltFromDataName(const Name& dataName)
+{
+  // The name is /.../<IBLT>/<version>/<segment-no> .
+  if (dataName.size() < syncPrefix_.size() + 4) {
+    _LOG_ERROR("The Data name does not have the IBLT: " << dataName);
+    return false;
+  }
+
+  iblt_ = dataName.get(-3);
+  return true;
+}
+
+}
@@ -0,0 +1,317 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2019-2020 Regents of the University of California.
+ * @author: Jeff Thompson <jefft0@remap.ucla.edu>
+ * @author: From the PSync library https://github.com/named-data/PSync/blob/master/PSync/partial-producer.cpp
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+// Only compile if ndn-cpp-config.h defines NDN_CPP_HAVE_LIBZ 1.
+#include <ndn-cpp/ndn-cpp-config.h>
+#if NDN_CPP_HAVE_LIBZ
+
+#include <ndn-cpp/util/logging.hpp>
+#include "./detail/invertible-bloom-lookup-table.hpp"
+#include "./detail/bloom-filter.hpp"
+#include "./detail/psync-state.hpp"
+#include "./detail/psync-segment-publisher.hpp"
+#include "./detail/psync-user-prefixes.hpp"
+#include <ndn-cpp/sync/partial-psync2017-producer.hpp>
+
+using namespace std;
+using namespace ndn::func_lib;
+
+INIT_LOGGER("ndn.PartialPSync2017Producer");
+
+namespace ndn {
+
+PartialPSync2017Producer::Impl::Impl
+  (size_t expectedNEntries, Face& face, const Name& syncPrefix,
+   KeyChain& keyChain, Milliseconds helloReplyFreshnessPeriod,
+   Milliseconds syncReplyFreshnessPeriod, const SigningInfo& signingInfo)
+: PSyncProducerBase(expectedNEntries, syncPrefix, syncReplyFreshnessPeriod),
+  face_(face), keyChain_(keyChain), signingInfo_(signingInfo),
+  helloReplyFreshnessPeriod_(helloReplyFreshnessPeriod),
+  segmentPublisher_(new PSyncSegmentPublisher(face_, keyChain_)),
+  prefixes_(new PSyncUserPrefixes())
+{
+}
+
+void
+PartialPSync2017Producer::Impl::initialize(const Name& userPrefix)
+{
+  if (userPrefix.size() > 0)
+    addUserNode(userPrefix);
+
+  registeredPrefix_ = face_.registerPrefix
+    (syncPrefix_,
+     bind(&PartialPSync2017Producer::Impl::onInterest,
+          static_pointer_cast<PartialPSync2017Producer::Impl>(shared_from_this()),
+          _1, _2, _3, _4, _5),
+     &PSyncProducerBase::onRegisterFailed);
+}
+
+int
+PartialPSync2017Producer::Impl::getSequenceNo(const Name& prefix) const
+{
+  return prefixes_->getSequenceNo(prefix);
+}
+
+bool
+PartialPSync2017Producer::Impl::addUserNode(const Name& prefix)
+{
+  return prefixes_->addUserNode(prefix);
+}
+
+void
+PartialPSync2017Producer::Impl::removeUserNode(const Name& prefix)
+{
+  if (prefixes_->isUserNode(prefix)) {
+    int sequenceNo = prefixes_->prefixes_[prefix];
+    prefixes_->removeUserNode(prefix);
+    removeFromIblt(Name(prefix).appendNumber(sequenceNo));
+  }
+}
+
+void
+PartialPSync2017Producer::Impl::publishName(const Name& prefix, int sequenceNo)
+{
+  if (!prefixes_->isUserNode(prefix)) {
+    _LOG_ERROR("Prefix not added: " << prefix);
+    return;
+  }
+
+  int newSequenceNo = sequenceNo >= 0 ? sequenceNo : prefixes_->prefixes_[prefix] + 1;
+
+  _LOG_INFO("Publish: " << prefix << "/" << newSequenceNo);
+  int oldSequenceNo;
+  if (!prefixes_->updateSequenceNo(prefix, newSequenceNo, oldSequenceNo))
+    return;
+
+  // We don't insert a prefix with sequence number zero in the IBLT.
+  if (oldSequenceNo != 0)
+    removeFromIblt(Name(prefix).appendNumber(oldSequenceNo));
+  insertIntoIblt(Name(prefix).appendNumber(newSequenceNo));
+
+  satisfyPendingSyncInterests(prefix, newSequenceNo);
+}
+
+void
+PartialPSync2017Producer::Impl::setNameHashMode(NameHashMode nameHashMode)
+{
+  PSyncProducerBase::setNameHashMode(nameHashMode);
+}
+
+void
+PartialPSync2017Producer::Impl::setCompressionLevel(int compressionLevel)
+{
+  iblt_->setCompressionLevel(compressionLevel);
+}
+
+void
+PartialPSync2017Producer::Impl::onInterest
+  (const ptr_lib::shared_ptr<const Name>& prefixName,
+   const ptr_lib::shared_ptr<const Interest>& interest, Face& face,
+   uint64_t interestFilterId,
+   const ptr_lib::shared_ptr<const InterestFilter>& filter)
+{
+  if (segmentPublisher_->replyFromStore(interest->getName()))
+    return;
+
+  const Name& name = interest->getName();
+  if (name.size() <= syncPrefix_.size())
+    return;
+  const Name::Component& operation = name.get(syncPrefix_.size());
+  size_t nAfterOperation = name.size() - syncPrefix_.size() - 1;
+
+  if (operation.equals(getHelloComponent())) {
+    // A hello Interest for a segment which is no longer in the store has a
+    // version which we can't reply with, so ignore it.
+    if (nAfterOperation == 0)
+      onHelloInterest(*interest);
+  }
+  else if (operation.equals(getSyncComponent())) {
+    // The name is /<sync-prefix>/partial-sync/<Bloom-filter>/<IBLT> or
+    // /<sync-prefix>/partial-sync/<Bloom-filter>/<IBLT>/<version>/<segment-no> .
+    if (nAfterOperation == BloomFilter::N_NAME_COMPONENTS + 1)
+      onSyncInterest(*interest, name);
+    else if (nAfterOperation == BloomFilter::N_NAME_COMPONENTS + 3)
+      onSyncInterest(*interest, name.getPrefix(-2));
+  }
+}
+
+void
+PartialPSync2017Producer::Impl::onHelloInterest(const Interest& interest)
+{
+  _LOG_DEBUG("Hello Interest received, nonce: " << interest.getNonce().toHex());
+
+  PSyncState state;
+  for (map<Name, int>::iterator prefix = prefixes_->prefixes_.begin();
+       prefix != prefixes_->prefixes_.end(); ++prefix)
+    state.addContent(Name(prefix->first).appendNumber(prefix->second));
+
+  Name helloDataName(interest.getName());
+  helloDataName.append(iblt_->encode());
+
+  segmentPublisher_->publish
+    (interest.getName(), helloDataName, state.wireEncode(),
+     helloReplyFreshnessPeriod_, signingInfo_);
+}
+
+void
+PartialPSync2017Producer::Impl::onSyncInterest
+  (const Interest& interest, const Name& interestName)
+{
+  _LOG_DEBUG("Partial Sync Interest received, nonce: " <<
+             interest.getNonce().toHex() << ", hash: " << interestName.hash());
+
+  ptr_lib::shared_ptr<BloomFilter> bloomFilter;
+  ptr_lib::shared_ptr<InvertibleBloomLookupTable> iblt
+    (new InvertibleBloomLookupTable(expectedNEntries_));
+  try {
+    bloomFilter.reset(new BloomFilter(interestName.getPrefix(-1)));
+    iblt->initialize(interestName.get(-1).getValue());
+  } catch (const std::exception& ex) {
+    _LOG_ERROR(ex.what());
+    return;
+  }
+
+  InvertibleBloomLookupTable difference(0);
+  iblt_->difference(*iblt, difference);
+
+  vector<uint32_t> positive;
+  vector<uint32_t> negative;
+  PSyncState state;
+
+  if (!difference.peelEntries(positive, negative)) {
+    _LOG_TRACE("Cannot decode differences, sending all subscribed names");
+    // Send the latest name of each subscribed prefix so that the consumer
+    // can catch up with the IBLT in the Data name.
+    for (map<Name, int>::iterator prefix = prefixes_->prefixes_.begin();
+         prefix != prefixes_->prefixes_.end(); ++prefix) {
+      if (prefix->second != 0 && bloomFilter->contains(prefix->first))
+        state.addContent(Name(prefix->first).appendNumber(prefix->second));
+    }
+  }
+  else {
+    for (vector<uint32_t>::iterator hash = positive.begin();
+         hash != positive.end(); ++hash) {
+      const Name* name = findNameByHash(*hash);
+      if (name && bloomFilter->contains(name->getPrefix(-1)))
+        state.addContent(*name);
+    }
+  }
+
+  if (state.getContent().size() > 0) {
+    _LOG_DEBUG("Sending sync content: " << state.toString());
+    sendSyncData
+      (interestName,
+       state.wireEncode(PSyncState::canDecodeCompact(interestName.get(-1))));
+    return;
+  }
+
+  ptr_lib::shared_ptr<PendingEntryInfo> entry
+    (new PendingEntryInfo(bloomFilter, iblt));
+  pendingEntries_[interestName] = entry;
+  face_.callLater
+    (interest.getInterestLifetimeMilliseconds(),
+     bind(&PartialPSync2017Producer::Impl::delayedRemovePendingEntry,
+          static_pointer_cast<PartialPSync2017Producer::Impl>(shared_from_this()),
+          interestName, entry));
+}
+
+void
+PartialPSync2017Producer::Impl::sendSyncData
+  (const Name& interestName, Blob content)
+{
+  Name dataName(interestName);
+  dataName.append(iblt_->encode());
+
+  segmentPublisher_->publish
+    (interestName, dataName, content, syncReplyFreshnessPeriod_, signingInfo_);
+}
+
+void
+PartialPSync2017Producer::Impl::satisfyPendingSyncInterests
+  (const Name& prefix, int sequenceNo)
+{
+  if (pendingEntries_.size() == 0)
+    return;
+
+  _LOG_DEBUG("Satisfying partial sync Interests: " << pendingEntries_.size());
+
+  // Hash the prefix once for all the Bloom filters.
+  uint32_t h1, h2;
+  BloomFilter::getHashes(prefix, h1, h2);
+  // Encode the content once for each encoding.
+  Blob content;
+  Blob compactContent;
+
+  for (map<Name, ptr_lib::shared_ptr<PendingEntryInfo> >::iterator it =
+         pendingEntries_.begin();
+       it != pendingEntries_.end();) {
+    if (it->second->bloomFilter_->contains(h1, h2)) {
+      bool isCompact = PSyncState::canDecodeCompact(it->first.get(-1));
+      Blob& encoding = (isCompact ? compactContent : content);
+      if (encoding.isNull()) {
+        PSyncState state;
+        state.addContent(Name(prefix).appendNumber(sequenceNo));
+        encoding = state.wireEncode(isCompact);
+      }
+
+      _LOG_DEBUG("Satisfying sync Interest for " << prefix << "/" << sequenceNo);
+      sendSyncData(it->first, encoding);
+      // Prevent delayedRemovePendingEntry from removing a new entry with the same Name.
+      it->second->isRemoved_ = true;
+      pendingEntries_.erase(it++);
+    }
+    else
+      ++it;
+  }
+}
+
+void
+PartialPSync2017Producer::Impl::delayedRemovePendingEntry
+  (const Name& name, const ptr_lib::shared_ptr<PendingEntryInfo>& entry)
+{
+  if (entry->isRemoved_)
+    // A previous operation already removed this entry, so don't try again to
+    // remove the entry with the Name in case it is a new entry.
+    return;
+
+  _LOG_TRACE("Remove Pending Interest " << name.hash());
+  entry->isRemoved_ = true;
+  pendingEntries_.erase(name);
+}
+
+const Name::Component&
+PartialPSync2017Producer::getHelloComponent()
+{
+  static Name::Component helloComponent("partial-hello");
+  return helloComponent;
+}
+
+const Name::Component&
+PartialPSync2017Producer::getSyncComponent()
+{
+  static Name::Component syncComponent("partial-sync");
+  return syncComponent;
+}
+
+}
+
+#endif // NDN_CPP_HAVE_LIBZ
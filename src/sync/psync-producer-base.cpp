@@ -24,8 +24,11 @@
 #include <ndn-cpp/ndn-cpp-config.h>
 #if NDN_CPP_HAVE_LIBZ
 
+#include <stdexcept>
 #include <ndn-cpp/util/logging.hpp>
+#include <ndn-cpp/encoding/tlv-wire-format.hpp>
 #include <ndn-cpp/lite/util/crypto-lite.hpp>
+#include "../util/hash-index.hpp"
 #include "./detail/invertible-bloom-lookup-table.hpp"
 #include <ndn-cpp/sync/psync-producer-base.hpp>
 
@@ -42,33 +45,103 @@ PSyncProducerBase::PSyncProducerBase
   expectedNEntries_(expectedNEntries),
   threshold_(expectedNEntries / 2),
   syncPrefix_(syncPrefix),
-  syncReplyFreshnessPeriod_(syncReplyFreshnessPeriod)
+  syncReplyFreshnessPeriod_(syncReplyFreshnessPeriod),
+  nameHashMode_(NAME_HASH_URI),
+  nameIndex_(new HashIndex<NameList::iterator>(expectedNEntries)),
+  hashIndex_(new HashIndex<NameList::iterator>(expectedNEntries))
 {
 }
 
+void
+PSyncProducerBase::setNameHashMode(NameHashMode nameHashMode)
+{
+  if (names_.size() > 0)
+    throw runtime_error
+      ("PSyncProducerBase: Cannot change the name hash mode after inserting names");
+
+  nameHashMode_ = nameHashMode;
+}
+
+uint32_t
+PSyncProducerBase::getNameHash(const Name& name) const
+{
+  if (nameHashMode_ == NAME_HASH_WIRE_ENCODING) {
+    Blob encoding = name.wireEncode(*TlvWireFormat::get());
+    return CryptoLite::murmurHash3
+      (InvertibleBloomLookupTable::N_HASHCHECK, encoding.buf(), encoding.size());
+  }
+  else {
+    string uri = name.toUri();
+    return CryptoLite::murmurHash3
+      (InvertibleBloomLookupTable::N_HASHCHECK, uri.data(), uri.size());
+  }
+}
+
 void
 PSyncProducerBase::insertIntoIblt(const Name& name)
 {
-  string uri = name.toUri();
-  uint32_t newHash = CryptoLite::murmurHash3
-    (InvertibleBloomLookupTable::N_HASHCHECK, uri.data(), uri.size());
-  nameToHash_[name] = newHash;
-  hashToName_[newHash] = name;
+  if (findByName(name) != names_.end())
+    return;
+
+  uint32_t newHash = getNameHash(name);
+  names_.push_back(NameEntry(name, newHash));
+  NameList::iterator entry = --names_.end();
+  nameIndex_->insert(name.hash(), entry);
+  hashIndex_->insert(newHash, entry);
   iblt_->insert(newHash);
 }
 
 void
 PSyncProducerBase::removeFromIblt(const Name& name)
 {
-  map<Name, uint32_t>::iterator hashEntry = nameToHash_.find(name);
-  if (hashEntry != nameToHash_.end()) {
-    uint32_t hash = hashEntry->second;
-    nameToHash_.erase(hashEntry);
-    hashToName_.erase(hash);
+  NameList::iterator entry = findByName(name);
+  if (entry != names_.end()) {
+    uint32_t hash = entry->hash_;
+    nameIndex_->erase(name.hash(), entry);
+    hashIndex_->erase(hash, entry);
+    names_.erase(entry);
     iblt_->erase(hash);
   }
 }
 
+const Name*
+PSyncProducerBase::findNameByHash(uint32_t hash) const
+{
+  const HashIndex<NameList::iterator>::Bucket& bucket = hashIndex_->getBucket(hash);
+  for (size_t i = 0; i < bucket.size(); ++i) {
+    if (bucket[i].hash_ == hash)
+      return &bucket[i].value_->name_;
+  }
+
+  return 0;
+}
+
+PSyncProducerBase::NameList::iterator
+PSyncProducerBase::findByName(const Name& name)
+{
+  size_t hash = name.hash();
+  const HashIndex<NameList::iterator>::Bucket& bucket = nameIndex_->getBucket(hash);
+  for (size_t i = 0; i < bucket.size(); ++i) {
+    if (bucket[i].hash_ == hash && bucket[i].value_->name_.equals(name))
+      return bucket[i].value_;
+  }
+
+  return names_.end();
+}
+
+PSyncProducerBase::NameList::const_iterator
+PSyncProducerBase::findByName(const Name& name) const
+{
+  size_t hash = name.hash();
+  const HashIndex<NameList::iterator>::Bucket& bucket = nameIndex_->getBucket(hash);
+  for (size_t i = 0; i < bucket.size(); ++i) {
+    if (bucket[i].hash_ == hash && bucket[i].value_->name_.equals(name))
+      return bucket[i].value_;
+  }
+
+  return names_.end();
+}
+
 void
 PSyncProducerBase::onRegisterFailed(const ptr_lib::shared_ptr<const Name>& prefix)
 {
@@ -0,0 +1,110 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Regents of the University of California.
+ * @author: Jeff Thompson <jefft0@remap.ucla.edu>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+#ifndef NDN_BEST_MATCH_HPP
+#define NDN_BEST_MATCH_HPP
+
+#include <ndn-cpp/interest.hpp>
+
+namespace ndn {
+
+/**
+ * IsFreshAt is the usual isFresh accessor for findBestMatchInIndex. It calls
+ * isFresh(nowMilliseconds) on the value in the index.
+ */
+class IsFreshAt {
+public:
+  /**
+   * Create an IsFreshAt for the given time.
+   * @param nowMilliseconds The current time in milliseconds from
+   * ndn_getNowMilliseconds.
+   */
+  IsFreshAt(MillisecondsSince1970 nowMilliseconds)
+  : nowMilliseconds_(nowMilliseconds)
+  {}
+
+  template<class Value> bool
+  operator()(const Value& value) const
+  {
+    return value.isFresh(nowMilliseconds_);
+  }
+
+private:
+  MillisecondsSince1970 nowMilliseconds_;
+};
+
+/**
+ * Find the entry in the name index which best matches the interest, using the
+ * name order to find the range of names with the interest name as a prefix,
+ * then checking the selectors of each entry in the range. If the interest has
+ * a rightmost ChildSelector, search the range backwards.
+ * @tparam NameIndex A std::map or std::multimap whose key is the Name.
+ * @tparam IsFresh The type of isFresh.
+ * @param index The name index.
+ * @param interest The Interest to match.
+ * @param isFresh If the Interest has MustBeFresh, this calls isFresh(value)
+ * with the value of each entry which otherwise matches. It should return true
+ * if the Data is still fresh. This is usually IsFreshAt(nowMilliseconds).
+ * @return The matching entry in index, or index.end() if not found.
+ */
+template<class NameIndex, class IsFresh>
+typename NameIndex::const_iterator
+findBestMatchInIndex
+  (const NameIndex& index, const Interest& interest, const IsFresh& isFresh)
+{
+  typedef typename NameIndex::const_iterator const_iterator;
+
+  const Name& interestName = interest.getName();
+  // All names with interestName as a prefix are contiguous in the canonical
+  // order, starting with interestName itself (if present).
+  const_iterator begin = index.lower_bound(interestName);
+  const_iterator end;
+  if (interestName.size() == 0)
+    // Every name has the empty name as a prefix.
+    end = index.end();
+  else
+    end = index.lower_bound(interestName.getSuccessor());
+
+  // With the canonical order, the child component at interestName.size()
+  // increases through the range, so the first match searching forward is a
+  // leftmost child and the first match searching backward is a rightmost child.
+  if (interest.getChildSelector() == 1) {
+    for (const_iterator i = end; i != begin; ) {
+      --i;
+      if (interest.matchesName(i->first) &&
+          !(interest.getMustBeFresh() && !isFresh(i->second)))
+        return i;
+    }
+  }
+  else {
+    for (const_iterator i = begin; i != end; ++i) {
+      if (interest.matchesName(i->first) &&
+          !(interest.getMustBeFresh() && !isFresh(i->second)))
+        return i;
+    }
+  }
+
+  return index.end();
+}
+
+}
+
+#endif
@@ -0,0 +1,147 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Regents of the University of California.
+ * @author: Jeff Thompson <jefft0@remap.ucla.edu>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+#include <algorithm>
+#include <ndn-cpp/util/cache-eviction-policy-arc.hpp>
+
+using namespace std;
+
+namespace ndn {
+
+void
+CacheEvictionPolicyArc::doInsert(const Name& name, size_t nBytes)
+{
+  map<Name, Entry>::iterator ghost = entries_.find(name);
+  if (ghost != entries_.end()) {
+    // insert() has already called doErase, so this is in B1 or B2. Adapt the
+    // target size of T1 in proportion to the relative sizes of the ghost lists.
+    if (ghost->second.listType_ == B1) {
+      size_t delta = nBytes;
+      if (listBytes_[B1] > 0)
+        delta = max
+          (delta, (size_t)((double)nBytes * listBytes_[B2] / listBytes_[B1]));
+      t1TargetBytes_ = min(getMaxBytes(), t1TargetBytes_ + delta);
+    }
+    else {
+      size_t delta = nBytes;
+      if (listBytes_[B2] > 0)
+        delta = max
+          (delta, (size_t)((double)nBytes * listBytes_[B1] / listBytes_[B2]));
+      t1TargetBytes_ = (t1TargetBytes_ > delta ? t1TargetBytes_ - delta : 0);
+    }
+
+    // The entry was used before, so put it in T2.
+    listBytes_[ghost->second.listType_] -= ghost->second.nBytes_;
+    ghost->second.nBytes_ = nBytes;
+    listBytes_[ghost->second.listType_] += nBytes;
+    moveTo(ghost->second, T2);
+  }
+  else {
+    Entry& entry = entries_[name];
+    entry.listType_ = T1;
+    entry.nBytes_ = nBytes;
+    entry.position_ = lists_[T1].insert(lists_[T1].end(), name);
+    listBytes_[T1] += nBytes;
+  }
+
+  trimGhosts();
+}
+
+void
+CacheEvictionPolicyArc::doAccess(const Name& name)
+{
+  map<Name, Entry>::iterator entry = entries_.find(name);
+  if (entry == entries_.end() ||
+      !(entry->second.listType_ == T1 || entry->second.listType_ == T2))
+    return;
+
+  moveTo(entry->second, T2);
+}
+
+size_t
+CacheEvictionPolicyArc::doErase(const Name& name)
+{
+  map<Name, Entry>::iterator entry = entries_.find(name);
+  if (entry == entries_.end() ||
+      !(entry->second.listType_ == T1 || entry->second.listType_ == T2))
+    // Leave a ghost entry so that it can adapt t1TargetBytes_.
+    return 0;
+
+  size_t nBytes = entry->second.nBytes_;
+  remove(entry);
+  return nBytes;
+}
+
+bool
+CacheEvictionPolicyArc::doEvict(Name& name, size_t& nBytes)
+{
+  ListType from;
+  if (lists_[T1].size() > 0 &&
+      (listBytes_[T1] > t1TargetBytes_ || lists_[T2].size() == 0))
+    from = T1;
+  else if (lists_[T2].size() > 0)
+    from = T2;
+  else
+    return false;
+
+  name = lists_[from].front();
+  Entry& entry = entries_[name];
+  nBytes = entry.nBytes_;
+  // Remember the evicted name in the ghost list.
+  moveTo(entry, from == T1 ? B1 : B2);
+  trimGhosts();
+  return true;
+}
+
+void
+CacheEvictionPolicyArc::moveTo(Entry& entry, ListType listType)
+{
+  lists_[listType].splice
+    (lists_[listType].end(), lists_[entry.listType_], entry.position_);
+  listBytes_[entry.listType_] -= entry.nBytes_;
+  listBytes_[listType] += entry.nBytes_;
+  entry.listType_ = listType;
+}
+
+void
+CacheEvictionPolicyArc::remove(map<Name, Entry>::iterator entry)
+{
+  lists_[entry->second.listType_].erase(entry->second.position_);
+  listBytes_[entry->second.listType_] -= entry->second.nBytes_;
+  entries_.erase(entry);
+}
+
+void
+CacheEvictionPolicyArc::trimGhosts()
+{
+  size_t maxBytes = getMaxBytes();
+  while (lists_[B1].size() > 0 && listBytes_[T1] + listBytes_[B1] > maxBytes)
+    remove(entries_.find(lists_[B1].front()));
+
+  while ((lists_[B1].size() > 0 || lists_[B2].size() > 0) &&
+         listBytes_[T1] + listBytes_[T2] + listBytes_[B1] + listBytes_[B2] >
+           2 * maxBytes) {
+    ListType from = (lists_[B2].size() > 0 ? B2 : B1);
+    remove(entries_.find(lists_[from].front()));
+  }
+}
+
+}
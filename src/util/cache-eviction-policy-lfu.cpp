@@ -0,0 +1,85 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Regents of the University of California.
+ * @author: Jeff Thompson <jefft0@remap.ucla.edu>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+#include <ndn-cpp/util/cache-eviction-policy-lfu.hpp>
+
+using namespace std;
+
+namespace ndn {
+
+void
+CacheEvictionPolicyLfu::doInsert(const Name& name, size_t nBytes)
+{
+  Entry& entry = entries_[name];
+  entry.nBytes_ = nBytes;
+  entry.useCount_ = 1;
+  list<Name>& names = byUseCount_[1];
+  entry.position_ = names.insert(names.end(), name);
+}
+
+void
+CacheEvictionPolicyLfu::doAccess(const Name& name)
+{
+  map<Name, Entry>::iterator entry = entries_.find(name);
+  if (entry == entries_.end())
+    return;
+
+  removeFromUseCount(entry->second);
+  ++entry->second.useCount_;
+  list<Name>& names = byUseCount_[entry->second.useCount_];
+  entry->second.position_ = names.insert(names.end(), name);
+}
+
+size_t
+CacheEvictionPolicyLfu::doErase(const Name& name)
+{
+  map<Name, Entry>::iterator entry = entries_.find(name);
+  if (entry == entries_.end())
+    return 0;
+
+  size_t nBytes = entry->second.nBytes_;
+  removeFromUseCount(entry->second);
+  entries_.erase(entry);
+  return nBytes;
+}
+
+bool
+CacheEvictionPolicyLfu::doEvict(Name& name, size_t& nBytes)
+{
+  if (byUseCount_.size() == 0)
+    return false;
+
+  // The first list has the lowest use count and is never empty.
+  name = byUseCount_.begin()->second.front();
+  nBytes = doErase(name);
+  return true;
+}
+
+void
+CacheEvictionPolicyLfu::removeFromUseCount(const Entry& entry)
+{
+  map<uint64_t, list<Name> >::iterator names = byUseCount_.find(entry.useCount_);
+  names->second.erase(entry.position_);
+  if (names->second.size() == 0)
+    byUseCount_.erase(names);
+}
+
+}
@@ -0,0 +1,72 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Regents of the University of California.
+ * @author: Jeff Thompson <jefft0@remap.ucla.edu>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+#include <ndn-cpp/util/cache-eviction-policy-lru.hpp>
+
+using namespace std;
+
+namespace ndn {
+
+void
+CacheEvictionPolicyLru::doInsert(const Name& name, size_t nBytes)
+{
+  Entry& entry = entries_[name];
+  entry.nBytes_ = nBytes;
+  entry.position_ = leastRecentlyUsed_.insert(leastRecentlyUsed_.end(), name);
+}
+
+void
+CacheEvictionPolicyLru::doAccess(const Name& name)
+{
+  map<Name, Entry>::iterator entry = entries_.find(name);
+  if (entry == entries_.end())
+    return;
+
+  // Move to the most recently used end.
+  leastRecentlyUsed_.splice
+    (leastRecentlyUsed_.end(), leastRecentlyUsed_, entry->second.position_);
+}
+
+size_t
+CacheEvictionPolicyLru::doErase(const Name& name)
+{
+  map<Name, Entry>::iterator entry = entries_.find(name);
+  if (entry == entries_.end())
+    return 0;
+
+  size_t nBytes = entry->second.nBytes_;
+  leastRecentlyUsed_.erase(entry->second.position_);
+  entries_.erase(entry);
+  return nBytes;
+}
+
+bool
+CacheEvictionPolicyLru::doEvict(Name& name, size_t& nBytes)
+{
+  if (leastRecentlyUsed_.size() == 0)
+    return false;
+
+  name = leastRecentlyUsed_.front();
+  nBytes = doErase(name);
+  return true;
+}
+
+}
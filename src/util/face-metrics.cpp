@@ -0,0 +1,71 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Regents of the University of California.
+ * @author: Jeff Thompson <jefft0@remap.ucla.edu>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+#include <sstream>
+#include <ndn-cpp/util/face-metrics.hpp>
+
+using namespace std;
+
+namespace ndn {
+
+uint64_t
+FaceMetrics::getNetworkNackCount() const
+{
+  uint64_t result = 0;
+  for (size_t i = 0; i < N_NACK_REASONS; ++i)
+    result += nNetworkNacks_[i];
+  return result;
+}
+
+static void
+printHistogram
+  (ostringstream& result, const string& label,
+   const LatencyHistogram& histogram)
+{
+  result << " " << label << "(us) count=" << histogram.getCount() <<
+    " p50=" << histogram.getValueAtPercentile(50.0) <<
+    " p99=" << histogram.getValueAtPercentile(99.0) <<
+    " max=" << histogram.getMax();
+}
+
+string
+FaceMetrics::toString() const
+{
+  ostringstream result;
+  result << "interestsSent=" << nInterestsSent_ <<
+    " dataReceived=" << nDataReceived_ <<
+    " timeouts=" << nTimeouts_ <<
+    " nacks=" << getNetworkNackCount() <<
+    " (congestion=" << nNetworkNacks_[1] <<
+    " duplicate=" << nNetworkNacks_[2] <<
+    " noRoute=" << nNetworkNacks_[3] << ")" <<
+    " bytesSent=" << nBytesSent_ <<
+    " bytesReceived=" << nBytesReceived_ <<
+    " pendingInterests=" << nPendingInterests_ <<
+    " interestFilters=" << nInterestFilters_ <<
+    " delayedCalls=" << nDelayedCalls_;
+  printHistogram(result, "rtt", rttHistogram_);
+  printHistogram(result, "callback", callbackHistogram_);
+
+  return result.str();
+}
+
+}
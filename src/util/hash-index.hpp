@@ -0,0 +1,180 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Regents of the University of California.
+ * @author: Jeff Thompson <jefft0@remap.ucla.edu>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+#ifndef NDN_HASH_INDEX_HPP
+#define NDN_HASH_INDEX_HPP
+
+#include <vector>
+#include <ndn-cpp/common.hpp>
+
+namespace ndn {
+
+/**
+ * A HashIndex is a hash table which indexes values held in another container,
+ * such as an iterator into a std::list or a position in a std::deque. The
+ * caller supplies the hash of each value's key and does the key comparison
+ * when searching a bucket, so the HashIndex doesn't need to know the key type.
+ * The number of buckets is a power of 2 which doubles when the number of
+ * values exceeds it, so that the buckets stay short.
+ * @tparam Value The type of the indexed value. It must be copyable and
+ * comparable with ==.
+ */
+template<class Value>
+class HashIndex {
+public:
+  /**
+   * An Entry has a value and the hash of its key. The hash is kept so that
+   * growing the index doesn't need to hash the keys again, and so that a
+   * search can skip entries with a different hash before comparing keys.
+   */
+  class Entry {
+  public:
+    Entry(size_t hash, const Value& value)
+    : hash_(hash), value_(value)
+    {}
+
+    size_t hash_;
+    Value value_;
+  };
+
+  typedef std::vector<Entry> Bucket;
+
+  /**
+   * Create an empty HashIndex.
+   * @param expectedSize (optional) The expected number of values. The initial
+   * number of buckets is the smallest power of 2 which is at least
+   * expectedSize and at least INITIAL_BUCKET_COUNT. If omitted, use
+   * INITIAL_BUCKET_COUNT.
+   */
+  HashIndex(size_t expectedSize = INITIAL_BUCKET_COUNT)
+  : size_(0)
+  {
+    size_t nBuckets = INITIAL_BUCKET_COUNT;
+    while (nBuckets < expectedSize)
+      nBuckets *= 2;
+    buckets_.resize(nBuckets);
+  }
+
+  /**
+   * Get the bucket which has the entries for the hash. To find a value, the
+   * caller should check each entry in the bucket whose hash_ equals the hash
+   * and compare the key of its value_.
+   * @param hash The hash of the key.
+   * @return The bucket, which is only valid until the next call to insert.
+   */
+  const Bucket&
+  getBucket(size_t hash) const
+  {
+    return buckets_[hash & (buckets_.size() - 1)];
+  }
+
+  /**
+   * Add the value to the index, doubling the number of buckets if the number
+   * of values would exceed it. This does not check if the index already has
+   * the value.
+   * @param hash The hash of the value's key.
+   * @param value The value to add.
+   */
+  void
+  insert(size_t hash, const Value& value)
+  {
+    if (size_ >= buckets_.size())
+      grow();
+
+    getMutableBucket(hash).push_back(Entry(hash, value));
+    ++size_;
+  }
+
+  /**
+   * Remove the value from the index.
+   * @param hash The hash of the value's key, which is the same as given to
+   * insert.
+   * @param value The value to remove.
+   * @return True if the value was removed, or false if it was not found.
+   */
+  bool
+  erase(size_t hash, const Value& value)
+  {
+    Bucket& bucket = getMutableBucket(hash);
+    for (size_t i = 0; i < bucket.size(); ++i) {
+      if (bucket[i].hash_ == hash && bucket[i].value_ == value) {
+        // The order in the bucket doesn't matter, so move the last to here.
+        if (i != bucket.size() - 1)
+          bucket[i] = bucket.back();
+        bucket.pop_back();
+        --size_;
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  /**
+   * Get the number of values in the index.
+   * @return The number of values.
+   */
+  size_t
+  size() const { return size_; }
+
+  /**
+   * Get the number of buckets, which is a power of 2.
+   * @return The number of buckets.
+   */
+  size_t
+  getBucketCount() const { return buckets_.size(); }
+
+  static const size_t INITIAL_BUCKET_COUNT = 16;
+
+private:
+  Bucket&
+  getMutableBucket(size_t hash)
+  {
+    return buckets_[hash & (buckets_.size() - 1)];
+  }
+
+  /**
+   * Double the number of buckets and move each entry to its new bucket.
+   */
+  void
+  grow()
+  {
+    std::vector<Bucket> newBuckets(buckets_.size() * 2);
+    size_t mask = newBuckets.size() - 1;
+    for (size_t i = 0; i < buckets_.size(); ++i) {
+      const Bucket& bucket = buckets_[i];
+      for (size_t j = 0; j < bucket.size(); ++j)
+        newBuckets[bucket[j].hash_ & mask].push_back(bucket[j]);
+    }
+
+    buckets_.swap(newBuckets);
+  }
+
+  std::vector<Bucket> buckets_;
+  size_t size_;
+};
+
+template<class Value>
+const size_t HashIndex<Value>::INITIAL_BUCKET_COUNT;
+
+}
+
+#endif
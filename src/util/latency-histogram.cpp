@@ -0,0 +1,116 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Regents of the University of California.
+ * @author: Jeff Thompson <jefft0@remap.ucla.edu>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+#include <ndn-cpp/util/latency-histogram.hpp>
+
+using namespace std;
+
+namespace ndn {
+
+// Values below 2 * SUB_BUCKET_COUNT have their own bucket.
+static const size_t SUB_BUCKET_BITS = 4;
+static const size_t SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS;
+static const uint64_t LINEAR_LIMIT = 2 * SUB_BUCKET_COUNT;
+
+void
+LatencyHistogram::record(uint64_t value)
+{
+  size_t index = getBucketIndex(value);
+  if (index >= counts_.size())
+    counts_.resize(index + 1, 0);
+  ++counts_[index];
+
+  if (count_ == 0 || value < min_)
+    min_ = value;
+  if (value > max_)
+    max_ = value;
+  ++count_;
+  sum_ += (double)value;
+}
+
+uint64_t
+LatencyHistogram::getValueAtPercentile(double percentile) const
+{
+  if (count_ == 0)
+    return 0;
+
+  if (percentile > 100.0)
+    percentile = 100.0;
+  uint64_t targetCount = (uint64_t)(percentile / 100.0 * count_ + 0.5);
+  if (targetCount == 0)
+    targetCount = 1;
+
+  uint64_t totalCount = 0;
+  for (size_t i = 0; i < counts_.size(); ++i) {
+    totalCount += counts_[i];
+    if (totalCount >= targetCount) {
+      uint64_t value = getBucketMaxValue(i);
+      return value < max_ ? value : max_;
+    }
+  }
+
+  return max_;
+}
+
+void
+LatencyHistogram::reset()
+{
+  counts_.clear();
+  count_ = 0;
+  min_ = 0;
+  max_ = 0;
+  sum_ = 0;
+}
+
+size_t
+LatencyHistogram::getBucketIndex(uint64_t value)
+{
+  if (value < LINEAR_LIMIT)
+    return (size_t)value;
+
+  // Find the position of the highest bit, which is at least SUB_BUCKET_BITS + 1.
+  size_t highBit = 0;
+  for (size_t shift = 32; shift > 0; shift /= 2) {
+    if (value >> (highBit + shift))
+      highBit += shift;
+  }
+
+  // The top SUB_BUCKET_BITS + 1 bits give the sub-bucket in
+  // [SUB_BUCKET_COUNT, 2 * SUB_BUCKET_COUNT).
+  size_t subBucket = (size_t)(value >> (highBit - SUB_BUCKET_BITS));
+  return LINEAR_LIMIT + (highBit - SUB_BUCKET_BITS - 1) * SUB_BUCKET_COUNT +
+    (subBucket - SUB_BUCKET_COUNT);
+}
+
+uint64_t
+LatencyHistogram::getBucketMaxValue(size_t index)
+{
+  if (index < LINEAR_LIMIT)
+    return index;
+
+  size_t highBit = (index - LINEAR_LIMIT) / SUB_BUCKET_COUNT + SUB_BUCKET_BITS + 1;
+  uint64_t subBucket =
+    (index - LINEAR_LIMIT) % SUB_BUCKET_COUNT + SUB_BUCKET_COUNT;
+  size_t shift = highBit - SUB_BUCKET_BITS;
+  return ((subBucket + 1) << shift) - 1;
+}
+
+}
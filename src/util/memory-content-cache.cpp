@@ -23,6 +23,7 @@
 #include "../c/util/time.h"
 #include <ndn-cpp/util/logging.hpp>
 #include <ndn-cpp/util/memory-content-cache.hpp>
+#include "best-match.hpp"
 
 using namespace std;
 using namespace ndn::func_lib;
@@ -35,6 +36,7 @@ MemoryContentCache::Impl::Impl
   (Face* face, Milliseconds cleanupIntervalMilliseconds)
 : face_(face), cleanupIntervalMilliseconds_(cleanupIntervalMilliseconds),
   nextCleanupTime_(ndn_getNowMilliseconds() + cleanupIntervalMilliseconds),
+  nRemovedInStaleTimeHeap_(0), nSatisfiedInTimeoutHeap_(0),
   isDoingCleanup_(false), minimumCacheLifetime_(0)
 {
 }
@@ -108,43 +110,68 @@ MemoryContentCache::Impl::add(const Data& data)
   MillisecondsSince1970 nowMilliseconds = ndn_getNowMilliseconds();
   doCleanup(nowMilliseconds);
 
+  if (evictionPolicy_)
+    // The policy has one entry per name, so replace any existing content.
+    removeContent(data.getName(), 0);
+
+  ptr_lib::shared_ptr<const Content> addedContent;
   if (data.getMetaInfo().getFreshnessPeriod() >= 0.0) {
-    // The content will go stale, so use staleTimeCache_.
+    // The content will go stale, so also add to staleTimeHeap_.
     ptr_lib::shared_ptr<const StaleTimeContent> content
       (new StaleTimeContent(data, nowMilliseconds, minimumCacheLifetime_));
-    // Insert into staleTimeCache_, sorted on content->cacheRemovalTimeMilliseconds_.
-    staleTimeCache_.insert
-      (std::lower_bound(staleTimeCache_.begin(), staleTimeCache_.end(), content, contentCompare_),
-       content);
+    staleTimeHeap_.push_back(content);
+    std::push_heap(staleTimeHeap_.begin(), staleTimeHeap_.end(), contentCompare_);
+    nameIndex_.insert(NameIndex::value_type
+      (content->getName(), IndexEntry(content, content.get())));
+    addedContent = content;
+  }
+  else {
+    // The data does not go stale, so only nameIndex_ has it.
+    addedContent = ptr_lib::make_shared<const Content>(data);
+    nameIndex_.insert(NameIndex::value_type
+      (addedContent->getName(), IndexEntry(addedContent, 0)));
+  }
+
+  if (evictionPolicy_) {
+    evictionPolicy_->insert
+      (addedContent->getName(), addedContent->getDataEncoding().size());
+    evictWhileOverBudget();
   }
-  else
-    // The data does not go stale, so use noStaleTimeCache_.
-    noStaleTimeCache_.push_back
-      (ptr_lib::make_shared<const Content>(data));
 
   // Remove timed-out interests and check if the data packet matches any pending
   // interest.
-  // Go backwards through the list so we can erase entries.
-  for (int i = (int)pendingInterestTable_.size() - 1; i >= 0; --i) {
-    if (pendingInterestTable_[i]->isTimedOut(nowMilliseconds)) {
-      pendingInterestTable_.erase(pendingInterestTable_.begin() + i);
-      continue;
+  removeTimedOutPendingInterests(nowMilliseconds);
+  if (pendingInterestIndex_.size() == 0)
+    return;
+  vector<PendingInterestIndex::iterator> matches;
+  findPendingInterestsForName(data.getName(), matches);
+  for (size_t i = 0; i < matches.size(); ++i) {
+    try {
+      // Send to the same transport from the original call to onInterest.
+      // wireEncode returns the cached encoding if available.
+      _LOG_TRACE("MemoryContentCache:  Reply w/ add Data " << data.getName());
+      matches[i]->second->getFace().send(*data.wireEncode());
+    } catch (std::exception& e) {
+      _LOG_DEBUG("Error in send: " << e.what());
+      return;
     }
 
-    if (pendingInterestTable_[i]->getInterest()->matchesName(data.getName())) {
-      try {
-        // Send to the same transport from the original call to onInterest.
-        // wireEncode returns the cached encoding if available.
-        _LOG_TRACE("MemoryContentCache:  Reply w/ add Data " << data.getName());
-        pendingInterestTable_[i]->getFace().send(*data.wireEncode());
-      } catch (std::exception& e) {
-        _LOG_DEBUG("Error in send: " << e.what());
-        return;
-      }
+    // The pending interest is satisfied, so remove it. Its entry in
+    // pendingInterestTimeoutHeap_ is removed later.
+    pendingInterestIndex_.erase(matches[i]);
+    ++nSatisfiedInTimeoutHeap_;
+  }
 
-      // The pending interest is satisfied, so remove it.
-      pendingInterestTable_.erase(pendingInterestTable_.begin() + i);
-    }
+  if (nSatisfiedInTimeoutHeap_ > pendingInterestTimeoutHeap_.size() / 2) {
+    // Remake the heap from pendingInterestIndex_.
+    pendingInterestTimeoutHeap_.clear();
+    for (PendingInterestIndex::iterator i = pendingInterestIndex_.begin();
+         i != pendingInterestIndex_.end(); ++i)
+      pendingInterestTimeoutHeap_.push_back(i->second);
+    std::make_heap
+      (pendingInterestTimeoutHeap_.begin(), pendingInterestTimeoutHeap_.end(),
+       timeoutCompare_);
+    nSatisfiedInTimeoutHeap_ = 0;
   }
 }
 
@@ -152,8 +179,14 @@ void
 MemoryContentCache::Impl::storePendingInterest
   (const ptr_lib::shared_ptr<const Interest>& interest, Face& face)
 {
-  pendingInterestTable_.push_back(ptr_lib::shared_ptr<PendingInterest>
-    (new PendingInterest(interest, face)));
+  ptr_lib::shared_ptr<const PendingInterest> pendingInterest
+    (new PendingInterest(interest, face));
+  pendingInterestIndex_.insert(PendingInterestIndex::value_type
+    (interest->getName(), pendingInterest));
+  pendingInterestTimeoutHeap_.push_back(pendingInterest);
+  std::push_heap
+    (pendingInterestTimeoutHeap_.begin(), pendingInterestTimeoutHeap_.end(),
+     timeoutCompare_);
 }
 
 void
@@ -163,18 +196,11 @@ MemoryContentCache::Impl::getPendingInterestsForName
 {
   pendingInterests.clear();
 
-  // Remove timed-out interests as we add results.
-  // Go backwards through the list so we can erase entries.
-  MillisecondsSince1970 nowMilliseconds = ndn_getNowMilliseconds();
-  for (int i = (int)pendingInterestTable_.size() - 1; i >= 0; --i) {
-    if (pendingInterestTable_[i]->isTimedOut(nowMilliseconds)) {
-      pendingInterestTable_.erase(pendingInterestTable_.begin() + i);
-      continue;
-    }
-
-    if (pendingInterestTable_[i]->getInterest()->matchesName(name))
-      pendingInterests.push_back(pendingInterestTable_[i]);
-  }
+  removeTimedOutPendingInterests(ndn_getNowMilliseconds());
+  vector<PendingInterestIndex::iterator> matches;
+  findPendingInterestsForName(name, matches);
+  for (size_t i = 0; i < matches.size(); ++i)
+    pendingInterests.push_back(matches[i]->second);
 }
 
 void
@@ -184,18 +210,12 @@ MemoryContentCache::Impl::getPendingInterestsWithPrefix
 {
   pendingInterests.clear();
 
-  // Remove timed-out interests as we add results.
-  // Go backwards through the list so we can erase entries.
-  MillisecondsSince1970 nowMilliseconds = ndn_getNowMilliseconds();
-  for (int i = (int)pendingInterestTable_.size() - 1; i >= 0; --i) {
-    if (pendingInterestTable_[i]->isTimedOut(nowMilliseconds)) {
-      pendingInterestTable_.erase(pendingInterestTable_.begin() + i);
-      continue;
-    }
-
-    if (prefix.isPrefixOf(pendingInterestTable_[i]->getInterest()->getName()))
-      pendingInterests.push_back(pendingInterestTable_[i]);
-  }
+  removeTimedOutPendingInterests(ndn_getNowMilliseconds());
+  // The Name keys are in order.
+  for (PendingInterestIndex::iterator i =
+         pendingInterestIndex_.lower_bound(prefix);
+       i != pendingInterestIndex_.end() && prefix.isPrefixOf(i->first); ++i)
+    pendingInterests.push_back(i->second);
 }
 
 void
@@ -210,69 +230,16 @@ MemoryContentCache::Impl::onInterest
   MillisecondsSince1970 nowMilliseconds = ndn_getNowMilliseconds();
   doCleanup(nowMilliseconds);
 
-  const Name::Component* selectedComponent = 0;
-  Blob selectedEncoding;
-  // We need to iterate over both arrays.
-  size_t totalSize = staleTimeCache_.size() + noStaleTimeCache_.size();
-  for (size_t i = 0; i < totalSize; ++i) {
-    const Content* content;
-    bool isFresh = true;
-    if (i < staleTimeCache_.size()) {
-      const StaleTimeContent *staleTimeContent = staleTimeCache_[i].get();
-      content = staleTimeContent;
-      isFresh = staleTimeContent->isFresh(nowMilliseconds);
-    }
-    else
-      // We have iterated over the first array. Get from the second.
-      content = noStaleTimeCache_[i - staleTimeCache_.size()].get();
-
-    if (interest->matchesName(content->getName()) &&
-        !(interest->getMustBeFresh() && !isFresh)) {
-      if (interest->getChildSelector() < 0) {
-        // No child selector, so send the first match that we have found.
-        _LOG_TRACE("MemoryContentCache:         Reply Data " << content->getName());
-        face.send(*content->getDataEncoding());
-        return;
-      }
-      else {
-        // Update selectedEncoding based on the child selector.
-        const Name::Component* component;
-        if (content->getName().size() > interest->getName().size())
-          component = &content->getName().get(interest->getName().size());
-        else
-          component = &emptyComponent_;
-
-        bool gotBetterMatch = false;
-        if (!selectedEncoding)
-          // Save the first match.
-          gotBetterMatch = true;
-        else {
-          if (interest->getChildSelector() == 0) {
-            // Leftmost child.
-            if (*component < *selectedComponent)
-              gotBetterMatch = true;
-          }
-          else {
-            // Rightmost child.
-            if (*component > *selectedComponent)
-              gotBetterMatch = true;
-          }
-        }
-
-        if (gotBetterMatch) {
-          selectedComponent = component;
-          selectedEncoding = content->getDataEncoding();
-        }
-      }
-    }
-  }
-
-  if (selectedEncoding) {
-    // We found the leftmost or rightmost child.
-    _LOG_TRACE("MemoryContentCache: Reply Data to Interest " << interest->toUri());
-    face.send(*selectedEncoding);
+  const Content* content = findBestMatch(*interest, nowMilliseconds);
+  if (content) {
+    if (evictionPolicy_)
+      evictionPolicy_->access(content->getName());
+    _LOG_TRACE("MemoryContentCache:         Reply Data " << content->getName());
+    face.send(*content->getDataEncoding());
   }
   else {
+    if (evictionPolicy_)
+      evictionPolicy_->miss();
     _LOG_TRACE("MemoryContentCache: onDataNotFound for " << interest->toUri());
     // Call the onDataNotFound callback (if defined).
     map<string, OnInterestCallback>::iterator onDataNotFound =
@@ -290,6 +257,152 @@ MemoryContentCache::Impl::onInterest
   }
 }
 
+const MemoryContentCache::Content*
+MemoryContentCache::Impl::findBestMatch
+  (const Interest& interest, MillisecondsSince1970 nowMilliseconds) const
+{
+  NameIndex::const_iterator match = findBestMatchInIndex
+    (nameIndex_, interest, IsFreshAt(nowMilliseconds));
+  if (match == nameIndex_.end())
+    return 0;
+  return match->second.content_.get();
+}
+
+bool
+MemoryContentCache::Impl::removeFromIndex(const Content* content)
+{
+  pair<NameIndex::iterator, NameIndex::iterator> range =
+    nameIndex_.equal_range(content->getName());
+  for (NameIndex::iterator i = range.first; i != range.second; ++i) {
+    if (i->second.content_.get() == content) {
+      nameIndex_.erase(i);
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void
+MemoryContentCache::Impl::removeContent
+  (const Name& name, ContentList* removedContent)
+{
+  pair<NameIndex::iterator, NameIndex::iterator> range =
+    nameIndex_.equal_range(name);
+  for (NameIndex::iterator i = range.first; i != range.second; ++i) {
+    if (i->second.staleTimeContent_)
+      ++nRemovedInStaleTimeHeap_;
+    if (removedContent)
+      removedContent->push_back(i->second.content_);
+  }
+
+  nameIndex_.erase(range.first, range.second);
+
+  if (nRemovedInStaleTimeHeap_ > staleTimeHeap_.size() / 2)
+    rebuildStaleTimeHeap();
+}
+
+void
+MemoryContentCache::Impl::rebuildStaleTimeHeap()
+{
+  staleTimeHeap_.clear();
+  for (NameIndex::iterator i = nameIndex_.begin(); i != nameIndex_.end(); ++i) {
+    if (i->second.staleTimeContent_)
+      staleTimeHeap_.push_back(ptr_lib::static_pointer_cast<const StaleTimeContent>
+        (i->second.content_));
+  }
+  std::make_heap(staleTimeHeap_.begin(), staleTimeHeap_.end(), contentCompare_);
+  nRemovedInStaleTimeHeap_ = 0;
+}
+
+bool
+MemoryContentCache::Impl::removeFromPendingInterestIndex
+  (const PendingInterest* pendingInterest)
+{
+  pair<PendingInterestIndex::iterator, PendingInterestIndex::iterator> range =
+    pendingInterestIndex_.equal_range(pendingInterest->getInterest()->getName());
+  for (PendingInterestIndex::iterator i = range.first; i != range.second; ++i) {
+    if (i->second.get() == pendingInterest) {
+      pendingInterestIndex_.erase(i);
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void
+MemoryContentCache::Impl::removeTimedOutPendingInterests
+  (MillisecondsSince1970 nowMilliseconds)
+{
+  while (pendingInterestTimeoutHeap_.size() > 0 &&
+         pendingInterestTimeoutHeap_.front()->isTimedOut(nowMilliseconds)) {
+    ptr_lib::shared_ptr<const PendingInterest> pendingInterest =
+      pendingInterestTimeoutHeap_.front();
+    std::pop_heap
+      (pendingInterestTimeoutHeap_.begin(), pendingInterestTimeoutHeap_.end(),
+       timeoutCompare_);
+    pendingInterestTimeoutHeap_.pop_back();
+
+    if (!removeFromPendingInterestIndex(pendingInterest.get()))
+      // It was already satisfied.
+      --nSatisfiedInTimeoutHeap_;
+  }
+}
+
+void
+MemoryContentCache::Impl::findPendingInterestsForName
+  (const Name& name, vector<PendingInterestIndex::iterator>& pendingInterests)
+{
+  if (pendingInterestIndex_.size() == 0)
+    return;
+
+  for (size_t nComponents = 0; nComponents <= name.size(); ++nComponents) {
+    pair<PendingInterestIndex::iterator, PendingInterestIndex::iterator> range =
+      pendingInterestIndex_.equal_range(name.getPrefix(nComponents));
+    for (PendingInterestIndex::iterator i = range.first; i != range.second; ++i) {
+      if (i->second->getInterest()->matchesName(name))
+        pendingInterests.push_back(i);
+    }
+  }
+}
+
+void
+MemoryContentCache::Impl::evictWhileOverBudget()
+{
+  ptr_lib::shared_ptr<ContentList> contentList;
+  Name name;
+  while (evictionPolicy_->isOverBudget() && evictionPolicy_->evict(name)) {
+    if (onContentRemoved_ && !contentList)
+      contentList.reset(new ContentList());
+    removeContent(name, contentList.get());
+  }
+
+  if (onContentRemoved_ && contentList && contentList->size() > 0) {
+    try {
+      onContentRemoved_(contentList);
+    } catch (const std::exception& ex) {
+      _LOG_ERROR("MemoryContentCache::add(): Error in onContentRemoved: " << ex.what());
+    } catch (...) {
+      _LOG_ERROR("MemoryContentCache::add(): Error in onContentRemoved.");
+    }
+  }
+}
+
+void
+MemoryContentCache::Impl::setEvictionPolicy
+  (const ptr_lib::shared_ptr<CacheEvictionPolicy>& evictionPolicy)
+{
+  evictionPolicy_ = evictionPolicy;
+  if (!evictionPolicy_)
+    return;
+
+  for (NameIndex::iterator i = nameIndex_.begin(); i != nameIndex_.end(); ++i)
+    evictionPolicy_->insert
+      (i->first, i->second.content_->getDataEncoding().size());
+  evictWhileOverBudget();
+}
+
 void
 MemoryContentCache::Impl::doCleanup(MillisecondsSince1970 nowMilliseconds)
 {
@@ -302,21 +415,31 @@ MemoryContentCache::Impl::doCleanup(MillisecondsSince1970 nowMilliseconds)
 
   ptr_lib::shared_ptr<ContentList> contentList;
   if (nowMilliseconds >= nextCleanupTime_) {
-    // staleTimeCache_ is sorted on cacheRemovalTimeMilliseconds_, so we only need to
-    // erase the stale entries at the front, then quit.
-    while (staleTimeCache_.size() > 0 &&
-           staleTimeCache_.front()->isPastRemovalTime(nowMilliseconds)) {
+    // staleTimeHeap_ is a min-heap on cacheRemovalTimeMilliseconds_, so we only
+    // need to pop the stale entries, then quit.
+    while (staleTimeHeap_.size() > 0 &&
+           staleTimeHeap_.front()->isPastRemovalTime(nowMilliseconds)) {
+      ptr_lib::shared_ptr<const StaleTimeContent> content = staleTimeHeap_.front();
+      std::pop_heap(staleTimeHeap_.begin(), staleTimeHeap_.end(), contentCompare_);
+      staleTimeHeap_.pop_back();
+
+      if (!removeFromIndex(content.get())) {
+        // removeContent already removed it.
+        --nRemovedInStaleTimeHeap_;
+        continue;
+      }
+      if (evictionPolicy_)
+        evictionPolicy_->erase(content->getName());
+
       if (onContentRemoved_) {
         // Add to the list of removed content for the OnContentRemoved callback.
         // We make a separate list instead of calling the callback each time
-        // because the callback might call add again to modify the staleTimeCache_.
+        // because the callback might call add again to modify the staleTimeHeap_.
         if (!contentList)
           contentList.reset(new ContentList());
 
-        contentList->push_back(staleTimeCache_.front());
+        contentList->push_back(content);
       }
-
-      staleTimeCache_.erase(staleTimeCache_.begin());
     }
 
     nextCleanupTime_ = nowMilliseconds + cleanupIntervalMilliseconds_;
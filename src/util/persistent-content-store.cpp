@@ -0,0 +1,597 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Regents of the University of California.
+ * @author: Jeff Thompson <jefft0@remap.ucla.edu>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+#include <stdexcept>
+#include <algorithm>
+#include <ndn-cpp/ndn-cpp-config.h>
+#if NDN_CPP_HAVE_UNISTD_H
+#include <errno.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+#include "../c/util/time.h"
+#include "../encoding/tlv-decoder.hpp"
+#include <ndn-cpp/util/logging.hpp>
+#include <ndn-cpp/util/persistent-content-store.hpp>
+#include "best-match.hpp"
+
+using namespace std;
+
+INIT_LOGGER("ndn.PersistentContentStore");
+
+namespace ndn {
+
+#if NDN_CPP_HAVE_UNISTD_H
+
+// Map at least this many bytes so that the log is not remapped for each add.
+static const uint64_t MINIMUM_MAP_SIZE = 1024 * 1024;
+// Don't compact automatically if the log is smaller than this.
+static const uint64_t MINIMUM_AUTO_COMPACTION_SIZE = 1024 * 1024;
+
+/**
+ * Write all the bytes to the file at the offset.
+ * @return True for success, or false if the write failed and errno is set.
+ */
+static bool
+writeAll(int fd, const uint8_t* buffer, size_t length, uint64_t offset)
+{
+  while (length > 0) {
+    ssize_t nWritten = ::pwrite(fd, buffer, length, offset);
+    if (nWritten < 0) {
+      if (errno == EINTR)
+        continue;
+      return false;
+    }
+
+    buffer += nWritten;
+    length -= nWritten;
+    offset += nWritten;
+  }
+
+  return true;
+}
+
+/**
+ * Read all the bytes from the file at the offset.
+ * @return True for success, or false if the read failed.
+ */
+static bool
+readAll(int fd, uint8_t* buffer, size_t length, uint64_t offset)
+{
+  while (length > 0) {
+    ssize_t nRead = ::pread(fd, buffer, length, offset);
+    if (nRead < 0 && errno == EINTR)
+      continue;
+    if (nRead <= 0)
+      return false;
+
+    buffer += nRead;
+    length -= nRead;
+    offset += nRead;
+  }
+
+  return true;
+}
+
+/**
+ * A Compaction holds the state of the background thread which copies the
+ * records which are used to the compacted log file.
+ */
+class PersistentContentStore::Compaction {
+public:
+  /**
+   * Create a Compaction to copy the records.
+   * @param fromFd The file descriptor of the log. The store must not close it
+   * until the thread is done.
+   * @param toFd The file descriptor of the empty compacted log.
+   * @param records The offset and length of each record to copy, sorted by
+   * offset.
+   * @param snapshotLogSize The log size when the records were selected.
+   */
+  Compaction
+    (int fromFd, int toFd, const vector<pair<uint64_t, size_t> >& records,
+     uint64_t snapshotLogSize)
+  : fromFd_(fromFd), toFd_(toFd), records_(records),
+    snapshotLogSize_(snapshotLogSize), compactedSize_(0), isDone_(false)
+  {
+    pthread_mutex_init(&mutex_, 0);
+  }
+
+  ~Compaction() { pthread_mutex_destroy(&mutex_); }
+
+  bool
+  isDone()
+  {
+    pthread_mutex_lock(&mutex_);
+    bool result = isDone_;
+    pthread_mutex_unlock(&mutex_);
+    return result;
+  }
+
+  /**
+   * The thread function which copies each record in records_ to toFd_ and sets
+   * newOffsets_.
+   * @param arg The Compaction.
+   */
+  static void*
+  run(void* arg)
+  {
+    Compaction& self = *(Compaction*)arg;
+    vector<uint8_t> buffer;
+    for (size_t i = 0; i < self.records_.size(); ++i) {
+      size_t length = self.records_[i].second;
+      buffer.resize(length);
+      if (!readAll(self.fromFd_, &buffer[0], length, self.records_[i].first) ||
+          !writeAll(self.toFd_, &buffer[0], length, self.compactedSize_)) {
+        self.error_ = strerror(errno);
+        break;
+      }
+
+      self.newOffsets_.push_back(self.compactedSize_);
+      self.compactedSize_ += length;
+    }
+
+    if (self.error_.empty() && ::fsync(self.toFd_) != 0)
+      self.error_ = strerror(errno);
+
+    pthread_mutex_lock(&self.mutex_);
+    self.isDone_ = true;
+    pthread_mutex_unlock(&self.mutex_);
+    return 0;
+  }
+
+  /**
+   * Get the offset in the compacted log of the record which was at the offset
+   * in the log when the records were selected.
+   */
+  uint64_t
+  getNewOffset(uint64_t offset) const
+  {
+    vector<pair<uint64_t, size_t> >::const_iterator record = lower_bound
+      (records_.begin(), records_.end(), pair<uint64_t, size_t>(offset, 0));
+    return newOffsets_[record - records_.begin()];
+  }
+
+  int fromFd_;
+  int toFd_;
+  vector<pair<uint64_t, size_t> > records_;
+  uint64_t snapshotLogSize_;
+  // The following are set by the thread.
+  vector<uint64_t> newOffsets_;
+  uint64_t compactedSize_;
+  string error_;
+  pthread_t thread_;
+
+private:
+  pthread_mutex_t mutex_;
+  bool isDone_;
+};
+
+#else
+
+class PersistentContentStore::Compaction {
+};
+
+#endif
+
+PersistentContentStore::PersistentContentStore(const string& filePath)
+: filePath_(filePath), fd_(-1), map_(0), mapSize_(0), logSize_(0),
+  liveSize_(0), autoCompactionRatio_(0.5)
+{
+#if NDN_CPP_HAVE_UNISTD_H
+  try {
+    open();
+  } catch (...) {
+    close();
+    throw;
+  }
+#else
+  throw runtime_error
+    ("PersistentContentStore: Memory-mapped files are not supported on this platform");
+#endif
+}
+
+PersistentContentStore::~PersistentContentStore()
+{
+  try {
+    finishCompaction(true);
+  } catch (const std::exception& ex) {
+    _LOG_ERROR("PersistentContentStore: Error finishing compaction: " << ex.what());
+  }
+  close();
+}
+
+void
+PersistentContentStore::add(const Data& data)
+{
+  finishCompaction(false);
+
+  // wireEncode returns the cached encoding if available.
+  Blob encoding = data.wireEncode();
+  uint64_t offset = append(encoding.buf(), encoding.size());
+
+  MillisecondsSince1970 freshnessExpiryTime = -1;
+  Milliseconds freshnessPeriod = data.getMetaInfo().getFreshnessPeriod();
+  if (freshnessPeriod >= 0.0)
+    freshnessExpiryTime = ndn_getNowMilliseconds() + freshnessPeriod;
+
+  NameIndex::iterator entry = index_.find(data.getName());
+  if (entry != index_.end()) {
+    liveSize_ -= entry->second.length_;
+    entry->second = Entry(offset, encoding.size(), freshnessExpiryTime);
+  }
+  else
+    index_.insert(NameIndex::value_type
+      (data.getName(), Entry(offset, encoding.size(), freshnessExpiryTime)));
+  liveSize_ += encoding.size();
+
+  maybeStartCompaction();
+}
+
+bool
+PersistentContentStore::remove(const Name& name)
+{
+  finishCompaction(false);
+
+  NameIndex::iterator entry = index_.find(name);
+  if (entry == index_.end())
+    return false;
+
+  // The name encoding is the removal record.
+  Blob encoding = name.wireEncode();
+  append(encoding.buf(), encoding.size());
+  liveSize_ -= entry->second.length_;
+  index_.erase(entry);
+
+  maybeStartCompaction();
+  return true;
+}
+
+bool
+PersistentContentStore::find
+  (const Interest& interest, const uint8_t*& encoding, size_t& encodingLength)
+{
+  finishCompaction(false);
+
+  NameIndex::const_iterator match = findBestMatchInIndex
+    (index_, interest, IsFreshAt(ndn_getNowMilliseconds()));
+  if (match == index_.end())
+    return false;
+
+  encoding = map_ + match->second.offset_;
+  encodingLength = match->second.length_;
+  return true;
+}
+
+void
+PersistentContentStore::flush()
+{
+#if NDN_CPP_HAVE_UNISTD_H
+  if (::fsync(fd_) != 0)
+    _LOG_ERROR("PersistentContentStore: Error flushing the log: " <<
+               strerror(errno));
+#endif
+}
+
+bool
+PersistentContentStore::startCompaction()
+{
+#if NDN_CPP_HAVE_UNISTD_H
+  if (compaction_)
+    return false;
+
+  vector<pair<uint64_t, size_t> > records;
+  records.reserve(index_.size());
+  for (NameIndex::const_iterator i = index_.begin(); i != index_.end(); ++i)
+    records.push_back
+      (pair<uint64_t, size_t>(i->second.offset_, i->second.length_));
+  // Copy in the order of the log.
+  sort(records.begin(), records.end());
+
+  string compactFilePath = filePath_ + ".compact";
+  int toFd = ::open(compactFilePath.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (toFd < 0)
+    throw runtime_error
+      ("Cannot open the compacted log " + compactFilePath + ": " +
+       strerror(errno));
+
+  ptr_lib::shared_ptr<Compaction> compaction(new Compaction
+    (fd_, toFd, records, logSize_));
+  if (pthread_create
+      (&compaction->thread_, 0, &Compaction::run, compaction.get()) != 0) {
+    ::close(toFd);
+    ::unlink(compactFilePath.c_str());
+    throw runtime_error("PersistentContentStore: Cannot create the compaction thread");
+  }
+
+  _LOG_DEBUG("PersistentContentStore: Start compaction of " << logSize_ <<
+             " bytes with " << liveSize_ << " bytes used");
+  compaction_ = compaction;
+  return true;
+#else
+  return false;
+#endif
+}
+
+void
+PersistentContentStore::waitForCompaction()
+{
+  finishCompaction(true);
+}
+
+void
+PersistentContentStore::onInterest
+  (const ptr_lib::shared_ptr<const Name>& prefix,
+   const ptr_lib::shared_ptr<const Interest>& interest, Face& face,
+   uint64_t interestFilterId,
+   const ptr_lib::shared_ptr<const InterestFilter>& filter)
+{
+  const uint8_t* encoding;
+  size_t encodingLength;
+  if (find(*interest, encoding, encodingLength)) {
+    _LOG_TRACE("PersistentContentStore: Reply Data for " << interest->getName());
+    face.send(encoding, encodingLength);
+    return;
+  }
+
+  _LOG_TRACE("PersistentContentStore: onDataNotFound for " << interest->getName());
+  if (onDataNotFound_) {
+    try {
+      onDataNotFound_(prefix, interest, face, interestFilterId, filter);
+    } catch (const std::exception& ex) {
+      _LOG_ERROR("PersistentContentStore::onInterest: Error in onDataNotFound: " << ex.what());
+    } catch (...) {
+      _LOG_ERROR("PersistentContentStore::onInterest: Error in onDataNotFound.");
+    }
+  }
+}
+
+void
+PersistentContentStore::open()
+{
+#if NDN_CPP_HAVE_UNISTD_H
+  fd_ = ::open(filePath_.c_str(), O_RDWR | O_CREAT, 0644);
+  if (fd_ < 0)
+    throw runtime_error
+      ("Cannot open the log " + filePath_ + ": " + strerror(errno));
+  struct stat fileStat;
+  if (::fstat(fd_, &fileStat) != 0)
+    throw runtime_error
+      ("Cannot get the size of the log " + filePath_ + ": " + strerror(errno));
+  uint64_t fileSize = fileStat.st_size;
+  map(fileSize);
+
+  uint64_t offset = 0;
+  while (offset < fileSize) {
+    const uint8_t* record = map_ + offset;
+    uint64_t type;
+    size_t headerLength;
+    size_t recordLength;
+    try {
+      TlvDecoder decoder(record, fileSize - offset);
+      type = decoder.readVarNumber();
+      uint64_t length = decoder.readVarNumber();
+      if (length > fileSize - offset - decoder.offset)
+        throw runtime_error("The record is incomplete");
+      headerLength = decoder.offset;
+      recordLength = headerLength + length;
+    } catch (const std::exception& ex) {
+      // Only the last record can be torn by stopping while appending it.
+      _LOG_ERROR("PersistentContentStore: Truncating the log " << filePath_ <<
+                 " at offset " << offset << ": " << ex.what());
+      if (::ftruncate(fd_, offset) != 0)
+        throw runtime_error
+          ("Cannot truncate the log " + filePath_ + ": " + strerror(errno));
+      break;
+    }
+
+    try {
+      // Limit the decoder to this record.
+      TlvDecoder decoder(record, recordLength);
+      decoder.seek(headerLength);
+
+      if (type == ndn_Tlv_Data) {
+        // Only decode the name and FreshnessPeriod.
+        size_t endOffset = recordLength;
+        size_t nameOffset = decoder.offset;
+        size_t nameEndOffset = decoder.readNestedTlvsStart(ndn_Tlv_Name);
+        Name name;
+        name.wireDecode(record + nameOffset, nameEndOffset - nameOffset);
+        decoder.seek(nameEndOffset);
+
+        MillisecondsSince1970 freshnessExpiryTime = -1;
+        if (decoder.peekType(ndn_Tlv_MetaInfo, endOffset)) {
+          size_t metaInfoEndOffset = decoder.readNestedTlvsStart(ndn_Tlv_MetaInfo);
+          decoder.skipOptionalTlv(ndn_Tlv_ContentType, metaInfoEndOffset);
+          if (decoder.peekType(ndn_Tlv_FreshnessPeriod, metaInfoEndOffset))
+            // The log doesn't have the time when the Data packet was added,
+            // so its FreshnessPeriod may have expired. Treat it as stale.
+            freshnessExpiryTime = 0;
+        }
+
+        NameIndex::iterator entry = index_.find(name);
+        if (entry != index_.end()) {
+          liveSize_ -= entry->second.length_;
+          entry->second = Entry(offset, recordLength, freshnessExpiryTime);
+        }
+        else
+          index_.insert(NameIndex::value_type
+            (name, Entry(offset, recordLength, freshnessExpiryTime)));
+        liveSize_ += recordLength;
+      }
+      else if (type == ndn_Tlv_Name) {
+        // A removal record.
+        Name name;
+        name.wireDecode(record, recordLength);
+        NameIndex::iterator entry = index_.find(name);
+        if (entry != index_.end()) {
+          liveSize_ -= entry->second.length_;
+          index_.erase(entry);
+        }
+      }
+      else
+        throw runtime_error("Unrecognized record type");
+    } catch (const std::exception& ex) {
+      // The record is complete, so skip it and keep the records after it.
+      // It is not in the index, so compaction will remove it.
+      _LOG_ERROR("PersistentContentStore: Skipping the record in the log " <<
+                 filePath_ << " at offset " << offset << ": " << ex.what());
+    }
+
+    offset += recordLength;
+  }
+
+  logSize_ = offset;
+#endif
+}
+
+void
+PersistentContentStore::close()
+{
+#if NDN_CPP_HAVE_UNISTD_H
+  if (map_) {
+    ::munmap(map_, mapSize_);
+    map_ = 0;
+    mapSize_ = 0;
+  }
+  if (fd_ >= 0) {
+    ::close(fd_);
+    fd_ = -1;
+  }
+#endif
+}
+
+void
+PersistentContentStore::map(uint64_t length)
+{
+#if NDN_CPP_HAVE_UNISTD_H
+  if (length <= mapSize_)
+    return;
+
+  // Map past the end of the file so that appended records are already mapped.
+  // Double the size so that the log is only remapped a few times.
+  uint64_t newMapSize = max(length, max(mapSize_ * 2, MINIMUM_MAP_SIZE));
+  if (map_)
+    ::munmap(map_, mapSize_);
+  map_ = 0;
+  mapSize_ = 0;
+
+  void* map = ::mmap(0, newMapSize, PROT_READ, MAP_SHARED, fd_, 0);
+  if (map == MAP_FAILED)
+    throw runtime_error
+      ("Cannot map the log " + filePath_ + ": " + strerror(errno));
+  map_ = (uint8_t*)map;
+  mapSize_ = newMapSize;
+#endif
+}
+
+uint64_t
+PersistentContentStore::append(const uint8_t* encoding, size_t encodingLength)
+{
+#if NDN_CPP_HAVE_UNISTD_H
+  uint64_t offset = logSize_;
+  if (!writeAll(fd_, encoding, encodingLength, offset)) {
+    string error = strerror(errno);
+    // Remove a partial record.
+    if (::ftruncate(fd_, offset) != 0)
+      _LOG_ERROR("PersistentContentStore: Error truncating the log: " <<
+                 strerror(errno));
+    throw runtime_error("Cannot write to the log " + filePath_ + ": " + error);
+  }
+
+  logSize_ += encodingLength;
+  map(logSize_);
+  return offset;
+#else
+  return 0;
+#endif
+}
+
+void
+PersistentContentStore::maybeStartCompaction()
+{
+  if (compaction_ || autoCompactionRatio_ >= 1.0 ||
+      logSize_ < MINIMUM_AUTO_COMPACTION_SIZE ||
+      logSize_ - liveSize_ <= autoCompactionRatio_ * logSize_)
+    return;
+
+  try {
+    startCompaction();
+  } catch (const std::exception& ex) {
+    _LOG_ERROR("PersistentContentStore: Error starting compaction: " << ex.what());
+  }
+}
+
+void
+PersistentContentStore::finishCompaction(bool wait)
+{
+#if NDN_CPP_HAVE_UNISTD_H
+  if (!compaction_ || (!wait && !compaction_->isDone()))
+    return;
+
+  pthread_join(compaction_->thread_, 0);
+  ptr_lib::shared_ptr<Compaction> compaction = compaction_;
+  compaction_.reset();
+
+  string compactFilePath = filePath_ + ".compact";
+  string error = compaction->error_;
+  uint64_t tailSize = logSize_ - compaction->snapshotLogSize_;
+  if (error.empty()) {
+    // Copy the records which were appended since compaction started.
+    if (tailSize > 0 &&
+        !(writeAll(compaction->toFd_, map_ + compaction->snapshotLogSize_,
+                   tailSize, compaction->compactedSize_) &&
+          ::fsync(compaction->toFd_) == 0))
+      error = strerror(errno);
+    else if (::rename(compactFilePath.c_str(), filePath_.c_str()) != 0)
+      error = strerror(errno);
+  }
+
+  if (!error.empty()) {
+    _LOG_ERROR("PersistentContentStore: Error compacting the log " <<
+               filePath_ << ": " << error);
+    ::close(compaction->toFd_);
+    ::unlink(compactFilePath.c_str());
+    return;
+  }
+
+  for (NameIndex::iterator i = index_.begin(); i != index_.end(); ++i) {
+    if (i->second.offset_ >= compaction->snapshotLogSize_)
+      i->second.offset_ = compaction->compactedSize_ +
+        (i->second.offset_ - compaction->snapshotLogSize_);
+    else
+      i->second.offset_ = compaction->getNewOffset(i->second.offset_);
+  }
+
+  _LOG_DEBUG("PersistentContentStore: Compacted the log from " << logSize_ <<
+             " to " << (compaction->compactedSize_ + tailSize) << " bytes");
+  close();
+  fd_ = compaction->toFd_;
+  logSize_ = compaction->compactedSize_ + tailSize;
+  map(logSize_);
+#endif
+}
+
+}
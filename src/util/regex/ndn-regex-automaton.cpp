@@ -0,0 +1,583 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Regents of the University of California.
+ * @author: Jeff Thompson <jefft0@remap.ucla.edu>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+#include "ndn-regex-matcher-base.hpp"
+// Only compile if we set NDN_CPP_HAVE_REGEX_LIB in ndn-regex-matcher-base.hpp.
+#if NDN_CPP_HAVE_REGEX_LIB
+
+#include <stdlib.h>
+#include "ndn-regex-automaton.hpp"
+
+using namespace std;
+
+namespace ndn {
+
+// The same limit as NdnRegexRepeatMatcher, which we treat as unbounded.
+static const size_t MAX_REPETITIONS = 32767;
+
+/**
+ * Return the index after the right bracket which matches the left bracket
+ * just before index, counting nested brackets in the same way as
+ * NdnRegexPatternListMatcher::extractSubPattern.
+ */
+static size_t
+extractSubPattern
+  (const string& expr, char left, char right, size_t index, size_t end)
+{
+  size_t lcount = 1;
+  size_t rcount = 0;
+
+  while (lcount > rcount) {
+    if (index >= end)
+      throw NdnRegexMatcherBase::Error("Parenthesis mismatch");
+
+    if (left == expr[index])
+      lcount++;
+
+    if (right == expr[index])
+      rcount++;
+
+    ++index;
+  }
+
+  return index;
+}
+
+/**
+ * Return the index after the repetition at index, in the same way as
+ * NdnRegexPatternListMatcher::extractRepetition.
+ */
+static size_t
+extractRepetition(const string& expr, size_t index, size_t end)
+{
+  if (index == end)
+    return index;
+
+  if (('+' == expr[index] || '?' == expr[index] || '*' == expr[index]))
+    return ++index;
+
+  if ('{' == expr[index]) {
+    while ('}' != expr[index]) {
+      index++;
+      if (index == end)
+        break;
+    }
+    if (index == end)
+      throw NdnRegexMatcherBase::Error("Missing right brace bracket");
+    else
+      return ++index;
+  }
+  else
+    return index;
+}
+
+/**
+ * Return the index after the component expression which starts at index, in
+ * the same way as NdnRegexComponentSetMatcher::extractComponent.
+ */
+static size_t
+extractComponent(const string& expr, size_t index)
+{
+  size_t lcount = 1;
+  size_t rcount = 0;
+
+  while (lcount > rcount) {
+    if (index >= expr.size())
+      throw NdnRegexMatcherBase::Error("Error: angle brackets mismatch");
+
+    switch (expr[index]) {
+    case '<':
+      ++lcount;
+      break;
+
+    case '>':
+      ++rcount;
+      break;
+    }
+
+    ++index;
+  }
+
+  return index;
+}
+
+NdnRegexAutomaton::NdnRegexAutomaton(const string& expr)
+: expr_(expr), start_(-1), accept_(-1), listId_(0)
+{
+  if (expr.empty())
+    throw NdnRegexMatcherBase::Error("NdnRegexAutomaton: Empty expression");
+
+  // Imitate NdnRegexTopMatcher::compile. Without '^', the language is the
+  // union of the primary matcher and the secondary matcher with a leading
+  // "<.*>*", which is the same as the secondary matcher.
+  string topExpr = expr;
+  if ('$' != topExpr[topExpr.size() - 1])
+    topExpr = topExpr + "<.*>*";
+  else
+    topExpr = topExpr.substr(0, topExpr.size() - 1);
+
+  if (topExpr.size() == 0 || '^' != topExpr[0])
+    compileExpr_ = "<.*>*" + topExpr;
+  else
+    compileExpr_ = topExpr.substr(1, topExpr.size() - 1);
+
+  accept_ = addState(STATE_ACCEPT, -1, -1, -1);
+  start_ = compilePatternList(0, compileExpr_.size(), accept_);
+  compileExpr_.clear();
+
+  lastListId_.resize(states_.size(), 0);
+  setResult_.resize(componentSets_.size(), 0);
+  computeLiteralPrefix();
+  computeRequiredComponents();
+}
+
+bool
+NdnRegexAutomaton::match(const Name& name)
+{
+  currentList_.clear();
+  ++listId_;
+  addToList(start_, currentList_);
+
+  string escapedString;
+  for (size_t i = 0; i < name.size(); ++i) {
+    if (currentList_.size() == 0)
+      return false;
+
+    const Name::Component& component = name.get(i);
+    escapedString.clear();
+    for (size_t j = 0; j < setResult_.size(); ++j)
+      setResult_[j] = 0;
+
+    nextList_.clear();
+    ++listId_;
+    for (size_t j = 0; j < currentList_.size(); ++j) {
+      const State& state = states_[currentList_[j]];
+      if (state.type_ != STATE_COMPONENT)
+        continue;
+
+      if (setResult_[state.set_] == 0)
+        setResult_[state.set_] =
+          (componentSets_[state.set_].match(component, escapedString) ? 2 : 1);
+      if (setResult_[state.set_] == 2)
+        addToList(state.out_, nextList_);
+    }
+
+    currentList_.swap(nextList_);
+  }
+
+  for (size_t j = 0; j < currentList_.size(); ++j) {
+    if (states_[currentList_[j]].type_ == STATE_ACCEPT)
+      return true;
+  }
+
+  return false;
+}
+
+int
+NdnRegexAutomaton::compilePatternList(size_t begin, size_t end, int next)
+{
+  // Split into patterns the same as NdnRegexPatternListMatcher::extractPattern.
+  // Each pattern has the start, the end of the atom, and the end including
+  // the repetition.
+  vector<size_t> starts;
+  vector<size_t> indicators;
+  vector<size_t> ends;
+
+  size_t index = begin;
+  while (index < end) {
+    size_t start = index;
+    char left = compileExpr_[index];
+    char right;
+    if (left == '(')
+      right = ')';
+    else if (left == '<')
+      right = '>';
+    else if (left == '[')
+      right = ']';
+    else
+      throw NdnRegexMatcherBase::Error("Unexpected syntax");
+
+    size_t indicator = extractSubPattern
+      (compileExpr_, left, right, index + 1, end);
+    index = extractRepetition(compileExpr_, indicator, end);
+
+    starts.push_back(start);
+    indicators.push_back(indicator);
+    ends.push_back(index);
+  }
+
+  // Compile in reverse order so that each pattern knows its next state.
+  int state = next;
+  for (size_t i = starts.size(); i > 0; --i) {
+    size_t repeatMin, repeatMax;
+    parseRepetition
+      (compileExpr_.substr(indicators[i - 1], ends[i - 1] - indicators[i - 1]),
+       repeatMin, repeatMax);
+    state = compileRepeat
+      (starts[i - 1], indicators[i - 1], repeatMin, repeatMax, state);
+  }
+
+  return state;
+}
+
+int
+NdnRegexAutomaton::compileAtom(size_t begin, size_t end, int next)
+{
+  if (compileExpr_[begin] == '(') {
+    // Imitate NdnRegexBackrefMatcher::compile.
+    if (end - begin < 2 || compileExpr_[end - 1] != ')')
+      throw NdnRegexMatcherBase::Error
+        ("Unrecognized format: " + compileExpr_.substr(begin, end - begin));
+
+    return compilePatternList(begin + 1, end - 1, next);
+  }
+  else {
+    int set = addComponentSet(compileExpr_.substr(begin, end - begin));
+    return addState(STATE_COMPONENT, set, next, -1);
+  }
+}
+
+int
+NdnRegexAutomaton::compileRepeat
+  (size_t begin, size_t end, size_t repeatMin, size_t repeatMax, int next)
+{
+  int state = next;
+
+  if (repeatMax >= MAX_REPETITIONS) {
+    // Make a loop which can repeat the atom or go to next.
+    int loop = addState(STATE_SPLIT, -1, -1, next);
+    int atom = compileAtom(begin, end, loop);
+    states_[loop].out_ = atom;
+    state = loop;
+  }
+  else {
+    // Each optional copy can repeat the atom or go to next.
+    for (size_t i = repeatMin; i < repeatMax; ++i) {
+      int atom = compileAtom(begin, end, state);
+      state = addState(STATE_SPLIT, -1, atom, next);
+    }
+  }
+
+  // Prepend the mandatory copies.
+  for (size_t i = 0; i < repeatMin; ++i)
+    state = compileAtom(begin, end, state);
+
+  return state;
+}
+
+int
+NdnRegexAutomaton::addComponentSet(const string& expr)
+{
+  // Imitate NdnRegexComponentSetMatcher::compile.
+  if (expr.size() < 2)
+    throw NdnRegexMatcherBase::Error
+      ("Regexp compile error (cannot parse " + expr + ")");
+
+  ComponentSet componentSet;
+  if (expr[0] == '<') {
+    size_t end = extractComponent(expr, 1);
+    if (expr.size() != end)
+      throw NdnRegexMatcherBase::Error("Component expr error " + expr);
+
+    componentSet.patterns_.push_back
+      (ComponentPattern(expr.substr(1, end - 2)));
+  }
+  else if (expr[0] == '[') {
+    size_t lastIndex = expr.size() - 1;
+    if (']' != expr[lastIndex])
+      throw NdnRegexMatcherBase::Error
+        ("Regexp compile error (no matching ']' in " + expr + ")");
+
+    size_t index = 1;
+    if ('^' == expr[1]) {
+      componentSet.isInclusion_ = false;
+      index = 2;
+    }
+
+    while (index < lastIndex) {
+      if ('<' != expr[index])
+        throw NdnRegexMatcherBase::Error("Component expr error " + expr);
+
+      size_t tempIndex = index + 1;
+      index = extractComponent(expr, tempIndex);
+      componentSet.patterns_.push_back
+        (ComponentPattern(expr.substr(tempIndex, index - tempIndex - 1)));
+    }
+
+    if (index != lastIndex)
+      throw NdnRegexMatcherBase::Error("Not sufficient expr to parse " + expr);
+  }
+  else
+    throw NdnRegexMatcherBase::Error
+      ("Regexp compile error (cannot parse " + expr + ")");
+
+  componentSets_.push_back(componentSet);
+  return componentSets_.size() - 1;
+}
+
+int
+NdnRegexAutomaton::addState(StateType type, int set, int out, int out2)
+{
+  if (states_.size() >= MAX_STATES)
+    throw NdnRegexMatcherBase::Error
+      ("NdnRegexAutomaton: The expression needs too many states: " + expr_);
+
+  states_.push_back(State(type, set, out, out2));
+  return states_.size() - 1;
+}
+
+void
+NdnRegexAutomaton::parseRepetition
+  (const string& repetition, size_t& repeatMin, size_t& repeatMax)
+{
+  // Imitate NdnRegexRepeatMatcher::parseRepetition.
+  if (repetition.size() == 0) {
+    repeatMin = 1;
+    repeatMax = 1;
+    return;
+  }
+  if (repetition == "?") {
+    repeatMin = 0;
+    repeatMax = 1;
+    return;
+  }
+  if (repetition == "+") {
+    repeatMin = 1;
+    repeatMax = MAX_REPETITIONS;
+    return;
+  }
+  if (repetition == "*") {
+    repeatMin = 0;
+    repeatMax = MAX_REPETITIONS;
+    return;
+  }
+
+  size_t rsSize = repetition.size();
+  size_t min = 0;
+  size_t max = 0;
+
+  if (regex_lib::regex_match
+      (repetition, regex_lib::regex("\\{[0-9]+,[0-9]+\\}"))) {
+    size_t separator = repetition.find_first_of(',', 0);
+    min = ::atoi(repetition.substr(1, separator - 1).c_str());
+    max = ::atoi
+      (repetition.substr(separator + 1, rsSize - separator - 2).c_str());
+  }
+  else if (regex_lib::regex_match
+           (repetition, regex_lib::regex("\\{,[0-9]+\\}"))) {
+    size_t separator = repetition.find_first_of(',', 0);
+    min = 0;
+    max = ::atoi
+      (repetition.substr(separator + 1, rsSize - separator - 2).c_str());
+  }
+  else if (regex_lib::regex_match
+           (repetition, regex_lib::regex("\\{[0-9]+,\\}"))) {
+    size_t separator = repetition.find_first_of(',', 0);
+    min = ::atoi(repetition.substr(1, separator - 1).c_str());
+    max = MAX_REPETITIONS;
+  }
+  else if (regex_lib::regex_match
+           (repetition, regex_lib::regex("\\{[0-9]+\\}"))) {
+    min = ::atoi(repetition.substr(1, rsSize - 2).c_str());
+    max = min;
+  }
+  else
+    throw NdnRegexMatcherBase::Error
+      ("NdnRegexAutomaton: Unrecognized repetition format " + repetition);
+
+  if (min > MAX_REPETITIONS || max > MAX_REPETITIONS || min > max)
+    throw NdnRegexMatcherBase::Error
+      ("NdnRegexAutomaton: Wrong repetition number " + repetition);
+
+  repeatMin = min;
+  repeatMax = max;
+}
+
+void
+NdnRegexAutomaton::addToList(int state, vector<int>& list)
+{
+  if (lastListId_[state] == listId_)
+    // Already added.
+    return;
+  lastListId_[state] = listId_;
+
+  const State& s = states_[state];
+  if (s.type_ == STATE_SPLIT) {
+    addToList(s.out_, list);
+    addToList(s.out2_, list);
+  }
+  else
+    list.push_back(state);
+}
+
+void
+NdnRegexAutomaton::computeLiteralPrefix()
+{
+  // Follow the start state while it must consume a single literal component.
+  // A SPLIT state means there is more than one path, so stop.
+  int state = start_;
+  while (true) {
+    const Name::Component* literal = getLiteral(state);
+    if (!literal)
+      break;
+
+    literalPrefix_.append(*literal);
+    state = states_[state].out_;
+  }
+}
+
+void
+NdnRegexAutomaton::computeRequiredComponents()
+{
+  vector<bool> isVisited(states_.size());
+  vector<int> stack;
+
+  // The states were compiled from right to left, so check in reverse order to
+  // get the components from left to right.
+  for (size_t i = states_.size(); i > 0; --i) {
+    int required = i - 1;
+    const Name::Component* literal = getLiteral(required);
+    if (!literal)
+      continue;
+
+    bool isDuplicate = false;
+    for (size_t j = 0; j < requiredComponents_.size(); ++j) {
+      if (requiredComponents_.get(j).equals(*literal)) {
+        isDuplicate = true;
+        break;
+      }
+    }
+    if (isDuplicate)
+      continue;
+
+    // Search for a path from start_ to accept_ which doesn't use required.
+    isVisited.assign(states_.size(), false);
+    isVisited[required] = true;
+    stack.clear();
+    if (start_ != required) {
+      stack.push_back(start_);
+      isVisited[start_] = true;
+    }
+    bool foundAccept = false;
+    while (stack.size() > 0 && !foundAccept) {
+      const State& state = states_[stack.back()];
+      stack.pop_back();
+
+      int outs[] = { state.out_, state.out2_ };
+      for (size_t j = 0; j < 2; ++j) {
+        int out = outs[j];
+        if (out < 0 || isVisited[out])
+          continue;
+        if (out == accept_) {
+          foundAccept = true;
+          break;
+        }
+
+        isVisited[out] = true;
+        stack.push_back(out);
+      }
+    }
+
+    if (!foundAccept)
+      requiredComponents_.append(*literal);
+  }
+}
+
+const Name::Component*
+NdnRegexAutomaton::getLiteral(int state) const
+{
+  if (states_[state].type_ != STATE_COMPONENT)
+    return 0;
+
+  const ComponentSet& componentSet = componentSets_[states_[state].set_];
+  if (!componentSet.isInclusion_ || componentSet.patterns_.size() != 1 ||
+      componentSet.patterns_[0].type_ != ComponentPattern::LITERAL)
+    return 0;
+
+  return &componentSet.patterns_[0].literal_;
+}
+
+NdnRegexAutomaton::ComponentPattern::ComponentPattern(const string& expr)
+{
+  if (expr.empty() || expr == ".*") {
+    type_ = ANY;
+    return;
+  }
+
+  // A name component is converted to an escaped string before matching. The
+  // escaped string keeps these characters, and they are not special in a
+  // regular expression, so we can compare the component value directly.
+  bool isLiteral = true;
+  for (size_t i = 0; i < expr.size(); ++i) {
+    char c = expr[i];
+    if (!((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+          (c >= '0' && c <= '9') || c == '-' || c == '_' || c == '~')) {
+      isLiteral = false;
+      break;
+    }
+  }
+
+  if (isLiteral) {
+    type_ = LITERAL;
+    literal_ = Name::Component(expr);
+  }
+  else {
+    type_ = REGEX;
+    regex_ = regex_lib::regex(expr);
+  }
+}
+
+bool
+NdnRegexAutomaton::ComponentPattern::match
+  (const Name::Component& component, string& escapedString) const
+{
+  if (type_ == ANY)
+    return true;
+  else if (type_ == LITERAL)
+    // A non-generic component has an escaped string like "sha256digest=..."
+    // so it can't match the literal.
+    return component.equals(literal_);
+  else {
+    if (escapedString.empty())
+      // An escaped string is never empty, so we haven't computed it yet.
+      escapedString = component.toEscapedString();
+    return regex_lib::regex_match(escapedString, regex_);
+  }
+}
+
+bool
+NdnRegexAutomaton::ComponentSet::match
+  (const Name::Component& component, string& escapedString) const
+{
+  bool isMatched = false;
+  for (size_t i = 0; i < patterns_.size(); ++i) {
+    if (patterns_[i].match(component, escapedString)) {
+      isMatched = true;
+      break;
+    }
+  }
+
+  return isInclusion_ ? isMatched : !isMatched;
+}
+
+}
+
+#endif // NDN_CPP_HAVE_REGEX_LIB
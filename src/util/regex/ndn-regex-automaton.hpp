@@ -0,0 +1,257 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Regents of the University of California.
+ * @author: Jeff Thompson <jefft0@remap.ucla.edu>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+#ifndef NDN_NDN_REGEX_AUTOMATON_HPP
+#define NDN_NDN_REGEX_AUTOMATON_HPP
+
+#include "ndn-regex-matcher-base.hpp"
+// Only compile if we set NDN_CPP_HAVE_REGEX_LIB in ndn-regex-matcher-base.hpp.
+#if NDN_CPP_HAVE_REGEX_LIB
+
+namespace ndn {
+
+/**
+ * NdnRegexAutomaton compiles an NDN regular expression (the same syntax as
+ * NdnRegexTopMatcher) into a nondeterministic finite automaton over name
+ * components. The match method simulates the automaton with a set of active
+ * states, so the time to match is linear in the number of name components
+ * instead of the backtracking search of NdnRegexTopMatcher. Each component
+ * expression is evaluated at most once per name component. A component
+ * expression which is a plain string is compared directly with the name
+ * component without using the regex library.
+ *
+ * NdnRegexAutomaton only answers whether the name matches. It does not record
+ * back references, so use NdnRegexTopMatcher to call expand().
+ */
+class NdnRegexAutomaton {
+public:
+  /**
+   * Compile the NDN regular expression.
+   * @param expr The NDN regular expression, as for NdnRegexTopMatcher.
+   * @throws NdnRegexMatcherBase::Error for a syntax error, or if the compiled
+   * automaton would be larger than MAX_STATES (for example if the expression
+   * has a large bounded repetition like {1,1000}). In this case, the caller
+   * should use NdnRegexTopMatcher.
+   * @throws std::exception from the regex library for an invalid component
+   * expression.
+   */
+  NdnRegexAutomaton(const std::string& expr);
+
+  /**
+   * Check if the name matches the regular expression, with the same result
+   * as NdnRegexTopMatcher::match(name).
+   * @param name The name to match.
+   * @return True for a match.
+   */
+  bool
+  match(const Name& name);
+
+  /**
+   * Get the name components which every matching name must start with. This
+   * is the leading components of an expression which starts with '^' where
+   * each component expression is a plain string which must be matched, for
+   * example /ndn/edu for "^<ndn><edu><>*<KEY><>$" or /a for "^<a>+<b>".
+   * @return The literal prefix, which is empty if there are no such leading
+   * components.
+   */
+  const Name&
+  getLiteralPrefix() const { return literalPrefix_; }
+
+  /**
+   * Get the plain-string name components which every matching name must
+   * contain somewhere, for example /group1/SYNC for
+   * "<group1><>*<SYNC><>$". This includes the components of
+   * getLiteralPrefix().
+   * @return The required components, in no particular order.
+   */
+  const Name&
+  getRequiredComponents() const { return requiredComponents_; }
+
+  const std::string&
+  getExpr() const { return expr_; }
+
+  /**
+   * The maximum number of automaton states.
+   */
+  static const size_t MAX_STATES = 2048;
+
+private:
+  /**
+   * A ComponentPattern matches one name component with the expression inside
+   * "<>".
+   */
+  class ComponentPattern {
+  public:
+    enum Type {
+      ANY,
+      LITERAL,
+      REGEX
+    };
+
+    ComponentPattern(const std::string& expr);
+
+    /**
+     * Check if the component matches.
+     * @param component The name component.
+     * @param escapedString The escaped string of component, which this sets
+     * if it is empty and this needs the regex library.
+     * @return True for a match.
+     */
+    bool
+    match(const Name::Component& component, std::string& escapedString) const;
+
+    Type type_;
+    Name::Component literal_;
+    regex_lib::regex regex_;
+  };
+
+  /**
+   * A ComponentSet matches one name component with a list of ComponentPattern
+   * as in "<a>", "[<a><b>]" or "[^<a><b>]".
+   */
+  class ComponentSet {
+  public:
+    ComponentSet()
+    : isInclusion_(true)
+    {
+    }
+
+    bool
+    match(const Name::Component& component, std::string& escapedString) const;
+
+    bool isInclusion_;
+    std::vector<ComponentPattern> patterns_;
+  };
+
+  enum StateType {
+    STATE_COMPONENT, // Consume one component matching componentSets_[set_].
+    STATE_SPLIT,     // Epsilon transitions to out_ and out2_.
+    STATE_ACCEPT
+  };
+
+  class State {
+  public:
+    State(StateType type, int set, int out, int out2)
+    : type_(type), set_(set), out_(out), out2_(out2)
+    {
+    }
+
+    StateType type_;
+    int set_;
+    int out_;
+    int out2_;
+  };
+
+  /**
+   * Compile the pattern list compileExpr_[begin, end) with the transitions of the
+   * final states going to next. This mimics
+   * NdnRegexPatternListMatcher::compile, but compiles the patterns in reverse
+   * order so that each one knows its following state.
+   * @return The start state of the pattern list.
+   */
+  int
+  compilePatternList(size_t begin, size_t end, int next);
+
+  /**
+   * Compile the atom compileExpr_[begin, end) which is "<...>", "[...]" or "(...)"
+   * with no repetition.
+   * @return The start state of the atom.
+   */
+  int
+  compileAtom(size_t begin, size_t end, int next);
+
+  /**
+   * Compile the atom with the given repetition.
+   */
+  int
+  compileRepeat
+    (size_t begin, size_t end, size_t repeatMin, size_t repeatMax, int next);
+
+  /**
+   * Add a ComponentSet for the expression "<...>" or "[...]".
+   * @return The index in componentSets_.
+   */
+  int
+  addComponentSet(const std::string& expr);
+
+  int
+  addState(StateType type, int set, int out, int out2);
+
+  /**
+   * Parse the repetition string such as "*", "{2,3}" or "" in the same way as
+   * NdnRegexRepeatMatcher::parseRepetition.
+   */
+  static void
+  parseRepetition
+    (const std::string& repetition, size_t& repeatMin, size_t& repeatMax);
+
+  /**
+   * Add state and the states reachable by epsilon transitions to list.
+   */
+  void
+  addToList(int state, std::vector<int>& list);
+
+  /**
+   * Set literalPrefix_ from the leading states which must each match one
+   * plain-string component.
+   */
+  void
+  computeLiteralPrefix();
+
+  /**
+   * Set requiredComponents_ from each state which must match one plain-string
+   * component and which is on every path from start_ to the accept state.
+   */
+  void
+  computeRequiredComponents();
+
+  /**
+   * Get the single plain-string component which the state must match.
+   * @return The literal component, or 0 if the state doesn't only match one
+   * plain-string component.
+   */
+  const Name::Component*
+  getLiteral(int state) const;
+
+  std::string expr_;
+  // The working expression while compiling.
+  std::string compileExpr_;
+  std::vector<ComponentSet> componentSets_;
+  std::vector<State> states_;
+  int start_;
+  int accept_;
+  Name literalPrefix_;
+  Name requiredComponents_;
+
+  // Scratch space for match.
+  std::vector<int> currentList_;
+  std::vector<int> nextList_;
+  std::vector<size_t> lastListId_;
+  size_t listId_;
+  // For the current component, 0 = not evaluated, 1 = no match, 2 = match.
+  std::vector<uint8_t> setResult_;
+};
+
+}
+
+#endif // NDN_CPP_HAVE_REGEX_LIB
+
+#endif
@@ -0,0 +1,57 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Regents of the University of California.
+ * @author: Jeff Thompson <jefft0@remap.ucla.edu>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+#include <math.h>
+#include <algorithm>
+#include <ndn-cpp/util/rtt-estimator.hpp>
+
+using namespace std;
+
+namespace ndn {
+
+// The gains and RTT variation multiplier from RFC 6298.
+static const double ALPHA = 1.0 / 8;
+static const double BETA = 1.0 / 4;
+static const double K = 4;
+
+void
+RttEstimator::addMeasurement(Milliseconds rtt)
+{
+  if (nMeasurements_ == 0) {
+    smoothedRtt_ = rtt;
+    rttVariation_ = rtt / 2;
+  }
+  else {
+    rttVariation_ = (1 - BETA) * rttVariation_ + BETA * fabs(smoothedRtt_ - rtt);
+    smoothedRtt_ = (1 - ALPHA) * smoothedRtt_ + ALPHA * rtt;
+  }
+  ++nMeasurements_;
+
+  rto_ = max(minRto_, min(maxRto_, smoothedRtt_ + K * rttVariation_));
+}
+
+void
+RttEstimator::backoffRto()
+{
+  rto_ = min(maxRto_, rto_ * 2);
+}
+
+}
@@ -20,8 +20,19 @@
  * A copy of the GNU Lesser General Public License is in the file COPYING.
  */
 
+#include <math.h>
 #include <stdexcept>
+#include <algorithm>
+#include <ndn-cpp/ndn-cpp-config.h>
+#if NDN_CPP_HAVE_UNISTD_H
+#include <errno.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
 #include "../c/util/ndn_memory.h"
+#include "../c/util/time.h"
 #include <ndn-cpp/util/logging.hpp>
 #include <ndn-cpp/util/segment-fetcher.hpp>
 
@@ -32,6 +43,118 @@ INIT_LOGGER("ndn.SegmentFetcher");
 
 namespace ndn {
 
+// The CUBIC constants from RFC 8312.
+static const double CUBIC_C = 0.4;
+static const double CUBIC_BETA = 0.7;
+
+/**
+ * An OutputFile memory-maps a file so that the SegmentFetcher can copy the
+ * content of each segment into it, growing the file as needed.
+ */
+class SegmentFetcher::OutputFile {
+public:
+  /**
+   * Create or truncate the file and map it with the initial size.
+   * @param filePath The path of the file.
+   * @param initialSize The initial size of the file.
+   * @throws runtime_error if the file can't be created or mapped.
+   */
+  OutputFile(const string& filePath, uint64_t initialSize)
+  : fd_(-1), map_(0), mapSize_(0)
+  {
+#if NDN_CPP_HAVE_UNISTD_H
+    fd_ = ::open(filePath.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd_ < 0)
+      throw runtime_error
+        ("Cannot open the output file " + filePath + ": " + strerror(errno));
+    resize(initialSize);
+#else
+    throw runtime_error("SegmentFetcher: An output file is not supported on this platform");
+#endif
+  }
+
+  ~OutputFile()
+  {
+    close(mapSize_);
+  }
+
+  /**
+   * Copy the content to the file at the offset, growing the file if needed.
+   * @param offset The offset in the file.
+   * @param content The content to copy.
+   * @throws runtime_error if the file can't be grown.
+   */
+  void
+  write(uint64_t offset, const Blob& content)
+  {
+    if (content.size() == 0)
+      return;
+
+    uint64_t end = offset + content.size();
+    if (end > mapSize_)
+      // Double the size so that the file is only remapped a few times.
+      resize(max(end, mapSize_ * 2));
+    ndn_memcpy(map_ + offset, content.buf(), content.size());
+  }
+
+  /**
+   * Unmap the file, truncate it to finalSize and close it. After this,
+   * write and close do nothing.
+   * @param finalSize The final size of the file.
+   */
+  void
+  close(uint64_t finalSize)
+  {
+#if NDN_CPP_HAVE_UNISTD_H
+    if (fd_ < 0)
+      return;
+
+    unmap();
+    if (::ftruncate(fd_, finalSize) != 0)
+      _LOG_ERROR("SegmentFetcher: Error truncating the output file: " <<
+                 strerror(errno));
+    ::close(fd_);
+    fd_ = -1;
+#endif
+  }
+
+private:
+  void
+  resize(uint64_t size)
+  {
+#if NDN_CPP_HAVE_UNISTD_H
+    unmap();
+    if (::ftruncate(fd_, size) != 0)
+      throw runtime_error
+        (string("Cannot resize the output file: ") + strerror(errno));
+    if (size == 0)
+      return;
+
+    void* map = ::mmap(0, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (map == MAP_FAILED)
+      throw runtime_error
+        (string("Cannot map the output file: ") + strerror(errno));
+    map_ = (uint8_t*)map;
+    mapSize_ = size;
+#endif
+  }
+
+  void
+  unmap()
+  {
+#if NDN_CPP_HAVE_UNISTD_H
+    if (map_)
+      ::munmap(map_, mapSize_);
+#endif
+    map_ = 0;
+    mapSize_ = 0;
+  }
+
+  int fd_;
+  uint8_t* map_;
+  uint64_t mapSize_;
+};
+
 bool
 SegmentFetcher::DontVerifySegment(const ptr_lib::shared_ptr<Data>& data)
 {
@@ -46,7 +169,7 @@ SegmentFetcher::fetch
   // Make a shared_ptr because we make callbacks with bind using
   //   shared_from_this() so the object remains allocated.
   ptr_lib::shared_ptr<SegmentFetcher> segmentFetcher
-    (new SegmentFetcher(face, 0, verifySegment, onComplete, onError));
+    (new SegmentFetcher(face, 0, verifySegment, onComplete, onError, false));
   segmentFetcher->fetchFirstSegment(baseInterest);
 }
 
@@ -60,7 +183,87 @@ SegmentFetcher::fetch
   ptr_lib::shared_ptr<SegmentFetcher> segmentFetcher
     (new SegmentFetcher
      (face, validatorKeyChain, SegmentFetcher::DontVerifySegment, onComplete,
-      onError));
+      onError, false));
+  segmentFetcher->fetchFirstSegment(baseInterest);
+}
+
+void
+SegmentFetcher::fetchWithManifest
+  (Face& face, const Interest &baseInterest, const VerifySegment& verifySegment,
+   const OnComplete& onComplete, const OnError& onError)
+{
+  // Make a shared_ptr because we make callbacks with bind using
+  //   shared_from_this() so the object remains allocated.
+  ptr_lib::shared_ptr<SegmentFetcher> segmentFetcher
+    (new SegmentFetcher(face, 0, verifySegment, onComplete, onError, true));
+  segmentFetcher->fetchFirstSegment(baseInterest);
+}
+
+void
+SegmentFetcher::fetchWithManifest
+  (Face& face, const Interest &baseInterest, KeyChain* validatorKeyChain,
+   const OnComplete& onComplete, const OnError& onError)
+{
+  // Make a shared_ptr because we make callbacks with bind using
+  //   shared_from_this() so the object remains allocated.
+  ptr_lib::shared_ptr<SegmentFetcher> segmentFetcher
+    (new SegmentFetcher
+     (face, validatorKeyChain, SegmentFetcher::DontVerifySegment, onComplete,
+      onError, true));
+  segmentFetcher->fetchFirstSegment(baseInterest);
+}
+
+void
+SegmentFetcher::fetch
+  (Face& face, const Interest &baseInterest, const VerifySegment& verifySegment,
+   const OnComplete& onComplete, const OnError& onError, const Options& options)
+{
+  // Make a shared_ptr because we make callbacks with bind using
+  //   shared_from_this() so the object remains allocated.
+  ptr_lib::shared_ptr<SegmentFetcher> segmentFetcher
+    (new SegmentFetcher
+     (face, 0, verifySegment, onComplete, onError, false, &options));
+  segmentFetcher->fetchFirstSegment(baseInterest);
+}
+
+void
+SegmentFetcher::fetch
+  (Face& face, const Interest &baseInterest, KeyChain* validatorKeyChain,
+   const OnComplete& onComplete, const OnError& onError, const Options& options)
+{
+  // Make a shared_ptr because we make callbacks with bind using
+  //   shared_from_this() so the object remains allocated.
+  ptr_lib::shared_ptr<SegmentFetcher> segmentFetcher
+    (new SegmentFetcher
+     (face, validatorKeyChain, SegmentFetcher::DontVerifySegment, onComplete,
+      onError, false, &options));
+  segmentFetcher->fetchFirstSegment(baseInterest);
+}
+
+void
+SegmentFetcher::fetchWithManifest
+  (Face& face, const Interest &baseInterest, const VerifySegment& verifySegment,
+   const OnComplete& onComplete, const OnError& onError, const Options& options)
+{
+  // Make a shared_ptr because we make callbacks with bind using
+  //   shared_from_this() so the object remains allocated.
+  ptr_lib::shared_ptr<SegmentFetcher> segmentFetcher
+    (new SegmentFetcher
+     (face, 0, verifySegment, onComplete, onError, true, &options));
+  segmentFetcher->fetchFirstSegment(baseInterest);
+}
+
+void
+SegmentFetcher::fetchWithManifest
+  (Face& face, const Interest &baseInterest, KeyChain* validatorKeyChain,
+   const OnComplete& onComplete, const OnError& onError, const Options& options)
+{
+  // Make a shared_ptr because we make callbacks with bind using
+  //   shared_from_this() so the object remains allocated.
+  ptr_lib::shared_ptr<SegmentFetcher> segmentFetcher
+    (new SegmentFetcher
+     (face, validatorKeyChain, SegmentFetcher::DontVerifySegment, onComplete,
+      onError, true, &options));
   segmentFetcher->fetchFirstSegment(baseInterest);
 }
 
@@ -71,6 +274,30 @@ SegmentFetcher::fetchFirstSegment(const Interest& baseInterest)
   interest.setChildSelector(1);
   interest.setMustBeFresh(true);
 
+  if (isPipelined_) {
+    if (options_.getOutputFilePath() != "") {
+      try {
+        outputFile_.reset(new OutputFile
+          (options_.getOutputFilePath(), options_.getOutputFileSize()));
+      } catch (const std::exception& ex) {
+        reportError(IO_ERROR, ex.what());
+        return;
+      }
+    }
+
+    // The segment Interests keep any special selectors of the base Interest.
+    segmentInterestTemplate_ = baseInterest;
+    segmentInterestTemplate_.setChildSelector(0);
+    segmentInterestTemplate_.setMustBeFresh(false);
+
+    face_.expressInterest
+      (interest,
+       bind(&SegmentFetcher::onSegmentReceived, shared_from_this(), _1, _2),
+       bind(&SegmentFetcher::onPipelinedTimeout, shared_from_this(), _1),
+       bind(&SegmentFetcher::onPipelinedNetworkNack, shared_from_this(), _1, _2));
+    return;
+  }
+
   face_.expressInterest
     (interest,
      bind(&SegmentFetcher::onSegmentReceived, shared_from_this(), _1, _2),
@@ -99,6 +326,20 @@ SegmentFetcher::onSegmentReceived
   (const ptr_lib::shared_ptr<const Interest>& originalInterest,
    const ptr_lib::shared_ptr<Data>& data)
 {
+  if (isPipelined_) {
+    if (isStopped_)
+      return;
+    if (!onPipelinedSegmentArrived(originalInterest, data))
+      // Don't verify a duplicate again.
+      return;
+  }
+
+  if (useManifest_) {
+    // Only the manifest is verified with the KeyChain or verifySegment_.
+    checkSegmentWithManifest(originalInterest, data);
+    return;
+  }
+
   if (validatorKeyChain_)
     validatorKeyChain_->verifyData
       (data,
@@ -121,6 +362,11 @@ SegmentFetcher::onVerified
   (const ptr_lib::shared_ptr<Data>& data,
    const ptr_lib::shared_ptr<const Interest>& originalInterest)
 {
+  if (isPipelined_) {
+    onPipelinedSegmentVerified(data);
+    return;
+  }
+
   if (!endsWithSegmentNumber(data->getName())) {
     // We don't expect a name without a segment number.  Treat it as a bad packet.
     try {
@@ -185,26 +431,7 @@ SegmentFetcher::onVerified
         if (currentSegment == finalSegmentNumber) {
           // We are finished.
 
-          // Get the total size and concatenate to get the content.
-          int totalSize = 0;
-          for (size_t i = 0; i < contentParts_.size(); ++i)
-            totalSize += contentParts_[i].size();
-          ptr_lib::shared_ptr<vector<uint8_t> > content
-            (new std::vector<uint8_t>(totalSize));
-          size_t offset = 0;
-          for (size_t i = 0; i < contentParts_.size(); ++i) {
-            const Blob& part = contentParts_[i];
-            ndn_memcpy(&(*content)[offset], part.buf(), part.size());
-            offset += part.size();
-          }
-
-          try {
-            onComplete_(Blob(content, false));
-          } catch (const std::exception& ex) {
-            _LOG_ERROR("SegmentFetcher::onSegmentReceived: Error in onComplete: " << ex.what());
-          } catch (...) {
-            _LOG_ERROR("SegmentFetcher::onSegmentReceived: Error in onComplete.");
-          }
+          reportComplete(contentParts_);
           return;
         }
       }
@@ -220,6 +447,12 @@ void
 SegmentFetcher::onValidationFailed
   (const ptr_lib::shared_ptr<Data>& data, const string& reason)
 {
+  if (isPipelined_) {
+    if (isStopped_)
+      return;
+    stop();
+  }
+
   try {
     onError_
       (SEGMENT_VERIFICATION_FAILED,
@@ -246,4 +479,687 @@ SegmentFetcher::onTimeout(const ptr_lib::shared_ptr<const Interest>& interest)
   }
 }
 
+void
+SegmentFetcher::fetchNextManifestSegment
+  (const Interest& originalInterest, const Name& segmentName)
+{
+  // Start with the original Interest to preserve any special selectors.
+  Interest interest(originalInterest);
+  interest.setChildSelector(0);
+  interest.setMustBeFresh(false);
+  interest.setName
+    (SegmentManifest::getManifestPrefix(segmentName.getPrefix(-1))
+     .appendSegment(nextManifestSegment_));
+
+  isFetchingManifest_ = true;
+  nManifestRetries_ = 0;
+  if (isPipelined_) {
+    face_.expressInterest
+      (interest,
+       bind(&SegmentFetcher::onManifestSegmentReceived, shared_from_this(), _1, _2),
+       bind(&SegmentFetcher::onManifestTimeout, shared_from_this(), _1),
+       bind(&SegmentFetcher::onManifestNetworkNack, shared_from_this(), _1, _2));
+    return;
+  }
+
+  face_.expressInterest
+    (interest,
+     bind(&SegmentFetcher::onManifestSegmentReceived, shared_from_this(), _1, _2),
+     bind(&SegmentFetcher::onTimeout, shared_from_this(), _1));
+}
+
+void
+SegmentFetcher::onManifestSegmentReceived
+  (const ptr_lib::shared_ptr<const Interest>& originalInterest,
+   const ptr_lib::shared_ptr<Data>& data)
+{
+  if (isStopped_)
+    return;
+
+  if (nextManifestSegment_ == 0) {
+    // Manifest segment 0 is the only packet which is signed by the producer.
+    if (validatorKeyChain_)
+      validatorKeyChain_->verifyData
+        (data,
+         bind(&SegmentFetcher::onManifestSegmentVerified, shared_from_this(),
+              _1, originalInterest),
+         // Cast to disambiguate from the deprecated OnVerifyFailed.
+         (const OnDataValidationFailed)bind
+           (&SegmentFetcher::onValidationFailed, shared_from_this(), _1, _2));
+    else {
+      if (!verifySegment_(data)) {
+        onValidationFailed(data, "verifySegment returned false");
+        return;
+      }
+
+      onManifestSegmentVerified(data, originalInterest);
+    }
+  }
+  else {
+    // The previous manifest segment has the digest of this one.
+    if (!data->getFullName()->get(-1).getValue().equals(nextManifestDigest_)) {
+      onValidationFailed
+        (data, "The manifest segment digest does not match the previous manifest segment");
+      return;
+    }
+
+    onManifestSegmentVerified(data, originalInterest);
+  }
+}
+
+void
+SegmentFetcher::onManifestSegmentVerified
+  (const ptr_lib::shared_ptr<Data>& data,
+   const ptr_lib::shared_ptr<const Interest>& originalInterest)
+{
+  isFetchingManifest_ = false;
+
+  SegmentManifest manifest;
+  try {
+    manifest.wireDecode(data->getContent());
+  } catch (const std::exception& ex) {
+    reportError
+      (SEGMENT_VERIFICATION_FAILED,
+       "Error decoding the manifest segment " + data->getName().toUri() +
+       ": " + ex.what());
+    return;
+  }
+
+  manifestDigests_.insert
+    (manifestDigests_.end(), manifest.getDigests().begin(),
+     manifest.getDigests().end());
+  nextManifestDigest_ = manifest.getNextManifestDigest();
+  ++nextManifestSegment_;
+
+  // Check the waiting segments again. A segment which still needs a later
+  // manifest segment is put back in segmentsWaitingForManifest_.
+  vector<pair<ptr_lib::shared_ptr<Data>, ptr_lib::shared_ptr<const Interest> > >
+    waitingSegments;
+  waitingSegments.swap(segmentsWaitingForManifest_);
+  for (size_t i = 0; i < waitingSegments.size(); ++i) {
+    if (isStopped_)
+      return;
+    checkSegmentWithManifest(waitingSegments[i].second, waitingSegments[i].first);
+  }
+}
+
+void
+SegmentFetcher::onManifestTimeout
+  (const ptr_lib::shared_ptr<const Interest>& interest)
+{
+  if (isStopped_)
+    return;
+
+  if (nManifestRetries_ >= options_.getMaxRetries()) {
+    reportError
+      (INTEREST_TIMEOUT,
+       string("Time out for interest ") + interest->getName().toUri());
+    return;
+  }
+
+  ++nManifestRetries_;
+  Interest retryInterest(*interest);
+  retryInterest.refreshNonce();
+  face_.expressInterest
+    (retryInterest,
+     bind(&SegmentFetcher::onManifestSegmentReceived, shared_from_this(), _1, _2),
+     bind(&SegmentFetcher::onManifestTimeout, shared_from_this(), _1),
+     bind(&SegmentFetcher::onManifestNetworkNack, shared_from_this(), _1, _2));
+}
+
+void
+SegmentFetcher::onManifestNetworkNack
+  (const ptr_lib::shared_ptr<const Interest>& interest,
+   const ptr_lib::shared_ptr<NetworkNack>& networkNack)
+{
+  // Retry the manifest segment the same as for a timeout.
+  onManifestTimeout(interest);
+}
+
+void
+SegmentFetcher::checkSegmentWithManifest
+  (const ptr_lib::shared_ptr<const Interest>& originalInterest,
+   const ptr_lib::shared_ptr<Data>& data)
+{
+  // onVerified reports the error for a missing or bad segment number.
+  if (!endsWithSegmentNumber(data->getName())) {
+    onVerified(data, originalInterest);
+    return;
+  }
+  uint64_t segment;
+  try {
+    segment = data->getName().get(-1).toSegment();
+  }
+  catch (runtime_error& ex) {
+    onVerified(data, originalInterest);
+    return;
+  }
+
+  if (!isPipelined_ && segment != contentParts_.size()) {
+    // onVerified doesn't use the content of an unexpected segment. It fetches
+    // the expected segment, which we check when it arrives.
+    onVerified(data, originalInterest);
+    return;
+  }
+
+  if (segment < manifestDigests_.size()) {
+    if (data->getFullName()->get(-1).getValue().equals
+        (manifestDigests_[segment]))
+      onVerified(data, originalInterest);
+    else
+      onValidationFailed
+        (data, "The segment digest does not match the manifest");
+    return;
+  }
+
+  if (nextManifestSegment_ > 0 && nextManifestDigest_.isNull()) {
+    // We already have all the manifest segments.
+    onValidationFailed(data, "The segment is not in the manifest");
+    return;
+  }
+
+  segmentsWaitingForManifest_.push_back(make_pair(data, originalInterest));
+  if (!isFetchingManifest_)
+    fetchNextManifestSegment(*originalInterest, data->getName());
+}
+
+void
+SegmentFetcher::reportError(ErrorCode errorCode, const string& message)
+{
+  if (isPipelined_) {
+    if (isStopped_)
+      return;
+    stop();
+  }
+
+  try {
+    onError_(errorCode, message);
+  } catch (const std::exception& ex) {
+    _LOG_ERROR("SegmentFetcher: Error in onError: " << ex.what());
+  } catch (...) {
+    _LOG_ERROR("SegmentFetcher: Error in onError.");
+  }
+}
+
+void
+SegmentFetcher::reportComplete(const vector<Blob>& contentParts)
+{
+  // Get the total size and concatenate to get the content.
+  size_t totalSize = 0;
+  for (size_t i = 0; i < contentParts.size(); ++i)
+    totalSize += contentParts[i].size();
+  ptr_lib::shared_ptr<vector<uint8_t> > content
+    (new std::vector<uint8_t>(totalSize));
+  size_t offset = 0;
+  for (size_t i = 0; i < contentParts.size(); ++i) {
+    const Blob& part = contentParts[i];
+    if (part.size() > 0)
+      ndn_memcpy(&(*content)[offset], part.buf(), part.size());
+    offset += part.size();
+  }
+
+  try {
+    onComplete_(Blob(content, false));
+  } catch (const std::exception& ex) {
+    _LOG_ERROR("SegmentFetcher::onSegmentReceived: Error in onComplete: " << ex.what());
+  } catch (...) {
+    _LOG_ERROR("SegmentFetcher::onSegmentReceived: Error in onComplete.");
+  }
+}
+
+bool
+SegmentFetcher::onPipelinedSegmentArrived
+  (const ptr_lib::shared_ptr<const Interest>& interest,
+   const ptr_lib::shared_ptr<Data>& data)
+{
+  if (!hasVersionedName_) {
+    // This is the Data for the first Interest which discovers the version.
+    increaseWindow();
+    return true;
+  }
+
+  uint64_t segment;
+  try {
+    segment = interest->getName().get(-1).toSegment();
+  } catch (const std::exception& ex) {
+    // A late reply to an Interest which discovered the version.
+    return false;
+  }
+
+  map<uint64_t, PendingSegment>::iterator pending =
+    pendingSegments_.find(segment);
+  if (pending == pendingSegments_.end() || pending->second.isInRetxQueue_)
+    // A duplicate or a segment which is no longer needed.
+    return false;
+
+  if (pending->second.nRetries_ == 0)
+    // Karn's algorithm: Only measure the RTT of an Interest which was not
+    // retransmitted since we don't know which Interest brought the Data.
+    rttEstimator_.addMeasurement
+      (ndn_getNowMilliseconds() - pending->second.sendTime_);
+  pendingSegments_.erase(pending);
+
+  if (data->getCongestionMark() > 0 && !options_.getIgnoreCongestionMarks())
+    decreaseWindow(segment);
+  else
+    increaseWindow();
+
+  return true;
+}
+
+void
+SegmentFetcher::onPipelinedSegmentVerified(const ptr_lib::shared_ptr<Data>& data)
+{
+  if (isStopped_)
+    return;
+
+  if (!endsWithSegmentNumber(data->getName())) {
+    reportError
+      (DATA_HAS_NO_SEGMENT,
+       string("Got an unexpected packet without a segment number: ") +
+         data->getName().toUri());
+    return;
+  }
+  uint64_t segment;
+  try {
+    segment = data->getName().get(-1).toSegment();
+  }
+  catch (runtime_error& ex) {
+    reportError
+      (DATA_HAS_NO_SEGMENT,
+       string("Error decoding the name segment number ") +
+       data->getName().get(-1).toEscapedString() + ": " + ex.what());
+    return;
+  }
+
+  if (!hasVersionedName_) {
+    versionedName_ = data->getName().getPrefix(-1);
+    hasVersionedName_ = true;
+  }
+
+  if (nSegments_ < 0 &&
+      data->getMetaInfo().getFinalBlockId().getValue().size() > 0) {
+    uint64_t finalSegment;
+    try {
+      finalSegment = data->getMetaInfo().getFinalBlockId().toSegment();
+    }
+    catch (runtime_error& ex) {
+      reportError
+        (DATA_HAS_NO_SEGMENT,
+         string("Error decoding the FinalBlockId segment number ") +
+         data->getMetaInfo().getFinalBlockId().toEscapedString() + ": " +
+         ex.what());
+      return;
+    }
+
+    setFinalSegment(finalSegment);
+  }
+
+  if ((nSegments_ < 0 || segment < (uint64_t)nSegments_) &&
+      segment >= nextSegmentToDeliver_)
+    receivedSegments_[segment] = data->getContent();
+
+  if (isStreaming_ && !deliverSegments())
+    return;
+
+  if (nSegments_ >= 0 &&
+      nextSegmentToDeliver_ + receivedSegments_.size() == (uint64_t)nSegments_) {
+    // We are finished. The keys of receivedSegments_ are nextSegmentToDeliver_
+    // to nSegments_ - 1.
+    stop();
+
+    if (isStreaming_) {
+      try {
+        onComplete_(Blob());
+      } catch (const std::exception& ex) {
+        _LOG_ERROR("SegmentFetcher::onSegmentReceived: Error in onComplete: " << ex.what());
+      } catch (...) {
+        _LOG_ERROR("SegmentFetcher::onSegmentReceived: Error in onComplete.");
+      }
+      return;
+    }
+
+    vector<Blob> contentParts;
+    contentParts.reserve(receivedSegments_.size());
+    for (map<uint64_t, Blob>::iterator part = receivedSegments_.begin();
+         part != receivedSegments_.end(); ++part)
+      contentParts.push_back(part->second);
+    receivedSegments_.clear();
+
+    reportComplete(contentParts);
+    return;
+  }
+
+  schedulePackets();
+}
+
+bool
+SegmentFetcher::deliverSegments()
+{
+  while (true) {
+    map<uint64_t, Blob>::iterator next =
+      receivedSegments_.find(nextSegmentToDeliver_);
+    if (next == receivedSegments_.end())
+      return true;
+
+    Blob content = next->second;
+    receivedSegments_.erase(next);
+    uint64_t offset = deliveredSize_;
+
+    if (options_.getOutputBuffer()) {
+      if (offset + content.size() > options_.getOutputBufferSize()) {
+        reportError
+          (IO_ERROR, "The output buffer is too small for the content");
+        return false;
+      }
+      if (content.size() > 0)
+        ndn_memcpy
+          (options_.getOutputBuffer() + offset, content.buf(), content.size());
+    }
+
+    if (outputFile_) {
+      try {
+        outputFile_->write(offset, content);
+      } catch (const std::exception& ex) {
+        reportError(IO_ERROR, ex.what());
+        return false;
+      }
+    }
+
+    ++nextSegmentToDeliver_;
+    deliveredSize_ += content.size();
+
+    if (options_.getOnSegment()) {
+      try {
+        options_.getOnSegment()(offset, content);
+      } catch (const std::exception& ex) {
+        _LOG_ERROR("SegmentFetcher::onSegmentReceived: Error in onSegment: " << ex.what());
+      } catch (...) {
+        _LOG_ERROR("SegmentFetcher::onSegmentReceived: Error in onSegment.");
+      }
+    }
+  }
+}
+
+void
+SegmentFetcher::onPipelinedTimeout
+  (const ptr_lib::shared_ptr<const Interest>& interest)
+{
+  if (isStopped_)
+    return;
+
+  string message = string("Time out for interest ") + interest->getName().toUri();
+  if (!hasVersionedName_) {
+    retryFirstSegment(interest, INTEREST_TIMEOUT, message);
+    return;
+  }
+
+  uint64_t segment;
+  try {
+    segment = interest->getName().get(-1).toSegment();
+  } catch (const std::exception& ex) {
+    return;
+  }
+  map<uint64_t, PendingSegment>::iterator pending =
+    pendingSegments_.find(segment);
+  if (pending == pendingSegments_.end() || pending->second.isInRetxQueue_)
+    return;
+
+  _LOG_TRACE("SegmentFetcher: Timeout for segment " << segment);
+  decreaseWindow(segment);
+  // The Interests lost in a burst time out together, so only back off the RTO
+  // once per RTO.
+  MillisecondsSince1970 now = ndn_getNowMilliseconds();
+  if (now - lastBackoffTime_ >= rttEstimator_.getEstimatedRto()) {
+    rttEstimator_.backoffRto();
+    lastBackoffTime_ = now;
+  }
+  if (enqueueRetransmission(segment, INTEREST_TIMEOUT, message))
+    schedulePackets();
+}
+
+void
+SegmentFetcher::onPipelinedNetworkNack
+  (const ptr_lib::shared_ptr<const Interest>& interest,
+   const ptr_lib::shared_ptr<NetworkNack>& networkNack)
+{
+  if (isStopped_)
+    return;
+
+  string message = string("Network Nack for interest ") +
+    interest->getName().toUri();
+  if (!hasVersionedName_) {
+    retryFirstSegment(interest, NACK_ERROR, message);
+    return;
+  }
+
+  uint64_t segment;
+  try {
+    segment = interest->getName().get(-1).toSegment();
+  } catch (const std::exception& ex) {
+    return;
+  }
+  map<uint64_t, PendingSegment>::iterator pending =
+    pendingSegments_.find(segment);
+  if (pending == pendingSegments_.end() || pending->second.isInRetxQueue_)
+    return;
+
+  _LOG_TRACE("SegmentFetcher: Network Nack for segment " << segment <<
+             " with reason " << networkNack->getReason());
+  if (networkNack->getReason() == ndn_NetworkNackReason_CONGESTION)
+    decreaseWindow(segment);
+  // For DUPLICATE, the retransmitted Interest has a new nonce.
+  if (enqueueRetransmission(segment, NACK_ERROR, message))
+    schedulePackets();
+}
+
+void
+SegmentFetcher::retryFirstSegment
+  (const ptr_lib::shared_ptr<const Interest>& interest, ErrorCode errorCode,
+   const string& message)
+{
+  if (nDiscoveryRetries_ >= options_.getMaxRetries()) {
+    reportError(errorCode, message);
+    return;
+  }
+
+  ++nDiscoveryRetries_;
+  Interest retryInterest(*interest);
+  retryInterest.refreshNonce();
+  face_.expressInterest
+    (retryInterest,
+     bind(&SegmentFetcher::onSegmentReceived, shared_from_this(), _1, _2),
+     bind(&SegmentFetcher::onPipelinedTimeout, shared_from_this(), _1),
+     bind(&SegmentFetcher::onPipelinedNetworkNack, shared_from_this(), _1, _2));
+}
+
+void
+SegmentFetcher::schedulePackets()
+{
+  if (!hasVersionedName_)
+    return;
+
+  // The face may call a callback before expressInterest returns, which
+  // changes the state, so check everything on each loop.
+  while (!isStopped_ &&
+         (double)(pendingSegments_.size() - retxQueue_.size()) <
+           max(1.0, floor(cwnd_))) {
+    uint64_t segment;
+    if (retxQueue_.size() > 0) {
+      segment = retxQueue_.front();
+      retxQueue_.pop_front();
+    }
+    else {
+      while (nextSegmentToRequest_ < nextSegmentToDeliver_ ||
+             receivedSegments_.find(nextSegmentToRequest_) !=
+               receivedSegments_.end() ||
+             pendingSegments_.find(nextSegmentToRequest_) !=
+               pendingSegments_.end())
+        ++nextSegmentToRequest_;
+      if (nSegments_ >= 0 && nextSegmentToRequest_ >= (uint64_t)nSegments_)
+        break;
+      // When streaming, the segments after a missing segment are buffered
+      // until it arrives, so don't request past the maximum window.
+      if (isStreaming_ &&
+          (double)(nextSegmentToRequest_ - nextSegmentToDeliver_) >=
+            max(1.0, floor(options_.getMaxWindow())))
+        break;
+
+      segment = nextSegmentToRequest_;
+      ++nextSegmentToRequest_;
+      pendingSegments_[segment] = PendingSegment();
+    }
+
+    sendSegmentInterest(segment);
+  }
+}
+
+void
+SegmentFetcher::sendSegmentInterest(uint64_t segment)
+{
+  PendingSegment& pending = pendingSegments_[segment];
+  pending.sendTime_ = ndn_getNowMilliseconds();
+  pending.isInRetxQueue_ = false;
+  int nRetries = pending.nRetries_;
+  if (segment > highInterest_)
+    highInterest_ = segment;
+
+  // Changing the name clears the nonce so that the library will generate a
+  // new one, which is needed for a retransmission.
+  Interest interest(segmentInterestTemplate_);
+  interest.setName(Name(versionedName_).appendSegment(segment));
+  interest.setInterestLifetimeMilliseconds(rttEstimator_.getEstimatedRto());
+
+  uint64_t pendingInterestId = face_.expressInterest
+    (interest,
+     bind(&SegmentFetcher::onSegmentReceived, shared_from_this(), _1, _2),
+     bind(&SegmentFetcher::onPipelinedTimeout, shared_from_this(), _1),
+     bind(&SegmentFetcher::onPipelinedNetworkNack, shared_from_this(), _1, _2));
+
+  // Check if a callback already finished this Interest.
+  map<uint64_t, PendingSegment>::iterator found = pendingSegments_.find(segment);
+  if (found != pendingSegments_.end() && !found->second.isInRetxQueue_ &&
+      found->second.nRetries_ == nRetries)
+    found->second.pendingInterestId_ = pendingInterestId;
+}
+
+bool
+SegmentFetcher::enqueueRetransmission
+  (uint64_t segment, ErrorCode errorCode, const string& message)
+{
+  PendingSegment& pending = pendingSegments_[segment];
+  if (pending.nRetries_ >= options_.getMaxRetries()) {
+    reportError(errorCode, message);
+    return false;
+  }
+
+  ++pending.nRetries_;
+  pending.isInRetxQueue_ = true;
+  retxQueue_.push_back(segment);
+  return true;
+}
+
+void
+SegmentFetcher::increaseWindow()
+{
+  if (options_.getUseConstantWindow())
+    return;
+
+  if (cwnd_ < ssthresh_)
+    // Slow start.
+    cwnd_ += options_.getAiStep();
+  else if (options_.getUseCubic()) {
+    double t = (ndn_getNowMilliseconds() - lastDecreaseTime_) / 1000.0;
+    double k = pow(wMax_ * (1 - CUBIC_BETA) / CUBIC_C, 1.0 / 3);
+    double wCubic = CUBIC_C * pow(t - k, 3) + wMax_;
+    // Don't grow slower than AIMD would in the same time (the TCP-friendly
+    // region in RFC 8312).
+    double rtt = rttEstimator_.getSmoothedRtt() > 0 ?
+      rttEstimator_.getSmoothedRtt() : rttEstimator_.getEstimatedRto();
+    double wEstimate = wMax_ * CUBIC_BETA +
+      3 * (1 - CUBIC_BETA) / (1 + CUBIC_BETA) * (t * 1000.0 / rtt);
+    // Limit the growth after a long time without congestion.
+    double target = min(max(wCubic, wEstimate), 1.5 * cwnd_);
+    if (target > cwnd_)
+      cwnd_ += (target - cwnd_) / cwnd_;
+  }
+  else
+    // Congestion avoidance.
+    cwnd_ += options_.getAiStep() / cwnd_;
+
+  cwnd_ = min(cwnd_, options_.getMaxWindow());
+}
+
+void
+SegmentFetcher::decreaseWindow(uint64_t segment)
+{
+  if (options_.getUseConstantWindow())
+    return;
+  if (hasRecoveryPoint_ && segment <= recoveryPoint_)
+    // We already decreased the window for this window of Interests.
+    return;
+
+  hasRecoveryPoint_ = true;
+  recoveryPoint_ = highInterest_;
+
+  if (options_.getUseCubic()) {
+    wMax_ = cwnd_;
+    ssthresh_ = max(2.0, cwnd_ * CUBIC_BETA);
+    lastDecreaseTime_ = ndn_getNowMilliseconds();
+  }
+  else
+    ssthresh_ = max(2.0, cwnd_ * options_.getMdCoefficient());
+  cwnd_ = min(ssthresh_, options_.getMaxWindow());
+  _LOG_TRACE("SegmentFetcher: Decreased the window to " << cwnd_ <<
+             " for segment " << segment);
+}
+
+void
+SegmentFetcher::setFinalSegment(uint64_t finalSegment)
+{
+  nSegments_ = (int64_t)finalSegment + 1;
+
+  // Cancel the Interests which were sent past the last segment.
+  map<uint64_t, PendingSegment>::iterator pending =
+    pendingSegments_.lower_bound((uint64_t)nSegments_);
+  while (pending != pendingSegments_.end()) {
+    if (!pending->second.isInRetxQueue_ &&
+        pending->second.pendingInterestId_ != 0)
+      face_.removePendingInterest(pending->second.pendingInterestId_);
+    pendingSegments_.erase(pending++);
+  }
+  deque<uint64_t> retxQueue;
+  for (size_t i = 0; i < retxQueue_.size(); ++i) {
+    if (retxQueue_[i] < (uint64_t)nSegments_)
+      retxQueue.push_back(retxQueue_[i]);
+  }
+  retxQueue_.swap(retxQueue);
+  receivedSegments_.erase
+    (receivedSegments_.lower_bound((uint64_t)nSegments_),
+     receivedSegments_.end());
+}
+
+void
+SegmentFetcher::stop()
+{
+  isStopped_ = true;
+
+  for (map<uint64_t, PendingSegment>::iterator pending =
+         pendingSegments_.begin();
+       pending != pendingSegments_.end(); ++pending) {
+    if (!pending->second.isInRetxQueue_ &&
+        pending->second.pendingInterestId_ != 0)
+      face_.removePendingInterest(pending->second.pendingInterestId_);
+  }
+  pendingSegments_.clear();
+  retxQueue_.clear();
+  segmentsWaitingForManifest_.clear();
+
+  if (outputFile_) {
+    // Keep the content which was written so far.
+    outputFile_->close(deliveredSize_);
+    outputFile_.reset();
+  }
+}
+
 }
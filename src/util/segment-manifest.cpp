@@ -0,0 +1,163 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Regents of the University of California.
+ * @author: Jeff Thompson <jefft0@remap.ucla.edu>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+#include <stdexcept>
+#include "../encoding/tlv-encoder.hpp"
+#include "../encoding/tlv-decoder.hpp"
+#include "../c/encoding/tlv/tlv.h"
+#include <ndn-cpp/util/segment-manifest.hpp>
+
+using namespace std;
+
+namespace ndn {
+
+Blob
+SegmentManifest::wireEncode() const
+{
+  // Encode directly as TLV. We don't support the WireFormat abstraction
+  // because this isn't meant to go directly on the wire.
+  TlvEncoder encoder
+    (16 + (digests_.size() + 1) * (ndn_SHA256_DIGEST_SIZE + 2));
+
+  encoder.writeNestedTlv(Tlv_SegmentManifest, encodeContent, this);
+
+  return encoder.finish();
+}
+
+void
+SegmentManifest::encodeContent(const void *context, TlvEncoder &encoder)
+{
+  const SegmentManifest& manifest = *(const SegmentManifest *)context;
+
+  for (size_t i = 0; i < manifest.digests_.size(); ++i)
+    encoder.writeBlobTlv
+      (ndn_Tlv_ImplicitSha256DigestComponent, manifest.digests_[i]);
+
+  if (!manifest.nextManifestDigest_.isNull())
+    encoder.writeBlobTlv
+      (Tlv_SegmentManifest_NextManifestDigest, manifest.nextManifestDigest_);
+}
+
+void
+SegmentManifest::wireDecode(const uint8_t *input, size_t inputLength)
+{
+  clear();
+
+  // Decode directly as TLV. We don't support the WireFormat abstraction
+  // because this isn't meant to go directly on the wire.
+  TlvDecoder decoder(input, inputLength);
+  size_t endOffset = decoder.readNestedTlvsStart(Tlv_SegmentManifest);
+
+  while (decoder.peekType(ndn_Tlv_ImplicitSha256DigestComponent, endOffset)) {
+    struct ndn_Blob digest =
+      decoder.readBlobTlv(ndn_Tlv_ImplicitSha256DigestComponent);
+    if (digest.length != ndn_SHA256_DIGEST_SIZE)
+      throw runtime_error
+        ("SegmentManifest: The segment digest is not the size of a SHA-256 digest");
+    digests_.push_back(Blob(digest.value, digest.length));
+  }
+
+  if (decoder.peekType(Tlv_SegmentManifest_NextManifestDigest, endOffset)) {
+    struct ndn_Blob digest =
+      decoder.readBlobTlv(Tlv_SegmentManifest_NextManifestDigest);
+    if (digest.length != ndn_SHA256_DIGEST_SIZE)
+      throw runtime_error
+        ("SegmentManifest: The next manifest digest is not the size of a SHA-256 digest");
+    nextManifestDigest_ = Blob(digest.value, digest.length);
+  }
+
+  decoder.finishNestedTlvs(endOffset);
+}
+
+void
+SegmentManifest::makeManifest
+  (const vector<ptr_lib::shared_ptr<Data> >& segments, KeyChain& keyChain,
+   vector<ptr_lib::shared_ptr<Data> >& manifests,
+   const SigningInfo& signingInfo, size_t maxDigestsPerManifest)
+{
+  if (segments.size() == 0)
+    throw runtime_error("SegmentManifest::makeManifest: There are no segments");
+  if (maxDigestsPerManifest == 0)
+    throw runtime_error
+      ("SegmentManifest::makeManifest: maxDigestsPerManifest must be positive");
+
+  SigningInfo digestSha256Info(SigningInfo::SIGNER_TYPE_SHA256);
+
+  // Sign the segments with only a digest and get their implicit digests. Get
+  // all the full names at once to use multi-buffer hashing.
+  for (size_t i = 0; i < segments.size(); ++i)
+    keyChain.sign(*segments[i], digestSha256Info);
+  vector<ptr_lib::shared_ptr<Name> > fullNames;
+  Data::getFullNames(segments, fullNames);
+  vector<Blob> digests;
+  digests.reserve(fullNames.size());
+  for (size_t i = 0; i < fullNames.size(); ++i)
+    digests.push_back(fullNames[i]->get(-1).getValue());
+
+  Name manifestPrefix = getManifestPrefix(segments[0]->getName().getPrefix(-1));
+  size_t nManifests =
+    (digests.size() + maxDigestsPerManifest - 1) / maxDigestsPerManifest;
+  Name::Component finalBlockId = Name::Component::fromSegment(nManifests - 1);
+
+  // Each manifest segment has the digest of the next one, so make them in
+  // reverse order.
+  vector<ptr_lib::shared_ptr<Data> > reversedManifests;
+  Blob nextManifestDigest;
+  for (size_t iManifest = nManifests; iManifest > 0; --iManifest) {
+    uint64_t manifestSegment = iManifest - 1;
+
+    SegmentManifest manifest;
+    size_t beginIndex = manifestSegment * maxDigestsPerManifest;
+    size_t endIndex = beginIndex + maxDigestsPerManifest;
+    if (endIndex > digests.size())
+      endIndex = digests.size();
+    for (size_t i = beginIndex; i < endIndex; ++i)
+      manifest.addDigest(digests[i]);
+    manifest.setNextManifestDigest(nextManifestDigest);
+
+    ptr_lib::shared_ptr<Data> data = ptr_lib::make_shared<Data>
+      (Name(manifestPrefix).appendSegment(manifestSegment));
+    data->setContent(manifest.wireEncode());
+    data->getMetaInfo().setFreshnessPeriod
+      (segments[0]->getMetaInfo().getFreshnessPeriod());
+    data->getMetaInfo().setFinalBlockId(finalBlockId);
+
+    if (manifestSegment == 0)
+      keyChain.sign(*data, signingInfo);
+    else
+      keyChain.sign(*data, digestSha256Info);
+
+    nextManifestDigest = data->getFullName()->get(-1).getValue();
+    reversedManifests.push_back(data);
+  }
+
+  manifests.insert
+    (manifests.end(), reversedManifests.rbegin(), reversedManifests.rend());
+}
+
+const Name::Component&
+SegmentManifest::getManifestComponent()
+{
+  static Name::Component manifestComponent("_manifest");
+  return manifestComponent;
+}
+
+}
@@ -0,0 +1,378 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Regents of the University of California.
+ * @author: Jeff Thompson <jefft0@remap.ucla.edu>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdexcept>
+#include <algorithm>
+#include "../c/util/time.h"
+#include <ndn-cpp/lite/util/crypto-lite.hpp>
+#include <ndn-cpp/digest-sha256-signature.hpp>
+#include <ndn-cpp/util/logging.hpp>
+#include <ndn-cpp/util/segment-publisher.hpp>
+
+using namespace std;
+using namespace ndn::func_lib;
+
+INIT_LOGGER("ndn.SegmentPublisher");
+
+namespace ndn {
+
+// Make this many segments for each thread before waiting for them to be
+// signed. This bounds the memory for publishFile.
+static const size_t SEGMENTS_PER_THREAD_BATCH = 16;
+
+/**
+ * A WorkerPool holds the threads which sign a batch of segments. The threads
+ * wait for a batch from sign(), then take the next unsigned segment until all
+ * are signed.
+ */
+class SegmentPublisher::WorkerPool {
+public:
+  /**
+   * Start the threads.
+   * @param publisher The SegmentPublisher whose signSegment is called.
+   * @param nThreads The number of threads.
+   * @throws runtime_error if a thread can't be started.
+   */
+  WorkerPool(SegmentPublisher& publisher, size_t nThreads)
+  : publisher_(publisher), segments_(0), nextIndex_(0), nRemaining_(0),
+    isStopping_(false)
+  {
+    pthread_mutex_init(&mutex_, 0);
+    pthread_cond_init(&workCondition_, 0);
+    pthread_cond_init(&doneCondition_, 0);
+
+    for (size_t i = 0; i < nThreads; ++i) {
+      pthread_t thread;
+      if (pthread_create(&thread, 0, &WorkerPool::run, this) != 0) {
+        stop();
+        throw runtime_error("SegmentPublisher: Cannot create a worker thread");
+      }
+      threads_.push_back(thread);
+    }
+  }
+
+  ~WorkerPool()
+  {
+    stop();
+    pthread_cond_destroy(&doneCondition_);
+    pthread_cond_destroy(&workCondition_);
+    pthread_mutex_destroy(&mutex_);
+  }
+
+  /**
+   * Sign the segments on the threads and wait until all are signed.
+   * @param segments The segments, which already have the SignatureInfo.
+   * @param begin The index in segments of the first segment to sign.
+   * @param keyName The key name for signSegment.
+   * @throws runtime_error for the first error from signSegment.
+   */
+  void
+  sign
+    (const vector<ptr_lib::shared_ptr<Data> >& segments, size_t begin,
+     const Name& keyName)
+  {
+    if (begin >= segments.size())
+      return;
+
+    pthread_mutex_lock(&mutex_);
+    segments_ = &segments;
+    keyName_ = keyName;
+    nextIndex_ = begin;
+    nRemaining_ = segments.size() - begin;
+    error_.clear();
+    pthread_cond_broadcast(&workCondition_);
+    while (nRemaining_ > 0)
+      pthread_cond_wait(&doneCondition_, &mutex_);
+    segments_ = 0;
+    string error = error_;
+    pthread_mutex_unlock(&mutex_);
+
+    if (!error.empty())
+      throw runtime_error(error);
+  }
+
+private:
+  static void*
+  run(void* arg)
+  {
+    WorkerPool& self = *(WorkerPool*)arg;
+
+    pthread_mutex_lock(&self.mutex_);
+    while (true) {
+      while (!self.isStopping_ &&
+             !(self.segments_ && self.nextIndex_ < self.segments_->size()))
+        pthread_cond_wait(&self.workCondition_, &self.mutex_);
+      if (self.isStopping_)
+        break;
+
+      Data& segment = *(*self.segments_)[self.nextIndex_];
+      ++self.nextIndex_;
+      pthread_mutex_unlock(&self.mutex_);
+
+      string error;
+      try {
+        self.publisher_.signSegment(segment, self.keyName_);
+      } catch (const std::exception& ex) {
+        error = ex.what();
+      }
+
+      pthread_mutex_lock(&self.mutex_);
+      if (!error.empty() && self.error_.empty())
+        self.error_ = error;
+      --self.nRemaining_;
+      if (self.nRemaining_ == 0)
+        pthread_cond_signal(&self.doneCondition_);
+    }
+    pthread_mutex_unlock(&self.mutex_);
+
+    return 0;
+  }
+
+  void
+  stop()
+  {
+    pthread_mutex_lock(&mutex_);
+    isStopping_ = true;
+    pthread_cond_broadcast(&workCondition_);
+    pthread_mutex_unlock(&mutex_);
+
+    for (size_t i = 0; i < threads_.size(); ++i)
+      pthread_join(threads_[i], 0);
+    threads_.clear();
+  }
+
+  SegmentPublisher& publisher_;
+  vector<pthread_t> threads_;
+  pthread_mutex_t mutex_;
+  pthread_cond_t workCondition_;
+  pthread_cond_t doneCondition_;
+  // The following are protected by mutex_.
+  const vector<ptr_lib::shared_ptr<Data> >* segments_;
+  Name keyName_;
+  size_t nextIndex_;
+  size_t nRemaining_;
+  bool isStopping_;
+  string error_;
+};
+
+namespace {
+
+/**
+ * A BufferReader reads the content for publishSegments from a buffer,
+ * advancing the pointer.
+ */
+class BufferReader {
+public:
+  BufferReader(const uint8_t* content)
+  : content_(content)
+  {
+  }
+
+  void
+  read(uint8_t* buffer, size_t length)
+  {
+    copy(content_, content_ + length, buffer);
+    content_ += length;
+  }
+
+private:
+  const uint8_t* content_;
+};
+
+}
+
+SegmentPublisher::SegmentPublisher(KeyChain& keyChain, const Options& options)
+: keyChain_(keyChain), options_(options), lastSegmentCount_(0),
+  lastThroughput_(0)
+{
+  if (options_.getSegmentSize() == 0)
+    throw runtime_error("SegmentPublisher: The segment size must be at least 1");
+  if (options_.getNThreads() == 0)
+    throw runtime_error("SegmentPublisher: The number of threads must be at least 1");
+
+  // Security v1 has no Tpm for signing on the worker threads.
+  if (options_.getNThreads() > 1 && !keyChain_.getIsSecurityV1())
+    workerPool_.reset(new WorkerPool(*this, options_.getNThreads()));
+}
+
+SegmentPublisher::~SegmentPublisher()
+{
+}
+
+Name
+SegmentPublisher::publish
+  (const Name& prefix, const uint8_t* content, size_t contentLength,
+   const OnSegment& onSegment)
+{
+  BufferReader reader(content);
+  return publishSegments
+    (prefix, contentLength, bind(&BufferReader::read, &reader, _1, _2),
+     onSegment);
+}
+
+/**
+ * Read length bytes from the file into the buffer.
+ * @throws runtime_error if the file can't be read.
+ */
+static void
+readFile(FILE* file, uint8_t* buffer, size_t length)
+{
+  if (fread(buffer, 1, length, file) != length)
+    throw runtime_error("SegmentPublisher: Cannot read the file");
+}
+
+Name
+SegmentPublisher::publishFile
+  (const Name& prefix, const string& filePath, const OnSegment& onSegment)
+{
+  FILE* file = fopen(filePath.c_str(), "rb");
+  if (!file)
+    throw runtime_error("SegmentPublisher: Cannot open the file " + filePath);
+
+  try {
+    if (fseek(file, 0, SEEK_END) != 0)
+      throw runtime_error("SegmentPublisher: Cannot seek in the file " + filePath);
+    long fileSize = ftell(file);
+    if (fileSize < 0 || fseek(file, 0, SEEK_SET) != 0)
+      throw runtime_error
+        ("SegmentPublisher: Cannot get the size of the file " + filePath);
+
+    Name result = publishSegments
+      (prefix, (uint64_t)fileSize, bind(&readFile, file, _1, _2), onSegment);
+    fclose(file);
+    return result;
+  } catch (...) {
+    fclose(file);
+    throw;
+  }
+}
+
+Name
+SegmentPublisher::publishSegments
+  (const Name& prefix, uint64_t contentLength,
+   const func_lib::function<void(uint8_t* buffer, size_t length)>& readContent,
+   const OnSegment& onSegment)
+{
+  MillisecondsSince1970 startTime = ndn_getNowMilliseconds();
+  Name versionedName(prefix);
+  versionedName.appendVersion((uint64_t)startTime);
+
+  size_t segmentSize = options_.getSegmentSize();
+  // Publish one segment for empty content.
+  uint64_t nSegments = max
+    ((uint64_t)1, (contentLength + segmentSize - 1) / segmentSize);
+  Name::Component finalBlockId = Name::Component::fromSegment(nSegments - 1);
+  size_t batchSize = workerPool_ ?
+    options_.getNThreads() * SEGMENTS_PER_THREAD_BATCH : 1;
+
+  ptr_lib::shared_ptr<Signature> signatureInfo;
+  Name keyName;
+  vector<ptr_lib::shared_ptr<Data> > batch;
+  uint64_t offset = 0;
+  for (uint64_t segmentNo = 0; segmentNo < nSegments; ) {
+    // Make the segments in the batch.
+    size_t nBatchSegments = (size_t)min((uint64_t)batchSize, nSegments - segmentNo);
+    batch.clear();
+    for (size_t i = 0; i < nBatchSegments; ++i) {
+      size_t length = (size_t)min((uint64_t)segmentSize, contentLength - offset);
+      ptr_lib::shared_ptr<vector<uint8_t> > value(new vector<uint8_t>(length));
+      if (length > 0)
+        readContent(&value->front(), length);
+      offset += length;
+
+      ptr_lib::shared_ptr<Data> segment(new Data
+        (Name(versionedName).appendSegment(segmentNo + i)));
+      segment->setContent(Blob(value, false));
+      if (options_.getFreshnessPeriod() >= 0)
+        segment->getMetaInfo().setFreshnessPeriod(options_.getFreshnessPeriod());
+      segment->getMetaInfo().setFinalBlockId(finalBlockId);
+      if (signatureInfo)
+        segment->setSignature(*signatureInfo);
+      batch.push_back(segment);
+    }
+
+    size_t begin = 0;
+    if (workerPool_ && !signatureInfo) {
+      // Sign the first segment on this thread to get the SignatureInfo and to
+      // make the Tpm load the key before the worker threads use it.
+      keyChain_.sign(*batch[0], options_.getSigningInfo());
+      begin = 1;
+
+      signatureInfo = batch[0]->getSignature()->clone();
+      if (!dynamic_cast<const DigestSha256Signature*>(signatureInfo.get()))
+        keyName = KeyLocator::getFromSignature(signatureInfo.get()).getKeyName();
+      for (size_t i = 1; i < batch.size(); ++i)
+        batch[i]->setSignature(*signatureInfo);
+    }
+
+    if (workerPool_)
+      workerPool_->sign(batch, begin, keyName);
+    else {
+      for (size_t i = 0; i < batch.size(); ++i)
+        keyChain_.sign(*batch[i], options_.getSigningInfo());
+    }
+
+    for (size_t i = 0; i < batch.size(); ++i)
+      onSegment(*batch[i]);
+
+    segmentNo += nBatchSegments;
+  }
+
+  lastSegmentCount_ = nSegments;
+  Milliseconds duration = ndn_getNowMilliseconds() - startTime;
+  // Avoid dividing by zero for a small object.
+  lastThroughput_ = contentLength / 1000.0 / max(duration, 0.001);
+  _LOG_DEBUG("SegmentPublisher: Published " << versionedName << " in " <<
+             nSegments << " segments at " << lastThroughput_ << " MB/s");
+
+  return versionedName;
+}
+
+void
+SegmentPublisher::signSegment(Data& segment, const Name& keyName)
+{
+  // Encode once to get the signed portion.
+  SignedBlob encoding = segment.wireEncode();
+
+  Blob signatureBits;
+  if (keyName.size() == 0) {
+    uint8_t digest[ndn_SHA256_DIGEST_SIZE];
+    CryptoLite::digestSha256
+      (encoding.signedBuf(), encoding.signedSize(), digest);
+    signatureBits = Blob(digest, sizeof(digest));
+  }
+  else {
+    signatureBits = keyChain_.getTpm().sign
+      (encoding.signedBuf(), encoding.signedSize(), keyName,
+       options_.getSigningInfo().getDigestAlgorithm());
+    if (signatureBits.isNull())
+      throw runtime_error
+        ("SegmentPublisher: Cannot sign with key " + keyName.toUri());
+  }
+  segment.getSignature()->setSignature(signatureBits);
+
+  // Encode again to include the signature.
+  segment.wireEncode();
+}
+
+}
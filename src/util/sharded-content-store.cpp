@@ -0,0 +1,306 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Regents of the University of California.
+ * @author: Jeff Thompson <jefft0@remap.ucla.edu>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+#include <pthread.h>
+#include <map>
+#include <stdexcept>
+#include "../c/util/time.h"
+#include <ndn-cpp/util/logging.hpp>
+#include <ndn-cpp/util/sharded-content-store.hpp>
+#include "best-match.hpp"
+
+using namespace std;
+
+INIT_LOGGER("ndn.ShardedContentStore");
+
+namespace ndn {
+
+/**
+ * A Shard holds the Data packets for the names whose shard key hashes to it,
+ * and the reader-writer lock which protects them.
+ */
+class ShardedContentStore::Shard {
+public:
+  class Entry {
+  public:
+    Entry(const Blob& encoding, MillisecondsSince1970 freshnessExpiryTime)
+    : encoding_(encoding), freshnessExpiryTimeMilliseconds_(freshnessExpiryTime)
+    {
+    }
+
+    /**
+     * Check if the Data packet is still fresh.
+     * @param nowMilliseconds The current time in milliseconds from
+     * ndn_getNowMilliseconds.
+     * @return True if the Data packet has no FreshnessPeriod or it has not
+     * expired.
+     */
+    bool
+    isFresh(MillisecondsSince1970 nowMilliseconds) const
+    {
+      return freshnessExpiryTimeMilliseconds_ < 0 ||
+        freshnessExpiryTimeMilliseconds_ > nowMilliseconds;
+    }
+
+    Blob encoding_;
+    // -1 if the Data packet has no FreshnessPeriod.
+    MillisecondsSince1970 freshnessExpiryTimeMilliseconds_;
+  };
+
+  typedef std::map<Name, Entry> NameIndex;
+
+  Shard()
+  {
+    if (pthread_rwlock_init(&lock_, 0) != 0)
+      throw runtime_error("ShardedContentStore: Cannot initialize the lock");
+  }
+
+  ~Shard() { pthread_rwlock_destroy(&lock_); }
+
+  /**
+   * Find the entry in index_ which best matches the interest, in the same way
+   * as MemoryContentCache. The caller must hold the lock.
+   * @param interest The Interest to match.
+   * @param nowMilliseconds The current time in milliseconds from
+   * ndn_getNowMilliseconds, to check MustBeFresh.
+   * @return The matching entry in index_, or index_.end() if not found.
+   */
+  NameIndex::const_iterator
+  findBestMatch
+    (const Interest& interest, MillisecondsSince1970 nowMilliseconds) const;
+
+  NameIndex index_;
+  mutable pthread_rwlock_t lock_;
+
+private:
+  // Disable the copy constructor and assignment operator.
+  Shard(const Shard& other);
+  Shard& operator=(const Shard& other);
+};
+
+namespace {
+
+/**
+ * ReadLock holds the read lock of a Shard until it goes out of scope.
+ */
+class ReadLock {
+public:
+  ReadLock(pthread_rwlock_t& lock)
+  : lock_(lock)
+  {
+    pthread_rwlock_rdlock(&lock_);
+  }
+
+  ~ReadLock() { pthread_rwlock_unlock(&lock_); }
+
+private:
+  pthread_rwlock_t& lock_;
+};
+
+/**
+ * WriteLock holds the write lock of a Shard until it goes out of scope.
+ */
+class WriteLock {
+public:
+  WriteLock(pthread_rwlock_t& lock)
+  : lock_(lock)
+  {
+    pthread_rwlock_wrlock(&lock_);
+  }
+
+  ~WriteLock() { pthread_rwlock_unlock(&lock_); }
+
+private:
+  pthread_rwlock_t& lock_;
+};
+
+}
+
+ShardedContentStore::ShardedContentStore
+  (size_t nShards, size_t nShardKeyComponents)
+: nShardKeyComponents_(nShardKeyComponents)
+{
+  if (nShards == 0)
+    throw runtime_error("ShardedContentStore: nShards must be at least 1");
+
+  for (size_t i = 0; i < nShards; ++i)
+    shards_.push_back(ptr_lib::make_shared<Shard>());
+}
+
+ShardedContentStore::~ShardedContentStore()
+{
+}
+
+void
+ShardedContentStore::add(const Data& data)
+{
+  // Encode before getting the lock.
+  Blob encoding = data.wireEncode();
+  MillisecondsSince1970 freshnessExpiryTime = -1;
+  Milliseconds freshnessPeriod = data.getMetaInfo().getFreshnessPeriod();
+  if (freshnessPeriod >= 0.0)
+    freshnessExpiryTime = ndn_getNowMilliseconds() + freshnessPeriod;
+  const Name& name = data.getName();
+
+  Shard& shard = getShard(name);
+  WriteLock lock(shard.lock_);
+  Shard::NameIndex::iterator entry = shard.index_.find(name);
+  if (entry != shard.index_.end())
+    entry->second = Shard::Entry(encoding, freshnessExpiryTime);
+  else
+    shard.index_.insert
+      (Shard::NameIndex::value_type
+       (name, Shard::Entry(encoding, freshnessExpiryTime)));
+}
+
+bool
+ShardedContentStore::remove(const Name& name)
+{
+  Shard& shard = getShard(name);
+  WriteLock lock(shard.lock_);
+  return shard.index_.erase(name) > 0;
+}
+
+Blob
+ShardedContentStore::find(const Interest& interest) const
+{
+  MillisecondsSince1970 nowMilliseconds = ndn_getNowMilliseconds();
+  const Name& interestName = interest.getName();
+
+  if (interestName.size() >= nShardKeyComponents_) {
+    // All the matching names have the same shard key.
+    Shard& shard = getShard(interestName);
+    ReadLock lock(shard.lock_);
+    Shard::NameIndex::const_iterator entry =
+      shard.findBestMatch(interest, nowMilliseconds);
+    if (entry == shard.index_.end())
+      return Blob();
+    return entry->second.encoding_;
+  }
+
+  // The matching names can be in any shard, so get the best match from each
+  // and choose the leftmost or rightmost in the canonical order.
+  bool haveMatch = false;
+  Name bestName;
+  Blob bestEncoding;
+  for (size_t i = 0; i < shards_.size(); ++i) {
+    const Shard& shard = *shards_[i];
+    ReadLock lock(shard.lock_);
+    Shard::NameIndex::const_iterator entry =
+      shard.findBestMatch(interest, nowMilliseconds);
+    if (entry == shard.index_.end())
+      continue;
+
+    int comparison = entry->first.compare(bestName);
+    if (!haveMatch ||
+        (interest.getChildSelector() == 1 ? comparison > 0 : comparison < 0)) {
+      haveMatch = true;
+      bestName = entry->first;
+      bestEncoding = entry->second.encoding_;
+    }
+  }
+
+  return bestEncoding;
+}
+
+size_t
+ShardedContentStore::removeStaleContent()
+{
+  MillisecondsSince1970 nowMilliseconds = ndn_getNowMilliseconds();
+  size_t nRemoved = 0;
+
+  for (size_t i = 0; i < shards_.size(); ++i) {
+    Shard& shard = *shards_[i];
+    WriteLock lock(shard.lock_);
+    for (Shard::NameIndex::iterator entry = shard.index_.begin();
+         entry != shard.index_.end(); ) {
+      if (!entry->second.isFresh(nowMilliseconds)) {
+        shard.index_.erase(entry++);
+        ++nRemoved;
+      }
+      else
+        ++entry;
+    }
+  }
+
+  return nRemoved;
+}
+
+size_t
+ShardedContentStore::size() const
+{
+  size_t result = 0;
+  for (size_t i = 0; i < shards_.size(); ++i) {
+    const Shard& shard = *shards_[i];
+    ReadLock lock(shard.lock_);
+    result += shard.index_.size();
+  }
+
+  return result;
+}
+
+void
+ShardedContentStore::onInterest
+  (const ptr_lib::shared_ptr<const Name>& prefix,
+   const ptr_lib::shared_ptr<const Interest>& interest, Face& face,
+   uint64_t interestFilterId,
+   const ptr_lib::shared_ptr<const InterestFilter>& filter)
+{
+  Blob encoding = find(*interest);
+  if (!encoding.isNull()) {
+    _LOG_TRACE("ShardedContentStore: Reply Data for " << interest->getName());
+    face.send(*encoding);
+    return;
+  }
+
+  _LOG_TRACE("ShardedContentStore: onDataNotFound for " << interest->getName());
+  if (onDataNotFound_) {
+    try {
+      onDataNotFound_(prefix, interest, face, interestFilterId, filter);
+    } catch (const std::exception& ex) {
+      _LOG_ERROR("ShardedContentStore::onInterest: Error in onDataNotFound: " << ex.what());
+    } catch (...) {
+      _LOG_ERROR("ShardedContentStore::onInterest: Error in onDataNotFound.");
+    }
+  }
+}
+
+ShardedContentStore::Shard&
+ShardedContentStore::getShard(const Name& name) const
+{
+  size_t nComponents = min(name.size(), nShardKeyComponents_);
+  // Use the same hash as Name::hash, which we can't call on a prefix without
+  // copying it.
+  size_t hashCode = 0;
+  for (size_t i = 0; i < nComponents; ++i)
+    hashCode = 37 * hashCode + name.get(i).hash();
+
+  return *shards_[hashCode % shards_.size()];
+}
+
+ShardedContentStore::Shard::NameIndex::const_iterator
+ShardedContentStore::Shard::findBestMatch
+  (const Interest& interest, MillisecondsSince1970 nowMilliseconds) const
+{
+  return findBestMatchInIndex(index_, interest, IsFreshAt(nowMilliseconds));
+}
+
+}
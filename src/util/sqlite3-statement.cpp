@@ -32,15 +32,136 @@ using namespace std;
 namespace ndn {
 
 Sqlite3Statement::Sqlite3Statement(sqlite3* database, const string& statement)
+: cacheEntry_(0)
 {
   int result = sqlite3_prepare_v2(database, statement.c_str(), -1, &statement_, 0);
   if (result != SQLITE_OK)
     throw domain_error("Error preparing SQL statement: " + statement);
 }
 
+Sqlite3Statement::Sqlite3Statement
+  (Sqlite3StatementCache& cache, const string& statement)
+{
+  cacheEntry_ = cache.acquire(statement);
+  if (cacheEntry_)
+    statement_ = cacheEntry_->statement_;
+  else {
+    int result = sqlite3_prepare_v2
+      (cache.getDatabase(), statement.c_str(), -1, &statement_, 0);
+    if (result != SQLITE_OK)
+      throw domain_error("Error preparing SQL statement: " + statement);
+  }
+}
+
 Sqlite3Statement::~Sqlite3Statement()
 {
-  sqlite3_finalize(statement_);
+  if (cacheEntry_) {
+    sqlite3_reset(statement_);
+    sqlite3_clear_bindings(statement_);
+    cacheEntry_->isInUse_ = false;
+  }
+  else
+    sqlite3_finalize(statement_);
+}
+
+Sqlite3StatementCache::~Sqlite3StatementCache()
+{
+  for (map<string, Entry>::iterator i = statements_.begin();
+       i != statements_.end(); ++i)
+    sqlite3_finalize(i->second.statement_);
+}
+
+Sqlite3StatementCache::Entry*
+Sqlite3StatementCache::acquire(const string& sql)
+{
+  map<string, Entry>::iterator found = statements_.find(sql);
+  if (found != statements_.end()) {
+    if (found->second.isInUse_)
+      return 0;
+
+    found->second.isInUse_ = true;
+    return &found->second;
+  }
+
+  sqlite3_stmt* statement;
+  int result = sqlite3_prepare_v2(database_, sql.c_str(), -1, &statement, 0);
+  if (result != SQLITE_OK)
+    throw domain_error("Error preparing SQL statement: " + sql);
+
+  Entry& entry = statements_[sql];
+  entry.statement_ = statement;
+  entry.isInUse_ = true;
+  return &entry;
+}
+
+int
+Sqlite3StatementCache::enableWriteAheadLog(Sqlite3Synchronous::Level level)
+{
+  int result = exec("PRAGMA journal_mode=WAL");
+  if (result != SQLITE_OK)
+    return result;
+
+  return setSynchronous(level);
+}
+
+int
+Sqlite3StatementCache::setSynchronous(Sqlite3Synchronous::Level level)
+{
+  switch (level) {
+  case Sqlite3Synchronous::OFF:    return exec("PRAGMA synchronous=OFF");
+  case Sqlite3Synchronous::NORMAL: return exec("PRAGMA synchronous=NORMAL");
+  case Sqlite3Synchronous::FULL:   return exec("PRAGMA synchronous=FULL");
+  case Sqlite3Synchronous::EXTRA:  return exec("PRAGMA synchronous=EXTRA");
+  default:                         return SQLITE_MISUSE;
+  }
+}
+
+int
+Sqlite3StatementCache::beginTransaction()
+{
+  if (transactionDepth_ == 0) {
+    // Take the write lock now so that a transaction which reads before it
+    // writes can't fail with SQLITE_BUSY when upgrading the lock.
+    int result = exec("BEGIN IMMEDIATE");
+    if (result != SQLITE_OK)
+      return result;
+  }
+
+  ++transactionDepth_;
+  return SQLITE_OK;
+}
+
+int
+Sqlite3StatementCache::commitTransaction()
+{
+  if (transactionDepth_ == 0)
+    return SQLITE_MISUSE;
+
+  if (transactionDepth_ == 1) {
+    int result = exec("COMMIT");
+    if (result != SQLITE_OK)
+      // Leave the transaction open so that the caller can roll back.
+      return result;
+  }
+
+  --transactionDepth_;
+  return SQLITE_OK;
+}
+
+int
+Sqlite3StatementCache::rollbackTransaction()
+{
+  if (transactionDepth_ == 0)
+    return SQLITE_OK;
+
+  transactionDepth_ = 0;
+  return exec("ROLLBACK");
+}
+
+int
+Sqlite3StatementCache::exec(const char* sql)
+{
+  return sqlite3_exec(database_, sql, NULL, NULL, NULL);
 }
 
 }
@@ -28,11 +28,142 @@
 #ifdef NDN_CPP_HAVE_SQLITE3
 
 #include <string>
+#include <map>
 #include <sqlite3.h>
 #include <ndn-cpp/util/blob.hpp>
+#include <ndn-cpp/util/sqlite3-synchronous.hpp>
 
 namespace ndn {
 
+/**
+ * Sqlite3StatementCache holds the per-connection state for an SQLite3
+ * database handle: the prepared statements which are reused by
+ * Sqlite3Statement, and the nesting depth of transactions. This does not own
+ * the database handle, but the destructor must be called before the owner
+ * calls sqlite3_close.
+ */
+class Sqlite3StatementCache
+{
+public:
+  /**
+   * Create an Sqlite3StatementCache for the database handle.
+   * @param database The handle to the open SQLite3 database.
+   */
+  Sqlite3StatementCache(sqlite3* database)
+  : database_(database), transactionDepth_(0)
+  {
+  }
+
+  /**
+   * Finalize all cached statements.
+   */
+  ~Sqlite3StatementCache();
+
+  /**
+   * Get the database handle given to the constructor.
+   * @return The database handle.
+   */
+  sqlite3*
+  getDatabase() { return database_; }
+
+  /**
+   * Get the number of cached prepared statements.
+   * @return The number of statements.
+   */
+  size_t
+  size() const { return statements_.size(); }
+
+  /**
+   * Set the database to use write-ahead logging (WAL) instead of the rollback
+   * journal, and set the synchronous level. WAL lets readers run at the same
+   * time as a writer and needs fewer disk syncs for each transaction.
+   * @param level The synchronous level.
+   * @return SQLite result value.
+   */
+  int
+  enableWriteAheadLog(Sqlite3Synchronous::Level level);
+
+  /**
+   * Set the level for "PRAGMA synchronous".
+   * @param level The synchronous level.
+   * @return SQLite result value.
+   */
+  int
+  setSynchronous(Sqlite3Synchronous::Level level);
+
+  /**
+   * Begin a transaction so that the following statements are committed
+   * together by commitTransaction(). Transactions may be nested, in which case
+   * only the outermost transaction is committed to the database.
+   * @return SQLite result value.
+   */
+  int
+  beginTransaction();
+
+  /**
+   * End the transaction begun by beginTransaction(). If this is the outermost
+   * transaction, commit it.
+   * @return SQLite result value, or SQLITE_MISUSE if there is no transaction.
+   */
+  int
+  commitTransaction();
+
+  /**
+   * Roll back the outermost transaction, including all nested transactions.
+   * If there is no transaction, do nothing.
+   * @return SQLite result value.
+   */
+  int
+  rollbackTransaction();
+
+  /**
+   * Get the nesting depth of transactions begun by beginTransaction().
+   * @return The depth, or 0 if not in a transaction.
+   */
+  int
+  getTransactionDepth() const { return transactionDepth_; }
+
+private:
+  friend class Sqlite3Statement;
+
+  class Entry {
+  public:
+    Entry()
+    : statement_(0), isInUse_(false)
+    {}
+
+    sqlite3_stmt* statement_;
+    bool isInUse_;
+  };
+
+  /**
+   * Get the cached prepared statement for the SQL, preparing it if needed,
+   * and mark it as in use.
+   * @param sql The SQL statement.
+   * @return The Entry, or 0 if the cached statement is already in use (by a
+   * caller higher on the stack) so that the caller must prepare its own.
+   * @throws std::domain_error SQL statement is bad
+   */
+  Entry*
+  acquire(const std::string& sql);
+
+  /**
+   * Run the SQL with sqlite3_exec, ignoring the result rows.
+   * @param sql The SQL statement.
+   * @return SQLite result value.
+   */
+  int
+  exec(const char* sql);
+
+  // Disable the copy constructor and assignment operator.
+  Sqlite3StatementCache(const Sqlite3StatementCache& other);
+  Sqlite3StatementCache& operator=(const Sqlite3StatementCache& other);
+
+  sqlite3* database_;
+  std::map<std::string, Entry> statements_;
+  int transactionDepth_;
+};
+
 /*
  * Sqlite3Statement is a utility class to wrap an SQLite3 prepared statement,
  * provide access methods, and finalize the statement in the destructor.
@@ -49,7 +180,18 @@ public:
   Sqlite3Statement(sqlite3* database, const std::string& statement);
 
   /**
-   * Finalize the statement.
+   * Create an Sqlite3Statement to use the prepared statement in the cache,
+   * preparing it the first time. If the cached statement is already in use,
+   * prepare a separate statement as in the other constructor.
+   * @param cache The Sqlite3StatementCache for the database.
+   * @param statement The SQL statement.
+   * @throws std::domain_error SQL statement is bad
+   */
+  Sqlite3Statement(Sqlite3StatementCache& cache, const std::string& statement);
+
+  /**
+   * If the statement is from the cache, reset it and clear the bindings so
+   * that it can be reused. Otherwise, finalize the statement.
    */
   ~Sqlite3Statement();
 
@@ -186,6 +328,8 @@ private:
   Sqlite3Statement& operator=(const Sqlite3Statement& other);
 
   sqlite3_stmt* statement_;
+  // If not 0, statement_ is from the Sqlite3StatementCache.
+  Sqlite3StatementCache::Entry* cacheEntry_;
 };
 
 }
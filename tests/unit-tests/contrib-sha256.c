@@ -0,0 +1,30 @@
+/**
+ * Copyright (C) 2020 Regents of the University of California.
+ * @author: Jeff Thompson <jefft0@remap.ucla.edu>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+/**
+ * Compile contrib/openssl/sha256.c as if libcrypto is not available, which is
+ * the only configuration where its SHA extensions (SHA-NI) code is used, so
+ * that test-contrib-sha256 can check it against libcrypto.
+ */
+
+#undef NDN_CPP_HAVE_LIBCRYPTO
+#define NDN_CPP_HAVE_LIBCRYPTO 0
+#include "contrib-sha256.h"
+#include "../../contrib/openssl/sha256.c"
@@ -0,0 +1,41 @@
+/**
+ * Copyright (C) 2020 Regents of the University of California.
+ * @author: Jeff Thompson <jefft0@remap.ucla.edu>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+/**
+ * This renames the functions of contrib/openssl/sha256.c so that a test can
+ * link it together with libcrypto. Include this before contrib/openssl/sha.h.
+ */
+
+#ifndef NDN_CONTRIB_SHA256_H
+#define NDN_CONTRIB_SHA256_H
+
+#define SHA224_Init ndn_contrib_SHA224_Init
+#define SHA224_Update ndn_contrib_SHA224_Update
+#define SHA224_Final ndn_contrib_SHA224_Final
+#define SHA224 ndn_contrib_SHA224
+#define SHA256_Init ndn_contrib_SHA256_Init
+#define SHA256_Update ndn_contrib_SHA256_Update
+#define SHA256_Final ndn_contrib_SHA256_Final
+#define SHA256 ndn_contrib_SHA256
+#define SHA256_Transform ndn_contrib_SHA256_Transform
+
+#include "../../contrib/openssl/sha.h"
+
+#endif
@@ -0,0 +1,133 @@
+/**
+ * Copyright (C) 2020 Regents of the University of California.
+ * @author: Jeff Thompson <jefft0@remap.ucla.edu>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+#include <stdexcept>
+#include "gtest/gtest.h"
+#include "../../src/sync/detail/bloom-filter.hpp"
+
+using namespace std;
+using namespace ndn;
+
+class TestBloomFilter : public ::testing::Test {
+};
+
+TEST_F(TestBloomFilter, InsertAndContains)
+{
+  BloomFilter bloomFilter(100, 0.001);
+  Name prefix("/test/memphis");
+
+  ASSERT_FALSE(bloomFilter.contains(prefix));
+  bloomFilter.insert(prefix);
+  ASSERT_TRUE(bloomFilter.contains(prefix));
+
+  uint32_t h1, h2;
+  BloomFilter::getHashes(prefix, h1, h2);
+  ASSERT_TRUE(bloomFilter.contains(h1, h2));
+
+  bloomFilter.clear();
+  ASSERT_FALSE(bloomFilter.contains(prefix));
+}
+
+TEST_F(TestBloomFilter, EncodeDecode)
+{
+  BloomFilter bloomFilter(100, 0.001);
+  for (int i = 0; i < 50; ++i)
+    bloomFilter.insert(Name("/test").appendNumber(i));
+
+  Name name("/sync");
+  bloomFilter.appendToName(name);
+  ASSERT_EQ(1 + BloomFilter::N_NAME_COMPONENTS, name.size());
+
+  BloomFilter bloomFilter2(name);
+  ASSERT_EQ(100, bloomFilter2.getProjectedElementCount());
+  ASSERT_EQ(0.001, bloomFilter2.getFalsePositiveProbability());
+  ASSERT_EQ(bloomFilter.getHashCount_(), bloomFilter2.getHashCount_());
+  for (int i = 0; i < 50; ++i)
+    ASSERT_TRUE(bloomFilter2.contains(Name("/test").appendNumber(i)));
+
+  // Encoding again gives the same name.
+  Name name2("/sync");
+  bloomFilter2.appendToName(name2);
+  ASSERT_TRUE(name.equals(name2));
+}
+
+TEST_F(TestBloomFilter, FalsePositiveRate)
+{
+  BloomFilter bloomFilter(1000, 0.01);
+  for (int i = 0; i < 1000; ++i)
+    bloomFilter.insert(Name("/inserted").appendNumber(i));
+
+  int nFalsePositives = 0;
+  const int nChecks = 10000;
+  for (int i = 0; i < nChecks; ++i) {
+    if (bloomFilter.contains(Name("/not-inserted").appendNumber(i)))
+      ++nFalsePositives;
+  }
+
+  // Allow for variation above the expected 1%.
+  ASSERT_LT(nFalsePositives, nChecks * 3 / 100);
+}
+
+TEST_F(TestBloomFilter, BadEncoding)
+{
+  ASSERT_THROW(BloomFilter(10, 0.0), runtime_error);
+  ASSERT_THROW(BloomFilter(10, 1.0), runtime_error);
+
+  BloomFilter bloomFilter(100, 0.001);
+  Name name;
+  bloomFilter.appendToName(name);
+
+  // Replace the bit table with one of the wrong size.
+  Name badName(name.getPrefix(-1));
+  uint8_t bits[] = { 1, 2, 3 };
+  badName.append(bits, sizeof(bits));
+  ASSERT_THROW(BloomFilter bloomFilter2(badName), runtime_error);
+
+  ASSERT_THROW(BloomFilter bloomFilter3(Name("/a")), runtime_error);
+}
+
+TEST_F(TestBloomFilter, HostileEncoding)
+{
+  uint8_t bits[] = { 1, 2, 3 };
+
+  // A huge projected element count must fail without allocating the bit
+  // table.
+  uint64_t counts[] = {
+    BloomFilter::MAX_PROJECTED_ELEMENT_COUNT + 1, 1ULL << 40,
+    0x7fffffffffffffffULL, 0xffffffffffffffffULL };
+  for (size_t i = 0; i < sizeof(counts) / sizeof(counts[0]); ++i) {
+    Name name("/sync");
+    name.appendNumber(counts[i]).appendNumber(1).append(bits, sizeof(bits));
+    ASSERT_THROW(BloomFilter bloomFilter(name), runtime_error);
+  }
+
+  // The maximum count with a small bit table is rejected by the size check.
+  Name name("/sync");
+  name.appendNumber(BloomFilter::MAX_PROJECTED_ELEMENT_COUNT).appendNumber(1)
+    .append(bits, sizeof(bits));
+  ASSERT_THROW(BloomFilter bloomFilter(name), runtime_error);
+}
+
+int
+main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,205 @@
+/**
+ * Copyright (C) 2020 Regents of the University of California.
+ * @author: Jeff Thompson <jefft0@remap.ucla.edu>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+#include "gtest/gtest.h"
+#include <ndn-cpp/util/cache-eviction-policy-lru.hpp>
+#include <ndn-cpp/util/cache-eviction-policy-lfu.hpp>
+#include <ndn-cpp/util/cache-eviction-policy-arc.hpp>
+#include <ndn-cpp/util/memory-content-cache.hpp>
+#include <ndn-cpp/in-memory-storage/in-memory-storage-retaining.hpp>
+
+using namespace std;
+using namespace ndn;
+using namespace ndn::func_lib;
+
+static void
+onContentRemoved
+  (const ptr_lib::shared_ptr<MemoryContentCache::ContentList>& contentList,
+   vector<Name>& removedNames)
+{
+  for (size_t i = 0; i < contentList->size(); ++i)
+    removedNames.push_back((*contentList)[i]->getName());
+}
+
+class TestCacheEvictionPolicy : public ::testing::Test {
+};
+
+TEST_F(TestCacheEvictionPolicy, Lru)
+{
+  CacheEvictionPolicyLru policy(300);
+  policy.insert(Name("/A"), 100);
+  policy.insert(Name("/B"), 100);
+  policy.insert(Name("/C"), 100);
+  ASSERT_EQ(300, policy.getByteCount());
+  ASSERT_TRUE(!policy.isOverBudget());
+
+  policy.access(Name("/A"));
+  policy.miss();
+  policy.insert(Name("/D"), 100);
+  ASSERT_TRUE(policy.isOverBudget());
+  Name name;
+  ASSERT_TRUE(policy.evict(name));
+  ASSERT_TRUE(name.equals(Name("/B")));
+  ASSERT_TRUE(!policy.isOverBudget());
+
+  // Replacing an entry updates the byte count.
+  policy.insert(Name("/A"), 50);
+  ASSERT_EQ(250, policy.getByteCount());
+  policy.erase(Name("/C"));
+  ASSERT_EQ(150, policy.getByteCount());
+
+  ASSERT_EQ(1, policy.getHitCount());
+  ASSERT_EQ(1, policy.getMissCount());
+  ASSERT_EQ(1, policy.getEvictionCount());
+}
+
+TEST_F(TestCacheEvictionPolicy, Lfu)
+{
+  CacheEvictionPolicyLfu policy(300);
+  policy.insert(Name("/A"), 100);
+  policy.insert(Name("/B"), 100);
+  policy.insert(Name("/C"), 100);
+  policy.access(Name("/A"));
+  policy.access(Name("/A"));
+  policy.access(Name("/B"));
+
+  // /C and the new /D have the lowest use count, and /C is older.
+  policy.insert(Name("/D"), 100);
+  Name name;
+  ASSERT_TRUE(policy.evict(name));
+  ASSERT_TRUE(name.equals(Name("/C")));
+  ASSERT_TRUE(policy.evict(name));
+  ASSERT_TRUE(name.equals(Name("/D")));
+  ASSERT_TRUE(policy.evict(name));
+  ASSERT_TRUE(name.equals(Name("/B")));
+  ASSERT_TRUE(policy.evict(name));
+  ASSERT_TRUE(name.equals(Name("/A")));
+  ASSERT_TRUE(!policy.evict(name));
+  ASSERT_EQ(0, policy.getByteCount());
+}
+
+TEST_F(TestCacheEvictionPolicy, Arc)
+{
+  CacheEvictionPolicyArc policy(300);
+  policy.insert(Name("/A"), 100);
+  policy.insert(Name("/B"), 100);
+  policy.insert(Name("/C"), 100);
+  // Move /A to T2.
+  policy.access(Name("/A"));
+
+  // Evict the least recently used of T1.
+  policy.insert(Name("/D"), 100);
+  Name name;
+  ASSERT_TRUE(policy.evict(name));
+  ASSERT_TRUE(name.equals(Name("/B")));
+  ASSERT_EQ(0, policy.getT1TargetBytes_());
+
+  // /B is in the ghost list B1, so inserting it again grows the T1 target.
+  policy.insert(Name("/B"), 100);
+  ASSERT_EQ(100, policy.getT1TargetBytes_());
+  ASSERT_TRUE(policy.evict(name));
+  ASSERT_TRUE(name.equals(Name("/C")));
+  ASSERT_TRUE(!policy.isOverBudget());
+
+  // Move /D to T2. Then T1 has only the new /E, which is within its target, so
+  // evict the least recently used of T2.
+  policy.access(Name("/D"));
+  policy.insert(Name("/E"), 100);
+  ASSERT_TRUE(policy.evict(name));
+  ASSERT_TRUE(name.equals(Name("/A")));
+
+  // /A is in the ghost list B2, so inserting it again shrinks the T1 target.
+  policy.insert(Name("/A"), 100);
+  ASSERT_EQ(0, policy.getT1TargetBytes_());
+  ASSERT_TRUE(policy.evict(name));
+  ASSERT_TRUE(name.equals(Name("/E")));
+  ASSERT_EQ(300, policy.getByteCount());
+}
+
+TEST_F(TestCacheEvictionPolicy, InMemoryStorageRetaining)
+{
+  InMemoryStorageRetaining storage;
+  Data data1(Name("/A/1"));
+  Data data2(Name("/A/2"));
+  Data data3(Name("/A/3"));
+  size_t dataSize = data1.wireEncode().size();
+  ASSERT_EQ(dataSize, data2.wireEncode().size());
+
+  ptr_lib::shared_ptr<CacheEvictionPolicy> policy
+    (new CacheEvictionPolicyLru(2 * dataSize));
+  storage.insert(data1);
+  storage.setEvictionPolicy(policy);
+  storage.insert(data2);
+  ASSERT_EQ(2, storage.size());
+  ASSERT_EQ(2 * dataSize, policy->getByteCount());
+
+  ASSERT_TRUE(!!storage.find(Name("/A/1")));
+  ASSERT_TRUE(!storage.find(Name("/B")));
+  storage.insert(data3);
+  ASSERT_EQ(2, storage.size());
+  ASSERT_TRUE(!!storage.find(Name("/A/1")));
+  ASSERT_TRUE(!storage.find(Name("/A/2")));
+  ASSERT_TRUE(!!storage.find(Name("/A/3")));
+
+  storage.remove(Name("/A"));
+  ASSERT_EQ(0, storage.size());
+  ASSERT_EQ(0, policy->getByteCount());
+  ASSERT_EQ(3, policy->getHitCount());
+  ASSERT_EQ(2, policy->getMissCount());
+  ASSERT_EQ(1, policy->getEvictionCount());
+}
+
+TEST_F(TestCacheEvictionPolicy, MemoryContentCache)
+{
+  Face face("localhost");
+  MemoryContentCache cache(&face);
+  vector<Name> removedNames;
+  cache.setOnContentRemoved(bind(&onContentRemoved, _1, ref(removedNames)));
+
+  Data data1(Name("/A/1"));
+  Data data2(Name("/A/2"));
+  // A Data packet with a FreshnessPeriod is also in the stale time list.
+  data2.getMetaInfo().setFreshnessPeriod(3600 * 1000.0);
+  Data data3(Name("/A/3"));
+  size_t dataSize = data1.wireEncode().size();
+
+  ptr_lib::shared_ptr<CacheEvictionPolicy> policy
+    (new CacheEvictionPolicyLru(dataSize + data2.wireEncode().size()));
+  cache.setEvictionPolicy(policy);
+  cache.add(data1);
+  cache.add(data2);
+  // Adding the same name replaces the content.
+  cache.add(data1);
+  ASSERT_EQ(0, removedNames.size());
+  ASSERT_EQ(0, policy->getEvictionCount());
+
+  // /A/2 is now the least recently used.
+  cache.add(data3);
+  ASSERT_EQ(1, removedNames.size());
+  ASSERT_TRUE(removedNames[0].equals(Name("/A/2")));
+  ASSERT_EQ(2 * dataSize, policy->getByteCount());
+}
+
+int
+main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
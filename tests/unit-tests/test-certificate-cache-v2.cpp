@@ -0,0 +1,121 @@
+/**
+ * Copyright (C) 2020 Regents of the University of California.
+ * @author: Jeff Thompson <jefft0@remap.ucla.edu>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+#include "gtest/gtest.h"
+#include <ndn-cpp/security/validity-period.hpp>
+#include <ndn-cpp/security/v2/certificate-cache-v2.hpp>
+
+using namespace std;
+using namespace ndn;
+
+/**
+ * Make a certificate for the identity which is valid from now until
+ * validHours from now.
+ */
+static CertificateV2
+makeCertificate(const Name& identityName, double validHours)
+{
+  CertificateV2 certificate;
+  certificate.setName(Name(identityName).append("KEY").append("123")
+    .append("self").appendVersion(1));
+  MillisecondsSince1970 now = ndn_getNowMilliseconds();
+  ValidityPeriod::getFromSignature(certificate.getSignature()).setPeriod
+    (now - 1000.0, now + validHours * 3600 * 1000.0);
+
+  return certificate;
+}
+
+class TestCertificateCacheV2 : public ::testing::Test {
+};
+
+TEST_F(TestCertificateCacheV2, InsertAndFind)
+{
+  CertificateCacheV2 cache;
+  CertificateV2 certificate = makeCertificate(Name("/A"), 10);
+  cache.insert(certificate);
+  cache.insert(makeCertificate(Name("/B"), 10));
+  ASSERT_EQ(2, cache.size());
+
+  Name keyName = certificate.getName().getPrefix(-2);
+  ASSERT_TRUE(cache.find(keyName)->getName().equals(certificate.getName()));
+  ASSERT_TRUE(!cache.find(Name("/C")));
+
+  // An Interest with no selectors uses the prefix lookup.
+  Interest interest(keyName);
+  ASSERT_TRUE(cache.find(interest)->getName().equals(certificate.getName()));
+
+  // An Interest with a selector uses Interest::matchesData.
+  interest.getExclude().appendComponent(Name::Component("self"));
+  ASSERT_TRUE(!cache.find(interest));
+
+  cache.deleteCertificate(certificate.getName());
+  ASSERT_EQ(1, cache.size());
+  ASSERT_TRUE(!cache.find(keyName));
+}
+
+TEST_F(TestCertificateCacheV2, Expiration)
+{
+  CertificateCacheV2 cache(2 * 3600 * 1000.0);
+  // /A is removed by its NotAfter time. /B is removed by the max lifetime.
+  cache.insert(makeCertificate(Name("/A"), 1));
+  cache.insert(makeCertificate(Name("/B"), 10));
+  // Re-inserting /C with a longer validity replaces the first removal time.
+  cache.insert(makeCertificate(Name("/C"), 0.5));
+  cache.insert(makeCertificate(Name("/C"), 10));
+  ASSERT_EQ(3, cache.size());
+
+  cache.setNowOffsetMilliseconds_(1.5 * 3600 * 1000.0);
+  ASSERT_TRUE(!cache.find(Name("/A")));
+  ASSERT_TRUE(!!cache.find(Name("/B")));
+  ASSERT_TRUE(!!cache.find(Name("/C")));
+  ASSERT_EQ(2, cache.size());
+
+  cache.setNowOffsetMilliseconds_(3 * 3600 * 1000.0);
+  ASSERT_TRUE(!cache.find(Name("/B")));
+  ASSERT_EQ(0, cache.size());
+}
+
+TEST_F(TestCertificateCacheV2, LeastRecentlyUsed)
+{
+  CertificateCacheV2 cache(CertificateCacheV2::getDefaultLifetime(), 2);
+  cache.insert(makeCertificate(Name("/A"), 10));
+  cache.insert(makeCertificate(Name("/B"), 10));
+
+  // Use /A so that /B is the least recently used.
+  ASSERT_TRUE(!!cache.find(Name("/A")));
+  cache.insert(makeCertificate(Name("/C"), 10));
+  ASSERT_EQ(2, cache.size());
+  ASSERT_TRUE(!!cache.find(Name("/A")));
+  ASSERT_TRUE(!cache.find(Name("/B")));
+  ASSERT_TRUE(!!cache.find(Name("/C")));
+
+  // Now /A is the least recently used.
+  cache.insert(makeCertificate(Name("/D"), 10));
+  ASSERT_TRUE(!cache.find(Name("/A")));
+  ASSERT_TRUE(!!cache.find(Name("/C")));
+  ASSERT_TRUE(!!cache.find(Name("/D")));
+}
+
+int
+main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
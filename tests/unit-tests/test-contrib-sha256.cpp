@@ -0,0 +1,101 @@
+/**
+ * Copyright (C) 2020 Regents of the University of California.
+ * @author: Jeff Thompson <jefft0@remap.ucla.edu>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+#include "gtest/gtest.h"
+#include <vector>
+#include <ndn-cpp/lite/util/crypto-lite.hpp>
+#include <ndn-cpp/util/blob.hpp>
+#include "contrib-sha256.h"
+
+using namespace std;
+using namespace ndn;
+
+/**
+ * Check that the digest from contrib/openssl/sha256.c is the same as from
+ * CryptoLite, which uses libcrypto.
+ */
+static void
+checkDigest(const uint8_t* data, size_t dataLength)
+{
+  uint8_t expected[ndn_SHA256_DIGEST_SIZE];
+  CryptoLite::digestSha256(data, dataLength, expected);
+  uint8_t digest[SHA256_DIGEST_LENGTH];
+  SHA256(data, dataLength, digest);
+
+  ASSERT_TRUE(Blob(expected, sizeof(expected)).equals
+              (Blob(digest, sizeof(digest))))
+    << "Wrong digest for length " << dataLength;
+}
+
+class TestContribSha256 : public ::testing::Test {
+public:
+  TestContribSha256()
+  : buffer_(1000)
+  {
+    for (size_t i = 0; i < buffer_.size(); ++i)
+      buffer_[i] = (uint8_t)(i * 7);
+  }
+
+  vector<uint8_t> buffer_;
+};
+
+TEST_F(TestContribSha256, Digest)
+{
+  // Use the buffers of TestDataMethods.DigestSha256Multi, whose lengths cross
+  // the SHA-256 block boundaries.
+  for (size_t i = 0; i < 19; ++i)
+    checkDigest(&buffer_[i], (i * 53) % 200 + (i == 0 ? 0 : 50));
+
+  // Check each length up to several blocks, and a length with many blocks
+  // which the SHA extensions process in one call.
+  for (size_t length = 0; length <= 300; ++length)
+    checkDigest(&buffer_[0], length);
+  checkDigest(&buffer_[0], buffer_.size());
+}
+
+TEST_F(TestContribSha256, Update)
+{
+  uint8_t expected[SHA256_DIGEST_LENGTH];
+  SHA256(&buffer_[0], buffer_.size(), expected);
+
+  // Split the data at different places relative to the 64-byte blocks.
+  size_t partLengths[] = { 1, 7, 63, 64, 65, 200, 999 };
+  for (size_t i = 0; i < sizeof(partLengths) / sizeof(partLengths[0]); ++i) {
+    SHA256_CTX context;
+    SHA256_Init(&context);
+    for (size_t offset = 0; offset < buffer_.size(); offset += partLengths[i])
+      SHA256_Update
+        (&context, &buffer_[offset],
+         min(partLengths[i], buffer_.size() - offset));
+    uint8_t digest[SHA256_DIGEST_LENGTH];
+    SHA256_Final(digest, &context);
+
+    ASSERT_TRUE(Blob(expected, sizeof(expected)).equals
+                (Blob(digest, sizeof(digest))))
+      << "Wrong digest for part length " << partLengths[i];
+  }
+}
+
+int
+main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
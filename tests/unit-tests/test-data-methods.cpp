@@ -34,6 +34,7 @@
 #include <ndn-cpp/encoding/tlv-wire-format.hpp>
 #include <ndn-cpp/lite/encoding/tlv-0_2-wire-format-lite.hpp>
 #include "../../src/lp/lp-packet.hpp"
+#include "../../src/c/util/sha256-multi-buffer.h"
 
 using namespace std;
 using namespace ndn;
@@ -642,6 +643,79 @@ TEST_F(TestDataMethods, FullName)
   ASSERT_FALSE(data.getFullName()->get(-1).equals(saveFullName.get(-1)));
 }
 
+TEST_F(TestDataMethods, FullNames)
+{
+  // Use content sizes which cross the SHA-256 block boundaries.
+  vector<ptr_lib::shared_ptr<Data> > dataList;
+  for (size_t i = 0; i < 21; ++i) {
+    ptr_lib::shared_ptr<Data> data(new Data(Name("/ndn/abc").appendSegment(i)));
+    vector<uint8_t> content(i * 13, (uint8_t)i);
+    data->setContent(content);
+    dataList.push_back(data);
+  }
+  // Already have the full name of one Data packet.
+  dataList[3]->getFullName();
+
+  vector<ptr_lib::shared_ptr<Name> > fullNames;
+  Data::getFullNames(dataList, fullNames);
+  ASSERT_EQ(dataList.size(), fullNames.size());
+
+  for (size_t i = 0; i < dataList.size(); ++i) {
+    Blob encoding = dataList[i]->wireEncode();
+    uint8_t digest[ndn_SHA256_DIGEST_SIZE];
+    CryptoLite::digestSha256(encoding, digest);
+
+    ASSERT_EQ(dataList[i]->getName(), fullNames[i]->getPrefix(-1));
+    ASSERT_TRUE(Blob(digest, sizeof(digest)).equals
+                (fullNames[i]->get(-1).getValue()));
+    // getFullNames should cache the full name.
+    ASSERT_EQ(fullNames[i].get(), dataList[i]->getFullName().get());
+  }
+}
+
+TEST_F(TestDataMethods, DigestSha256Multi)
+{
+  vector<uint8_t> buffer(1000);
+  for (size_t i = 0; i < buffer.size(); ++i)
+    buffer[i] = (uint8_t)(i * 7);
+
+  // Use lengths which cross the SHA-256 block boundaries and a count which
+  // is not a multiple of the number of lanes.
+  const size_t nBuffers = 19;
+  const uint8_t* data[nBuffers];
+  size_t dataLength[nBuffers];
+  for (size_t i = 0; i < nBuffers; ++i) {
+    data[i] = &buffer[i];
+    dataLength[i] = (i * 53) % 200 + (i == 0 ? 0 : 50);
+  }
+
+  uint8_t digests[nBuffers * ndn_SHA256_DIGEST_SIZE];
+  CryptoLite::digestSha256Multi(data, dataLength, nBuffers, digests);
+  for (size_t i = 0; i < nBuffers; ++i) {
+    uint8_t digest[ndn_SHA256_DIGEST_SIZE];
+    CryptoLite::digestSha256(data[i], dataLength[i], digest);
+    ASSERT_TRUE(Blob(digest, sizeof(digest)).equals
+                (Blob(digests + i * ndn_SHA256_DIGEST_SIZE,
+                      ndn_SHA256_DIGEST_SIZE)))
+      << "Wrong digest for buffer " << i;
+  }
+
+  if (ndn_Sha256MultiBuffer_isSupported()) {
+    // Also check the multi-buffer lanes even if they are not preferred.
+    for (size_t nLanes = 1; nLanes <= NDN_SHA256_MULTI_BUFFER_LANES; ++nLanes) {
+      ndn_Sha256MultiBuffer_digest(data, dataLength, nLanes, digests);
+      for (size_t i = 0; i < nLanes; ++i) {
+        uint8_t digest[ndn_SHA256_DIGEST_SIZE];
+        CryptoLite::digestSha256(data[i], dataLength[i], digest);
+        ASSERT_TRUE(Blob(digest, sizeof(digest)).equals
+                    (Blob(digests + i * ndn_SHA256_DIGEST_SIZE,
+                          ndn_SHA256_DIGEST_SIZE)))
+          << "Wrong multi-buffer digest for lane " << i;
+      }
+    }
+  }
+}
+
 
 TEST_F(TestDataMethods, CongestionMark)
 {
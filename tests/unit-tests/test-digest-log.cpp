@@ -0,0 +1,127 @@
+/**
+ * Copyright (C) 2020 Regents of the University of California.
+ * @author: Jeff Thompson <jefft0@remap.ucla.edu>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+#include "gtest/gtest.h"
+#include <ndn-cpp/ndn-cpp-config.h>
+#if NDN_CPP_HAVE_PROTOBUF
+#include <sstream>
+#include "../../src/sync/sync-state.pb.h"
+#include "../../src/sync/digest-log.hpp"
+
+using namespace std;
+using namespace ndn;
+
+static string
+makeDigest(int i)
+{
+  ostringstream digest;
+  digest << "digest" << i;
+  return digest.str();
+}
+
+/**
+ * Make a SyncStateMsg with one update for a participant.
+ */
+static void
+makeContent(Sync::SyncStateMsg& content, int sequenceNo)
+{
+  Sync::SyncState* syncState = content.add_ss();
+  syncState->set_name("/ndn/edu/ucla/alice");
+  syncState->set_type(Sync::SyncState_ActionType_UPDATE);
+  syncState->mutable_seqno()->set_seq(sequenceNo);
+  syncState->mutable_seqno()->set_session(1);
+}
+
+class TestDigestLog : public ::testing::Test {
+};
+
+TEST_F(TestDigestLog, Find)
+{
+  DigestLog digestLog(0);
+  ASSERT_EQ(-1, digestLog.find("00"));
+
+  // Add enough entries to grow the index.
+  const int nEntries = 100;
+  for (int i = 0; i < nEntries; ++i) {
+    Sync::SyncStateMsg content;
+    makeContent(content, i);
+    digestLog.add(makeDigest(i), content.ss());
+  }
+  ASSERT_EQ(nEntries, digestLog.size());
+
+  for (int i = 0; i < nEntries; ++i) {
+    ASSERT_EQ(i, digestLog.find(makeDigest(i)));
+    ASSERT_EQ(makeDigest(i), digestLog.get(i).getDigest());
+    ASSERT_EQ(1, digestLog.get(i).getData().size());
+    ASSERT_EQ(i, digestLog.get(i).getData().Get(0).seqno().seq());
+  }
+  ASSERT_EQ(-1, digestLog.find(makeDigest(nEntries)));
+  ASSERT_EQ(0, digestLog.getEvictionCount());
+}
+
+TEST_F(TestDigestLog, Evict)
+{
+  const int maxEntries = 10;
+  DigestLog digestLog(maxEntries);
+  ASSERT_EQ(maxEntries, digestLog.getMaxEntries());
+
+  const int nEntries = 35;
+  for (int i = 0; i < nEntries; ++i) {
+    Sync::SyncStateMsg content;
+    makeContent(content, i);
+    digestLog.add(makeDigest(i), content.ss());
+    ASSERT_TRUE(digestLog.size() <= maxEntries);
+  }
+
+  ASSERT_EQ(maxEntries, digestLog.size());
+  ASSERT_EQ(nEntries - maxEntries, digestLog.getEvictionCount());
+  for (int i = 0; i < nEntries - maxEntries; ++i)
+    ASSERT_EQ(-1, digestLog.find(makeDigest(i))) << "Evicted entry " << i;
+  // The remaining entries are in order from the oldest.
+  for (int i = 0; i < maxEntries; ++i) {
+    int entryNo = nEntries - maxEntries + i;
+    ASSERT_EQ(i, digestLog.find(makeDigest(entryNo)));
+    ASSERT_EQ(entryNo, digestLog.get(i).getData().Get(0).seqno().seq());
+  }
+
+  // Reducing the maximum evicts the oldest entries now.
+  digestLog.setMaxEntries(3);
+  ASSERT_EQ(3, digestLog.size());
+  ASSERT_EQ(nEntries - 3, digestLog.getEvictionCount());
+  ASSERT_EQ(-1, digestLog.find(makeDigest(nEntries - 4)));
+  ASSERT_EQ(0, digestLog.find(makeDigest(nEntries - 3)));
+  ASSERT_EQ(2, digestLog.find(makeDigest(nEntries - 1)));
+
+  // An evicted digest can be added again as a new entry.
+  Sync::SyncStateMsg content;
+  makeContent(content, nEntries);
+  digestLog.add(makeDigest(0), content.ss());
+  ASSERT_EQ(2, digestLog.find(makeDigest(0)));
+  ASSERT_EQ(-1, digestLog.find(makeDigest(nEntries - 3)));
+}
+
+#endif // NDN_CPP_HAVE_PROTOBUF
+
+int
+main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
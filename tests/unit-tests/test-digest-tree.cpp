@@ -0,0 +1,89 @@
+/**
+ * Copyright (C) 2020 Regents of the University of California.
+ * @author: Jeff Thompson <jefft0@remap.ucla.edu>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+#include "gtest/gtest.h"
+#include "../../src/sync/digest-tree.hpp"
+
+using namespace std;
+using namespace ndn;
+
+class TestDigestTree : public ::testing::Test {
+};
+
+TEST_F(TestDigestTree, Root)
+{
+  // The root digests interoperate with other ChronoSync2013 implementations,
+  // so they must not change.
+  DigestTree digestTree;
+  ASSERT_EQ("00", digestTree.getRoot());
+
+  ASSERT_TRUE(digestTree.update("/ndn/edu/ucla/alice", 1, 1));
+  ASSERT_EQ("95d2be1ff7159e6fe3d23305321a5483aec320924575e51d70d2398183a81ac3",
+            digestTree.getRoot());
+
+  // Update twice before getting the root.
+  ASSERT_TRUE(digestTree.update("/ndn/edu/ucla/bob", 2, 5));
+  ASSERT_TRUE(digestTree.update("/ndn/edu/arizona/carol", 3, 2));
+  ASSERT_EQ("30aeccc2b622a0b909ea67c5dcc370f52f4b83c9231a58978e035ea6b0293221",
+            digestTree.getRoot());
+
+  ASSERT_TRUE(digestTree.update("/ndn/edu/ucla/alice", 1, 4));
+  ASSERT_EQ("7a44ce257fe1dfb261107e726c7b95ac0e4141a844dba98fe7db9f8d228aa27a",
+            digestTree.getRoot());
+
+  // An old sequence number doesn't change the tree.
+  ASSERT_FALSE(digestTree.update("/ndn/edu/ucla/alice", 1, 3));
+  ASSERT_EQ("7a44ce257fe1dfb261107e726c7b95ac0e4141a844dba98fe7db9f8d228aa27a",
+            digestTree.getRoot());
+}
+
+TEST_F(TestDigestTree, Find)
+{
+  DigestTree digestTree;
+  // Add enough nodes to grow the index.
+  for (int i = 0; i < 100; ++i) {
+    ostringstream dataPrefix;
+    dataPrefix << "/ndn/participant/" << i;
+    digestTree.update(dataPrefix.str(), i % 3, i);
+  }
+  ASSERT_EQ(100, digestTree.size());
+
+  for (int i = 0; i < 100; ++i) {
+    ostringstream dataPrefix;
+    dataPrefix << "/ndn/participant/" << i;
+    const DigestTree::Node* node = digestTree.find(dataPrefix.str(), i % 3);
+    ASSERT_TRUE(node != 0);
+    ASSERT_EQ(i, node->getSequenceNo());
+    // A different session is a different node.
+    ASSERT_TRUE(digestTree.find(dataPrefix.str(), i % 3 + 1) == 0);
+  }
+
+  // The nodes are sorted by data prefix.
+  for (size_t i = 1; i < digestTree.size(); ++i)
+    ASSERT_TRUE(digestTree.get(i - 1).getDataPrefix() <
+                digestTree.get(i).getDataPrefix());
+}
+
+int
+main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,242 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Regents of the University of California.
+ * @author: Jeff Thompson <jefft0@remap.ucla.edu>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+#include "gtest/gtest.h"
+#include <unistd.h>
+#include <ndn-cpp/face.hpp>
+#include "../../src/node.hpp"
+
+using namespace std;
+using namespace ndn;
+using namespace ndn::func_lib;
+
+/**
+ * LoopbackTransport extends Transport to count the sent packets instead of
+ * sending them to a forwarder, and to let the test deliver packets to the
+ * Node.
+ */
+class LoopbackTransport : public Transport {
+public:
+  LoopbackTransport()
+  : elementListener_(0)
+  {
+  }
+
+  virtual bool
+  isLocal(const Transport::ConnectionInfo& connectionInfo) { return true; }
+
+  virtual bool
+  isAsync() { return false; }
+
+  virtual void
+  connect
+    (const Transport::ConnectionInfo& connectionInfo,
+     ElementListener& elementListener, const OnConnected& onConnected)
+  {
+    elementListener_ = &elementListener;
+    if (onConnected)
+      onConnected();
+  }
+
+  virtual void
+  send(const uint8_t *data, size_t dataLength)
+  {
+    ptr_lib::shared_ptr<Interest> interest(new Interest());
+    interest->wireDecode(data, dataLength);
+    sentInterests_.push_back(interest);
+  }
+
+  virtual void
+  processEvents() {}
+
+  virtual bool
+  getIsConnected() { return elementListener_ != 0; }
+
+  /**
+   * Deliver the encoded packet to the Node as if it came from the forwarder.
+   */
+  void
+  receive(const Blob& encoding)
+  {
+    elementListener_->onReceivedElement(encoding.buf(), encoding.size());
+  }
+
+  vector<ptr_lib::shared_ptr<Interest> > sentInterests_;
+
+private:
+  ElementListener* elementListener_;
+};
+
+static void
+onData(const ptr_lib::shared_ptr<const Interest>& interest,
+       const ptr_lib::shared_ptr<Data>& data)
+{
+  // Take some time so that the callback histogram has a non-zero value.
+  usleep(2000);
+}
+
+static void
+onTimeout(const ptr_lib::shared_ptr<const Interest>& interest) {}
+
+static void
+onNetworkNack(const ptr_lib::shared_ptr<const Interest>& interest,
+              const ptr_lib::shared_ptr<NetworkNack>& networkNack) {}
+
+static void
+onMetrics(const FaceMetrics& metrics, int& nCalls)
+{
+  ++nCalls;
+}
+
+TEST(TestLatencyHistogram, Percentiles)
+{
+  LatencyHistogram histogram;
+  ASSERT_EQ(0, histogram.getValueAtPercentile(50.0));
+
+  for (uint64_t value = 1; value <= 1000; ++value)
+    histogram.record(value);
+  ASSERT_EQ(1000, histogram.getCount());
+  ASSERT_EQ(1, histogram.getMin());
+  ASSERT_EQ(1000, histogram.getMax());
+  ASSERT_DOUBLE_EQ(500.5, histogram.getMean());
+
+  // Each bucket is within 1/16 of its values.
+  uint64_t p50 = histogram.getValueAtPercentile(50.0);
+  ASSERT_TRUE(p50 >= 500 && p50 <= 500 + 500 / 16) << p50;
+  uint64_t p99 = histogram.getValueAtPercentile(99.0);
+  ASSERT_TRUE(p99 >= 990 && p99 <= 1000) << p99;
+  ASSERT_EQ(1000, histogram.getValueAtPercentile(100.0));
+  // Small values are exact.
+  ASSERT_EQ(10, histogram.getValueAtPercentile(1.0));
+
+  // A large value has a bucket.
+  histogram.record((uint64_t)1 << 62);
+  ASSERT_EQ((uint64_t)1 << 62, histogram.getValueAtPercentile(100.0));
+
+  histogram.reset();
+  ASSERT_EQ(0, histogram.getCount());
+  ASSERT_EQ(0, histogram.getMax());
+}
+
+class TestFaceMetrics : public ::testing::Test {
+public:
+  TestFaceMetrics()
+  : transport_(new LoopbackTransport()),
+    face_(transport_, ptr_lib::make_shared<Transport::ConnectionInfo>())
+  {
+  }
+
+  ptr_lib::shared_ptr<LoopbackTransport> transport_;
+  Face face_;
+};
+
+TEST_F(TestFaceMetrics, Disabled)
+{
+  ASSERT_FALSE((bool)face_.getMetrics());
+  face_.expressInterest(Name("/test/a"), bind(&onData, _1, _2));
+  ASSERT_FALSE((bool)face_.getMetrics());
+}
+
+TEST_F(TestFaceMetrics, Counters)
+{
+  face_.setMetricsEnabled(true);
+  face_.setInterestFilter(Name("/test/filter"), OnInterestCallback());
+
+  face_.expressInterest
+    (Interest(Name("/test/a"), 4000.0), bind(&onData, _1, _2),
+     bind(&onTimeout, _1), bind(&onNetworkNack, _1, _2));
+  face_.expressInterest
+    (Interest(Name("/test/b"), 4000.0), bind(&onData, _1, _2),
+     bind(&onTimeout, _1), bind(&onNetworkNack, _1, _2));
+  face_.expressInterest
+    (Interest(Name("/test/c"), 50.0), bind(&onData, _1, _2),
+     bind(&onTimeout, _1), bind(&onNetworkNack, _1, _2));
+
+  ptr_lib::shared_ptr<FaceMetrics> metrics = face_.getMetrics();
+  ASSERT_EQ(3, metrics->getInterestsSentCount());
+  ASSERT_EQ(3, metrics->getPendingInterestCount());
+  ASSERT_EQ(1, metrics->getInterestFilterCount());
+  ASSERT_EQ(3, metrics->getDelayedCallCount());
+  size_t nBytesSent = 0;
+  for (size_t i = 0; i < transport_->sentInterests_.size(); ++i)
+    nBytesSent += transport_->sentInterests_[i]->wireEncode().size();
+  ASSERT_EQ(nBytesSent, metrics->getBytesSentCount());
+
+  Blob dataEncoding = Data(Name("/test/a")).wireEncode();
+  transport_->receive(dataEncoding);
+  NetworkNack networkNack;
+  networkNack.setReason(ndn_NetworkNackReason_NO_ROUTE);
+  Blob nackEncoding =
+    Node::encodeLpNack(*transport_->sentInterests_[1], networkNack);
+  transport_->receive(nackEncoding);
+
+  for (int i = 0; i < 100 && face_.getMetrics()->getTimeoutCount() == 0; ++i) {
+    face_.processEvents();
+    usleep(10000);
+  }
+
+  metrics = face_.getMetrics();
+  ASSERT_EQ(1, metrics->getDataReceivedCount());
+  ASSERT_EQ(1, metrics->getTimeoutCount());
+  ASSERT_EQ(1, metrics->getNetworkNackCount());
+  ASSERT_EQ(1, metrics->getNetworkNackCount(ndn_NetworkNackReason_NO_ROUTE));
+  ASSERT_EQ(0, metrics->getNetworkNackCount(ndn_NetworkNackReason_CONGESTION));
+  ASSERT_EQ(dataEncoding.size() + nackEncoding.size(),
+            metrics->getBytesReceivedCount());
+  ASSERT_EQ(0, metrics->getPendingInterestCount());
+
+  ASSERT_EQ(1, metrics->getRttHistogram().getCount());
+  // Data, Nack and timeout.
+  ASSERT_EQ(3, metrics->getCallbackHistogram().getCount());
+  ASSERT_TRUE(metrics->getCallbackHistogram().getMax() >= 2000);
+
+  // Disabling discards the metrics.
+  face_.setMetricsEnabled(false);
+  ASSERT_FALSE((bool)face_.getMetrics());
+}
+
+TEST_F(TestFaceMetrics, Dump)
+{
+  int nCalls = 0;
+  face_.setMetricsDump(10.0, bind(&onMetrics, _1, ref(nCalls)));
+  ASSERT_TRUE((bool)face_.getMetrics());
+
+  for (int i = 0; i < 100 && nCalls < 3; ++i) {
+    face_.processEvents();
+    usleep(5000);
+  }
+  ASSERT_TRUE(nCalls >= 3);
+
+  face_.setMetricsDump(0);
+  int nCallsAfterStop = nCalls;
+  for (int i = 0; i < 5; ++i) {
+    face_.processEvents();
+    usleep(5000);
+  }
+  ASSERT_EQ(nCallsAfterStop, nCalls);
+}
+
+int
+main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
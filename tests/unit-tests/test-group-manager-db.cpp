@@ -273,6 +273,51 @@ TEST_F(TestGroupManagerDb, DatabaseFunctions)
   database->deleteSchedule("not-existing-time");
 }
 
+TEST_F(TestGroupManagerDb, Transactions)
+{
+  Sqlite3GroupManagerDb& database =
+    dynamic_cast<Sqlite3GroupManagerDb&>(*this->database);
+  Blob scheduleBlob(SCHEDULE, sizeof(SCHEDULE));
+  Schedule schedule;
+  schedule.wireDecode(scheduleBlob);
+  uint8_t keyBuffer[] = { 0x01, 0x02, 0x03 };
+  Blob keyBlob(keyBuffer, sizeof(keyBuffer));
+
+  database.setSynchronous(Sqlite3Synchronous::FULL);
+  database.addSchedule("work-time", schedule);
+
+  // Roll back a nested transaction.
+  database.beginTransaction();
+  database.addMember("work-time", Name("/ndn/BoyA/ksk-123"), keyBlob);
+  database.beginTransaction();
+  database.addMember("work-time", Name("/ndn/BoyB/ksk-123"), keyBlob);
+  database.commitTransaction();
+  ASSERT_TRUE(database.hasMember(Name("/ndn/BoyB")));
+  database.rollbackTransaction();
+  ASSERT_FALSE(database.hasMember(Name("/ndn/BoyA")));
+  ASSERT_FALSE(database.hasMember(Name("/ndn/BoyB")));
+  ASSERT_THROW(database.commitTransaction(), GroupManagerDb::Error)
+    << "Expected an error committing when not in a transaction";
+
+  // Commit many members in one transaction.
+  const int nMembers = 100;
+  database.beginTransaction();
+  for (int i = 0; i < nMembers; ++i)
+    database.addMember
+      ("work-time", Name("/ndn/member").appendSequenceNumber(i).append("ksk-123"),
+       keyBlob);
+  database.commitTransaction();
+
+  vector<Name> members;
+  database.listAllMembers(members);
+  ASSERT_EQ(nMembers, members.size());
+
+  // The database is committed, so a new connection sees the members.
+  Sqlite3GroupManagerDb database2(databaseFilePath);
+  ASSERT_TRUE(database2.hasMember
+    (Name("/ndn/member").appendSequenceNumber(nMembers - 1)));
+}
+
 int
 main(int argc, char **argv)
 {
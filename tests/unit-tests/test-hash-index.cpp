@@ -0,0 +1,131 @@
+/**
+ * Copyright (C) 2020 Regents of the University of California.
+ * @author: Jeff Thompson <jefft0@remap.ucla.edu>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+#include "gtest/gtest.h"
+#include "../../src/util/hash-index.hpp"
+
+using namespace std;
+using namespace ndn;
+
+/**
+ * Find the value in the index the way that the users of HashIndex do.
+ * @return True if the index has an entry with the hash and value.
+ */
+static bool
+contains(const HashIndex<int>& index, size_t hash, int value)
+{
+  const HashIndex<int>::Bucket& bucket = index.getBucket(hash);
+  for (size_t i = 0; i < bucket.size(); ++i) {
+    if (bucket[i].hash_ == hash && bucket[i].value_ == value)
+      return true;
+  }
+
+  return false;
+}
+
+class TestHashIndex : public ::testing::Test {
+};
+
+TEST_F(TestHashIndex, Constructor)
+{
+  HashIndex<int> index;
+  ASSERT_EQ(0, index.size());
+  ASSERT_EQ(HashIndex<int>::INITIAL_BUCKET_COUNT, index.getBucketCount());
+
+  // The bucket count is rounded up to a power of 2.
+  HashIndex<int> largeIndex(1000);
+  ASSERT_EQ(1024, largeIndex.getBucketCount());
+  HashIndex<int> smallIndex(3);
+  ASSERT_EQ(HashIndex<int>::INITIAL_BUCKET_COUNT, smallIndex.getBucketCount());
+}
+
+TEST_F(TestHashIndex, InsertAndGrow)
+{
+  HashIndex<int> index;
+  size_t nValues = 1000;
+  for (size_t i = 0; i < nValues; ++i) {
+    // Use a hash multiplier so that values spread over the buckets.
+    index.insert(i * 2654435761u, (int)i);
+    ASSERT_EQ(i + 1, index.size());
+    // The bucket count doubles so that it is never less than the size.
+    ASSERT_GE(index.getBucketCount(), index.size());
+    ASSERT_EQ(0, index.getBucketCount() & (index.getBucketCount() - 1));
+  }
+  ASSERT_EQ(1024, index.getBucketCount());
+
+  // Every value is still found after growing.
+  for (size_t i = 0; i < nValues; ++i)
+    ASSERT_TRUE(contains(index, i * 2654435761u, (int)i));
+  ASSERT_FALSE(contains(index, 0, 1));
+}
+
+TEST_F(TestHashIndex, Collisions)
+{
+  HashIndex<int> index;
+  // Values with the same hash share a bucket, including after growing.
+  for (int i = 0; i < 40; ++i)
+    index.insert(7, i);
+  // A different hash in the same bucket.
+  index.insert(7 + index.getBucketCount(), 100);
+
+  for (int i = 0; i < 40; ++i)
+    ASSERT_TRUE(contains(index, 7, i));
+  ASSERT_TRUE(contains(index, 7 + index.getBucketCount(), 100));
+  ASSERT_FALSE(contains(index, 7, 100));
+}
+
+TEST_F(TestHashIndex, Erase)
+{
+  HashIndex<int> index;
+  for (int i = 0; i < 10; ++i)
+    index.insert(5, i);
+  index.insert(6, 10);
+
+  // Erase from the middle, the end and the front of the bucket.
+  ASSERT_TRUE(index.erase(5, 4));
+  ASSERT_TRUE(index.erase(5, 9));
+  ASSERT_TRUE(index.erase(5, 0));
+  ASSERT_EQ(8, index.size());
+  ASSERT_FALSE(contains(index, 5, 4));
+  ASSERT_FALSE(contains(index, 5, 9));
+  ASSERT_FALSE(contains(index, 5, 0));
+  for (int i = 1; i < 9; ++i) {
+    if (i != 4) {
+      ASSERT_TRUE(contains(index, 5, i));
+    }
+  }
+
+  // Erasing a missing value or with the wrong hash doesn't change the index.
+  ASSERT_FALSE(index.erase(5, 4));
+  ASSERT_FALSE(index.erase(5, 10));
+  ASSERT_EQ(8, index.size());
+  ASSERT_TRUE(contains(index, 6, 10));
+
+  ASSERT_TRUE(index.erase(6, 10));
+  ASSERT_EQ(7, index.size());
+  ASSERT_EQ(0, index.getBucket(6).size());
+}
+
+int
+main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
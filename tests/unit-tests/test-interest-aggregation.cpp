@@ -0,0 +1,244 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Regents of the University of California.
+ * @author: Jeff Thompson <jefft0@remap.ucla.edu>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+#include "gtest/gtest.h"
+#include <unistd.h>
+#include <ndn-cpp/face.hpp>
+#include "../../src/node.hpp"
+
+using namespace std;
+using namespace ndn;
+using namespace ndn::func_lib;
+
+/**
+ * LoopbackTransport extends Transport to save the sent Interests instead of
+ * sending them to a forwarder, and to let the test deliver packets to the
+ * Node.
+ */
+class LoopbackTransport : public Transport {
+public:
+  LoopbackTransport()
+  : elementListener_(0)
+  {
+  }
+
+  virtual bool
+  isLocal(const Transport::ConnectionInfo& connectionInfo) { return true; }
+
+  virtual bool
+  isAsync() { return false; }
+
+  virtual void
+  connect
+    (const Transport::ConnectionInfo& connectionInfo,
+     ElementListener& elementListener, const OnConnected& onConnected)
+  {
+    elementListener_ = &elementListener;
+    if (onConnected)
+      onConnected();
+  }
+
+  virtual void
+  send(const uint8_t *data, size_t dataLength)
+  {
+    ptr_lib::shared_ptr<Interest> interest(new Interest());
+    interest->wireDecode(data, dataLength);
+    sentInterests_.push_back(interest);
+  }
+
+  virtual void
+  processEvents() {}
+
+  virtual bool
+  getIsConnected() { return elementListener_ != 0; }
+
+  /**
+   * Deliver the encoded packet to the Node as if it came from the forwarder.
+   */
+  void
+  receive(const Blob& encoding)
+  {
+    elementListener_->onReceivedElement(encoding.buf(), encoding.size());
+  }
+
+  vector<ptr_lib::shared_ptr<Interest> > sentInterests_;
+
+private:
+  ElementListener* elementListener_;
+};
+
+class Counter {
+public:
+  Counter()
+  : nData_(0), nTimeouts_(0), nNacks_(0)
+  {
+  }
+
+  void
+  onData(const ptr_lib::shared_ptr<const Interest>& interest,
+         const ptr_lib::shared_ptr<Data>& data)
+  {
+    ++nData_;
+  }
+
+  void
+  onTimeout(const ptr_lib::shared_ptr<const Interest>& interest)
+  {
+    ++nTimeouts_;
+  }
+
+  void
+  onNetworkNack(const ptr_lib::shared_ptr<const Interest>& interest,
+                const ptr_lib::shared_ptr<NetworkNack>& networkNack)
+  {
+    ++nNacks_;
+  }
+
+  int nData_;
+  int nTimeouts_;
+  int nNacks_;
+};
+
+class TestInterestAggregation : public ::testing::Test {
+public:
+  TestInterestAggregation()
+  : transport_(new LoopbackTransport()),
+    face_(transport_, ptr_lib::make_shared<Transport::ConnectionInfo>())
+  {
+    face_.setInterestAggregationEnabled(true);
+  }
+
+  void
+  expressInterest(const Interest& interest)
+  {
+    face_.expressInterest
+      (interest, bind(&Counter::onData, &counter_, _1, _2),
+       bind(&Counter::onTimeout, &counter_, _1),
+       bind(&Counter::onNetworkNack, &counter_, _1, _2));
+  }
+
+  ptr_lib::shared_ptr<LoopbackTransport> transport_;
+  Face face_;
+  Counter counter_;
+};
+
+TEST_F(TestInterestAggregation, Data)
+{
+  Interest interest(Name("/test/certificate"), 4000.0);
+  interest.setCanBePrefix(true);
+  for (int i = 0; i < 5; ++i)
+    expressInterest(interest);
+  // A shorter lifetime is aggregated.
+  interest.setInterestLifetimeMilliseconds(1000.0);
+  expressInterest(interest);
+  ASSERT_EQ(1, transport_->sentInterests_.size());
+
+  // A different name or selector is sent.
+  expressInterest(Interest(Name("/test/other"), 4000.0));
+  interest.setMustBeFresh(true);
+  expressInterest(interest);
+  ASSERT_EQ(3, transport_->sentInterests_.size());
+
+  // A longer lifetime would outlive the outstanding Interest, so it is sent.
+  interest.setMustBeFresh(false);
+  interest.setInterestLifetimeMilliseconds(10000.0);
+  expressInterest(interest);
+  ASSERT_EQ(4, transport_->sentInterests_.size());
+
+  Data data(Name("/test/certificate/1"));
+  transport_->receive(data.wireEncode());
+  // The 6 aggregated Interests, the sent one with the longer lifetime and the
+  // one with MustBeFresh (since the Data has no FreshnessPeriod, it matches).
+  ASSERT_EQ(8, counter_.nData_);
+
+  // Now that the Data arrived, a new Interest is sent.
+  expressInterest(Interest(Name("/test/certificate"), 4000.0));
+  ASSERT_EQ(5, transport_->sentInterests_.size());
+}
+
+TEST_F(TestInterestAggregation, NetworkNack)
+{
+  Interest interest(Name("/test/manifest"), 4000.0);
+  for (int i = 0; i < 3; ++i)
+    expressInterest(interest);
+  ASSERT_EQ(1, transport_->sentInterests_.size());
+
+  NetworkNack networkNack;
+  networkNack.setReason(ndn_NetworkNackReason_NO_ROUTE);
+  transport_->receive
+    (Node::encodeLpNack(*transport_->sentInterests_[0], networkNack));
+  ASSERT_EQ(3, counter_.nNacks_);
+}
+
+TEST_F(TestInterestAggregation, Timeout)
+{
+  Interest interest(Name("/test/timeout"), 100.0);
+  for (int i = 0; i < 3; ++i)
+    expressInterest(interest);
+  ASSERT_EQ(1, transport_->sentInterests_.size());
+
+  for (int i = 0; i < 100 && counter_.nTimeouts_ < 3; ++i) {
+    face_.processEvents();
+    usleep(10000);
+  }
+  ASSERT_EQ(3, counter_.nTimeouts_);
+  ASSERT_EQ(0, counter_.nData_);
+}
+
+TEST_F(TestInterestAggregation, ExpirationTime)
+{
+  Interest interest(Name("/test/certificate"), 400.0);
+  expressInterest(interest);
+  ASSERT_EQ(1, transport_->sentInterests_.size());
+
+  // The same lifetime later would outlive the outstanding Interest, so it is
+  // sent.
+  usleep(200000);
+  expressInterest(interest);
+  ASSERT_EQ(2, transport_->sentInterests_.size());
+
+  // An Interest which expires before the second one is aggregated.
+  interest.setInterestLifetimeMilliseconds(100.0);
+  expressInterest(interest);
+  ASSERT_EQ(2, transport_->sentInterests_.size());
+
+  transport_->receive(Data(Name("/test/certificate/1")).wireEncode());
+  ASSERT_EQ(3, counter_.nData_);
+}
+
+TEST_F(TestInterestAggregation, Disabled)
+{
+  face_.setInterestAggregationEnabled(false);
+  Interest interest(Name("/test/certificate"), 4000.0);
+  for (int i = 0; i < 3; ++i)
+    expressInterest(interest);
+  ASSERT_EQ(3, transport_->sentInterests_.size());
+
+  transport_->receive(Data(Name("/test/certificate")).wireEncode());
+  ASSERT_EQ(3, counter_.nData_);
+}
+
+int
+main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -28,6 +28,13 @@
 using namespace std;
 using namespace ndn;
 
+static uint32_t
+makeHash(const string& prefix, int i)
+{
+  string uri = Name(prefix + std::to_string(i)).appendNumber(1).toUri();
+  return CryptoLite::murmurHash3(11, uri.data(), uri.size());
+}
+
 class TestInvertibleBloomLookupTable : public ::testing::Test {
 };
 
@@ -212,6 +219,267 @@ TEST_F(TestInvertibleBloomLookupTable, DifferenceBwOversizedIblts)
   ASSERT_TRUE(!receivedIblt.listEntries(positive, negative));
 }
 
+TEST_F(TestInvertibleBloomLookupTable, PeelEntries)
+{
+  size_t size = 100;
+
+  InvertibleBloomLookupTable ownIblt(size);
+  InvertibleBloomLookupTable scratch(0);
+  vector<uint32_t> positive;
+  vector<uint32_t> negative;
+
+  for (int i = 0; i < 60; ++i) {
+    string prefix = Name("/test/memphis" + std::to_string(i)).appendNumber(1).toUri();
+    ownIblt.insert(CryptoLite::murmurHash3(11, prefix.data(), prefix.size()));
+  }
+
+  // Reuse the same scratch IBLT and vectors for several differences.
+  for (int nChanges = 1; nChanges <= 20; ++nChanges) {
+    InvertibleBloomLookupTable otherIblt(ownIblt);
+    set<uint32_t> expectedPositive;
+    set<uint32_t> expectedNegative;
+    for (int i = 0; i < nChanges; ++i) {
+      string prefix = Name("/test/memphis" + std::to_string(i)).appendNumber(1).toUri();
+      uint32_t hash = CryptoLite::murmurHash3(11, prefix.data(), prefix.size());
+      otherIblt.erase(hash);
+      expectedPositive.insert(hash);
+
+      prefix = Name("/test/ucla" + std::to_string(i)).appendNumber(1).toUri();
+      hash = CryptoLite::murmurHash3(11, prefix.data(), prefix.size());
+      otherIblt.insert(hash);
+      expectedNegative.insert(hash);
+    }
+
+    ownIblt.difference(otherIblt, scratch);
+    ASSERT_TRUE(scratch.equals(*ownIblt.difference(otherIblt)));
+
+    set<uint32_t> listPositive;
+    set<uint32_t> listNegative;
+    ASSERT_TRUE(scratch.listEntries(listPositive, listNegative));
+    ASSERT_TRUE(scratch.peelEntries(positive, negative));
+
+    ASSERT_EQ(vector<uint32_t>(expectedPositive.begin(), expectedPositive.end()),
+              positive);
+    ASSERT_EQ(vector<uint32_t>(expectedNegative.begin(), expectedNegative.end()),
+              negative);
+    ASSERT_EQ(expectedPositive, listPositive);
+    ASSERT_EQ(expectedNegative, listNegative);
+
+    // Peeling leaves the scratch IBLT empty.
+    ASSERT_TRUE(scratch.equals(InvertibleBloomLookupTable(size)));
+  }
+
+  // An oversized IBLT can't be peeled.
+  InvertibleBloomLookupTable emptyIblt(size);
+  for (int i = 60; i < 400; ++i) {
+    string prefix = Name("/test/memphis" + std::to_string(i)).appendNumber(1).toUri();
+    ownIblt.insert(CryptoLite::murmurHash3(11, prefix.data(), prefix.size()));
+  }
+  ownIblt.difference(emptyIblt, scratch);
+  ASSERT_FALSE(scratch.peelEntries(positive, negative));
+}
+
+TEST_F(TestInvertibleBloomLookupTable, CachedEncoding)
+{
+  size_t size = 100;
+
+  InvertibleBloomLookupTable iblt(size);
+  for (int i = 0; i < 50; ++i) {
+    string prefix = Name("/test/memphis" + std::to_string(i)).appendNumber(1).toUri();
+    iblt.insert(CryptoLite::murmurHash3(11, prefix.data(), prefix.size()));
+  }
+
+  // Encoding again without a change should return the saved encoding.
+  Blob encoding = iblt.encode();
+  ASSERT_EQ(encoding.buf(), iblt.encode().buf());
+
+  // After a change, the encoding should match a fresh copy of the IBLT.
+  string prefix = Name("/test/ucla").appendNumber(1).toUri();
+  uint32_t newHash = CryptoLite::murmurHash3(11, prefix.data(), prefix.size());
+  iblt.insert(newHash);
+  InvertibleBloomLookupTable expected(size);
+  expected.initialize(iblt.encode());
+  ASSERT_TRUE(expected.equals(iblt));
+  ASSERT_FALSE(iblt.encode().equals(encoding));
+
+  iblt.erase(newHash);
+  ASSERT_TRUE(iblt.encode().equals(encoding));
+
+  // Each compression level should decode to the same IBLT.
+  for (int level = -1; level <= 9; ++level) {
+    iblt.setCompressionLevel(level);
+    ASSERT_EQ(level, iblt.getCompressionLevel());
+
+    InvertibleBloomLookupTable decoded(size);
+    decoded.initialize(iblt.encode());
+    ASSERT_TRUE(decoded.equals(iblt));
+  }
+
+  // Without compression, the encoding is larger than the 12-byte entries.
+  iblt.setCompressionLevel(0);
+  ASSERT_TRUE(iblt.encode().size() > 12 * 150);
+  iblt.setCompressionLevel(InvertibleBloomLookupTable::DEFAULT_COMPRESSION_LEVEL);
+  ASSERT_TRUE(iblt.encode().equals(encoding));
+
+  ASSERT_THROW(iblt.setCompressionLevel(10), runtime_error);
+  ASSERT_THROW(iblt.setCompressionLevel(-2), runtime_error);
+}
+
+TEST_F(TestInvertibleBloomLookupTable, EncodingCacheInvalidation)
+{
+  size_t size = 50;
+
+  // After each change to iblt, its encoding should match a fresh IBLT with
+  // the same contents which never saved an encoding.
+  InvertibleBloomLookupTable iblt(size);
+  for (int i = 0; i < 20; ++i)
+    iblt.insert(makeHash("/test/memphis", i));
+  Blob encoding = iblt.encode();
+
+  // insert
+  iblt.insert(makeHash("/test/ucla", 1));
+  {
+    InvertibleBloomLookupTable fresh(size);
+    for (int i = 0; i < 20; ++i)
+      fresh.insert(makeHash("/test/memphis", i));
+    fresh.insert(makeHash("/test/ucla", 1));
+    ASSERT_TRUE(iblt.encode().equals(fresh.encode()));
+    ASSERT_FALSE(iblt.encode().equals(encoding));
+  }
+
+  // erase
+  iblt.encode();
+  iblt.erase(makeHash("/test/memphis", 0));
+  {
+    InvertibleBloomLookupTable fresh(size);
+    for (int i = 1; i < 20; ++i)
+      fresh.insert(makeHash("/test/memphis", i));
+    fresh.insert(makeHash("/test/ucla", 1));
+    ASSERT_TRUE(iblt.encode().equals(fresh.encode()));
+  }
+
+  // initialize
+  InvertibleBloomLookupTable received(size);
+  Blob emptyEncoding = received.encode();
+  received.initialize(iblt.encode());
+  ASSERT_TRUE(received.encode().equals(iblt.encode()));
+  ASSERT_FALSE(received.encode().equals(emptyEncoding));
+
+  // setCompressionLevel
+  Blob level9Encoding = iblt.encode();
+  iblt.setCompressionLevel(0);
+  {
+    InvertibleBloomLookupTable fresh(size);
+    fresh.initialize(level9Encoding);
+    fresh.setCompressionLevel(0);
+    ASSERT_TRUE(iblt.encode().equals(fresh.encode()));
+    ASSERT_FALSE(iblt.encode().equals(level9Encoding));
+  }
+  // Setting the same level keeps the saved encoding.
+  Blob level0Encoding = iblt.encode();
+  iblt.setCompressionLevel(0);
+  ASSERT_EQ(level0Encoding.buf(), iblt.encode().buf());
+  iblt.setCompressionLevel(9);
+  ASSERT_TRUE(iblt.encode().equals(level9Encoding));
+
+  // difference(other, result)
+  InvertibleBloomLookupTable other(size);
+  other.insert(makeHash("/test/csu", 1));
+  InvertibleBloomLookupTable result(size);
+  Blob resultEncoding = result.encode();
+  iblt.difference(other, result);
+  ASSERT_TRUE(result.encode().equals(iblt.difference(other)->encode()));
+  ASSERT_FALSE(result.encode().equals(resultEncoding));
+
+  // peelEntries
+  vector<uint32_t> positive;
+  vector<uint32_t> negative;
+  ASSERT_TRUE(result.peelEntries(positive, negative));
+  ASSERT_TRUE(result.encode().equals(InvertibleBloomLookupTable(size).encode()));
+}
+
+TEST_F(TestInvertibleBloomLookupTable, PeelReusedScratch)
+{
+  // Reuse one scratch IBLT and one pair of vectors for differences of
+  // different sizes, including after a failed peel. Each peel should match
+  // listEntries of the same difference.
+  InvertibleBloomLookupTable scratch(0);
+  vector<uint32_t> positive;
+  vector<uint32_t> negative;
+
+  size_t sizes[] = { 10, 100, 30, 100, 10 };
+  int nChanges[] = { 3, 40, 500, 12, 1 };
+  for (size_t t = 0; t < sizeof(sizes) / sizeof(sizes[0]); ++t) {
+    InvertibleBloomLookupTable ownIblt(sizes[t]);
+    InvertibleBloomLookupTable otherIblt(sizes[t]);
+    for (int i = 0; i < 20; ++i) {
+      ownIblt.insert(makeHash("/test/memphis", i));
+      otherIblt.insert(makeHash("/test/memphis", i));
+    }
+    for (int i = 0; i < nChanges[t]; ++i) {
+      if (i % 2 == 0)
+        ownIblt.insert(makeHash("/test/ucla", i));
+      else
+        otherIblt.insert(makeHash("/test/csu", i));
+    }
+
+    ptr_lib::shared_ptr<InvertibleBloomLookupTable> diff =
+      ownIblt.difference(otherIblt);
+    set<uint32_t> listPositive;
+    set<uint32_t> listNegative;
+    bool listResult = diff->listEntries(listPositive, listNegative);
+
+    ownIblt.difference(otherIblt, scratch);
+    ASSERT_TRUE(scratch.equals(*diff));
+    bool peelResult = scratch.peelEntries(positive, negative);
+
+    ASSERT_EQ(listResult, peelResult);
+    ASSERT_EQ(vector<uint32_t>(listPositive.begin(), listPositive.end()),
+              positive);
+    ASSERT_EQ(vector<uint32_t>(listNegative.begin(), listNegative.end()),
+              negative);
+    // The table with 500 changes in 30 expected entries can't be peeled.
+    ASSERT_EQ(nChanges[t] != 500, peelResult);
+  }
+}
+
+TEST_F(TestInvertibleBloomLookupTable, DifferenceIntoResult)
+{
+  size_t size = 20;
+
+  InvertibleBloomLookupTable ownIblt(size);
+  InvertibleBloomLookupTable otherIblt(size);
+  for (int i = 0; i < 10; ++i) {
+    ownIblt.insert(makeHash("/test/memphis", i));
+    otherIblt.insert(makeHash("/test/memphis", i + 5));
+  }
+  ownIblt.setCompressionLevel(1);
+
+  // The result can have a different size and contents, which are replaced.
+  InvertibleBloomLookupTable result(100);
+  result.insert(makeHash("/test/ucla", 1));
+  ownIblt.difference(otherIblt, result);
+  ASSERT_TRUE(result.equals(*ownIblt.difference(otherIblt)));
+  ASSERT_EQ(1, result.getCompressionLevel());
+
+  set<uint32_t> positive;
+  set<uint32_t> negative;
+  ASSERT_TRUE(result.listEntries(positive, negative));
+  ASSERT_EQ(5, positive.size());
+  ASSERT_EQ(5, negative.size());
+  for (int i = 0; i < 5; ++i) {
+    ASSERT_TRUE(positive.count(makeHash("/test/memphis", i)) > 0);
+    ASSERT_TRUE(negative.count(makeHash("/test/memphis", i + 10)) > 0);
+  }
+
+  // The difference of equal IBLTs is empty.
+  otherIblt.difference(otherIblt, result);
+  ASSERT_TRUE(result.equals(InvertibleBloomLookupTable(size)));
+
+  InvertibleBloomLookupTable otherSize(size * 2);
+  ASSERT_THROW(ownIblt.difference(otherSize, result), runtime_error);
+}
+
 int
 main(int argc, char **argv)
 {
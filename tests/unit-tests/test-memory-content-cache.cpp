@@ -0,0 +1,139 @@
+/**
+ * Copyright (C) 2020 Regents of the University of California.
+ * @author: Jeff Thompson <jefft0@remap.ucla.edu>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+#include "gtest/gtest.h"
+#include <unistd.h>
+#include "gtest/gtest.h"
+#include <ndn-cpp/util/memory-content-cache.hpp>
+
+using namespace std;
+using namespace ndn;
+using namespace ndn::func_lib;
+
+/**
+ * SendCountFace extends Face to count the packets sent instead of sending them
+ * to a forwarder.
+ */
+class SendCountFace : public Face {
+public:
+  SendCountFace()
+  : Face("localhost"), nSent_(0)
+  {
+  }
+
+  virtual void
+  send(const uint8_t *encoding, size_t encodingLength) { ++nSent_; }
+
+  size_t nSent_;
+};
+
+static void
+onContentRemoved
+  (const ptr_lib::shared_ptr<MemoryContentCache::ContentList>& contentList,
+   vector<Name>& removedNames)
+{
+  for (size_t i = 0; i < contentList->size(); ++i)
+    removedNames.push_back((*contentList)[i]->getName());
+}
+
+class TestMemoryContentCache : public ::testing::Test {
+};
+
+TEST_F(TestMemoryContentCache, PendingInterests)
+{
+  SendCountFace face;
+  MemoryContentCache cache(&face);
+  Name prefix("/A");
+
+  ptr_lib::shared_ptr<Interest> interest1(new Interest(Name("/A/1")));
+  ptr_lib::shared_ptr<Interest> interest2(new Interest(Name("/A/2")));
+  ptr_lib::shared_ptr<Interest> interest3(new Interest(Name("/A")));
+  ptr_lib::shared_ptr<Interest> interest4(new Interest(Name("/B/1")));
+  cache.storePendingInterest(interest1, face);
+  cache.storePendingInterest(interest2, face);
+  cache.storePendingInterest(interest3, face);
+  cache.storePendingInterest(interest4, face);
+
+  vector<ptr_lib::shared_ptr<const MemoryContentCache::PendingInterest> >
+    pendingInterests;
+  cache.getPendingInterestsForName(Name("/A/1/%00"), pendingInterests);
+  ASSERT_EQ(2, pendingInterests.size());
+  cache.getPendingInterestsWithPrefix(prefix, pendingInterests);
+  ASSERT_EQ(3, pendingInterests.size());
+
+  // Adding /A/1 satisfies the Interests for /A/1 and /A .
+  cache.add(Data(Name("/A/1")));
+  ASSERT_EQ(2, face.nSent_);
+  cache.getPendingInterestsWithPrefix(prefix, pendingInterests);
+  ASSERT_EQ(1, pendingInterests.size());
+  ASSERT_TRUE(pendingInterests[0]->getInterest()->getName().equals
+              (Name("/A/2")));
+
+  // An Interest which times out is removed.
+  ptr_lib::shared_ptr<Interest> interest5(new Interest(Name("/A/5")));
+  interest5->setInterestLifetimeMilliseconds(1.0);
+  cache.storePendingInterest(interest5, face);
+  usleep(10000);
+  cache.getPendingInterestsWithPrefix(prefix, pendingInterests);
+  ASSERT_EQ(1, pendingInterests.size());
+  cache.add(Data(Name("/A/5")));
+  ASSERT_EQ(2, face.nSent_);
+
+  cache.add(Data(Name("/B/1")));
+  ASSERT_EQ(3, face.nSent_);
+  cache.getPendingInterestsForName(Name("/B/1"), pendingInterests);
+  ASSERT_EQ(0, pendingInterests.size());
+}
+
+TEST_F(TestMemoryContentCache, StaleTimeCleanup)
+{
+  SendCountFace face;
+  // Use a cleanup interval of zero to clean up on each call to add.
+  MemoryContentCache cache(&face, 0.0);
+  vector<Name> removedNames;
+  cache.setOnContentRemoved(bind(&onContentRemoved, _1, ref(removedNames)));
+
+  // Add the Data packets with the longer FreshnessPeriod first.
+  for (int i = 3; i >= 1; --i) {
+    Data data(Name("/A").appendNumber(i));
+    data.getMetaInfo().setFreshnessPeriod(i == 3 ? 3600 * 1000.0 : i * 1.0);
+    cache.add(data);
+  }
+  Data noStaleTimeData(Name("/A/4"));
+  cache.add(noStaleTimeData);
+
+  usleep(10000);
+  cache.add(Data(Name("/B")));
+  // The Data packets are removed in order of the removal time.
+  ASSERT_EQ(2, removedNames.size());
+  ASSERT_TRUE(removedNames[0].equals(Name("/A").appendNumber(1)));
+  ASSERT_TRUE(removedNames[1].equals(Name("/A").appendNumber(2)));
+
+  // Another cleanup does not remove the content which is not stale.
+  cache.add(Data(Name("/C")));
+  ASSERT_EQ(2, removedNames.size());
+}
+
+int
+main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
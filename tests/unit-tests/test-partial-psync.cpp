@@ -0,0 +1,391 @@
+/**
+ * Copyright (C) 2020 Regents of the University of California.
+ * @author: Jeff Thompson <jefft0@remap.ucla.edu>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <ndn-cpp/security/key-chain.hpp>
+#include <ndn-cpp/sync/partial-psync2017-producer.hpp>
+#include <ndn-cpp/sync/partial-psync-consumer.hpp>
+#include "../../src/impl/interest-filter-table.hpp"
+#include "../../src/impl/delayed-call-table.hpp"
+#include "../../src/sync/detail/psync-state.hpp"
+
+using namespace std;
+using namespace ndn;
+using namespace ndn::func_lib;
+
+/**
+ * LoopbackFace extends Face to connect a PartialPSync2017Producer and a
+ * PartialPSyncConsumer in the same process. Each expressed Interest is queued
+ * until processEvents, which passes it to the OnInterest callback of each
+ * matching registered prefix and keeps it pending. Each Data from putData
+ * satisfies the matching pending Interests right away, so that an Interest
+ * which the consumer sends in its OnData callback waits for the next
+ * processEvents. Pending Interests don't time out.
+ */
+class LoopbackFace : public Face {
+public:
+  LoopbackFace()
+  : Face("localhost"), nextPendingInterestId_(1)
+  {
+  }
+
+  virtual uint64_t
+  expressInterest
+    (const Interest& interest, const OnData& onData, const OnTimeout& onTimeout,
+     const OnNetworkNack& onNetworkNack,
+     WireFormat& wireFormat = *WireFormat::getDefaultWireFormat())
+  {
+    PendingInterest pendingInterest;
+    pendingInterest.pendingInterestId_ = nextPendingInterestId_++;
+    pendingInterest.interest_ = ptr_lib::make_shared<Interest>(interest);
+    pendingInterest.onData_ = onData;
+    pendingInterest.onTimeout_ = onTimeout;
+    pendingInterests_.push_back(pendingInterest);
+    interestQueue_.push_back(pendingInterest.interest_);
+
+    return pendingInterest.pendingInterestId_;
+  }
+
+  virtual void
+  removePendingInterest(uint64_t pendingInterestId)
+  {
+    for (size_t i = 0; i < pendingInterests_.size(); ++i) {
+      if (pendingInterests_[i].pendingInterestId_ == pendingInterestId) {
+        pendingInterests_.erase(pendingInterests_.begin() + i);
+        return;
+      }
+    }
+  }
+
+  virtual uint64_t
+  registerPrefix
+    (const Name& prefix, const OnInterestCallback& onInterest,
+     const OnRegisterFailed& onRegisterFailed,
+     const OnRegisterSuccess& onRegisterSuccess,
+     const RegistrationOptions& registrationOptions = RegistrationOptions(),
+     WireFormat& wireFormat = *WireFormat::getDefaultWireFormat())
+  {
+    interestFilterTable_.setInterestFilter
+      (0, ptr_lib::make_shared<InterestFilter>(prefix), onInterest, this);
+
+    if (onRegisterSuccess)
+      onRegisterSuccess(ptr_lib::make_shared<Name>(prefix), 0);
+    return 0;
+  }
+
+  virtual void
+  putData
+    (const Data& data,
+     WireFormat& wireFormat = *WireFormat::getDefaultWireFormat())
+  {
+    ptr_lib::shared_ptr<Data> dataCopy(new Data(data));
+    sentData_.push_back(dataCopy);
+
+    // Remove the satisfied Interests first, in case onData expresses another.
+    vector<PendingInterest> satisfied;
+    for (size_t i = 0; i < pendingInterests_.size();) {
+      if (pendingInterests_[i].interest_->matchesData(data)) {
+        satisfied.push_back(pendingInterests_[i]);
+        pendingInterests_.erase(pendingInterests_.begin() + i);
+      }
+      else
+        ++i;
+    }
+
+    for (size_t i = 0; i < satisfied.size(); ++i)
+      satisfied[i].onData_(satisfied[i].interest_, dataCopy);
+  }
+
+  virtual void
+  callLater(Milliseconds delayMilliseconds, const Face::Callback& callback)
+  {
+    delayedCallTable_.callLater(delayMilliseconds, callback);
+  }
+
+  /**
+   * Pass each Interest which was queued before this call to the matching
+   * OnInterest callbacks, then call the timed-out callLater callbacks.
+   */
+  virtual void
+  processEvents()
+  {
+    vector<ptr_lib::shared_ptr<Interest> > queue;
+    queue.swap(interestQueue_);
+
+    for (size_t i = 0; i < queue.size(); ++i) {
+      vector<ptr_lib::shared_ptr<InterestFilterTable::Entry> > matchedFilters;
+      interestFilterTable_.getMatchedFilters(*queue[i], matchedFilters);
+      for (size_t j = 0; j < matchedFilters.size(); ++j) {
+        InterestFilterTable::Entry &entry = *matchedFilters[j];
+        entry.getOnInterest()
+          (entry.getPrefix(), queue[i], entry.getFace(),
+           entry.getInterestFilterId(), entry.getFilter());
+      }
+    }
+
+    delayedCallTable_.callTimedOut();
+  }
+
+  /**
+   * Get the content of the last sync Data sent by putData.
+   * @param syncPrefix The sync prefix of the producer.
+   * @return The decoded PSyncState, or null if no sync Data was sent.
+   */
+  ptr_lib::shared_ptr<PSyncState>
+  getLastSyncState(const Name& syncPrefix)
+  {
+    for (size_t i = sentData_.size(); i > 0; --i) {
+      const Name& name = sentData_[i - 1]->getName();
+      if (syncPrefix.isPrefixOf(name) && name.size() > syncPrefix.size() &&
+          name.get(syncPrefix.size()).equals(PartialPSync2017Producer::getSyncComponent()))
+        return ptr_lib::make_shared<PSyncState>(sentData_[i - 1]->getContent());
+    }
+
+    return ptr_lib::shared_ptr<PSyncState>();
+  }
+
+  vector<ptr_lib::shared_ptr<Data> > sentData_;
+
+private:
+  class PendingInterest {
+  public:
+    uint64_t pendingInterestId_;
+    ptr_lib::shared_ptr<Interest> interest_;
+    OnData onData_;
+    OnTimeout onTimeout_;
+  };
+
+  uint64_t nextPendingInterestId_;
+  vector<PendingInterest> pendingInterests_;
+  vector<ptr_lib::shared_ptr<Interest> > interestQueue_;
+  InterestFilterTable interestFilterTable_;
+  DelayedCallTable delayedCallTable_;
+};
+
+static void
+onReceiveHelloData
+  (const ptr_lib::shared_ptr<vector<Name> >& prefixes,
+   vector<Name>& result)
+{
+  result = *prefixes;
+}
+
+static void
+onUpdate
+  (const ptr_lib::shared_ptr<vector<ptr_lib::shared_ptr<PSyncMissingDataInfo> > >& updates,
+   vector<ptr_lib::shared_ptr<PSyncMissingDataInfo> >& result)
+{
+  result.insert(result.end(), updates->begin(), updates->end());
+}
+
+/**
+ * Check if the state has the name.
+ */
+static bool
+hasName(const PSyncState& state, const Name& name)
+{
+  const vector<Name>& content = state.getContent();
+  return find(content.begin(), content.end(), name) != content.end();
+}
+
+class TestPartialPSync : public ::testing::Test {
+public:
+  TestPartialPSync()
+  : keyChain_("pib-memory:", "tpm-memory:"),
+    syncPrefix_("/psync"),
+    prefixA_("/user/a"),
+    prefixB_("/user/b"),
+    prefixC_("/user/c")
+  {
+  }
+
+  /**
+   * Create producer_ and consumer_ on face_, and add the user prefixes A, B
+   * and C.
+   * @param expectedNEntries The expected number of entries in the producer's
+   * IBLT.
+   */
+  void
+  createProducerAndConsumer(size_t expectedNEntries)
+  {
+    producer_.reset(new PartialPSync2017Producer
+      (expectedNEntries, face_, syncPrefix_, prefixA_, keyChain_,
+       PartialPSync2017Producer::DEFAULT_HELLO_REPLY_FRESHNESS_PERIOD,
+       PartialPSync2017Producer::DEFAULT_SYNC_REPLY_FRESHNESS_PERIOD,
+       SigningInfo(SigningInfo::SIGNER_TYPE_SHA256)));
+    producer_->addUserNode(prefixB_);
+    producer_->addUserNode(prefixC_);
+
+    consumer_.reset(new PartialPSyncConsumer
+      (face_, syncPrefix_, bind(&onReceiveHelloData, _1, ref(helloPrefixes_)),
+       bind(&onUpdate, _1, ref(updates_)), 10));
+  }
+
+  /**
+   * Check that updates_ has exactly one update, with the prefix and sequence
+   * numbers, then clear updates_.
+   */
+  void
+  checkUpdate(const Name& prefix, int lowSequenceNo, int highSequenceNo)
+  {
+    ASSERT_EQ(1, updates_.size());
+    ASSERT_EQ(prefix, updates_[0]->prefix_);
+    ASSERT_EQ(lowSequenceNo, updates_[0]->lowSequenceNo_);
+    ASSERT_EQ(highSequenceNo, updates_[0]->highSequenceNo_);
+    updates_.clear();
+  }
+
+  LoopbackFace face_;
+  KeyChain keyChain_;
+  Name syncPrefix_;
+  Name prefixA_;
+  Name prefixB_;
+  Name prefixC_;
+  ptr_lib::shared_ptr<PartialPSync2017Producer> producer_;
+  ptr_lib::shared_ptr<PartialPSyncConsumer> consumer_;
+  vector<Name> helloPrefixes_;
+  vector<ptr_lib::shared_ptr<PSyncMissingDataInfo> > updates_;
+};
+
+TEST_F(TestPartialPSync, SubscriptionUpdates)
+{
+  createProducerAndConsumer(40);
+  producer_->publishName(prefixA_);
+
+  consumer_->sendHelloInterest();
+  face_.processEvents();
+  ASSERT_EQ(3, helloPrefixes_.size());
+  ASSERT_TRUE(find(helloPrefixes_.begin(), helloPrefixes_.end(), prefixC_) !=
+              helloPrefixes_.end());
+
+  // The subscription starts from the sequence number in the hello reply.
+  ASSERT_TRUE(consumer_->addSubscription(prefixA_));
+  ASSERT_TRUE(consumer_->addSubscription(prefixB_));
+  ASSERT_FALSE(consumer_->addSubscription(prefixA_));
+  ASSERT_EQ(1, consumer_->getSequenceNo(prefixA_));
+  ASSERT_EQ(0, consumer_->getSequenceNo(prefixB_));
+  ASSERT_FALSE(consumer_->isSubscribed(prefixC_));
+
+  // The sync Interest waits at the producer since there is nothing new.
+  consumer_->sendSyncInterest();
+  face_.processEvents();
+  ASSERT_EQ(0, updates_.size());
+
+  // Publishing satisfies the pending sync Interest.
+  producer_->publishName(prefixA_);
+  checkUpdate(prefixA_, 2, 2);
+  ASSERT_EQ(2, consumer_->getSequenceNo(prefixA_));
+
+  // The consumer is not subscribed to C.
+  face_.processEvents();
+  producer_->publishName(prefixC_);
+  face_.processEvents();
+  ASSERT_EQ(0, updates_.size());
+
+  // Publish B twice before the consumer's next sync Interest arrives. The
+  // first publish satisfies the pending Interest. The producer answers the
+  // next Interest from the IBLT difference.
+  producer_->publishName(prefixB_);
+  checkUpdate(prefixB_, 1, 1);
+  producer_->publishName(prefixB_);
+  ASSERT_EQ(0, updates_.size());
+  face_.processEvents();
+  checkUpdate(prefixB_, 2, 2);
+  ptr_lib::shared_ptr<PSyncState> state = face_.getLastSyncState(syncPrefix_);
+  ASSERT_TRUE(!!state);
+  ASSERT_EQ(1, state->getContent().size());
+  ASSERT_TRUE(hasName(*state, Name(prefixB_).appendNumber(2)));
+
+  // After removing the subscription, the consumer gets no updates for B.
+  consumer_->removeSubscription(prefixB_);
+  ASSERT_FALSE(consumer_->isSubscribed(prefixB_));
+  ASSERT_EQ(-1, consumer_->getSequenceNo(prefixB_));
+  consumer_->sendSyncInterest();
+  face_.processEvents();
+  producer_->publishName(prefixB_);
+  face_.processEvents();
+  ASSERT_EQ(0, updates_.size());
+
+  producer_->publishName(prefixA_);
+  face_.processEvents();
+  checkUpdate(prefixA_, 3, 3);
+}
+
+TEST_F(TestPartialPSync, CannotPeelDifference)
+{
+  // A small IBLT so that the difference below can't be peeled.
+  size_t expectedNEntries = 4;
+  createProducerAndConsumer(expectedNEntries);
+  vector<Name> otherPrefixes;
+  for (int i = 0; i < 20; ++i) {
+    otherPrefixes.push_back(Name("/user/other").appendNumber(i));
+    producer_->addUserNode(otherPrefixes.back());
+  }
+
+  consumer_->sendHelloInterest();
+  face_.processEvents();
+  ASSERT_EQ(23, helloPrefixes_.size());
+  consumer_->addSubscription(prefixA_);
+  consumer_->addSubscription(prefixB_);
+  consumer_->sendSyncInterest();
+  face_.processEvents();
+
+  producer_->publishName(prefixA_);
+  checkUpdate(prefixA_, 1, 1);
+
+  // While the consumer's next sync Interest is queued, publish more names
+  // than the IBLT can decode.
+  producer_->publishName(prefixB_);
+  for (size_t i = 0; i < otherPrefixes.size(); ++i) {
+    producer_->publishName(otherPrefixes[i]);
+    producer_->publishName(otherPrefixes[i]);
+  }
+  face_.processEvents();
+
+  // The producer can't peel the difference, so it sends the latest name of
+  // each subscribed prefix, including A which didn't change.
+  ptr_lib::shared_ptr<PSyncState> state = face_.getLastSyncState(syncPrefix_);
+  ASSERT_TRUE(!!state);
+  ASSERT_EQ(2, state->getContent().size());
+  ASSERT_TRUE(hasName(*state, Name(prefixA_).appendNumber(1)));
+  ASSERT_TRUE(hasName(*state, Name(prefixB_).appendNumber(1)));
+  // The consumer only reports the new sequence number.
+  checkUpdate(prefixB_, 1, 1);
+
+  // The consumer now has the producer's IBLT, so it is back in sync.
+  face_.processEvents();
+  producer_->publishName(prefixA_);
+  checkUpdate(prefixA_, 2, 2);
+  face_.processEvents();
+  producer_->publishName(prefixC_);
+  producer_->publishName(prefixB_);
+  face_.processEvents();
+  checkUpdate(prefixB_, 2, 2);
+  state = face_.getLastSyncState(syncPrefix_);
+  ASSERT_EQ(1, state->getContent().size());
+}
+
+int
+main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
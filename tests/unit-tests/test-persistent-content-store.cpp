@@ -0,0 +1,292 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Regents of the University of California.
+ * @author: Jeff Thompson <jefft0@remap.ucla.edu>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+#include "gtest/gtest.h"
+#include <fstream>
+#include <stdexcept>
+#include <ndn-cpp/util/persistent-content-store.hpp>
+
+using namespace std;
+using namespace ndn;
+
+static bool
+fileExists(const string& filePath)
+{
+  ifstream stream(filePath.c_str());
+  bool result = (bool)stream;
+  stream.close();
+  return result;
+}
+
+static string
+getPolicyConfigDirectory()
+{
+  string policyConfigDirectory = "policy_config";
+  // Check if expected files are in this directory.
+  if (!fileExists(policyConfigDirectory + "/regex_ruleset.conf")) {
+    // Maybe we are running "make check" from the ndn-cpp root.  There may be
+    //   a way to tell "make check" to run from tests/unit-tests, but for
+    //   now just set policyConfigDirectory explicitly.
+    policyConfigDirectory = "tests/unit-tests/policy_config";
+
+    if(!fileExists(policyConfigDirectory + "/regex_ruleset.conf"))
+      throw runtime_error("Cannot find the directory for policy-config");
+  }
+
+  return policyConfigDirectory;
+}
+
+static Data
+makeData(const Name& name, const string& content)
+{
+  Data data(name);
+  data.setContent(Blob((const uint8_t*)content.c_str(), content.size()));
+  return data;
+}
+
+/**
+ * Find the Data packet for the Interest name in the store.
+ * @return The encoding, or an isNull() Blob if not found.
+ */
+static Blob
+find(PersistentContentStore& store, const Interest& interest)
+{
+  const uint8_t* encoding;
+  size_t encodingLength;
+  if (!store.find(interest, encoding, encodingLength))
+    return Blob();
+  return Blob(encoding, encodingLength);
+}
+
+class TestPersistentContentStore : public ::testing::Test {
+public:
+  TestPersistentContentStore()
+  {
+    logFilePath_ = getPolicyConfigDirectory() + "/test-content-store.log";
+    remove(logFilePath_.c_str());
+  }
+
+  virtual void
+  TearDown()
+  {
+    remove(logFilePath_.c_str());
+    remove((logFilePath_ + ".compact").c_str());
+  }
+
+  string logFilePath_;
+};
+
+TEST_F(TestPersistentContentStore, Restart)
+{
+  Data data1 = makeData(Name("/A/1").appendSegment(0), "data1");
+  Data data2 = makeData(Name("/A/1").appendSegment(1), "data2");
+  Data data3 = makeData(Name("/A/2"), "data3");
+  {
+    PersistentContentStore store(logFilePath_);
+    store.add(data1);
+    store.add(data2);
+    store.add(data3);
+    ASSERT_EQ(3, store.size());
+
+    Interest interest(Name("/A/1"));
+    ASSERT_TRUE(find(store, interest).equals(data1.wireEncode()));
+    interest.setChildSelector(1);
+    ASSERT_TRUE(find(store, interest).equals(data2.wireEncode()));
+
+    ASSERT_TRUE(store.remove(data3.getName()));
+    ASSERT_FALSE(store.remove(data3.getName()));
+  }
+
+  // Open the log again.
+  PersistentContentStore store(logFilePath_);
+  ASSERT_EQ(2, store.size());
+  ASSERT_EQ(data1.wireEncode().size() + data2.wireEncode().size(),
+            store.getLiveSize());
+  Interest interest(Name("/A/1"));
+  interest.setChildSelector(1);
+  ASSERT_TRUE(find(store, interest).equals(data2.wireEncode()));
+  ASSERT_TRUE(find(store, Interest(Name("/A/2"))).isNull());
+
+  // Replace a Data packet.
+  Data newData1 = makeData(data1.getName(), "newData1");
+  store.add(newData1);
+  ASSERT_EQ(2, store.size());
+  ASSERT_TRUE(find(store, Interest(data1.getName())).equals
+              (newData1.wireEncode()));
+}
+
+TEST_F(TestPersistentContentStore, RestartMustBeFresh)
+{
+  Data freshData = makeData(Name("/A/1"), "freshData");
+  freshData.getMetaInfo().setFreshnessPeriod(3600000.0);
+  Data noFreshnessData = makeData(Name("/B/1"), "noFreshnessData");
+  Interest freshInterest(Name("/A"));
+  freshInterest.setMustBeFresh(true);
+  Interest noFreshnessInterest(Name("/B"));
+  noFreshnessInterest.setMustBeFresh(true);
+  {
+    PersistentContentStore store(logFilePath_);
+    store.add(freshData);
+    store.add(noFreshnessData);
+    ASSERT_TRUE(find(store, freshInterest).equals(freshData.wireEncode()));
+  }
+
+  // Open the log again. The FreshnessPeriod must not start again.
+  PersistentContentStore store(logFilePath_);
+  ASSERT_EQ(2, store.size());
+  ASSERT_TRUE(find(store, freshInterest).isNull());
+  freshInterest.setMustBeFresh(false);
+  ASSERT_TRUE(find(store, freshInterest).equals(freshData.wireEncode()));
+  // A Data packet without a FreshnessPeriod is still fresh.
+  ASSERT_TRUE(find(store, noFreshnessInterest).equals
+              (noFreshnessData.wireEncode()));
+
+  // Adding the Data packet again makes it fresh.
+  store.add(freshData);
+  freshInterest.setMustBeFresh(true);
+  ASSERT_TRUE(find(store, freshInterest).equals(freshData.wireEncode()));
+}
+
+TEST_F(TestPersistentContentStore, IncompleteRecord)
+{
+  Data data1 = makeData(Name("/A/1"), "data1");
+  Data data2 = makeData(Name("/A/2"), "data2");
+  uint64_t logSize;
+  {
+    PersistentContentStore store(logFilePath_);
+    store.add(data1);
+    logSize = store.getLogSize();
+  }
+
+  {
+    // Simulate stopping while appending data2.
+    ofstream file(logFilePath_.c_str(), ios::binary | ios::app);
+    file.write((const char*)data2.wireEncode().buf(),
+               data2.wireEncode().size() - 2);
+  }
+
+  PersistentContentStore store(logFilePath_);
+  ASSERT_EQ(1, store.size());
+  ASSERT_EQ(logSize, store.getLogSize());
+  store.add(data2);
+  ASSERT_TRUE(find(store, Interest(data2.getName())).equals
+              (data2.wireEncode()));
+}
+
+TEST_F(TestPersistentContentStore, CorruptRecord)
+{
+  Data data1 = makeData(Name("/A/1"), "data1");
+  Data data2 = makeData(Name("/A/2"), "data2");
+  {
+    PersistentContentStore store(logFilePath_);
+    store.add(data1);
+  }
+
+  // Append complete records which can't be decoded, followed by data2.
+  // An unrecognized record type.
+  uint8_t unrecognized[] = { 0x99, 0x03, 0x01, 0x02, 0x03 };
+  // A Data record whose Name has a malformed component.
+  uint8_t badName[] = {
+    0x06, 0x06,
+      0x07, 0x04, 0x08, 0x05, 0x41, 0x42 };
+  {
+    ofstream file(logFilePath_.c_str(), ios::binary | ios::app);
+    file.write((const char*)unrecognized, sizeof(unrecognized));
+    file.write((const char*)badName, sizeof(badName));
+    file.write((const char*)data2.wireEncode().buf(),
+               data2.wireEncode().size());
+  }
+  uint64_t expectedLogSize = data1.wireEncode().size() +
+    sizeof(unrecognized) + sizeof(badName) + data2.wireEncode().size();
+
+  PersistentContentStore store(logFilePath_);
+  // The corrupt records are skipped without losing data2.
+  ASSERT_EQ(2, store.size());
+  ASSERT_EQ(expectedLogSize, store.getLogSize());
+  ASSERT_EQ(data1.wireEncode().size() + data2.wireEncode().size(),
+            store.getLiveSize());
+  ASSERT_TRUE(find(store, Interest(data1.getName())).equals
+              (data1.wireEncode()));
+  ASSERT_TRUE(find(store, Interest(data2.getName())).equals
+              (data2.wireEncode()));
+
+  // Compaction removes the corrupt records.
+  ASSERT_TRUE(store.startCompaction());
+  store.waitForCompaction();
+  ASSERT_EQ(store.getLiveSize(), store.getLogSize());
+  ASSERT_TRUE(find(store, Interest(data2.getName())).equals
+              (data2.wireEncode()));
+}
+
+TEST_F(TestPersistentContentStore, Compaction)
+{
+  const int nData = 100;
+  vector<Data> expected;
+  {
+    PersistentContentStore store(logFilePath_);
+    store.setAutoCompactionRatio(1.0);
+    for (int i = 0; i < nData; ++i)
+      store.add(makeData(Name("/A").appendNumber(i), "old"));
+    // Replace half and remove some, so that the log has unused records.
+    for (int i = 0; i < nData; i += 2)
+      store.add(makeData(Name("/A").appendNumber(i), "new"));
+    for (int i = 1; i < 20; i += 2)
+      ASSERT_TRUE(store.remove(Name("/A").appendNumber(i)));
+    ASSERT_TRUE(store.getLogSize() > store.getLiveSize());
+
+    ASSERT_TRUE(store.startCompaction());
+    ASSERT_FALSE(store.startCompaction());
+    // Change the store while compaction is running.
+    store.add(makeData(Name("/A").appendNumber(0), "newer"));
+    ASSERT_TRUE(store.remove(Name("/A").appendNumber(99)));
+    store.waitForCompaction();
+    ASSERT_FALSE(store.isCompacting());
+
+    for (int i = 0; i < nData; ++i) {
+      if ((i < 20 && i % 2 == 1) || i == 99)
+        continue;
+      string content = (i == 0 ? "newer" : (i % 2 == 0 ? "new" : "old"));
+      expected.push_back(makeData(Name("/A").appendNumber(i), content));
+    }
+    ASSERT_EQ(expected.size(), store.size());
+    for (size_t i = 0; i < expected.size(); ++i)
+      ASSERT_TRUE(find(store, Interest(expected[i].getName())).equals
+                  (expected[i].wireEncode()));
+    ASSERT_TRUE(find(store, Interest(Name("/A").appendNumber(99))).isNull());
+    ASSERT_FALSE(fileExists(logFilePath_ + ".compact"));
+  }
+
+  PersistentContentStore store(logFilePath_);
+  ASSERT_EQ(expected.size(), store.size());
+  // Only the records added during compaction are unused.
+  ASSERT_TRUE(store.getLogSize() - store.getLiveSize() <
+              3 * expected[0].wireEncode().size());
+  for (size_t i = 0; i < expected.size(); ++i)
+    ASSERT_TRUE(find(store, Interest(expected[i].getName())).equals
+                (expected[i].wireEncode()));
+}
+
+int
+main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -183,6 +183,50 @@ TEST_F(TestPibImpl, TpmLocator)
   }
 }
 
+TEST_F(TestPibImpl, Sqlite3Transaction)
+{
+  PibSqlite3& pib = dynamic_cast<PibSqlite3&>(*pibSqlite3Fixture.pib);
+  const Name& id1 = pibSqlite3Fixture.id1;
+  const Name& id2 = pibSqlite3Fixture.id2;
+  pib.setSynchronous(Sqlite3Synchronous::FULL);
+
+  ASSERT_THROW(pib.commitTransaction(), PibImpl::Error);
+  // Rollback outside of a transaction does nothing.
+  pib.rollbackTransaction();
+
+  // A rollback discards the changes, including a nested transaction.
+  pib.beginTransaction();
+  pib.addIdentity(id1);
+  pib.beginTransaction();
+  pib.addIdentity(id2);
+  pib.commitTransaction();
+  ASSERT_TRUE(pib.hasIdentity(id1));
+  pib.rollbackTransaction();
+  ASSERT_FALSE(pib.hasIdentity(id1));
+  ASSERT_FALSE(pib.hasIdentity(id2));
+  ASSERT_THROW(pib.getDefaultIdentity(), Pib::Error);
+  ASSERT_THROW(pib.commitTransaction(), PibImpl::Error);
+
+  // Only the outermost commit writes the changes.
+  pib.beginTransaction();
+  pib.addIdentity(id1);
+  pib.beginTransaction();
+  pib.addIdentity(id2);
+  pib.commitTransaction();
+  pib.commitTransaction();
+  // This rollback is not in a transaction.
+  pib.rollbackTransaction();
+  ASSERT_TRUE(pib.hasIdentity(id1));
+  ASSERT_TRUE(pib.hasIdentity(id2));
+
+  // The committed changes are in the database file.
+  string databaseDirectoryPath = getPolicyConfigDirectory();
+  PibSqlite3 pib2(databaseDirectoryPath, "test-pib.db");
+  ASSERT_TRUE(pib2.hasIdentity(id1));
+  ASSERT_TRUE(pib2.hasIdentity(id2));
+  ASSERT_TRUE(pib2.getDefaultIdentity().equals(id1));
+}
+
 TEST_F(TestPibImpl, IdentityManagement)
 {
   for (size_t i = 0; i < sizeof(pibImpls) / sizeof(pibImpls[0]); ++i) {
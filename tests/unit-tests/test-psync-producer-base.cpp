@@ -0,0 +1,133 @@
+/**
+ * Copyright (C) 2019-2020 Regents of the University of California.
+ * @author: Jeff Thompson <jefft0@remap.ucla.edu>
+ * From PSync unit tests:
+ * https://github.com/named-data/PSync/blob/master/tests/test-state.cpp
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+#include "gtest/gtest.h"
+#include <ndn-cpp/encoding/tlv-wire-format.hpp>
+#include <ndn-cpp/lite/util/crypto-lite.hpp>
+#include <ndn-cpp/sync/psync-producer-base.hpp>
+#include "../../src/sync/detail/invertible-bloom-lookup-table.hpp"
+
+using namespace std;
+using namespace ndn;
+
+/**
+ * TestProducer extends PSyncProducerBase to make the name table methods
+ * public for testing.
+ */
+class TestProducer : public PSyncProducerBase {
+public:
+  TestProducer(size_t expectedNEntries)
+  : PSyncProducerBase(expectedNEntries, Name("/sync"), 1000)
+  {
+  }
+
+  using PSyncProducerBase::setNameHashMode;
+  using PSyncProducerBase::getNameHash;
+  using PSyncProducerBase::insertIntoIblt;
+  using PSyncProducerBase::removeFromIblt;
+  using PSyncProducerBase::hasName;
+  using PSyncProducerBase::findNameByHash;
+
+  size_t
+  getNameCount() const { return names_.size(); }
+
+  const InvertibleBloomLookupTable&
+  getIblt() const { return *iblt_; }
+};
+
+class TestPSyncProducerBase : public ::testing::Test {
+};
+
+TEST_F(TestPSyncProducerBase, NameHashMode)
+{
+  Name name("/test/memphis");
+  name.appendNumber(1);
+
+  TestProducer producer(10);
+  string uri = name.toUri();
+  ASSERT_EQ(CryptoLite::murmurHash3(11, uri.data(), uri.size()),
+            producer.getNameHash(name));
+
+  producer.setNameHashMode(PSyncProducerBase::NAME_HASH_WIRE_ENCODING);
+  Blob encoding = name.wireEncode(*TlvWireFormat::get());
+  ASSERT_EQ(CryptoLite::murmurHash3(11, encoding.buf(), encoding.size()),
+            producer.getNameHash(name));
+
+  // Can't change the mode after inserting.
+  producer.insertIntoIblt(name);
+  ASSERT_THROW
+    (producer.setNameHashMode(PSyncProducerBase::NAME_HASH_URI), runtime_error);
+}
+
+TEST_F(TestPSyncProducerBase, InsertAndRemove)
+{
+  // Use a small expected size so that the name table grows.
+  TestProducer producer(10);
+  InvertibleBloomLookupTable expectedIblt(10);
+  const int nNames = 1000;
+
+  for (int i = 0; i < nNames; ++i) {
+    Name name = Name("/test/user").appendNumber(i);
+    producer.insertIntoIblt(name);
+    expectedIblt.insert(producer.getNameHash(name));
+  }
+  // Inserting again should not change anything.
+  producer.insertIntoIblt(Name("/test/user").appendNumber(0));
+
+  ASSERT_EQ(nNames, producer.getNameCount());
+  ASSERT_TRUE(producer.getIblt().equals(expectedIblt));
+  for (int i = 0; i < nNames; ++i) {
+    Name name = Name("/test/user").appendNumber(i);
+    ASSERT_TRUE(producer.hasName(name));
+    const Name* found = producer.findNameByHash(producer.getNameHash(name));
+    ASSERT_TRUE(found != 0);
+    ASSERT_TRUE(found->equals(name));
+  }
+  ASSERT_FALSE(producer.hasName(Name("/test/other")));
+  ASSERT_TRUE
+    (producer.findNameByHash(producer.getNameHash(Name("/test/other"))) == 0);
+
+  // Remove the even names.
+  for (int i = 0; i < nNames; i += 2) {
+    Name name = Name("/test/user").appendNumber(i);
+    producer.removeFromIblt(name);
+    expectedIblt.erase(producer.getNameHash(name));
+  }
+  // Removing a missing name should do nothing.
+  producer.removeFromIblt(Name("/test/other"));
+
+  ASSERT_EQ(nNames / 2, producer.getNameCount());
+  ASSERT_TRUE(producer.getIblt().equals(expectedIblt));
+  for (int i = 0; i < nNames; ++i) {
+    Name name = Name("/test/user").appendNumber(i);
+    ASSERT_EQ(i % 2 == 1, producer.hasName(name));
+    ASSERT_EQ(i % 2 == 1,
+              producer.findNameByHash(producer.getNameHash(name)) != 0);
+  }
+}
+
+int
+main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
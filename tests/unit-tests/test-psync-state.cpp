@@ -21,6 +21,7 @@
  */
 
 #include "gtest/gtest.h"
+#include <algorithm>
 #include <ndn-cpp/data.hpp>
 #include "../../src/sync/detail/psync-state.hpp"
 
@@ -65,6 +66,98 @@ TEST_F(TestPSyncState, EmptyContent)
   ASSERT_EQ(0, state2.getContent().size());
 }
 
+TEST_F(TestPSyncState, CompactEncodeDecode)
+{
+  PSyncState state;
+  state.addContent(Name("b").append("xyz"));
+  state.addContent(Name("a").appendNumber(2));
+  state.addContent(Name("a").appendNumber(1));
+
+  Blob encoding = state.wireEncode(true);
+  uint8_t expectedEncoding[] = {
+    0x81, 0x14, // PSyncCompactContent
+      0x00, 0x01, 0x08, 0x01, 0x61, // 0 shared, 1 new = "a"
+        0x02,                       // Sequence number 0 + 1
+      0x01, 0x00,                   // 1 shared, 0 new
+        0x02,                       // Sequence number 1 + 1
+      0x00, 0x01, 0x08, 0x01, 0x62, // 0 shared, 1 new = "b"
+        0x00, 0x08, 0x03, 0x78, 0x79, 0x7a // Component "xyz"
+  };
+  ASSERT_TRUE(encoding.equals(Blob(expectedEncoding, sizeof(expectedEncoding))));
+
+  PSyncState receivedState(encoding);
+  // The compact encoding is sorted.
+  ASSERT_EQ(3, receivedState.getContent().size());
+  ASSERT_EQ(Name("a").appendNumber(1), receivedState.getContent()[0]);
+  ASSERT_EQ(Name("a").appendNumber(2), receivedState.getContent()[1]);
+  ASSERT_EQ(Name("b").append("xyz"), receivedState.getContent()[2]);
+}
+
+TEST_F(TestPSyncState, CompactRoundTrip)
+{
+  PSyncState state;
+  state.addContent(Name("/ndn/edu/ucla/alice").appendNumber(65536));
+  state.addContent(Name("/ndn/edu/ucla/alice").appendNumber(0));
+  state.addContent(Name("/ndn/edu/ucla/alice").appendNumber(255));
+  state.addContent(Name("/ndn/edu/ucla/alice").appendNumber(256));
+  state.addContent(Name("/ndn/edu/ucla/bob").appendNumber(0xffffffffffffffffULL));
+  state.addContent(Name("/ndn/edu/ucla/bob").appendNumber(7));
+  state.addContent(Name("/ndn/edu/memphis").appendNumber(3));
+  state.addContent(Name("/ndn/edu/memphis/carol").appendVersion(3));
+  // A non-canonical number is not encoded as a sequence number.
+  uint8_t nonCanonical[] = { 0x00, 0x05 };
+  state.addContent
+    (Name("/ndn/edu/memphis").append(nonCanonical, sizeof(nonCanonical)));
+  state.addContent(Name("/ndn/edu/memphis").append("dave"));
+  state.addContent(Name("single"));
+  state.addContent(Name("").appendNumber(5));
+
+  Blob encoding = state.wireEncode(true);
+  ASSERT_EQ(PSyncState::Tlv_PSyncCompactContent, encoding.buf()[0]);
+  ASSERT_TRUE(encoding.size() < state.wireEncode().size());
+
+  vector<Name> expected = state.getContent();
+  sort(expected.begin(), expected.end());
+  PSyncState receivedState(encoding);
+  ASSERT_TRUE(expected == receivedState.getContent());
+}
+
+TEST_F(TestPSyncState, CompactFallback)
+{
+  // The compact encoding can't split the last component of an empty Name.
+  PSyncState state;
+  state.addContent(Name("test1"));
+  state.addContent(Name());
+
+  Blob encoding = state.wireEncode(true);
+  ASSERT_TRUE(encoding.equals(state.wireEncode()));
+  PSyncState receivedState(encoding);
+  ASSERT_TRUE(state.getContent() == receivedState.getContent());
+
+  // Empty content is still encoded as compact.
+  PSyncState emptyState;
+  PSyncState receivedEmptyState(emptyState.wireEncode(true));
+  ASSERT_EQ(0, receivedEmptyState.getContent().size());
+}
+
+TEST_F(TestPSyncState, IbltComponent)
+{
+  uint8_t ibltBytes[] = { 0x78, 0x9c, 0x01, 0x02 };
+  Blob encodedIblt(ibltBytes, sizeof(ibltBytes));
+
+  Name::Component component = PSyncState::makeIbltComponent(encodedIblt);
+  ASSERT_TRUE(component.getValue().equals(encodedIblt));
+  ASSERT_TRUE(PSyncState::canDecodeCompact(component));
+  ASSERT_FALSE(PSyncState::canDecodeCompact(Name::Component(encodedIblt)));
+
+  // The component type survives the encoding of the sync Interest name.
+  Name name("/sync");
+  name.append(component);
+  Name decodedName;
+  decodedName.wireDecode(name.wireEncode());
+  ASSERT_TRUE(PSyncState::canDecodeCompact(decodedName.get(-1)));
+}
+
 int
 main(int argc, char **argv)
 {
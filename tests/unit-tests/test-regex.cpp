@@ -26,6 +26,7 @@
 #include "../../src/util/regex/ndn-regex-repeat-matcher.hpp"
 #include "../../src/util/regex/ndn-regex-pattern-list-matcher.hpp"
 #include "../../src/util/regex/ndn-regex-top-matcher.hpp"
+#include "../../src/util/regex/ndn-regex-automaton.hpp"
 #include "gtest/gtest.h"
 
 using namespace std;
@@ -453,6 +454,66 @@ TEST_F(TestRegex, TopMatcherAdvanced)
   ASSERT_EQ(Name("/ndn/edu/ucla/yingdi/mac/"), cm->expand());
 }
 
+TEST_F(TestRegex, Automaton)
+{
+  const char* exprs[] = {
+    "^<a><b><c>", "<b><c><d>$", "^<a><b><c><d>$", "<a><b><c><d>", "<b><c>",
+    "^(<.*>*)<.*>", "^(<.*>*)<.*><c>(<.*>)<.*>", "(<.*>*)<.*>$",
+    "<.*>(<.*>*)<.*>$", "<a>(<>*)<>$", "^<ndn><(.*)\\.(.*)><DNS>(<>*)<>",
+    "^[<a><b>]+<c>$", "^<a>?<b>$", "^[<a><b>]{2,3}$", "^[<a><b>]{2,}$",
+    "^[<a><b>]{,2}$", "^[<a><b>]{3}$", "^([<a><b>])+$", "^(<a>(<b>))<c>$",
+    "^[^<a><b>]*<c>$", "^<>*<a><>*$", "^(<a><b>?)*$", "^<a><b>(<c><d>)*$", "^<a.*><b[0-9]+>$", "^<a><b>", "<KEY><>$",
+    "^<a><b><c>$"
+  };
+  const char* names[] = {
+    "/", "/a", "/b", "/c", "/a/b", "/a/b/c", "/a/b/c/d", "/x/a/b/c/d",
+    "/b/c/d", "/a/a/b", "/b/a/b", "/a/b/a", "/a/b/a/b/c", "/a/b/b",
+    "/ndn/ucla.edu/DNS/www/NS", "/ndn/ucla/DNS/www", "/c/d/c", "/d/c",
+    "/a/a/a/a/c", "/abc/b42", "/abc/b", "/x/KEY/1", "/KEY/1/2", "/a/c/a/d"
+  };
+  size_t nExprs = sizeof(exprs) / sizeof(exprs[0]);
+  size_t nNames = sizeof(names) / sizeof(names[0]);
+
+  for (size_t i = 0; i < nExprs; ++i) {
+    NdnRegexTopMatcher topMatcher(exprs[i]);
+    NdnRegexAutomaton automaton(exprs[i]);
+    for (size_t j = 0; j < nNames; ++j) {
+      Name name(names[j]);
+      ASSERT_EQ(topMatcher.match(name), automaton.match(name)) <<
+        "Different result for " << exprs[i] << " on " << names[j];
+    }
+  }
+
+  // A component which is not generic doesn't match a literal.
+  NdnRegexAutomaton literal("^<a><b>$");
+  ASSERT_TRUE(literal.match(Name("/a/b")));
+  ASSERT_FALSE(literal.match
+    (Name("/a").append(Name::Component("b", ndn_NameComponentType_OTHER_CODE, 9))));
+
+  ASSERT_TRUE(NdnRegexAutomaton("^<a><b><c>").getLiteralPrefix().equals
+              (Name("/a/b/c")));
+  ASSERT_TRUE(NdnRegexAutomaton("^<a><b.*><c>").getLiteralPrefix().equals
+              (Name("/a")));
+  ASSERT_TRUE(NdnRegexAutomaton("^(<a><b>)<c>?").getLiteralPrefix().equals
+              (Name("/a/b")));
+  ASSERT_EQ(0, NdnRegexAutomaton("<a><b>").getLiteralPrefix().size());
+  ASSERT_TRUE(NdnRegexAutomaton("^<a>+<b>").getLiteralPrefix().equals
+              (Name("/a")));
+  ASSERT_EQ(0, NdnRegexAutomaton("^<a>?<b>").getLiteralPrefix().size());
+  ASSERT_EQ(0, NdnRegexAutomaton("^[^<a>]<b>").getLiteralPrefix().size());
+
+  ASSERT_TRUE(NdnRegexAutomaton("<a>[<b><c>]<>*<d>{2}").getRequiredComponents()
+              .equals(Name("/a/d")));
+  ASSERT_TRUE(NdnRegexAutomaton("^<a><b>?(<c><d>)+<e.*>").getRequiredComponents()
+              .equals(Name("/a/c/d")));
+  ASSERT_EQ(0, NdnRegexAutomaton("^(<a><b>)*<c>?").getRequiredComponents()
+               .size());
+
+  // A large bounded repetition is too big for the automaton.
+  ASSERT_THROW(NdnRegexAutomaton("^<a>{1,5000}$"), NdnRegexMatcherBase::Error);
+  ASSERT_THROW(NdnRegexAutomaton("^<a>{2,1}$"), NdnRegexMatcherBase::Error);
+}
+
 int
 main(int argc, char **argv)
 {
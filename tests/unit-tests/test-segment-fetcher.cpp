@@ -0,0 +1,686 @@
+/**
+ * Copyright (C) 2020 Regents of the University of California.
+ * @author: Jeff Thompson <jefft0@remap.ucla.edu>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+#include <ndn-cpp/network-nack.hpp>
+#include <ndn-cpp/in-memory-storage/in-memory-storage-retaining.hpp>
+#include <ndn-cpp/util/segment-fetcher.hpp>
+#include <ndn-cpp/encoding/tlv-wire-format.hpp>
+#include <ndn-cpp/lite/lp/lp-packet-lite.hpp>
+#include <ndn-cpp/lite/encoding/tlv-0_2-wire-format-lite.hpp>
+#include "../../src/lp/lp-packet.hpp"
+
+using namespace std;
+using namespace ndn;
+using namespace ndn::func_lib;
+
+static void
+onComplete(const Blob& content, Blob& result) { result = content; }
+
+static void
+onError
+  (SegmentFetcher::ErrorCode errorCode, const string& message,
+   int& resultErrorCode)
+{
+  resultErrorCode = errorCode;
+}
+
+static void
+onSegment
+  (uint64_t offset, const Blob& content, vector<uint64_t>& offsets,
+   vector<uint8_t>& result)
+{
+  offsets.push_back(offset);
+  result.insert(result.end(), content.buf(), content.buf() + content.size());
+}
+
+static bool
+countVerifySegment(const ptr_lib::shared_ptr<Data>& data, int& count)
+{
+  ++count;
+  return true;
+}
+
+static bool
+fileExists(const string& filePath)
+{
+  ifstream stream(filePath.c_str());
+  bool result = (bool)stream;
+  stream.close();
+  return result;
+}
+
+static string
+getPolicyConfigDirectory()
+{
+  string policyConfigDirectory = "policy_config";
+  // Check if expected files are in this directory.
+  if (!fileExists(policyConfigDirectory + "/regex_ruleset.conf")) {
+    // Maybe we are running "make check" from the ndn-cpp root.  There may be
+    //   a way to tell "make check" to run from tests/unit-tests, but for
+    //   now just set policyConfigDirectory explicitly.
+    policyConfigDirectory = "tests/unit-tests/policy_config";
+
+    if(!fileExists(policyConfigDirectory + "/regex_ruleset.conf"))
+      throw runtime_error("Cannot find the directory for policy-config");
+  }
+
+  return policyConfigDirectory;
+}
+
+static void
+appendTlvLength(vector<uint8_t>& encoding, size_t length)
+{
+  if (length < 253)
+    encoding.push_back((uint8_t)length);
+  else {
+    encoding.push_back(253);
+    encoding.push_back((uint8_t)(length >> 8));
+    encoding.push_back((uint8_t)length);
+  }
+}
+
+/**
+ * Imitate onReceivedElement to return a copy of the Data with a
+ * CongestionMark of 1 in its LpPacket.
+ */
+static ptr_lib::shared_ptr<Data>
+makeCongestionMarkedData(const Data& data)
+{
+  Blob dataEncoding = data.wireEncode();
+  vector<uint8_t> fields;
+  // CongestionMark = 1
+  const uint8_t congestionMark[] = { 0xfd, 0x03, 0x40, 0x01, 0x01 };
+  fields.insert(fields.end(), congestionMark, congestionMark + sizeof(congestionMark));
+  // Fragment
+  fields.push_back(0x50);
+  appendTlvLength(fields, dataEncoding.size());
+  fields.insert(fields.end(), dataEncoding.buf(), dataEncoding.buf() + dataEncoding.size());
+  vector<uint8_t> encoding;
+  // LpPacket
+  encoding.push_back(0x64);
+  appendTlvLength(encoding, fields.size());
+  encoding.insert(encoding.end(), fields.begin(), fields.end());
+
+  struct ndn_LpPacketHeaderField headerFields[5];
+  LpPacketLite lpPacketLite
+    (headerFields, sizeof(headerFields) / sizeof(headerFields[0]));
+  ndn_Error error;
+  if ((error = Tlv0_2WireFormatLite::decodeLpPacket
+       (lpPacketLite, &encoding[0], encoding.size())))
+    throw runtime_error(ndn_getErrorString(error));
+  lpPacketLite.setFragmentWireEncoding(BlobLite());
+  ptr_lib::shared_ptr<LpPacket> lpPacket(new LpPacket());
+  lpPacket->set(lpPacketLite);
+
+  ptr_lib::shared_ptr<Data> result(new Data());
+  result->wireDecode(dataEncoding, *TlvWireFormat::get());
+  result->setLpPacket(lpPacket);
+  return result;
+}
+
+/**
+ * QueueFace extends Face to queue each expressed Interest until
+ * processEvents, which answers all the queued Interests from an
+ * InMemoryStorageRetaining. This lets the SegmentFetcher pipeline have more
+ * than one Interest outstanding.
+ */
+class QueueFace : public Face {
+public:
+  QueueFace(InMemoryStorageRetaining* storage)
+  : Face("localhost"), maxInFlight_(0), reverseOrder_(false),
+    nackReason_(ndn_NetworkNackReason_NONE), markCongestion_(false),
+    duplicateData_(false), storage_(storage), nextPendingInterestId_(1)
+  {
+  }
+
+  virtual uint64_t
+  expressInterest
+    (const Interest& interest, const OnData& onData, const OnTimeout& onTimeout,
+     const OnNetworkNack& onNetworkNack,
+     WireFormat& wireFormat = *WireFormat::getDefaultWireFormat())
+  {
+    sentInterests_.push_back(ptr_lib::make_shared<Interest>(interest));
+
+    Entry entry;
+    entry.pendingInterestId_ = nextPendingInterestId_++;
+    entry.interest_ = ptr_lib::make_shared<Interest>(interest);
+    entry.onData_ = onData;
+    entry.onTimeout_ = onTimeout;
+    entry.onNetworkNack_ = onNetworkNack;
+    queue_.push_back(entry);
+    maxInFlight_ = max(maxInFlight_, queue_.size());
+
+    return entry.pendingInterestId_;
+  }
+
+  virtual void
+  removePendingInterest(uint64_t pendingInterestId)
+  {
+    for (size_t i = 0; i < queue_.size(); ++i) {
+      if (queue_[i].pendingInterestId_ == pendingInterestId) {
+        queue_.erase(queue_.begin() + i);
+        return;
+      }
+    }
+  }
+
+  /**
+   * Answer all the queued Interests. An Interest for a name in timeoutNames_
+   * times out once. If nackReason_ is not NONE, every Interest gets a Network
+   * Nack. If markCongestion_ is true, set the congestion mark of every Data.
+   * If duplicateData_ is true, deliver every Data twice.
+   */
+  virtual void
+  processEvents()
+  {
+    vector<Entry> queue;
+    queue.swap(queue_);
+    if (reverseOrder_)
+      reverse(queue.begin(), queue.end());
+
+    for (size_t i = 0; i < queue.size(); ++i) {
+      const Entry& entry = queue[i];
+
+      vector<Name>::iterator timeoutName = find
+        (timeoutNames_.begin(), timeoutNames_.end(), entry.interest_->getName());
+      if (timeoutName != timeoutNames_.end()) {
+        timeoutNames_.erase(timeoutName);
+        entry.onTimeout_(entry.interest_);
+        continue;
+      }
+
+      if (nackReason_ != ndn_NetworkNackReason_NONE) {
+        ptr_lib::shared_ptr<NetworkNack> networkNack(new NetworkNack());
+        networkNack->setReason(nackReason_);
+        entry.onNetworkNack_(entry.interest_, networkNack);
+        continue;
+      }
+
+      ptr_lib::shared_ptr<Data> data = storage_->find(*entry.interest_);
+      if (data) {
+        if (markCongestion_)
+          data = makeCongestionMarkedData(*data);
+        entry.onData_(entry.interest_, data);
+        if (duplicateData_)
+          entry.onData_(entry.interest_, data);
+      }
+      else
+        entry.onTimeout_(entry.interest_);
+    }
+  }
+
+  /**
+   * Count the sent Interests with the name.
+   */
+  size_t
+  countSentInterests(const Name& name)
+  {
+    size_t count = 0;
+    for (size_t i = 0; i < sentInterests_.size(); ++i) {
+      if (sentInterests_[i]->getName().equals(name))
+        ++count;
+    }
+    return count;
+  }
+
+  vector<ptr_lib::shared_ptr<Interest> > sentInterests_;
+  size_t maxInFlight_;
+  bool reverseOrder_;
+  ndn_NetworkNackReason nackReason_;
+  vector<Name> timeoutNames_;
+  bool markCongestion_;
+  bool duplicateData_;
+
+private:
+  class Entry {
+  public:
+    uint64_t pendingInterestId_;
+    ptr_lib::shared_ptr<Interest> interest_;
+    OnData onData_;
+    OnTimeout onTimeout_;
+    OnNetworkNack onNetworkNack_;
+  };
+
+  InMemoryStorageRetaining* storage_;
+  uint64_t nextPendingInterestId_;
+  vector<Entry> queue_;
+};
+
+class TestSegmentFetcher : public ::testing::Test {
+public:
+  TestSegmentFetcher()
+  : prefix_("/test/object"), face_(&storage_)
+  {
+    outputFilePath_ = getPolicyConfigDirectory() + "/test-segment-fetcher.out";
+    remove(outputFilePath_.c_str());
+  }
+
+  virtual void
+  TearDown()
+  {
+    remove(outputFilePath_.c_str());
+  }
+
+  /**
+   * Make the segments of content and insert them into storage_.
+   */
+  void
+  publish(size_t nSegments)
+  {
+    Name versionedPrefix = Name(prefix_).appendVersion(1);
+    for (size_t i = 0; i < nSegments; ++i) {
+      Data segment(Name(versionedPrefix).appendSegment(i));
+      uint8_t value = (uint8_t)i;
+      segment.setContent(Blob(&value, 1));
+      segment.getMetaInfo().setFinalBlockId
+        (Name::Component::fromSegment(nSegments - 1));
+      storage_.insert(segment);
+    }
+  }
+
+  /**
+   * Call face_.processEvents() until the fetch is finished.
+   */
+  void
+  processEvents(const Blob& content, int& errorCode)
+  {
+    for (int i = 0; i < 1000 && content.isNull() && errorCode == 0; ++i)
+      face_.processEvents();
+  }
+
+  Name prefix_;
+  InMemoryStorageRetaining storage_;
+  QueueFace face_;
+  string outputFilePath_;
+};
+
+TEST_F(TestSegmentFetcher, RttEstimator)
+{
+  RttEstimator estimator(1000.0, 200.0, 60000.0);
+  ASSERT_EQ(1000.0, estimator.getEstimatedRto());
+
+  estimator.addMeasurement(100.0);
+  // SRTT = 100, RTTVAR = 50, RTO = 100 + 4 * 50.
+  ASSERT_EQ(100.0, estimator.getSmoothedRtt());
+  ASSERT_EQ(300.0, estimator.getEstimatedRto());
+
+  estimator.addMeasurement(100.0);
+  // RTTVAR = 0.75 * 50, RTO = 100 + 4 * 37.5.
+  ASSERT_EQ(250.0, estimator.getEstimatedRto());
+
+  estimator.backoffRto();
+  ASSERT_EQ(500.0, estimator.getEstimatedRto());
+
+  // The RTO is not less than the minimum.
+  for (int i = 0; i < 100; ++i)
+    estimator.addMeasurement(1.0);
+  ASSERT_EQ(200.0, estimator.getEstimatedRto());
+}
+
+TEST_F(TestSegmentFetcher, Pipeline)
+{
+  publish(50);
+
+  Blob content;
+  int errorCode = 0;
+  SegmentFetcher::fetch
+    (face_, Interest(prefix_), SegmentFetcher::DontVerifySegment,
+     bind(&onComplete, _1, ref(content)),
+     bind(&onError, _1, _2, ref(errorCode)), SegmentFetcher::Options());
+  processEvents(content, errorCode);
+
+  ASSERT_EQ(0, errorCode);
+  ASSERT_EQ(50, content.size());
+  for (size_t i = 0; i < content.size(); ++i)
+    ASSERT_EQ(i, content.buf()[i]);
+  // The window grew past one Interest.
+  ASSERT_TRUE(face_.maxInFlight_ > 4);
+  // The Interest to discover the version (with ChildSelector=1) got the last
+  // segment, so each other segment was requested once.
+  ASSERT_EQ(50, face_.sentInterests_.size());
+}
+
+TEST_F(TestSegmentFetcher, OutOfOrder)
+{
+  publish(20);
+  face_.reverseOrder_ = true;
+
+  Blob content;
+  int errorCode = 0;
+  SegmentFetcher::fetch
+    (face_, Interest(prefix_), SegmentFetcher::DontVerifySegment,
+     bind(&onComplete, _1, ref(content)),
+     bind(&onError, _1, _2, ref(errorCode)),
+     SegmentFetcher::Options().setInitialWindow(8).setUseConstantWindow(true));
+  processEvents(content, errorCode);
+
+  ASSERT_EQ(0, errorCode);
+  ASSERT_EQ(20, content.size());
+  for (size_t i = 0; i < content.size(); ++i)
+    ASSERT_EQ(i, content.buf()[i]);
+  ASSERT_EQ(8, face_.maxInFlight_);
+}
+
+TEST_F(TestSegmentFetcher, Retransmit)
+{
+  publish(10);
+  Name segment3Name = Name(prefix_).appendVersion(1).appendSegment(3);
+  face_.timeoutNames_.push_back(segment3Name);
+
+  Blob content;
+  int errorCode = 0;
+  SegmentFetcher::fetch
+    (face_, Interest(prefix_), SegmentFetcher::DontVerifySegment,
+     bind(&onComplete, _1, ref(content)),
+     bind(&onError, _1, _2, ref(errorCode)), SegmentFetcher::Options());
+  processEvents(content, errorCode);
+
+  ASSERT_EQ(0, errorCode);
+  ASSERT_EQ(10, content.size());
+  for (size_t i = 0; i < content.size(); ++i)
+    ASSERT_EQ(i, content.buf()[i]);
+  ASSERT_EQ(2, face_.countSentInterests(segment3Name));
+}
+
+TEST_F(TestSegmentFetcher, Duplicate)
+{
+  publish(10);
+  face_.duplicateData_ = true;
+
+  Blob content;
+  int errorCode = 0;
+  int nVerified = 0;
+  SegmentFetcher::fetch
+    (face_, Interest(prefix_), bind(&countVerifySegment, _1, ref(nVerified)),
+     bind(&onComplete, _1, ref(content)),
+     bind(&onError, _1, _2, ref(errorCode)), SegmentFetcher::Options());
+  processEvents(content, errorCode);
+
+  ASSERT_EQ(0, errorCode);
+  ASSERT_EQ(10, content.size());
+  for (size_t i = 0; i < content.size(); ++i)
+    ASSERT_EQ(i, content.buf()[i]);
+  // Each duplicate was dropped before verifying it.
+  ASSERT_EQ(10, nVerified);
+}
+
+TEST_F(TestSegmentFetcher, CongestionMark)
+{
+  publish(50);
+  face_.markCongestion_ = true;
+
+  Blob content;
+  int errorCode = 0;
+  SegmentFetcher::fetch
+    (face_, Interest(prefix_), SegmentFetcher::DontVerifySegment,
+     bind(&onComplete, _1, ref(content)),
+     bind(&onError, _1, _2, ref(errorCode)), SegmentFetcher::Options());
+  processEvents(content, errorCode);
+
+  ASSERT_EQ(0, errorCode);
+  ASSERT_EQ(50, content.size());
+  // Each congestion mark keeps the window from growing.
+  ASSERT_TRUE(face_.maxInFlight_ <= 3);
+
+  // Fetch again, ignoring the congestion marks.
+  face_.maxInFlight_ = 0;
+  content = Blob();
+  SegmentFetcher::fetch
+    (face_, Interest(prefix_), SegmentFetcher::DontVerifySegment,
+     bind(&onComplete, _1, ref(content)),
+     bind(&onError, _1, _2, ref(errorCode)),
+     SegmentFetcher::Options().setIgnoreCongestionMarks(true));
+  processEvents(content, errorCode);
+
+  ASSERT_EQ(0, errorCode);
+  ASSERT_EQ(50, content.size());
+  ASSERT_TRUE(face_.maxInFlight_ > 4);
+}
+
+TEST_F(TestSegmentFetcher, NackError)
+{
+  publish(10);
+  face_.nackReason_ = ndn_NetworkNackReason_NO_ROUTE;
+
+  Blob content;
+  int errorCode = 0;
+  SegmentFetcher::fetch
+    (face_, Interest(prefix_), SegmentFetcher::DontVerifySegment,
+     bind(&onComplete, _1, ref(content)),
+     bind(&onError, _1, _2, ref(errorCode)),
+     SegmentFetcher::Options().setMaxRetries(2));
+  processEvents(content, errorCode);
+
+  ASSERT_EQ(SegmentFetcher::NACK_ERROR, errorCode);
+  ASSERT_TRUE(content.isNull());
+  // The Interest to discover the version was sent with 2 retries.
+  ASSERT_EQ(3, face_.sentInterests_.size());
+}
+
+TEST_F(TestSegmentFetcher, TimeoutError)
+{
+  // Publish segments 0 to 9 with a FinalBlockId of 20 so that Interests for
+  // segment 10 are never answered.
+  Name versionedPrefix = Name(prefix_).appendVersion(1);
+  for (size_t i = 0; i < 10; ++i) {
+    Data segment(Name(versionedPrefix).appendSegment(i));
+    segment.getMetaInfo().setFinalBlockId(Name::Component::fromSegment(20));
+    storage_.insert(segment);
+  }
+
+  Blob content;
+  int errorCode = 0;
+  SegmentFetcher::fetch
+    (face_, Interest(prefix_), SegmentFetcher::DontVerifySegment,
+     bind(&onComplete, _1, ref(content)),
+     bind(&onError, _1, _2, ref(errorCode)),
+     SegmentFetcher::Options().setMaxRetries(3));
+  processEvents(content, errorCode);
+
+  ASSERT_EQ(SegmentFetcher::INTEREST_TIMEOUT, errorCode);
+  ASSERT_TRUE(content.isNull());
+  ASSERT_EQ(4, face_.countSentInterests(Name(versionedPrefix).appendSegment(10)));
+}
+
+TEST_F(TestSegmentFetcher, Manifest)
+{
+  publish(50);
+  vector<ptr_lib::shared_ptr<Data> > segments;
+  Name versionedPrefix = Name(prefix_).appendVersion(1);
+  for (size_t i = 0; i < 50; ++i)
+    segments.push_back(storage_.find(Interest(Name(versionedPrefix).appendSegment(i))));
+  KeyChain keyChain("pib-memory:", "tpm-memory:");
+  vector<ptr_lib::shared_ptr<Data> > manifests;
+  SegmentManifest::makeManifest
+    (segments, keyChain, manifests,
+     SigningInfo(SigningInfo::SIGNER_TYPE_SHA256), 8);
+  for (size_t i = 0; i < manifests.size(); ++i)
+    storage_.insert(*manifests[i]);
+  // makeManifest signs the segments, so replace the unsigned segments.
+  for (size_t i = 0; i < segments.size(); ++i) {
+    storage_.remove(segments[i]->getName());
+    storage_.insert(*segments[i]);
+  }
+  face_.reverseOrder_ = true;
+
+  Blob content;
+  int errorCode = 0;
+  SegmentFetcher::fetchWithManifest
+    (face_, Interest(prefix_), SegmentFetcher::DontVerifySegment,
+     bind(&onComplete, _1, ref(content)),
+     bind(&onError, _1, _2, ref(errorCode)), SegmentFetcher::Options());
+  processEvents(content, errorCode);
+
+  ASSERT_EQ(0, errorCode);
+  ASSERT_EQ(50, content.size());
+  for (size_t i = 0; i < content.size(); ++i)
+    ASSERT_EQ(i, content.buf()[i]);
+  // Each manifest segment was fetched once.
+  for (size_t i = 0; i < manifests.size(); ++i)
+    ASSERT_EQ(1, face_.countSentInterests(manifests[i]->getName()));
+}
+
+TEST_F(TestSegmentFetcher, Streaming)
+{
+  publish(50);
+  face_.reverseOrder_ = true;
+
+  Blob content;
+  int errorCode = 0;
+  vector<uint64_t> offsets;
+  vector<uint8_t> result;
+  SegmentFetcher::fetch
+    (face_, Interest(prefix_), SegmentFetcher::DontVerifySegment,
+     bind(&onComplete, _1, ref(content)),
+     bind(&onError, _1, _2, ref(errorCode)),
+     SegmentFetcher::Options().setOnSegment
+       (bind(&onSegment, _1, _2, ref(offsets), ref(result))));
+  for (int i = 0; i < 1000 && offsets.size() < 50 && errorCode == 0; ++i)
+    face_.processEvents();
+
+  ASSERT_EQ(0, errorCode);
+  // In streaming mode, onComplete gets a null Blob.
+  ASSERT_TRUE(content.isNull());
+  // The segments arrived out of order but are delivered in order.
+  ASSERT_EQ(50, offsets.size());
+  ASSERT_EQ(50, result.size());
+  for (size_t i = 0; i < result.size(); ++i) {
+    ASSERT_EQ(i, offsets[i]);
+    ASSERT_EQ(i, result[i]);
+  }
+}
+
+TEST_F(TestSegmentFetcher, StreamingBoundedByWindow)
+{
+  publish(200);
+  // Hold back segment 1 while it is retried.
+  Name segment1Name = Name(prefix_).appendVersion(1).appendSegment(1);
+  for (int i = 0; i < 12; ++i)
+    face_.timeoutNames_.push_back(segment1Name);
+
+  Blob content;
+  int errorCode = 0;
+  vector<uint64_t> offsets;
+  vector<uint8_t> result;
+  const double maxWindow = 8;
+  SegmentFetcher::fetch
+    (face_, Interest(prefix_), SegmentFetcher::DontVerifySegment,
+     bind(&onComplete, _1, ref(content)),
+     bind(&onError, _1, _2, ref(errorCode)),
+     SegmentFetcher::Options().setMaxWindow(maxWindow).setOnSegment
+       (bind(&onSegment, _1, _2, ref(offsets), ref(result))));
+  for (int i = 0; i < 1000 && offsets.size() < 200 && errorCode == 0; ++i) {
+    face_.processEvents();
+
+    if (offsets.size() <= 1) {
+      // Segment 1 is not delivered, so the segments after it are buffered.
+      // They must be within the window.
+      uint64_t maxSegment = 0;
+      for (size_t j = 0; j < face_.sentInterests_.size(); ++j) {
+        const Name& name = face_.sentInterests_[j]->getName();
+        if (name.size() > 0 && name.get(-1).isSegment())
+          maxSegment = max(maxSegment, name.get(-1).toSegment());
+      }
+      ASSERT_LT(maxSegment - 1, maxWindow);
+    }
+  }
+
+  ASSERT_EQ(0, errorCode);
+  ASSERT_EQ(13, face_.countSentInterests(segment1Name));
+  ASSERT_EQ(200, result.size());
+  for (size_t i = 0; i < result.size(); ++i)
+    ASSERT_EQ((uint8_t)i, result[i]);
+}
+
+TEST_F(TestSegmentFetcher, OutputBuffer)
+{
+  publish(50);
+
+  Blob content;
+  int errorCode = 0;
+  vector<uint64_t> offsets;
+  vector<uint8_t> result;
+  uint8_t buffer[50];
+  SegmentFetcher::fetch
+    (face_, Interest(prefix_), SegmentFetcher::DontVerifySegment,
+     bind(&onComplete, _1, ref(content)),
+     bind(&onError, _1, _2, ref(errorCode)),
+     SegmentFetcher::Options().setOutputBuffer(buffer, sizeof(buffer))
+       .setOnSegment(bind(&onSegment, _1, _2, ref(offsets), ref(result))));
+  for (int i = 0; i < 1000 && offsets.size() < 50 && errorCode == 0; ++i)
+    face_.processEvents();
+
+  ASSERT_EQ(0, errorCode);
+  ASSERT_EQ(50, offsets.size());
+  for (size_t i = 0; i < sizeof(buffer); ++i)
+    ASSERT_EQ(i, buffer[i]);
+
+  // A buffer which is too small.
+  uint8_t smallBuffer[40];
+  SegmentFetcher::fetch
+    (face_, Interest(prefix_), SegmentFetcher::DontVerifySegment,
+     bind(&onComplete, _1, ref(content)),
+     bind(&onError, _1, _2, ref(errorCode)),
+     SegmentFetcher::Options().setOutputBuffer(smallBuffer, sizeof(smallBuffer)));
+  processEvents(content, errorCode);
+
+  ASSERT_EQ(SegmentFetcher::IO_ERROR, errorCode);
+}
+
+TEST_F(TestSegmentFetcher, OutputFile)
+{
+  publish(50);
+
+  Blob content;
+  int errorCode = 0;
+  vector<uint64_t> offsets;
+  vector<uint8_t> result;
+  // Start with an empty file so that it must grow.
+  SegmentFetcher::fetch
+    (face_, Interest(prefix_), SegmentFetcher::DontVerifySegment,
+     bind(&onComplete, _1, ref(content)),
+     bind(&onError, _1, _2, ref(errorCode)),
+     SegmentFetcher::Options().setOutputFile(outputFilePath_)
+       .setOnSegment(bind(&onSegment, _1, _2, ref(offsets), ref(result))));
+  for (int i = 0; i < 1000 && offsets.size() < 50 && errorCode == 0; ++i)
+    face_.processEvents();
+
+  ASSERT_EQ(0, errorCode);
+  ASSERT_EQ(50, offsets.size());
+
+  // The file is truncated to the content size.
+  ifstream file(outputFilePath_.c_str(), ios::binary);
+  vector<char> fileContent
+    ((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+  ASSERT_EQ(50, fileContent.size());
+  for (size_t i = 0; i < fileContent.size(); ++i)
+    ASSERT_EQ(i, (uint8_t)fileContent[i]);
+}
+
+int
+main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
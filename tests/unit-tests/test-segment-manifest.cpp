@@ -0,0 +1,202 @@
+/**
+ * Copyright (C) 2020 Regents of the University of California.
+ * @author: Jeff Thompson <jefft0@remap.ucla.edu>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+#include "gtest/gtest.h"
+#include <ndn-cpp/digest-sha256-signature.hpp>
+#include <ndn-cpp/util/segment-fetcher.hpp>
+#include "identity-management-fixture.hpp"
+#include "in-memory-storage-face.hpp"
+
+using namespace std;
+using namespace ndn;
+using namespace ndn::func_lib;
+
+static void
+onComplete(const Blob& content, Blob& result) { result = content; }
+
+static void
+onError
+  (SegmentFetcher::ErrorCode errorCode, const string& message,
+   int& resultErrorCode)
+{
+  resultErrorCode = errorCode;
+}
+
+static bool
+countVerifySegment(const ptr_lib::shared_ptr<Data>& data, int& nCalls)
+{
+  ++nCalls;
+  return true;
+}
+
+class TestSegmentManifest : public ::testing::Test, public IdentityManagementFixture {
+public:
+  TestSegmentManifest()
+  : prefix_("/test/object"), face_(&storage_)
+  {
+    addIdentity(Name("/test"));
+  }
+
+  /**
+   * Make the segments of content, make the manifest and insert all into
+   * storage_.
+   */
+  void
+  publish(size_t nSegments, size_t maxDigestsPerManifest)
+  {
+    Name versionedPrefix = Name(prefix_).appendVersion(1);
+    for (size_t i = 0; i < nSegments; ++i) {
+      ptr_lib::shared_ptr<Data> segment = ptr_lib::make_shared<Data>
+        (Name(versionedPrefix).appendSegment(i));
+      uint8_t value = (uint8_t)i;
+      segment->setContent(Blob(&value, 1));
+      segment->getMetaInfo().setFinalBlockId
+        (Name::Component::fromSegment(nSegments - 1));
+      segments_.push_back(segment);
+    }
+
+    SegmentManifest::makeManifest
+      (segments_, keyChain_, manifests_, SigningInfo(), maxDigestsPerManifest);
+
+    for (size_t i = 0; i < segments_.size(); ++i)
+      storage_.insert(*segments_[i]);
+    for (size_t i = 0; i < manifests_.size(); ++i)
+      storage_.insert(*manifests_[i]);
+  }
+
+  Name prefix_;
+  InMemoryStorageRetaining storage_;
+  InMemoryStorageFace face_;
+  vector<ptr_lib::shared_ptr<Data> > segments_;
+  vector<ptr_lib::shared_ptr<Data> > manifests_;
+};
+
+TEST_F(TestSegmentManifest, EncodeDecode)
+{
+  uint8_t digest1[ndn_SHA256_DIGEST_SIZE];
+  uint8_t digest2[ndn_SHA256_DIGEST_SIZE];
+  for (size_t i = 0; i < ndn_SHA256_DIGEST_SIZE; ++i) {
+    digest1[i] = (uint8_t)i;
+    digest2[i] = (uint8_t)(0xff - i);
+  }
+
+  SegmentManifest manifest;
+  manifest.addDigest(Blob(digest1, sizeof(digest1)));
+  manifest.addDigest(Blob(digest2, sizeof(digest2)));
+  manifest.setNextManifestDigest(Blob(digest2, sizeof(digest2)));
+
+  SegmentManifest decoded(manifest.wireEncode());
+  ASSERT_EQ(2, decoded.getDigests().size());
+  ASSERT_TRUE(decoded.getDigests()[0].equals(Blob(digest1, sizeof(digest1))));
+  ASSERT_TRUE(decoded.getDigests()[1].equals(Blob(digest2, sizeof(digest2))));
+  ASSERT_TRUE(decoded.getNextManifestDigest().equals
+              (Blob(digest2, sizeof(digest2))));
+
+  // The last manifest segment has no next manifest digest.
+  manifest.setNextManifestDigest(Blob());
+  decoded.wireDecode(manifest.wireEncode());
+  ASSERT_EQ(2, decoded.getDigests().size());
+  ASSERT_TRUE(decoded.getNextManifestDigest().isNull());
+}
+
+TEST_F(TestSegmentManifest, MakeManifest)
+{
+  publish(10, 4);
+
+  ASSERT_EQ(3, manifests_.size());
+  for (size_t i = 0; i < segments_.size(); ++i)
+    ASSERT_TRUE(dynamic_cast<const DigestSha256Signature*>
+                (segments_[i]->getSignature()) != 0);
+  // Only manifest segment 0 is signed with the KeyChain.
+  ASSERT_TRUE(dynamic_cast<const DigestSha256Signature*>
+              (manifests_[0]->getSignature()) == 0);
+  ASSERT_TRUE(dynamic_cast<const DigestSha256Signature*>
+              (manifests_[1]->getSignature()) != 0);
+
+  Name manifestPrefix = SegmentManifest::getManifestPrefix
+    (Name(prefix_).appendVersion(1));
+  for (size_t i = 0; i < manifests_.size(); ++i) {
+    ASSERT_TRUE(manifests_[i]->getName().equals
+                (Name(manifestPrefix).appendSegment(i)));
+    ASSERT_EQ(2, manifests_[i]->getMetaInfo().getFinalBlockId().toSegment());
+  }
+
+  SegmentManifest manifest0(manifests_[0]->getContent());
+  ASSERT_EQ(4, manifest0.getDigests().size());
+  ASSERT_TRUE(manifest0.getDigests()[3].equals
+              (segments_[3]->getFullName()->get(-1).getValue()));
+  ASSERT_TRUE(manifest0.getNextManifestDigest().equals
+              (manifests_[1]->getFullName()->get(-1).getValue()));
+
+  SegmentManifest manifest2(manifests_[2]->getContent());
+  ASSERT_EQ(2, manifest2.getDigests().size());
+  ASSERT_TRUE(manifest2.getNextManifestDigest().isNull());
+}
+
+TEST_F(TestSegmentManifest, FetchWithManifest)
+{
+  publish(10, 4);
+
+  Blob content;
+  int errorCode = 0;
+  int nVerifyCalls = 0;
+  SegmentFetcher::fetchWithManifest
+    (face_, Interest(prefix_),
+     bind(&countVerifySegment, _1, ref(nVerifyCalls)),
+     bind(&onComplete, _1, ref(content)),
+     bind(&onError, _1, _2, ref(errorCode)));
+
+  ASSERT_EQ(0, errorCode);
+  ASSERT_EQ(10, content.size());
+  for (size_t i = 0; i < content.size(); ++i)
+    ASSERT_EQ(i, content.buf()[i]);
+  // Only manifest segment 0 is verified with verifySegment.
+  ASSERT_EQ(1, nVerifyCalls);
+}
+
+TEST_F(TestSegmentManifest, FetchWithManifestBadSegment)
+{
+  publish(10, 4);
+
+  // Replace segment 6 with different content, still signed with a digest.
+  Data badSegment(*segments_[6]);
+  uint8_t value = 0xff;
+  badSegment.setContent(Blob(&value, 1));
+  keyChain_.sign(badSegment, SigningInfo(SigningInfo::SIGNER_TYPE_SHA256));
+  storage_.remove(segments_[6]->getName());
+  storage_.insert(badSegment);
+
+  Blob content;
+  int errorCode = 0;
+  SegmentFetcher::fetchWithManifest
+    (face_, Interest(prefix_), SegmentFetcher::DontVerifySegment,
+     bind(&onComplete, _1, ref(content)),
+     bind(&onError, _1, _2, ref(errorCode)));
+
+  ASSERT_EQ(SegmentFetcher::SEGMENT_VERIFICATION_FAILED, errorCode);
+  ASSERT_TRUE(content.isNull());
+}
+
+int
+main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,209 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Regents of the University of California.
+ * @author: Jeff Thompson <jefft0@remap.ucla.edu>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+#include "gtest/gtest.h"
+#include <fstream>
+#include <stdexcept>
+#include <ndn-cpp/security/verification-helpers.hpp>
+#include <ndn-cpp/util/segment-publisher.hpp>
+
+using namespace std;
+using namespace ndn;
+using namespace ndn::func_lib;
+
+static bool
+fileExists(const string& filePath)
+{
+  ifstream stream(filePath.c_str());
+  bool result = (bool)stream;
+  stream.close();
+  return result;
+}
+
+static string
+getPolicyConfigDirectory()
+{
+  string policyConfigDirectory = "policy_config";
+  // Check if expected files are in this directory.
+  if (!fileExists(policyConfigDirectory + "/regex_ruleset.conf")) {
+    // Maybe we are running "make check" from the ndn-cpp root.  There may be
+    //   a way to tell "make check" to run from tests/unit-tests, but for
+    //   now just set policyConfigDirectory explicitly.
+    policyConfigDirectory = "tests/unit-tests/policy_config";
+
+    if(!fileExists(policyConfigDirectory + "/regex_ruleset.conf"))
+      throw runtime_error("Cannot find the directory for policy-config");
+  }
+
+  return policyConfigDirectory;
+}
+
+static void
+onSegment(const Data& segment, vector<Data>& segments)
+{
+  segments.push_back(segment);
+}
+
+class TestSegmentPublisher : public ::testing::Test {
+public:
+  TestSegmentPublisher()
+  : keyChain_("pib-memory:", "tpm-memory:")
+  {
+    for (size_t i = 0; i < 10000; ++i)
+      content_.push_back((uint8_t)i);
+  }
+
+  /**
+   * Check that segments_ has the names, FinalBlockId and content for
+   * content_.
+   */
+  void
+  checkSegments(const Name& versionedName, size_t segmentSize)
+  {
+    size_t nSegments = (content_.size() + segmentSize - 1) / segmentSize;
+    ASSERT_EQ(nSegments, segments_.size());
+    vector<uint8_t> content;
+    for (size_t i = 0; i < segments_.size(); ++i) {
+      const Data& segment = segments_[i];
+      ASSERT_TRUE(segment.getName().equals
+                  (Name(versionedName).appendSegment(i)));
+      ASSERT_EQ(nSegments - 1,
+                segment.getMetaInfo().getFinalBlockId().toSegment());
+      content.insert
+        (content.end(), segment.getContent().buf(),
+         segment.getContent().buf() + segment.getContent().size());
+    }
+    ASSERT_TRUE(content == content_);
+  }
+
+  KeyChain keyChain_;
+  vector<uint8_t> content_;
+  vector<Data> segments_;
+};
+
+TEST_F(TestSegmentPublisher, Rsa)
+{
+  ptr_lib::shared_ptr<PibIdentity> identity =
+    keyChain_.createIdentityV2(Name("/test/rsa"), RsaKeyParams());
+  SegmentPublisher publisher
+    (keyChain_, SegmentPublisher::Options().setSegmentSize(1000)
+     .setFreshnessPeriod(1000.0).setSigningInfo(SigningInfo(identity)));
+
+  Name versionedName = publisher.publish
+    (Name("/test/object"), Blob(content_),
+     bind(&onSegment, _1, ref(segments_)));
+  ASSERT_TRUE(Name("/test/object").isPrefixOf(versionedName));
+  ASSERT_TRUE(versionedName[-1].isVersion());
+  ASSERT_EQ(10, publisher.getLastSegmentCount());
+  checkSegments(versionedName, 1000);
+
+  ptr_lib::shared_ptr<CertificateV2> certificate =
+    identity->getDefaultKey()->getDefaultCertificate();
+  for (size_t i = 0; i < segments_.size(); ++i) {
+    ASSERT_EQ(1000.0, segments_[i].getMetaInfo().getFreshnessPeriod());
+    ASSERT_TRUE(VerificationHelpers::verifyDataSignature
+                (segments_[i], *certificate));
+  }
+}
+
+TEST_F(TestSegmentPublisher, Ecdsa)
+{
+  ptr_lib::shared_ptr<PibIdentity> identity =
+    keyChain_.createIdentityV2(Name("/test/ecdsa"), EcKeyParams());
+  SegmentPublisher publisher
+    (keyChain_, SegmentPublisher::Options().setSegmentSize(300)
+     .setNThreads(3).setSigningInfo(SigningInfo(identity)));
+
+  Name versionedName = publisher.publish
+    (Name("/test/object"), Blob(content_),
+     bind(&onSegment, _1, ref(segments_)));
+  checkSegments(versionedName, 300);
+
+  ptr_lib::shared_ptr<CertificateV2> certificate =
+    identity->getDefaultKey()->getDefaultCertificate();
+  for (size_t i = 0; i < segments_.size(); ++i)
+    ASSERT_TRUE(VerificationHelpers::verifyDataSignature
+                (segments_[i], *certificate));
+}
+
+TEST_F(TestSegmentPublisher, DigestSha256)
+{
+  SigningInfo signingInfo;
+  signingInfo.setSha256Signing();
+  // Use one thread to sign on the calling thread.
+  size_t nThreadsList[] = { 1, 4 };
+  for (size_t i = 0; i < 2; ++i) {
+    segments_.clear();
+    SegmentPublisher publisher
+      (keyChain_, SegmentPublisher::Options().setSegmentSize(100)
+       .setNThreads(nThreadsList[i]).setSigningInfo(signingInfo));
+
+    Name versionedName = publisher.publish
+      (Name("/test/object"), Blob(content_),
+       bind(&onSegment, _1, ref(segments_)));
+    checkSegments(versionedName, 100);
+    for (size_t j = 0; j < segments_.size(); ++j)
+      ASSERT_TRUE(VerificationHelpers::verifyDataDigest
+                  (segments_[j], DIGEST_ALGORITHM_SHA256));
+  }
+
+  // Empty content has one segment.
+  segments_.clear();
+  SegmentPublisher publisher
+    (keyChain_, SegmentPublisher::Options().setSigningInfo(signingInfo));
+  publisher.publish
+    (Name("/test/empty"), Blob(), bind(&onSegment, _1, ref(segments_)));
+  ASSERT_EQ(1, segments_.size());
+  ASSERT_EQ(0, segments_[0].getContent().size());
+  ASSERT_EQ(0, segments_[0].getMetaInfo().getFinalBlockId().toSegment());
+}
+
+TEST_F(TestSegmentPublisher, File)
+{
+  string filePath =
+    getPolicyConfigDirectory() + "/test-segment-publisher.dat";
+  {
+    ofstream file(filePath.c_str(), ios::binary);
+    file.write((const char*)&content_[0], content_.size());
+  }
+
+  SigningInfo signingInfo;
+  signingInfo.setSha256Signing();
+  SegmentPublisher publisher
+    (keyChain_, SegmentPublisher::Options().setSegmentSize(128)
+     .setSigningInfo(signingInfo));
+  Name versionedName = publisher.publishFile
+    (Name("/test/file"), filePath, bind(&onSegment, _1, ref(segments_)));
+  remove(filePath.c_str());
+  checkSegments(versionedName, 128);
+
+  ASSERT_THROW
+    (publisher.publishFile
+     (Name("/test/file"), filePath, bind(&onSegment, _1, ref(segments_))),
+     runtime_error);
+}
+
+int
+main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
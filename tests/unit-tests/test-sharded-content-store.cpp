@@ -0,0 +1,164 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Regents of the University of California.
+ * @author: Jeff Thompson <jefft0@remap.ucla.edu>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+#include <pthread.h>
+#include <unistd.h>
+#include "gtest/gtest.h"
+#include <ndn-cpp/util/sharded-content-store.hpp>
+
+using namespace std;
+using namespace ndn;
+
+static Name
+getName(const Blob& encoding)
+{
+  Data data;
+  data.wireDecode(encoding);
+  return data.getName();
+}
+
+class AddThreadParams {
+public:
+  ShardedContentStore* store_;
+  size_t threadNumber_;
+  size_t nData_;
+};
+
+static void*
+addData(void* arg)
+{
+  AddThreadParams& params = *(AddThreadParams*)arg;
+  for (size_t i = 0; i < params.nData_; ++i) {
+    Data data(Name("/A").appendNumber(i % 10).appendNumber(params.threadNumber_)
+              .appendNumber(i));
+    data.wireEncode();
+    params.store_->add(data);
+  }
+
+  return 0;
+}
+
+class TestShardedContentStore : public ::testing::Test {
+};
+
+TEST_F(TestShardedContentStore, Find)
+{
+  ShardedContentStore store(4, 2);
+  for (int i = 1; i <= 3; ++i) {
+    store.add(Data(Name("/A/1").appendSegment(i)));
+    store.add(Data(Name("/A/2").appendSegment(i)));
+  }
+  store.add(Data(Name("/B/1")));
+  ASSERT_EQ(7, store.size());
+
+  Interest interest(Name("/A/1").appendSegment(2));
+  ASSERT_TRUE(getName(store.find(interest)).equals(interest.getName()));
+
+  interest.setName(Name("/A/1"));
+  ASSERT_TRUE(getName(store.find(interest)).equals
+              (Name("/A/1").appendSegment(1)));
+  interest.setChildSelector(1);
+  ASSERT_TRUE(getName(store.find(interest)).equals
+              (Name("/A/1").appendSegment(3)));
+
+  // A name shorter than the shard key searches all the shards.
+  interest.setName(Name("/A"));
+  ASSERT_TRUE(getName(store.find(interest)).equals
+              (Name("/A/2").appendSegment(3)));
+  interest.setChildSelector(0);
+  ASSERT_TRUE(getName(store.find(interest)).equals
+              (Name("/A/1").appendSegment(1)));
+  interest.setName(Name());
+  ASSERT_TRUE(getName(store.find(interest)).equals
+              (Name("/A/1").appendSegment(1)));
+
+  interest.setName(Name("/C/1"));
+  ASSERT_TRUE(store.find(interest).isNull());
+
+  ASSERT_TRUE(store.remove(Name("/B/1")));
+  ASSERT_FALSE(store.remove(Name("/B/1")));
+  interest.setName(Name("/B"));
+  ASSERT_TRUE(store.find(interest).isNull());
+}
+
+TEST_F(TestShardedContentStore, Freshness)
+{
+  ShardedContentStore store;
+  Data data1(Name("/A/1/1"));
+  data1.getMetaInfo().setFreshnessPeriod(1.0);
+  store.add(data1);
+  Data data2(Name("/A/1/2"));
+  data2.getMetaInfo().setFreshnessPeriod(3600 * 1000.0);
+  store.add(data2);
+  store.add(Data(Name("/A/1/3")));
+  usleep(10000);
+
+  Interest interest(Name("/A/1"));
+  interest.setMustBeFresh(true);
+  ASSERT_TRUE(getName(store.find(interest)).equals(Name("/A/1/2")));
+  interest.setMustBeFresh(false);
+  ASSERT_TRUE(getName(store.find(interest)).equals(Name("/A/1/1")));
+
+  ASSERT_EQ(1, store.removeStaleContent());
+  ASSERT_EQ(2, store.size());
+
+  // Adding the same name replaces the Data packet.
+  data2.setContent(Blob((const uint8_t*)"x", 1));
+  store.add(data2);
+  ASSERT_EQ(2, store.size());
+  interest.setName(Name("/A/1/2"));
+  ASSERT_TRUE(store.find(interest).equals(data2.wireEncode()));
+}
+
+TEST_F(TestShardedContentStore, ConcurrentAdd)
+{
+  ShardedContentStore store(8, 2);
+  const size_t nThreads = 4;
+  const size_t nData = 1000;
+  pthread_t threads[nThreads];
+  AddThreadParams params[nThreads];
+  for (size_t i = 0; i < nThreads; ++i) {
+    params[i].store_ = &store;
+    params[i].threadNumber_ = i;
+    params[i].nData_ = nData;
+    ASSERT_EQ(0, pthread_create(&threads[i], 0, addData, &params[i]));
+  }
+
+  // Find while the other threads add.
+  Interest interest(Name("/A").appendNumber(0));
+  for (size_t i = 0; i < 1000; ++i)
+    store.find(interest);
+
+  for (size_t i = 0; i < nThreads; ++i)
+    pthread_join(threads[i], 0);
+
+  ASSERT_EQ(nThreads * nData, store.size());
+  interest.setName
+    (Name("/A").appendNumber(9).appendNumber(3).appendNumber(999));
+  ASSERT_FALSE(store.find(interest).isNull());
+}
+
+int
+main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -436,6 +436,47 @@ TEST_F(TestValidationPolicyCommandInterest, LimitedRecords)
     "Should succeed despite timestamp is reordered, because the record has been evicted");
 }
 
+TEST_F(TestValidationPolicyCommandInterest, RefreshedRecordNotEvicted)
+{
+  fixture_.reset(new ValidationPolicyCommandInterestFixture
+    (ValidationPolicyCommandInterest::Options(15 * 1000.0, 3)));
+
+  vector<ptr_lib::shared_ptr<PibIdentity> > identities;
+  for (int i = 0; i < 4; ++i) {
+    ptr_lib::shared_ptr<PibIdentity> identity = fixture_->addSubCertificate
+      ("/Security/V2/ValidatorFixture/Sub" + to_string(i), fixture_->identity_);
+    fixture_->cache_.insert(*identity->getDefaultKey()->getDefaultCertificate());
+    identities.push_back(identity);
+  }
+
+  // Signed at 0 seconds.
+  ptr_lib::shared_ptr<Interest> interest00 = fixture_->makeCommandInterest
+    (identities[0]);
+  ptr_lib::shared_ptr<Interest> interest1 = fixture_->makeCommandInterest
+    (identities[1]);
+  ptr_lib::shared_ptr<Interest> interest2 = fixture_->makeCommandInterest
+    (identities[2]);
+  // Signed at +1 seconds.
+  fixture_->setNowOffsetMilliseconds(1 * 1000.0);
+  ptr_lib::shared_ptr<Interest> interest01 = fixture_->makeCommandInterest
+    (identities[0]);
+  ptr_lib::shared_ptr<Interest> interest3 = fixture_->makeCommandInterest
+    (identities[3]);
+
+  validateExpectSuccess(*interest00, "Should succeed");
+  validateExpectSuccess(*interest1, "Should succeed");
+  validateExpectSuccess(*interest2, "Should succeed");
+  // This refreshes the record of identities[0], so it is not the oldest.
+  validateExpectSuccess(*interest01, "Should succeed");
+
+  validateExpectSuccess(*interest3, "Should succeed, forgets identities[1]");
+
+  validateExpectFailure(*interest00,
+    "Should fail (timestamp reorder) because the record was refreshed");
+  validateExpectSuccess(*interest1,
+    "Should succeed despite the timestamp being reordered, because the record has been evicted");
+}
+
 TEST_F(TestValidationPolicyCommandInterest, UnlimitedRecords)
 {
   fixture_.reset(new ValidationPolicyCommandInterestFixture
@@ -28,6 +28,7 @@
 #include <fstream>
 #include <ndn-cpp/security/v2/certificate-fetcher-offline.hpp>
 #include <ndn-cpp/security/validator-config.hpp>
+#include <ndn-cpp/security/v2/validator-config/config-rule-index.hpp>
 
 using namespace std;
 using namespace ndn;
@@ -296,6 +297,79 @@ TEST_F(TestValidationPolicyConfig, HyperRelation)
   ASSERT_TRUE(result.calledFailure_ && !result.calledContinue_);
 }
 
+TEST_F(TestValidationPolicyConfig, RuleIndex)
+{
+  const char* filters[][2] = {
+    { "/a/b", "is-strict-prefix-of" },
+    { "^<a><c><>*<KEY>$", 0 },
+    { "/a/b/c", "equal" },
+    { "<KEY><>$", 0 },
+    { "/a", "is-prefix-of" },
+    { "^[^<a>]<x>", 0 },
+    { "/", "is-strict-prefix-of" }
+  };
+  size_t nFilters = sizeof(filters) / sizeof(filters[0]);
+  const char* names[] = {
+    "/", "/a", "/a/b", "/a/b/c", "/a/b/c/d", "/a/c/KEY", "/a/c/d/KEY",
+    "/b/x", "/b/x/y", "/b/KEY/1", "/z", "/z/KEY/1", "/a/KEY/1/2"
+  };
+  size_t nNames = sizeof(names) / sizeof(names[0]);
+
+  for (int isForInterest = 0; isForInterest <= 1; ++isForInterest) {
+    // Each rule has one filter, except the last rule which has all the
+    // filters after the first.
+    vector<ptr_lib::shared_ptr<ConfigRule>> rules;
+    for (size_t i = 0; i <= nFilters; ++i) {
+      ptr_lib::shared_ptr<ConfigRule> rule(new ConfigRule
+        ("rule", isForInterest != 0));
+      for (size_t j = (i < nFilters ? i : 1);
+           j < (i < nFilters ? i + 1 : nFilters); ++j) {
+        if (filters[j][1])
+          rule->addFilter(ptr_lib::make_shared<ConfigRelationNameFilter>
+            (Name(filters[j][0]),
+             ConfigNameRelation::getNameRelationFromString(filters[j][1])));
+        else
+          rule->addFilter
+            (ptr_lib::make_shared<ConfigRegexNameFilter>(filters[j][0]));
+      }
+      rules.push_back(rule);
+    }
+
+    for (size_t nRules = 0; nRules <= rules.size(); ++nRules) {
+      // Try a sublist with rules removed from the front.
+      vector<ptr_lib::shared_ptr<ConfigRule>> subRules
+        (rules.begin() + (rules.size() - nRules), rules.end());
+      ConfigRuleIndex index(subRules, isForInterest != 0);
+
+      for (size_t i = 0; i < nNames; ++i) {
+        Name name(names[i]);
+        if (isForInterest)
+          // Add the signature components.
+          name.append("info").append("sig");
+
+        ConfigRule* expected = 0;
+        for (size_t j = 0; j < subRules.size(); ++j) {
+          if (subRules[j]->match(isForInterest != 0, name)) {
+            expected = subRules[j].get();
+            break;
+          }
+        }
+
+        ASSERT_EQ(expected, index.findFirstMatch(name)) <<
+          "Wrong rule for " << name.toUri() << " with " << nRules << " rules";
+      }
+    }
+
+    // A rule with no filters matches an Interest name which is too short.
+    vector<ptr_lib::shared_ptr<ConfigRule>> alwaysRules(rules);
+    alwaysRules.push_back(ptr_lib::make_shared<ConfigRule>
+      ("always", isForInterest != 0));
+    ConfigRuleIndex alwaysIndex(alwaysRules, isForInterest != 0);
+    ASSERT_EQ(isForInterest ? alwaysRules.back().get() : rules[4].get(),
+              alwaysIndex.findFirstMatch(Name("/a")));
+  }
+}
+
 int
 main(int argc, char **argv)
 {
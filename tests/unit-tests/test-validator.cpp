@@ -176,6 +176,18 @@ TEST_F(TestValidator, Timeouts)
   ASSERT_TRUE(fixture_.face_.sentInterests_.size() > 1);
 }
 
+static void
+countSuccess(const Data& data, int* nSuccesses)
+{
+  ++(*nSuccesses);
+}
+
+static void
+countFailure(const Data& data, const ValidationError& error, int* nFailures)
+{
+  ++(*nFailures);
+}
+
 static void
 processInterestAsNetworkNack
   (const ndn::Interest& interest, const ndn::OnData& onData,
@@ -201,6 +213,160 @@ TEST_F(TestValidator, NackedInterests)
   ASSERT_TRUE(fixture_.face_.sentInterests_.size() > 1);
 }
 
+TEST_F(TestValidator, NegativeCache)
+{
+  // Disable responses from the simulated Face.
+  fixture_.face_.processInterest_ = 0;
+
+  Data data(Name("/Security/V2/ValidatorFixture/Sub1/Sub2/Data"));
+  fixture_.keyChain_.sign(data, SigningInfo(fixture_.subIdentity_));
+
+  validateExpectFailure(data, "Should fail to retrieve certificate");
+  ASSERT_TRUE(fixture_.face_.sentInterests_.size() > 1);
+  fixture_.face_.sentInterests_.clear();
+
+  validateExpectFailure(data, "Should fail from the negative cache");
+  ASSERT_EQ(0, fixture_.face_.sentInterests_.size());
+
+  // Simulate a time after the negative cache entry expires.
+  CertificateFetcherFromNetwork& fetcher =
+    dynamic_cast<CertificateFetcherFromNetwork&>
+      (fixture_.validator_.getFetcher());
+  fetcher.setNowOffsetMilliseconds_
+    (CertificateFetcherFromNetwork::getDefaultNegativeCacheLifetime() + 1000.0);
+
+  validateExpectFailure(data, "Should try again to retrieve certificate");
+  ASSERT_TRUE(fixture_.face_.sentInterests_.size() > 1);
+}
+
+/**
+ * Save the callbacks from expressInterest so that the test can respond later.
+ */
+static void
+processInterestLater
+  (const ndn::Interest& interest, const ndn::OnData& onData,
+   const ndn::OnTimeout& onTimeout, const ndn::OnNetworkNack& onNetworkNack,
+   vector<ndn::OnData>* savedOnData, vector<ndn::OnTimeout>* savedOnTimeout)
+{
+  savedOnData->push_back(onData);
+  savedOnTimeout->push_back(onTimeout);
+}
+
+TEST_F(TestValidator, CoalescedFetches)
+{
+  vector<ndn::OnData> savedOnData;
+  vector<ndn::OnTimeout> savedOnTimeout;
+  fixture_.face_.processInterest_ = bind
+    (&processInterestLater, _1, _2, _3, _4, &savedOnData, &savedOnTimeout);
+
+  int nSuccesses = 0;
+  int nFailures = 0;
+  const int nPackets = 10;
+  for (int i = 0; i < nPackets; ++i) {
+    Data data(Name("/Security/V2/ValidatorFixture/Sub1/Sub2/Data").append
+      (Name::Component::fromNumber(i)));
+    fixture_.keyChain_.sign(data, SigningInfo(fixture_.subIdentity_));
+    fixture_.validator_.validate
+      (data, bind(&countSuccess, _1, &nSuccesses),
+       bind(&countFailure, _1, _2, &nFailures));
+  }
+
+  // All packets wait for one Interest for the same certificate.
+  ASSERT_EQ(1, fixture_.face_.sentInterests_.size());
+  ASSERT_EQ(1, savedOnData.size());
+  ASSERT_EQ(0, nSuccesses + nFailures);
+
+  ptr_lib::shared_ptr<CertificateV2> certificate =
+    fixture_.cache_.find(fixture_.face_.sentInterests_[0]);
+  ASSERT_TRUE(!!certificate);
+  savedOnData[0]
+    (ptr_lib::make_shared<Interest>(fixture_.face_.sentInterests_[0]),
+     certificate);
+
+  ASSERT_EQ(nPackets, nSuccesses);
+  ASSERT_EQ(0, nFailures);
+}
+
+TEST_F(TestValidator, CoalescedRetries)
+{
+  vector<ndn::OnData> savedOnData;
+  vector<ndn::OnTimeout> savedOnTimeout;
+  fixture_.face_.processInterest_ = bind
+    (&processInterestLater, _1, _2, _3, _4, &savedOnData, &savedOnTimeout);
+  ptr_lib::shared_ptr<Interest> interest;
+
+  int nSuccesses = 0;
+  int nFailures = 0;
+  Data data0(Name("/Security/V2/ValidatorFixture/Sub1/Sub2/Data0"));
+  fixture_.keyChain_.sign(data0, SigningInfo(fixture_.subIdentity_));
+  fixture_.validator_.validate
+    (data0, bind(&countSuccess, _1, &nSuccesses),
+     bind(&countFailure, _1, _2, &nFailures));
+  ASSERT_EQ(1, fixture_.face_.sentInterests_.size());
+  interest = ptr_lib::make_shared<Interest>(fixture_.face_.sentInterests_[0]);
+
+  // Use two of the three retries of the first request.
+  savedOnTimeout.back()(interest);
+  savedOnTimeout.back()(interest);
+  ASSERT_EQ(3, fixture_.face_.sentInterests_.size());
+
+  // The second request joins the pending fetch with its own three retries.
+  Data data1(Name("/Security/V2/ValidatorFixture/Sub1/Sub2/Data1"));
+  fixture_.keyChain_.sign(data1, SigningInfo(fixture_.subIdentity_));
+  fixture_.validator_.validate
+    (data1, bind(&countSuccess, _1, &nSuccesses),
+     bind(&countFailure, _1, _2, &nFailures));
+  ASSERT_EQ(3, fixture_.face_.sentInterests_.size());
+
+  // The first request runs out of retries, but the second keeps the fetch.
+  savedOnTimeout.back()(interest);
+  ASSERT_EQ(0, nFailures);
+  savedOnTimeout.back()(interest);
+  ASSERT_EQ(1, nFailures);
+  ASSERT_EQ(5, fixture_.face_.sentInterests_.size());
+
+  ptr_lib::shared_ptr<CertificateV2> certificate =
+    fixture_.cache_.find(fixture_.face_.sentInterests_[0]);
+  ASSERT_TRUE(!!certificate);
+  savedOnData.back()(interest, certificate);
+  ASSERT_EQ(1, nSuccesses);
+  ASSERT_EQ(1, nFailures);
+}
+
+TEST_F(TestValidator, RetryChecksCache)
+{
+  vector<ndn::OnData> savedOnData;
+  vector<ndn::OnTimeout> savedOnTimeout;
+  fixture_.face_.processInterest_ = bind
+    (&processInterestLater, _1, _2, _3, _4, &savedOnData, &savedOnTimeout);
+
+  int nSuccesses = 0;
+  int nFailures = 0;
+  Data data(Name("/Security/V2/ValidatorFixture/Sub1/Sub2/Data"));
+  fixture_.keyChain_.sign(data, SigningInfo(fixture_.subIdentity_));
+  fixture_.validator_.validate
+    (data, bind(&countSuccess, _1, &nSuccesses),
+     bind(&countFailure, _1, _2, &nFailures));
+  ASSERT_EQ(1, fixture_.face_.sentInterests_.size());
+
+  // The certificate arrives another way while the Interest is outstanding.
+  ptr_lib::shared_ptr<CertificateV2> certificate =
+    fixture_.cache_.find(fixture_.face_.sentInterests_[0]);
+  ASSERT_TRUE(!!certificate);
+  fixture_.validator_.cacheUnverifiedCertificate(*certificate);
+
+  // The retry finds it without sending another Interest.
+  savedOnTimeout.back()
+    (ptr_lib::make_shared<Interest>(fixture_.face_.sentInterests_[0]));
+  ASSERT_EQ(1, fixture_.face_.sentInterests_.size());
+  ASSERT_EQ(1, nSuccesses);
+  ASSERT_EQ(0, nFailures);
+  CertificateFetcherFromNetwork& fetcher =
+    dynamic_cast<CertificateFetcherFromNetwork&>
+      (fixture_.validator_.getFetcher());
+  ASSERT_EQ(0, fetcher.getPendingFetchCount());
+}
+
 static void
 processInterestWithCertificate
   (const ndn::Interest& interest, const ndn::OnData& onData,